@@ -61,12 +61,48 @@ namespace Framework
         mLogLevel = static_cast<LogLevel>(aSerializer["game"].get("loglevel", mLogLevel).asInt());
         mLogFile = aSerializer["game"].get("logfile", mLogFile).asString();
         Logger::Initialize(mLogFile, mLogLevel);
+        mHotReload = aSerializer["game"].get("hotreload", mHotReload).asBool();
 
         LoadInputFromJson(aSerializer["input"]);
         LoadGraphicsFromJson(aSerializer["graphics"]);
         LoadResourcesFromJson(aSerializer["resources"]);
         LoadPrefabsFromJson(aSerializer["prefabs"]); 
         LoadCatalogsFromJson(aSerializer["catalogs"]);   
+        LoadCacheDirectory(aSerializer["game"]);
+    }
+
+    void Config::LoadCacheDirectory(const Json::Value& aSerializer)
+    {
+        mCacheDirectory = aSerializer.get("cachedirectory", "").asString();
+        if (!mCacheDirectory.empty())
+            return;
+
+        // The cache directory of the user: %LOCALAPPDATA% on Windows, $XDG_CACHE_HOME or ~/.cache elsewhere
+#ifdef _WIN32
+        const char* lUserCache = getenv("LOCALAPPDATA");
+        if (lUserCache)
+            mCacheDirectory.assign(lUserCache);
+#else
+        const char* lUserCache = getenv("XDG_CACHE_HOME");
+        const char* lHome = getenv("HOME");
+        if (lUserCache && *lUserCache)
+            mCacheDirectory.assign(lUserCache);
+        else if (lHome && *lHome)
+            mCacheDirectory.assign(lHome).append("/.cache");
+#endif
+        if (mCacheDirectory.empty())
+        {
+            WARNING("No user cache directory, the cache goes to the data directory");
+            mCacheDirectory = mDataDirectory + "/cache";
+            return;
+        }
+
+        for (char& lChar : mCacheDirectory)
+        {
+            if (lChar == '\\')
+                lChar = '/';
+        }
+        mCacheDirectory.append("/").append(mGameName.empty() ? "Insomnium" : mGameName).append("/cache");
     }
 
     void Config::LoadInputFromJson(const Json::Value& aSerializer)
@@ -103,6 +139,10 @@ namespace Framework
                0.0f <= mFocusLineColor.b && mFocusLineColor.b <= 1.0f &&
                0.0f <= mFocusLineColor.a && mFocusLineColor.a <= 1.0f);
 
+        // Megabytes, optional
+        mCpuMemoryBudget = uint64_t(aSerializer["memoryBudget"].get("cpu", 0).asUInt()) << 20;
+        mGpuMemoryBudget = uint64_t(aSerializer["memoryBudget"].get("gpu", 0).asUInt()) << 20;
+
         mFontInfo.path = aSerializer["font"]["path"].asString();
         ASSERT(!mFontInfo.path.empty());
         mFontInfo.size = aSerializer["font"]["size"].asUInt();
@@ -30,6 +30,8 @@ namespace Framework
         const glm::vec4&                GetSelectionLineColor() const { return mSelectionLineColor; }
         float                           GetFocusLineWidth() const { return mFocusLineWidth; }
         const glm::vec4&                GetFocusLineColor() const { return mFocusLineColor; }
+        uint64_t                        GetCpuMemoryBudget() const { return mCpuMemoryBudget; }
+        uint64_t                        GetGpuMemoryBudget() const { return mGpuMemoryBudget; }
                                         
         struct FONT_INFO 
         {
@@ -45,6 +47,8 @@ namespace Framework
 
         const std::string&              GetGameName() const { return mGameName; }
         const std::string&              GetDataDirectory() const { return mDataDirectory; }
+        const std::string&              GetCacheDirectory() const { return mCacheDirectory; }
+        bool                            GetHotReload() const { return mHotReload; }
 
         const std::string&              GetPrefabFile(const std::string& aName);
         void                            GetPrefabFiles(std::vector<std::string>& aFilesOut) const;
@@ -61,6 +65,7 @@ namespace Framework
         void                            LoadResourcesFromJson(const Json::Value& aSerializer);
         void                            LoadPrefabsFromJson(const Json::Value& aSerializer);
         void                            LoadCatalogsFromJson(const Json::Value& aSerializer);
+        void                            LoadCacheDirectory(const Json::Value& aSerializer);
 
     private:
         Config() = default;
@@ -69,9 +74,11 @@ namespace Framework
         std::string                mInitialStateFile;
         std::string                mLanguageFile;
         std::string                mDataDirectory;
+        std::string                mCacheDirectory;         /**< Writable per user, the data directory may be read only once installed */
         std::string                mUIThemeFile;
         std::string                mLogFile;
         LogLevel                   mLogLevel;
+        bool                       mHotReload = false;      /**< Reload the resources when their files change */
 
         glm::uvec2                 mResolution;
         bool                       mFullscreen;
@@ -80,6 +87,8 @@ namespace Framework
         glm::vec4                  mSelectionLineColor = { 1.0f, 1.0f, 1.0f, 1.0f };
         float                      mFocusLineWidth = 1.0f;
         glm::vec4                  mFocusLineColor = { 1.0f, 1.0f, 1.0f, 1.0f };
+        uint64_t                   mCpuMemoryBudget = 0;    /**< Bytes of the loaded assets, 0 is no limit */
+        uint64_t                   mGpuMemoryBudget = 0;
 
         float                      mKeyboardSensibility;
         float                      mMouseSensibility;
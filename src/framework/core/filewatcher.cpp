@@ -0,0 +1,190 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Reports the watched files that were written
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "core/filewatcher.h"
+
+#if defined(__linux__)
+    #include <errno.h>
+    #include <unistd.h>
+    #include <sys/inotify.h>
+#else
+    #include <sys/types.h>
+    #include <sys/stat.h>
+#endif
+
+namespace Framework
+{
+    namespace
+    {
+        std::string NormalizePath(const std::string& aPath)
+        {
+            std::string lPath = aPath;
+            std::replace(lPath.begin(), lPath.end(), '\\', '/');
+            return lPath;
+        }
+
+        /* Directory part of a path, empty for a file of the working directory */
+        std::string GetDirectory(const std::string& aPath)
+        {
+            const size_t lSlash = aPath.find_last_of('/');
+            return lSlash != std::string::npos ? aPath.substr(0, lSlash) : std::string();
+        }
+
+#if !defined(__linux__)
+        /* The modification times have a resolution of a second, the size tells the
+           writes of the same second apart most of the time */
+        std::pair<int64_t, int64_t> GetFileStamp(const std::string& aPath)
+        {
+            struct stat lStat;
+            if ( stat(aPath.c_str(), &lStat) != 0 )
+                return std::make_pair(int64_t(-1), int64_t(-1));
+            return std::make_pair(static_cast<int64_t>(lStat.st_mtime), static_cast<int64_t>(lStat.st_size));
+        }
+#endif
+    }
+
+#if defined(__linux__)
+
+    bool FileWatcher::IsNative()
+    {
+        return true;
+    }
+
+    bool FileWatcher::Watch(const std::string& aFileName)
+    {
+        const std::string lPath = NormalizePath(aFileName);
+        if ( mFiles.count(lPath) > 0 )
+            return true;
+
+        if ( mDescriptor < 0 )
+        {
+            mDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if ( mDescriptor < 0 )
+            {
+                WARNING("Cannot create the inotify instance: %s", strerror(errno));
+                return false;
+            }
+        }
+
+        /* A directory watch sees the editors that save to a temporary file and
+           rename it over the original, a watch on the file would be lost */
+        const std::string lDirectory = GetDirectory(lPath);
+        if ( mWatchedDirectories.count(lDirectory) == 0 )
+        {
+            const int lWatch = inotify_add_watch(mDescriptor, lDirectory.empty() ? "." : lDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if ( lWatch < 0 )
+            {
+                WARNING("Cannot watch the directory of %s: %s", lPath.c_str(), strerror(errno));
+                return false;
+            }
+            mDirectories[lWatch] = lDirectory;
+            mWatchedDirectories.insert(lDirectory);
+        }
+        mFiles.insert(lPath);
+        return true;
+    }
+
+    void FileWatcher::Clear()
+    {
+        if ( mDescriptor >= 0 )
+            close(mDescriptor); // removes the watches
+        mDescriptor = -1;
+        mDirectories.clear();
+        mWatchedDirectories.clear();
+        mFiles.clear();
+    }
+
+    uint32_t FileWatcher::Poll(std::vector<std::string>& aChanged)
+    {
+        if ( mDescriptor < 0 )
+            return 0;
+
+        std::unordered_set<std::string> lChanged;
+        bool lOverflow = false;
+        alignas(struct inotify_event) char lBuffer[4096];
+        for ( ;; )
+        {
+            const ssize_t lRead = read(mDescriptor, lBuffer, sizeof lBuffer);
+            if ( lRead <= 0 )
+                break; // EAGAIN, nothing more to read
+
+            for ( const char* lEvent = lBuffer; lEvent < lBuffer + lRead; )
+            {
+                const struct inotify_event& lInfo = *reinterpret_cast<const struct inotify_event*>(lEvent);
+                lEvent += sizeof(struct inotify_event) + lInfo.len;
+                if ( lInfo.mask & IN_Q_OVERFLOW )
+                    lOverflow = true;
+                if ( lInfo.len == 0 )
+                    continue;
+                auto lDirectory = mDirectories.find(lInfo.wd);
+                if ( lDirectory == mDirectories.end() )
+                    continue;
+                std::string lPath = lDirectory->second.empty() ? std::string(lInfo.name) : lDirectory->second + "/" + lInfo.name;
+                if ( mFiles.count(lPath) > 0 )
+                    lChanged.insert(std::move(lPath));
+            }
+        }
+
+        // Events were dropped, any file may have changed
+        if ( lOverflow )
+            lChanged = mFiles;
+
+        aChanged.insert(aChanged.end(), lChanged.begin(), lChanged.end());
+        return static_cast<uint32_t>(lChanged.size());
+    }
+
+#else
+
+    const uint32_t FileWatcher::sPollInterval;
+
+    bool FileWatcher::IsNative()
+    {
+        return false;
+    }
+
+    bool FileWatcher::Watch(const std::string& aFileName)
+    {
+        const std::string lPath = NormalizePath(aFileName);
+        if ( mFiles.insert(lPath).second )
+            mStamps[lPath] = GetFileStamp(lPath);
+        return true;
+    }
+
+    void FileWatcher::Clear()
+    {
+        mFiles.clear();
+        mStamps.clear();
+    }
+
+    uint32_t FileWatcher::Poll(std::vector<std::string>& aChanged)
+    {
+        const uint64_t lNow = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        if ( lNow - mLastScan < sPollInterval )
+            return 0;
+        mLastScan = lNow;
+
+        uint32_t lChanged = 0;
+        for ( auto& lFile : mStamps )
+        {
+            const std::pair<int64_t, int64_t> lStamp = GetFileStamp(lFile.first);
+            if ( lStamp == lFile.second )
+                continue;
+            lFile.second = lStamp;
+            if ( lStamp.first >= 0 ) // a deleted file is reported when it is written again
+            {
+                aChanged.push_back(lFile.first);
+                ++lChanged;
+            }
+        }
+        return lChanged;
+    }
+
+#endif
+}
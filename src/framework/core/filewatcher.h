@@ -0,0 +1,79 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Reports the watched files that were written. On Linux the
+ *                directories of the files are watched with inotify and the events
+ *                are read without blocking; elsewhere the modification times are
+ *                compared at a fixed interval.
+ *******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <stdint.h>
+
+namespace Framework
+{
+    class FileWatcher
+    {
+    public:
+        FileWatcher() = default;
+        ~FileWatcher() { Clear(); }
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        /**
+         * Watches a file. The file does not need to exist yet, its directory does
+         *
+         * @param aFileName  File to watch, the changes are reported with this spelling
+         *                   with the separators unified
+         *
+         * @return false if the directory of the file cannot be watched
+         */
+        bool Watch(const std::string& aFileName);
+
+        /**
+         * Stops watching all the files
+         */
+        void Clear();
+
+        /**
+         * Collects the watched files written since the last call, each file once.
+         * With inotify a file is reported when it is closed after writing or moved
+         * in place, so the writer has finished with it; the polling reports a new
+         * modification time
+         *
+         * @param aChanged  Changed files are appended
+         *
+         * @return Number of files appended
+         */
+        uint32_t Poll(std::vector<std::string>& aChanged);
+
+        uint32_t GetFileCount() const { return static_cast<uint32_t>(mFiles.size()); }
+
+        /**
+         * @return true if the changes are notified by the operating system, false if
+         *         the files are polled
+         */
+        static bool IsNative();
+
+    private:
+        std::unordered_set<std::string> mFiles;
+#if defined(__linux__)
+        int                                  mDescriptor = -1;   /**< inotify instance, opened by the first Watch */
+        std::unordered_map<int, std::string> mDirectories;       /**< Watch descriptor to directory */
+        std::unordered_set<std::string>      mWatchedDirectories;
+#else
+        static const uint32_t                                        sPollInterval = 500; /**< Milliseconds between two scans */
+        std::unordered_map<std::string, std::pair<int64_t, int64_t>> mStamps;             /**< Modification time and size of every file */
+        uint64_t                                                     mLastScan = 0;
+#endif
+    };
+}
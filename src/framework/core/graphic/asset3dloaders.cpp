@@ -336,8 +336,6 @@ namespace Framework
             }
         }
 
-        fclose(lFile);
-
     error_exit:
         fclose(lFile);
         return lResult;
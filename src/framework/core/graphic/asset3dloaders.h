@@ -59,6 +59,8 @@ namespace Framework
         * renderer can loop per material, and then for each material a list of indexed display
         * lists are provided.
         *
+        * ObjImporter reads the complete format in parallel and is preferred for new imports.
+        *
         * @param model  The Asset3D where the data will be loaded into
         * @param name   Path and name of the model in disk
         *
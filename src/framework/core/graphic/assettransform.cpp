@@ -42,6 +42,7 @@ namespace Framework
     void AssetTransform::AppendGeometryOnly(Asset3D &to, const Asset3D &from)
     {
         uint32_t lOrigDataSize = static_cast<uint32_t>(to.mVertexData.size());
+        ASSERT(to.mLods.empty() && from.mLods.empty()); // The levels of detail are generated once the geometry is final
 
         /* The vertex data, materials, textures and indices count can be appended directly,
         * as they are independant of the mVertexData size */
@@ -57,6 +58,7 @@ namespace Framework
     void AssetTransform::SetUniqueMaterial(Asset3D &aAsset, const Material &aMaterial, Texture&& aTexture)
     {
         /* Clear all previous data */
+        ASSERT(aAsset.mLods.empty());
         aAsset.mMaterials.clear();
         aAsset.mTextures.clear();
         aAsset.mIndicesOffsets.clear();
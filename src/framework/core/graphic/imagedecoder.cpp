@@ -0,0 +1,59 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Thread-safe decoding of the common image formats
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "core/mappedfile.h"
+#include "core/graphic/imagedecoder.h"
+#include "nanovg/stb_image.h"
+
+namespace Framework
+{
+    bool ImageDecoder::Decode(const std::string& aFilename, Texture& aImage, const Options& aOptions)
+    {
+        aImage.Clear();
+        MappedFile lFile;
+        if ( !lFile.Open(aFilename) || !Decode(lFile.GetData(), lFile.GetSize(), aImage, aOptions) )
+            return false;
+        aImage.mName = Utils::GetFileName(aFilename);
+        return true;
+    }
+
+    bool ImageDecoder::Decode(const uint8_t* aData, size_t aSize, Texture& aImage, const Options& aOptions)
+    {
+        aImage.Clear();
+        ASSERT(aOptions.mChannels <= 4);
+        if ( aSize == 0 || aSize > size_t(std::numeric_limits<int>::max()) || aOptions.mChannels > 4 )
+            return false;
+
+        int lWidth = 0, lHeight = 0, lChannels = 0;
+        stbi_uc* lPixels = stbi_load_from_memory(aData, static_cast<int>(aSize), &lWidth, &lHeight, &lChannels,
+                                                 static_cast<int>(aOptions.mChannels));
+        if ( !lPixels )
+            return false;
+        if ( aOptions.mChannels != 0 )
+            lChannels = static_cast<int>(aOptions.mChannels);
+
+        static const uint32_t sFormats[5] = { 0, GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_RGB, GL_RGBA };
+        aImage.mWidth = static_cast<uint32_t>(lWidth);
+        aImage.mHeight = static_cast<uint32_t>(lHeight);
+        aImage.mBytesPerPixel = static_cast<uint32_t>(lChannels);
+        aImage.mFormat = sFormats[lChannels];
+        aImage.mType = GL_UNSIGNED_BYTE;
+
+        const size_t lRowSize = size_t(lWidth) * lChannels;
+        aImage.mPixels.resize(lRowSize * lHeight);
+        for ( int y = 0; y < lHeight; ++y )
+        {
+            const int lRow = aOptions.mFlipVertically ? lHeight - 1 - y : y;
+            memcpy(&aImage.mPixels[size_t(y) * lRowSize], lPixels + size_t(lRow) * lRowSize, lRowSize);
+        }
+        stbi_image_free(lPixels);
+        return true;
+    }
+}
@@ -0,0 +1,52 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Thread-safe decoding of the PNG, JPEG, TGA and BMP images. DevIL keeps
+ *                the bound image and its settings in globals, so it can only decode on
+ *                one thread at a time. This decoder goes through stb_image (already
+ *                linked with NanoVG) on a mapped file and only touches the caller's
+ *                buffers, so any number of threads can decode at once.
+ *
+ *                stb_image keeps a few settings in globals too; they are never changed
+ *                here (the vertical flip is done by the decoder) so they are only read.
+ *******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <stdint.h>
+#include "graphic/texture.h"
+
+namespace Framework
+{
+    class ImageDecoder
+    {
+    public:
+        struct Options
+        {
+            uint32_t mChannels = 0;         /**< Channels of the result, 0 keeps the ones of the file */
+            bool     mFlipVertically = true;/**< First row at the bottom, the OpenGL and DevIL origin */
+        };
+
+        /**
+         * Decodes an image file into 8 bit pixels
+         *
+         * @param aFilename  Image file
+         * @param aImage     Out: pixels, size and GL format of the image. Cleared on failure
+         * @param aOptions   Layout of the result
+         *
+         * @return false if the file cannot be read or its format is not supported
+         *         (e.g. 16 bit PNG), the caller may then fall back to Texture::Load
+         */
+        static bool Decode(const std::string& aFilename, Texture& aImage, const Options& aOptions);
+        static bool Decode(const std::string& aFilename, Texture& aImage) { return Decode(aFilename, aImage, Options()); }
+
+        /**
+         * Decodes an image already in memory
+         */
+        static bool Decode(const uint8_t* aData, size_t aSize, Texture& aImage, const Options& aOptions);
+    };
+}
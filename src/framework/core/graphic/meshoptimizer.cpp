@@ -0,0 +1,334 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Cook time optimization of the geometry of an Asset3D
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include <chrono>
+#include "core/graphic/meshoptimizer.h"
+
+namespace Framework
+{
+    namespace
+    {
+        /* FIFO post-transform cache. A vertex is in the cache while fewer than aSize
+           vertices were transformed after it, so a flush is a jump of the clock */
+        class FifoCache
+        {
+        public:
+            FifoCache(uint32_t aVertexCount, uint32_t aSize)
+                : mStamps(aVertexCount, 0)
+                , mSize(aSize)
+                , mClock(aSize + 1)
+            {}
+
+            inline uint32_t Access(uint32_t aVertex)
+            {
+                if ( mClock - mStamps[aVertex] > mSize )
+                {
+                    mStamps[aVertex] = mClock++;
+                    return 1;
+                }
+                return 0;
+            }
+
+            inline uint32_t AccessTriangle(const uint32_t* aTriangle)
+            {
+                return Access(aTriangle[0]) + Access(aTriangle[1]) + Access(aTriangle[2]);
+            }
+
+            inline void Flush() { mClock += mSize + 1; }
+
+        private:
+            std::vector<uint32_t> mStamps;
+            uint32_t              mSize;
+            uint32_t              mClock;
+        };
+
+        struct Cluster
+        {
+            uint32_t mFirst;    /**< First triangle */
+            uint32_t mCount;    /**< Triangles */
+            float    mSortKey;
+        };
+    }
+
+    MeshOptimizer::Stats MeshOptimizer::Optimize(Asset3D& aAsset, const Options& aOptions)
+    {
+        ASSERT(!aAsset.mRendererResources);
+        const auto lStart = std::chrono::steady_clock::now();
+
+        Stats lStats;
+        lStats.mBefore = Analyze(aAsset);
+
+        const uint32_t lVertexCount = static_cast<uint32_t>(aAsset.mVertexData.size());
+        for ( uint32_t lIndex : aAsset.mVertexIndices )
+        {
+            if ( lIndex >= lVertexCount )
+            {
+                WARNING("Asset %s has an index out of range, it is not optimized", aAsset.GetName().c_str());
+                lStats.mAfter = lStats.mBefore;
+                return lStats;
+            }
+        }
+
+        for ( size_t i = 0; i < aAsset.mIndicesOffsets.size(); ++i )
+        {
+            const uint32_t lFirst = aAsset.mIndicesOffsets[i];
+            const uint32_t lCount = aAsset.mIndicesCount[i] - aAsset.mIndicesCount[i] % 3;
+            if ( lFirst + lCount > aAsset.mVertexIndices.size() )
+            {
+                WARNING("Asset %s has a rendering list out of range", aAsset.GetName().c_str());
+                continue;
+            }
+            if ( aOptions.mVertexCache )
+                OptimizeVertexCache(aAsset.mVertexIndices, lFirst, lCount, lVertexCount);
+            if ( aOptions.mOverdraw )
+                lStats.mClusters += OptimizeOverdraw(aAsset.mVertexIndices, lFirst, lCount, aAsset.mVertexData, aOptions.mOverdrawThreshold);
+        }
+
+        if ( aOptions.mVertexFetch )
+            OptimizeVertexFetch(aAsset);
+        aAsset.mVertexFormat = aOptions.mVertexFormat;
+
+        lStats.mAfter = Analyze(aAsset);
+        lStats.mTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - lStart).count();
+        INFO(LogLevel::eLEVEL2, "Optimized %s: ACMR %.3f -> %.3f, %u -> %u bytes per vertex, %u -> %u bytes per index",
+             aAsset.GetName().c_str(), lStats.mBefore.mACMR, lStats.mAfter.mACMR, lStats.mBefore.mVertexBytes,
+             lStats.mAfter.mVertexBytes, lStats.mBefore.mIndexBytes, lStats.mAfter.mIndexBytes);
+        return lStats;
+    }
+
+    MeshOptimizer::Analysis MeshOptimizer::Analyze(const Asset3D& aAsset, uint32_t aCacheSize)
+    {
+        Analysis lAnalysis;
+        const auto& lIndices = aAsset.GetIndexData();
+        lAnalysis.mVertices = static_cast<uint32_t>(aAsset.GetVertexData().size());
+        lAnalysis.mTriangles = static_cast<uint32_t>(lIndices.size() / 3);
+        lAnalysis.mVertexBytes = Asset3D::GetVertexStride(aAsset.GetVertexFormat());
+        lAnalysis.mIndexBytes = aAsset.GetIndexSize();
+        lAnalysis.mGeometryBytes = uint64_t(lAnalysis.mVertices) * lAnalysis.mVertexBytes + uint64_t(lIndices.size()) * lAnalysis.mIndexBytes;
+
+        FifoCache lCache(lAnalysis.mVertices, aCacheSize);
+        uint32_t lMisses = 0;
+        for ( uint32_t lIndex : lIndices )
+        {
+            if ( lIndex < lAnalysis.mVertices )
+                lMisses += lCache.Access(lIndex);
+        }
+        if ( lAnalysis.mTriangles > 0 )
+            lAnalysis.mACMR = float(lMisses) / lAnalysis.mTriangles;
+        if ( lAnalysis.mVertices > 0 )
+            lAnalysis.mATVR = float(lMisses) / lAnalysis.mVertices;
+        return lAnalysis;
+    }
+
+    void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& aIndices, uint32_t aFirst, uint32_t aCount,
+                                            uint32_t aVertexCount, uint32_t aCacheSize)
+    {
+        const uint32_t lTriangleCount = aCount / 3;
+        if ( lTriangleCount < 2 )
+            return;
+        const uint32_t* lTriangles = aIndices.data() + aFirst;
+
+        /* Triangles of every vertex, the live count is the number not emitted yet */
+        std::vector<uint32_t> lLive(aVertexCount, 0);
+        for ( uint32_t i = 0; i < lTriangleCount * 3; ++i )
+            ++lLive[lTriangles[i]];
+        std::vector<uint32_t> lAdjacencyOffsets(aVertexCount + 1, 0);
+        for ( uint32_t v = 0; v < aVertexCount; ++v )
+            lAdjacencyOffsets[v + 1] = lAdjacencyOffsets[v] + lLive[v];
+        std::vector<uint32_t> lAdjacency(lTriangleCount * 3);
+        {
+            std::vector<uint32_t> lFill(lAdjacencyOffsets.begin(), lAdjacencyOffsets.end() - 1);
+            for ( uint32_t i = 0; i < lTriangleCount * 3; ++i )
+                lAdjacency[lFill[lTriangles[i]]++] = i / 3;
+        }
+
+        std::vector<uint32_t> lStamps(aVertexCount, 0);
+        std::vector<uint8_t>  lEmitted(lTriangleCount, 0);
+        std::vector<uint32_t> lDeadEnds;
+        std::vector<uint32_t> lCandidates;
+        std::vector<uint32_t> lResult;
+        lDeadEnds.reserve(lTriangleCount * 3);
+        lResult.reserve(lTriangleCount * 3);
+
+        uint32_t lClock = aCacheSize + 1;
+        uint32_t lCursor = 0;
+        int64_t  lFan = lTriangles[0];
+        while ( lFan >= 0 )
+        {
+            /* Emit all the remaining triangles around the fanning vertex */
+            lCandidates.clear();
+            for ( uint32_t a = lAdjacencyOffsets[lFan]; a < lAdjacencyOffsets[lFan + 1]; ++a )
+            {
+                const uint32_t lTriangle = lAdjacency[a];
+                if ( lEmitted[lTriangle] )
+                    continue;
+                lEmitted[lTriangle] = 1;
+                for ( uint32_t c = 0; c < 3; ++c )
+                {
+                    const uint32_t lVertex = lTriangles[lTriangle * 3 + c];
+                    lResult.push_back(lVertex);
+                    lDeadEnds.push_back(lVertex);
+                    lCandidates.push_back(lVertex);
+                    --lLive[lVertex];
+                    if ( lClock - lStamps[lVertex] > aCacheSize )
+                        lStamps[lVertex] = lClock++;
+                }
+            }
+
+            /* Next fan: the oldest vertex of the last fan that would still be in the
+               cache after emitting all its triangles */
+            lFan = -1;
+            int64_t lBestPriority = -1;
+            for ( uint32_t lVertex : lCandidates )
+            {
+                if ( lLive[lVertex] == 0 )
+                    continue;
+                int64_t lPriority = 0;
+                if ( lClock - lStamps[lVertex] + 2 * lLive[lVertex] <= aCacheSize )
+                    lPriority = lClock - lStamps[lVertex];
+                if ( lPriority > lBestPriority )
+                {
+                    lBestPriority = lPriority;
+                    lFan = lVertex;
+                }
+            }
+
+            /* Dead end, go back to a recent vertex with triangles left or to the next one in order */
+            while ( lFan < 0 && !lDeadEnds.empty() )
+            {
+                const uint32_t lVertex = lDeadEnds.back();
+                lDeadEnds.pop_back();
+                if ( lLive[lVertex] > 0 )
+                    lFan = lVertex;
+            }
+            while ( lFan < 0 && lCursor < aVertexCount )
+            {
+                if ( lLive[lCursor] > 0 )
+                    lFan = lCursor;
+                ++lCursor;
+            }
+        }
+
+        ASSERT(lResult.size() == lTriangleCount * 3);
+        std::copy(lResult.begin(), lResult.end(), aIndices.begin() + aFirst);
+    }
+
+    uint32_t MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t>& aIndices, uint32_t aFirst, uint32_t aCount,
+                                             const std::vector<Asset3D::VertexData>& aVertices, float aThreshold)
+    {
+        const uint32_t lTriangleCount = aCount / 3;
+        if ( lTriangleCount == 0 )
+            return 0;
+        const std::vector<uint32_t> lTriangles(aIndices.begin() + aFirst, aIndices.begin() + aFirst + lTriangleCount * 3);
+        FifoCache lCache(static_cast<uint32_t>(aVertices.size()), sCacheSize);
+
+        /* Hard boundaries, a triangle missing the cache on its three vertices starts a
+           disjoint patch, so it can be moved without hurting the cache */
+        std::vector<uint32_t> lHardBoundaries;
+        for ( uint32_t t = 0; t < lTriangleCount; ++t )
+        {
+            if ( lCache.AccessTriangle(&lTriangles[t * 3]) == 3 )
+                lHardBoundaries.push_back(t);
+        }
+        lHardBoundaries.push_back(lTriangleCount);
+
+        /* Soft boundaries, a patch is split where its ACMR so far is within the threshold
+           of the ACMR of the whole patch */
+        std::vector<uint32_t> lBoundaries;
+        for ( size_t h = 0; h + 1 < lHardBoundaries.size(); ++h )
+        {
+            const uint32_t lBegin = lHardBoundaries[h];
+            const uint32_t lEnd = lHardBoundaries[h + 1];
+
+            lCache.Flush();
+            uint32_t lMisses = 0;
+            for ( uint32_t t = lBegin; t < lEnd; ++t )
+                lMisses += lCache.AccessTriangle(&lTriangles[t * 3]);
+            const float lLimit = aThreshold * float(lMisses) / float(lEnd - lBegin);
+
+            lCache.Flush();
+            lBoundaries.push_back(lBegin);
+            uint32_t lRunMisses = 0;
+            uint32_t lRunBegin = lBegin;
+            for ( uint32_t t = lBegin; t < lEnd; ++t )
+            {
+                lRunMisses += lCache.AccessTriangle(&lTriangles[t * 3]);
+                if ( t + 1 < lEnd && float(lRunMisses) / float(t + 1 - lRunBegin) <= lLimit )
+                {
+                    lBoundaries.push_back(t + 1);
+                    lRunBegin = t + 1;
+                    lRunMisses = 0;
+                    lCache.Flush();
+                }
+            }
+        }
+        lBoundaries.push_back(lTriangleCount);
+
+        /* The clusters far from the center and facing out are drawn first */
+        glm::vec3 lMeshCenter(0.0f);
+        for ( uint32_t lIndex : lTriangles )
+            lMeshCenter += aVertices[lIndex].mVertex;
+        lMeshCenter /= float(lTriangles.size());
+
+        std::vector<Cluster> lClusters(lBoundaries.size() - 1);
+        for ( size_t c = 0; c < lClusters.size(); ++c )
+        {
+            Cluster& lCluster = lClusters[c];
+            lCluster.mFirst = lBoundaries[c];
+            lCluster.mCount = lBoundaries[c + 1] - lBoundaries[c];
+
+            glm::vec3 lCenter(0.0f), lNormal(0.0f);
+            float lArea = 0.0f;
+            for ( uint32_t t = lCluster.mFirst; t < lCluster.mFirst + lCluster.mCount; ++t )
+            {
+                const glm::vec3& a = aVertices[lTriangles[t * 3]].mVertex;
+                const glm::vec3& b = aVertices[lTriangles[t * 3 + 1]].mVertex;
+                const glm::vec3& d = aVertices[lTriangles[t * 3 + 2]].mVertex;
+                const glm::vec3 lCross = glm::cross(b - a, d - a);
+                const float lTriangleArea = glm::length(lCross);
+                lCenter += (a + b + d) * (lTriangleArea / 3.0f);
+                lNormal += lCross;
+                lArea += lTriangleArea;
+            }
+            const float lNormalLength = glm::length(lNormal);
+            lCluster.mSortKey = (lArea > 0.0f && lNormalLength > 0.0f) ? glm::dot(lCenter / lArea - lMeshCenter, lNormal / lNormalLength) : 0.0f;
+        }
+        std::stable_sort(lClusters.begin(), lClusters.end(),
+                         [](const Cluster& aLeft, const Cluster& aRight) { return aLeft.mSortKey > aRight.mSortKey; });
+
+        uint32_t lOut = aFirst;
+        for ( const auto& lCluster : lClusters )
+        {
+            std::copy(lTriangles.begin() + lCluster.mFirst * 3, lTriangles.begin() + (lCluster.mFirst + lCluster.mCount) * 3,
+                      aIndices.begin() + lOut);
+            lOut += lCluster.mCount * 3;
+        }
+        return static_cast<uint32_t>(lClusters.size());
+    }
+
+    uint32_t MeshOptimizer::OptimizeVertexFetch(Asset3D& aAsset)
+    {
+        const uint32_t sUnused = 0xFFFFFFFF;
+        std::vector<uint32_t> lRemap(aAsset.mVertexData.size(), sUnused);
+        std::vector<Asset3D::VertexData> lVertices;
+        lVertices.reserve(aAsset.mVertexData.size());
+        for ( uint32_t& lIndex : aAsset.mVertexIndices )
+        {
+            if ( lRemap[lIndex] == sUnused )
+            {
+                lRemap[lIndex] = static_cast<uint32_t>(lVertices.size());
+                lVertices.push_back(aAsset.mVertexData[lIndex]);
+            }
+            lIndex = lRemap[lIndex];
+        }
+        aAsset.mVertexData = std::move(lVertices);
+        return static_cast<uint32_t>(aAsset.mVertexData.size());
+    }
+}
@@ -0,0 +1,119 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Cook time optimization of the geometry of an Asset3D. Every rendering
+ *                list is processed on its own, so the materials keep their ranges:
+ *
+ *                    * Vertex cache: the triangles are reordered with Tipsify (Sander,
+ *                      Nehab and Barczak 2007) so the post-transform cache is reused
+ *                    * Overdraw: the result is cut in clusters at the cache flushes, and
+ *                      the clusters are sorted so the ones facing out of the mesh are
+ *                      drawn first and occlude the rest, as long as the cache efficiency
+ *                      stays within a threshold
+ *                    * Vertex fetch: the vertices are renumbered in the order the indices
+ *                      use them, unused vertices are dropped
+ *                    * Vertex format: optionally a smaller GPU layout, see Asset3D::VertexFormat.
+ *                      The indices are uploaded as 16 bits when the vertices allow it
+ *
+ *                The efficiency is measured as the ACMR (average cache miss ratio, the
+ *                vertices transformed per triangle) of a FIFO cache, so it can be
+ *                tracked per model without a GPU.
+ *******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include "graphic/asset3d.h"
+
+namespace Framework
+{
+    class MeshOptimizer
+    {
+    public:
+        static const uint32_t sCacheSize = 16;  /**< Entries of the simulated post-transform cache */
+
+        struct Options
+        {
+            bool                 mVertexCache = true;
+            bool                 mOverdraw = true;
+            float                mOverdrawThreshold = 1.05f;  /**< Maximum ACMR growth allowed to the overdraw ordering */
+            bool                 mVertexFetch = true;
+            Asset3D::VertexFormat mVertexFormat = Asset3D::VertexFormat::eFLOAT;
+        };
+
+        /**
+         * Efficiency of the geometry of an asset
+         */
+        struct Analysis
+        {
+            float    mACMR = 0.0f;          /**< Transformed vertices per triangle, 0.5 is ideal for a regular grid, 3 is the worst */
+            float    mATVR = 0.0f;          /**< Transformed vertices per vertex, 1 is ideal */
+            uint32_t mVertices = 0;
+            uint32_t mTriangles = 0;
+            uint32_t mVertexBytes = 0;      /**< Bytes of a vertex in the GPU buffer */
+            uint32_t mIndexBytes = 0;       /**< Bytes of an index in the GPU buffer */
+            uint64_t mGeometryBytes = 0;    /**< Bytes of the GPU vertex and index buffers */
+        };
+
+        struct Stats
+        {
+            Analysis mBefore;
+            Analysis mAfter;
+            uint32_t mClusters = 0;         /**< Clusters sorted by the overdraw ordering */
+            double   mTime = 0.0;           /**< Milliseconds */
+        };
+
+        /**
+         * Runs the enabled passes on the asset, it must not be uploaded yet
+         *
+         * @param aAsset    Asset to optimize
+         * @param aOptions  Passes to run
+         *
+         * @return The efficiency before and after the optimization
+         */
+        static Stats Optimize(Asset3D& aAsset, const Options& aOptions);
+        static Stats Optimize(Asset3D& aAsset) { return Optimize(aAsset, Options()); }
+
+        /**
+         * Simulates a FIFO post-transform cache on the indices of the asset
+         */
+        static Analysis Analyze(const Asset3D& aAsset, uint32_t aCacheSize = sCacheSize);
+
+        /**
+         * Reorders the triangles of a range of indices for the vertex cache
+         *
+         * @param aIndices      Triangle list, only [aFirst, aFirst + aCount) is reordered
+         * @param aFirst        First index of the range
+         * @param aCount        Indices of the range, a multiple of 3
+         * @param aVertexCount  Number of vertices addressed by the indices
+         * @param aCacheSize    Entries of the target cache
+         */
+        static void OptimizeVertexCache(std::vector<uint32_t>& aIndices, uint32_t aFirst, uint32_t aCount,
+                                        uint32_t aVertexCount, uint32_t aCacheSize = sCacheSize);
+
+        /**
+         * Sorts the clusters of a cache optimized range of indices to reduce the overdraw
+         *
+         * @param aIndices    Triangle list, only [aFirst, aFirst + aCount) is reordered
+         * @param aFirst      First index of the range
+         * @param aCount      Indices of the range, a multiple of 3
+         * @param aVertices   Vertices addressed by the indices
+         * @param aThreshold  Maximum ACMR growth of a cluster caused by splitting it
+         *
+         * @return Number of clusters
+         */
+        static uint32_t OptimizeOverdraw(std::vector<uint32_t>& aIndices, uint32_t aFirst, uint32_t aCount,
+                                         const std::vector<Asset3D::VertexData>& aVertices, float aThreshold);
+
+        /**
+         * Renumbers the vertices in the order of first use and drops the unused ones
+         *
+         * @return Number of vertices kept
+         */
+        static uint32_t OptimizeVertexFetch(Asset3D& aAsset);
+    };
+}
@@ -0,0 +1,485 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Generation of the levels of detail of an Asset3D
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include <queue>
+#include <unordered_map>
+#include "core/graphic/meshoptimizer.h"
+#include "core/graphic/meshsimplifier.h"
+
+namespace Framework
+{
+    namespace
+    {
+        const double sBorderWeight = 10.0;  /**< Weight of the planes keeping the open borders in place */
+
+        /* Sum of squared distances to a set of weighted planes, as x'Ax + 2b'x + c */
+        struct Quadric
+        {
+            double mA[6] = {};  /**< xx, xy, xz, yy, yz, zz */
+            double mB[3] = {};
+            double mC = 0.0;
+            double mWeight = 0.0;
+
+            void AddPlane(const glm::dvec3& aNormal, double aDistance, double aWeight)
+            {
+                mA[0] += aWeight * aNormal.x * aNormal.x;
+                mA[1] += aWeight * aNormal.x * aNormal.y;
+                mA[2] += aWeight * aNormal.x * aNormal.z;
+                mA[3] += aWeight * aNormal.y * aNormal.y;
+                mA[4] += aWeight * aNormal.y * aNormal.z;
+                mA[5] += aWeight * aNormal.z * aNormal.z;
+                mB[0] += aWeight * aNormal.x * aDistance;
+                mB[1] += aWeight * aNormal.y * aDistance;
+                mB[2] += aWeight * aNormal.z * aDistance;
+                mC += aWeight * aDistance * aDistance;
+                mWeight += aWeight;
+            }
+
+            Quadric& operator+=(const Quadric& aOther)
+            {
+                for ( int i = 0; i < 6; ++i )
+                    mA[i] += aOther.mA[i];
+                for ( int i = 0; i < 3; ++i )
+                    mB[i] += aOther.mB[i];
+                mC += aOther.mC;
+                mWeight += aOther.mWeight;
+                return *this;
+            }
+
+            double Evaluate(const glm::dvec3& p) const
+            {
+                const double lValue = mA[0] * p.x * p.x + 2.0 * mA[1] * p.x * p.y + 2.0 * mA[2] * p.x * p.z +
+                                      mA[3] * p.y * p.y + 2.0 * mA[4] * p.y * p.z + mA[5] * p.z * p.z +
+                                      2.0 * (mB[0] * p.x + mB[1] * p.y + mB[2] * p.z) + mC;
+                return std::max(lValue, 0.0);
+            }
+        };
+
+        struct Collapse
+        {
+            double   mCost;
+            uint32_t mFrom;
+            uint32_t mTo;
+            uint32_t mFromVersion;
+            uint32_t mToVersion;
+
+            bool operator>(const Collapse& aOther) const { return mCost > aOther.mCost; }
+        };
+
+        /* Edge collapse state of an asset, the collapses go on from one level to the next */
+        class Simplifier
+        {
+        public:
+            explicit Simplifier(const Asset3D& aAsset);
+
+            /**
+             * Collapses the cheapest edges until the triangles reach the target or the
+             * cheapest collapse costs more than the given squared relative error
+             */
+            void Run(uint32_t aTargetTriangles, double aMaxCost);
+
+            uint32_t GetTriangles() const { return mLiveTriangles; }
+            double   GetError() const { return std::sqrt(mMaxCost); }
+
+            /**
+             * Indices of the remaining triangles of every rendering list
+             */
+            void Snapshot(std::vector<std::vector<uint32_t>>& aLists) const;
+
+        private:
+            struct Triangle
+            {
+                uint32_t mCorners[3];   /**< Vertices */
+                uint32_t mList;
+            };
+
+            inline uint32_t PositionOf(const Triangle& aTriangle, int aCorner) const { return mPositionOf[aTriangle.mCorners[aCorner]]; }
+            inline bool     HasPosition(const Triangle& aTriangle, uint32_t aPosition) const
+            {
+                return PositionOf(aTriangle, 0) == aPosition || PositionOf(aTriangle, 1) == aPosition || PositionOf(aTriangle, 2) == aPosition;
+            }
+
+            void     Push(uint32_t aFrom, uint32_t aTo);
+            bool     CanCollapse(uint32_t aFrom, uint32_t aTo);
+            void     Apply(uint32_t aFrom, uint32_t aTo);
+            uint32_t ClosestVertex(uint32_t aPosition, uint32_t aVertex) const;
+            void     Neighbors(uint32_t aPosition, std::vector<uint32_t>& aNeighbors) const;
+
+            const std::vector<Asset3D::VertexData>& mVertices;
+            uint32_t                           mListCount;
+            std::vector<uint32_t>              mPositionOf;         /**< Welded position of every vertex */
+            std::vector<glm::dvec3>            mPositions;          /**< Relative to the radius of the asset */
+            std::vector<std::vector<uint32_t>> mPositionVertices;   /**< Vertices sharing every position */
+            std::vector<std::vector<uint32_t>> mPositionTriangles;  /**< Triangles around every position, may hold removed ones */
+            std::vector<Quadric>               mQuadrics;
+            std::vector<uint32_t>              mVersions;           /**< Changes of every position, to drop outdated collapses */
+            std::vector<uint8_t>               mRemovedPositions;
+            std::vector<uint8_t>               mBorder;             /**< On an open border, it can only slide along it */
+            std::vector<uint8_t>               mLocked;             /**< On a non manifold edge, it never moves */
+            std::vector<Triangle>              mTriangles;
+            std::vector<uint8_t>               mRemovedTriangles;
+            uint32_t                           mLiveTriangles = 0;
+            double                             mMaxCost = 0.0;
+            std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> mQueue;
+            std::vector<uint32_t>              mScratchFrom;
+            std::vector<uint32_t>              mScratchTo;
+        };
+
+        Simplifier::Simplifier(const Asset3D& aAsset)
+            : mVertices(aAsset.GetVertexData())
+            , mListCount(static_cast<uint32_t>(aAsset.GetIndicesOffsets().size()))
+        {
+            /* Weld the vertices by position */
+            float lRadius = 0.0f;
+            for ( const auto& lVertex : mVertices )
+                lRadius = std::max(lRadius, glm::length(lVertex.mVertex));
+            const double lScale = lRadius > 0.0f ? 1.0 / lRadius : 1.0;
+
+            struct PositionHash
+            {
+                size_t operator()(const glm::vec3& aPosition) const
+                {
+                    uint32_t lBits[3];
+                    memcpy(lBits, &aPosition, sizeof lBits);
+                    return (lBits[0] * 73856093u) ^ (lBits[1] * 19349663u) ^ (lBits[2] * 83492791u);
+                }
+            };
+            std::unordered_map<glm::vec3, uint32_t, PositionHash> lWelded;
+            lWelded.reserve(mVertices.size());
+            mPositionOf.resize(mVertices.size());
+            for ( uint32_t v = 0; v < mVertices.size(); ++v )
+            {
+                auto lInserted = lWelded.emplace(mVertices[v].mVertex, static_cast<uint32_t>(mPositions.size()));
+                if ( lInserted.second )
+                {
+                    mPositions.push_back(glm::dvec3(mVertices[v].mVertex) * lScale);
+                    mPositionVertices.emplace_back();
+                }
+                mPositionOf[v] = lInserted.first->second;
+                mPositionVertices[mPositionOf[v]].push_back(v);
+            }
+
+            const size_t lPositionCount = mPositions.size();
+            mPositionTriangles.resize(lPositionCount);
+            mQuadrics.resize(lPositionCount);
+            mVersions.resize(lPositionCount, 0);
+            mRemovedPositions.resize(lPositionCount, 0);
+            mBorder.resize(lPositionCount, 0);
+            mLocked.resize(lPositionCount, 0);
+
+            /* Triangles of the full resolution lists, the degenerated ones are dropped */
+            const auto& lIndices = aAsset.GetIndexData();
+            for ( uint32_t l = 0; l < mListCount; ++l )
+            {
+                const uint32_t lFirst = aAsset.GetIndicesOffsets()[l];
+                const uint32_t lEnd = lFirst + aAsset.GetIndicesCount()[l];
+                for ( uint32_t i = lFirst; i + 2 < lEnd; i += 3 )
+                {
+                    Triangle lTriangle = { { lIndices[i], lIndices[i + 1], lIndices[i + 2] }, l };
+                    const uint32_t p0 = PositionOf(lTriangle, 0), p1 = PositionOf(lTriangle, 1), p2 = PositionOf(lTriangle, 2);
+                    if ( p0 == p1 || p1 == p2 || p0 == p2 )
+                        continue;
+                    const uint32_t lTriangleIndex = static_cast<uint32_t>(mTriangles.size());
+                    mTriangles.push_back(lTriangle);
+                    mPositionTriangles[p0].push_back(lTriangleIndex);
+                    mPositionTriangles[p1].push_back(lTriangleIndex);
+                    mPositionTriangles[p2].push_back(lTriangleIndex);
+
+                    /* Area weighted plane of the triangle */
+                    const glm::dvec3 lCross = glm::cross(mPositions[p1] - mPositions[p0], mPositions[p2] - mPositions[p0]);
+                    const double lLength = glm::length(lCross);
+                    if ( lLength > 0.0 )
+                    {
+                        const glm::dvec3 lNormal = lCross / lLength;
+                        const double lDistance = -glm::dot(lNormal, mPositions[p0]);
+                        for ( uint32_t p : { p0, p1, p2 } )
+                            mQuadrics[p].AddPlane(lNormal, lDistance, lLength * 0.5);
+                    }
+                }
+            }
+            mRemovedTriangles.resize(mTriangles.size(), 0);
+            mLiveTriangles = static_cast<uint32_t>(mTriangles.size());
+
+            /* Edges used by one triangle are open borders, kept in place by a plane
+               perpendicular to the triangle. Edges used by more than two are locked */
+            std::unordered_map<uint64_t, uint32_t> lEdgeUses;
+            lEdgeUses.reserve(mTriangles.size() * 3);
+            auto lEdgeKey = [](uint32_t a, uint32_t b) { return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a; };
+            for ( const auto& lTriangle : mTriangles )
+            {
+                for ( int c = 0; c < 3; ++c )
+                    ++lEdgeUses[lEdgeKey(PositionOf(lTriangle, c), PositionOf(lTriangle, (c + 1) % 3))];
+            }
+            for ( const auto& lTriangle : mTriangles )
+            {
+                const glm::dvec3 lNormal = glm::cross(mPositions[PositionOf(lTriangle, 1)] - mPositions[PositionOf(lTriangle, 0)],
+                                                      mPositions[PositionOf(lTriangle, 2)] - mPositions[PositionOf(lTriangle, 0)]);
+                for ( int c = 0; c < 3; ++c )
+                {
+                    const uint32_t a = PositionOf(lTriangle, c), b = PositionOf(lTriangle, (c + 1) % 3);
+                    const uint32_t lUses = lEdgeUses[lEdgeKey(a, b)];
+                    if ( lUses > 2 )
+                        mLocked[a] = mLocked[b] = 1;
+                    if ( lUses != 1 )
+                        continue;
+                    mBorder[a] = mBorder[b] = 1;
+                    const glm::dvec3 lEdge = mPositions[b] - mPositions[a];
+                    const glm::dvec3 lPlane = glm::cross(lEdge, lNormal);
+                    const double lLength = glm::length(lPlane);
+                    if ( lLength > 0.0 )
+                    {
+                        const glm::dvec3 lPlaneNormal = lPlane / lLength;
+                        const double lDistance = -glm::dot(lPlaneNormal, mPositions[a]);
+                        const double lWeight = glm::dot(lEdge, lEdge) * sBorderWeight;
+                        mQuadrics[a].AddPlane(lPlaneNormal, lDistance, lWeight);
+                        mQuadrics[b].AddPlane(lPlaneNormal, lDistance, lWeight);
+                    }
+                }
+            }
+
+            for ( const auto& lTriangle : mTriangles )
+            {
+                for ( int c = 0; c < 3; ++c )
+                {
+                    const uint32_t a = PositionOf(lTriangle, c), b = PositionOf(lTriangle, (c + 1) % 3);
+                    if ( a < b )
+                    {
+                        Push(a, b);
+                        Push(b, a);
+                    }
+                }
+            }
+        }
+
+        void Simplifier::Push(uint32_t aFrom, uint32_t aTo)
+        {
+            if ( mLocked[aFrom] || (mBorder[aFrom] && !mBorder[aTo]) )
+                return;
+            Quadric lQuadric = mQuadrics[aFrom];
+            lQuadric += mQuadrics[aTo];
+            const double lCost = lQuadric.mWeight > 0.0 ? lQuadric.Evaluate(mPositions[aTo]) / lQuadric.mWeight : 0.0;
+            mQueue.push(Collapse{ lCost, aFrom, aTo, mVersions[aFrom], mVersions[aTo] });
+        }
+
+        void Simplifier::Run(uint32_t aTargetTriangles, double aMaxCost)
+        {
+            while ( mLiveTriangles > aTargetTriangles && !mQueue.empty() )
+            {
+                const Collapse lCollapse = mQueue.top();
+                if ( lCollapse.mCost > aMaxCost )
+                    break;
+                mQueue.pop();
+                if ( mRemovedPositions[lCollapse.mFrom] || mRemovedPositions[lCollapse.mTo] ||
+                     mVersions[lCollapse.mFrom] != lCollapse.mFromVersion || mVersions[lCollapse.mTo] != lCollapse.mToVersion )
+                    continue;
+                if ( !CanCollapse(lCollapse.mFrom, lCollapse.mTo) )
+                    continue;
+                Apply(lCollapse.mFrom, lCollapse.mTo);
+                mMaxCost = std::max(mMaxCost, lCollapse.mCost);
+            }
+        }
+
+        void Simplifier::Neighbors(uint32_t aPosition, std::vector<uint32_t>& aNeighbors) const
+        {
+            aNeighbors.clear();
+            for ( uint32_t t : mPositionTriangles[aPosition] )
+            {
+                if ( mRemovedTriangles[t] )
+                    continue;
+                for ( int c = 0; c < 3; ++c )
+                {
+                    const uint32_t p = PositionOf(mTriangles[t], c);
+                    if ( p != aPosition )
+                        aNeighbors.push_back(p);
+                }
+            }
+            std::sort(aNeighbors.begin(), aNeighbors.end());
+            aNeighbors.erase(std::unique(aNeighbors.begin(), aNeighbors.end()), aNeighbors.end());
+        }
+
+        bool Simplifier::CanCollapse(uint32_t aFrom, uint32_t aTo)
+        {
+            uint32_t lShared = 0;
+            for ( uint32_t t : mPositionTriangles[aFrom] )
+            {
+                if ( mRemovedTriangles[t] )
+                    continue;
+                const Triangle& lTriangle = mTriangles[t];
+                if ( HasPosition(lTriangle, aTo) )
+                {
+                    ++lShared;
+                    continue;
+                }
+
+                /* The triangles that stay must not flip nor collapse */
+                glm::dvec3 lOld[3], lNew[3];
+                for ( int c = 0; c < 3; ++c )
+                {
+                    const uint32_t p = PositionOf(lTriangle, c);
+                    lOld[c] = mPositions[p];
+                    lNew[c] = p == aFrom ? mPositions[aTo] : lOld[c];
+                }
+                const glm::dvec3 lOldNormal = glm::cross(lOld[1] - lOld[0], lOld[2] - lOld[0]);
+                const glm::dvec3 lNewNormal = glm::cross(lNew[1] - lNew[0], lNew[2] - lNew[0]);
+                const double lNewArea = glm::dot(lNewNormal, lNewNormal);
+                if ( lNewArea <= 1e-24 || glm::dot(lOldNormal, lNewNormal) <= 0.2 * std::sqrt(glm::dot(lOldNormal, lOldNormal) * lNewArea) )
+                    return false;
+            }
+
+            /* An edge of a manifold has one or two triangles, and an open border edge can
+               only collapse along the border */
+            if ( lShared == 0 || lShared > 2 || (mBorder[aFrom] && lShared != 1) )
+                return false;
+
+            /* Link condition, the only neighbors in common are the opposite corners of
+               the collapsed triangles, otherwise the surface would pinch */
+            Neighbors(aFrom, mScratchFrom);
+            Neighbors(aTo, mScratchTo);
+            uint32_t lCommon = 0;
+            for ( size_t i = 0, j = 0; i < mScratchFrom.size() && j < mScratchTo.size(); )
+            {
+                if ( mScratchFrom[i] < mScratchTo[j] )
+                    ++i;
+                else if ( mScratchFrom[i] > mScratchTo[j] )
+                    ++j;
+                else
+                {
+                    ++lCommon;
+                    ++i;
+                    ++j;
+                }
+            }
+            return lCommon == lShared;
+        }
+
+        uint32_t Simplifier::ClosestVertex(uint32_t aPosition, uint32_t aVertex) const
+        {
+            const auto& lReference = mVertices[aVertex];
+            uint32_t lBest = mPositionVertices[aPosition].front();
+            float lBestDistance = std::numeric_limits<float>::max();
+            for ( uint32_t v : mPositionVertices[aPosition] )
+            {
+                const glm::vec3 lNormal = mVertices[v].mNormal - lReference.mNormal;
+                const glm::vec2 lUV = mVertices[v].mUVCoord - lReference.mUVCoord;
+                const float lDistance = glm::dot(lNormal, lNormal) + glm::dot(lUV, lUV);
+                if ( lDistance < lBestDistance )
+                {
+                    lBestDistance = lDistance;
+                    lBest = v;
+                }
+            }
+            return lBest;
+        }
+
+        void Simplifier::Apply(uint32_t aFrom, uint32_t aTo)
+        {
+            for ( uint32_t t : mPositionTriangles[aFrom] )
+            {
+                if ( mRemovedTriangles[t] )
+                    continue;
+                Triangle& lTriangle = mTriangles[t];
+                if ( HasPosition(lTriangle, aTo) )
+                {
+                    mRemovedTriangles[t] = 1;
+                    --mLiveTriangles;
+                    continue;
+                }
+                for ( int c = 0; c < 3; ++c )
+                {
+                    if ( PositionOf(lTriangle, c) == aFrom )
+                        lTriangle.mCorners[c] = ClosestVertex(aTo, lTriangle.mCorners[c]);
+                }
+                mPositionTriangles[aTo].push_back(t);
+            }
+
+            mQuadrics[aTo] += mQuadrics[aFrom];
+            mRemovedPositions[aFrom] = 1;
+            mPositionTriangles[aFrom].clear();
+            ++mVersions[aTo];
+
+            auto& lTriangles = mPositionTriangles[aTo];
+            lTriangles.erase(std::remove_if(lTriangles.begin(), lTriangles.end(), [this](uint32_t t) { return mRemovedTriangles[t] != 0; }),
+                             lTriangles.end());
+
+            Neighbors(aTo, mScratchTo);
+            for ( uint32_t p : mScratchTo )
+            {
+                Push(p, aTo);
+                Push(aTo, p);
+            }
+        }
+
+        void Simplifier::Snapshot(std::vector<std::vector<uint32_t>>& aLists) const
+        {
+            aLists.assign(mListCount, std::vector<uint32_t>());
+            for ( size_t t = 0; t < mTriangles.size(); ++t )
+            {
+                if ( mRemovedTriangles[t] )
+                    continue;
+                const Triangle& lTriangle = mTriangles[t];
+                aLists[lTriangle.mList].insert(aLists[lTriangle.mList].end(), lTriangle.mCorners, lTriangle.mCorners + 3);
+            }
+        }
+    }
+
+    uint32_t MeshSimplifier::GenerateLods(Asset3D& aAsset, const Options& aOptions)
+    {
+        ASSERT(!aAsset.mRendererResources);
+
+        /* The indices of the previous levels follow the full resolution ones */
+        uint32_t lFullEnd = 0;
+        for ( size_t i = 0; i < aAsset.mIndicesOffsets.size(); ++i )
+            lFullEnd = std::max(lFullEnd, aAsset.mIndicesOffsets[i] + aAsset.mIndicesCount[i]);
+        if ( !aAsset.mLods.empty() )
+        {
+            aAsset.mVertexIndices.resize(lFullEnd);
+            aAsset.mLods.clear();
+        }
+        if ( aAsset.mVertexData.empty() || lFullEnd == 0 )
+            return 0;
+
+        Simplifier lSimplifier(aAsset);
+        const double lMaxCost = double(aOptions.mMaxError) * aOptions.mMaxError;
+        const uint32_t lVertexCount = static_cast<uint32_t>(aAsset.mVertexData.size());
+        uint32_t lPrevious = lSimplifier.GetTriangles();
+        std::vector<std::vector<uint32_t>> lLists;
+        while ( aAsset.mLods.size() < aOptions.mMaxLevels )
+        {
+            const uint32_t lTarget = std::max(aOptions.mMinTriangles, static_cast<uint32_t>(lPrevious * aOptions.mRatio));
+            if ( lTarget >= lPrevious )
+                break;
+            lSimplifier.Run(lTarget, lMaxCost);
+
+            /* A level with less than half of the expected reduction is not worth its indices */
+            const uint32_t lTriangles = lSimplifier.GetTriangles();
+            if ( lPrevious - lTriangles < (lPrevious - lTarget) / 2 )
+                break;
+
+            Asset3D::LevelOfDetail lLod;
+            lLod.mError = static_cast<float>(lSimplifier.GetError());
+            lSimplifier.Snapshot(lLists);
+            for ( const auto& lList : lLists )
+            {
+                const uint32_t lOffset = static_cast<uint32_t>(aAsset.mVertexIndices.size());
+                const uint32_t lCount = static_cast<uint32_t>(lList.size());
+                aAsset.mVertexIndices.insert(aAsset.mVertexIndices.end(), lList.begin(), lList.end());
+                MeshOptimizer::OptimizeVertexCache(aAsset.mVertexIndices, lOffset, lCount, lVertexCount);
+                lLod.mIndicesOffsets.push_back(lOffset);
+                lLod.mIndicesCount.push_back(lCount);
+            }
+            aAsset.mLods.push_back(std::move(lLod));
+            lPrevious = lTriangles;
+        }
+
+        INFO(LogLevel::eLEVEL2, "Generated %zu levels of detail for %s, %u triangles at the coarsest",
+             aAsset.mLods.size(), aAsset.GetName().c_str(), aAsset.GetTriangleCount(aAsset.GetLodCount() - 1));
+        return static_cast<uint32_t>(aAsset.mLods.size());
+    }
+}
@@ -0,0 +1,52 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Generation of the levels of detail of an Asset3D by quadric error
+ *                edge collapses (Garland and Heckbert 1997).
+ *
+ *                The vertices are welded by position, so the UV seams and the hard
+ *                edges do not block the simplification. An edge collapse moves one
+ *                position onto the other one (half-edge collapse), so no vertex is
+ *                created and all the levels share the vertex buffer of the asset,
+ *                only indices are added. The corners of the moved position take the
+ *                vertex of the kept position with the closest normal and UV.
+ *
+ *                A collapse is rejected when it flips a triangle, breaks the manifold
+ *                or moves an open border, and the collapses go on from the previous
+ *                level, so the levels are nested.
+ *******************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include "graphic/asset3d.h"
+
+namespace Framework
+{
+    class MeshSimplifier
+    {
+    public:
+        struct Options
+        {
+            uint32_t mMaxLevels = 4;        /**< Levels generated besides the full resolution */
+            float    mRatio = 0.5f;         /**< Triangles of a level relative to the previous one */
+            float    mMaxError = 0.05f;     /**< Largest error of a level, relative to the radius of the asset */
+            uint32_t mMinTriangles = 32;    /**< No level is made with fewer triangles */
+        };
+
+        /**
+         * Replaces the levels of detail of an asset, it must not be uploaded yet.
+         * The indices of every level are ordered for the vertex cache
+         *
+         * @param aAsset    Asset to simplify
+         * @param aOptions  Number and size of the levels
+         *
+         * @return Number of levels of detail generated
+         */
+        static uint32_t GenerateLods(Asset3D& aAsset, const Options& aOptions);
+        static uint32_t GenerateLods(Asset3D& aAsset) { return GenerateLods(aAsset, Options()); }
+    };
+}
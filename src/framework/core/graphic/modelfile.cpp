@@ -0,0 +1,214 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Chunked binary .model format
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include <fstream>
+#include "zlib.h"
+#include "core/graphic/modelfile.h"
+
+namespace Framework
+{
+    namespace
+    {
+        const char* CompressionName(uint16_t aCompression)
+        {
+            switch ( static_cast<ModelFile::Compression>(aCompression) )
+            {
+                case ModelFile::Compression::eNONE: return "none";
+                case ModelFile::Compression::eZLIB: return "zlib";
+                case ModelFile::Compression::eLZ4:  return "lz4";
+                case ModelFile::Compression::eZSTD: return "zstd";
+            }
+            return "unknown";
+        }
+
+        uint64_t Align(uint64_t aOffset)
+        {
+            return (aOffset + ModelFile::sAlignment - 1) & ~uint64_t(ModelFile::sAlignment - 1);
+        }
+    }
+
+    bool ModelFile::IsModelFile(const std::string& aFileName)
+    {
+        std::ifstream lFile(aFileName, std::ios::binary | std::ios::in);
+        uint32_t lMagic = 0;
+        lFile.read(reinterpret_cast<char*>(&lMagic), sizeof(lMagic));
+        return lFile.good() && lMagic == sMagic;
+    }
+
+    bool ModelFile::ReadHeader(const std::string& aFileName, Header& aHeader)
+    {
+        std::ifstream lFile(aFileName, std::ios::binary | std::ios::in);
+        lFile.read(reinterpret_cast<char*>(&aHeader), sizeof(aHeader));
+        return lFile.good() && aHeader.mMagic == sMagic && aHeader.mVersion <= sVersion;
+    }
+
+    bool ModelFile::Open(const std::string& aFileName)
+    {
+        Close();
+        if ( !mFile.Open(aFileName) )
+        {
+            WARNING("Cannot map the model file %s", aFileName.c_str());
+            return false;
+        }
+        if ( mFile.GetSize() < sizeof(Header) )
+        {
+            WARNING("Model file %s is truncated", aFileName.c_str());
+            Close();
+            return false;
+        }
+        memcpy(&mHeader, mFile.GetData(), sizeof(Header));
+        if ( mHeader.mMagic != sMagic || mHeader.mVersion > sVersion )
+        {
+            WARNING("Model file %s has an unsupported version %u", aFileName.c_str(), mHeader.mVersion);
+            Close();
+            return false;
+        }
+        const uint64_t lTableEnd = uint64_t(mHeader.mChunkTableOffset) + uint64_t(mHeader.mChunkCount) * sizeof(Chunk);
+        if ( lTableEnd > mFile.GetSize() )
+        {
+            WARNING("Model file %s has a corrupt chunk table", aFileName.c_str());
+            Close();
+            return false;
+        }
+        mChunks.resize(mHeader.mChunkCount);
+        memcpy(mChunks.data(), mFile.GetData() + mHeader.mChunkTableOffset, mChunks.size() * sizeof(Chunk));
+        for ( const Chunk& lChunk : mChunks )
+        {
+            if ( lChunk.mOffset + lChunk.mSize > mFile.GetSize() || lChunk.mOffset % sAlignment != 0 )
+            {
+                WARNING("Model file %s has a corrupt chunk", aFileName.c_str());
+                Close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void ModelFile::Close()
+    {
+        mFile.Close();
+        mChunks.clear();
+        mHeader = Header();
+    }
+
+    const ModelFile::Chunk* ModelFile::FindChunk(uint32_t aType) const
+    {
+        for ( const Chunk& lChunk : mChunks )
+            if ( lChunk.mType == aType )
+                return &lChunk;
+        return nullptr;
+    }
+
+    bool ModelFile::ReadChunk(const Chunk& aChunk, void* aData) const
+    {
+        const uint8_t* lStored = GetChunkData(aChunk);
+        switch ( static_cast<Compression>(aChunk.mCompression) )
+        {
+            case Compression::eNONE:
+                ASSERT(aChunk.mSize == aChunk.mRawSize);
+                memcpy(aData, lStored, aChunk.mRawSize);
+                return true;
+            case Compression::eZLIB:
+            {
+                uLongf lSize = static_cast<uLongf>(aChunk.mRawSize);
+                if ( uncompress(static_cast<Bytef*>(aData), &lSize, lStored, static_cast<uLong>(aChunk.mSize)) != Z_OK ||
+                     lSize != aChunk.mRawSize )
+                {
+                    WARNING("ERROR inflating a model chunk");
+                    return false;
+                }
+                return true;
+            }
+            default:
+                WARNING("Model chunk compressed with %s, which is not available in this build", CompressionName(aChunk.mCompression));
+                return false;
+        }
+    }
+
+    void ModelFileWriter::AddChunk(uint32_t aType, const void* aData, uint64_t aSize, uint32_t aCount,
+                                   ModelFile::Compression aCompression)
+    {
+        ModelFile::Chunk lChunk = {};
+        lChunk.mType = aType;
+        lChunk.mCount = aCount;
+        lChunk.mRawSize = aSize;
+
+        std::vector<uint8_t> lData;
+        if ( aCompression == ModelFile::Compression::eZLIB && aSize )
+        {
+            uLongf lSize = compressBound(static_cast<uLong>(aSize));
+            lData.resize(lSize);
+            if ( compress2(lData.data(), &lSize, static_cast<const Bytef*>(aData), static_cast<uLong>(aSize), Z_DEFAULT_COMPRESSION) == Z_OK &&
+                 lSize < aSize )
+            {
+                lData.resize(lSize);
+                lChunk.mCompression = static_cast<uint16_t>(ModelFile::Compression::eZLIB);
+            }
+            else
+            {
+                lData.clear();
+            }
+        }
+        else if ( aCompression != ModelFile::Compression::eNONE )
+        {
+            WARNING("%s compression is not available in this build, the chunk is stored uncompressed",
+                    CompressionName(static_cast<uint16_t>(aCompression)));
+        }
+
+        if ( lChunk.mCompression == static_cast<uint16_t>(ModelFile::Compression::eNONE) )
+            lData.assign(static_cast<const uint8_t*>(aData), static_cast<const uint8_t*>(aData) + aSize);
+        lChunk.mSize = lData.size();
+        mChunks.push_back(lChunk);
+        mData.push_back(std::move(lData));
+    }
+
+    bool ModelFileWriter::Write(const std::string& aFileName, ModelFile::Header aHeader) const
+    {
+        std::ofstream lFile(aFileName, std::ios::binary | std::ios::out | std::ios::trunc);
+        if ( !lFile.is_open() )
+        {
+            WARNING("ERROR opening file %s", aFileName.c_str());
+            return false;
+        }
+
+        // Lay out the chunks after the header, each one on an aligned offset
+        std::vector<ModelFile::Chunk> lChunks = mChunks;
+        uint64_t lOffset = Align(sizeof(ModelFile::Header));
+        for ( auto& lChunk : lChunks )
+        {
+            lChunk.mOffset = lOffset;
+            lOffset = Align(lOffset + lChunk.mSize);
+        }
+
+        aHeader.mMagic = ModelFile::sMagic;
+        aHeader.mVersion = ModelFile::sVersion;
+        aHeader.mChunkCount = static_cast<uint32_t>(lChunks.size());
+        aHeader.mChunkTableOffset = static_cast<uint32_t>(lOffset);
+        lFile.write(reinterpret_cast<const char*>(&aHeader), sizeof(aHeader));
+
+        static const char sPadding[ModelFile::sAlignment] = {};
+        uint64_t lPosition = sizeof(aHeader);
+        for ( size_t i = 0; i < lChunks.size(); ++i )
+        {
+            lFile.write(sPadding, static_cast<std::streamsize>(lChunks[i].mOffset - lPosition));
+            lFile.write(reinterpret_cast<const char*>(mData[i].data()), static_cast<std::streamsize>(mData[i].size()));
+            lPosition = lChunks[i].mOffset + lChunks[i].mSize;
+        }
+        lFile.write(sPadding, static_cast<std::streamsize>(lOffset - lPosition));
+        lFile.write(reinterpret_cast<const char*>(lChunks.data()), static_cast<std::streamsize>(lChunks.size() * sizeof(ModelFile::Chunk)));
+
+        if ( lFile.bad() )
+        {
+            WARNING("ERROR writing data to file %s", aFileName.c_str());
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,197 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Chunked binary .model format. The file starts with a fixed size
+ *                header holding the version and the precomputed bounds of the model,
+ *                followed by the chunks and, at the end, the chunk table:
+ *
+ *                    | header 64 | chunk | chunk | ... | chunk table |
+ *
+ *                Every chunk starts at a 64 byte aligned offset, so an uncompressed
+ *                vertex or index chunk can be used straight from the memory mapped
+ *                file, for example as the source of a GPU buffer upload. A chunk can
+ *                also be compressed on its own, the others stay mappable. The header
+ *                alone answers bounds queries without reading the rest of the file.
+ *
+ *                The files written before this format are a single zlib stream,
+ *                they never start with the magic number so both can be told apart.
+ *******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "core/mappedfile.h"
+
+namespace Framework
+{
+    class ModelFile
+    {
+    public:
+        static const uint32_t sMagic = 0x4C444D49;  /**< "IMDL" read as a little endian uint32 */
+        static const uint16_t sVersion = 1;
+        static const uint32_t sAlignment = 64;       /**< Alignment of the chunks in the file */
+
+        enum class Compression : uint16_t
+        {
+            eNONE = 0,
+            eZLIB = 1,
+            eLZ4  = 2,      /**< Reserved, no codec in this build */
+            eZSTD = 3       /**< Reserved, no codec in this build */
+        };
+
+        enum ChunkType : uint32_t
+        {
+            eCHUNK_VERTICES        = 0x54524556,  /**< "VERT" Asset3D::VertexData array */
+            eCHUNK_INDICES         = 0x58444E49,  /**< "INDX" uint32_t array */
+            eCHUNK_LIST_OFFSETS    = 0x46464F4C,  /**< "LOFF" uint32_t array, first index of each rendering list */
+            eCHUNK_LIST_COUNTS     = 0x544E434C,  /**< "LCNT" uint32_t array, indices of each rendering list */
+            eCHUNK_MATERIALS       = 0x4C54414D,  /**< "MATL" Material array */
+            eCHUNK_TEXTURES        = 0x53584554,  /**< "TEXS" per texture a TextureHeader and its pixels */
+            eCHUNK_COOKED_TEXTURES = 0x58455443,  /**< "CTEX" per texture a CookedTextureHeader and its levels, replaces "TEXS" */
+            eCHUNK_LODS            = 0x53444F4C   /**< "LODS" per level the float error, then the offsets and the counts of every rendering list */
+        };
+
+        enum Flags : uint16_t
+        {
+            eFLAG_VERTEX_FORMAT_MASK = 0x000F   /**< Asset3D::VertexFormat of the GPU buffer, the stored vertices are always floats */
+        };
+
+        struct Header
+        {
+            uint32_t mMagic = sMagic;
+            uint16_t mVersion = sVersion;
+            uint16_t mFlags = 0;
+            uint32_t mChunkCount = 0;
+            uint32_t mChunkTableOffset = 0;
+            float    mBoundsMin[3] = { 0.0f, 0.0f, 0.0f };
+            float    mBoundsMax[3] = { 0.0f, 0.0f, 0.0f };
+            float    mMaxLengthVertex[3] = { 0.0f, 0.0f, 0.0f };
+            uint32_t mVertexCount = 0;
+            uint32_t mIndexCount = 0;
+            uint32_t mRenderListCount = 0;
+        };
+        static_assert(sizeof(Header) == 64, "The model file header must take 64 bytes");
+
+        struct Chunk
+        {
+            uint32_t mType;
+            uint16_t mCompression;  /**< Compression of the stored bytes */
+            uint16_t mReserved;
+            uint32_t mCount;        /**< Number of elements */
+            uint32_t mReserved2;
+            uint64_t mOffset;       /**< From the start of the file */
+            uint64_t mSize;         /**< Stored bytes */
+            uint64_t mRawSize;      /**< Bytes once decompressed */
+        };
+        static_assert(sizeof(Chunk) == 40, "The model file chunk entry must take 40 bytes");
+
+        struct TextureHeader
+        {
+            uint32_t mWidth;
+            uint32_t mHeight;
+            uint32_t mBytesPerPixel;
+            uint32_t mFormat;
+            uint32_t mType;
+        };
+
+        struct CookedTextureHeader
+        {
+            uint32_t mWidth;
+            uint32_t mHeight;
+            uint32_t mBytesPerPixel;
+            uint32_t mFormat;
+            uint32_t mType;
+            uint32_t mCompression;  /**< Texture::Compression */
+            uint32_t mMipLevels;
+            uint32_t mReserved;
+            uint64_t mDataSize;     /**< Bytes of all the levels */
+        };
+        static_assert(sizeof(CookedTextureHeader) == 40, "The cooked texture header must take 40 bytes");
+
+        /**
+         * Checks the magic number of a file
+         *
+         * @return true if the file is in this format, false if it is an old zlib file or cannot be read
+         */
+        static bool IsModelFile(const std::string& aFileName);
+
+        /**
+         * Reads only the header of a file, enough for a bounds query
+         *
+         * @return true if the header was read and its version is supported
+         */
+        static bool ReadHeader(const std::string& aFileName, Header& aHeader);
+
+        /**
+         * Maps a file and validates its header and chunk table
+         *
+         * @return true if the file can be read
+         */
+        bool Open(const std::string& aFileName);
+        void Close();
+
+        const Header& GetHeader() const { return mHeader; }
+
+        /**
+         * @return The first chunk of the given type, or nullptr if the file has none
+         */
+        const Chunk* FindChunk(uint32_t aType) const;
+
+        /**
+         * Stored bytes of a chunk inside the mapped file. They can be used directly when
+         * the chunk is not compressed, the pointer is valid until the file is closed
+         */
+        const uint8_t* GetChunkData(const Chunk& aChunk) const { return mFile.GetData() + aChunk.mOffset; }
+
+        /**
+         * Copies a chunk, decompressing it if needed
+         *
+         * @param aChunk  Chunk to read
+         * @param aData   Destination of mRawSize bytes
+         *
+         * @return true if the chunk was read correctly
+         */
+        bool ReadChunk(const Chunk& aChunk, void* aData) const;
+
+    private:
+        MappedFile         mFile;
+        Header             mHeader;
+        std::vector<Chunk> mChunks;
+    };
+
+    class ModelFileWriter
+    {
+    public:
+        /**
+         * Adds a chunk to the file. The data is copied, and compressed if requested.
+         * A compressed chunk that is not smaller than the raw one is stored as is
+         *
+         * @param aType         Chunk type
+         * @param aData         Raw bytes of the chunk
+         * @param aSize         Number of bytes
+         * @param aCount        Number of elements
+         * @param aCompression  Requested compression
+         */
+        void AddChunk(uint32_t aType, const void* aData, uint64_t aSize, uint32_t aCount,
+                      ModelFile::Compression aCompression = ModelFile::Compression::eNONE);
+
+        /**
+         * Writes the header, the chunks and the chunk table
+         *
+         * @param aFileName  Output file
+         * @param aHeader    Bounds and counts of the model, the rest is filled by the writer
+         *
+         * @return true if the file was written correctly
+         */
+        bool Write(const std::string& aFileName, ModelFile::Header aHeader) const;
+
+    private:
+        std::vector<ModelFile::Chunk>      mChunks;
+        std::vector<std::vector<uint8_t>>  mData;
+    };
+}
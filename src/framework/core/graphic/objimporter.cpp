@@ -0,0 +1,554 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Multithreaded OBJ importer
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include <array>
+#include <chrono>
+#include <unordered_map>
+#include "core/mappedfile.h"
+#include "core/graphic/asset3dloaders.h"
+#include "core/graphic/objimporter.h"
+
+namespace Framework
+{
+    namespace
+    {
+        const size_t sMinChunkSize = 1 << 20;   /**< Smaller pieces of a file are not worth a thread */
+
+        /* A triangle corner with the 0 based position, uv and normal indices, -1 for a
+           missing uv or normal. The indices written as negative numbers in the file are
+           relative to the vertices parsed so far, so they are local to the chunk until
+           the number of vertices of the previous chunks is known */
+        struct Corner
+        {
+            int32_t mIndex[3];
+            uint8_t mLocal;     /**< Bit per index that is still local to the chunk */
+
+            bool operator==(const Corner& aOther) const
+            {
+                return mIndex[0] == aOther.mIndex[0] && mIndex[1] == aOther.mIndex[1] && mIndex[2] == aOther.mIndex[2];
+            }
+        };
+
+        struct CornerHash
+        {
+            size_t operator()(const Corner& aCorner) const
+            {
+                uint64_t lHash = uint64_t(uint32_t(aCorner.mIndex[0])) * 0x9E3779B97F4A7C15ull;
+                lHash ^= uint64_t(uint32_t(aCorner.mIndex[1])) * 0xC2B2AE3D27D4EB4Full;
+                lHash ^= uint64_t(uint32_t(aCorner.mIndex[2])) * 0x165667B19E3779F9ull;
+                return static_cast<size_t>(lHash ^ (lHash >> 29));
+            }
+        };
+
+        /* Material switch inside a chunk */
+        struct Group
+        {
+            std::string mMaterial;
+            uint32_t    mFirstCorner;
+        };
+
+        struct Chunk
+        {
+            const char*              mBegin = nullptr;
+            const char*              mEnd = nullptr;
+            std::vector<glm::vec3>   mPositions;
+            std::vector<glm::vec2>   mTexCoords;
+            std::vector<glm::vec3>   mNormals;
+            std::vector<Corner>      mCorners;      /**< 3 per triangle */
+            std::vector<Group>       mGroups;
+            std::vector<std::string> mLibraries;
+            uint32_t                 mPolygons = 0;
+            const char*              mError = nullptr; /**< First malformed line */
+        };
+
+        /* Run of triangles of a material */
+        struct Run
+        {
+            uint32_t mChunk;
+            uint32_t mBegin;
+            uint32_t mEnd;
+        };
+
+        inline bool IsSpace(char aChar)
+        {
+            return aChar == ' ' || aChar == '\t' || aChar == '\r';
+        }
+
+        inline const char* SkipSpaces(const char* aBegin, const char* aEnd)
+        {
+            while ( aBegin < aEnd && IsSpace(*aBegin) )
+                ++aBegin;
+            return aBegin;
+        }
+
+        inline bool StartsWith(const char* aBegin, const char* aEnd, const char* aKeyword, size_t aLength)
+        {
+            return size_t(aEnd - aBegin) > aLength && memcmp(aBegin, aKeyword, aLength) == 0 && IsSpace(aBegin[aLength]);
+        }
+
+        std::string Trimmed(const char* aBegin, const char* aEnd)
+        {
+            aBegin = SkipSpaces(aBegin, aEnd);
+            while ( aEnd > aBegin && IsSpace(aEnd[-1]) )
+                --aEnd;
+            return std::string(aBegin, aEnd);
+        }
+
+        inline const char* ParseInt(const char* aBegin, const char* aEnd, int32_t& aValue)
+        {
+            const char* p = aBegin;
+            const bool lNegative = p < aEnd && *p == '-';
+            if ( p < aEnd && (*p == '-' || *p == '+') )
+                ++p;
+            const char* lDigits = p;
+            int64_t lValue = 0;
+            while ( p < aEnd && *p >= '0' && *p <= '9' && lValue <= INT32_MAX )
+                lValue = lValue * 10 + (*p++ - '0');
+            if ( p == lDigits || lValue > INT32_MAX )
+                return aBegin;
+            aValue = static_cast<int32_t>(lNegative ? -lValue : lValue);
+            return p;
+        }
+
+        bool ParseFloats(const char*& aBegin, const char* aEnd, float* aValues, uint32_t aCount)
+        {
+            for ( uint32_t i = 0; i < aCount; ++i )
+            {
+                const char* p = SkipSpaces(aBegin, aEnd);
+                const char* lNext = ObjImporter::ParseFloat(p, aEnd, aValues[i]);
+                if ( lNext == p )
+                    return false;
+                aBegin = lNext;
+            }
+            return true;
+        }
+
+        bool ParseFace(Chunk& aChunk, const char* p, const char* aEnd, std::vector<Corner>& aPolygon)
+        {
+            const uint32_t lCounts[3] = { static_cast<uint32_t>(aChunk.mPositions.size()),
+                                          static_cast<uint32_t>(aChunk.mTexCoords.size()),
+                                          static_cast<uint32_t>(aChunk.mNormals.size()) };
+            aPolygon.clear();
+            for ( ;; )
+            {
+                p = SkipSpaces(p, aEnd);
+                if ( p >= aEnd || *p == '#' )
+                    break;
+
+                // v, v/vt, v//vn or v/vt/vn
+                Corner lCorner = { { -1, -1, -1 }, 0 };
+                for ( int k = 0; k < 3; ++k )
+                {
+                    if ( k > 0 )
+                    {
+                        if ( p >= aEnd || *p != '/' )
+                            break;
+                        ++p;
+                        if ( k == 1 && p < aEnd && *p == '/' )
+                            continue;
+                    }
+                    int32_t lIndex;
+                    const char* lNext = ParseInt(p, aEnd, lIndex);
+                    if ( lNext == p || lIndex == 0 )
+                        return false;
+                    p = lNext;
+                    if ( lIndex > 0 )
+                        lCorner.mIndex[k] = lIndex - 1;
+                    else
+                    {
+                        lCorner.mIndex[k] = static_cast<int32_t>(lCounts[k]) + lIndex;
+                        lCorner.mLocal |= 1 << k;
+                    }
+                }
+                if ( p < aEnd && !IsSpace(*p) )
+                    return false;
+                aPolygon.push_back(lCorner);
+            }
+            if ( aPolygon.size() < 3 )
+                return false;
+
+            // Convex polygons, triangulated as a fan around the first corner
+            ++aChunk.mPolygons;
+            for ( size_t i = 1; i + 1 < aPolygon.size(); ++i )
+            {
+                aChunk.mCorners.push_back(aPolygon[0]);
+                aChunk.mCorners.push_back(aPolygon[i]);
+                aChunk.mCorners.push_back(aPolygon[i + 1]);
+            }
+            return true;
+        }
+
+        bool ParseLine(Chunk& aChunk, const char* p, const char* aEnd, std::vector<Corner>& aPolygon)
+        {
+            if ( p >= aEnd )
+                return true;
+            switch ( *p )
+            {
+                case 'v':
+                    if ( p + 1 < aEnd && IsSpace(p[1]) )
+                    {
+                        glm::vec3 lPosition;
+                        ++p;
+                        if ( !ParseFloats(p, aEnd, &lPosition.x, 3) )
+                            return false;
+                        aChunk.mPositions.push_back(lPosition);
+                    }
+                    else if ( p + 2 < aEnd && p[1] == 't' && IsSpace(p[2]) )
+                    {
+                        glm::vec2 lUV(0.0f);
+                        p += 2;
+                        if ( !ParseFloats(p, aEnd, &lUV.x, 1) )
+                            return false;
+                        ParseFloats(p, aEnd, &lUV.y, 1);
+                        /* OBJ defines (0,0) to be the top-left corner while OpenGL uses
+                           the bottom left corner, as in Asset3DLoaders::LoadOBJ */
+                        lUV.y = 1.0f - lUV.y;
+                        aChunk.mTexCoords.push_back(lUV);
+                    }
+                    else if ( p + 2 < aEnd && p[1] == 'n' && IsSpace(p[2]) )
+                    {
+                        glm::vec3 lNormal;
+                        p += 2;
+                        if ( !ParseFloats(p, aEnd, &lNormal.x, 3) )
+                            return false;
+                        aChunk.mNormals.push_back(lNormal);
+                    }
+                    return true;
+                case 'f':
+                    if ( p + 1 < aEnd && IsSpace(p[1]) )
+                        return ParseFace(aChunk, p + 1, aEnd, aPolygon);
+                    return true;
+                case 'u':
+                    if ( StartsWith(p, aEnd, "usemtl", 6) )
+                        aChunk.mGroups.push_back({ Trimmed(p + 6, aEnd), static_cast<uint32_t>(aChunk.mCorners.size()) });
+                    return true;
+                case 'm':
+                    if ( StartsWith(p, aEnd, "mtllib", 6) )
+                        aChunk.mLibraries.push_back(Trimmed(p + 6, aEnd));
+                    return true;
+                default:
+                    // Comments, objects, groups, smoothing groups, lines and points are ignored
+                    return true;
+            }
+        }
+
+        void ParseChunk(Chunk& aChunk)
+        {
+            std::vector<Corner> lPolygon;
+            const char* p = aChunk.mBegin;
+            while ( p < aChunk.mEnd )
+            {
+                const char* lEnd = static_cast<const char*>(memchr(p, '\n', aChunk.mEnd - p));
+                if ( !lEnd )
+                    lEnd = aChunk.mEnd;
+                if ( !ParseLine(aChunk, SkipSpaces(p, lEnd), lEnd, lPolygon) && !aChunk.mError )
+                    aChunk.mError = p;
+                p = lEnd < aChunk.mEnd ? lEnd + 1 : lEnd;
+            }
+        }
+
+        /* Runs aFunction(i) for every i in [0, aCount), one thread each */
+        template<typename F>
+        void ParallelFor(size_t aCount, F aFunction)
+        {
+            std::vector<std::thread> lThreads;
+            for ( size_t i = 1; i < aCount; ++i )
+                lThreads.emplace_back(aFunction, i);
+            if ( aCount )
+                aFunction(size_t(0));
+            for ( auto& lThread : lThreads )
+                lThread.join();
+        }
+
+        double Milliseconds(std::chrono::high_resolution_clock::time_point aStart)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - aStart).count();
+        }
+    }
+
+    const char* ObjImporter::ParseFloat(const char* aBegin, const char* aEnd, float& aValue)
+    {
+        static const double sPowers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+        const char* p = aBegin;
+        const bool lNegative = p < aEnd && *p == '-';
+        if ( p < aEnd && (*p == '-' || *p == '+') )
+            ++p;
+
+        // Up to 19 significant digits fit in the mantissa, the rest only scale it
+        uint64_t lMantissa = 0;
+        int32_t lExponent = 0;
+        uint32_t lDigits = 0;
+        bool lAny = false;
+        for ( ; p < aEnd && *p >= '0' && *p <= '9'; ++p, lAny = true )
+        {
+            if ( lDigits < 19 )
+            {
+                lMantissa = lMantissa * 10 + (*p - '0');
+                lDigits += lMantissa != 0;
+            }
+            else
+                ++lExponent;
+        }
+        if ( p < aEnd && *p == '.' )
+        {
+            for ( ++p; p < aEnd && *p >= '0' && *p <= '9'; ++p, lAny = true )
+            {
+                if ( lDigits < 19 )
+                {
+                    lMantissa = lMantissa * 10 + (*p - '0');
+                    lDigits += lMantissa != 0;
+                    --lExponent;
+                }
+            }
+        }
+        if ( !lAny )
+            return aBegin;
+
+        if ( p < aEnd && (*p == 'e' || *p == 'E') )
+        {
+            int32_t lPower;
+            const char* lNext = ParseInt(p + 1, aEnd, lPower);
+            if ( lNext != p + 1 )
+            {
+                lExponent += std::max(-400, std::min(400, lPower));
+                p = lNext;
+            }
+        }
+
+        double lValue = static_cast<double>(lMantissa);
+        if ( lValue != 0.0 )
+        {
+            // Dividing by an exact power of ten is more precise than multiplying by its inverse
+            const bool lDivide = lExponent < 0;
+            uint32_t lPower = static_cast<uint32_t>(lDivide ? -lExponent : lExponent);
+            for ( ; lPower > 22; lPower -= 22 )
+                lValue = lDivide ? lValue / sPowers[22] : lValue * sPowers[22];
+            lValue = lDivide ? lValue / sPowers[lPower] : lValue * sPowers[lPower];
+        }
+        aValue = static_cast<float>(lNegative ? -lValue : lValue);
+        return p;
+    }
+
+    bool ObjImporter::Load(Asset3D& aAsset, const std::string& aFileName, uint32_t aThreads, Stats* aStats)
+    {
+        const auto lStart = std::chrono::high_resolution_clock::now();
+        MappedFile lFile;
+        if ( !lFile.Open(aFileName) )
+        {
+            WARNING("ERROR cannot open file %s", aFileName.c_str());
+            return false;
+        }
+        const char* lData = reinterpret_cast<const char*>(lFile.GetData());
+        const size_t lSize = lFile.GetSize();
+
+        /* Split the file in chunks that start at the beginning of a line */
+        if ( aThreads == 0 )
+            aThreads = std::max(1u, std::thread::hardware_concurrency());
+        const size_t lChunkCount = std::max<size_t>(1, std::min<size_t>(aThreads, lSize / sMinChunkSize));
+        std::vector<Chunk> lChunks(lChunkCount);
+        const char* lBegin = lData;
+        for ( size_t i = 0; i < lChunkCount; ++i )
+        {
+            const char* lEnd = lData + lSize;
+            if ( i + 1 < lChunkCount )
+            {
+                lEnd = std::max(lBegin, lData + lSize * (i + 1) / lChunkCount);
+                const char* lNewLine = static_cast<const char*>(memchr(lEnd, '\n', lData + lSize - lEnd));
+                lEnd = lNewLine ? lNewLine + 1 : lData + lSize;
+            }
+            lChunks[i].mBegin = lBegin;
+            lChunks[i].mEnd = lEnd;
+            lBegin = lEnd;
+        }
+
+        ParallelFor(lChunkCount, [&lChunks](size_t i) { ParseChunk(lChunks[i]); });
+        const double lParseTime = Milliseconds(lStart);
+
+        for ( const auto& lChunk : lChunks )
+        {
+            if ( lChunk.mError )
+            {
+                const char* lLineEnd = static_cast<const char*>(memchr(lChunk.mError, '\n', lChunk.mEnd - lChunk.mError));
+                const std::string lLine = Trimmed(lChunk.mError, lLineEnd ? lLineEnd : lChunk.mEnd);
+                WARNING("ERROR malformed line at byte %zu of %s: %.64s", size_t(lChunk.mError - lData), aFileName.c_str(), lLine.c_str());
+                return false;
+            }
+        }
+
+        /* The vertices of every chunk start after the ones of the previous chunks */
+        const auto lMergeStart = std::chrono::high_resolution_clock::now();
+        std::vector<glm::vec3> lPositions;
+        std::vector<glm::vec2> lTexCoords;
+        std::vector<glm::vec3> lNormals;
+        std::vector<std::array<int32_t, 3>> lBases(lChunkCount);
+        size_t lCornerCount = 0;
+        uint32_t lPolygons = 0;
+        for ( size_t i = 0; i < lChunkCount; ++i )
+        {
+            lBases[i] = { { int32_t(lPositions.size()), int32_t(lTexCoords.size()), int32_t(lNormals.size()) } };
+            lPositions.insert(lPositions.end(), lChunks[i].mPositions.begin(), lChunks[i].mPositions.end());
+            lTexCoords.insert(lTexCoords.end(), lChunks[i].mTexCoords.begin(), lChunks[i].mTexCoords.end());
+            lNormals.insert(lNormals.end(), lChunks[i].mNormals.begin(), lChunks[i].mNormals.end());
+            lCornerCount += lChunks[i].mCorners.size();
+            lPolygons += lChunks[i].mPolygons;
+        }
+
+        /* Resolve the relative indices and check the ranges */
+        const int32_t lTotals[3] = { int32_t(lPositions.size()), int32_t(lTexCoords.size()), int32_t(lNormals.size()) };
+        std::vector<uint8_t> lValid(lChunkCount, 1);
+        ParallelFor(lChunkCount, [&](size_t i)
+        {
+            for ( Corner& lCorner : lChunks[i].mCorners )
+            {
+                for ( int k = 0; k < 3; ++k )
+                {
+                    if ( lCorner.mLocal & (1 << k) )
+                        lCorner.mIndex[k] += lBases[i][k];
+                    else if ( k > 0 && lCorner.mIndex[k] == -1 )
+                        continue;
+                    if ( lCorner.mIndex[k] < 0 || lCorner.mIndex[k] >= lTotals[k] )
+                        lValid[i] = 0;
+                }
+                lCorner.mLocal = 0;
+            }
+        });
+        if ( std::find(lValid.begin(), lValid.end(), 0) != lValid.end() )
+        {
+            WARNING("ERROR %s has face indices out of range", aFileName.c_str());
+            return false;
+        }
+
+        /* Runs of triangles of every material, in order of first use. The faces before
+           the first usemtl go to a default material */
+        std::vector<std::string> lOrder;
+        std::map<std::string, std::vector<Run>> lRuns;
+        auto lAddRun = [&](const std::string& aMaterial, uint32_t aChunk, uint32_t aBegin, uint32_t aEnd)
+        {
+            if ( aBegin == aEnd )
+                return;
+            auto& lMaterialRuns = lRuns[aMaterial];
+            if ( lMaterialRuns.empty() )
+                lOrder.push_back(aMaterial);
+            lMaterialRuns.push_back({ aChunk, aBegin, aEnd });
+        };
+        std::string lCurrent = "Default";
+        for ( uint32_t i = 0; i < lChunkCount; ++i )
+        {
+            uint32_t lFirst = 0;
+            for ( const auto& lGroup : lChunks[i].mGroups )
+            {
+                lAddRun(lCurrent, i, lFirst, lGroup.mFirstCorner);
+                lCurrent = lGroup.mMaterial;
+                lFirst = lGroup.mFirstCorner;
+            }
+            lAddRun(lCurrent, i, lFirst, static_cast<uint32_t>(lChunks[i].mCorners.size()));
+        }
+
+        /* De-duplicate the corners on their full key, the order of the first use is kept */
+        std::unordered_map<Corner, uint32_t, CornerHash> lUnique;
+        lUnique.reserve(lCornerCount / 2 + 1);
+        std::vector<Asset3D::VertexData> lVertexData;
+        std::vector<uint8_t> lMissingNormal;
+        std::vector<uint32_t> lIndices;
+        std::vector<uint32_t> lOffsets, lCounts;
+        lVertexData.reserve(lCornerCount / 2 + 1);
+        lIndices.reserve(lCornerCount);
+        for ( const auto& lMaterial : lOrder )
+        {
+            lOffsets.push_back(static_cast<uint32_t>(lIndices.size()));
+            for ( const Run& lRun : lRuns[lMaterial] )
+            {
+                const Corner* lCorners = lChunks[lRun.mChunk].mCorners.data();
+                for ( uint32_t c = lRun.mBegin; c < lRun.mEnd; ++c )
+                {
+                    const Corner& lCorner = lCorners[c];
+                    auto lInserted = lUnique.emplace(lCorner, static_cast<uint32_t>(lVertexData.size()));
+                    if ( lInserted.second )
+                    {
+                        Asset3D::VertexData lVertex;
+                        lVertex.mVertex = lPositions[lCorner.mIndex[0]];
+                        lVertex.mUVCoord = lCorner.mIndex[1] >= 0 ? lTexCoords[lCorner.mIndex[1]] : glm::vec2(0.0f);
+                        lVertex.mNormal = lCorner.mIndex[2] >= 0 ? lNormals[lCorner.mIndex[2]] : glm::vec3(0.0f);
+                        lVertexData.push_back(lVertex);
+                        lMissingNormal.push_back(lCorner.mIndex[2] < 0);
+                    }
+                    lIndices.push_back(lInserted.first->second);
+                }
+            }
+            lCounts.push_back(static_cast<uint32_t>(lIndices.size()) - lOffsets.back());
+        }
+
+        /* The corners without a normal get the area weighted normals of their faces */
+        if ( std::find(lMissingNormal.begin(), lMissingNormal.end(), 1) != lMissingNormal.end() )
+        {
+            for ( size_t t = 0; t + 2 < lIndices.size(); t += 3 )
+            {
+                const uint32_t a = lIndices[t], b = lIndices[t + 1], c = lIndices[t + 2];
+                const glm::vec3 lFaceNormal = glm::cross(lVertexData[b].mVertex - lVertexData[a].mVertex,
+                                                         lVertexData[c].mVertex - lVertexData[a].mVertex);
+                for ( uint32_t lIndex : { a, b, c } )
+                    if ( lMissingNormal[lIndex] )
+                        lVertexData[lIndex].mNormal += lFaceNormal;
+            }
+            for ( size_t v = 0; v < lVertexData.size(); ++v )
+                if ( lMissingNormal[v] && glm::length(lVertexData[v].mNormal) > 0.0f )
+                    lVertexData[v].mNormal = glm::normalize(lVertexData[v].mNormal);
+        }
+        const double lMergeTime = Milliseconds(lMergeStart);
+
+        /* Materials and textures */
+        std::map<std::string, Material> lMaterials;
+        std::map<std::string, Texture> lTextures;
+        std::vector<std::string> lLibraries;
+        for ( const auto& lChunk : lChunks )
+            for ( const auto& lLibrary : lChunk.mLibraries )
+                if ( std::find(lLibraries.begin(), lLibraries.end(), lLibrary) == lLibraries.end() )
+                    lLibraries.push_back(lLibrary);
+        for ( const auto& lLibrary : lLibraries )
+            Asset3DLoaders::LoadMTL(Utils::GetFilePath(aFileName), lLibrary, lMaterials, lTextures);
+
+        aAsset.mVertexData = std::move(lVertexData);
+        aAsset.mVertexIndices = std::move(lIndices);
+        aAsset.mIndicesOffsets = std::move(lOffsets);
+        aAsset.mIndicesCount = std::move(lCounts);
+        aAsset.mMaterials.clear();
+        aAsset.mTextures.clear();
+        for ( const auto& lMaterial : lOrder )
+        {
+            auto lFound = lMaterials.find(lMaterial);
+            if ( lFound == lMaterials.end() && lMaterial != "Default" )
+                WARNING("Material %s of %s not found in the material libraries", lMaterial.c_str(), aFileName.c_str());
+            aAsset.mMaterials.push_back(lFound != lMaterials.end() ? lFound->second : Material());
+            aAsset.mTextures.push_back(std::move(lTextures[lMaterial]));
+        }
+
+        /* And finally normalize the vertices */
+        aAsset.Normalize();
+
+        if ( aStats )
+        {
+            aStats->mBytes = lSize;
+            aStats->mThreads = static_cast<uint32_t>(lChunkCount);
+            aStats->mPositions = static_cast<uint32_t>(lPositions.size());
+            aStats->mTexCoords = static_cast<uint32_t>(lTexCoords.size());
+            aStats->mNormals = static_cast<uint32_t>(lNormals.size());
+            aStats->mPolygons = lPolygons;
+            aStats->mTriangles = static_cast<uint32_t>(aAsset.mVertexIndices.size() / 3);
+            aStats->mVertices = static_cast<uint32_t>(aAsset.mVertexData.size());
+            aStats->mParseTime = lParseTime;
+            aStats->mMergeTime = lMergeTime;
+            aStats->mTotalTime = Milliseconds(lStart);
+        }
+        INFO(LogLevel::eLEVEL2, "Imported %s with %zu vertices and %zu faces\n", aFileName.c_str(),
+             aAsset.mVertexData.size(), aAsset.mVertexIndices.size() / 3);
+        return true;
+    }
+}
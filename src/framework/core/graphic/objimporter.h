@@ -0,0 +1,75 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Multithreaded OBJ importer. The file is memory mapped and split in
+ *                chunks at line boundaries, every chunk is parsed by its own thread in
+ *                a single pass. The relative face indices are resolved once the number
+ *                of vertices of the previous chunks is known, then the corners are
+ *                de-duplicated on their full (position, uv, normal) key.
+ *
+ *                Compared to Asset3DLoaders::LoadOBJ it also supports:
+ *
+ *                    * Polygons of any size, triangulated as a fan
+ *                    * The v, v/vt, v//vn and v/vt/vn face forms and negative indices
+ *                    * Faces without normals, which get smoothed face normals
+ *                    * Faces before the first usemtl, which get a default material
+ *******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <stdint.h>
+
+namespace Framework
+{
+    class Asset3D;
+
+    class ObjImporter
+    {
+    public:
+        /**
+         * Counters and timings of an import
+         */
+        struct Stats
+        {
+            uint64_t mBytes = 0;
+            uint32_t mThreads = 0;
+            uint32_t mPositions = 0;
+            uint32_t mTexCoords = 0;
+            uint32_t mNormals = 0;
+            uint32_t mPolygons = 0;
+            uint32_t mTriangles = 0;
+            uint32_t mVertices = 0;     /**< Unique corners after the de-duplication */
+            double   mParseTime = 0.0;  /**< Milliseconds of the parallel parsing */
+            double   mMergeTime = 0.0;  /**< Milliseconds of the index resolution and de-duplication */
+            double   mTotalTime = 0.0;  /**< Milliseconds including the materials and textures */
+        };
+
+        /**
+         * Imports an OBJ file and the MTL files it references
+         *
+         * @param aAsset     The Asset3D where the data will be loaded into
+         * @param aFileName  Path and name of the OBJ file
+         * @param aThreads   Parsing threads, 0 uses one per core
+         * @param aStats     Optional counters of the import
+         *
+         * @return true if the model was loaded
+         */
+        static bool Load(Asset3D& aAsset, const std::string& aFileName, uint32_t aThreads = 0, Stats* aStats = nullptr);
+
+        /**
+         * Parses a decimal float, with optional sign, fraction and exponent. It does not
+         * depend on the locale and stops at the first character that is not part of the number
+         *
+         * @param aBegin  First character
+         * @param aEnd    End of the buffer
+         * @param aValue  Parsed value
+         *
+         * @return The character after the number, aBegin if there is no number
+         */
+        static const char* ParseFloat(const char* aBegin, const char* aEnd, float& aValue);
+    };
+}
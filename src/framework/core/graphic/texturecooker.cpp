@@ -0,0 +1,679 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Cook step of the textures and its disk cache
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "core/mappedfile.h"
+#include "graphic/asset3d.h"
+#include "core/graphic/texturecooker.h"
+
+#if defined(_WIN32)
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+namespace Framework
+{
+    std::string TextureCooker::sCacheDirectory;
+
+    namespace
+    {
+        uint64_t Fnv1a(const void* aData, size_t aSize, uint64_t aHash = 14695981039346656037ull)
+        {
+            const uint8_t* lBytes = static_cast<const uint8_t*>(aData);
+            for ( size_t i = 0; i < aSize; ++i )
+            {
+                aHash ^= lBytes[i];
+                aHash *= 1099511628211ull;
+            }
+            return aHash;
+        }
+
+        void CreateDirectories(const std::string& aPath)
+        {
+            for ( size_t i = 1; i <= aPath.size(); ++i )
+            {
+                if ( i < aPath.size() && aPath[i] != '/' && aPath[i] != '\\' )
+                    continue;
+                const std::string lDirectory = aPath.substr(0, i);
+#if defined(_WIN32)
+                _mkdir(lDirectory.c_str());
+#else
+                mkdir(lDirectory.c_str(), 0755);
+#endif
+            }
+        }
+
+        /* Pixels of a 4x4 block, the ones outside the image repeat the last row and column */
+        void ReadBlock(const uint8_t* aPixels, uint32_t aWidth, uint32_t aHeight, uint32_t aX, uint32_t aY, glm::vec4 aBlock[16])
+        {
+            for ( uint32_t y = 0; y < 4; ++y )
+            {
+                for ( uint32_t x = 0; x < 4; ++x )
+                {
+                    const uint8_t* p = aPixels + (size_t(std::min(aY + y, aHeight - 1)) * aWidth + std::min(aX + x, aWidth - 1)) * 4;
+                    aBlock[y * 4 + x] = glm::vec4(p[0], p[1], p[2], p[3]);
+                }
+            }
+        }
+
+        /* Endpoints of the segment along the principal axis of the masked pixels */
+        bool FitSegment(const glm::vec4 aPixels[16], const bool aMask[16], glm::vec4& aFirst, glm::vec4& aLast)
+        {
+            glm::vec4 lMean(0.0f);
+            int lCount = 0;
+            for ( int i = 0; i < 16; ++i )
+            {
+                if ( aMask[i] )
+                {
+                    lMean += aPixels[i];
+                    ++lCount;
+                }
+            }
+            if ( lCount == 0 )
+                return false;
+            lMean /= float(lCount);
+
+            glm::mat4 lCovariance(0.0f);
+            for ( int i = 0; i < 16; ++i )
+            {
+                if ( aMask[i] )
+                    lCovariance += glm::outerProduct(aPixels[i] - lMean, aPixels[i] - lMean);
+            }
+
+            /* Power iterations from the axis of largest variance */
+            int lStart = 0;
+            for ( int c = 1; c < 4; ++c )
+            {
+                if ( lCovariance[c][c] > lCovariance[lStart][lStart] )
+                    lStart = c;
+            }
+            glm::vec4 lAxis = lCovariance[lStart];
+            for ( int i = 0; i < 8; ++i )
+            {
+                const float lLength = glm::length(lAxis);
+                if ( lLength <= 1e-6f )
+                {
+                    aFirst = aLast = lMean;
+                    return true;
+                }
+                lAxis = lCovariance * (lAxis / lLength);
+            }
+            lAxis = glm::normalize(lAxis);
+
+            float lMin = std::numeric_limits<float>::max(), lMax = -std::numeric_limits<float>::max();
+            for ( int i = 0; i < 16; ++i )
+            {
+                if ( !aMask[i] )
+                    continue;
+                const float t = glm::dot(aPixels[i] - lMean, lAxis);
+                lMin = std::min(lMin, t);
+                lMax = std::max(lMax, t);
+            }
+            aFirst = glm::clamp(lMean + lAxis * lMax, 0.0f, 255.0f);
+            aLast = glm::clamp(lMean + lAxis * lMin, 0.0f, 255.0f);
+            return true;
+        }
+
+        /* Best endpoints for the palette weights the pixels were assigned to */
+        bool RefitSegment(const glm::vec4 aPixels[16], const bool aMask[16], const uint8_t aIndices[16], const float* aWeights,
+                          glm::vec4& aFirst, glm::vec4& aLast)
+        {
+            float A = 0.0f, B = 0.0f, C = 0.0f;
+            glm::vec4 X(0.0f), Y(0.0f);
+            for ( int i = 0; i < 16; ++i )
+            {
+                if ( !aMask[i] )
+                    continue;
+                const float w = aWeights[aIndices[i]];
+                const float lAlpha = 1.0f - w;
+                A += lAlpha * lAlpha;
+                B += lAlpha * w;
+                C += w * w;
+                X += lAlpha * aPixels[i];
+                Y += w * aPixels[i];
+            }
+            const float lDeterminant = A * C - B * B;
+            if ( std::abs(lDeterminant) < 1e-6f )
+                return false;
+            aFirst = glm::clamp((C * X - B * Y) / lDeterminant, 0.0f, 255.0f);
+            aLast = glm::clamp((A * Y - B * X) / lDeterminant, 0.0f, 255.0f);
+            return true;
+        }
+
+        inline float SquaredDistance(const glm::vec4& a, const glm::vec4& b)
+        {
+            const glm::vec4 d = a - b;
+            return glm::dot(d, d);
+        }
+
+        /* --- BC1 color block --- */
+
+        const float sBC1Weights4[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+        const float sBC1Weights3[3] = { 0.0f, 1.0f, 0.5f };
+
+        inline uint16_t To565(const glm::vec4& aColor)
+        {
+            const uint32_t r = uint32_t(glm::clamp(aColor.r * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f));
+            const uint32_t g = uint32_t(glm::clamp(aColor.g * 63.0f / 255.0f + 0.5f, 0.0f, 63.0f));
+            const uint32_t b = uint32_t(glm::clamp(aColor.b * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f));
+            return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+        }
+
+        inline glm::vec4 From565(uint16_t aColor)
+        {
+            const uint32_t r = aColor >> 11, g = (aColor >> 5) & 63, b = aColor & 31;
+            return glm::vec4((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 0.0f);
+        }
+
+        float AssignBC1(const glm::vec4 aPixels[16], const bool aMask[16], uint16_t aFirst, uint16_t aLast, bool aThreeColors,
+                        uint8_t aIndices[16])
+        {
+            const glm::vec4 c0 = From565(aFirst), c1 = From565(aLast);
+            glm::vec4 lPalette[4] = { c0, c1, (c0 + c1) * 0.5f, glm::vec4(0.0f) };
+            if ( !aThreeColors )
+            {
+                lPalette[2] = (c0 * 2.0f + c1) / 3.0f;
+                lPalette[3] = (c0 + c1 * 2.0f) / 3.0f;
+            }
+            const int lEntries = aThreeColors ? 3 : 4;
+
+            float lError = 0.0f;
+            for ( int i = 0; i < 16; ++i )
+            {
+                if ( !aMask[i] )
+                {
+                    aIndices[i] = 3;    /* transparent in the three colors mode */
+                    continue;
+                }
+                float lBest = std::numeric_limits<float>::max();
+                for ( int k = 0; k < lEntries; ++k )
+                {
+                    const float lDistance = SquaredDistance(aPixels[i], lPalette[k]);
+                    if ( lDistance < lBest )
+                    {
+                        lBest = lDistance;
+                        aIndices[i] = static_cast<uint8_t>(k);
+                    }
+                }
+                lError += lBest;
+            }
+            return lError;
+        }
+
+        /* Color block of BC1 and BC3. With aPunchThrough the pixels with alpha under
+           128 are stored as transparent, which needs the three colors mode */
+        void EncodeColorBlock(const glm::vec4 aBlock[16], bool aPunchThrough, uint8_t* aOut)
+        {
+            glm::vec4 lPixels[16];
+            bool lMask[16];
+            bool lThreeColors = false;
+            for ( int i = 0; i < 16; ++i )
+            {
+                lPixels[i] = glm::vec4(aBlock[i].r, aBlock[i].g, aBlock[i].b, 0.0f);
+                lMask[i] = !aPunchThrough || aBlock[i].a >= 128.0f;
+                lThreeColors |= !lMask[i];
+            }
+
+            uint16_t q0 = 0, q1 = 0;
+            uint8_t lIndices[16];
+            memset(lIndices, 3, sizeof lIndices);
+            glm::vec4 e0, e1;
+            if ( FitSegment(lPixels, lMask, e0, e1) )
+            {
+                const float* lWeights = lThreeColors ? sBC1Weights3 : sBC1Weights4;
+                q0 = To565(e0);
+                q1 = To565(e1);
+                float lError = AssignBC1(lPixels, lMask, q0, q1, lThreeColors, lIndices);
+
+                uint8_t lRefitIndices[16];
+                if ( RefitSegment(lPixels, lMask, lIndices, lWeights, e0, e1) )
+                {
+                    const uint16_t r0 = To565(e0), r1 = To565(e1);
+                    const float lRefitError = AssignBC1(lPixels, lMask, r0, r1, lThreeColors, lRefitIndices);
+                    if ( lRefitError < lError )
+                    {
+                        q0 = r0;
+                        q1 = r1;
+                        memcpy(lIndices, lRefitIndices, sizeof lIndices);
+                    }
+                }
+
+                /* The order of the endpoints selects the mode of the block */
+                if ( lThreeColors ? q0 > q1 : q0 < q1 )
+                {
+                    std::swap(q0, q1);
+                    for ( auto& lIndex : lIndices )
+                    {
+                        if ( lIndex < 2 )
+                            lIndex ^= 1;
+                        else if ( !lThreeColors )
+                            lIndex ^= 1;    /* 2 <-> 3 */
+                    }
+                }
+                else if ( !lThreeColors && q0 == q1 )
+                    memset(lIndices, 0, sizeof lIndices);
+            }
+
+            uint32_t lBits = 0;
+            for ( int i = 0; i < 16; ++i )
+                lBits |= uint32_t(lIndices[i]) << (2 * i);
+            aOut[0] = q0 & 0xFF;
+            aOut[1] = q0 >> 8;
+            aOut[2] = q1 & 0xFF;
+            aOut[3] = q1 >> 8;
+            memcpy(aOut + 4, &lBits, sizeof lBits);
+        }
+
+        /* --- BC3 alpha block --- */
+
+        void EncodeAlphaBlock(const glm::vec4 aBlock[16], uint8_t* aOut)
+        {
+            int lMin = 255, lMax = 0;
+            for ( int i = 0; i < 16; ++i )
+            {
+                lMin = std::min(lMin, int(aBlock[i].a));
+                lMax = std::max(lMax, int(aBlock[i].a));
+            }
+
+            /* With a0 > a1, index 0 is a0, 1 is a1 and 2..7 are the steps from a0 to a1 */
+            uint64_t lBits = 0;
+            if ( lMax > lMin )
+            {
+                for ( int i = 0; i < 16; ++i )
+                {
+                    const int lStep = int((lMax - aBlock[i].a) * 7.0f / (lMax - lMin) + 0.5f);
+                    const uint64_t lIndex = lStep == 0 ? 0 : (lStep == 7 ? 1 : lStep + 1);
+                    lBits |= lIndex << (3 * i);
+                }
+            }
+            aOut[0] = static_cast<uint8_t>(lMax);
+            aOut[1] = static_cast<uint8_t>(lMin);
+            for ( int i = 0; i < 6; ++i )
+                aOut[2 + i] = static_cast<uint8_t>(lBits >> (8 * i));
+        }
+
+        /* --- BC7 mode 6, one subset of RGBA 7.7.7.7 endpoints with a p-bit and 4 bit indices --- */
+
+        const int sBC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        struct BC7Endpoint
+        {
+            uint8_t mColor[4];  /**< 7 bits per channel */
+            uint8_t mPBit;
+
+            glm::vec4 Value() const
+            {
+                return glm::vec4((mColor[0] << 1) | mPBit, (mColor[1] << 1) | mPBit, (mColor[2] << 1) | mPBit, (mColor[3] << 1) | mPBit);
+            }
+        };
+
+        BC7Endpoint QuantizeBC7(const glm::vec4& aColor)
+        {
+            BC7Endpoint lBest = {};
+            float lBestError = std::numeric_limits<float>::max();
+            for ( uint8_t p = 0; p < 2; ++p )
+            {
+                BC7Endpoint lEndpoint;
+                lEndpoint.mPBit = p;
+                for ( int c = 0; c < 4; ++c )
+                    lEndpoint.mColor[c] = static_cast<uint8_t>(glm::clamp((aColor[c] - p) * 0.5f + 0.5f, 0.0f, 127.0f));
+                const float lError = SquaredDistance(lEndpoint.Value(), aColor);
+                if ( lError < lBestError )
+                {
+                    lBestError = lError;
+                    lBest = lEndpoint;
+                }
+            }
+            return lBest;
+        }
+
+        float AssignBC7(const glm::vec4 aPixels[16], const BC7Endpoint& aFirst, const BC7Endpoint& aLast, uint8_t aIndices[16])
+        {
+            const glm::vec4 e0 = aFirst.Value(), e1 = aLast.Value();
+            glm::vec4 lPalette[16];
+            for ( int k = 0; k < 16; ++k )
+                lPalette[k] = glm::floor((e0 * float(64 - sBC7Weights[k]) + e1 * float(sBC7Weights[k]) + 32.0f) / 64.0f);
+
+            float lError = 0.0f;
+            for ( int i = 0; i < 16; ++i )
+            {
+                float lBest = std::numeric_limits<float>::max();
+                for ( int k = 0; k < 16; ++k )
+                {
+                    const float lDistance = SquaredDistance(aPixels[i], lPalette[k]);
+                    if ( lDistance < lBest )
+                    {
+                        lBest = lDistance;
+                        aIndices[i] = static_cast<uint8_t>(k);
+                    }
+                }
+                lError += lBest;
+            }
+            return lError;
+        }
+
+        class BitWriter
+        {
+        public:
+            explicit BitWriter(uint8_t* aOut) : mOut(aOut) { memset(mOut, 0, 16); }
+
+            void Write(uint32_t aValue, uint32_t aBits)
+            {
+                for ( uint32_t i = 0; i < aBits; ++i, ++mPosition )
+                    mOut[mPosition >> 3] |= ((aValue >> i) & 1) << (mPosition & 7);
+            }
+
+        private:
+            uint8_t* mOut;
+            uint32_t mPosition = 0;
+        };
+
+        void EncodeBC7Block(const glm::vec4 aBlock[16], uint8_t* aOut)
+        {
+            static const bool sAll[16] = { true, true, true, true, true, true, true, true,
+                                           true, true, true, true, true, true, true, true };
+            float lWeights[16]; // per call, the blocks are encoded on several threads
+            for ( int k = 0; k < 16; ++k )
+                lWeights[k] = sBC7Weights[k] / 64.0f;
+
+            glm::vec4 e0, e1;
+            FitSegment(aBlock, sAll, e0, e1);
+            BC7Endpoint q0 = QuantizeBC7(e0), q1 = QuantizeBC7(e1);
+            uint8_t lIndices[16];
+            float lError = AssignBC7(aBlock, q0, q1, lIndices);
+
+            uint8_t lRefitIndices[16];
+            if ( RefitSegment(aBlock, sAll, lIndices, lWeights, e0, e1) )
+            {
+                const BC7Endpoint r0 = QuantizeBC7(e0), r1 = QuantizeBC7(e1);
+                if ( AssignBC7(aBlock, r0, r1, lRefitIndices) < lError )
+                {
+                    q0 = r0;
+                    q1 = r1;
+                    memcpy(lIndices, lRefitIndices, sizeof lIndices);
+                }
+            }
+
+            /* The most significant bit of the first index is implicitly 0 */
+            if ( lIndices[0] & 8 )
+            {
+                std::swap(q0, q1);
+                for ( auto& lIndex : lIndices )
+                    lIndex = 15 - lIndex;
+            }
+
+            BitWriter lWriter(aOut);
+            lWriter.Write(1 << 6, 7);
+            for ( int c = 0; c < 4; ++c )
+            {
+                lWriter.Write(q0.mColor[c], 7);
+                lWriter.Write(q1.mColor[c], 7);
+            }
+            lWriter.Write(q0.mPBit, 1);
+            lWriter.Write(q1.mPBit, 1);
+            for ( int i = 0; i < 16; ++i )
+                lWriter.Write(lIndices[i], i == 0 ? 3 : 4);
+        }
+
+        void EncodeLevel(const std::vector<uint8_t>& aPixels, uint32_t aWidth, uint32_t aHeight, Texture::Compression aCompression,
+                         std::vector<uint8_t>& aOut)
+        {
+            if ( aCompression == Texture::Compression::eNONE )
+            {
+                aOut.insert(aOut.end(), aPixels.begin(), aPixels.end());
+                return;
+            }
+
+            const size_t lBlockSize = aCompression == Texture::Compression::eBC1 ? 8 : 16;
+            size_t lOffset = aOut.size();
+            aOut.resize(lOffset + Texture::GetLevelSize(aCompression, aWidth, aHeight));
+            glm::vec4 lBlock[16];
+            for ( uint32_t y = 0; y < aHeight; y += 4 )
+            {
+                for ( uint32_t x = 0; x < aWidth; x += 4, lOffset += lBlockSize )
+                {
+                    ReadBlock(aPixels.data(), aWidth, aHeight, x, y, lBlock);
+                    switch ( aCompression )
+                    {
+                        case Texture::Compression::eBC1:
+                            EncodeColorBlock(lBlock, true, &aOut[lOffset]);
+                            break;
+                        case Texture::Compression::eBC3:
+                            EncodeAlphaBlock(lBlock, &aOut[lOffset]);
+                            EncodeColorBlock(lBlock, false, &aOut[lOffset + 8]);
+                            break;
+                        default:
+                            EncodeBC7Block(lBlock, &aOut[lOffset]);
+                            break;
+                    }
+                }
+            }
+        }
+
+        /* Box filter, an odd last row or column is dropped like glGenerateMipmap does */
+        void Downsample(const std::vector<uint8_t>& aSource, uint32_t aWidth, uint32_t aHeight, std::vector<uint8_t>& aDest)
+        {
+            const uint32_t lWidth = std::max(aWidth / 2, 1u), lHeight = std::max(aHeight / 2, 1u);
+            aDest.resize(size_t(lWidth) * lHeight * 4);
+            for ( uint32_t y = 0; y < lHeight; ++y )
+            {
+                const uint8_t* lRow0 = &aSource[size_t(std::min(2 * y, aHeight - 1)) * aWidth * 4];
+                const uint8_t* lRow1 = &aSource[size_t(std::min(2 * y + 1, aHeight - 1)) * aWidth * 4];
+                for ( uint32_t x = 0; x < lWidth; ++x )
+                {
+                    const size_t x0 = size_t(std::min(2 * x, aWidth - 1)) * 4, x1 = size_t(std::min(2 * x + 1, aWidth - 1)) * 4;
+                    uint8_t* lOut = &aDest[(size_t(y) * lWidth + x) * 4];
+                    for ( int c = 0; c < 4; ++c )
+                        lOut[c] = static_cast<uint8_t>((lRow0[x0 + c] + lRow0[x1 + c] + lRow1[x0 + c] + lRow1[x1 + c] + 2) >> 2);
+                }
+            }
+        }
+    }
+
+    bool TextureCooker::ConvertToRGBA8(const Texture& aTexture, std::vector<uint8_t>& aPixels)
+    {
+        /* 16 bit channels keep their most significant byte */
+        uint32_t lComponentSize = 1;
+        if ( aTexture.mType == GL_UNSIGNED_SHORT )
+            lComponentSize = 2;
+        else if ( aTexture.mType != 0 && aTexture.mType != GL_UNSIGNED_BYTE )
+            return false;
+
+        /* Textures made in code may only set the bytes per pixel */
+        uint32_t lFormat = aTexture.mFormat;
+        if ( lFormat == 0 )
+        {
+            static const uint32_t sFormats[5] = { 0, GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_RGB, GL_RGBA };
+            lFormat = aTexture.mBytesPerPixel <= 4 ? sFormats[aTexture.mBytesPerPixel] : 0;
+        }
+
+        /* Source offset of R, G, B and A, -1 for an opaque alpha */
+        int lChannels[4];
+        switch ( lFormat )
+        {
+            case GL_RGB:             lChannels[0] = 0; lChannels[1] = 1; lChannels[2] = 2; lChannels[3] = -1; break;
+            case GL_BGR:             lChannels[0] = 2; lChannels[1] = 1; lChannels[2] = 0; lChannels[3] = -1; break;
+            case GL_RGBA:            lChannels[0] = 0; lChannels[1] = 1; lChannels[2] = 2; lChannels[3] = 3;  break;
+            case GL_BGRA:            lChannels[0] = 2; lChannels[1] = 1; lChannels[2] = 0; lChannels[3] = 3;  break;
+            case GL_LUMINANCE:
+            case GL_RED:             lChannels[0] = 0; lChannels[1] = 0; lChannels[2] = 0; lChannels[3] = -1; break;
+            case GL_LUMINANCE_ALPHA: lChannels[0] = 0; lChannels[1] = 0; lChannels[2] = 0; lChannels[3] = 1;  break;
+            default:
+                return false;
+        }
+
+        const size_t lPixelCount = size_t(aTexture.mWidth) * aTexture.mHeight;
+        const uint32_t lStride = aTexture.mBytesPerPixel;
+        if ( lStride == 0 || aTexture.mPixels.size() < lPixelCount * lStride )
+            return false;
+        for ( int c = 0; c < 4; ++c )
+        {
+            if ( lChannels[c] < 0 )
+                continue;
+            lChannels[c] = lChannels[c] * lComponentSize + (lComponentSize - 1);
+            if ( lChannels[c] >= int(lStride) )
+                return false;
+        }
+
+        aPixels.resize(lPixelCount * 4);
+        const uint8_t* lIn = aTexture.mPixels.data();
+        uint8_t* lOut = aPixels.data();
+        for ( size_t i = 0; i < lPixelCount; ++i, lIn += lStride, lOut += 4 )
+        {
+            for ( int c = 0; c < 4; ++c )
+                lOut[c] = lChannels[c] < 0 ? 0xFF : lIn[lChannels[c]];
+        }
+        return true;
+    }
+
+    bool TextureCooker::Cook(Texture& aTexture, const Options& aOptions)
+    {
+        ASSERT(!aTexture.IsCooked());
+        std::vector<uint8_t> lLevel, lNextLevel;
+        if ( aTexture.mWidth == 0 || aTexture.mHeight == 0 || !ConvertToRGBA8(aTexture, lLevel) )
+            return false;
+
+        uint32_t lLevels = 1;
+        if ( aOptions.mMipmaps )
+        {
+            while ( (std::max(aTexture.mWidth, aTexture.mHeight) >> lLevels) > 0 )
+                ++lLevels;
+        }
+
+        std::vector<uint8_t> lCooked;
+        uint32_t lWidth = aTexture.mWidth, lHeight = aTexture.mHeight;
+        for ( uint32_t i = 0; i < lLevels; ++i )
+        {
+            EncodeLevel(lLevel, lWidth, lHeight, aOptions.mCompression, lCooked);
+            if ( i + 1 < lLevels )
+            {
+                Downsample(lLevel, lWidth, lHeight, lNextLevel);
+                lLevel.swap(lNextLevel);
+                lWidth = std::max(lWidth / 2, 1u);
+                lHeight = std::max(lHeight / 2, 1u);
+            }
+        }
+
+        aTexture.mPixels = std::move(lCooked);
+        aTexture.mBytesPerPixel = 4;
+        aTexture.mFormat = GL_RGBA;
+        aTexture.mType = GL_UNSIGNED_BYTE;
+        aTexture.mCompression = aOptions.mCompression;
+        aTexture.mMipLevels = lLevels;
+        ASSERT(aTexture.mPixels.size() == aTexture.GetLevelOffset(lLevels));
+        return true;
+    }
+
+    uint32_t TextureCooker::CookTextures(Asset3D& aAsset, const Options& aOptions)
+    {
+        uint32_t lCooked = 0;
+        for ( auto& lTexture : aAsset.mTextures )
+        {
+            if ( lTexture.IsCooked() )
+                continue;
+            if ( Cook(lTexture, aOptions) )
+                ++lCooked;
+            else
+                WARNING("Texture %s cannot be cooked, it is kept as it is", lTexture.mName.c_str());
+        }
+        return lCooked;
+    }
+
+    std::string TextureCooker::GetCacheFile(const std::string& aFilename, const Options& aOptions, uint64_t& aSourceHash)
+    {
+        if ( sCacheDirectory.empty() )
+            return std::string();
+        MappedFile lSource;
+        if ( !lSource.Open(aFilename) )
+            return std::string();
+
+        const uint32_t lKey[3] = { sVersion, static_cast<uint32_t>(aOptions.mCompression), aOptions.mMipmaps ? 1u : 0u };
+        aSourceHash = Fnv1a(lKey, sizeof lKey, Fnv1a(lSource.GetData(), lSource.GetSize()));
+        char lName[32];
+        snprintf(lName, sizeof lName, "%016llx.tex", (unsigned long long)aSourceHash);
+        return sCacheDirectory + "/" + lName;
+    }
+
+    bool TextureCooker::ReadCacheFile(const std::string& aFilename, uint64_t aSourceHash, Texture& aTexture)
+    {
+        MappedFile lFile;
+        if ( !lFile.Open(aFilename) || lFile.GetSize() < sizeof(CacheHeader) )
+            return false;
+        CacheHeader lHeader;
+        memcpy(&lHeader, lFile.GetData(), sizeof lHeader);
+        if ( lHeader.mMagic != sMagic || lHeader.mVersion != sVersion || lHeader.mSourceHash != aSourceHash ||
+             lHeader.mCompression > static_cast<uint16_t>(Texture::Compression::eBC7) || lHeader.mMipLevels == 0 ||
+             lHeader.mWidth == 0 || lHeader.mHeight == 0 )
+            return false;
+
+        aTexture.Clear();
+        aTexture.mWidth = lHeader.mWidth;
+        aTexture.mHeight = lHeader.mHeight;
+        aTexture.mBytesPerPixel = 4;
+        aTexture.mFormat = GL_RGBA;
+        aTexture.mType = GL_UNSIGNED_BYTE;
+        aTexture.mCompression = static_cast<Texture::Compression>(lHeader.mCompression);
+        aTexture.mMipLevels = lHeader.mMipLevels;
+        if ( lHeader.mDataSize != aTexture.GetLevelOffset(lHeader.mMipLevels) ||
+             lHeader.mDataSize > lFile.GetSize() - sizeof(CacheHeader) )
+        {
+            aTexture.Clear();
+            return false;
+        }
+        const uint8_t* lData = lFile.GetData() + sizeof(CacheHeader);
+        aTexture.mPixels.assign(lData, lData + lHeader.mDataSize);
+        return true;
+    }
+
+    bool TextureCooker::WriteCacheFile(const std::string& aFilename, uint64_t aSourceHash, const Texture& aTexture)
+    {
+        ASSERT(aTexture.IsCooked());
+        CreateDirectories(aFilename.substr(0, aFilename.find_last_of("/\\")));
+
+        CacheHeader lHeader;
+        lHeader.mCompression = static_cast<uint16_t>(aTexture.mCompression);
+        lHeader.mSourceHash = aSourceHash;
+        lHeader.mWidth = aTexture.mWidth;
+        lHeader.mHeight = aTexture.mHeight;
+        lHeader.mMipLevels = aTexture.mMipLevels;
+        lHeader.mDataSize = aTexture.mPixels.size();
+
+        /* Written aside and renamed, so a reader never sees half a file */
+        const std::string lTemporary = aFilename + ".tmp";
+        FILE* lFile = fopen(lTemporary.c_str(), "wb");
+        if ( !lFile )
+            return false;
+        const bool lWritten = fwrite(&lHeader, sizeof lHeader, 1, lFile) == 1 &&
+                              fwrite(aTexture.mPixels.data(), 1, aTexture.mPixels.size(), lFile) == aTexture.mPixels.size();
+        if ( fclose(lFile) != 0 || !lWritten || std::rename(lTemporary.c_str(), aFilename.c_str()) != 0 )
+        {
+            std::remove(lTemporary.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool TextureCooker::Load(const std::string& aFilename, Texture& aTexture, const Options& aOptions)
+    {
+        uint64_t lSourceHash = 0;
+        const std::string lCacheFile = GetCacheFile(aFilename, aOptions, lSourceHash);
+        if ( !lCacheFile.empty() && ReadCacheFile(lCacheFile, lSourceHash, aTexture) )
+        {
+            aTexture.mName = Utils::GetFileName(aFilename);
+            return true;
+        }
+
+        if ( !aTexture.Load(aFilename) )
+            return false;
+        if ( Cook(aTexture, aOptions) && !lCacheFile.empty() && !WriteCacheFile(lCacheFile, lSourceHash, aTexture) )
+            WARNING("Failed to write the texture cache file %s", lCacheFile.c_str());
+        return true;
+    }
+}
@@ -0,0 +1,126 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Cook step of the textures. A decoded image is converted to RGBA8,
+ *                its mip chain is built with a box filter and, optionally, every
+ *                level is encoded on the CPU as BC1, BC3 or BC7 (mode 6) blocks.
+ *                The result is uploaded as is, without glGenerateMipmap.
+ *
+ *                The block compression is opt-in, asked for by the cook tool: the
+ *                runtime loads the images as RGBA8, encoding BC7 on the CPU at the
+ *                first start takes far longer than decoding the image.
+ *
+ *                The cooked textures are kept in a disk cache, one file per source
+ *                image named after the hash of its contents and of the cook options,
+ *                so an edited image is cooked again and an unchanged one is read
+ *                without going through the image decoder:
+ *
+ *                    | header 64 | level 0 | level 1 | ... |
+ *******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <stdint.h>
+#include "graphic/texture.h"
+
+namespace Framework
+{
+    class Asset3D;
+
+    class TextureCooker
+    {
+    public:
+        static const uint32_t sMagic = 0x58455449;  /**< "ITEX" read as a little endian uint32 */
+        static const uint16_t sVersion = 1;
+
+        struct Options
+        {
+            Texture::Compression mCompression = Texture::Compression::eNONE;
+            bool                 mMipmaps = true;
+        };
+
+        struct CacheHeader
+        {
+            uint32_t mMagic = sMagic;
+            uint16_t mVersion = sVersion;
+            uint16_t mCompression = 0;
+            uint64_t mSourceHash = 0;   /**< Hash of the source image and of the cook options */
+            uint32_t mWidth = 0;
+            uint32_t mHeight = 0;
+            uint32_t mMipLevels = 0;
+            uint32_t mReserved = 0;
+            uint64_t mDataSize = 0;     /**< Bytes of all the levels */
+            uint8_t  mPadding[24] = {};
+        };
+        static_assert(sizeof(CacheHeader) == 64, "The texture cache header must take 64 bytes");
+
+        /**
+         * Cooks a decoded texture in place. Only 8 and 16 bit textures can be cooked,
+         * the others are left as they are
+         *
+         * @param aTexture  Texture to cook, it must not be cooked already
+         * @param aOptions  Compression and mip chain of the result
+         *
+         * @return true if the texture was cooked
+         */
+        static bool Cook(Texture& aTexture, const Options& aOptions);
+        static bool Cook(Texture& aTexture) { return Cook(aTexture, Options()); }
+
+        /**
+         * Cooks the textures of an asset that are not cooked yet, it must not be uploaded yet
+         *
+         * @return Number of textures cooked
+         */
+        static uint32_t CookTextures(Asset3D& aAsset, const Options& aOptions);
+
+        /**
+         * Loads an image through the disk cache. If the cache holds the cooked image
+         * it is read, otherwise the image is decoded, cooked and stored in the cache.
+         * Without a cache directory the image is only decoded and cooked
+         *
+         * @param aFilename  Image file
+         * @param aTexture   Out: cooked texture
+         * @param aOptions   Compression and mip chain of the result
+         *
+         * @return true if the texture was loaded
+         */
+        static bool Load(const std::string& aFilename, Texture& aTexture, const Options& aOptions);
+        static bool Load(const std::string& aFilename, Texture& aTexture) { return Load(aFilename, aTexture, Options()); }
+
+        /**
+         * Reads and writes a cooked texture in the cache file format
+         */
+        static bool ReadCacheFile(const std::string& aFilename, uint64_t aSourceHash, Texture& aTexture);
+        static bool WriteCacheFile(const std::string& aFilename, uint64_t aSourceHash, const Texture& aTexture);
+
+        /**
+         * Directory of the cache files, it is created on the first write. An empty
+         * directory disables the cache
+         */
+        static void               SetCacheDirectory(const std::string& aDirectory) { sCacheDirectory = aDirectory; }
+        static const std::string& GetCacheDirectory() { return sCacheDirectory; }
+
+        /**
+         * Cache file of an image, empty if the image cannot be read or there is no cache
+         *
+         * @param aFilename    Image file
+         * @param aOptions     Cook options, part of the key
+         * @param aSourceHash  Out: key of the cache file
+         */
+        static std::string GetCacheFile(const std::string& aFilename, const Options& aOptions, uint64_t& aSourceHash);
+
+        /**
+         * Converts a decoded texture to RGBA8, the layout every cooked texture starts from
+         *
+         * @return false if the format of the texture is not supported
+         */
+        static bool ConvertToRGBA8(const Texture& aTexture, std::vector<uint8_t>& aPixels);
+
+    private:
+        static std::string sCacheDirectory;
+    };
+}
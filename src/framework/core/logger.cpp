@@ -12,12 +12,19 @@
 #include <stdarg.h>
 #include <time.h>
 
+#ifdef __linux__
+    #include <limits.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
 namespace Framework
 {
     LogLevel Logger::mLogLevel = LogLevel::eLEVEL1;
     std::ofstream* Logger::mFileStream = nullptr;
     std::vector<std::string> Logger::mLogEntries = vector<string>();
 
+#ifdef  _WIN32
     std::string GetExePath()
     {
         char buffer[MAX_PATH];
@@ -38,6 +45,30 @@ namespace Framework
         else
             return CreateDirectory(aDirPath.c_str(), NULL); //  Try to create the Logs directory
     }
+#elif __linux__
+    std::string GetExePath()
+    {
+        char buffer[PATH_MAX];
+        const ssize_t length = readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
+        if (length <= 0)
+            return "";
+        buffer[length] = '\0';
+
+        string::size_type pos = string(buffer).find_last_of("/");
+        if (pos == string::npos)
+            return "";
+        return string(buffer).substr(0, pos);
+    }
+
+    bool CreateLogDirectory(std::string aDirPath)
+    {
+        struct stat lInfo;
+        if (stat(aDirPath.c_str(), &lInfo) == 0 && S_ISDIR(lInfo.st_mode))
+            return true; //  Directory already exists so return true
+        else
+            return mkdir(aDirPath.c_str(), 0755) == 0; //  Try to create the Logs directory
+    }
+#endif
 
     bool Logger::Initialize(std::string aLogFile, LogLevel aLogLevel)
     {
@@ -52,8 +83,8 @@ namespace Framework
         }
 
         string lExePath = GetExePath();
-        string lLogDirPath = lExePath + "\\Logs";
-        string lLogFilePath = lLogDirPath + "\\" + aLogFile;
+        string lLogDirPath = lExePath + Utils::GetPathSeparator() + "Logs";
+        string lLogFilePath = lLogDirPath + Utils::GetPathSeparator() + aLogFile;
 
         if (!CreateLogDirectory(lLogDirPath))
         {
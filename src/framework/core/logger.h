@@ -7,7 +7,9 @@
 
 #pragma once
 
-#include <windows.h>
+#ifdef  _WIN32
+    #include <windows.h>
+#endif
 #include <assert.h>
 #include <stdarg.h>
 #include <iostream>
@@ -77,6 +79,7 @@ namespace Framework
 //ASSERT
 #define STR(x) #x
 #ifndef NDEBUG
+#ifdef  _WIN32
     #define ASSERT(expression) \
     do { \
         if ( !(expression)) \
@@ -89,6 +92,17 @@ namespace Framework
             MessageBox(NULL, (LPCSTR)(lBuffer), (LPCSTR)("ASSERT FAILED!"), MB_ICONERROR | MB_OK); \
         } \
     } while (false);
+#elif __linux__
+    #define ASSERT(expression) \
+    do { \
+        if ( !(expression)) \
+        { \
+            char lBuffer[1024]; \
+            sprintf(lBuffer, "ASSERT FAILED: Expression: %s Line: %d\n", STR(expression), __LINE__); \
+            Logger::LoggerPrint(__PRETTY_FUNCTION__, lBuffer); \
+        } \
+    } while (false);
+#endif
 #else
 #   define ASSERT(expression, ...) do { } while (false);
 #endif
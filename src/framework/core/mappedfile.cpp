@@ -0,0 +1,89 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Read only memory mapping of a whole file
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "core/mappedfile.h"
+
+#if defined(__linux__)
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+namespace Framework
+{
+    bool MappedFile::Open(const std::string& aFileName)
+    {
+        Close();
+#if defined(_WIN32)
+        HANDLE lFile = CreateFileA(aFileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                   FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if ( lFile == INVALID_HANDLE_VALUE )
+            return false;
+        LARGE_INTEGER lSize;
+        if ( !GetFileSizeEx(lFile, &lSize) || lSize.QuadPart == 0 )
+        {
+            CloseHandle(lFile);
+            return false;
+        }
+        HANDLE lMapping = CreateFileMappingA(lFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if ( !lMapping )
+        {
+            CloseHandle(lFile);
+            return false;
+        }
+        const void* lData = MapViewOfFile(lMapping, FILE_MAP_READ, 0, 0, 0);
+        if ( !lData )
+        {
+            CloseHandle(lMapping);
+            CloseHandle(lFile);
+            return false;
+        }
+        mFile = lFile;
+        mMapping = lMapping;
+        mData = static_cast<const uint8_t*>(lData);
+        mSize = static_cast<size_t>(lSize.QuadPart);
+#elif defined(__linux__)
+        const int lFile = open(aFileName.c_str(), O_RDONLY);
+        if ( lFile < 0 )
+            return false;
+        struct stat lStat;
+        if ( fstat(lFile, &lStat) != 0 || lStat.st_size == 0 )
+        {
+            close(lFile);
+            return false;
+        }
+        void* lData = mmap(nullptr, static_cast<size_t>(lStat.st_size), PROT_READ, MAP_PRIVATE, lFile, 0);
+        // The mapping keeps its own reference to the file
+        close(lFile);
+        if ( lData == MAP_FAILED )
+            return false;
+        mData = static_cast<const uint8_t*>(lData);
+        mSize = static_cast<size_t>(lStat.st_size);
+#endif
+        return mData != nullptr;
+    }
+
+    void MappedFile::Close()
+    {
+        if ( !mData )
+            return;
+#if defined(_WIN32)
+        UnmapViewOfFile(mData);
+        CloseHandle(mMapping);
+        CloseHandle(mFile);
+        mMapping = mFile = nullptr;
+#elif defined(__linux__)
+        munmap(const_cast<uint8_t*>(mData), mSize);
+#endif
+        mData = nullptr;
+        mSize = 0;
+    }
+}
@@ -0,0 +1,55 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Read only memory mapping of a whole file. The pages are loaded by
+ *                the operating system on first access, so only the touched parts of
+ *                the file are read from disk.
+ *******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Framework
+{
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { Close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * Maps the file, a previously mapped one is closed first
+         *
+         * @param aFileName  File to map
+         *
+         * @return true if the file was mapped, false if it cannot be opened or is empty
+         */
+        bool Open(const std::string& aFileName);
+
+        /**
+         * Unmaps the file, the pointers returned by GetData are not valid any more
+         */
+        void Close();
+
+        bool           IsOpen() const  { return mData != nullptr; }
+        const uint8_t* GetData() const { return mData; }
+        size_t         GetSize() const { return mSize; }
+
+    private:
+        const uint8_t* mData = nullptr;
+        size_t         mSize = 0;
+#if defined(_WIN32)
+        void*          mFile = nullptr;     /**< HANDLE of the file */
+        void*          mMapping = nullptr;  /**< HANDLE of the mapping */
+#endif
+    };
+}
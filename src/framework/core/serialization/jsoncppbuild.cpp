@@ -11,6 +11,7 @@
 #include <fstream>
 
 #include "jsoncpputils.h"
+#include "jsondocument.h"
 
 #include "core/logger.h"
 
@@ -109,3 +110,14 @@ Json::Value::ArrayIndex Json::JsonUtils::GetComponentIdxByType(const Json::Value
 
      return lResult;
  }
+
+bool Json::JsonUtils::OpenAndParseJsonFromFile(Framework::JsonDocument& out, string filename)
+{
+     const bool lResult = out.ParseFile(filename);
+     if (!lResult)
+     {
+         WARNING("Error parsing %s\n %s\n", filename.c_str(), out.GetError().c_str());
+     }
+
+     return lResult;
+}
@@ -10,6 +10,11 @@
 
 #include "json/json.h"
 
+namespace Framework
+{
+    class JsonDocument;
+}
+
 namespace Json
 {
 	namespace JsonUtils
@@ -19,5 +24,6 @@ namespace Json
 		void OverrideEntity(Json::Value& a, const Json::Value& b);
 
 		bool OpenAndParseJsonFromFile(Json::Value& out, std::string filename);
+		bool OpenAndParseJsonFromFile(Framework::JsonDocument& out, std::string filename);
 	}
 }
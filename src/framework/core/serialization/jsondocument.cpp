@@ -0,0 +1,768 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Read-only JSON document for the loading paths
+ *******************************************************************************/
+
+#include "precompiled.h"
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+#include "json/json.h"
+
+#include "core/serialization/jsondocument.h"
+
+namespace Framework
+{
+    namespace
+    {
+        const JsonNode sNullNode = { nullptr, 0, 0, JsonType::eNULL, { false } };
+        // Largest first block of a document arena
+        const size_t sArenaReserveMax = 64 * 1024;
+
+        /* Reads the 4 hex digits of a \u escape */
+        bool ReadHex(char*& aCursor, const char* aEnd, uint32_t& aCode)
+        {
+            if ( aEnd - aCursor < 4 )
+                return false;
+            aCode = 0;
+            for ( int i = 0; i < 4; ++i, ++aCursor )
+            {
+                const char c = *aCursor;
+                aCode <<= 4;
+                if ( c >= '0' && c <= '9' )
+                    aCode |= c - '0';
+                else if ( c >= 'a' && c <= 'f' )
+                    aCode |= c - 'a' + 10;
+                else if ( c >= 'A' && c <= 'F' )
+                    aCode |= c - 'A' + 10;
+                else
+                    return false;
+            }
+            return true;
+        }
+
+        char* EncodeUtf8(uint32_t aCode, char* aOut)
+        {
+            if ( aCode < 0x80 )
+            {
+                *aOut++ = static_cast<char>(aCode);
+            }
+            else if ( aCode < 0x800 )
+            {
+                *aOut++ = static_cast<char>(0xC0 | (aCode >> 6));
+                *aOut++ = static_cast<char>(0x80 | (aCode & 0x3F));
+            }
+            else if ( aCode < 0x10000 )
+            {
+                *aOut++ = static_cast<char>(0xE0 | (aCode >> 12));
+                *aOut++ = static_cast<char>(0x80 | ((aCode >> 6) & 0x3F));
+                *aOut++ = static_cast<char>(0x80 | (aCode & 0x3F));
+            }
+            else
+            {
+                *aOut++ = static_cast<char>(0xF0 | (aCode >> 18));
+                *aOut++ = static_cast<char>(0x80 | ((aCode >> 12) & 0x3F));
+                *aOut++ = static_cast<char>(0x80 | ((aCode >> 6) & 0x3F));
+                *aOut++ = static_cast<char>(0x80 | (aCode & 0x3F));
+            }
+            return aOut;
+        }
+
+        /* Builds the nodes of a document. The values of the open containers wait in a stack,
+           the children of a container are moved to the arena when it closes */
+        class DocumentBuilder : public JsonHandler
+        {
+        public:
+            explicit DocumentBuilder(JsonArena& aArena)
+                : mArena(aArena)
+            {
+                mStack.reserve(64);
+            }
+
+            bool Null() override { Push(JsonType::eNULL); return true; }
+            bool Bool(bool aValue) override { Push(JsonType::eBOOL).mBool = aValue; return true; }
+            bool Int(int64_t aValue) override { Push(JsonType::eINT).mInt = aValue; return true; }
+            bool UInt(uint64_t aValue) override { Push(JsonType::eUINT).mUInt = aValue; return true; }
+            bool Double(double aValue) override { Push(JsonType::eDOUBLE).mDouble = aValue; return true; }
+
+            bool String(const char* aValue, uint32_t aSize) override
+            {
+                JsonNode& lNode = Push(JsonType::eSTRING);
+                lNode.mString = aValue;
+                lNode.mSize = aSize;
+                return true;
+            }
+
+            bool StartObject() override { Push(JsonType::eOBJECT); return true; }
+            bool EndObject(uint32_t aMembers) override { Close(aMembers); return true; }
+            bool StartArray() override { Push(JsonType::eARRAY); return true; }
+            bool EndArray(uint32_t aElements) override { Close(aElements); return true; }
+
+            bool Key(const char* aName, uint32_t aSize) override
+            {
+                mName = aName;
+                mNameSize = aSize;
+                return true;
+            }
+
+            const JsonNode* Finish()
+            {
+                ASSERT(mStack.size() == 1);
+                JsonNode* lRoot = static_cast<JsonNode*>(mArena.Allocate(sizeof(JsonNode)));
+                *lRoot = mStack.back();
+                return lRoot;
+            }
+
+        private:
+            JsonNode& Push(JsonType aType)
+            {
+                mStack.emplace_back();
+                JsonNode& lNode = mStack.back();
+                lNode.mName = mName;
+                lNode.mNameSize = mNameSize;
+                lNode.mType = aType;
+                mName = nullptr;
+                mNameSize = 0;
+                return lNode;
+            }
+
+            void Close(uint32_t aChildren)
+            {
+                JsonNode* lChildren = nullptr;
+                if ( aChildren > 0 )
+                {
+                    lChildren = static_cast<JsonNode*>(mArena.Allocate(aChildren * sizeof(JsonNode)));
+                    memcpy(lChildren, &mStack[mStack.size() - aChildren], aChildren * sizeof(JsonNode));
+                    mStack.resize(mStack.size() - aChildren);
+                }
+                JsonNode& lContainer = mStack.back();
+                lContainer.mChildren = lChildren;
+                lContainer.mSize = aChildren;
+            }
+
+            JsonArena&              mArena;
+            std::vector<JsonNode>   mStack;
+            const char*             mName = nullptr;    // Name of the next member
+            uint32_t                mNameSize = 0;
+        };
+    }
+
+    //--------------------------------------------------------------------------
+    // JsonReader
+
+    bool JsonReader::Parse(char* aBegin, char* aEnd, JsonHandler& aHandler)
+    {
+        mBegin = mCursor = aBegin;
+        mEnd = aEnd;
+        mHandler = &aHandler;
+        mError.clear();
+
+        if ( mEnd - mCursor >= 3 && memcmp(mCursor, "\xEF\xBB\xBF", 3) == 0 )
+            mCursor += 3;
+        if ( !SkipSpaces() )
+            return false;
+        if ( mCursor == mEnd )
+            return Fail("The document is empty");
+        // The text after the root value is ignored, as jsoncpp does
+        return ParseValue(0);
+    }
+
+    bool JsonReader::ParseValue(uint32_t aDepth)
+    {
+        switch ( *mCursor )
+        {
+        case '{':
+            return ParseObject(aDepth + 1);
+        case '[':
+            return ParseArray(aDepth + 1);
+        case '"':
+            return ParseString(false);
+        case 't':
+            return ParseLiteral("true") && (mHandler->Bool(true) || Fail("The handler stopped the parse"));
+        case 'f':
+            return ParseLiteral("false") && (mHandler->Bool(false) || Fail("The handler stopped the parse"));
+        case 'n':
+            return ParseLiteral("null") && (mHandler->Null() || Fail("The handler stopped the parse"));
+        default:
+            if ( *mCursor == '-' || (*mCursor >= '0' && *mCursor <= '9') )
+                return ParseNumber();
+            return Fail("Syntax error: value, object or array expected");
+        }
+    }
+
+    bool JsonReader::ParseObject(uint32_t aDepth)
+    {
+        if ( aDepth > sMaxDepth )
+            return Fail("Exceeded the nesting limit");
+        ++mCursor;
+        if ( !mHandler->StartObject() )
+            return Fail("The handler stopped the parse");
+        if ( !SkipSpaces() )
+            return false;
+        if ( mCursor < mEnd && *mCursor == '}' )
+        {
+            ++mCursor;
+            return mHandler->EndObject(0) || Fail("The handler stopped the parse");
+        }
+
+        for ( uint32_t lMembers = 1; ; ++lMembers )
+        {
+            if ( mCursor == mEnd || *mCursor != '"' )
+                return Fail("Missing '\"' of an object member name");
+            if ( !ParseString(true) || !SkipSpaces() )
+                return false;
+            if ( mCursor == mEnd || *mCursor != ':' )
+                return Fail("Missing ':' after an object member name");
+            ++mCursor;
+            if ( !SkipSpaces() )
+                return false;
+            if ( mCursor == mEnd )
+                return Fail("Missing the value of an object member");
+            if ( !ParseValue(aDepth) || !SkipSpaces() )
+                return false;
+            if ( mCursor < mEnd && *mCursor == ',' )
+            {
+                ++mCursor;
+                if ( !SkipSpaces() )
+                    return false;
+                continue;
+            }
+            if ( mCursor < mEnd && *mCursor == '}' )
+            {
+                ++mCursor;
+                return mHandler->EndObject(lMembers) || Fail("The handler stopped the parse");
+            }
+            return Fail("Missing ',' or '}' in an object");
+        }
+    }
+
+    bool JsonReader::ParseArray(uint32_t aDepth)
+    {
+        if ( aDepth > sMaxDepth )
+            return Fail("Exceeded the nesting limit");
+        ++mCursor;
+        if ( !mHandler->StartArray() )
+            return Fail("The handler stopped the parse");
+        if ( !SkipSpaces() )
+            return false;
+        if ( mCursor < mEnd && *mCursor == ']' )
+        {
+            ++mCursor;
+            return mHandler->EndArray(0) || Fail("The handler stopped the parse");
+        }
+
+        for ( uint32_t lElements = 1; ; ++lElements )
+        {
+            if ( mCursor == mEnd )
+                return Fail("Missing ']' of an array");
+            if ( !ParseValue(aDepth) || !SkipSpaces() )
+                return false;
+            if ( mCursor < mEnd && *mCursor == ',' )
+            {
+                ++mCursor;
+                if ( !SkipSpaces() )
+                    return false;
+                continue;
+            }
+            if ( mCursor < mEnd && *mCursor == ']' )
+            {
+                ++mCursor;
+                return mHandler->EndArray(lElements) || Fail("The handler stopped the parse");
+            }
+            return Fail("Missing ',' or ']' in an array");
+        }
+    }
+
+    bool JsonReader::ParseString(bool aIsKey)
+    {
+        // The decoded string is never longer than the text, so it is written over it
+        char* lStart = ++mCursor;
+        char* lOut = lStart;
+        while ( mCursor < mEnd )
+        {
+            char c = *mCursor;
+            if ( c == '"' )
+            {
+                *lOut = '\0';
+                ++mCursor;
+                const uint32_t lSize = static_cast<uint32_t>(lOut - lStart);
+                const bool lGoOn = aIsKey ? mHandler->Key(lStart, lSize) : mHandler->String(lStart, lSize);
+                return lGoOn || Fail("The handler stopped the parse");
+            }
+            if ( c != '\\' )
+            {
+                *lOut++ = c;
+                ++mCursor;
+                continue;
+            }
+
+            if ( mEnd - mCursor < 2 )
+                break;
+            c = mCursor[1];
+            mCursor += 2;
+            switch ( c )
+            {
+            case '"':  *lOut++ = '"'; break;
+            case '\\': *lOut++ = '\\'; break;
+            case '/':  *lOut++ = '/'; break;
+            case 'b':  *lOut++ = '\b'; break;
+            case 'f':  *lOut++ = '\f'; break;
+            case 'n':  *lOut++ = '\n'; break;
+            case 'r':  *lOut++ = '\r'; break;
+            case 't':  *lOut++ = '\t'; break;
+            case 'u':
+            {
+                uint32_t lCode;
+                if ( !ReadHex(mCursor, mEnd, lCode) )
+                    return Fail("Bad unicode escape sequence in a string");
+                if ( lCode >= 0xD800 && lCode <= 0xDBFF )
+                {
+                    uint32_t lLow;
+                    if ( mEnd - mCursor < 6 || mCursor[0] != '\\' || mCursor[1] != 'u' )
+                        return Fail("Missing the second half of a unicode surrogate pair");
+                    mCursor += 2;
+                    if ( !ReadHex(mCursor, mEnd, lLow) || lLow < 0xDC00 || lLow > 0xDFFF )
+                        return Fail("Bad second half of a unicode surrogate pair");
+                    lCode = 0x10000 + ((lCode - 0xD800) << 10) + (lLow - 0xDC00);
+                }
+                lOut = EncodeUtf8(lCode, lOut);
+                break;
+            }
+            default:
+                return Fail("Bad escape sequence in a string");
+            }
+        }
+        return Fail("Missing '\"' at the end of a string");
+    }
+
+    bool JsonReader::ParseNumber()
+    {
+        // The grammar of jsoncpp: the digits of every part may be missing, so "-" is 0 and "1." is 1,
+        // and the text is an error only when strtod reads no number from it
+        const char* lStart = mCursor;
+        const bool lIsNegative = *mCursor == '-';
+        if ( lIsNegative )
+            ++mCursor;
+
+        uint64_t lValue = 0;
+        bool lIsDouble = false;
+        for ( ; mCursor < mEnd && *mCursor >= '0' && *mCursor <= '9'; ++mCursor )
+        {
+            const uint64_t lDigit = *mCursor - '0';
+            if ( lValue > (std::numeric_limits<uint64_t>::max() - lDigit) / 10 )
+                lIsDouble = true;   // out of the range of the integers
+            else
+                lValue = lValue * 10 + lDigit;
+        }
+        if ( mCursor < mEnd && *mCursor == '.' )
+        {
+            lIsDouble = true;
+            ++mCursor;
+            while ( mCursor < mEnd && *mCursor >= '0' && *mCursor <= '9' )
+                ++mCursor;
+        }
+        if ( mCursor < mEnd && (*mCursor == 'e' || *mCursor == 'E') )
+        {
+            lIsDouble = true;
+            ++mCursor;
+            if ( mCursor < mEnd && (*mCursor == '+' || *mCursor == '-') )
+                ++mCursor;
+            while ( mCursor < mEnd && *mCursor >= '0' && *mCursor <= '9' )
+                ++mCursor;
+        }
+
+        const uint64_t lMaxInt = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+        if ( !lIsDouble && !lIsNegative && lValue > lMaxInt )
+            return mHandler->UInt(lValue) || Fail("The handler stopped the parse");
+        if ( !lIsDouble && (lValue <= lMaxInt || (lIsNegative && lValue == lMaxInt + 1)) )
+        {
+            const int64_t lInt = lIsNegative ? static_cast<int64_t>(0 - lValue) : static_cast<int64_t>(lValue);
+            return mHandler->Int(lInt) || Fail("The handler stopped the parse");
+        }
+
+        // strtod needs a terminated copy, the text goes on after the number
+        char lBuffer[64];
+        std::string lLongNumber;
+        const size_t lLength = mCursor - lStart;
+        const char* lNumber = lBuffer;
+        if ( lLength < sizeof(lBuffer) )
+        {
+            memcpy(lBuffer, lStart, lLength);
+            lBuffer[lLength] = '\0';
+        }
+        else
+        {
+            lLongNumber.assign(lStart, lLength);
+            lNumber = lLongNumber.c_str();
+        }
+
+        // No number, as "-.", or one out of the range of a double, as 1e400
+        char* lNumberEnd = nullptr;
+        const double lDouble = strtod(lNumber, &lNumberEnd);
+        if ( lNumberEnd == lNumber || std::isinf(lDouble) )
+        {
+            mCursor = const_cast<char*>(lStart);
+            return Fail(("'" + std::string(lNumber) + "' is not a number.").c_str());
+        }
+        return mHandler->Double(lDouble) || Fail("The handler stopped the parse");
+    }
+
+    bool JsonReader::ParseLiteral(const char* aLiteral)
+    {
+        const size_t lLength = strlen(aLiteral);
+        if ( static_cast<size_t>(mEnd - mCursor) < lLength || memcmp(mCursor, aLiteral, lLength) != 0 )
+            return Fail("Syntax error: value, object or array expected");
+        mCursor += lLength;
+        return true;
+    }
+
+    bool JsonReader::SkipSpaces()
+    {
+        while ( mCursor < mEnd )
+        {
+            const char c = *mCursor;
+            if ( c == ' ' || c == '\t' || c == '\n' || c == '\r' )
+            {
+                ++mCursor;
+            }
+            else if ( c == '/' && mEnd - mCursor >= 2 && mCursor[1] == '/' )
+            {
+                while ( mCursor < mEnd && *mCursor != '\n' && *mCursor != '\r' )
+                    ++mCursor;
+            }
+            else if ( c == '/' && mEnd - mCursor >= 2 && mCursor[1] == '*' )
+            {
+                char* lEnd = mCursor + 2;
+                while ( mEnd - lEnd >= 2 && !(lEnd[0] == '*' && lEnd[1] == '/') )
+                    ++lEnd;
+                if ( mEnd - lEnd < 2 )
+                    return Fail("Missing the end of a comment");
+                mCursor = lEnd + 2;
+            }
+            else
+            {
+                break;
+            }
+        }
+        return true;
+    }
+
+    bool JsonReader::Fail(const char* aMessage)
+    {
+        uint32_t lLine = 1;
+        const char* lLineStart = mBegin;
+        for ( const char* c = mBegin; c < mCursor; ++c )
+        {
+            if ( *c == '\n' )
+            {
+                ++lLine;
+                lLineStart = c + 1;
+            }
+        }
+        char lPosition[64];
+        snprintf(lPosition, sizeof(lPosition), "Line %u, Column %u\n  ", lLine, static_cast<uint32_t>(mCursor - lLineStart) + 1);
+        mError = lPosition;
+        mError += aMessage;
+        mError += '\n';
+        return false;
+    }
+
+    //--------------------------------------------------------------------------
+    // JsonView
+
+    JsonView::JsonView()
+        : mNode(&sNullNode)
+    {
+    }
+
+    uint32_t JsonView::size() const
+    {
+        return isArray() || isObject() ? mNode->mSize : 0;
+    }
+
+    const JsonNode* JsonView::Find(const char* aName, size_t aSize) const
+    {
+        if ( !isObject() )
+            return nullptr;
+        // From the last member, a duplicated name finds the last one like in jsoncpp
+        for ( uint32_t i = mNode->mSize; i-- > 0; )
+        {
+            const JsonNode& lMember = mNode->mChildren[i];
+            if ( lMember.mNameSize == aSize && memcmp(lMember.mName, aName, aSize) == 0 )
+                return &lMember;
+        }
+        return nullptr;
+    }
+
+    JsonView JsonView::operator[](const char* aName) const
+    {
+        const JsonNode* lMember = Find(aName, strlen(aName));
+        return lMember ? JsonView(lMember) : JsonView();
+    }
+
+    JsonView JsonView::operator[](const std::string& aName) const
+    {
+        const JsonNode* lMember = Find(aName.c_str(), aName.size());
+        return lMember ? JsonView(lMember) : JsonView();
+    }
+
+    JsonView JsonView::operator[](uint32_t aIndex) const
+    {
+        return isArray() && aIndex < mNode->mSize ? JsonView(&mNode->mChildren[aIndex]) : JsonView();
+    }
+
+    std::string JsonView::asString() const
+    {
+        switch ( mNode->mType )
+        {
+        case JsonType::eSTRING:
+            return std::string(mNode->mString, mNode->mSize);
+        case JsonType::eBOOL:
+            return mNode->mBool ? "true" : "false";
+        case JsonType::eINT:
+            return std::to_string(mNode->mInt);
+        case JsonType::eUINT:
+            return std::to_string(mNode->mUInt);
+        case JsonType::eDOUBLE:
+        {
+            char lBuffer[32];
+            snprintf(lBuffer, sizeof(lBuffer), "%.17g", mNode->mDouble);
+            return lBuffer;
+        }
+        default:
+            return std::string();
+        }
+    }
+
+    bool JsonView::asBool() const
+    {
+        switch ( mNode->mType )
+        {
+        case JsonType::eBOOL:   return mNode->mBool;
+        case JsonType::eINT:    return mNode->mInt != 0;
+        case JsonType::eUINT:   return mNode->mUInt != 0;
+        case JsonType::eDOUBLE: return mNode->mDouble != 0.0;
+        default:                return false;
+        }
+    }
+
+    int64_t JsonView::asInt64() const
+    {
+        switch ( mNode->mType )
+        {
+        case JsonType::eBOOL:   return mNode->mBool ? 1 : 0;
+        case JsonType::eINT:    return mNode->mInt;
+        case JsonType::eUINT:   return static_cast<int64_t>(mNode->mUInt);
+        case JsonType::eDOUBLE: return static_cast<int64_t>(mNode->mDouble);
+        default:                return 0;
+        }
+    }
+
+    uint64_t JsonView::asUInt64() const
+    {
+        switch ( mNode->mType )
+        {
+        case JsonType::eBOOL:   return mNode->mBool ? 1 : 0;
+        case JsonType::eINT:    return static_cast<uint64_t>(mNode->mInt);
+        case JsonType::eUINT:   return mNode->mUInt;
+        case JsonType::eDOUBLE: return static_cast<uint64_t>(mNode->mDouble);
+        default:                return 0;
+        }
+    }
+
+    double JsonView::asDouble() const
+    {
+        switch ( mNode->mType )
+        {
+        case JsonType::eBOOL:   return mNode->mBool ? 1.0 : 0.0;
+        case JsonType::eINT:    return static_cast<double>(mNode->mInt);
+        case JsonType::eUINT:   return static_cast<double>(mNode->mUInt);
+        case JsonType::eDOUBLE: return mNode->mDouble;
+        default:                return 0.0;
+        }
+    }
+
+    std::string JsonView::get(const char* aName, const char* aDefault) const
+    {
+        const JsonNode* lMember = Find(aName, strlen(aName));
+        return lMember ? JsonView(lMember).asString() : std::string(aDefault);
+    }
+
+    std::string JsonView::get(const char* aName, const std::string& aDefault) const
+    {
+        const JsonNode* lMember = Find(aName, strlen(aName));
+        return lMember ? JsonView(lMember).asString() : aDefault;
+    }
+
+    bool JsonView::get(const char* aName, bool aDefault) const
+    {
+        const JsonNode* lMember = Find(aName, strlen(aName));
+        return lMember ? JsonView(lMember).asBool() : aDefault;
+    }
+
+    int JsonView::get(const char* aName, int aDefault) const
+    {
+        const JsonNode* lMember = Find(aName, strlen(aName));
+        return lMember ? JsonView(lMember).asInt() : aDefault;
+    }
+
+    float JsonView::get(const char* aName, float aDefault) const
+    {
+        const JsonNode* lMember = Find(aName, strlen(aName));
+        return lMember ? JsonView(lMember).asFloat() : aDefault;
+    }
+
+    JsonView::Iterator JsonView::begin() const
+    {
+        return Iterator(isArray() || isObject() ? mNode->mChildren : nullptr);
+    }
+
+    JsonView::Iterator JsonView::end() const
+    {
+        return Iterator(isArray() || isObject() ? mNode->mChildren + mNode->mSize : nullptr);
+    }
+
+    void JsonView::ToValue(Json::Value& aValue) const
+    {
+        switch ( mNode->mType )
+        {
+        case JsonType::eNULL:
+            aValue = Json::Value();
+            break;
+        case JsonType::eBOOL:
+            aValue = Json::Value(mNode->mBool);
+            break;
+        case JsonType::eINT:
+            // The types jsoncpp gives to the integers it reads
+            if ( mNode->mInt > std::numeric_limits<Json::Int>::max() )
+                aValue = Json::Value(static_cast<Json::UInt64>(mNode->mInt));
+            else
+                aValue = Json::Value(static_cast<Json::Int64>(mNode->mInt));
+            break;
+        case JsonType::eUINT:
+            aValue = Json::Value(static_cast<Json::UInt64>(mNode->mUInt));
+            break;
+        case JsonType::eDOUBLE:
+            aValue = Json::Value(mNode->mDouble);
+            break;
+        case JsonType::eSTRING:
+            aValue = Json::Value(mNode->mString, mNode->mString + mNode->mSize);
+            break;
+        case JsonType::eARRAY:
+            aValue = Json::Value(Json::arrayValue);
+            aValue.resize(mNode->mSize);
+            for ( uint32_t i = 0; i < mNode->mSize; ++i )
+                JsonView(&mNode->mChildren[i]).ToValue(aValue[i]);
+            break;
+        case JsonType::eOBJECT:
+            aValue = Json::Value(Json::objectValue);
+            for ( uint32_t i = 0; i < mNode->mSize; ++i )
+            {
+                const JsonNode& lMember = mNode->mChildren[i];
+                JsonView(&lMember).ToValue(aValue[std::string(lMember.mName, lMember.mNameSize)]);
+            }
+            break;
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // JsonArena
+
+    namespace
+    {
+        // The first word of a block points to the previous one, 8 bytes to keep the nodes aligned
+        const size_t sBlockHeader = 8;
+    }
+
+    void* JsonArena::Allocate(size_t aBytes)
+    {
+        aBytes = (aBytes + 7) & ~static_cast<size_t>(7);
+        if ( mUsed + aBytes > mCapacity )
+        {
+            size_t lCapacity = sBlockSize;
+            if ( mReserve > 0 )
+                lCapacity = mReserve;
+            lCapacity = std::max(lCapacity, aBytes + sBlockHeader);
+            mReserve = 0;
+            char* lBlock = new char[lCapacity];
+            *reinterpret_cast<char**>(lBlock) = mBlock;
+            mBlock = lBlock;
+            mUsed = sBlockHeader;
+            mCapacity = lCapacity;
+            mBytes += lCapacity;
+            ++mBlocks;
+        }
+        void* lPointer = mBlock + mUsed;
+        mUsed += aBytes;
+        return lPointer;
+    }
+
+    void JsonArena::Clear()
+    {
+        while ( mBlock )
+        {
+            char* lPrevious = *reinterpret_cast<char**>(mBlock);
+            delete[] mBlock;
+            mBlock = lPrevious;
+        }
+        mUsed = 0;
+        mCapacity = 0;
+        mReserve = 0;
+        mBytes = 0;
+        mBlocks = 0;
+    }
+
+    //--------------------------------------------------------------------------
+    // JsonDocument
+
+    bool JsonDocument::Parse(const char* aText, size_t aSize)
+    {
+        return Parse(std::string(aText, aSize));
+    }
+
+    bool JsonDocument::Parse(std::string&& aText)
+    {
+        mArena.Clear();
+        mRoot = nullptr;
+        mError.clear();
+        mText = std::move(aText);
+
+        // The nodes of a document take up to twice its text, the large ones go on in default blocks
+        mArena.Reserve(std::min(std::max(2 * mText.size(), static_cast<size_t>(256)), sArenaReserveMax));
+        DocumentBuilder lBuilder(mArena);
+        JsonReader lReader;
+        char* lBegin = &mText[0];
+        if ( !lReader.Parse(lBegin, lBegin + mText.size(), lBuilder) )
+        {
+            mError = lReader.GetError();
+            mArena.Clear();
+            return false;
+        }
+        mRoot = lBuilder.Finish();
+        return true;
+    }
+
+    bool JsonDocument::ParseFile(const std::string& aFileName)
+    {
+        std::ifstream lFile(aFileName, std::ios::binary | std::ios::ate);
+        if ( !lFile )
+        {
+            mError = "Can't open the file";
+            return false;
+        }
+        std::string lText(static_cast<size_t>(lFile.tellg()), '\0');
+        lFile.seekg(0);
+        if ( !lText.empty() && !lFile.read(&lText[0], lText.size()) )
+        {
+            mError = "Can't read the file";
+            return false;
+        }
+        return Parse(std::move(lText));
+    }
+}
@@ -0,0 +1,251 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Read-only JSON document for the loading paths. The text is parsed
+ *                in place by a SAX reader: the strings are decoded inside the text
+ *                and read from there, and the values are nodes allocated in an arena
+ *                of a few blocks, all released with the document. A jsoncpp tree
+ *                allocates every value, member name and map entry on the heap.
+ *
+ *                JsonView reads a node with the names of the Json::Value readers,
+ *                so a reader ports to it by the type of its argument, get returning
+ *                the converted value. The object members keep the order of the text,
+ *                the last one of a duplicated name is the one found, as in jsoncpp.
+ *                The loaders that are not ported parse their files with jsoncpp: a
+ *                document converted to a tree would cost both parses.
+ *******************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "core/utils.h"
+
+namespace Json
+{
+    class Value;
+}
+
+namespace Framework
+{
+    enum class JsonType : uint8_t
+    {
+        eNULL = 0,
+        eBOOL,
+        eINT,
+        eUINT,          /**< The integers above the range of int64_t */
+        eDOUBLE,
+        eSTRING,
+        eARRAY,
+        eOBJECT
+    };
+
+    struct JsonNode
+    {
+        const char*         mName;          /**< Member name in the text, nullptr for the array elements and the root */
+        uint32_t            mNameSize;
+        uint32_t            mSize;          /**< Bytes of a string, elements of an array, members of an object */
+        JsonType            mType;
+        union
+        {
+            bool            mBool;
+            int64_t         mInt;
+            uint64_t        mUInt;
+            double          mDouble;
+            const char*     mString;        /**< Null terminated, in the text */
+            const JsonNode* mChildren;      /**< In the arena */
+        };
+    };
+
+    /**
+     * Callbacks of the reader, in the order of the text. A string is only valid while the
+     * text is. Returning false stops the parse
+     */
+    class JsonHandler
+    {
+    public:
+        virtual ~JsonHandler() = default;
+
+        virtual bool    Null() = 0;
+        virtual bool    Bool(bool aValue) = 0;
+        virtual bool    Int(int64_t aValue) = 0;
+        virtual bool    UInt(uint64_t aValue) = 0;
+        virtual bool    Double(double aValue) = 0;
+        virtual bool    String(const char* aValue, uint32_t aSize) = 0;
+        virtual bool    StartObject() = 0;
+        virtual bool    Key(const char* aName, uint32_t aSize) = 0;
+        virtual bool    EndObject(uint32_t aMembers) = 0;
+        virtual bool    StartArray() = 0;
+        virtual bool    EndArray(uint32_t aElements) = 0;
+    };
+
+    /**
+     * SAX reader of the JSON jsoncpp accepts, comments included. The text is parsed in
+     * place: the strings are decoded over their escapes and null terminated over their
+     * closing quote. The numbers are the ones of jsoncpp, "-" and "1." included, the
+     * integers in the range of int64_t or uint64_t and the others doubles, except that a
+     * double out of range as 1e400 is an error where jsoncpp reads an infinity
+     */
+    class JsonReader
+    {
+    public:
+        bool                Parse(char* aBegin, char* aEnd, JsonHandler& aHandler);
+        const std::string&  GetError() const { return mError; }
+
+    private:
+        static const uint32_t sMaxDepth = 1000;
+
+        bool                ParseValue(uint32_t aDepth);
+        bool                ParseObject(uint32_t aDepth);
+        bool                ParseArray(uint32_t aDepth);
+        bool                ParseString(bool aIsKey);
+        bool                ParseNumber();
+        bool                ParseLiteral(const char* aLiteral);
+        bool                SkipSpaces();
+        bool                Fail(const char* aMessage);
+
+        char*               mBegin = nullptr;
+        char*               mCursor = nullptr;
+        char*               mEnd = nullptr;
+        JsonHandler*        mHandler = nullptr;
+        std::string         mError;
+    };
+
+    /** A node of a document, Json::Value const readers */
+    class JsonView
+    {
+    public:
+        class Iterator
+        {
+        public:
+            explicit        Iterator(const JsonNode* aNode) : mNode(aNode) {}
+            JsonView        operator*() const { return JsonView(mNode); }
+            Iterator&       operator++() { ++mNode; return *this; }
+            bool            operator!=(const Iterator& aOther) const { return mNode != aOther.mNode; }
+            bool            operator==(const Iterator& aOther) const { return mNode == aOther.mNode; }
+
+        private:
+            const JsonNode* mNode;
+        };
+
+                            JsonView();
+        explicit            JsonView(const JsonNode* aNode) : mNode(aNode) {}
+
+        JsonType            type() const { return mNode->mType; }
+        bool                isNull() const { return mNode->mType == JsonType::eNULL; }
+        bool                isBool() const { return mNode->mType == JsonType::eBOOL; }
+        bool                isInt() const { return mNode->mType == JsonType::eINT; }
+        bool                isUInt() const { return mNode->mType == JsonType::eUINT; }
+        bool                isDouble() const { return mNode->mType == JsonType::eDOUBLE; }
+        bool                isNumeric() const { return isInt() || isUInt() || isDouble(); }
+        bool                isString() const { return mNode->mType == JsonType::eSTRING; }
+        bool                isArray() const { return mNode->mType == JsonType::eARRAY; }
+        bool                isObject() const { return mNode->mType == JsonType::eOBJECT; }
+
+        /** Elements of an array, members of an object, 0 for the other values */
+        uint32_t            size() const;
+        bool                empty() const { return size() == 0; }
+        bool                isMember(const char* aName) const { return Find(aName, strlen(aName)) != nullptr; }
+        bool                isMember(const std::string& aName) const { return Find(aName.c_str(), aName.size()) != nullptr; }
+
+        /** The member or the element, a null value if there is none */
+        JsonView            operator[](const char* aName) const;
+        JsonView            operator[](const std::string& aName) const;
+        JsonView            operator[](uint32_t aIndex) const;
+        JsonView            operator[](int aIndex) const { return (*this)[static_cast<uint32_t>(aIndex)]; }
+
+        /** Name of a member, empty for the others */
+        std::string         name() const { return mNode->mName ? std::string(mNode->mName, mNode->mNameSize) : std::string(); }
+
+        /** The string in the text, without a copy. Empty for the other values */
+        const char*         asCString() const { return isString() ? mNode->mString : ""; }
+        std::string         asString() const;
+        bool                asBool() const;
+        int                 asInt() const { return static_cast<int>(asInt64()); }
+        unsigned int        asUInt() const { return static_cast<unsigned int>(asInt64()); }
+        int64_t             asInt64() const;
+        uint64_t            asUInt64() const;
+        float               asFloat() const { return static_cast<float>(asDouble()); }
+        double              asDouble() const;
+
+        /** The member converted, the default if there is none */
+        std::string         get(const char* aName, const char* aDefault) const;
+        std::string         get(const char* aName, const std::string& aDefault) const;
+        bool                get(const char* aName, bool aDefault) const;
+        int                 get(const char* aName, int aDefault) const;
+        float               get(const char* aName, float aDefault) const;
+
+        /** Elements of an array or members of an object */
+        Iterator            begin() const;
+        Iterator            end() const;
+
+        /** Copy into a jsoncpp tree, for the readers of Json::Value */
+        void                ToValue(Json::Value& aValue) const;
+
+    private:
+        const JsonNode*     Find(const char* aName, size_t aSize) const;
+
+        const JsonNode*     mNode;
+    };
+
+    /** Blocks of the nodes of a document, released together */
+    class JsonArena
+    {
+        NON_COPYABLE_CLASS(JsonArena);
+
+    public:
+                            JsonArena() = default;
+                            ~JsonArena() { Clear(); }
+
+        void*               Allocate(size_t aBytes);
+        void                Clear();
+        /** Size of the next block, the blocks after it take the default size */
+        void                Reserve(size_t aBytes) { mReserve = aBytes; }
+
+        size_t              GetBytes() const { return mBytes; }
+        uint32_t            GetBlocks() const { return mBlocks; }
+
+    private:
+        static const size_t sBlockSize = 16 * 1024;
+
+        char*               mBlock = nullptr;       /**< The current block, its first word points to the previous one */
+        size_t              mUsed = 0;
+        size_t              mCapacity = 0;
+        size_t              mReserve = 0;
+        size_t              mBytes = 0;             /**< Taken from the heap */
+        uint32_t            mBlocks = 0;
+    };
+
+    class JsonDocument
+    {
+        NON_COPYABLE_CLASS(JsonDocument);
+
+    public:
+                            JsonDocument() = default;
+
+        /** Parses a copy of the text, or the text itself. False with the error on a syntax error */
+        bool                Parse(const char* aText, size_t aSize);
+        bool                Parse(std::string&& aText);
+        bool                ParseFile(const std::string& aFileName);
+
+        /** The root value, null before a successful parse */
+        JsonView            GetRoot() const { return mRoot ? JsonView(mRoot) : JsonView(); }
+        const std::string&  GetError() const { return mError; }
+
+        /** Heap taken by the document: its text and its arena */
+        size_t              GetBytes() const { return mText.capacity() + mArena.GetBytes(); }
+        const JsonArena&    GetArena() const { return mArena; }
+
+    private:
+        std::string         mText;
+        JsonArena           mArena;
+        const JsonNode*     mRoot = nullptr;
+        std::string         mError;
+    };
+}
@@ -97,6 +97,43 @@ namespace Framework
             return result;
         }
 
+        //List the files of a directory with the given extension, not recursive
+        static std::vector<std::string> ListFiles(const std::string &aDirectory, const std::string &aExtension)
+        {
+            std::vector<std::string> lResult;
+#if !defined(_WIN32)
+            DIR *dp = opendir(aDirectory.c_str());
+            if (!dp)
+                return lResult;
+            struct dirent *ep;
+            while ((ep = readdir(dp))) {
+                const char *lFileName = ep->d_name;
+#else
+            WIN32_FIND_DATAA ffd;
+            std::string searchPath = aDirectory + "/*." + aExtension;
+            HANDLE handle = FindFirstFileA(searchPath.c_str(), &ffd);
+            if (handle == INVALID_HANDLE_VALUE)
+                return lResult;
+            do
+            {
+                const char *lFileName = ffd.cFileName;
+#endif
+                const size_t lLength = strlen(lFileName);
+                if (lLength <= aExtension.size() + 1 || lFileName[lLength - aExtension.size() - 1] != '.' ||
+                    aExtension.compare(lFileName + lLength - aExtension.size()) != 0)
+                    continue;
+                lResult.push_back(aDirectory + "/" + std::string(lFileName));
+#if !defined(_WIN32)
+            }
+            closedir(dp);
+#else
+            } while (FindNextFileA(handle, &ffd) != 0);
+            FindClose(handle);
+#endif
+            std::sort(lResult.begin(), lResult.end());
+            return lResult;
+        }
+
         // Does checks and returns the contents of the file
         // If it failed, it returns an empty string
         static std::string GetFileContents(const std::string& aFilePath)
@@ -11,6 +11,7 @@
 #include "engine.h"
 #include "core/serialization/serializableobject.h"
 #include "core/serialization/jsoncpputils.h"
+#include "core/graphic/texturecooker.h"
 
 using namespace LuaIntf;
 
@@ -82,6 +83,12 @@ namespace Framework
         Audio().Initialize();
         GameController().Initialize();
         PrefabManager().GetPrefabsFromConfig(Config());
+        TextureCooker::SetCacheDirectory(mConfig.GetCacheDirectory() + "/textures");
+        MemoryBudget lBudget;
+        lBudget.mCpuBytes = mConfig.GetCpuMemoryBudget();
+        lBudget.mGpuBytes = mConfig.GetGpuMemoryBudget();
+        ResourceManager().SetMemoryBudget(lBudget);
+        ResourceManager().EnableHotReload(mConfig.GetHotReload());
         ResourceManager().Initialize(mConfig.GetResourceFiles());
         Script().Initialize(mConfig.GetInitialStateFile());
 
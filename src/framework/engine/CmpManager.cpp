@@ -9,6 +9,14 @@
 #include "engine.h"
 #include "CmpManager.h"
 
+namespace Framework
+{
+    ComponentID RegisterCmpManager(ICmpManager* aCmpManager)
+    {
+        return Engine::Instance()->CmpManagerRegistry().RegisterCmpManager(aCmpManager);
+    }
+}
+
 /*
 namespace Framework
 {
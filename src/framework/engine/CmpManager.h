@@ -6,26 +6,37 @@
  *******************************************************************************/
 
 #pragma once
+#include <type_traits>
 #include "ICmpManager.h"
 #include "CmpManagerRegistry.h"
+#include "sparseset.h"
+#include "components/basecmp.h"
 
 namespace Framework
 {
 
+    // The registry of the engine gives the id, defined out of the header so it doesn't need engine.h
+    ComponentID RegisterCmpManager(ICmpManager* aCmpManager);
+
 #define INIT_CMP_MANAGER(aType, aName, aNumInstances) \
   CmpManager<aType>::Instance()->Init(aName, aNumInstances);
 
+// Make the components of aType reachable through the aBaseType lookups, like Entity::GetComponent<Object3DCmp>()
+#define LINK_CMP_MANAGER(aType, aBaseType) \
+  CmpManager<aType>::Instance()->LinkTo(CmpManager<aBaseType>::Instance());
+
     template< class BaseCmpT >
     class CmpManager : public ICmpManager
     {
     private:
 
-        std::vector<BaseCmp*>               mComponents;
+        SparseSet< shared_ptr<BaseCmp> >    mComponents;        // Owned components keyed by entity id
+        SparseSet< shared_ptr<BaseCmp> >    mLinkedComponents;  // Derived type components, only for the lookups
+        std::vector<ICmpManager*>           mBaseCmpManagers;
         static ComponentID                  mCompId;
-        size_t                              mMaxNumComponents;
-        bool                                mUpdatingComponents;
         static CmpManager<BaseCmpT>         mInstance;
         std::string                         mName;
+        shared_ptr<BaseCmp>                 (*mCreateCmp)() = nullptr;   // Creates a component of the type, nullptr for the abstract types
 
     public:
 
@@ -33,42 +44,89 @@ namespace Framework
 
         virtual int GetCmpID() { return mCompId; }
         virtual const char* GetName() const { return mName.c_str(); }
-        virtual size_t Size() const { return 0; }
+        virtual size_t Size() const { return mComponents.Size(); }
         virtual void Serialize(Json::Value& aSerializer) const {}
         virtual void Deserialize(Json::Value& aSerializer) const {}
 
-        // Reserv the memory to the instances
+        // Reserv the memory to the instances. It is only a hint, the manager grows on demand
         void Init(std::string aName, size_t aNumInstances)
         {
             ASSERT(mCompId == 0);   // Doesn't call this method more than one times!
             mName = aName;
-            mCompId = Engine::Instance()->CmpManagerRegistry().RegisterCmpManager(this);
-            mMaxNumComponents = aNumInstances;
-            mComponents.reserve(aNumInstances);
+            mCompId = RegisterCmpManager(this);
+            mComponents.Reserve(aNumInstances);
+            mCreateCmp = GetCmpCreator<BaseCmpT>();
+        }
+
+        // The manager knows the type of its components, so they are not created by name through the ObjectFactory
+        template< class T >
+        static typename std::enable_if< !std::is_abstract<T>::value, shared_ptr<BaseCmp> (*)() >::type GetCmpCreator()
+        {
+            return []() { return shared_ptr<BaseCmp>(new T); };
+        }
+
+        // The abstract base types only find the derived components, they don't have their own
+        template< class T >
+        static typename std::enable_if< std::is_abstract<T>::value, shared_ptr<BaseCmp> (*)() >::type GetCmpCreator()
+        {
+            return nullptr;
+        }
+
+        void LinkTo(ICmpManager* aBaseCmpManager)
+        {
+            mBaseCmpManagers.push_back(aBaseCmpManager);
         }
 
-        // Return with the new component
-        shared_ptr<BaseCmp> AddCmp() 
+        // Return with the new component of the entity
+        shared_ptr<BaseCmp> AddCmp(size_t aEntityID)
         {
-            ASSERT(mComponents.size() < mMaxNumComponents);  //Too many components - Increase the size of the components in the entity manager
-            shared_ptr<SerializableObject> lComponentInstance = Engine::Instance()->ObjectFactory().Create(mName);
-            shared_ptr<BaseCmp> lBaseCmpInstance = dynamic_pointer_cast<BaseCmp>(lComponentInstance);
+            ASSERT(!mComponents.Contains(aEntityID));  //One component per type and entity
+            if (!mCreateCmp)
+                CRASH("The '%s' components are abstract, they can't be created", mName.c_str());
+            shared_ptr<BaseCmp> lBaseCmpInstance = mCreateCmp();
             lBaseCmpInstance->SetCmpId(mCompId);
-            mComponents.push_back(lBaseCmpInstance.get());
+            mComponents.Insert(aEntityID, lBaseCmpInstance);
+            for (auto lBaseCmpManager : mBaseCmpManagers)
+                lBaseCmpManager->LinkCmp(aEntityID, lBaseCmpInstance);
             return lBaseCmpInstance;
         }
 
-        void RemoveCmp(BaseCmp* aBaseCmp)
+        void RemoveCmp(size_t aEntityID)
+        {
+            if (!mComponents.Remove(aEntityID))
+                return;
+            for (auto lBaseCmpManager : mBaseCmpManagers)
+                lBaseCmpManager->UnlinkCmp(aEntityID);
+        }
+
+        void LinkCmp(size_t aEntityID, const shared_ptr<BaseCmp>& aCmp)
+        {
+            mLinkedComponents.Insert(aEntityID, aCmp);
+        }
+
+        void UnlinkCmp(size_t aEntityID)
+        {
+            mLinkedComponents.Remove(aEntityID);
+        }
+
+        shared_ptr<BaseCmp> GetCmp(size_t aEntityID) const
+        {
+            const shared_ptr<BaseCmp>* lCmp = Find(aEntityID);
+            return lCmp ? *lCmp : shared_ptr<BaseCmp>();
+        }
+
+        // O(1) lookup of the entity component without touching the reference counter
+        const shared_ptr<BaseCmp>* Find(size_t aEntityID) const
         {
-            std::vector<BaseCmp*>::iterator lIter = std::find(mComponents.begin(), mComponents.end(), aBaseCmp);
-            if (lIter != mComponents.end())
-                mComponents.erase(lIter);
+            const shared_ptr<BaseCmp>* lCmp = mComponents.Find(aEntityID);
+            return lCmp ? lCmp : mLinkedComponents.Find(aEntityID);
         }
 
         void Update()
         {
-            for (auto lComponent : mComponents)
-                lComponent->Update();
+            // The dense array can change if an update creates or destroys components, so don't use iterators
+            for (size_t i = 0; i < mComponents.Size(); ++i)
+                mComponents[i]->Update();
         }
     };
 
@@ -15,7 +15,6 @@ namespace Framework
 {
     CmpManagerRegistry::CmpManagerRegistry() : mCmpID(0)
     {
-        mCmpManagers.resize(sMaxComponentId);
     }
 
     CmpManagerRegistry::~CmpManagerRegistry()
@@ -25,6 +24,8 @@ namespace Framework
 
     ICmpManager* CmpManagerRegistry::GetByCompID(ComponentID aCmpID)
     {
+        if (aCmpID >= mCmpManagers.size())
+            return NULL;
         return mCmpManagers[aCmpID];
     }
 
@@ -38,22 +39,16 @@ namespace Framework
 
     void CmpManagerRegistry::Update() 
     {
-        typedef vector< ICmpManager* >::const_iterator IT;
-        IT lCmpManagerIter = mCmpManagers.begin();
-        while (*lCmpManagerIter)
-        {
-            (*lCmpManagerIter)->Update();
-            lCmpManagerIter++;
-        }
+        for (ICmpManager* lCmpManager : mCmpManagers)
+            lCmpManager->Update();
     }
 
 
     unsigned int CmpManagerRegistry::RegisterCmpManager(ICmpManager* aNewManager)
     {
         ComponentID lNewId = mCmpID++;
-        // too many components defined?, increase cte Entity::max_component_id
-        ASSERT(lNewId < sMaxComponentId);
-        mCmpManagers[lNewId] = aNewManager;
+        ASSERT(lNewId == mCmpManagers.size());
+        mCmpManagers.push_back(aNewManager);
 
         // Register it in the dictionary by name
         mCmpManagerByName[aNewManager->GetName()] = aNewManager;
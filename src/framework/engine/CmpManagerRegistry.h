@@ -9,7 +9,6 @@
 #pragma once
 typedef unsigned int ComponentID;
 static const ComponentID sMinComponentId = 1;
-static const ComponentID sMaxComponentId = 64;
 
 namespace Framework
 {
@@ -28,7 +27,8 @@ namespace Framework
         CmpManagerRegistry();
         ~CmpManagerRegistry();
 
-        void         Update();
+        void         Update();   // Update each component type in one pass, in registration order
+        size_t       Size() const { return mCmpManagers.size(); }
 
         ICmpManager* GetByCompID(ComponentID aCmpID);
         ICmpManager* GetByCompName(const std::string &aCmpName);
@@ -8,8 +8,12 @@
 
 #pragma once
 
+#include <memory>
+
 namespace Framework
 {
+    class BaseCmp;
+
     class ICmpManager
     {
     public:
@@ -17,8 +21,11 @@ namespace Framework
         virtual const char* GetName() const = 0; //Return with the name of the cmpmanager like renderablecmp manager, tranformcmp manager...etc
         virtual int GetCmpID() = 0;
         virtual size_t Size() const = 0;  //Return with the size of the cmps
-        virtual shared_ptr<BaseCmp> AddCmp() = 0;
-        virtual void RemoveCmp(BaseCmp* aCmp) = 0;
+        virtual shared_ptr<BaseCmp> AddCmp(size_t aEntityID) = 0;  //Create a new component for the entity
+        virtual void RemoveCmp(size_t aEntityID) = 0;
+        virtual shared_ptr<BaseCmp> GetCmp(size_t aEntityID) const = 0;
+        virtual void LinkCmp(size_t aEntityID, const shared_ptr<BaseCmp>& aCmp) = 0;  //Make a derived type component visible by the base type
+        virtual void UnlinkCmp(size_t aEntityID) = 0;
         virtual void Update() { }
         virtual void Serialize(Json::Value& aSerializer) const {}
         virtual void Deserialize(Json::Value& aSerializer) const {}
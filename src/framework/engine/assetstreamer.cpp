@@ -0,0 +1,275 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Asynchronous loading of the 3D assets
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "engine/assetstreamer.h"
+#include "graphic/asset3d.h"
+#include "graphic/renderer.h"
+
+namespace Framework
+{
+    namespace
+    {
+        double Milliseconds(std::chrono::steady_clock::time_point aStart, std::chrono::steady_clock::time_point aEnd)
+        {
+            return std::chrono::duration<double, std::milli>(aEnd - aStart).count();
+        }
+    }
+
+    AssetStreamer::~AssetStreamer()
+    {
+        Shutdown();
+    }
+
+    std::shared_future<bool> AssetStreamer::Request(const std::shared_ptr<Asset3D>& aAsset, Callback aCallback)
+    {
+        ASSERT(aAsset);
+        if ( aAsset->mRendererResources )
+        {
+            std::promise<bool> lPromise;
+            lPromise.set_value(true);
+            if ( aCallback )
+                aCallback(aAsset, true);
+            return lPromise.get_future().share();
+        }
+
+        // The asset is already in flight, share its result
+        auto lFound = mJobs.find(aAsset.get());
+        if ( lFound != mJobs.end() )
+        {
+            if ( aCallback )
+                lFound->second->mCallbacks.push_back(std::move(aCallback));
+            return lFound->second->mFuture;
+        }
+
+        /* The placeholder takes the bounds from the header of a chunked file, the older
+           files would have to be loaded completely so they get a unit box */
+        ModelFile::Header lHeader;
+        if ( aAsset->mResourceName.empty() )
+        {
+            // Procedural data already in memory, only the upload is pending
+        }
+        else if ( ModelFile::ReadHeader(aAsset->mResourceName, lHeader) )
+        {
+            aAsset->mBoundingBox = BoundingBox(glm::vec3(lHeader.mBoundsMin[0], lHeader.mBoundsMin[1], lHeader.mBoundsMin[2]),
+                                               glm::vec3(lHeader.mBoundsMax[0], lHeader.mBoundsMax[1], lHeader.mBoundsMax[2]));
+            aAsset->mMaxLengthVertex = glm::vec3(lHeader.mMaxLengthVertex[0], lHeader.mMaxLengthVertex[1], lHeader.mMaxLengthVertex[2]);
+        }
+        else
+        {
+            aAsset->mBoundingBox = BoundingBox(glm::vec3(-0.5f), glm::vec3(0.5f));
+            aAsset->mMaxLengthVertex = glm::vec3(0.5f);
+        }
+        ++aAsset->mRevision;
+
+        auto lJob = std::make_shared<Job>();
+        lJob->mAsset = aAsset;
+        lJob->mGeneration = mGeneration;
+        lJob->mRequestTime = std::chrono::steady_clock::now();
+        lJob->mFuture = lJob->mPromise.get_future().share();
+        if ( aCallback )
+            lJob->mCallbacks.push_back(std::move(aCallback));
+        mJobs.emplace(aAsset.get(), lJob);
+
+        StartWorkers();
+        {
+            std::lock_guard<std::mutex> lLock(mMutex);
+            mQueue.push_back(lJob);
+        }
+        mCondition.notify_one();
+        return lJob->mFuture;
+    }
+
+    uint32_t AssetStreamer::Update(const Renderer& aRenderer)
+    {
+        const auto lStart = std::chrono::steady_clock::now();
+        mStats.mFrameUploads = 0;
+        mStats.mFrameBytes = 0;
+        mStats.mFrameTime = 0.0;
+
+        uint32_t lFinished = 0;
+        for ( ;; )
+        {
+            std::shared_ptr<Job> lJob;
+            {
+                std::lock_guard<std::mutex> lLock(mMutex);
+                if ( mDecodedJobs.empty() )
+                    break;
+                if ( mStats.mFrameUploads > 0 &&
+                     (mStats.mFrameBytes + mDecodedJobs.front()->mBytes > mBudgetBytes ||
+                      Milliseconds(lStart, std::chrono::steady_clock::now()) >= mBudgetTime) )
+                    break;
+                lJob = std::move(mDecodedJobs.front());
+                mDecodedJobs.pop_front();
+            }
+
+            // Requests dropped by Cancel while they were being decoded
+            if ( lJob->mGeneration != mGeneration )
+                continue;
+
+            bool lLoaded = lJob->mLoaded;
+            if ( lLoaded )
+            {
+                Asset3D& lAsset = *lJob->mAsset;
+                // CreateModel3D may have loaded the asset synchronously in the meantime
+                if ( lJob->mDecoded && !lAsset.mRendererResources )
+                {
+                    lAsset.TakeData(*lJob->mDecoded);
+                    lJob->mDecoded.reset();
+                }
+
+                lLoaded = aRenderer.PrepareForRendering(lAsset);
+                if ( lLoaded )
+                {
+                    ++mStats.mFrameUploads;
+                    mStats.mFrameBytes += lJob->mBytes;
+                }
+                else
+                    WARNING("Failed to prepare asset %s", lAsset.GetName().c_str());
+            }
+            Finish(*lJob, lLoaded);
+            ++lFinished;
+        }
+
+        mStats.mFrameTime = Milliseconds(lStart, std::chrono::steady_clock::now());
+        return lFinished;
+    }
+
+    void AssetStreamer::Finish(Job& aJob, bool aLoaded)
+    {
+        const double lLatency = Milliseconds(aJob.mRequestTime, std::chrono::steady_clock::now());
+        if ( aLoaded )
+        {
+            ++mStats.mCompleted;
+            mTotalLatency += lLatency;
+            mStats.mAverageLatency = mTotalLatency / mStats.mCompleted;
+            mStats.mMaxLatency = std::max(mStats.mMaxLatency, lLatency);
+        }
+        else
+            ++mStats.mFailed;
+
+        // Keep the job alive until the callbacks are done, they may request other assets
+        auto lFound = mJobs.find(aJob.mAsset.get());
+        std::shared_ptr<Job> lJob;
+        if ( lFound != mJobs.end() && lFound->second.get() == &aJob )
+        {
+            lJob = std::move(lFound->second);
+            mJobs.erase(lFound);
+        }
+
+        aJob.mPromise.set_value(aLoaded);
+        for ( auto& lCallback : aJob.mCallbacks )
+            lCallback(aJob.mAsset, aLoaded);
+        aJob.mCallbacks.clear();
+    }
+
+    void AssetStreamer::Cancel()
+    {
+        {
+            std::lock_guard<std::mutex> lLock(mMutex);
+            mQueue.clear();
+            mDecodedJobs.clear();
+        }
+        ++mGeneration;
+
+        auto lJobs = std::move(mJobs);
+        mJobs.clear();
+        for ( auto& lJob : lJobs )
+        {
+            ++mStats.mFailed;
+            lJob.second->mPromise.set_value(false);
+            for ( auto& lCallback : lJob.second->mCallbacks )
+                lCallback(lJob.second->mAsset, false);
+            lJob.second->mCallbacks.clear();
+        }
+    }
+
+    void AssetStreamer::Shutdown()
+    {
+        Cancel();
+        {
+            std::lock_guard<std::mutex> lLock(mMutex);
+            mStop = true;
+        }
+        mCondition.notify_all();
+        for ( auto& lWorker : mWorkers )
+            lWorker.join();
+        mWorkers.clear();
+
+        std::lock_guard<std::mutex> lLock(mMutex);
+        mDecodedJobs.clear();
+        mStop = false;
+    }
+
+    AssetStreamer::Stats AssetStreamer::GetStats() const
+    {
+        Stats lStats = mStats;
+        std::lock_guard<std::mutex> lLock(mMutex);
+        lStats.mQueued = static_cast<uint32_t>(mQueue.size());
+        lStats.mDecoding = mDecoding;
+        lStats.mWaitingUpload = static_cast<uint32_t>(mDecodedJobs.size());
+        return lStats;
+    }
+
+    void AssetStreamer::ResetStats()
+    {
+        mStats = Stats();
+        mTotalLatency = 0.0;
+    }
+
+    void AssetStreamer::StartWorkers()
+    {
+        if ( !mWorkers.empty() )
+            return;
+        // One core is left to the main thread
+        const uint32_t lCores = std::thread::hardware_concurrency();
+        const uint32_t lCount = std::min(sMaxWorkers, lCores > 1 ? lCores - 1 : 1u);
+        for ( uint32_t i = 0; i < lCount; ++i )
+            mWorkers.emplace_back(&AssetStreamer::WorkerLoop, this);
+        INFO(LogLevel::eLEVEL2, "Asset streamer started with %u worker threads", lCount);
+    }
+
+    void AssetStreamer::WorkerLoop()
+    {
+        for ( ;; )
+        {
+            std::shared_ptr<Job> lJob;
+            {
+                std::unique_lock<std::mutex> lLock(mMutex);
+                mCondition.wait(lLock, [this]() { return mStop || !mQueue.empty(); });
+                if ( mStop )
+                    return;
+                lJob = std::move(mQueue.front());
+                mQueue.pop_front();
+                ++mDecoding;
+            }
+
+            /* The worker only writes its own copy, the shared asset may be read by the
+               main thread in the meantime. The name and resource name never change */
+            const Asset3D& lAsset = *lJob->mAsset;
+            if ( lAsset.GetResourceName().empty() )
+                lJob->mLoaded = true;
+            else
+            {
+                lJob->mDecoded = std::make_unique<Asset3D>(lAsset.GetName(), lAsset.GetResourceName());
+                lJob->mLoaded = lJob->mDecoded->Load(lAsset.GetResourceName());
+                if ( lJob->mLoaded )
+                    lJob->mBytes = lJob->mDecoded->GetUploadSize();
+            }
+            if ( !lJob->mLoaded )
+                WARNING("Failed to load asset %s(%s)", lAsset.GetName().c_str(), lAsset.GetResourceName().c_str());
+
+            {
+                std::lock_guard<std::mutex> lLock(mMutex);
+                --mDecoding;
+                mDecodedJobs.push_back(std::move(lJob));
+            }
+        }
+    }
+}
@@ -0,0 +1,152 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Asynchronous loading of the 3D assets. Worker threads read and
+ *                decompress the model files into CPU buffers, the main thread moves
+ *                the decoded data into the shared Asset3D and uploads it to the GPU
+ *                within a per-frame budget:
+ *
+ *                    Request -> [queued] -> worker: Load -> [decoded] -> Update: upload -> ready
+ *
+ *                The shared asset is only written by the main thread, so the renderer
+ *                never sees a half loaded model. Until the upload is done the asset
+ *                keeps the bounds stored in the header of the file, which are used to
+ *                draw a placeholder box.
+ *******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Framework
+{
+    class Asset3D;
+    class Renderer;
+
+    class AssetStreamer final
+    {
+    public:
+        static const uint32_t sMaxWorkers = 4;
+
+        /**
+         * Called on the main thread once the asset is uploaded, or failed to load
+         */
+        using Callback = std::function<void(const std::shared_ptr<const Asset3D>& aAsset, bool aLoaded)>;
+
+        /**
+         * Counters of the streamer. The latency goes from the request to the end of the upload
+         */
+        struct Stats
+        {
+            uint32_t mQueued = 0;          /**< Requests waiting for a worker */
+            uint32_t mDecoding = 0;        /**< Requests being loaded by a worker */
+            uint32_t mWaitingUpload = 0;   /**< Decoded requests waiting for the upload budget */
+            uint64_t mCompleted = 0;       /**< Assets uploaded */
+            uint64_t mFailed = 0;          /**< Assets that could not be loaded or uploaded */
+            double   mAverageLatency = 0.0;/**< Milliseconds */
+            double   mMaxLatency = 0.0;    /**< Milliseconds */
+            uint32_t mFrameUploads = 0;    /**< Assets uploaded in the last update */
+            uint64_t mFrameBytes = 0;      /**< Bytes uploaded in the last update */
+            double   mFrameTime = 0.0;     /**< Milliseconds spent uploading in the last update */
+
+            uint32_t GetQueueDepth() const { return mQueued + mDecoding + mWaitingUpload; }
+        };
+
+        AssetStreamer() = default;
+        ~AssetStreamer();
+
+        AssetStreamer(const AssetStreamer&) = delete;
+        AssetStreamer& operator=(const AssetStreamer&) = delete;
+
+        /**
+         * Queues the load of an asset. A request for an asset already in flight shares
+         * its future, a request for an uploaded asset is resolved immediately.
+         * The future is resolved by Update on the main thread, so it must not be
+         * waited on from the main thread, only polled
+         *
+         * @param aAsset     Asset to load, it must not be used by a renderer yet
+         * @param aCallback  Optional notification, called on the main thread
+         *
+         * @return A future holding true if the asset was loaded and uploaded
+         */
+        std::shared_future<bool> Request(const std::shared_ptr<Asset3D>& aAsset, Callback aCallback = nullptr);
+
+        /**
+         * Uploads the decoded assets until the budget of the frame is spent. At least one
+         * asset is uploaded per call, so a model larger than the budget still progresses.
+         * It must be called on the main thread with the context of the renderer current
+         *
+         * @return Number of assets finished in this call
+         */
+        uint32_t Update(const Renderer& aRenderer);
+
+        /**
+         * Per-frame upload budget. The budget is spent when either limit is reached
+         *
+         * @param aBytes         Bytes of vertices, indices and textures
+         * @param aMilliseconds  Time spent creating the GPU resources
+         */
+        void SetUploadBudget(uint64_t aBytes, double aMilliseconds) { mBudgetBytes = aBytes; mBudgetTime = aMilliseconds; }
+
+        /**
+         * Drops all requests. Their futures are resolved with false and the assets being
+         * decoded are discarded when they come back from the workers
+         */
+        void Cancel();
+
+        /**
+         * Cancels the requests and joins the worker threads
+         */
+        void Shutdown();
+
+        bool  IsIdle() const { return mJobs.empty(); }
+        Stats GetStats() const;
+        void  ResetStats();
+
+    private:
+        struct Job
+        {
+            std::shared_ptr<Asset3D>   mAsset;
+            std::unique_ptr<Asset3D>   mDecoded;       /**< Written by the worker, adopted by the main thread */
+            bool                       mLoaded = false;
+            uint64_t                   mBytes = 0;
+            uint32_t                   mGeneration = 0;
+            std::chrono::steady_clock::time_point mRequestTime;
+            std::promise<bool>         mPromise;
+            std::shared_future<bool>   mFuture;
+            std::vector<Callback>      mCallbacks;
+        };
+
+        void StartWorkers();
+        void WorkerLoop();
+        void Finish(Job& aJob, bool aLoaded);
+
+        std::vector<std::thread>           mWorkers;
+        mutable std::mutex                 mMutex;
+        std::condition_variable            mCondition;
+        std::deque<std::shared_ptr<Job>>   mQueue;         /**< Guarded by mMutex */
+        std::deque<std::shared_ptr<Job>>   mDecodedJobs;   /**< Guarded by mMutex */
+        uint32_t                           mDecoding = 0;  /**< Guarded by mMutex */
+        bool                               mStop = false;  /**< Guarded by mMutex */
+
+        std::unordered_map<const Asset3D*, std::shared_ptr<Job>> mJobs;  /**< Requests in flight, main thread only */
+        uint32_t                           mGeneration = 0;
+        uint64_t                           mBudgetBytes = 16 * 1024 * 1024;
+        double                             mBudgetTime = 4.0;
+
+        Stats                              mStats;         /**< Completion counters, main thread only */
+        double                             mTotalLatency = 0.0;
+    };
+}
@@ -0,0 +1,381 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Incremental autosave
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "engine/autosave.h"
+#include "engine/projectfile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Framework
+{
+    namespace
+    {
+        /* The journal is compacted when it is larger than this part of the base */
+        const double sCompactionRatio = 0.5;
+
+        uint64_t FileSize(const std::string& aFileName)
+        {
+            std::ifstream lFile(aFileName, std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
+            return lFile ? static_cast<uint64_t>(lFile.tellg()) : 0;
+        }
+    }
+
+    AutosaveJournal::~AutosaveJournal()
+    {
+        {
+            std::lock_guard<std::mutex> lLock(mMutex);
+            mStop = true;
+        }
+        mCondition.notify_all();
+        if ( mWorker.joinable() )
+            mWorker.join();
+
+        // After a clean exit the autosave file holds the last autosave by itself
+        if ( mHasBase )
+            Compact(mFileName);
+    }
+
+    void AutosaveJournal::SetFileName(const std::string& aFileName)
+    {
+        Flush();
+        mFileName = aFileName;
+        mHasBase = false;
+        mScenes.clear();
+    }
+
+    bool AutosaveJournal::NeedsBase(const std::vector<std::string>& aScenes) const
+    {
+        std::lock_guard<std::mutex> lLock(mMutex);
+        return !mHasBase || aScenes != mScenes || mFailed;
+    }
+
+    void AutosaveJournal::Write(Snapshot&& aSnapshot, const std::vector<std::string>& aScenes)
+    {
+        ASSERT(!mFileName.empty());
+        const auto lStart = std::chrono::steady_clock::now();
+        if ( aSnapshot.mFull )
+        {
+            mHasBase = true;
+            mScenes = aScenes;
+        }
+
+        uint32_t lEntities = 0;
+        for ( const auto& lScene : aSnapshot.mScenes )
+            lEntities += static_cast<uint32_t>(lScene.mEntities.size());
+
+        std::unique_ptr<Snapshot> lSnapshot(new Snapshot(std::move(aSnapshot)));
+        {
+            std::lock_guard<std::mutex> lLock(mMutex);
+            if ( !mWorker.joinable() )
+                mWorker = std::thread(&AutosaveJournal::WorkerLoop, this);
+
+            const double lStall = lSnapshot->mTime
+                + std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - lStart).count();
+            mQueue.push_back(std::move(lSnapshot));
+            ++mStats.mAutosaves;
+            mStats.mLastStall = lStall;
+            mStats.mMaxStall = std::max(mStats.mMaxStall, lStall);
+            mStats.mLastEntities = lEntities;
+        }
+        mCondition.notify_all();
+    }
+
+    void AutosaveJournal::Flush()
+    {
+        std::unique_lock<std::mutex> lLock(mMutex);
+        mCondition.wait(lLock, [this]() { return mQueue.empty() && !mWriting; });
+    }
+
+    AutosaveJournal::Stats AutosaveJournal::GetStats() const
+    {
+        std::lock_guard<std::mutex> lLock(mMutex);
+        return mStats;
+    }
+
+    void AutosaveJournal::WorkerLoop()
+    {
+        std::unique_lock<std::mutex> lLock(mMutex);
+        for ( ;; )
+        {
+            mCondition.wait(lLock, [this]() { return mStop || !mQueue.empty(); });
+            if ( mQueue.empty() )
+                return; // stopped, after the queued snapshots are written
+
+            std::unique_ptr<Snapshot> lSnapshot = std::move(mQueue.front());
+            mQueue.pop_front();
+            // The journal misses the failed autosave, nothing goes on top of it until a base
+            const bool lSkip = mFailed && !lSnapshot->mFull;
+            mWriting = true;
+            lLock.unlock();
+
+            bool lWritten = true;
+            if ( lSnapshot->mFull )
+                lWritten = WriteBase(*lSnapshot);
+            else if ( !lSkip )
+                lWritten = AppendJournal(*lSnapshot);
+            lSnapshot.reset();
+            if ( !lWritten )
+                WARNING("Autosave to %s failed, the next autosave writes the whole project", mFileName.c_str());
+
+            lLock.lock();
+            if ( !lWritten )
+            {
+                mFailed = true;
+                ++mStats.mFailures;
+            }
+            mWriting = false;
+            mCondition.notify_all();
+        }
+    }
+
+    bool AutosaveJournal::WriteBase(const Snapshot& aSnapshot)
+    {
+        const std::string lNewFile = mFileName + ".new";
+        ProjectFile::Writer lWriter;
+        if ( !lWriter.Open(lNewFile) )
+            return false;
+
+        lWriter.WriteProject(aSnapshot.mProject);
+        for ( const auto& lScene : aSnapshot.mScenes )
+        {
+            lWriter.BeginScene(lScene.mHeader);
+            for ( const auto& lEntity : lScene.mEntities )
+                lWriter.WriteEntity(lEntity.second, lEntity.first);
+            lWriter.EndScene();
+        }
+        if ( !lWriter.Close() || !ProjectFile::ReplaceFile(lNewFile, mFileName) )
+            return false;
+        std::remove(GetJournalName(mFileName).c_str());
+
+        std::lock_guard<std::mutex> lLock(mMutex);
+        mFailed = false;
+        ++mStats.mFullAutosaves;
+        mStats.mLastBytes = lWriter.GetWrittenBytes();
+        mStats.mTotalBytes += lWriter.GetWrittenBytes();
+        mStats.mBaseBytes = lWriter.GetWrittenBytes();
+        mStats.mJournalBytes = 0;
+        return true;
+    }
+
+    bool AutosaveJournal::AppendJournal(const Snapshot& aSnapshot)
+    {
+        ProjectFile::Writer lWriter;
+        if ( !lWriter.Open(GetJournalName(mFileName), true) )
+            return false;
+
+        lWriter.WriteProject(aSnapshot.mProject);
+        for ( const auto& lScene : aSnapshot.mScenes )
+        {
+            lWriter.BeginScene(lScene.mHeader);
+            for ( const auto& lEntity : lScene.mEntities )
+                lWriter.WriteEntity(lEntity.second, lEntity.first);
+            lWriter.EndScene();
+        }
+        if ( !aSnapshot.mRemoved.empty() )
+            lWriter.WriteRemoved(aSnapshot.mRemoved);
+        // The end record commits the autosave
+        if ( !lWriter.Close() )
+            return false;
+
+        bool lCompact;
+        {
+            std::lock_guard<std::mutex> lLock(mMutex);
+            mStats.mLastBytes = lWriter.GetWrittenBytes();
+            mStats.mTotalBytes += lWriter.GetWrittenBytes();
+            mStats.mJournalBytes += lWriter.GetWrittenBytes();
+            lCompact = mStats.mJournalBytes > mStats.mBaseBytes * sCompactionRatio;
+        }
+
+        if ( lCompact && Compact(mFileName) )
+        {
+            const uint64_t lBaseBytes = FileSize(mFileName);
+            std::lock_guard<std::mutex> lLock(mMutex);
+            ++mStats.mCompactions;
+            mStats.mBaseBytes = lBaseBytes;
+            mStats.mJournalBytes = 0;
+        }
+        return true;
+    }
+
+    bool AutosaveJournal::Compact(const std::string& aFileName)
+    {
+        const std::string lJournalName = GetJournalName(aFileName);
+        if ( !std::ifstream(lJournalName).good() )
+            return true;
+
+        /* The last version of the entities in the journal, an autosave at a time */
+        struct Change
+        {
+            std::string mScene;
+            Json::Value mEntity;
+        };
+        Json::Value                             lProject;
+        std::unordered_map<std::string, Json::Value> lHeaders;
+        std::unordered_map<uint64_t, Change>    lChanged;
+        std::unordered_set<uint64_t>            lRemoved;
+        {
+            ProjectFile::Reader lReader;
+            if ( !lReader.Open(lJournalName) )
+                return false;
+
+            Json::Value lBatchProject;
+            std::vector<std::pair<std::string, Json::Value>> lBatchHeaders;
+            std::vector<std::pair<uint64_t, Change>> lBatchEntities;
+            std::vector<uint64_t> lBatchRemoved;
+            std::string lScene;
+            bool lTruncated = false;
+            while ( !lTruncated && !lReader.AtEnd() )
+            {
+                Json::Value lValue;
+                switch ( lReader.Next(lValue) )
+                {
+                case ProjectFile::Record::ePROJECT:
+                    lBatchProject.swap(lValue);
+                    break;
+                case ProjectFile::Record::eSCENE:
+                    lScene = lValue["sceneName"].asString();
+                    lBatchHeaders.emplace_back(lScene, Json::Value());
+                    lBatchHeaders.back().second.swap(lValue);
+                    break;
+                case ProjectFile::Record::eENTITY:
+                    lBatchEntities.emplace_back(lReader.GetEntityKey(), Change());
+                    lBatchEntities.back().second.mScene = lScene;
+                    lBatchEntities.back().second.mEntity.swap(lValue);
+                    break;
+                case ProjectFile::Record::eSCENE_END:
+                    break;
+                case ProjectFile::Record::eREMOVE:
+                    for ( const Json::Value& lKey : lValue )
+                        lBatchRemoved.push_back(lKey.asUInt64());
+                    break;
+                case ProjectFile::Record::eEND:
+                    if ( !lBatchProject.isNull() )
+                        lProject.swap(lBatchProject);
+                    for ( auto& lHeader : lBatchHeaders )
+                        lHeaders[lHeader.first].swap(lHeader.second);
+                    for ( auto& lEntity : lBatchEntities )
+                    {
+                        Change& lChange = lChanged[lEntity.first];
+                        lChange.mScene = lEntity.second.mScene;
+                        lChange.mEntity.swap(lEntity.second.mEntity);
+                        lRemoved.erase(lEntity.first);
+                    }
+                    for ( uint64_t lKey : lBatchRemoved )
+                    {
+                        lChanged.erase(lKey);
+                        lRemoved.insert(lKey);
+                    }
+                    lBatchProject = Json::Value();
+                    lBatchHeaders.clear();
+                    lBatchEntities.clear();
+                    lBatchRemoved.clear();
+                    break;
+                default:
+                    // An autosave cut by a crash, the ones before it are kept
+                    WARNING("Ignoring the last autosave of %s, it is incomplete", lJournalName.c_str());
+                    lTruncated = true;
+                    break;
+                }
+            }
+        }
+
+        /* The new entities go at the end of their scene, by id */
+        std::unordered_map<std::string, std::vector<uint64_t>> lSceneKeys;
+        for ( const auto& lChange : lChanged )
+            lSceneKeys[lChange.second.mScene].push_back(lChange.first);
+        for ( auto& lKeys : lSceneKeys )
+            std::sort(lKeys.second.begin(), lKeys.second.end());
+
+        const std::string lNewFile = aFileName + ".new";
+        {
+            ProjectFile::Reader lBase;
+            ProjectFile::Writer lWriter;
+            if ( !lBase.Open(aFileName) || !lWriter.Open(lNewFile) )
+                return false;
+
+            std::unordered_set<uint64_t> lWritten;
+            std::unordered_set<std::string> lScenes;
+            auto lWriteChanges = [&](const std::string& aScene)
+            {
+                for ( uint64_t lKey : lSceneKeys[aScene] )
+                {
+                    if ( lWritten.insert(lKey).second )
+                        lWriter.WriteEntity(lChanged[lKey].mEntity, lKey);
+                }
+            };
+
+            std::string lScene;
+            bool lEnd = false;
+            while ( !lEnd )
+            {
+                Json::Value lValue;
+                switch ( lBase.Next(lValue) )
+                {
+                case ProjectFile::Record::ePROJECT:
+                    lWriter.WriteProject(lProject.isNull() ? lValue : lProject);
+                    break;
+                case ProjectFile::Record::eSCENE:
+                {
+                    lScene = lValue["sceneName"].asString();
+                    lScenes.insert(lScene);
+                    auto lHeader = lHeaders.find(lScene);
+                    lWriter.BeginScene(lHeader != lHeaders.end() ? lHeader->second : lValue);
+                    break;
+                }
+                case ProjectFile::Record::eENTITY:
+                {
+                    // A changed entity keeps its place, a removed one or one that changed of scene is dropped
+                    const uint64_t lKey = lBase.GetEntityKey();
+                    auto lChange = lChanged.find(lKey);
+                    if ( lChange == lChanged.end() )
+                    {
+                        if ( !lRemoved.count(lKey) )
+                            lWriter.WriteEntity(lValue, lKey);
+                    }
+                    else if ( lChange->second.mScene == lScene && lWritten.insert(lKey).second )
+                        lWriter.WriteEntity(lChange->second.mEntity, lKey);
+                    break;
+                }
+                case ProjectFile::Record::eSCENE_END:
+                    lWriteChanges(lScene);
+                    lWriter.EndScene();
+                    break;
+                case ProjectFile::Record::eEND:
+                    lEnd = true;
+                    break;
+                default:
+                    return false;
+                }
+            }
+
+            // Scenes that are only in the journal
+            for ( const auto& lHeader : lHeaders )
+            {
+                if ( lScenes.count(lHeader.first) )
+                    continue;
+                lWriter.BeginScene(lHeader.second);
+                lWriteChanges(lHeader.first);
+                lWriter.EndScene();
+            }
+            if ( !lWriter.Close() )
+                return false;
+        }
+
+        if ( !ProjectFile::ReplaceFile(lNewFile, aFileName) )
+            return false;
+        std::remove(lJournalName.c_str());
+        return true;
+    }
+}
@@ -0,0 +1,134 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Incremental autosave. The main thread only serializes the entities
+ *                changed since the previous autosave into a snapshot, a worker thread
+ *                appends it to a journal next to the autosave file:
+ *
+ *                    autosave.project          binary project, the base
+ *                    autosave.project.journal  the autosaves since the base, each one
+ *                                              the scenes with changes, their changed
+ *                                              entities and the removed ones
+ *
+ *                The first autosave of a session, and the ones after a scene is added
+ *                or removed, write the whole project as the base. When the journal
+ *                grows past a part of the base, the worker compacts them into a new
+ *                base. An autosave cut by a crash lacks its end record and is ignored
+ *                by the compaction, with the ones after it. So after a failed write the
+ *                worker drops the queued journal autosaves and the next autosave writes
+ *                the base again, which holds the changes of the failed one.
+ *******************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+#include "json/json.h"
+
+namespace Framework
+{
+    class AutosaveJournal final
+    {
+    public:
+        /**
+         * Changes of the project, serialized on the main thread
+         */
+        struct Snapshot
+        {
+            struct SceneChanges
+            {
+                Json::Value                                  mHeader;     /**< Attributes of the scene, see Scene::SerializeHeader */
+                std::vector<std::pair<uint64_t, Json::Value>> mEntities;  /**< Entity id and entity */
+            };
+
+            bool                      mFull = false;   /**< The whole project, it becomes the base */
+            Json::Value               mProject;        /**< Project properties */
+            std::vector<SceneChanges> mScenes;
+            std::vector<uint64_t>     mRemoved;        /**< Ids of the removed entities */
+            double                    mTime = 0.0;     /**< Milliseconds spent serializing it */
+        };
+
+        struct Stats
+        {
+            uint32_t mAutosaves = 0;
+            uint32_t mFullAutosaves = 0;    /**< Autosaves that wrote a base */
+            uint32_t mCompactions = 0;
+            double   mLastStall = 0.0;      /**< Milliseconds of the last autosave on the main thread */
+            double   mMaxStall = 0.0;
+            uint32_t mLastEntities = 0;     /**< Entities written by the last autosave */
+            uint64_t mLastBytes = 0;        /**< Bytes written by the last finished autosave */
+            uint64_t mTotalBytes = 0;       /**< Bytes written by the autosaves, the compactions excluded */
+            uint64_t mBaseBytes = 0;
+            uint64_t mJournalBytes = 0;
+            uint32_t mFailures = 0;         /**< Writes that failed, each one makes the next autosave a base */
+        };
+
+        ~AutosaveJournal();
+
+        /**
+         * Starts a session on the autosave file: the next autosave writes the base
+         */
+        void SetFileName(const std::string& aFileName);
+        const std::string& GetFileName() const { return mFileName; }
+
+        /**
+         * @return true if the next snapshot must be a full one: there is no base in
+         *         this session, the scenes changed or a write failed
+         */
+        bool NeedsBase(const std::vector<std::string>& aScenes) const;
+
+        /**
+         * Queues the write of a snapshot and returns
+         *
+         * @param aScenes  Names of the scenes of the project, kept to know when the base
+         *                 has to be written again
+         */
+        void Write(Snapshot&& aSnapshot, const std::vector<std::string>& aScenes);
+
+        /**
+         * Waits until the queued snapshots are written
+         */
+        void Flush();
+
+        Stats GetStats() const;
+
+        /**
+         * Compacts the journal of an autosave file into it, so the file holds the last
+         * autosave. Nothing is done if there is no journal
+         *
+         * @return false if the files could not be read or written
+         */
+        static bool Compact(const std::string& aFileName);
+
+        static std::string GetJournalName(const std::string& aFileName) { return aFileName + ".journal"; }
+
+    private:
+        void WorkerLoop();
+        bool WriteBase(const Snapshot& aSnapshot);
+        bool AppendJournal(const Snapshot& aSnapshot);
+
+        std::string                            mFileName;
+        bool                                   mHasBase = false;   /**< Main thread only */
+        std::vector<std::string>               mScenes;            /**< Scenes of the base, main thread only */
+
+        std::thread                            mWorker;
+        mutable std::mutex                     mMutex;
+        std::condition_variable                mCondition;
+        std::deque<std::unique_ptr<Snapshot>>  mQueue;             /**< Guarded by mMutex */
+        bool                                   mWriting = false;   /**< Guarded by mMutex */
+        bool                                   mFailed = false;    /**< Guarded by mMutex, a write failed and no base was written since */
+        bool                                   mStop = false;      /**< Guarded by mMutex */
+        Stats                                  mStats;             /**< Guarded by mMutex */
+    };
+}
@@ -8,6 +8,8 @@
 
 #include "precompiled.h"
 
+#include <deque>
+
 #include "core/serialization/jsoncpputils.h"
 
 #include "engine.h"
@@ -18,11 +20,16 @@
 #include "engine/CmpManager.h"
 #include "engine/message.h"
 #include "engine/entitymanager.h"
+#include "engine/prefabtemplate.h"
 
 namespace Framework
 {
+    /* The ids of the destroyed entities are reused oldest first, and only once enough of
+       them wait: an id kept by a script or a message after its entity is gone doesn't
+       find the next entity created */
+    static const size_t          sMinFreeIds = 1024;
     static uint32_t              sId = 0;
-    static std::vector<uint32_t> sReservedIds;
+    static std::deque<uint32_t>  sFreeIds;
 
     uint32_t Entity::GetDefaultID()
     {
@@ -31,12 +38,18 @@ namespace Framework
 
     uint32_t Entity::AqcuireEntityId()
     {
-       do
-       {
-           sId += 1;
-       }
-       while ( std::find(sReservedIds.cbegin(), sReservedIds.cend(), static_cast<uint32_t>(sId)) != sReservedIds.cend() );
-       return sId;
+        if ( sFreeIds.size() >= sMinFreeIds )
+        {
+            uint32_t lId = sFreeIds.front();
+            sFreeIds.pop_front();
+            return lId;
+        }
+        return ++sId;
+    }
+
+    void Entity::ReleaseEntityId(uint32_t aEntityId)
+    {
+        sFreeIds.push_back(aEntityId);
     }
 
     Entity::Entity()
@@ -59,42 +72,38 @@ namespace Framework
 
     Entity::~Entity()
     {
-        for(shared_ptr<BaseCmp> lComponent : mComponents )
+        CmpManagerRegistry& lRegistry = Engine::Instance()->CmpManagerRegistry();
+        for ( ComponentID lCmpId : mComponents )
         {
-            ICmpManager *lCmpBase = Engine::Instance()->CmpManagerRegistry().GetByCompID(lComponent->GetCmpId());
-            lCmpBase->RemoveCmp(lComponent.get());
+            ICmpManager *lCmpBase = lRegistry.GetByCompID(lCmpId);
+            lCmpBase->RemoveCmp(mEntityID);
         }
         mComponents.clear();
+
+        // The components are gone, so the id can be given to a new entity
+        ReleaseEntityId(static_cast<uint32_t>(mEntityID));
     }
 
     void Entity::AddComponent(shared_ptr<BaseCmp> lComponent)
     {
         lComponent->mCreationPriority = (uint32_t)mComponents.size();
-        mComponents.push_back(lComponent);
+        mComponents.push_back(lComponent->GetCmpId());
         lComponent->SetOwner(this);
         ComponentAdded.Emit(lComponent);
-        SortComponents();
     }
 
-    void Entity::SortComponents()
+    void Entity::SetName( const string& aName )
     {
-       // some components, like MotionCmp update other components, like TransformCmp and so must run before them
-       // one way to ensure this is to sort and update them using a priority index (lower value means lower priority)
-       // another way would be to have dedicated "systems" for updating each component type
-       // the system update order would be determined at compile time, so no need for sorting in that case
-       std::function<bool(const shared_ptr<BaseCmp> lLeftCmp, const shared_ptr<BaseCmp> lRightCmp)> lSortPred =
-          [](const shared_ptr<BaseCmp> lLeftCmp, const shared_ptr<BaseCmp> lRightCmp)
-       {
-          return lLeftCmp->GetUpdatePriority() > lRightCmp->GetUpdatePriority();
-       };
-
-       std::sort(mComponents.begin(), mComponents.end(), lSortPred);
+        if ( mName == aName )
+            return;
+        string lOldName( std::move(mName) );
+        mName = aName;
+        Engine::Instance()->EntityManager().OnEntityRenamed(*this, lOldName);
     }
 
-
-    void Entity::SetName( const string& aName )
+    void Entity::MarkDirty() const
     {
-        mName = aName;
+        Engine::Instance()->EntityManager().MarkDirty(mEntityID);
     }
 
     void Entity::SetActive(const bool aActive)
@@ -105,22 +114,18 @@ namespace Framework
     void Entity::Send(const Msg& aMsg)
     {
         // For the all callbacks that registed for a following message
-        MsgsSubscriptions::const_iterator lSubscriptionIter = Engine::Instance()->EntityManager().mMsgsSubscriptions.find(aMsg.mMsgType);
-        while (lSubscriptionIter != Engine::Instance()->EntityManager().mMsgsSubscriptions.end() && lSubscriptionIter->first == aMsg.mMsgType)
+        const MsgsSubscriptions& lSubscriptions = Engine::Instance()->EntityManager().mMsgsSubscriptions;
+        auto lSubscriptionRange = lSubscriptions.equal_range(aMsg.mMsgType);
+        for (auto lSubscriptionIter = lSubscriptionRange.first; lSubscriptionIter != lSubscriptionRange.second; ++lSubscriptionIter)
         {
-            vector<shared_ptr<BaseCmp>>::iterator lCmpIter = mComponents.begin();
-            while (lCmpIter != mComponents.end())
+            // If the entity has that component
+            ICmpManager* lCmpManager = Engine::Instance()->CmpManagerRegistry().GetByCompID(lSubscriptionIter->second.mComponentId);
+            shared_ptr<BaseCmp> lCmp = lCmpManager ? lCmpManager->GetCmp(mEntityID) : nullptr;
+            if (lCmp)
             {
-                // If the entity has that component
-                if (lCmpIter->get()->GetCmpId() == lSubscriptionIter->second.mComponentId)
-                {
-                    // Call the virtual Execute methode, wherewith we can make the upcast and send the message
-                    BaseCmp* lBaseCmp = lCmpIter->get();
-                    lSubscriptionIter->second.mMethod->Execute(lBaseCmp, aMsg);
-                }
+                // Call the virtual Execute methode, wherewith we can make the upcast and send the message
+                lSubscriptionIter->second.mMethod->Execute(lCmp.get(), aMsg);
             }
-            
-            lSubscriptionIter++;
         }
     }
 
@@ -132,14 +137,13 @@ namespace Framework
         {
             Json::Value& v = aSerializer["components"];
             v = Json::Value(Json::ValueType::arrayValue);
-            std::vector< std::shared_ptr<BaseCmp> > lComponents(mComponents); // copy
-            auto lSortPred = [](const shared_ptr<BaseCmp> lLeftCmp, const shared_ptr<BaseCmp> lRightCmp)
-            { return lLeftCmp->mCreationPriority < lRightCmp->mCreationPriority; };
-            std::sort(lComponents.begin(), lComponents.end(), lSortPred);
-            for ( Json::ArrayIndex i = 0; i < lComponents.size(); ++i )
+            // mComponents is kept in creation order
+            CmpManagerRegistry& lRegistry = Engine::Instance()->CmpManagerRegistry();
+            for ( Json::ArrayIndex i = 0; i < mComponents.size(); ++i )
             {
-                v[i]["type"] = Framework::Utils::Demangling(typeid(*lComponents[i]).name());
-                lComponents[i]->Serialize(v[i]);
+                shared_ptr<BaseCmp> lComponent = lRegistry.GetByCompID(mComponents[i])->GetCmp(mEntityID);
+                v[i]["type"] = Framework::Utils::Demangling(typeid(*lComponent).name());
+                lComponent->Serialize(v[i]);
             }
         }
     }
@@ -156,11 +160,29 @@ namespace Framework
             ICmpManager* lCmpManager = Engine::Instance()->CmpManagerRegistry().GetByCompName(lComponentType);
             ASSERT(lCmpManager != nullptr);
 
-            shared_ptr<BaseCmp> lNewCmp = lCmpManager->AddCmp();
+            shared_ptr<BaseCmp> lNewCmp = lCmpManager->AddCmp(mEntityID);
             ASSERT(lNewCmp != nullptr);
 
             AddComponent(lNewCmp);
             lNewCmp->Deserialize(lComponent);
         }
     }
+
+    void Entity::Instantiate(const PrefabTemplate& aTemplate, const Json::Value& aOverride)
+    {
+        SetName( aTemplate.GetName(aOverride) );
+
+        CmpManagerRegistry& lRegistry = Engine::Instance()->CmpManagerRegistry();
+        auto lResolver = [&lRegistry](const std::string& aType) { return lRegistry.GetByCompName(aType); };
+        aTemplate.VisitComponents(aOverride, lResolver, [this](ICmpManager* aCmpManager, const Json::Value& aValues)
+        {
+            ASSERT(aCmpManager != nullptr);
+
+            shared_ptr<BaseCmp> lNewCmp = aCmpManager->AddCmp(mEntityID);
+            ASSERT(lNewCmp != nullptr);
+
+            AddComponent(lNewCmp);
+            lNewCmp->Deserialize(aValues);
+        });
+    }
 }
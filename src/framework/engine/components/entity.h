@@ -10,10 +10,13 @@
 #include <vector>
 #include "core/signal.h"
 #include "core/serialization/serializableobject.h"
+#include "engine/CmpManagerRegistry.h"
+#include "engine/CmpManager.h"
 
 namespace Framework
 {
     class BaseCmp;
+    class PrefabTemplate;
     struct Msg;
 }
 
@@ -39,6 +42,11 @@ namespace Framework
         const bool          IsActive() const { return mActive; }
         size_t              GetEntityID() const { return mEntityID; }
 
+        /**
+         * Records a change of the entity or of its components for the next autosave
+         */
+        void                MarkDirty() const;
+
         template <class COMPONENT_TYPE>
         std::weak_ptr<COMPONENT_TYPE> GetComponent() const;
 
@@ -50,10 +58,16 @@ namespace Framework
         virtual void        Serialize(Json::Value& serializer) const override;
         virtual void        Deserialize(const Json::Value& serializer) override;
 
+        /**
+         * Creates the components of a compiled prefab, with the values of the override
+         * merged in, as Deserialize does with the merged JSON of the prefab
+         */
+        void                Instantiate(const PrefabTemplate& aTemplate, const Json::Value& aOverride);
+
     private:
         static uint32_t     AqcuireEntityId();
+        static void         ReleaseEntityId(uint32_t aEntityId);
         void                AddComponent(std::shared_ptr<BaseCmp> aComponent);
-        void                SortComponents();
 
         Signal<std::shared_ptr<BaseCmp>>      ComponentAdded;
 
@@ -61,19 +75,15 @@ namespace Framework
         std::string                           mName;
         bool                                  mActive;
         size_t                                mEntityID;
-        std::vector<std::shared_ptr<BaseCmp>> mComponents;
+        std::vector<ComponentID>              mComponents;  // Component types of the entity, in creation order. The components live in the CmpManagers
     };
 
     template <class COMPONENT_TYPE>
     std::weak_ptr<COMPONENT_TYPE> Entity::GetComponent() const
     {
-        for ( std::shared_ptr<BaseCmp> lComponent : mComponents )
-        {
-            if ( std::shared_ptr<COMPONENT_TYPE> sComponent = std::dynamic_pointer_cast<COMPONENT_TYPE>(lComponent) )
-            {
-                return std::weak_ptr<COMPONENT_TYPE>( sComponent );
-            }
-        }
+        const std::shared_ptr<BaseCmp>* lComponent = CmpManager<COMPONENT_TYPE>::Instance()->Find(mEntityID);
+        if ( lComponent )
+            return std::weak_ptr<COMPONENT_TYPE>( std::static_pointer_cast<COMPONENT_TYPE>(*lComponent) );
 
         return std::weak_ptr<COMPONENT_TYPE>();
     }
@@ -81,13 +91,6 @@ namespace Framework
     template <class COMPONENT_TYPE>
     bool Entity::HasComponent() const
     {
-        for (std::shared_ptr<BaseCmp> lComponent : mComponents)
-        {
-            if (std::shared_ptr<COMPONENT_TYPE> sComponent = std::dynamic_pointer_cast<COMPONENT_TYPE>(lComponent))
-            {
-                return true;
-            }
-        }
-        return false;
+        return CmpManager<COMPONENT_TYPE>::Instance()->Find(mEntityID) != nullptr;
     }
 }
@@ -10,6 +10,7 @@
 #include "precompiled.h"
 #include "engine.h"
 #include "engine/components/entity.h"
+#include "engine/CmpManager.h"
 #include "engine/components/cameracmp.h"
 #include "engine/components/motioncmp.h"
 #include "engine/components/transformcmp.h"
@@ -81,16 +81,18 @@ namespace Framework
             // check for procedural model names
             if (lModelName.compare("#plane") == 0)
             {
-                auto lPlaneAsset = std::make_shared<Procedural::Plane>();
+                // All the planes share the mesh of the cache, and are drawn as its instances
                 auto lRenderer = Engine::Instance()->Display().GetRenderer();
-                if (!lRenderer->PrepareForRendering(*lPlaneAsset))
-                    CRASH("Failed to prepare model %s\n", lPlaneAsset->GetName().c_str());
+                auto lPlaneAsset = Engine::Instance()->ResourceManager().ProceduralMeshes().Get<Procedural::Plane>(*lRenderer);
+                if (!lPlaneAsset)
+                    CRASH("Failed to prepare model %s\n", lModelName.c_str());
                 mModel3D = new Model3D(std::move(lPlaneAsset));
             }
             // else create model from asset3d
             else
             {
-                mModel3D = Engine::Instance()->ResourceManager().CreateModel3D(lModelName);
+                // The mesh is streamed in the background, the model shows a placeholder until it arrives
+                mModel3D = Engine::Instance()->ResourceManager().CreateModel3DAsync(lModelName);
                 if (!mModel3D)
                     return;
                 // create a buddy model2d for non-procedural model3d
@@ -11,6 +11,7 @@
 #include "engine.h"
 #include "engine/components/cameracmp.h"
 #include "engine/components/entity.h"
+#include "engine/CmpManager.h"
 #include "engine/components/renderablecmp.h"
 #include "engine/components/transformcmp.h"
 
@@ -34,6 +35,7 @@ namespace Framework
           lObj3D->SetPosition(mPosition);
           lObj3D->SetOrientation(lOrientation);
           lObj3D->SetScaleFactor(mScaling);
+          lObj3D->RefitSpatialProxy();
           mTransformChanged = false;
        }
     }
@@ -42,18 +44,24 @@ namespace Framework
     {
        mPosition = aPosition;
        mTransformChanged = true;
+       if (mOwner)
+          mOwner->MarkDirty();
     }
 
     void TransformCmp::SetOrientation(const glm::quat& aOrientation)
     {
        mOrientation = aOrientation;
        mTransformChanged = true;
+       if (mOwner)
+          mOwner->MarkDirty();
     }
 
     void TransformCmp::SetScale(const glm::vec3& aScale)
     {
        mScaling = aScale;
        mTransformChanged = true;
+       if (mOwner)
+          mOwner->MarkDirty();
     }
 
     glm::vec3 TransformCmp::GetPosition()
@@ -0,0 +1,99 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Dependencies between the resources and the files they are loaded from
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "engine/dependencygraph.h"
+
+namespace Framework
+{
+    const uint32_t DependencyGraph::sInvalidNode;
+
+    std::string DependencyGraph::GetKey(NodeType aType, const std::string& aName)
+    {
+        std::string lKey(1, static_cast<char>('0' + static_cast<int>(aType)));
+        lKey += aName;
+        if ( aType == NodeType::eFILE )
+            std::replace(lKey.begin(), lKey.end(), '\\', '/');
+        return lKey;
+    }
+
+    uint32_t DependencyGraph::AddNode(NodeType aType, const std::string& aName)
+    {
+        std::string lKey = GetKey(aType, aName);
+        auto lFound = mIndex.find(lKey);
+        if ( lFound != mIndex.end() )
+            return lFound->second;
+
+        const uint32_t lNode = static_cast<uint32_t>(mNodes.size());
+        Node lNew;
+        lNew.mType = aType;
+        lNew.mName = lKey.substr(1);
+        mNodes.push_back(std::move(lNew));
+        mIndex.emplace(std::move(lKey), lNode);
+        return lNode;
+    }
+
+    uint32_t DependencyGraph::FindNode(NodeType aType, const std::string& aName) const
+    {
+        auto lFound = mIndex.find(GetKey(aType, aName));
+        return lFound != mIndex.end() ? lFound->second : sInvalidNode;
+    }
+
+    void DependencyGraph::AddDependency(uint32_t aDependent, uint32_t aDependency)
+    {
+        ASSERT(aDependent < mNodes.size() && aDependency < mNodes.size() && aDependent != aDependency);
+        std::vector<uint32_t>& lDependencies = mNodes[aDependent].mDependencies;
+        if ( std::find(lDependencies.begin(), lDependencies.end(), aDependency) != lDependencies.end() )
+            return;
+        lDependencies.push_back(aDependency);
+        mNodes[aDependency].mDependents.push_back(aDependent);
+        ++mEdges;
+    }
+
+    void DependencyGraph::ClearDependencies(uint32_t aDependent)
+    {
+        ASSERT(aDependent < mNodes.size());
+        for ( uint32_t lDependency : mNodes[aDependent].mDependencies )
+        {
+            std::vector<uint32_t>& lDependents = mNodes[lDependency].mDependents;
+            lDependents.erase(std::remove(lDependents.begin(), lDependents.end(), aDependent), lDependents.end());
+            --mEdges;
+        }
+        mNodes[aDependent].mDependencies.clear();
+    }
+
+    void DependencyGraph::CollectDependents(uint32_t aNode, std::vector<uint32_t>& aDependents) const
+    {
+        ASSERT(aNode < mNodes.size());
+        std::vector<bool> lVisited(mNodes.size(), false);
+        lVisited[aNode] = true;
+
+        // Breadth first, the list itself is the queue
+        auto lVisit = [this, &lVisited, &aDependents](uint32_t aFrom)
+        {
+            for ( uint32_t lDependent : mNodes[aFrom].mDependents )
+                if ( !lVisited[lDependent] )
+                {
+                    lVisited[lDependent] = true;
+                    aDependents.push_back(lDependent);
+                }
+        };
+        const size_t lFirst = aDependents.size();
+        lVisit(aNode);
+        for ( size_t i = lFirst; i < aDependents.size(); ++i )
+            lVisit(aDependents[i]);
+    }
+
+    void DependencyGraph::Clear()
+    {
+        mNodes.clear();
+        mIndex.clear();
+        mEdges = 0;
+    }
+}
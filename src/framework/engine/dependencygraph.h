@@ -0,0 +1,88 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Dependencies between the resources and the files they are loaded
+ *                from, recorded while they load: a model depends on its model file
+ *                and on its materials, a material on its texture, a shader program
+ *                on its stage files. The dependents of a changed file are the nodes
+ *                that have to be loaded again, and only them.
+ *******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+namespace Framework
+{
+    class DependencyGraph
+    {
+    public:
+        static const uint32_t sInvalidNode = 0xFFFFFFFF;
+
+        enum class NodeType : uint8_t
+        {
+            eFILE = 0,
+            eSHADER,
+            eASSET3D,
+            eASSET2D,
+            eIMAGE,
+            eMATERIAL,
+            eTEXTURE,
+        };
+
+        struct Node
+        {
+            NodeType              mType;
+            std::string           mName;           /**< Resource name, or the path of a file */
+            std::vector<uint32_t> mDependencies;   /**< Nodes this one is built from */
+            std::vector<uint32_t> mDependents;     /**< Nodes built from this one */
+        };
+
+        /**
+         * @return The node of the resource, added if it does not exist. The separators
+         *         of the file paths are unified
+         */
+        uint32_t AddNode(NodeType aType, const std::string& aName);
+
+        /**
+         * @return The node or sInvalidNode
+         */
+        uint32_t FindNode(NodeType aType, const std::string& aName) const;
+
+        /**
+         * Records that aDependent is built from aDependency, once
+         */
+        void     AddDependency(uint32_t aDependent, uint32_t aDependency);
+
+        /**
+         * Forgets what the node is built from, before the resource records its
+         * dependencies again when it is reloaded
+         */
+        void     ClearDependencies(uint32_t aDependent);
+
+        /**
+         * Collects the nodes built from the node, directly or not, nearest first.
+         * Each node appears once, even when it is reached by several paths
+         */
+        void     CollectDependents(uint32_t aNode, std::vector<uint32_t>& aDependents) const;
+
+        const Node& GetNode(uint32_t aNode) const { return mNodes[aNode]; }
+        uint32_t    GetNodeCount() const { return static_cast<uint32_t>(mNodes.size()); }
+        uint32_t    GetEdgeCount() const { return mEdges; }
+
+        void        Clear();
+
+    private:
+        static std::string GetKey(NodeType aType, const std::string& aName);
+
+        std::vector<Node>                         mNodes;
+        std::unordered_map<std::string, uint32_t> mIndex;   /**< Type and name to node */
+        uint32_t                                  mEdges = 0;
+    };
+}
@@ -10,6 +10,7 @@
 #include "objectfactory.h"
 #include "core\logger.h"
 #include "CmpManager.h"
+#include "prefabmanager.h"
 
 #include "components/entity.h"
 #include "components/basecmp.h"
@@ -32,16 +33,18 @@ namespace Framework
 
     EntityManager::~EntityManager()
     {
-        ASSERT( mEntities.empty() );
+        ASSERT( mEntities.Empty() );
     }
 
     void EntityManager::Initialize()
     {
         //REGISTER THE COMPONENTS ORDER THAT YOU WANT TO UPDATE THE COMPONENTS
+        //Each component type is updated in one pass, so the MotionCmp (it modifies the TransformCmp) goes before the TransformCmp.
+        //The number of instances is only a reservation hint, the managers grow on demand
         INIT_CMP_MANAGER(CameraCmp,      typeid(CameraCmp).name(),      64);
         INIT_CMP_MANAGER(CatalogCmp,     typeid(CatalogCmp).name(),     64);
-        INIT_CMP_MANAGER(TransformCmp,   typeid(TransformCmp).name(),   64);
         INIT_CMP_MANAGER(MotionCmp,      typeid(MotionCmp).name(),      64);
+        INIT_CMP_MANAGER(TransformCmp,   typeid(TransformCmp).name(),   64);
 
         INIT_CMP_MANAGER(Object3DCmp,    typeid(Object3DCmp).name(),    64);
         INIT_CMP_MANAGER(RenderableCmp,  typeid(RenderableCmp).name(),  64);
@@ -49,12 +52,23 @@ namespace Framework
         INIT_CMP_MANAGER(SpotLightCmp,   typeid(SpotLightCmp).name(),   64);
         INIT_CMP_MANAGER(PointLightCmp,  typeid(PointLightCmp).name(),  64);
 
+        //The Object3DCmp is abstract, its lookups find the derived components
+        LINK_CMP_MANAGER(CameraCmp,      Object3DCmp);
+        LINK_CMP_MANAGER(RenderableCmp,  Object3DCmp);
+        LINK_CMP_MANAGER(DirectLightCmp, Object3DCmp);
+        LINK_CMP_MANAGER(SpotLightCmp,   Object3DCmp);
+        LINK_CMP_MANAGER(PointLightCmp,  Object3DCmp);
+
         SUBSCRIBE(CatalogCmp, eMSG_ENTITY_CREATED, OnNewEntity);
     }
 
     void EntityManager::DeInitialize()
     {
-        mEntities.clear();
+        mDestroyedEntities.clear();
+        mDirtyEntities.clear();
+        mRemovedEntities.clear();
+        mNames.Clear();
+        mEntities.Clear();
     }
 
     void EntityManager::Update()
@@ -69,20 +83,26 @@ namespace Framework
         if (mDestroyedEntities.size() == 0)
             return;
 
-        for ( const shared_ptr<Entity>& lEntity : mDestroyedEntities )
-        {
-            for (auto i = mEntities.begin(); i != mEntities.end(); ++i)
-            {
-                if ( *i == lEntity )
-                {
-                    mEntities.erase(i);
-                    break;
-                }
-            }
-        }
+        for ( size_t lEntityID : mDestroyedEntities )
+            RemoveEntity( lEntityID );
         mDestroyedEntities.clear();
     }
 
+    void EntityManager::RemoveEntity( size_t aEntityID )
+    {
+        shared_ptr<Entity>* lEntity = mEntities.Find( aEntityID );
+        if ( !lEntity )
+            return;
+
+        mNames.Remove( aEntityID );
+
+        // Keep the entity alive until it is out of the containers, its destructor releases the id
+        shared_ptr<Entity> lRemovedEntity = *lEntity;
+        mEntities.Remove( aEntityID );
+        mDirtyEntities.erase( aEntityID );
+        mRemovedEntities.insert( aEntityID );
+    }
+
     weak_ptr<Framework::Entity> EntityManager::CreateEntity()
     {
         shared_ptr<SerializableObject> lObj = Engine::Instance()->ObjectFactory().Create("class Framework::Entity");
@@ -109,83 +129,118 @@ namespace Framework
         return weak_ptr<Entity>(lEntity);
     }
 
-    weak_ptr<Framework::Entity> EntityManager::CreateEntityFromPrefab(const std::string& prefabName)
+    weak_ptr<Framework::Entity> EntityManager::CreateEntityFromPrefab(const std::string& aPrefabName, const Json::Value& aOverride)
     {
-        Json::Value prefab = Engine::Instance()->PrefabManager().GetPrefab(prefabName);
-        return CreateEntityFromData(prefab);
+        // An override of the type makes another entity, only the JSON knows it
+        const PrefabTemplate* lTemplate = Engine::Instance()->PrefabManager().GetTemplate(aPrefabName);
+        if ( !lTemplate || aOverride.isMember("type") )
+        {
+            Json::Value lPrefab = Engine::Instance()->PrefabManager().GetPrefab(aPrefabName);
+            if ( !aOverride.isNull() )
+                Json::JsonUtils::OverrideEntity(lPrefab, aOverride);
+            return CreateEntityFromData(lPrefab);
+        }
+
+        shared_ptr<Entity> lEntity(new Entity());
+        lEntity->Instantiate(*lTemplate, aOverride);
+        AddEntity(lEntity);
+        return weak_ptr<Entity>(lEntity);
     }
 
     void EntityManager::AddEntity( const shared_ptr<Entity>& aEntity )
     {
-        for (auto i = mEntities.begin(); i != mEntities.end(); ++i)
-            if ( *i == aEntity )
-                CRASH("EntityManager::AddEntity : Attempt to add the same entity twice");
-        mEntities.push_back( aEntity );
+        if ( mEntities.Contains( aEntity->GetEntityID() ) )
+            CRASH("EntityManager::AddEntity : Attempt to add the same entity twice");
+        mEntities.Insert( aEntity->GetEntityID(), aEntity );
+        mNames.Add( aEntity->GetEntityID(), aEntity->GetName() );
+        MarkDirty( aEntity->GetEntityID() );
     }
 
     void EntityManager::DestroyEntity( size_t aEntityID )
     {
-        for ( auto& lEntity : mEntities )
-            if ( lEntity->GetEntityID() == aEntityID )
-                mDestroyedEntities.push_back(lEntity);
+        if ( !mEntities.Contains( aEntityID ) )
+            return;
+        // An id queued twice is removed once, RemoveEntity finds nothing the second time
+        mDestroyedEntities.push_back( aEntityID );
+    }
+
+    void EntityManager::DestroyEntityNow( size_t aEntityID )
+    {
+        // A queued id of the same entity finds nothing at the next update
+        RemoveEntity( aEntityID );
     }
 
     std::shared_ptr<Entity> EntityManager::GetEntityByID(size_t aEntityID) const
     {
-        for ( const shared_ptr<Entity>& lEntity : mEntities )
-        {
-            if ( lEntity->GetEntityID() == aEntityID )
-            {
-                return lEntity;
-            }
-        }
-        return std::shared_ptr<Entity>();
+        const shared_ptr<Entity>* lEntity = mEntities.Find( aEntityID );
+        return lEntity ? *lEntity : std::shared_ptr<Entity>();
     }
 
     shared_ptr<Entity> EntityManager::GetEntityByName( const std::string& aName ) const
     {
-        for ( const shared_ptr<Entity>& lEntity : mEntities )
-        {
-            if ( lEntity->GetName().compare(aName) == 0 )
-            {
-                return lEntity;
-            }
-        }
-        return std::shared_ptr<Entity>();
+        size_t lEntityID = 0;
+        return mNames.Find( aName, lEntityID ) ? GetEntityByID( lEntityID ) : std::shared_ptr<Entity>();
     }
 
     void EntityManager::GetEntitiesByName( const std::string& aName, std::vector<weak_ptr<Entity>>& entities ) const
     {
-        for ( const shared_ptr<Entity>& lEntity : mEntities )
-        {
-            if ( lEntity->GetName().compare(aName) == 0 )
-            {
-                entities.push_back( weak_ptr<Entity>( lEntity ) );
-            }
-        }
+        std::vector<size_t> lEntityIDs;
+        mNames.FindAll( aName, lEntityIDs );
+        std::sort( lEntityIDs.begin(), lEntityIDs.end() );
+        for ( size_t lEntityID : lEntityIDs )
+            entities.push_back( weak_ptr<Entity>( GetEntityByID( lEntityID ) ) );
     }
 
     shared_ptr<Entity> EntityManager::GetEntityByNameSubString( const std::string& aName ) const
     {
-        for ( const shared_ptr<Entity>& lEntity : mEntities )
+        // The lowest id, the candidates of the index come in no order
+        size_t lEntityID = 0;
+        bool lFound = false;
+        mNames.VisitSubString( aName, [&lEntityID, &lFound](size_t aEntityID)
         {
-            if ( lEntity->GetName().find(aName) != std::string::npos )
-            {
-                return lEntity;
-            }
-        }
-        return std::shared_ptr<Entity>();
+            if ( !lFound || aEntityID < lEntityID )
+                lEntityID = aEntityID;
+            lFound = true;
+        });
+        return lFound ? GetEntityByID( lEntityID ) : std::shared_ptr<Entity>();
     }
 
     void EntityManager::GetEntitiesByNameSubString( const std::string& aName, std::vector<weak_ptr<Entity>>& entities ) const
     {
-        for ( const shared_ptr<Entity>& lEntity : mEntities )
+        std::vector<size_t> lEntityIDs;
+        mNames.VisitSubString( aName, [&lEntityIDs](size_t aEntityID)
         {
-            if ( lEntity->GetName().find( aName ) != std::string::npos )
-            {
-                entities.push_back( weak_ptr<Entity>( lEntity ) );
-            }
-        }
+            lEntityIDs.push_back( aEntityID );
+        });
+        std::sort( lEntityIDs.begin(), lEntityIDs.end() );
+
+        for ( size_t lEntityID : lEntityIDs )
+            entities.push_back( weak_ptr<Entity>( GetEntityByID( lEntityID ) ) );
+    }
+
+    void EntityManager::OnEntityRenamed( const Entity& aEntity, const std::string& aOldName )
+    {
+        if ( !mEntities.Contains( aEntity.GetEntityID() ) )
+            return;
+        mNames.Rename( aEntity.GetEntityID(), aEntity.GetName() );
+        MarkDirty( aEntity.GetEntityID() );
+    }
+
+    void EntityManager::MarkDirty( size_t aEntityID )
+    {
+        if ( !mEntities.Contains( aEntityID ) )
+            return;
+        mDirtyEntities.insert( aEntityID );
+        // A reused id is a new entity, which replaces the removed one
+        mRemovedEntities.erase( aEntityID );
+    }
+
+    void EntityManager::TakeChanges( std::vector<size_t>& aDirty, std::vector<size_t>& aRemoved )
+    {
+        aDirty.assign( mDirtyEntities.begin(), mDirtyEntities.end() );
+        aRemoved.assign( mRemovedEntities.begin(), mRemovedEntities.end() );
+        mDirtyEntities.clear();
+        mRemovedEntities.clear();
     }
 
     void EntityManager::Serialize(Json::Value& aSerializer) const
@@ -200,20 +255,11 @@ namespace Framework
         const Json::Value& entities = aSerializer["entities"];
         for (const auto& lEntity : entities)
         {
-            Json::Value finalentity;
-
             std::string prefab = lEntity.get("prefab", "").asString();
             if (!prefab.empty())
-            {
-                finalentity = Engine::Instance()->PrefabManager().GetPrefab(prefab);
-                Json::Value overrideParams = lEntity["override"];
-                Json::JsonUtils::OverrideEntity(finalentity, overrideParams);
-            }
+                CreateEntityFromPrefab(prefab, lEntity["override"]);
             else
-            {
-                finalentity = lEntity;
-            }
-            CreateEntityFromData(finalentity);
+                CreateEntityFromData(lEntity);
         }
     }
 
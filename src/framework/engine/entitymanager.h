@@ -7,13 +7,17 @@
 
 #pragma once
 
-#include <list>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "core/utils.h"
 #include "core/serialization/jsoncpputils.h"
 #include "core/serialization/serializableobject.h"
+#include "entitynameindex.h"
 #include "message.h"
+#include "sparseset.h"
 
 namespace Framework
 {
@@ -42,10 +46,16 @@ namespace Framework
         std::weak_ptr<Entity>   CreateEntity();
         std::weak_ptr<Entity>   CreateEntity( const std::string& aName );
         std::weak_ptr<Entity>   CreateEntityFromData( const Json::Value& aSerializer);
-        std::weak_ptr<Entity>   CreateEntityFromPrefab(const std::string& aPrefabName);
+        /**
+         * Creates an instance of a prefab, with the values of the override. A compiled
+         * prefab is instantiated from its template, the others from their merged JSON
+         */
+        std::weak_ptr<Entity>   CreateEntityFromPrefab(const std::string& aPrefabName, const Json::Value& aOverride = Json::Value());
 
         void                    AddEntity( const std::shared_ptr<Entity>& aEntity );
         void                    DestroyEntity( size_t aEntityID );
+        /** Removes the entity at once instead of at the next update, so what it holds is released. Not while the entities are updated */
+        void                    DestroyEntityNow( size_t aEntityID );
 
         std::shared_ptr<Entity> GetEntityByID(size_t aEntityID) const;
         std::shared_ptr<Entity> GetEntityByName( const std::string& aName ) const;
@@ -53,6 +63,14 @@ namespace Framework
         std::shared_ptr<Entity> GetEntityByNameSubString( const std::string& aName ) const;
         void                    GetEntitiesByNameSubString( const std::string& aName, std::vector<std::weak_ptr<Entity>>& aEntities ) const;
 
+        /**
+         * Change tracking for the incremental saves. An entity is dirty from its creation
+         * or its last change, and removed from its removal, until the changes are taken
+         */
+        void                    MarkDirty( size_t aEntityID );
+        void                    TakeChanges( std::vector<size_t>& aDirty, std::vector<size_t>& aRemoved );
+        bool                    HasChanges() const { return !mDirtyEntities.empty() || !mRemovedEntities.empty(); }
+
         void                    Serialize(Json::Value& aSerializer) const override;
         void                    Deserialize(const Json::Value& aSerializer) override;
         
@@ -62,9 +80,16 @@ namespace Framework
         void SubscribeTo(MsgType aMsgType, IFunctorBase* aMethod);
 
         void                    DeleteDestroyedEntities();
+        void                    RemoveEntity( size_t aEntityID );
+
+        // Keeps the name index up to date, called by Entity::SetName
+        void                    OnEntityRenamed( const Entity& aEntity, const std::string& aOldName );
 
-        std::list< std::shared_ptr<Entity> >    mEntities;
-        std::vector< std::shared_ptr<Entity> >  mDestroyedEntities;
+        SparseSet< std::shared_ptr<Entity> >           mEntities;           // Entities keyed by id, contiguous and swap-removed
+        std::vector< size_t >                          mDestroyedEntities;  // Ids destroyed at the next update
+        std::unordered_set< size_t >                   mDirtyEntities;      // Ids created or changed since the changes were taken
+        std::unordered_set< size_t >                   mRemovedEntities;    // Ids removed since the changes were taken
+        EntityNameIndex                                mNames;              // Exact and substring name lookups
 
         // A multimap to store who should be called when a msg type arrives
         MsgsSubscriptions  mMsgsSubscriptions;
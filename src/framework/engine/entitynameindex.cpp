@@ -0,0 +1,120 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Name index of the entities
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "engine/entitynameindex.h"
+
+namespace Framework
+{
+    uint32_t EntityNameIndex::Trigram( const std::string& aName, size_t aPosition )
+    {
+        return static_cast<uint32_t>( static_cast<uint8_t>( aName[aPosition] ) ) << 16 |
+               static_cast<uint32_t>( static_cast<uint8_t>( aName[aPosition + 1] ) ) << 8 |
+               static_cast<uint32_t>( static_cast<uint8_t>( aName[aPosition + 2] ) );
+    }
+
+    void EntityNameIndex::Add( size_t aEntityID, const std::string& aName )
+    {
+        if ( mNames.Contains( aEntityID ) )
+            Remove( aEntityID );
+        Insert( aEntityID, aName, ++mSequence );
+    }
+
+    void EntityNameIndex::Insert( size_t aEntityID, const std::string& aName, uint64_t aSequence )
+    {
+        Entry lEntry;
+        lEntry.mName = aName;
+        lEntry.mSequence = aSequence;
+        mEntities[aName].emplace( aSequence, aEntityID );
+
+        for ( size_t i = 0; i + sTrigramSize <= aName.size(); ++i )
+        {
+            const uint32_t lTrigram = Trigram( aName, i );
+            bool lIsIndexed = false;
+            for ( const TrigramSlot& lSlot : lEntry.mTrigrams )
+                lIsIndexed |= lSlot.mTrigram == lTrigram;
+            if ( lIsIndexed )
+                continue;
+            EntityIDs& lTrigramEntities = mTrigrams[lTrigram];
+            lEntry.mTrigrams.push_back( TrigramSlot{ lTrigram, static_cast<uint32_t>( lTrigramEntities.size() ) } );
+            lTrigramEntities.push_back( aEntityID );
+        }
+        mNames.Insert( aEntityID, std::move( lEntry ) );
+    }
+
+    void EntityNameIndex::Remove( size_t aEntityID )
+    {
+        Entry* lEntry = mNames.Find( aEntityID );
+        if ( !lEntry )
+            return;
+
+        auto lEntities = mEntities.find( lEntry->mName );
+        lEntities->second.erase( lEntry->mSequence );
+        if ( lEntities->second.empty() )
+            mEntities.erase( lEntities );
+
+        // The last id of a trigram takes the place of the removed one, and its entity the new position
+        for ( const TrigramSlot& lSlot : lEntry->mTrigrams )
+        {
+            auto lTrigram = mTrigrams.find( lSlot.mTrigram );
+            const size_t lLast = lTrigram->second.back();
+            if ( lLast != aEntityID )
+            {
+                lTrigram->second[lSlot.mPosition] = lLast;
+                for ( TrigramSlot& lMovedSlot : mNames.Find( lLast )->mTrigrams )
+                {
+                    if ( lMovedSlot.mTrigram == lSlot.mTrigram )
+                    {
+                        lMovedSlot.mPosition = lSlot.mPosition;
+                        break;
+                    }
+                }
+            }
+            lTrigram->second.pop_back();
+            if ( lTrigram->second.empty() )
+                mTrigrams.erase( lTrigram );
+        }
+
+        mNames.Remove( aEntityID );
+    }
+
+    void EntityNameIndex::Rename( size_t aEntityID, const std::string& aName )
+    {
+        // The entity keeps its place among the entities of its new name
+        const Entry* lEntry = mNames.Find( aEntityID );
+        const uint64_t lSequence = lEntry ? lEntry->mSequence : ++mSequence;
+        Remove( aEntityID );
+        Insert( aEntityID, aName, lSequence );
+    }
+
+    void EntityNameIndex::Clear()
+    {
+        mNames.Clear();
+        mEntities.clear();
+        mTrigrams.clear();
+    }
+
+    bool EntityNameIndex::Find( const std::string& aName, size_t& aEntityID ) const
+    {
+        auto lEntities = mEntities.find( aName );
+        if ( lEntities == mEntities.end() )
+            return false;
+        aEntityID = lEntities->second.begin()->second;
+        return true;
+    }
+
+    void EntityNameIndex::FindAll( const std::string& aName, std::vector<size_t>& aEntityIDs ) const
+    {
+        auto lEntities = mEntities.find( aName );
+        if ( lEntities == mEntities.end() )
+            return;
+        for ( const auto& lEntity : lEntities->second )
+            aEntityIDs.push_back( lEntity.second );
+    }
+}
@@ -0,0 +1,111 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Name index of the entities. The exact names are hashed, the
+ *                substrings are found through the trigrams of the names: a name
+ *                holding a substring holds all its trigrams, so the candidates are
+ *                the ids of its rarest trigram, checked against the name. Every
+ *                trigram maps to an array of ids, an entity keeps its positions in
+ *                them and is swap removed, so adding, renaming and removing an
+ *                entity is linear in the length of its name, whatever the number of
+ *                entities sharing its trigrams.
+ *
+ *                The ids of a name are kept in the order the entities were added,
+ *                keyed by an add sequence that a rename keeps, so an exact lookup
+ *                finds the first entity of the name as the scan of the entity list
+ *                did. Removing one of them is logarithmic in the entities sharing
+ *                the name.
+ *******************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "engine/sparseset.h"
+
+namespace Framework
+{
+    class EntityNameIndex
+    {
+    public:
+        void                    Add( size_t aEntityID, const std::string& aName );
+        void                    Remove( size_t aEntityID );
+        void                    Rename( size_t aEntityID, const std::string& aName );
+        void                    Clear();
+
+        size_t                  Size() const { return mNames.Size(); }
+
+        /** The first entity added with the name, renamed ones count from their add */
+        bool                    Find( const std::string& aName, size_t& aEntityID ) const;
+        /** The entities of the name in the order they were added */
+        void                    FindAll( const std::string& aName, std::vector<size_t>& aEntityIDs ) const;
+
+        /** Calls the visitor with the id of every entity whose name contains the substring, in no order */
+        template< class Visitor >
+        void                    VisitSubString( const std::string& aSubString, Visitor aVisitor ) const;
+
+    private:
+        typedef std::vector< size_t > EntityIDs;
+        typedef std::map< uint64_t, size_t > OrderedEntityIDs;   // Add sequence -> entity id
+
+        /** A trigram of a name, and the position of the entity in the ids of the trigram */
+        struct TrigramSlot
+        {
+            uint32_t                    mTrigram;
+            uint32_t                    mPosition;
+        };
+
+        struct Entry
+        {
+            std::string                 mName;
+            uint64_t                    mSequence;  // Order of the add, the key in the ids of the name
+            std::vector< TrigramSlot >  mTrigrams;  // Each trigram of the name once
+        };
+
+        static const size_t     sTrigramSize = 3;
+
+        static uint32_t         Trigram( const std::string& aName, size_t aPosition );
+
+        void                    Insert( size_t aEntityID, const std::string& aName, uint64_t aSequence );
+
+        SparseSet< Entry >                                   mNames;      // Entity id -> name and positions
+        std::unordered_map< std::string, OrderedEntityIDs >  mEntities;   // Name -> entity ids in add order
+        std::unordered_map< uint32_t, EntityIDs >            mTrigrams;   // Every 3 characters of the names -> entity ids
+        uint64_t                                             mSequence = 0;
+    };
+
+    template< class Visitor >
+    void EntityNameIndex::VisitSubString( const std::string& aSubString, Visitor aVisitor ) const
+    {
+        // A substring shorter than a trigram matches too many names to be worth an index
+        if ( aSubString.size() < sTrigramSize )
+        {
+            for ( size_t i = 0; i < mNames.Size(); ++i )
+                if ( mNames[i].mName.find( aSubString ) != std::string::npos )
+                    aVisitor( mNames.KeyAt( i ) );
+            return;
+        }
+
+        const EntityIDs* lCandidates = nullptr;
+        for ( size_t i = 0; i + sTrigramSize <= aSubString.size(); ++i )
+        {
+            auto lTrigram = mTrigrams.find( Trigram( aSubString, i ) );
+            if ( lTrigram == mTrigrams.end() )
+                return;
+            if ( !lCandidates || lTrigram->second.size() < lCandidates->size() )
+                lCandidates = &lTrigram->second;
+        }
+        for ( size_t lEntityID : *lCandidates )
+        {
+            if ( mNames.Find( lEntityID )->mName.find( aSubString ) != std::string::npos )
+                aVisitor( lEntityID );
+        }
+    }
+}
@@ -0,0 +1,191 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Pool of worker threads decoding images
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "engine/imageloader.h"
+
+namespace Framework
+{
+    namespace
+    {
+        double Milliseconds(std::chrono::steady_clock::time_point aStart, std::chrono::steady_clock::time_point aEnd)
+        {
+            return std::chrono::duration<double, std::milli>(aEnd - aStart).count();
+        }
+    }
+
+    const uint32_t ImageLoader::sMaxWorkers;
+
+    ImageLoader::~ImageLoader()
+    {
+        Shutdown();
+    }
+
+    void ImageLoader::Request(const std::string& aFilename, const ImageDecoder::Options& aOptions, Callback aCallback)
+    {
+        std::unique_ptr<Job> lJob(new Job());
+        lJob->mFilename = aFilename;
+        lJob->mOptions = aOptions;
+        lJob->mCallback = std::move(aCallback);
+        lJob->mGeneration = mGeneration;
+        lJob->mRequestTime = std::chrono::steady_clock::now();
+        ++mPending;
+
+        StartWorkers();
+        {
+            std::lock_guard<std::mutex> lLock(mMutex);
+            mQueue.push_back(std::move(lJob));
+        }
+        mCondition.notify_one();
+    }
+
+    uint32_t ImageLoader::Update(uint32_t aMaxImages)
+    {
+        uint32_t lDelivered = 0;
+        while ( lDelivered < aMaxImages )
+        {
+            std::unique_ptr<Job> lJob;
+            {
+                std::lock_guard<std::mutex> lLock(mMutex);
+                if ( mDecodedJobs.empty() )
+                    break;
+                lJob = std::move(mDecodedJobs.front());
+                mDecodedJobs.pop_front();
+            }
+
+            // Requests dropped by Cancel while they were being decoded
+            if ( lJob->mGeneration != mGeneration )
+                continue;
+            Deliver(*lJob);
+            ++lDelivered;
+        }
+        return lDelivered;
+    }
+
+    uint32_t ImageLoader::Flush()
+    {
+        uint32_t lDelivered = Update();
+        while ( mPending > 0 )
+        {
+            {
+                std::unique_lock<std::mutex> lLock(mMutex);
+                mDecodedCondition.wait(lLock, [this]() { return !mDecodedJobs.empty(); });
+            }
+            lDelivered += Update();
+        }
+        return lDelivered;
+    }
+
+    void ImageLoader::Deliver(Job& aJob)
+    {
+        ASSERT(mPending > 0);
+        --mPending;
+        if ( aJob.mLoaded )
+            ++mStats.mCompleted;
+        else
+        {
+            ++mStats.mFailed;
+            WARNING("Failed to decode image %s", aJob.mFilename.c_str());
+        }
+        mStats.mMaxLatency = std::max(mStats.mMaxLatency, Milliseconds(aJob.mRequestTime, std::chrono::steady_clock::now()));
+        if ( aJob.mCallback )
+            aJob.mCallback(aJob.mFilename, aJob.mImage, aJob.mLoaded);
+    }
+
+    void ImageLoader::Cancel()
+    {
+        {
+            std::lock_guard<std::mutex> lLock(mMutex);
+            mQueue.clear();
+            mDecodedJobs.clear();
+        }
+        ++mGeneration;
+        mPending = 0;
+    }
+
+    void ImageLoader::Shutdown()
+    {
+        Cancel();
+        {
+            std::lock_guard<std::mutex> lLock(mMutex);
+            mStop = true;
+        }
+        mCondition.notify_all();
+        for ( auto& lWorker : mWorkers )
+            lWorker.join();
+        mWorkers.clear();
+
+        std::lock_guard<std::mutex> lLock(mMutex);
+        mDecodedJobs.clear();
+        mStop = false;
+    }
+
+    ImageLoader::Stats ImageLoader::GetStats() const
+    {
+        Stats lStats = mStats;
+        std::lock_guard<std::mutex> lLock(mMutex);
+        lStats.mQueued = static_cast<uint32_t>(mQueue.size());
+        lStats.mDecoding = mDecoding;
+        lStats.mDecoded = static_cast<uint32_t>(mDecodedJobs.size());
+        lStats.mDecodeTime = mDecodeTime;
+        return lStats;
+    }
+
+    void ImageLoader::ResetStats()
+    {
+        mStats = Stats();
+        std::lock_guard<std::mutex> lLock(mMutex);
+        mDecodeTime = 0.0;
+    }
+
+    void ImageLoader::StartWorkers()
+    {
+        if ( !mWorkers.empty() )
+            return;
+        // One core is left to the main thread
+        const uint32_t lCores = std::thread::hardware_concurrency();
+        const uint32_t lCount = mWorkerCount > 0 ? mWorkerCount : std::min(sMaxWorkers, lCores > 1 ? lCores - 1 : 1u);
+        for ( uint32_t i = 0; i < lCount; ++i )
+            mWorkers.emplace_back(&ImageLoader::WorkerLoop, this);
+        INFO(LogLevel::eLEVEL2, "Image loader started with %u worker threads", lCount);
+    }
+
+    void ImageLoader::WorkerLoop()
+    {
+        for ( ;; )
+        {
+            std::unique_ptr<Job> lJob;
+            {
+                std::unique_lock<std::mutex> lLock(mMutex);
+                mCondition.wait(lLock, [this]() { return mStop || !mQueue.empty(); });
+                if ( mStop )
+                    return;
+                lJob = std::move(mQueue.front());
+                mQueue.pop_front();
+                ++mDecoding;
+            }
+
+            /* The formats the decoder does not support go through DevIL, which only
+               gives the default layout */
+            const auto lStart = std::chrono::steady_clock::now();
+            lJob->mLoaded = ImageDecoder::Decode(lJob->mFilename, lJob->mImage, lJob->mOptions);
+            if ( !lJob->mLoaded && lJob->mOptions.mChannels == 0 && lJob->mOptions.mFlipVertically )
+                lJob->mLoaded = lJob->mImage.Load(lJob->mFilename);
+            lJob->mDecodeTime = Milliseconds(lStart, std::chrono::steady_clock::now());
+
+            {
+                std::lock_guard<std::mutex> lLock(mMutex);
+                --mDecoding;
+                mDecodeTime += lJob->mDecodeTime;
+                mDecodedJobs.push_back(std::move(lJob));
+            }
+            mDecodedCondition.notify_one();
+        }
+    }
+}
@@ -0,0 +1,139 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Pool of worker threads decoding images. The workers turn image files
+ *                into pixel buffers, the main thread receives the buffers and uploads
+ *                them (NanoVG images, textures) in its callbacks:
+ *
+ *                    Request -> [queued] -> worker: ImageDecoder -> [decoded] -> Update: callback
+ *
+ *                The callbacks always run on the main thread, in Update or Flush, so
+ *                they can use the GL context and the engine state freely.
+ *******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "core/graphic/imagedecoder.h"
+
+namespace Framework
+{
+    class ImageLoader final
+    {
+    public:
+        static const uint32_t sMaxWorkers = 4;
+
+        /**
+         * Called on the main thread with the decoded image. The callback may move the
+         * pixels out of the image
+         */
+        using Callback = std::function<void(const std::string& aFilename, Texture& aImage, bool aLoaded)>;
+
+        struct Stats
+        {
+            uint32_t mQueued = 0;           /**< Requests waiting for a worker */
+            uint32_t mDecoding = 0;         /**< Requests being decoded */
+            uint32_t mDecoded = 0;          /**< Decoded requests waiting for the main thread */
+            uint64_t mCompleted = 0;        /**< Images delivered */
+            uint64_t mFailed = 0;           /**< Images that could not be decoded */
+            double   mDecodeTime = 0.0;     /**< Milliseconds spent decoding, summed over the workers */
+            double   mMaxLatency = 0.0;     /**< Milliseconds from a request to its callback */
+
+            uint32_t GetQueueDepth() const { return mQueued + mDecoding + mDecoded; }
+        };
+
+        /**
+         * @param aWorkers  Worker threads, 0 uses one per core but the main thread's,
+         *                  up to sMaxWorkers
+         */
+        explicit ImageLoader(uint32_t aWorkers = 0) : mWorkerCount(aWorkers) {}
+        ~ImageLoader();
+
+        ImageLoader(const ImageLoader&) = delete;
+        ImageLoader& operator=(const ImageLoader&) = delete;
+
+        /**
+         * Queues the decode of an image
+         *
+         * @param aFilename  Image file
+         * @param aOptions   Layout of the decoded pixels
+         * @param aCallback  Receives the image on the main thread
+         */
+        void Request(const std::string& aFilename, const ImageDecoder::Options& aOptions, Callback aCallback);
+
+        /**
+         * Delivers the decoded images to their callbacks, on the main thread
+         *
+         * @param aMaxImages  Most callbacks to run in this call
+         *
+         * @return Number of images delivered
+         */
+        uint32_t Update(uint32_t aMaxImages = std::numeric_limits<uint32_t>::max());
+
+        /**
+         * Waits on the main thread until every request is delivered, the callbacks
+         * run as the images come out of the workers
+         *
+         * @return Number of images delivered
+         */
+        uint32_t Flush();
+
+        /**
+         * Drops all requests, their callbacks are not called
+         */
+        void Cancel();
+
+        /**
+         * Cancels the requests and joins the worker threads
+         */
+        void Shutdown();
+
+        bool     IsIdle() const { return mPending == 0; }
+        uint32_t GetWorkerCount() const { return static_cast<uint32_t>(mWorkers.size()); }
+        Stats    GetStats() const;
+        void     ResetStats();
+
+    private:
+        struct Job
+        {
+            std::string           mFilename;
+            ImageDecoder::Options mOptions;
+            Callback              mCallback;
+            Texture               mImage;          /**< Written by the worker */
+            bool                  mLoaded = false;
+            double                mDecodeTime = 0.0;
+            uint32_t              mGeneration = 0;
+            std::chrono::steady_clock::time_point mRequestTime;
+        };
+
+        void StartWorkers();
+        void WorkerLoop();
+        void Deliver(Job& aJob);
+
+        uint32_t                           mWorkerCount;
+        std::vector<std::thread>           mWorkers;
+        mutable std::mutex                 mMutex;
+        std::condition_variable            mCondition;         /**< Signals the workers */
+        std::condition_variable            mDecodedCondition;  /**< Signals Flush */
+        std::deque<std::unique_ptr<Job>>   mQueue;             /**< Guarded by mMutex */
+        std::deque<std::unique_ptr<Job>>   mDecodedJobs;       /**< Guarded by mMutex */
+        uint32_t                           mDecoding = 0;      /**< Guarded by mMutex */
+        double                             mDecodeTime = 0.0;  /**< Guarded by mMutex */
+        bool                               mStop = false;      /**< Guarded by mMutex */
+
+        uint32_t                           mPending = 0;       /**< Requests not delivered yet, main thread only */
+        uint32_t                           mGeneration = 0;    /**< Main thread only */
+        Stats                              mStats;             /**< Completion counters, main thread only */
+    };
+}
@@ -14,7 +14,9 @@
 
 #include "core/config.h"
 
+#include "engine.h"
 #include "engine/prefabmanager.h"
+#include "engine/components/entity.h"
 
 
 namespace Framework
@@ -27,7 +29,13 @@ Json::Value PrefabManager::GetPrefab(const std::string& aPrefabName)
     {
         CRASH("Not find any '%s' in the prefabManager", aPrefabName.c_str());
     }
-	return m_Database[aPrefabName];
+	return lResult->second;
+}
+
+const PrefabTemplate* PrefabManager::GetTemplate(const std::string& aPrefabName) const
+{
+    auto lResult = m_Templates.find(aPrefabName);
+    return lResult == m_Templates.end() ? nullptr : &lResult->second;
 }
 
 void PrefabManager::AddPrefab(const std::string prefabFileName)
@@ -52,6 +60,19 @@ void PrefabManager::AddPrefab(const std::string prefabFileName)
 	ASSERT(m_Database.find(name) == m_Database.end());
 
 	m_Database[name] = prefabdefinition;
+
+	// Only the plain entities are compiled, another entity type may read more of the JSON
+	CmpManagerRegistry& lRegistry = Engine::Instance()->CmpManagerRegistry();
+	PrefabTemplate lTemplate;
+	if (prefabdefinition["type"].asString() == Utils::Demangling(typeid(Entity).name()) &&
+		lTemplate.Compile(prefabdefinition, [&lRegistry](const std::string& aType) { return lRegistry.GetByCompName(aType); }))
+	{
+		m_Templates.emplace(name, std::move(lTemplate));
+	}
+	else
+	{
+		WARNING("Prefab '%s' is not compiled, its instances are created from the JSON\n", name.c_str());
+	}
 }
 
 void PrefabManager::GetPrefabsFromConfig(const Config& config)
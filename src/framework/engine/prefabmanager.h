@@ -12,6 +12,7 @@
     #include "json/json-forwards.h"
 #endif
 #include <map>
+#include "engine/prefabtemplate.h"
 
 namespace Framework
 {
@@ -23,6 +24,12 @@ namespace Framework
 		Json::Value GetPrefab(const std::string& prefabName);
 		void AddPrefab(const std::string prefabFile);
 
+		/**
+		 * The prefab compiled at its load, nullptr if it could not be compiled and its
+		 * instances are created from the JSON of GetPrefab
+		 */
+		const PrefabTemplate* GetTemplate(const std::string& aPrefabName) const;
+
 	private:
 		friend class Engine;
 
@@ -31,6 +38,7 @@ namespace Framework
 		~PrefabManager() = default;
 
 		std::map<const std::string, Json::Value> m_Database;
+		std::map<const std::string, PrefabTemplate> m_Templates;
 
 	};
 }
@@ -0,0 +1,79 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : A prefab compiled once, when it is loaded
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include <algorithm>
+#include "engine/prefabtemplate.h"
+
+namespace Framework
+{
+    bool PrefabTemplate::Compile(const Json::Value& aDefinition, const Resolver& aResolver)
+    {
+        mType = aDefinition["type"].asString();
+        mName = aDefinition["name"].asString();
+        mComponents.clear();
+        for ( const auto& lValues : aDefinition["components"] )
+        {
+            Component lComponent;
+            lComponent.mType = lValues["type"].asString();
+            lComponent.mManager = aResolver(lComponent.mType);
+            if ( !lComponent.mManager )
+                return false;
+            lComponent.mValues = lValues;
+            mComponents.push_back(std::move(lComponent));
+        }
+        return true;
+    }
+
+    std::string PrefabTemplate::GetName(const Json::Value& aOverride) const
+    {
+        return aOverride.isMember("name") ? aOverride["name"].asString() : mName;
+    }
+
+    void PrefabTemplate::VisitComponents(const Json::Value& aOverride, const Resolver& aResolver, const Visitor& aVisitor) const
+    {
+        // The component each override component changes is the first one of its type, -1 if it is added
+        const Json::Value& lOverrides = aOverride["components"];
+        std::vector<int> lTargets;
+        lTargets.reserve(lOverrides.size());
+        for ( const auto& lOverride : lOverrides )
+        {
+            const std::string lType = lOverride["type"].asString();
+            auto lFound = std::find_if(mComponents.begin(), mComponents.end(), [&lType](const Component& aComponent) { return aComponent.mType == lType; });
+            lTargets.push_back(lFound == mComponents.end() ? -1 : static_cast<int>(lFound - mComponents.begin()));
+        }
+
+        for ( size_t c = 0; c < mComponents.size(); ++c )
+        {
+            const Component& lComponent = mComponents[c];
+            if ( std::find(lTargets.begin(), lTargets.end(), static_cast<int>(c)) == lTargets.end() )
+            {
+                aVisitor(lComponent.mManager, lComponent.mValues);
+                continue;
+            }
+
+            // Only a changed component is copied, the override values replace the prefab ones key by key
+            Json::Value lValues = lComponent.mValues;
+            for ( Json::ArrayIndex i = 0; i < lOverrides.size(); ++i )
+            {
+                if ( lTargets[i] != static_cast<int>(c) )
+                    continue;
+                for ( const auto& lKey : lOverrides[i].getMemberNames() )
+                    lValues[lKey] = lOverrides[i][lKey];
+            }
+            aVisitor(lComponent.mManager, lValues);
+        }
+
+        for ( Json::ArrayIndex i = 0; i < lOverrides.size(); ++i )
+        {
+            if ( lTargets[i] == -1 )
+                aVisitor(aResolver(lOverrides[i]["type"].asString()), lOverrides[i]);
+        }
+    }
+}
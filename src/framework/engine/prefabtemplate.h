@@ -0,0 +1,65 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : A prefab compiled once, when it is loaded. The component managers
+ *                of the prefab are resolved and its component values kept parsed,
+ *                so an instance is created from the template and the values its
+ *                override changes, without copying and merging the prefab JSON.
+ *                The override is merged as JsonUtils::OverrideEntity does.
+ *******************************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "core/serialization/serializableobject.h"
+
+namespace Framework
+{
+    class ICmpManager;
+
+    class PrefabTemplate
+    {
+    public:
+        struct Component
+        {
+            ICmpManager*  mManager = nullptr;
+            std::string   mType;
+            Json::Value   mValues;          /**< The prefab values of the component */
+        };
+
+        /** Component manager of a component type name, nullptr if there is none */
+        typedef std::function<ICmpManager*(const std::string&)>           Resolver;
+        typedef std::function<void(ICmpManager*, const Json::Value&)>     Visitor;
+
+        /**
+         * Compiles a prefab definition. False if a component has no manager, the
+         * instances of the prefab are created from the JSON then
+         */
+        bool                            Compile(const Json::Value& aDefinition, const Resolver& aResolver);
+
+        const std::string&              GetType() const { return mType; }
+        const std::string&              GetName() const { return mName; }
+        const std::vector<Component>&   GetComponents() const { return mComponents; }
+
+        /** Name of an instance, the one of the override if it has one */
+        std::string                     GetName(const Json::Value& aOverride) const;
+
+        /**
+         * Visits the components of an instance in creation order with their values: the
+         * prefab values of the components the override does not change, a merge of the
+         * others. The components the override adds come last, resolved by their name
+         */
+        void                            VisitComponents(const Json::Value& aOverride, const Resolver& aResolver, const Visitor& aVisitor) const;
+
+    private:
+        std::string                     mType;
+        std::string                     mName;
+        std::vector<Component>          mComponents;
+    };
+}
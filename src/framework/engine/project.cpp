@@ -8,14 +8,21 @@
 #include "precompiled.h"
 #include "engine.h"
 #include "engine/project.h"
+#include "engine/autosave.h"
+#include "engine/projectfile.h"
 #include "graphic/scene.h"
 
 #include "json/json.h"
 #include "core/serialization/jsoncpputils.h"
 
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <unordered_set>
+
 namespace Framework
 {
-    void Project::Save(string aFileNameOverride)
+    void Project::Save(string aFileNameOverride, Format aFormat)
     {
         if (mFileName.empty())
         {
@@ -27,6 +34,12 @@ namespace Framework
         if (aFileNameOverride.compare(""))
             lFileName = aFileNameOverride;
 
+        if (aFormat == Format::eBINARY || ProjectFile::HasBinaryExtension(lFileName))
+        {
+            SaveBinary(lFileName);
+            return;
+        }
+
         Json::Value lSerializer;
         lSerializer["projectName"] = mName;
         lSerializer["sample"] = mSample;
@@ -34,9 +47,23 @@ namespace Framework
         v = Json::Value(Json::ValueType::arrayValue);
 
         unsigned int i = 0;
+        std::vector<std::pair<std::shared_ptr<Scene>, const Json::Value*>> lOverwrittenScenes;
         for (const auto lScene : mScenes)
         {
-            lScene->Serialize(v[i++]);
+            Json::Value& lSceneValue = v[i++];
+            if (lScene->IsLoaded())
+            {
+                lScene->Serialize(lSceneValue);
+                continue;
+            }
+
+            // A scene that is not loaded is written from its stored entities
+            lScene->SerializeHeader(lSceneValue);
+            Json::Value& lEntities = lSceneValue["entities"];
+            lEntities = Json::Value(Json::ValueType::arrayValue);
+            lScene->ReadStoredEntities([&lEntities](uint64_t, Json::Value& aEntity) { lEntities.append(Json::Value()).swap(aEntity); });
+            if (lScene->IsStoredIn(lFileName))
+                lOverwrittenScenes.emplace_back(lScene, &lSceneValue);
         }
 
         Json::StyledWriter writer;
@@ -44,12 +71,146 @@ namespace Framework
         fstream lFileOut(lFileName, ios_base::out);
         lFileOut << lOutput;
 
+        // The binary project the scenes were read from is replaced, they are kept in memory
+        for (auto& lScene : lOverwrittenScenes)
+        {
+            Json::Value lHeader;
+            lScene.first->SerializeHeader(lHeader);
+            StoreInMemory(*lScene.first, lHeader, (*lScene.second)["entities"]);
+        }
+
+        Engine::Instance()->StateMachine().ExecuteAction("SetProjectSaved");
+    }
+
+    void Project::SaveBinary(const std::string& aFileName)
+    {
+        // The scenes that are not loaded may be read from the file being replaced
+        const std::string lNewFile = aFileName + ".new";
+        ProjectFile::Writer lWriter;
+        if (!lWriter.Open(lNewFile))
+            return;
+
+        Json::Value lProject;
+        lProject["projectName"] = mName;
+        lProject["sample"] = mSample;
+        lWriter.WriteProject(lProject);
+
+        std::vector<std::pair<std::shared_ptr<Scene>, std::streampos>> lStoredScenes;
+        bool lIsOk = true;
+        for (const auto& lScene : mScenes)
+        {
+            Json::Value lHeader;
+            lScene->SerializeHeader(lHeader);
+            lWriter.BeginScene(lHeader);
+            if (lScene->IsLoaded())
+                lScene->SerializeEntities([&lWriter](size_t aEntityID, Json::Value& aEntity) { lWriter.WriteEntity(aEntity, aEntityID); });
+            else
+            {
+                lStoredScenes.emplace_back(lScene, lWriter.GetScenePosition());
+                lIsOk &= lScene->ReadStoredEntities([&lWriter](uint64_t aKey, Json::Value& aEntity) { lWriter.WriteEntity(aEntity, aKey); });
+            }
+            lWriter.EndScene();
+        }
+
+        lIsOk &= lWriter.Close();
+        if (!lIsOk || !ProjectFile::ReplaceFile(lNewFile, aFileName))
+        {
+            std::remove(lNewFile.c_str());
+            WARNING("Could not save the project file %s", aFileName.c_str());
+            return;
+        }
+
+        // The scenes that are not loaded are read from the saved file from now on
+        for (auto& lStoredScene : lStoredScenes)
+            lStoredScene.first->SetStoredEntities(aFileName, lStoredScene.second);
         Engine::Instance()->StateMachine().ExecuteAction("SetProjectSaved");
     }
 
+    bool Project::Autosave(AutosaveJournal& aJournal)
+    {
+        const auto lStart = std::chrono::steady_clock::now();
+        const EntityManager& lEntityManager = Engine::Instance()->EntityManager();
+
+        std::vector<size_t> lDirty, lRemoved;
+        Engine::Instance()->EntityManager().TakeChanges(lDirty, lRemoved);
+
+        const std::vector<std::string> lSceneNames = GetSceneList();
+        AutosaveJournal::Snapshot lSnapshot;
+        lSnapshot.mFull = aJournal.NeedsBase(lSceneNames) || mScenesLoadedChanged;
+        if (!lSnapshot.mFull && lDirty.empty() && lRemoved.empty())
+            return false;
+
+        lSnapshot.mProject["projectName"] = mName;
+        lSnapshot.mProject["sample"] = mSample;
+        lSnapshot.mRemoved.assign(lRemoved.begin(), lRemoved.end());
+
+        const std::unordered_set<size_t> lDirtySet(lDirty.begin(), lDirty.end());
+        std::vector<size_t> lEntityIDs;
+        for (size_t i = 0; i < mScenes.size(); ++i)
+        {
+            const auto& lScene = mScenes[i];
+            AutosaveJournal::Snapshot::SceneChanges lChanges;
+            if (!lScene->IsLoaded())
+            {
+                /* Nothing changes in a scene that is not loaded, so its entities are only
+                   in the bases. They have no entity id, their keys are above the ids */
+                if (lSnapshot.mFull)
+                {
+                    uint64_t lKey = (uint64_t(1) << 63) | (uint64_t(i) << 32);
+                    lScene->ReadStoredEntities([&lChanges, &lKey](uint64_t, Json::Value& aEntity)
+                    {
+                        lChanges.mEntities.emplace_back(lKey++, Json::Value());
+                        lChanges.mEntities.back().second.swap(aEntity);
+                    });
+                    lScene->SerializeHeader(lChanges.mHeader);
+                    lSnapshot.mScenes.push_back(std::move(lChanges));
+                }
+                continue;
+            }
+
+            lEntityIDs.clear();
+            lScene->GetSavedEntities(lEntityIDs);
+            for (size_t lEntityID : lEntityIDs)
+            {
+                if (!lSnapshot.mFull && !lDirtySet.count(lEntityID))
+                    continue;
+                lChanges.mEntities.emplace_back(lEntityID, Json::Value());
+                lEntityManager.GetEntityByID(lEntityID)->Serialize(lChanges.mEntities.back().second);
+            }
+
+            // The journal keeps only the scenes with changes
+            if (lSnapshot.mFull || !lChanges.mEntities.empty())
+            {
+                lScene->SerializeHeader(lChanges.mHeader);
+                lSnapshot.mScenes.push_back(std::move(lChanges));
+            }
+        }
+
+        // The entities of a scene loaded or evicted changed of key, the base is written again
+        if (lSnapshot.mFull)
+            mScenesLoadedChanged = false;
+
+        lSnapshot.mTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - lStart).count();
+        aJournal.Write(std::move(lSnapshot), lSceneNames);
+        return true;
+    }
+
 
     bool Project::Load()
     {
+        if (ProjectFile::IsBinary(mFileName))
+        {
+            // The changes of an autosave that was not compacted, after a crash
+            AutosaveJournal::Compact(mFileName);
+            if (!LoadBinary())
+            {
+                WARNING("Cannot load '%s' file as a project!", mFileName.c_str());
+                return false;
+            }
+            Engine::Instance()->StateMachine().ExecuteAction("SetProjectSaved");
+            return true;
+        }
+
         Json::Value lSerializer;
         bool lIsOk = Json::JsonUtils::OpenAndParseJsonFromFile(lSerializer, mFileName);
 
@@ -65,24 +226,77 @@ namespace Framework
         if (lSerializer.isMember("sample"))
             mSample = lSerializer["sample"].asBool();
 
-        // Deserialize scenes
+        // Index the scenes, they are loaded when shown
         const Json::Value& lScenes = lSerializer["scenes"];
         ASSERT(lScenes.isArray());
-        for(size_t i = 0, lSize = lScenes.size(); i < lSize; ++i)
-        {
-            const Json::Value lSceneRes = lScenes[static_cast<int>(i)];
-            AddScene(lSceneRes);
-        }
+        for (const Json::Value& lSceneRes : lScenes)
+            IndexScene(lSceneRes);
 
         Engine::Instance()->StateMachine().ExecuteAction("SetProjectSaved");
         return true;
     }
 
+    bool Project::LoadBinary()
+    {
+        ProjectFile::Reader lReader;
+        if (!lReader.Open(mFileName))
+            return false;
+
+        // Only the headers of the scenes are read, their entities when they are shown
+        Json::Value lRecord;
+        std::shared_ptr<Scene> lScene;
+        for (;;)
+        {
+            switch (lReader.Next(lRecord))
+            {
+            case ProjectFile::Record::ePROJECT:
+                if (lRecord.isMember("projectName"))
+                    mName = lRecord["projectName"].asString();
+                if (lRecord.isMember("sample"))
+                    mSample = lRecord["sample"].asBool();
+                break;
+
+            case ProjectFile::Record::eSCENE:
+            {
+                const string lName = lRecord["sceneName"].asString();
+                if (GetSceneByName(lName))
+                {
+                    WARNING("Scene '%s already exists and cannot be added again!", lName.c_str());
+                    if (!lReader.SkipScene())
+                        return false;
+                    break;
+                }
+                lScene = std::make_shared<Scene>(lName);
+                lScene->DeserializeHeader(lRecord);
+                lScene->SetStoredEntities(mFileName, lReader.GetRecordPosition());
+                if (!lReader.SkipScene())
+                    return false;
+                break;
+            }
+
+            case ProjectFile::Record::eSCENE_END:
+                if (lScene)
+                {
+                    mScenes.push_back(lScene);
+                    lScene.reset();
+                }
+                break;
+
+            case ProjectFile::Record::eEND:
+                return true;
+
+            default:
+                return false;
+            }
+        }
+    }
+
     void Project::Unload()
     {
         for (auto& lScene : mScenes)
             lScene->Unload();
         mScenes.clear();
+        mLoadedScenes.clear();
 
         // clear all stuff from entity manager
         Engine::Instance()->EntityManager().DeInitialize();
@@ -93,18 +307,68 @@ namespace Framework
         return mActiveScene;
     }
 
-    void Project::SetActiveScene(shared_ptr<Scene> aScene)
+    bool Project::SetActiveScene(shared_ptr<Scene> aScene)
     {
         if(!aScene)
         {
             WARNING("Cannot set empty scene as active scene");
-            return;
+            return false;
         }
 
         if (find(mScenes.begin(), mScenes.end(), aScene) == mScenes.end())
             CRASH("Scene being set as active is not part of the current project.");
 
+        if (!aScene->IsLoaded())
+        {
+            // A scene that failed to load has no render targets, the active one stays
+            const auto lStart = std::chrono::steady_clock::now();
+            if (!aScene->Load())
+            {
+                WARNING("Scene '%s' could not be loaded", aScene->GetName().c_str());
+                return false;
+            }
+            mScenesLoadedChanged = true;
+            INFO(LogLevel::eLEVEL2, "Scene '%s' loaded in %.1f ms", aScene->GetName().c_str(),
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - lStart).count());
+        }
         mActiveScene = aScene;
+
+        auto lLoaded = find(mLoadedScenes.begin(), mLoadedScenes.end(), aScene);
+        if (lLoaded != mLoadedScenes.end())
+            mLoadedScenes.erase(lLoaded);
+        mLoadedScenes.push_back(aScene);
+        EvictScenes();
+        return true;
+    }
+
+    bool Project::FitsMemoryBudget() const
+    {
+        const ResourceManager& lResourceManager = Engine::Instance()->ResourceManager();
+        const ResourceManager::Stats lStats = lResourceManager.GetStats();
+        uint64_t lRenderTargetBytes = 0;
+        for (const auto& lScene : mLoadedScenes)
+            lRenderTargetBytes += lScene->GetRenderTargetBytes();
+        return lResourceManager.GetMemoryBudget().Fits(lStats.GetCpuBytes(), lStats.GetGpuBytes() + lRenderTargetBytes);
+    }
+
+    void Project::EvictScenes()
+    {
+        for (auto lScene = mLoadedScenes.begin(); lScene != mLoadedScenes.end() && !FitsMemoryBudget(); )
+        {
+            if (*lScene == mActiveScene)
+            {
+                ++lScene;
+                continue;
+            }
+
+            INFO(LogLevel::eLEVEL2, "Scene '%s' evicted to fit the memory budget", (*lScene)->GetName().c_str());
+            (*lScene)->Evict();
+            lScene = mLoadedScenes.erase(lScene);
+            mScenesLoadedChanged = true;
+
+            // The assets only the evicted scene used are released now, not at the next frame
+            Engine::Instance()->ResourceManager().TrimMemory();
+        }
     }
 
     bool Project::AddScene(const string& aSceneName, const string& aSceneFile)
@@ -126,6 +390,7 @@ namespace Framework
         auto lScene = std::make_shared<Scene>(aSceneName);
         lScene->Deserialize(lSerializer);
         mScenes.push_back(lScene);
+        mLoadedScenes.push_back(lScene);
         return true;
     }
 
@@ -145,9 +410,51 @@ namespace Framework
         auto lScene = std::make_shared<Scene>(lName);
         lScene->Deserialize(aSerializer);
         mScenes.push_back(lScene);
+        mLoadedScenes.push_back(lScene);
+        return true;
+    }
+
+    bool Project::IndexScene(const Json::Value& aSerializer)
+    {
+        if (!aSerializer.isMember("sceneName"))
+            CRASH("Scene has no 'sceneName' attribute!");
+
+        string lName = aSerializer["sceneName"].asString();
+        if (GetSceneByName(lName))
+        {
+            WARNING("Scene '%s already exists and cannot be added again!", lName.c_str());
+            return false;
+        }
+
+        Json::Value lHeader(Json::objectValue);
+        for (auto lMember = aSerializer.begin(); lMember != aSerializer.end(); ++lMember)
+        {
+            if (lMember.name() != "entities")
+                lHeader[lMember.name()] = *lMember;
+        }
+
+        auto lScene = std::make_shared<Scene>(lName);
+        lScene->DeserializeHeader(lHeader);
+        StoreInMemory(*lScene, lHeader, aSerializer["entities"]);
+        mScenes.push_back(lScene);
         return true;
     }
 
+    void Project::StoreInMemory(Scene& aScene, const Json::Value& aHeader, const Json::Value& aEntities)
+    {
+        // The scene is kept as a binary project of its own until it is shown
+        std::stringstream lRecords(std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+        ProjectFile::Writer lWriter;
+        lWriter.Open(lRecords);
+        lWriter.BeginScene(aHeader);
+        const std::streampos lPosition = lWriter.GetScenePosition();
+        for (const Json::Value& lEntity : aEntities)
+            lWriter.WriteEntity(lEntity);
+        lWriter.EndScene();
+        lWriter.Close();
+        aScene.SetStoredEntities(lRecords.str(), lPosition);
+    }
+
     bool Project::RemoveScene(const string& aSceneName)
     {
         for (vector<std::shared_ptr<Scene>>::iterator lScene = mScenes.begin(); lScene != mScenes.end(); ++lScene)
@@ -155,6 +462,7 @@ namespace Framework
             if ((*lScene)->GetName().compare(aSceneName) == 0)
             {
                 (*lScene)->Unload();
+                mLoadedScenes.erase(std::remove(mLoadedScenes.begin(), mLoadedScenes.end(), *lScene), mLoadedScenes.end());
                 mScenes.erase(lScene);
                 Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
                 return true;
@@ -186,5 +494,6 @@ namespace Framework
     void Project::ClearScenes()
     {
         mScenes.clear();
+        mLoadedScenes.clear();
     }
 }
@@ -8,6 +8,11 @@
 *                present in the project. Projects are saved in .sh3d files which will save all the 
 *                project properties and all the scenes with all elements contained in those scenes.
 *                This means that the .sh3d file will contain the complete scene data as well.
+*
+*                The scenes are loaded lazily: opening the project indexes them, a scene
+*                is loaded the first time it is set as active, and the least recently
+*                shown ones are evicted while the loaded scenes exceed the memory budget
+*                of the resource manager.
 *******************************************************************************/
 
 #pragma once
@@ -21,10 +26,16 @@
 namespace Framework
 {
     class Scene;
+    class AutosaveJournal;
 
     class Project
     {
     public:
+        enum class Format
+        {
+            eJSON,      /**< The whole project as one JSON document */
+            eBINARY,    /**< Records written and read one entity at a time, see engine/projectfile.h */
+        };
 
         Project(string aFileName = "", bool aSample = false)
             : mName("")
@@ -38,15 +49,38 @@ namespace Framework
         void                        SetFileName(const std::string& aFileName){ mFileName = aFileName; }
         std::string                 GetFileName() const { return mFileName; }
 
+        /**
+         * Loads the project file, in any of the formats. The scenes are only indexed,
+         * see SetActiveScene
+         */
         bool                        Load();
         void                        Unload();
-        void                        Save(std::string aFileNameOverride = "");
+        /**
+         * Saves the project as JSON. The binary format is written when it is asked for,
+         * or when the file has the binary extension, see ProjectFile::sBinaryExtension
+         */
+        void                        Save(std::string aFileNameOverride = "", Format aFormat = Format::eJSON);
+
+        /**
+         * Serializes the entities changed since the previous autosave and hands them to
+         * the journal, which writes them on its worker thread
+         *
+         * @return false if nothing changed
+         */
+        bool                        Autosave(AutosaveJournal& aJournal);
 
         void                        SetSample(const bool aSample) { mSample = aSample; }
         bool                        IsSample() const { return mSample; }
 
         std::shared_ptr<Scene>      GetActiveScene();
-        void                        SetActiveScene(shared_ptr<Scene> aScene);
+
+        /**
+         * Loads the scene if it is not, then evicts the least recently active scenes
+         * while the loaded ones do not fit the memory budget
+         *
+         * @return false if the scene could not be loaded, the active scene is kept
+         */
+        bool                        SetActiveScene(shared_ptr<Scene> aScene);
 
         bool                        AddScene(const string& aSceneName, const string& aSceneFile);
         bool                        AddScene(const Json::Value& aSerializer);
@@ -56,12 +90,31 @@ namespace Framework
         void                        ClearScenes();
 
      protected:
+        bool                            LoadBinary();
+        void                            SaveBinary(const std::string& aFileName);
+
+        /**
+         * Adds a scene of a JSON project without loading it, its entities are stored
+         * in memory in the binary format
+         */
+        bool                            IndexScene(const Json::Value& aSerializer);
+        static void                     StoreInMemory(Scene& aScene, const Json::Value& aHeader, const Json::Value& aEntities);
+
+        /**
+         * @return true if the resources and the render targets of the loaded scenes fit
+         *         the memory budget
+         */
+        bool                            FitsMemoryBudget() const;
+        void                            EvictScenes();
+
         std::string                     mName;
         std::string                     mFileName;
         bool                            mSample;
 
         vector<std::shared_ptr<Scene>>  mScenes;
         std::shared_ptr<Scene>          mActiveScene;
+        vector<std::shared_ptr<Scene>>  mLoadedScenes;              /**< The least recently active first */
+        bool                            mScenesLoadedChanged = false; /**< A scene was loaded or evicted since the last autosave */
     };
 }
 
@@ -0,0 +1,737 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Binary project file
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "engine/projectfile.h"
+
+#include <cstdio>
+#include <cstring>
+#include "core/serialization/jsoncpputils.h"
+
+namespace Framework
+{
+    namespace ProjectFile
+    {
+        namespace
+        {
+            const char sMagic[4] = { 'I', 'P', 'R', 'J' };
+
+            /* A record is its type, the length of the payload and the payload */
+            const size_t sRecordHeader = 1 + 4;
+
+            /* The scene record starts with the bytes of its entity records and their count */
+            const size_t sSceneFields = 8 + 4;
+
+            enum Tag : uint8_t
+            {
+                eNULL = 0,
+                eFALSE,
+                eTRUE,
+                eINT,           /**< Zigzag varint */
+                eUINT,          /**< Varint */
+                eFLOAT,         /**< A real that is exact as a float, 4 bytes */
+                eDOUBLE,        /**< 8 bytes */
+                eSTRING,        /**< Varint length and the bytes, added to the string table */
+                eSTRING_REF,    /**< Varint index in the string table */
+                eARRAY,         /**< Varint count and the values */
+                eFLOATS,        /**< Varint count and the floats, 4 bytes each */
+                eOBJECT,        /**< Varint count and the members, a string and a value each */
+            };
+
+            /* Little endian, whatever the platform */
+            void AppendFixed(std::string& aBuffer, uint64_t aValue, size_t aBytes)
+            {
+                for ( size_t i = 0; i < aBytes; ++i )
+                    aBuffer.push_back(static_cast<char>((aValue >> (8 * i)) & 0xFF));
+            }
+
+            uint64_t ReadFixed(const char* aData, size_t aBytes)
+            {
+                uint64_t lValue = 0;
+                for ( size_t i = 0; i < aBytes; ++i )
+                    lValue |= uint64_t(static_cast<uint8_t>(aData[i])) << (8 * i);
+                return lValue;
+            }
+
+            bool IsFloat(const Json::Value& aValue)
+            {
+                if ( aValue.type() != Json::realValue )
+                    return false;
+                const double lValue = aValue.asDouble();
+                return static_cast<double>(static_cast<float>(lValue)) == lValue;
+            }
+
+            /* An array of reals, where StyledWriter has written the whole ones as integers */
+            bool IsFloatArray(const Json::Value& aValue)
+            {
+                if ( aValue.size() < 2 )
+                    return false;
+                bool lReal = false;
+                for ( const Json::Value& lElement : aValue )
+                {
+                    if ( lElement.type() == Json::intValue || lElement.type() == Json::uintValue )
+                    {
+                        const double lValue = lElement.asDouble();
+                        if ( static_cast<double>(static_cast<float>(lValue)) != lValue )
+                            return false;
+                    }
+                    else if ( IsFloat(lElement) )
+                        lReal = true;
+                    else
+                        return false;
+                }
+                return lReal;
+            }
+
+            uint32_t FloatBits(double aValue)
+            {
+                const float lValue = static_cast<float>(aValue);
+                uint32_t lBits;
+                memcpy(&lBits, &lValue, sizeof lBits);
+                return lBits;
+            }
+
+            float BitsFloat(uint32_t aBits)
+            {
+                float lValue;
+                memcpy(&lValue, &aBits, sizeof lValue);
+                return lValue;
+            }
+        }
+
+        Writer::~Writer()
+        {
+            if ( mStream )
+                Close();
+        }
+
+        bool Writer::Open(const std::string& aFileName, bool aAppend)
+        {
+            mWrittenBytes = 0;
+            if ( aAppend )
+            {
+                // Not std::ios_base::app, which would write the scene fields patched by EndScene at the end
+                mFile.open(aFileName, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+                if ( mFile )
+                    mFile.seekp(0, std::ios_base::end);
+            }
+            if ( !mFile.is_open() )
+                mFile.open(aFileName, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+            if ( !mFile )
+            {
+                WARNING("Cannot open the project file %s for writing", aFileName.c_str());
+                return false;
+            }
+            return Open(mFile);
+        }
+
+        bool Writer::Open(std::ostream& aStream)
+        {
+            mStream = &aStream;
+            mWrittenBytes = 0;
+            if ( mStream->tellp() <= std::streampos(0) )
+            {
+                std::string lHeader(sMagic, sizeof sMagic);
+                AppendFixed(lHeader, sVersion, 4);
+                mStream->write(lHeader.data(), lHeader.size());
+                mWrittenBytes = lHeader.size();
+            }
+            mStrings.clear();
+            mScene = -1;
+            return true;
+        }
+
+        void Writer::WriteProject(const Json::Value& aProject)
+        {
+            mStrings.clear();
+            mPayload.clear();
+            Encode(aProject);
+            WriteRecord(Record::ePROJECT, mPayload);
+        }
+
+        void Writer::BeginScene(const Json::Value& aScene)
+        {
+            ASSERT(mScene == std::streampos(-1));
+
+            // The scenes do not share strings, so a scene can be skipped
+            mStrings.clear();
+            mPayload.clear();
+            AppendFixed(mPayload, 0, sSceneFields); // patched by EndScene
+            Encode(aScene);
+
+            mScene = mStream->tellp();
+            mSceneEntities = 0;
+            WriteRecord(Record::eSCENE, mPayload);
+        }
+
+        void Writer::WriteEntity(const Json::Value& aEntity, uint64_t aKey)
+        {
+            ASSERT(mScene != std::streampos(-1));
+            mPayload.clear();
+            PutVarint(aKey);
+            Encode(aEntity);
+            WriteRecord(Record::eENTITY, mPayload);
+            ++mSceneEntities;
+        }
+
+        void Writer::EndScene()
+        {
+            ASSERT(mScene != std::streampos(-1));
+            const std::streampos lEnd = mStream->tellp();
+            mPayload.clear();
+            WriteRecord(Record::eSCENE_END, mPayload);
+
+            // Bytes of the entity records, from the end of the scene record to its end record
+            const std::streamoff lSceneRecord = sRecordHeader + mSceneRecordBytes;
+            std::string lFields;
+            AppendFixed(lFields, static_cast<uint64_t>(lEnd - mScene - lSceneRecord), 8);
+            AppendFixed(lFields, mSceneEntities, 4);
+            const std::streampos lCurrent = mStream->tellp();
+            mStream->seekp(mScene + std::streamoff(sRecordHeader));
+            mStream->write(lFields.data(), lFields.size());
+            mStream->seekp(lCurrent);
+            mScene = -1;
+        }
+
+        void Writer::WriteRemoved(const std::vector<uint64_t>& aKeys)
+        {
+            ASSERT(mScene == std::streampos(-1));
+            mPayload.clear();
+            PutVarint(aKeys.size());
+            for ( uint64_t lKey : aKeys )
+                PutVarint(lKey);
+            WriteRecord(Record::eREMOVE, mPayload);
+        }
+
+        bool Writer::Close()
+        {
+            if ( mScene != std::streampos(-1) )
+                EndScene();
+            mPayload.clear();
+            WriteRecord(Record::eEND, mPayload);
+            mStream->flush();
+            const bool lIsOk = mStream->good();
+            if ( mStream == &mFile )
+                mFile.close();
+            mStream = nullptr;
+            mStrings.clear();
+            if ( !lIsOk )
+                WARNING("Failed to write the project file");
+            return lIsOk;
+        }
+
+        void Writer::WriteRecord(Record aType, const std::string& aPayload)
+        {
+            if ( aType == Record::eSCENE )
+                mSceneRecordBytes = aPayload.size();
+
+            char lHeader[sRecordHeader];
+            lHeader[0] = static_cast<char>(aType);
+            for ( size_t i = 0; i < 4; ++i )
+                lHeader[1 + i] = static_cast<char>((aPayload.size() >> (8 * i)) & 0xFF);
+            mStream->write(lHeader, sizeof lHeader);
+            mStream->write(aPayload.data(), aPayload.size());
+            mWrittenBytes += sizeof lHeader + aPayload.size();
+        }
+
+        void Writer::Encode(const Json::Value& aValue)
+        {
+            switch ( aValue.type() )
+            {
+            case Json::nullValue:
+                mPayload.push_back(eNULL);
+                break;
+            case Json::booleanValue:
+                mPayload.push_back(aValue.asBool() ? eTRUE : eFALSE);
+                break;
+            case Json::intValue:
+            {
+                const int64_t lValue = aValue.asInt64();
+                mPayload.push_back(eINT);
+                PutVarint((static_cast<uint64_t>(lValue) << 1) ^ static_cast<uint64_t>(lValue >> 63));
+                break;
+            }
+            case Json::uintValue:
+                mPayload.push_back(eUINT);
+                PutVarint(aValue.asUInt64());
+                break;
+            case Json::realValue:
+                if ( IsFloat(aValue) )
+                {
+                    mPayload.push_back(eFLOAT);
+                    AppendFixed(mPayload, FloatBits(aValue.asDouble()), 4);
+                }
+                else
+                {
+                    const double lValue = aValue.asDouble();
+                    uint64_t lBits;
+                    memcpy(&lBits, &lValue, sizeof lBits);
+                    mPayload.push_back(eDOUBLE);
+                    AppendFixed(mPayload, lBits, 8);
+                }
+                break;
+            case Json::stringValue:
+            {
+                const char* lBegin = nullptr;
+                const char* lEnd = nullptr;
+                aValue.getString(&lBegin, &lEnd);
+                EncodeString(lBegin, lEnd - lBegin);
+                break;
+            }
+            case Json::arrayValue:
+            {
+                // Positions, scales, rotations and colors are stored as they are in memory
+                const bool lFloats = IsFloatArray(aValue);
+                mPayload.push_back(lFloats ? eFLOATS : eARRAY);
+                PutVarint(aValue.size());
+                for ( Json::ArrayIndex i = 0; i < aValue.size(); ++i )
+                {
+                    if ( lFloats )
+                        AppendFixed(mPayload, FloatBits(aValue[i].asDouble()), 4);
+                    else
+                        Encode(aValue[i]);
+                }
+                break;
+            }
+            case Json::objectValue:
+                mPayload.push_back(eOBJECT);
+                PutVarint(aValue.size());
+                for ( auto lMember = aValue.begin(); lMember != aValue.end(); ++lMember )
+                {
+                    const char* lEnd = nullptr;
+                    const char* lBegin = lMember.memberName(&lEnd);
+                    EncodeString(lBegin, lEnd - lBegin);
+                    Encode(*lMember);
+                }
+                break;
+            }
+        }
+
+        void Writer::EncodeString(const char* aString, size_t aLength)
+        {
+            const std::string lString(aString, aLength);
+            auto lFound = mStrings.find(lString);
+            if ( lFound != mStrings.end() )
+            {
+                mPayload.push_back(eSTRING_REF);
+                PutVarint(lFound->second);
+                return;
+            }
+            const uint32_t lIndex = static_cast<uint32_t>(mStrings.size());
+            mStrings.emplace(lString, lIndex);
+            mPayload.push_back(eSTRING);
+            PutVarint(aLength);
+            mPayload.append(aString, aLength);
+        }
+
+        void Writer::PutVarint(uint64_t aValue)
+        {
+            while ( aValue >= 0x80 )
+            {
+                mPayload.push_back(static_cast<char>((aValue & 0x7F) | 0x80));
+                aValue >>= 7;
+            }
+            mPayload.push_back(static_cast<char>(aValue));
+        }
+
+
+        bool Reader::Open(const std::string& aFileName)
+        {
+            mFile.open(aFileName, std::ios_base::in | std::ios_base::binary);
+            if ( !Open(mFile) )
+            {
+                WARNING("%s is not a binary project file of this version", aFileName.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        bool Reader::Open(std::istream& aStream)
+        {
+            mStream = &aStream;
+            char lHeader[sizeof sMagic + 4];
+            if ( !*mStream || !mStream->read(lHeader, sizeof lHeader) || memcmp(lHeader, sMagic, sizeof sMagic) != 0 )
+                return false;
+            const uint32_t lVersion = static_cast<uint32_t>(ReadFixed(lHeader + sizeof sMagic, 4));
+            if ( lVersion > sVersion )
+            {
+                WARNING("The project has the version %u, this build reads up to %u", lVersion, sVersion);
+                return false;
+            }
+            mVersion = lVersion;
+            mStrings.clear();
+            mSceneEnd = -1;
+            return true;
+        }
+
+        Record Reader::Next(Json::Value& aValue)
+        {
+            aValue = Json::Value();
+
+            mRecord = mStream->tellg();
+            char lHeader[sRecordHeader];
+            if ( !mStream->read(lHeader, sizeof lHeader) )
+            {
+                WARNING("The project file is truncated");
+                return Record::eERROR;
+            }
+            const Record lType = static_cast<Record>(lHeader[0]);
+            mPayload.resize(static_cast<size_t>(ReadFixed(lHeader + 1, 4)));
+            if ( !mPayload.empty() && !mStream->read(&mPayload[0], mPayload.size()) )
+            {
+                WARNING("The project file is truncated");
+                return Record::eERROR;
+            }
+            mCursor = 0;
+
+            switch ( lType )
+            {
+            case Record::ePROJECT:
+                mStrings.clear();
+                break;
+            case Record::eSCENE:
+            {
+                if ( mPayload.size() < sSceneFields )
+                    return Record::eERROR;
+                const std::streamoff lEntityBytes = static_cast<std::streamoff>(ReadFixed(mPayload.data(), 8));
+                mSceneEntities = static_cast<uint32_t>(ReadFixed(mPayload.data() + 8, 4));
+                mSceneEnd = mStream->tellg() + lEntityBytes;
+                mCursor = sSceneFields;
+                mStrings.clear();
+                break;
+            }
+            case Record::eENTITY:
+                mEntityKey = 0;
+                if ( mVersion >= 2 && !GetVarint(mEntityKey) )
+                    return Record::eERROR;
+                break;
+            case Record::eREMOVE:
+            {
+                uint64_t lCount = 0;
+                if ( !GetVarint(lCount) || lCount > mPayload.size() )
+                    return Record::eERROR;
+                aValue = Json::Value(Json::arrayValue);
+                for ( uint64_t i = 0, lKey = 0; i < lCount; ++i )
+                {
+                    if ( !GetVarint(lKey) )
+                        return Record::eERROR;
+                    aValue.append(static_cast<Json::UInt64>(lKey));
+                }
+                return mCursor == mPayload.size() ? lType : Record::eERROR;
+            }
+            case Record::eSCENE_END:
+                mSceneEnd = -1;
+                return lType;
+            case Record::eEND:
+                return lType;
+            default:
+                WARNING("Unknown record %u in the project file", static_cast<uint32_t>(lType));
+                return Record::eERROR;
+            }
+
+            if ( !Decode(aValue) || mCursor != mPayload.size() )
+            {
+                WARNING("Corrupted record in the project file");
+                return Record::eERROR;
+            }
+            return lType;
+        }
+
+        bool Reader::SkipScene()
+        {
+            if ( mSceneEnd == std::streampos(-1) )
+                return false;
+            mStream->seekg(mSceneEnd);
+            return !!*mStream;
+        }
+
+        bool Reader::Seek(std::streampos aRecord)
+        {
+            mStream->clear();
+            mStream->seekg(aRecord);
+            mSceneEnd = -1;
+            return !!*mStream;
+        }
+
+        bool Reader::Decode(Json::Value& aValue)
+        {
+            uint8_t lTag;
+            if ( !GetBytes(&lTag, 1) )
+                return false;
+
+            uint64_t lCount = 0;
+            switch ( lTag )
+            {
+            case eNULL:
+                aValue = Json::Value();
+                return true;
+            case eFALSE:
+            case eTRUE:
+                aValue = (lTag == eTRUE);
+                return true;
+            case eINT:
+                if ( !GetVarint(lCount) )
+                    return false;
+                aValue = static_cast<Json::Int64>((lCount >> 1) ^ (~(lCount & 1) + 1));
+                return true;
+            case eUINT:
+                if ( !GetVarint(lCount) )
+                    return false;
+                aValue = static_cast<Json::UInt64>(lCount);
+                return true;
+            case eFLOAT:
+            {
+                char lBits[4];
+                if ( !GetBytes(lBits, sizeof lBits) )
+                    return false;
+                aValue = BitsFloat(static_cast<uint32_t>(ReadFixed(lBits, 4)));
+                return true;
+            }
+            case eDOUBLE:
+            {
+                char lBytes[8];
+                if ( !GetBytes(lBytes, sizeof lBytes) )
+                    return false;
+                const uint64_t lBits = ReadFixed(lBytes, 8);
+                double lValue;
+                memcpy(&lValue, &lBits, sizeof lValue);
+                aValue = lValue;
+                return true;
+            }
+            case eSTRING:
+            case eSTRING_REF:
+            {
+                --mCursor; // the string reads its own tag
+                std::string lString;
+                if ( !DecodeString(lString) )
+                    return false;
+                aValue = lString;
+                return true;
+            }
+            case eARRAY:
+            case eFLOATS:
+                if ( !GetVarint(lCount) || lCount > mPayload.size() - mCursor )
+                    return false;
+                aValue = Json::Value(Json::arrayValue);
+                if ( lCount )
+                    aValue.resize(static_cast<Json::ArrayIndex>(lCount));
+                for ( Json::ArrayIndex i = 0; i < lCount; ++i )
+                {
+                    if ( lTag == eARRAY )
+                    {
+                        if ( !Decode(aValue[i]) )
+                            return false;
+                        continue;
+                    }
+                    char lBits[4];
+                    if ( !GetBytes(lBits, sizeof lBits) )
+                        return false;
+                    aValue[i] = BitsFloat(static_cast<uint32_t>(ReadFixed(lBits, 4)));
+                }
+                return true;
+            case eOBJECT:
+            {
+                if ( !GetVarint(lCount) || lCount > mPayload.size() - mCursor )
+                    return false;
+                aValue = Json::Value(Json::objectValue);
+                std::string lName;
+                for ( uint64_t i = 0; i < lCount; ++i )
+                {
+                    if ( !DecodeString(lName) || !Decode(aValue[lName]) )
+                        return false;
+                }
+                return true;
+            }
+            default:
+                return false;
+            }
+        }
+
+        bool Reader::DecodeString(std::string& aString)
+        {
+            uint8_t lTag;
+            uint64_t lValue;
+            if ( !GetBytes(&lTag, 1) || !GetVarint(lValue) )
+                return false;
+
+            if ( lTag == eSTRING_REF )
+            {
+                if ( lValue >= mStrings.size() )
+                    return false;
+                aString = mStrings[static_cast<size_t>(lValue)];
+                return true;
+            }
+            if ( lTag != eSTRING || lValue > mPayload.size() - mCursor )
+                return false;
+            aString.assign(mPayload, mCursor, static_cast<size_t>(lValue));
+            mCursor += static_cast<size_t>(lValue);
+            mStrings.push_back(aString);
+            return true;
+        }
+
+        bool Reader::GetVarint(uint64_t& aValue)
+        {
+            aValue = 0;
+            for ( uint32_t lShift = 0; lShift < 64; lShift += 7 )
+            {
+                if ( mCursor >= mPayload.size() )
+                    return false;
+                const uint8_t lByte = static_cast<uint8_t>(mPayload[mCursor++]);
+                aValue |= uint64_t(lByte & 0x7F) << lShift;
+                if ( !(lByte & 0x80) )
+                    return true;
+            }
+            return false;
+        }
+
+        bool Reader::GetBytes(void* aData, size_t aSize)
+        {
+            if ( aSize > mPayload.size() - mCursor )
+                return false;
+            memcpy(aData, mPayload.data() + mCursor, aSize);
+            mCursor += aSize;
+            return true;
+        }
+
+
+        bool IsBinary(const std::string& aFileName)
+        {
+            std::ifstream lFile(aFileName, std::ios_base::in | std::ios_base::binary);
+            char lMagic[sizeof sMagic];
+            return lFile.read(lMagic, sizeof lMagic) && memcmp(lMagic, sMagic, sizeof sMagic) == 0;
+        }
+
+        bool HasBinaryExtension(const std::string& aFileName)
+        {
+            const size_t lLength = strlen(sBinaryExtension);
+            return aFileName.size() >= lLength && aFileName.compare(aFileName.size() - lLength, lLength, sBinaryExtension) == 0;
+        }
+
+        bool ReplaceFile(const std::string& aNewFile, const std::string& aFileName)
+        {
+            if ( std::rename(aNewFile.c_str(), aFileName.c_str()) == 0 )
+                return true;
+            // Windows does not rename over an existing file
+            std::remove(aFileName.c_str());
+            if ( std::rename(aNewFile.c_str(), aFileName.c_str()) == 0 )
+                return true;
+            WARNING("Cannot replace %s", aFileName.c_str());
+            return false;
+        }
+
+        namespace
+        {
+            /* Writes a value as StyledWriter does, its lines after the first one indented */
+            void WriteStyled(std::ostream& aOut, const Json::Value& aValue, const std::string& aIndent)
+            {
+                Json::StyledWriter lWriter;
+                const std::string lText = lWriter.write(aValue);
+                size_t lLength = lText.size();
+                while ( lLength && lText[lLength - 1] == '\n' )
+                    --lLength;
+                for ( size_t i = 0; i < lLength; ++i )
+                {
+                    aOut.put(lText[i]);
+                    if ( lText[i] == '\n' )
+                        aOut << aIndent;
+                }
+            }
+
+            void WriteMembers(std::ostream& aOut, const Json::Value& aObject, const std::string& aIndent)
+            {
+                for ( auto lMember = aObject.begin(); lMember != aObject.end(); ++lMember )
+                {
+                    aOut << aIndent << Json::valueToQuotedString(lMember.name().c_str()) << " : ";
+                    WriteStyled(aOut, *lMember, aIndent);
+                    aOut << ",\n";
+                }
+            }
+        }
+
+        bool ExportJson(const std::string& aBinaryFile, const std::string& aJsonFile)
+        {
+            Reader lReader;
+            if ( !lReader.Open(aBinaryFile) )
+                return false;
+            std::ofstream lOut(aJsonFile, std::ios_base::out | std::ios_base::trunc);
+            if ( !lOut )
+            {
+                WARNING("Cannot open %s for writing", aJsonFile.c_str());
+                return false;
+            }
+
+            const std::string lSceneIndent(6, ' ');
+            const std::string lEntityIndent(12, ' ');
+            bool lFirstScene = true;
+            bool lFirstEntity = true;
+            Json::Value lValue;
+            lOut << "{\n";
+            for ( ;; )
+            {
+                const Record lRecord = lReader.Next(lValue);
+                switch ( lRecord )
+                {
+                case Record::ePROJECT:
+                    WriteMembers(lOut, lValue, "   ");
+                    break;
+                case Record::eSCENE:
+                    lOut << (lFirstScene ? "   \"scenes\" : [\n" : ",\n") << "      {\n";
+                    lFirstScene = false;
+                    lValue.removeMember("entities");
+                    WriteMembers(lOut, lValue, "         ");
+                    lOut << "         \"entities\" : [";
+                    lFirstEntity = true;
+                    break;
+                case Record::eENTITY:
+                    lOut << (lFirstEntity ? "\n" : ",\n") << lEntityIndent;
+                    lFirstEntity = false;
+                    WriteStyled(lOut, lValue, lEntityIndent);
+                    break;
+                case Record::eSCENE_END:
+                    lOut << "\n         ]\n" << lSceneIndent << "}";
+                    break;
+                case Record::eEND:
+                    lOut << (lFirstScene ? "   \"scenes\" : []\n}\n" : "\n   ]\n}\n");
+                    lOut.close();
+                    return !!lOut;
+                default:
+                    return false;
+                }
+            }
+        }
+
+        bool ImportJson(const std::string& aJsonFile, const std::string& aBinaryFile)
+        {
+            Json::Value lProject;
+            if ( !Json::JsonUtils::OpenAndParseJsonFromFile(lProject, aJsonFile) )
+            {
+                WARNING("Cannot load '%s' file as a project!", aJsonFile.c_str());
+                return false;
+            }
+
+            Writer lWriter;
+            if ( !lWriter.Open(aBinaryFile) )
+                return false;
+
+            Json::Value lScenes;
+            lProject.removeMember("scenes", &lScenes);
+            lWriter.WriteProject(lProject);
+            for ( Json::Value& lScene : lScenes )
+            {
+                Json::Value lEntities;
+                lScene.removeMember("entities", &lEntities);
+                lWriter.BeginScene(lScene);
+                for ( const Json::Value& lEntity : lEntities )
+                    lWriter.WriteEntity(lEntity);
+                lWriter.EndScene();
+            }
+            return lWriter.Close();
+        }
+    }
+}
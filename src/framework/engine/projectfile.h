@@ -0,0 +1,204 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Binary project file. The project is a sequence of records, each
+ *                one the type, the length of the payload and the payload: the
+ *                project properties, then per scene its header, its entities and
+ *                its end. The payloads are the JSON values of the current format
+ *                in a compact encoding: the strings go to a string table of the
+ *                scene the first time they are seen and are referenced by index
+ *                afterwards, and the arrays of floats, as the transforms, are
+ *                stored as raw floats.
+ *
+ *                The writer encodes every record as it is given and the reader
+ *                decodes one record at a time, so neither of them holds the
+ *                values of the whole project.
+ *******************************************************************************/
+
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+#include "json/json.h"
+
+namespace Framework
+{
+    namespace ProjectFile
+    {
+        /* 2: the entity records start with the key of the entity */
+        static const uint32_t sVersion = 2;
+
+        /* The binary format is opt-in, a project is saved in it when its file has this extension */
+        static const char* const sBinaryExtension = ".sh3b";
+
+        enum class Record : uint8_t
+        {
+            eERROR = 0,     /**< Only returned by the reader, on a corrupted or truncated file */
+            ePROJECT,       /**< Project properties: projectName, sample */
+            eSCENE,         /**< Scene attributes, all the ones of the JSON scene but the entities */
+            eENTITY,        /**< An entity as Entity::Serialize writes it */
+            eSCENE_END,
+            eEND,
+            eREMOVE,        /**< Keys of removed entities, an array, only in the autosave journal */
+        };
+
+        class Writer
+        {
+        public:
+            ~Writer();
+
+            /**
+             * @param aAppend  Appends the records to an existing file, as the journal of
+             *                 the autosave does, a new file is created if there is none
+             */
+            bool Open(const std::string& aFileName, bool aAppend = false);
+
+            /**
+             * Writes to a stream of the caller, as a scene kept in memory. The stream must
+             * seek, EndScene patches the scene record
+             */
+            bool Open(std::ostream& aStream);
+
+            void WriteProject(const Json::Value& aProject);
+            void BeginScene(const Json::Value& aScene);
+
+            /**
+             * @param aKey  Identifies the entity in the file, its entity id when saved by
+             *              the engine. The JSON project has no key, so it is dropped by the export
+             */
+            void WriteEntity(const Json::Value& aEntity, uint64_t aKey = 0);
+            void EndScene();
+
+            /**
+             * @return Position of the record of the open scene, where a reader seeks to read it
+             */
+            std::streampos GetScenePosition() const { return mScene; }
+
+            void WriteRemoved(const std::vector<uint64_t>& aKeys);
+
+            /**
+             * Writes the end of the project and closes the file
+             *
+             * @return false if any of the writes failed
+             */
+            bool Close();
+
+            uint64_t GetWrittenBytes() const { return mWrittenBytes; }
+
+        private:
+            void WriteRecord(Record aType, const std::string& aPayload);
+            void Encode(const Json::Value& aValue);
+            void EncodeString(const char* aString, size_t aLength);
+            void PutVarint(uint64_t aValue);
+
+            std::ofstream                             mFile;
+            std::ostream*                             mStream = nullptr;
+            std::string                               mPayload;        /**< Scratch buffer of the record being encoded */
+            std::unordered_map<std::string, uint32_t> mStrings;        /**< String table of the current scene */
+            std::streampos                            mScene = -1;     /**< Position of the open scene record */
+            size_t                                    mSceneRecordBytes = 0;
+            uint32_t                                  mSceneEntities = 0;
+            uint64_t                                  mWrittenBytes = 0;
+        };
+
+        class Reader
+        {
+        public:
+            bool Open(const std::string& aFileName);
+            bool Open(std::istream& aStream);
+
+            /**
+             * Reads the next record
+             *
+             * @param aValue  Decoded payload, null for the records without one
+             *
+             * @return Type of the record, eEND at the end of the project
+             */
+            Record Next(Json::Value& aValue);
+
+            /**
+             * Jumps over the entities of the scene whose header was just read, to
+             * its end record
+             */
+            bool SkipScene();
+
+            /**
+             * Moves to a record whose position was known before, as the one of a scene
+             */
+            bool Seek(std::streampos aRecord);
+
+            /**
+             * @return Position of the last record read
+             */
+            std::streampos GetRecordPosition() const { return mRecord; }
+
+            /**
+             * @return Entities of the last scene read, known from its header
+             */
+            uint32_t GetSceneEntities() const { return mSceneEntities; }
+
+            /**
+             * @return Key of the last entity read
+             */
+            uint64_t GetEntityKey() const { return mEntityKey; }
+
+            /**
+             * @return true if there are no more records, a file can hold several
+             *         projects ended by eEND, as the journal of the autosave does
+             */
+            bool AtEnd() { return mStream->peek() == std::char_traits<char>::eof(); }
+
+        private:
+            bool Decode(Json::Value& aValue);
+            bool DecodeString(std::string& aString);
+            bool GetVarint(uint64_t& aValue);
+            bool GetBytes(void* aData, size_t aSize);
+
+            std::ifstream            mFile;
+            std::istream*            mStream = nullptr;
+            std::string              mPayload;          /**< Payload of the record being decoded */
+            size_t                   mCursor = 0;
+            std::vector<std::string> mStrings;          /**< String table of the current scene */
+            std::streampos           mSceneEnd = -1;    /**< Position of the end record of the current scene */
+            std::streampos           mRecord = -1;
+            uint32_t                 mSceneEntities = 0;
+            uint64_t                 mEntityKey = 0;
+            uint32_t                 mVersion = sVersion;
+        };
+
+        /**
+         * @return true if the file starts as a binary project
+         */
+        bool IsBinary(const std::string& aFileName);
+
+        /**
+         * @return true if the file name ends with sBinaryExtension
+         */
+        bool HasBinaryExtension(const std::string& aFileName);
+
+        /**
+         * Replaces a file by a new one written next to it, so a failed save does not
+         * destroy the previous file
+         */
+        bool ReplaceFile(const std::string& aNewFile, const std::string& aFileName);
+
+        /**
+         * Writes a binary project as a JSON project. The entities are converted one
+         * at a time
+         */
+        bool ExportJson(const std::string& aBinaryFile, const std::string& aJsonFile);
+
+        /**
+         * Writes a JSON project as a binary project. The JSON project is parsed
+         * whole, as the JSON loading does
+         */
+        bool ImportJson(const std::string& aJsonFile, const std::string& aBinaryFile);
+    }
+}
@@ -14,11 +14,28 @@
 #include "graphic/renderer.h"
 #include "graphic/model3d.h"
 #include "graphic/model2d.h"
-#include "graphic/opengl/opengl_shader.h"
+#include "graphic/shader.h"
 #include "graphic/procedural/texturedquad.h"
+#include "core/graphic/texturecooker.h"
 
 namespace Framework
 {
+    namespace
+    {
+        /* The 2D assets are textured quads */
+        void MakeTexturedQuad(Asset2D& aAsset, Texture&& aTexture, float aWidth, float aHeight)
+        {
+            Procedural::TexturedQuad lTexQuadAsset(aWidth, aHeight, std::move(aTexture));
+            const_cast<string&>(lTexQuadAsset.GetName()) = aAsset.GetName(); // hack!
+            aAsset = std::move(lTexQuadAsset);
+        }
+
+        double Milliseconds(std::chrono::steady_clock::time_point aStart)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - aStart).count();
+        }
+    }
+
     ResourceManager::ResourceManager()
     {}
 
@@ -37,34 +54,34 @@ namespace Framework
         // first, add all shaders that are in use
 
         // No lighting shader:
-        Shader* lShader = new OpenGLShader("No lighting");
+        Shader* lShader = Shader::New("No lighting");
         string err;
         if ( !lShader->Load("lighting/no_lighting", err) )
             CRASH("Failed to load 'No lighting' shader: %s", err.c_str());        
         mShaders.push_back(lShader);
 
         // Shaders for deferred shading technique:
-        lShader = new OpenGLShader("DeferredShading_GeometryPass");
+        lShader = Shader::New("DeferredShading_GeometryPass");
         if ( !lShader->Load("lighting/deferred/geometry_pass", err) )
             CRASH("Failed to load 'Deferred shading - geometry pass' shader: %s", err.c_str());        
         mShaders.push_back(lShader);
 
-        lShader = new OpenGLShader("DeferredShading_AmbientPass");
+        lShader = Shader::New("DeferredShading_AmbientPass");
         if ( !lShader->Load("lighting/deferred/ambient_pass", err) )
             CRASH("Failed to load 'Deferred shading - ambient pass' shader: %s", err.c_str());        
         mShaders.push_back(lShader);
 
-        lShader = new OpenGLShader("DeferredShading_DirectionalLightPass");
+        lShader = Shader::New("DeferredShading_DirectionalLightPass");
         if ( !lShader->Load("lighting/deferred/directional_light_pass", err) )
             CRASH("Failed to load 'Deferred shading - directional light pass' shader: %s", err.c_str());        
         mShaders.push_back(lShader);
 
-        lShader = new OpenGLShader("DeferredShading_PointLightPass");
+        lShader = Shader::New("DeferredShading_PointLightPass");
         if ( !lShader->Load("lighting/deferred/point_light_pass", err) )
             CRASH("Failed to load 'Deferred shading - point light pass' shader: %s", err.c_str());        
         mShaders.push_back(lShader);
 
-        lShader = new OpenGLShader("DeferredShading_SpotLightPass");
+        lShader = Shader::New("DeferredShading_SpotLightPass");
         if ( !lShader->Load("lighting/deferred/spot_light_pass", err) )
             CRASH("Failed to load 'Deferred shading - spot light pass' shader: %s", err.c_str());        
         mShaders.push_back(lShader);
@@ -76,13 +93,13 @@ namespace Framework
         mShaders.push_back(lShader);*/
 
         // Shadow map:
-        lShader = OpenGLShader::New("Depth");
+        lShader = Shader::New("Depth");
         if ( !lShader->Load("utils/depth", err) )
             CRASH("Failed to load 'utils/depth': %s\n", err.c_str());
         mShaders.push_back(lShader);
 
         // Gizmo drawing:
-        lShader = new OpenGLShader("Gizmo drawing");
+        lShader = Shader::New("Gizmo drawing");
         if ( lShader->Load("utils/gizmos", err) )
             mShaders.push_back(lShader);
         else
@@ -92,7 +109,7 @@ namespace Framework
         }
 
         // Grid drawing 2D:
-        lShader = new OpenGLShader("Grid drawing 2D");
+        lShader = Shader::New("Grid drawing 2D");
         if ( lShader->Load("utils/grid2d", err) )
            mShaders.push_back(lShader);
         else
@@ -102,7 +119,7 @@ namespace Framework
         }
 
         // Grid drawing 3D:
-        lShader = new OpenGLShader("Grid drawing 3D");
+        lShader = Shader::New("Grid drawing 3D");
         if (lShader->Load("utils/grid3d", err))
             mShaders.push_back(lShader);
         else
@@ -111,12 +128,17 @@ namespace Framework
             delete lShader;
         }
 
+        for ( auto lLoaded : mShaders )
+            RecordShader(*lLoaded);
+
         // Now load models, images, scenes
         for ( const auto& lResourceFile : aResourceFiles )
         {
-            Json::Value lRes;
-            Json::JsonUtils::OpenAndParseJsonFromFile(lRes, lResourceFile);
-            for ( auto lResModel : lRes["models"] )
+            // Read in place, the resource files are the largest JSON of the startup
+            JsonDocument lDocument;
+            Json::JsonUtils::OpenAndParseJsonFromFile(lDocument, lResourceFile);
+            const JsonView lRes = lDocument.GetRoot();
+            for ( const JsonView lResModel : lRes["models"] )
             {
                 if ( lResModel.isMember("asset3d") )
                     AddAsset3D(lResModel);
@@ -125,20 +147,30 @@ namespace Framework
                 if ( lResModel.isMember("icon") )
                     AddImage(lResModel);
             }
-            for ( auto lImage : lRes["images"] )
+            for ( const JsonView lImage : lRes["images"] )
                 AddImage(lImage);
-            for ( auto lProject : lRes["projects"] )
+            for ( const JsonView lProject : lRes["projects"] )
                 AddProject(lProject.asString());
         }
+
+        // The images of all the resource files were decoded in parallel
+        const auto lStart = std::chrono::steady_clock::now();
+        const uint32_t lImages = mImageLoader.Flush();
+        INFO(LogLevel::eLEVEL2, "%u images loaded in %.1f ms", lImages,
+             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - lStart).count());
     }
 
 
     void ResourceManager::DeInitialize()
     {
+        mStreamer.Shutdown();
+        mImageLoader.Shutdown();
+        mWatcher.Clear();
         ClearAssets3D();
         ClearAssets2D();
         ClearImages();
         ClearProjectList();
+        mDependencies.Clear();
     }
 
     // Note: there is no AddShader
@@ -159,7 +191,7 @@ namespace Framework
     }
 
 
-    bool ResourceManager::AddAsset3D(const Json::Value& aSerializer)
+    bool ResourceManager::AddAsset3D(const JsonView& aSerializer)
     {
         if ( !aSerializer.isMember("name") )
             CRASH("Object has no 'name' attribute!");
@@ -171,20 +203,17 @@ namespace Framework
         const string lName = aSerializer["name"].asString();
         const string lResourceName = aSerializer["asset3d"].asString();
         // check that we won't add duplicates :
-        for ( auto lAsset : mAssets3D )
-            if ( lAsset->GetName() == lName ||
-                lAsset->GetResourceName() == lResourceName )
-            {
-                WARNING("Asset3D '%s'(%s) already exists and cannot be added again!",
-                    lName.c_str(), lResourceName.c_str());
-                return false;
-            }
-        mAssets3D.push_back(std::make_shared<Asset3D>(lName, lResourceName));
+        if ( !mAssets3D.Add(lName, lResourceName, true) )
+        {
+            WARNING("Asset3D '%s'(%s) already exists and cannot be added again!",
+                lName.c_str(), lResourceName.c_str());
+            return false;
+        }
         return true;
     }
 
 
-    bool ResourceManager::AddAsset2D(const Json::Value& aSerializer)
+    bool ResourceManager::AddAsset2D(const JsonView& aSerializer)
     {
         if ( !aSerializer.isMember("name") )
             CRASH("Object has no 'name' attribute!");
@@ -194,28 +223,27 @@ namespace Framework
 
         const string lName = aSerializer["name"].asString();
         const string lResourceName = aSerializer["asset2d"].asString();
-        // check that we won't add duplicates :
-        for ( auto lAsset : mAssets2D )
-            if ( lAsset->GetName() == lName /*|| // ignore duplicate resource names for now
-                lAsset->GetResourceName() == lResourceName*/ )
-            {
-                WARNING("Asset2D '%s'(%s) already exists and cannot be added again!",
-                    lName.c_str(), lResourceName.c_str());
-                return false;
-            }
-        mAssets2D.push_back(std::make_shared<Asset2D>(lName, lResourceName));
+        // check that we won't add duplicates (ignore duplicate resource names for now) :
+        if ( !mAssets2D.Add(lName, lResourceName, false) )
+        {
+            WARNING("Asset2D '%s'(%s) already exists and cannot be added again!",
+                lName.c_str(), lResourceName.c_str());
+            return false;
+        }
         return true;
     }
 
 		
 	Model3D* ResourceManager::CreateModel3D(const string& aAssetName) const
     {
-        auto lAsset = FindAsset3D(aAssetName);
-        if ( !lAsset )
+        const uint32_t lIndex = mAssets3D.FindIndex(aAssetName);
+        if ( lIndex == ResourceRegistryBase::sInvalidIndex )
         {
             WARNING("Asset3D '%s' does not exist in the resource manager!", aAssetName.c_str());
             return nullptr;
         }
+        mAssets3D.MarkUsed(lIndex, mFrame);
+        std::shared_ptr<const Asset3D> lAsset = mAssets3D.Get(lIndex);
         if ( !lAsset->mRendererResources )
         {
             Asset3D* lAsset_ = const_cast<Asset3D*>(lAsset.get());
@@ -231,34 +259,357 @@ namespace Framework
                 WARNING("Failed to prepare asset %s", lAsset->GetName().c_str());
                 return nullptr;
             }
+            mAssets3D.SetResident(lIndex, true, lAsset->GetCpuSize(), lAsset->GetGpuSize());
+            RecordAsset3D(lIndex);
+        }
+        return new Model3D(std::move(lAsset));
+    }
+
+
+    std::shared_future<bool> ResourceManager::LoadAsset3DAsync(const string& aAssetName, AssetStreamer::Callback aCallback) const
+    {
+        const uint32_t lIndex = mAssets3D.FindIndex(aAssetName);
+        if ( lIndex != ResourceRegistryBase::sInvalidIndex )
+        {
+            mAssets3D.MarkUsed(lIndex, mFrame);
+            // The memory of the asset is accounted once it is uploaded
+            return mStreamer.Request(mAssets3D.Get(lIndex), [this, lIndex, aCallback](const std::shared_ptr<const Asset3D>& aAsset, bool aLoaded)
+            {
+                if ( aLoaded && lIndex < mAssets3D.GetCount() && mAssets3D.Get(lIndex) == aAsset )
+                {
+                    mAssets3D.SetResident(lIndex, true, aAsset->GetCpuSize(), aAsset->GetGpuSize());
+                    RecordAsset3D(lIndex);
+                }
+                if ( aCallback )
+                    aCallback(aAsset, aLoaded);
+            });
+        }
+
+        WARNING("Asset3D '%s' does not exist in the resource manager!", aAssetName.c_str());
+        std::promise<bool> lPromise;
+        lPromise.set_value(false);
+        if ( aCallback )
+            aCallback(nullptr, false);
+        return lPromise.get_future().share();
+    }
+
+
+    uint32_t ResourceManager::UpdateStreaming(const Renderer& aRenderer)
+    {
+        const uint32_t lChanged = UpdateHotReload(aRenderer);
+        mImageLoader.Update();
+        const uint32_t lFinished = mStreamer.Update(aRenderer);
+        ++mFrame;
+        TrimMemory();
+        return lFinished + lChanged;
+    }
+
+
+    uint32_t ResourceManager::TrimMemory()
+    {
+        mProceduralMeshes.Trim();
+        return ResourceRegistryBase::Trim(mBudget, mFrame, { &mAssets3D, &mAssets2D });
+    }
+
+
+    ResourceManager::Stats ResourceManager::GetStats() const
+    {
+        Stats lStats;
+        lStats.mAssets3D = mAssets3D.GetStats();
+        lStats.mAssets2D = mAssets2D.GetStats();
+        for ( const auto& lImage : mImages )
+        {
+            if ( lImage.second.mId > 0 )
+            {
+                ++lStats.mImages;
+                lStats.mImageBytes += lImage.second.mBytes;
+            }
+        }
+        lStats.mProceduralMeshes = mProceduralMeshes.GetStats();
+        lStats.mBudget = mBudget;
+        return lStats;
+    }
+
+
+    void ResourceManager::ResetStats()
+    {
+        mAssets3D.ResetCounters();
+        mAssets2D.ResetCounters();
+        mHotReloadStats = HotReloadStats();
+    }
+
+
+    void ResourceManager::EnableHotReload(bool aEnable)
+    {
+        mHotReload = aEnable;
+        if ( !mHotReload )
+        {
+            mWatcher.Clear();
+            return;
+        }
+        for ( uint32_t i = 0; i < mDependencies.GetNodeCount(); ++i )
+            if ( mDependencies.GetNode(i).mType == DependencyGraph::NodeType::eFILE )
+                mWatcher.Watch(mDependencies.GetNode(i).mName);
+        INFO(LogLevel::eLEVEL2, "Hot reload watching %u files (%s)", mWatcher.GetFileCount(),
+             FileWatcher::IsNative() ? "notified" : "polled");
+    }
+
+
+    uint32_t ResourceManager::UpdateHotReload(const Renderer& aRenderer)
+    {
+        if ( !mHotReload )
+            return 0;
+        std::vector<string> lChanged;
+        if ( mWatcher.Poll(lChanged) == 0 )
+            return 0;
+
+        for ( const auto& lFile : lChanged )
+        {
+            const auto lStart = std::chrono::steady_clock::now();
+            const uint32_t lFileNode = mDependencies.FindNode(DependencyGraph::NodeType::eFILE, lFile);
+            if ( lFileNode == DependencyGraph::sInvalidNode )
+                continue;
+            std::vector<uint32_t> lDependents;
+            mDependencies.CollectDependents(lFileNode, lDependents);
+
+            /* The materials and textures are reloaded with their model. A reload
+               records the dependencies again, so the node is copied first */
+            uint32_t lReloaded = 0, lFailed = 0;
+            for ( uint32_t lNode : lDependents )
+            {
+                const DependencyGraph::NodeType lType = mDependencies.GetNode(lNode).mType;
+                const string lName = mDependencies.GetNode(lNode).mName;
+                int lResult = 0;
+                switch ( lType )
+                {
+                case DependencyGraph::NodeType::eSHADER:  lResult = ReloadShader(lName); break;
+                case DependencyGraph::NodeType::eASSET3D: lResult = ReloadAsset3D(lName, aRenderer); break;
+                case DependencyGraph::NodeType::eASSET2D: lResult = ReloadAsset2D(lName, aRenderer); break;
+                case DependencyGraph::NodeType::eIMAGE:   lResult = ReloadImage(lName); break;
+                default: break;
+                }
+                if ( lResult > 0 )
+                    ++lReloaded;
+                else if ( lResult < 0 )
+                    ++lFailed;
+            }
+
+            const double lLatency = Milliseconds(lStart);
+            ++mHotReloadStats.mChanges;
+            mHotReloadStats.mDependents += static_cast<uint32_t>(lDependents.size());
+            mHotReloadStats.mReloaded += lReloaded;
+            mHotReloadStats.mFailed += lFailed;
+            mHotReloadStats.mLastLatency = lLatency;
+            mHotReloadStats.mMaxLatency = std::max(mHotReloadStats.mMaxLatency, lLatency);
+            INFO(LogLevel::eLEVEL2, "Hot reload of %s: %u dependents touched, %u reloaded, %u failed in %.2f ms", lFile.c_str(),
+                 static_cast<uint32_t>(lDependents.size()), lReloaded, lFailed, lLatency);
+        }
+        return static_cast<uint32_t>(lChanged.size());
+    }
+
+
+    void ResourceManager::AddFileDependency(uint32_t aNode, const string& aFile) const
+    {
+        const uint32_t lFileNode = mDependencies.AddNode(DependencyGraph::NodeType::eFILE, aFile);
+        mDependencies.AddDependency(aNode, lFileNode);
+        if ( mHotReload )
+            mWatcher.Watch(mDependencies.GetNode(lFileNode).mName);
+    }
+
+
+    void ResourceManager::RecordShader(const Shader& aShader)
+    {
+        const uint32_t lNode = mDependencies.AddNode(DependencyGraph::NodeType::eSHADER, aShader.GetName());
+        mDependencies.ClearDependencies(lNode);
+        for ( const auto& lFile : aShader.GetSourceFiles() )
+            AddFileDependency(lNode, lFile);
+    }
+
+
+    void ResourceManager::RecordAsset3D(uint32_t aIndex) const
+    {
+        const Asset3D& lAsset = *mAssets3D.Get(aIndex);
+        const uint32_t lNode = mDependencies.AddNode(DependencyGraph::NodeType::eASSET3D, lAsset.GetName());
+        mDependencies.ClearDependencies(lNode);
+        AddFileDependency(lNode, mAssets3D.GetResourcePath(aIndex));
+
+        /* The material and the texture of every rendering list are embedded in the
+           model file, they are named after the asset and the list */
+        for ( size_t i = 0; i < lAsset.GetMaterials().size(); ++i )
+        {
+            const string lList = lAsset.GetName() + "#" + std::to_string(i);
+            const uint32_t lMaterial = mDependencies.AddNode(DependencyGraph::NodeType::eMATERIAL, lList);
+            mDependencies.ClearDependencies(lMaterial);
+            mDependencies.AddDependency(lNode, lMaterial);
+            mDependencies.AddDependency(lMaterial, mDependencies.AddNode(DependencyGraph::NodeType::eTEXTURE, lList));
+        }
+    }
+
+
+    void ResourceManager::RecordAsset2D(uint32_t aIndex) const
+    {
+        const uint32_t lNode = mDependencies.AddNode(DependencyGraph::NodeType::eASSET2D, mAssets2D.GetName(aIndex));
+        mDependencies.ClearDependencies(lNode);
+        AddFileDependency(lNode, mAssets2D.GetResourcePath(aIndex));
+    }
+
+
+    void ResourceManager::RecordImage(const string& aName, const string& aFile)
+    {
+        const uint32_t lNode = mDependencies.AddNode(DependencyGraph::NodeType::eIMAGE, aName);
+        mDependencies.ClearDependencies(lNode);
+        AddFileDependency(lNode, aFile);
+    }
+
+
+    int ResourceManager::ReloadShader(const string& aName)
+    {
+        auto lShader = std::find_if(mShaders.begin(), mShaders.end(), [&aName](const Shader* aShader) { return aShader->GetName() == aName; });
+        if ( lShader == mShaders.end() )
+            return 0;
+        string lError;
+        if ( !(*lShader)->Reload(lError) )
+        {
+            WARNING("Failed to reload shader '%s', the previous program is kept: %s", aName.c_str(), lError.c_str());
+            return -1;
+        }
+        RecordShader(**lShader);
+        return 1;
+    }
+
+
+    int ResourceManager::ReloadAsset3D(const string& aName, const Renderer& aRenderer)
+    {
+        const uint32_t lIndex = mAssets3D.FindIndex(aName);
+        if ( lIndex == ResourceRegistryBase::sInvalidIndex || !mAssets3D.IsResident(lIndex) )
+            return 0;
+
+        /* Loaded aside, so a broken file leaves the asset as it was. The models keep
+           the same asset and show the new data */
+        const std::shared_ptr<Asset3D>& lAsset = mAssets3D.Get(lIndex);
+        const string& lResourceName = mAssets3D.GetResourcePath(lIndex);
+        Asset3D lLoaded(aName, lResourceName);
+        if ( !lLoaded.Load(lResourceName) )
+        {
+            WARNING("Failed to reload asset %s(%s), the previous version is kept", aName.c_str(), lResourceName.c_str());
+            return -1;
+        }
+        lAsset->TakeData(lLoaded);
+        lAsset->mRendererResources.reset();
+        if ( !aRenderer.PrepareForRendering(*lAsset) )
+        {
+            WARNING("Failed to prepare asset %s", aName.c_str());
+            mAssets3D.SetResident(lIndex, false, 0, 0);
+            return -1;
+        }
+        mAssets3D.SetResident(lIndex, true, lAsset->GetCpuSize(), lAsset->GetGpuSize());
+        RecordAsset3D(lIndex);
+        return 1;
+    }
+
+
+    int ResourceManager::ReloadAsset2D(const string& aName, const Renderer& aRenderer)
+    {
+        const uint32_t lIndex = mAssets2D.FindIndex(aName);
+        if ( lIndex == ResourceRegistryBase::sInvalidIndex || !mAssets2D.IsResident(lIndex) )
+            return 0;
+
+        const string& lResourceName = mAssets2D.GetResourcePath(lIndex);
+        Texture lTexture;
+        if ( !TextureCooker::Load(lResourceName, lTexture) )
+        {
+            WARNING("Failed to reload asset %s(%s), the previous version is kept", aName.c_str(), lResourceName.c_str());
+            return -1;
+        }
+        Asset2D& lAsset = *mAssets2D.Get(lIndex);
+        const glm::vec2 lSize = mQuadSizes[lIndex];
+        lAsset.mRendererResources.reset();
+        MakeTexturedQuad(lAsset, std::move(lTexture), lSize.x, lSize.y);
+        if ( !aRenderer.PrepareForRendering(lAsset) )
+        {
+            WARNING("Failed to prepare asset %s", aName.c_str());
+            mAssets2D.SetResident(lIndex, false, 0, 0);
+            return -1;
         }
+        mAssets2D.SetResident(lIndex, true, lAsset.GetCpuSize(), lAsset.GetGpuSize());
+        return 1;
+    }
+
+
+    int ResourceManager::ReloadImage(const string& aName)
+    {
+        auto lRecord = mImages.find(aName);
+        if ( lRecord == mImages.end() || lRecord->second.mId <= 0 )
+            return 0; // the decode in flight may read the old file, it is not reloaded
+
+        /* Decoded on the main thread, the latency of the reload includes it */
+        ImageDecoder::Options lOptions;
+        lOptions.mChannels = 4;
+        lOptions.mFlipVertically = false;
+        Texture lImage;
+        if ( !ImageDecoder::Decode(lRecord->second.mFile, lImage, lOptions) )
+        {
+            WARNING("Failed to reload image %s(%s), the previous version is kept", aName.c_str(), lRecord->second.mFile.c_str());
+            return -1;
+        }
+
+        NVGcontext* lContext = Engine::Instance()->Display().nvgContext();
+        int lWidth = 0, lHeight = 0;
+        nvgImageSize(lContext, lRecord->second.mId, &lWidth, &lHeight);
+        if ( lWidth == static_cast<int>(lImage.mWidth) && lHeight == static_cast<int>(lImage.mHeight) )
+        {
+            nvgUpdateImage(lContext, lRecord->second.mId, lImage.mPixels.data());
+            return 1;
+        }
+
+        /* A new size needs a new image. The old one is not deleted, the widgets that
+           looked it up draw it until they are created again */
+        const int lImageId = nvgCreateImageRGBA(lContext, lImage.mWidth, lImage.mHeight, 0, lImage.mPixels.data());
+        if ( lImageId <= 0 )
+        {
+            WARNING("Could not load image \"%s\"", aName.c_str());
+            return -1;
+        }
+        lRecord->second.mId = lImageId;
+        lRecord->second.mBytes = lImage.mPixels.size();
+        return 1;
+    }
+
+    Model3D* ResourceManager::CreateModel3DAsync(const string& aAssetName, AssetStreamer::Callback aCallback) const
+    {
+        auto lAsset = FindAsset3D(aAssetName);
+        if ( !lAsset )
+        {
+            WARNING("Asset3D '%s' does not exist in the resource manager!", aAssetName.c_str());
+            return nullptr;
+        }
+        LoadAsset3DAsync(aAssetName, std::move(aCallback));
         return new Model3D(std::move(lAsset));
     }
 
 
     std::shared_ptr<const Asset3D> ResourceManager::FindAsset3D(const string& aAssetName) const
     {
-        for (auto& lAsset : mAssets3D )
-            if ( lAsset->GetName() == aAssetName )
-                return lAsset;
-        return nullptr;
+        return mAssets3D.Find(aAssetName);
     }
 
 
     Model2D* ResourceManager::CreateModel2D(const string& aAssetName, float aWidth, float aHeight) const
     {
-        auto lAsset = FindAsset2D(aAssetName);
-        if ( !lAsset )
+        const uint32_t lIndex = mAssets2D.FindIndex(aAssetName);
+        if ( lIndex == ResourceRegistryBase::sInvalidIndex )
         {
             WARNING("Asset2D '%s' does not exist in the resource manager!", aAssetName.c_str());
             return nullptr;
         }
+        mAssets2D.MarkUsed(lIndex, mFrame);
+        std::shared_ptr<const Asset2D> lAsset = mAssets2D.Get(lIndex);
         if ( !lAsset->mRendererResources )
         {
             Asset2D* lAsset_ = const_cast<Asset2D*>(lAsset.get());
             Texture lTexture;
             ASSERT(!lAsset->GetResourceName().empty());
-            if ( !lTexture.Load(lAsset->GetResourceName()) )
+            if ( !TextureCooker::Load(lAsset->GetResourceName(), lTexture) )
             {
                 WARNING("Failed to load asset %s(%s)", lAsset->GetName().c_str(), lAsset->GetResourceName().c_str());
                 // create a stub texture instead of returning nullptr
@@ -272,15 +623,16 @@ namespace Framework
                 for ( size_t i = 0; i < lTexture.mPixels.size(); i += 3 )
                     lTexture.mPixels[i] = lTexture.mPixels[i + 2] = 0xff;
             }
-            Procedural::TexturedQuad lTexQuadAsset(aWidth, aHeight, std::move(lTexture));
-            const_cast<string&>(lTexQuadAsset.GetName()) = lAsset_->GetName(); // hack!
-            *lAsset_ = std::move(lTexQuadAsset);
+            MakeTexturedQuad(*lAsset_, std::move(lTexture), aWidth, aHeight);
+            mQuadSizes[lIndex] = glm::vec2(aWidth, aHeight);
             auto lRenderer = Engine::Instance()->Display().GetRenderer();
             if ( !lRenderer->PrepareForRendering(*lAsset_) )
             {
                 WARNING("Failed to prepare asset %s", lAsset->GetName().c_str());
                 return nullptr;
             }
+            mAssets2D.SetResident(lIndex, true, lAsset->GetCpuSize(), lAsset->GetGpuSize());
+            RecordAsset2D(lIndex);
         }
         return new Model2D(std::move(lAsset));
     }
@@ -288,25 +640,25 @@ namespace Framework
 
     std::shared_ptr<const Asset2D> ResourceManager::FindAsset2D(const string& aAssetName) const
     {
-        for (auto& lAsset : mAssets2D )
-            if ( lAsset->GetName() == aAssetName )
-                return lAsset;
-        return nullptr;
+        return mAssets2D.Find(aAssetName);
     }
 
 
     void ResourceManager::ClearAssets3D()
     {
-        mAssets3D.clear();
+        mStreamer.Cancel();
+        mAssets3D.Clear();
+        mProceduralMeshes.Clear();
     }
 
 
     void ResourceManager::ClearAssets2D()
     {
-        mAssets2D.clear();
+        mAssets2D.Clear();
+        mQuadSizes.clear();
     }
 
-    bool ResourceManager::AddImage(const Json::Value& aSerializer)
+    bool ResourceManager::AddImage(const JsonView& aSerializer)
     {
         if(!aSerializer.isMember("name"))
             CRASH("Image has no 'name' attribute!");
@@ -318,36 +670,54 @@ namespace Framework
             lResourceFileName = aSerializer["icon"].asString();
         if( lResourceFileName.empty() )
             CRASH("Image has no 'file' / 'icon' attribute or has both!");
-        if ( FindImage(lName) > 0 )
+        ImageRecord lNewRecord;
+        lNewRecord.mFile = lResourceFileName;
+        if ( !mImages.emplace(lName, std::move(lNewRecord)).second )
         {
             WARNING("Image '%s'(%s) already exists and cannot be added again!", lName.c_str(), lResourceFileName.c_str());
             return false;
         }
+        RecordImage(lName, lResourceFileName);
 
         /* note: here we do not check for adding the same image resource
-        with different names */
-        UIScreen& lUIScreen = Engine::Instance()->Display();
-        int lImageId = nvgCreateImage(lUIScreen.nvgContext(), lResourceFileName.c_str(), 0);
-        if (lImageId > 0)
-            mImages.emplace_back( std::move(lName), lImageId);
-        else
-            WARNING("Could not load image \"%s\"", lName.c_str());
+        with different names. The record has no id until the image is decoded */
+        ImageDecoder::Options lOptions;
+        lOptions.mChannels = 4;
+        lOptions.mFlipVertically = false;
+        mImageLoader.Request(lResourceFileName, lOptions, [this, lName](const std::string&, Texture& aImage, bool aLoaded)
+        {
+            auto lRecord = mImages.find(lName);
+            if ( lRecord == mImages.end() )
+                return; // cleared in the meantime
+            UIScreen& lUIScreen = Engine::Instance()->Display();
+            const int lImageId = aLoaded ? nvgCreateImageRGBA(lUIScreen.nvgContext(), aImage.mWidth, aImage.mHeight, 0, aImage.mPixels.data()) : 0;
+            if ( lImageId > 0 )
+            {
+                lRecord->second.mId = lImageId;
+                lRecord->second.mBytes = aImage.mPixels.size();
+            }
+            else
+            {
+                WARNING("Could not load image \"%s\"", lName.c_str());
+                mImages.erase(lRecord);
+            }
+        });
         return true;
     }
 
     int ResourceManager::FindImage(const string& aName)
     {
-        for ( auto& lImage : mImages )
-            if ( lImage.first == aName )
-                return lImage.second;
-        return -1;
+        auto lImage = mImages.find(aName);
+        return lImage != mImages.end() && lImage->second.mId > 0 ? lImage->second.mId : -1;
     }
 
     void ResourceManager::ClearImages()
     {
+        mImageLoader.Cancel();
         UIScreen& lUIScreen = Engine::Instance()->Display();
         for (auto& lImage : mImages)
-            nvgDeleteImage(lUIScreen.nvgContext(), lImage.second);
+            if ( lImage.second.mId > 0 )
+                nvgDeleteImage(lUIScreen.nvgContext(), lImage.second.mId);
         mImages.clear();
     }
 
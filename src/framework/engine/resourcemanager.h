@@ -7,7 +7,14 @@
 
 #pragma once
 #include "core/utils.h"
+#include "core/filewatcher.h"
 #include "core/serialization/jsoncpputils.h"
+#include "core/serialization/jsondocument.h"
+#include "engine/assetstreamer.h"
+#include "engine/dependencygraph.h"
+#include "engine/imageloader.h"
+#include "engine/resourceregistry.h"
+#include "graphic/procedural/meshcache.h"
 
 namespace Framework
 {
@@ -17,11 +24,48 @@ namespace Framework
     class Model2D;
     class Shader;
     class Project;
+    class Renderer;
 
+    /**
+     * The assets are registered in hashed registries, by name and interned resource
+     * path. A model holds the shared pointer of its asset, so an asset no model uses
+     * anymore can be unloaded: once per frame the least recently used of them are
+     * evicted until the loaded assets fit the memory budget. They load again the
+     * next time a model is created for them. Images and projects are never unloaded
+     *
+     * The resources record in a dependency graph what they are loaded from: the
+     * shader programs their stage files, the 3D assets their model file and their
+     * materials, the materials their texture, the 2D assets and the images their
+     * picture. With hot reload the files are watched, and a written file reloads
+     * its dependents only, keeping the objects the models and the renderer hold
+     */
     class ResourceManager final
     {
 
     public:
+        struct Stats
+        {
+            ResourceRegistryBase::Stats mAssets3D;
+            ResourceRegistryBase::Stats mAssets2D;
+            uint32_t                    mImages = 0;
+            uint64_t                    mImageBytes = 0;    /**< Video memory of the images, outside of the budget */
+            Procedural::MeshCache::Stats mProceduralMeshes;
+            MemoryBudget                mBudget;
+
+            uint64_t GetCpuBytes() const { return mAssets3D.mCpuBytes + mAssets2D.mCpuBytes; }
+            uint64_t GetGpuBytes() const { return mAssets3D.mGpuBytes + mAssets2D.mGpuBytes; }
+        };
+
+        struct HotReloadStats
+        {
+            uint32_t mChanges = 0;          /**< Changed files handled */
+            uint32_t mDependents = 0;       /**< Dependents of the changed files, directly or not */
+            uint32_t mReloaded = 0;         /**< Resources loaded again */
+            uint32_t mFailed = 0;           /**< Reloads that kept the previous version */
+            double   mLastLatency = 0.0;    /**< Milliseconds from the notification of the last change to its dependents reloaded */
+            double   mMaxLatency = 0.0;
+        };
+
                                  ResourceManager();
                                  ~ResourceManager();
 
@@ -33,22 +77,90 @@ namespace Framework
         void                     ClearShaders();
 
         // Assets/Models 3D
-        bool                     AddAsset3D(const Json::Value& aSerializer);
+        bool                     AddAsset3D(const JsonView& aSerializer);
         std::shared_ptr<const Asset3D> FindAsset3D(const std::string& aAssetName) const;
         void                     ClearAssets3D();
         Model3D*                 CreateModel3D(const std::string& aAssetName) const;
-        
+
+        /**
+         * Streamed counterparts of CreateModel3D. The asset is loaded by the worker
+         * threads of the streamer and uploaded by UpdateStreaming, the model is returned
+         * at once and shows a placeholder box until then
+         *
+         * @see AssetStreamer
+         */
+        std::shared_future<bool> LoadAsset3DAsync(const std::string& aAssetName, AssetStreamer::Callback aCallback = nullptr) const;
+        Model3D*                 CreateModel3DAsync(const std::string& aAssetName, AssetStreamer::Callback aCallback = nullptr) const;
+
+        /**
+         * Reloads the dependents of the changed files, then uploads the streamed
+         * assets within the budget of the frame and the images decoded since the
+         * last frame, on the main thread
+         *
+         * @return Number of streamed assets finished and of changed files reloaded in
+         *         this call, the models sync their assets when it is not 0
+         */
+        uint32_t                 UpdateStreaming(const Renderer& aRenderer);
+        AssetStreamer&           Streamer() { return mStreamer; }
+        AssetStreamer::Stats     GetStreamingStats() const { return mStreamer.GetStats(); }
+
+        /**
+         * Shared meshes of the procedural generators. The meshes no model holds are
+         * dropped by TrimMemory
+         */
+        Procedural::MeshCache&   ProceduralMeshes() const { return mProceduralMeshes; }
+
         // Assets/Models 2D
-        bool                     AddAsset2D(const Json::Value& aSerializer);
+        bool                     AddAsset2D(const JsonView& aSerializer);
         std::shared_ptr<const Asset2D> FindAsset2D(const std::string& aAssetName) const;
         void                     ClearAssets2D();
         Model2D*                 CreateModel2D(const std::string& aAssetName, float aWidth = 1.0f, float aHeight = 1.0f) const;
 
-        // Images
-        bool                     AddImage(const Json::Value& aSerializer);
+        /**
+         * Images are decoded by the worker threads of the image loader and created in
+         * NanoVG on the main thread. The images of the resource files are all available
+         * when Initialize returns, the ones added later once UpdateStreaming delivers them
+         */
+        bool                     AddImage(const JsonView& aSerializer);
+        ImageLoader::Stats       GetImageLoaderStats() const { return mImageLoader.GetStats(); }
         int                      FindImage(const string& aImageName);
         void                     ClearImages();
 
+        /**
+         * Memory the loaded assets may take, 0 is no limit. The assets still used by a
+         * model are never evicted, so the budget can be exceeded while they do not fit
+         */
+        void                     SetMemoryBudget(const MemoryBudget& aBudget) { mBudget = aBudget; }
+        const MemoryBudget&      GetMemoryBudget() const { return mBudget; }
+
+        /**
+         * Evicts the unused assets that do not fit the memory budget, called by
+         * UpdateStreaming once per frame
+         *
+         * @return Number of evicted assets
+         */
+        uint32_t                 TrimMemory();
+        Stats                    GetStats() const;
+        void                     ResetStats();
+
+        /**
+         * Watches the files of the loaded resources, the ones loaded later are watched
+         * as they load. Disabled, the dependencies are still recorded
+         */
+        void                     EnableHotReload(bool aEnable);
+        bool                     IsHotReloadEnabled() const { return mHotReload; }
+
+        /**
+         * Reloads the dependents of the files written since the last call, called by
+         * UpdateStreaming. The resources not loaded have nothing to reload, they read
+         * the new file on their next use
+         *
+         * @return Number of changed files
+         */
+        uint32_t                 UpdateHotReload(const Renderer& aRenderer);
+        const DependencyGraph&   GetDependencies() const { return mDependencies; }
+        const HotReloadStats&    GetHotReloadStats() const { return mHotReloadStats; }
+
         // Projects
         bool                        AddProject(const string& aProjectFile);
         std::shared_ptr<Project>    GetProjectByFile(const string& aProjectFile);
@@ -57,12 +169,41 @@ namespace Framework
 
     protected:
 
+        struct ImageRecord
+        {
+            int         mId = 0;       /**< NanoVG image, 0 until the image is decoded */
+            uint64_t    mBytes = 0;
+            std::string mFile;
+        };
+
+        /* Records the dependencies of a loaded resource, replacing the previous ones */
+        void                     RecordShader(const Shader& aShader);
+        void                     RecordAsset3D(uint32_t aIndex) const;
+        void                     RecordAsset2D(uint32_t aIndex) const;
+        void                     RecordImage(const std::string& aName, const std::string& aFile);
+        void                     AddFileDependency(uint32_t aNode, const std::string& aFile) const;
+
+        /* Reload of a dependent: 1 reloaded, 0 nothing loaded to reload, -1 failed */
+        int                      ReloadShader(const std::string& aName);
+        int                      ReloadAsset3D(const std::string& aName, const Renderer& aRenderer);
+        int                      ReloadAsset2D(const std::string& aName, const Renderer& aRenderer);
+        int                      ReloadImage(const std::string& aName);
+
         std::vector<Shader*>                    mShaders;
-        std::vector< std::shared_ptr<Asset3D> > mAssets3D;
-        std::vector< std::shared_ptr<Asset2D> > mAssets2D;
-        using ImageRecord = std::pair< std::string/*name*/, int/*id*/ >;
-        std::vector<ImageRecord>                mImages;
+        mutable ResourceRegistry<Asset3D>       mAssets3D;
+        mutable ResourceRegistry<Asset2D>       mAssets2D;
+        std::unordered_map<std::string, ImageRecord> mImages;
         std::vector< std::shared_ptr<Project> > mProjects;
+        mutable AssetStreamer                   mStreamer;
+        mutable Procedural::MeshCache           mProceduralMeshes;
+        ImageLoader                             mImageLoader;
+        MemoryBudget                            mBudget;
+        uint64_t                                mFrame = 0;     /**< Clock of the least recently used eviction */
+        mutable std::unordered_map<uint32_t, glm::vec2> mQuadSizes; /**< Size the loaded 2D assets were made with, by index */
+        mutable DependencyGraph                 mDependencies;
+        mutable FileWatcher                     mWatcher;
+        bool                                    mHotReload = false;
+        HotReloadStats                          mHotReloadStats;
     };
 }
 
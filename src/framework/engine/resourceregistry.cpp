@@ -0,0 +1,174 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Hashed registry of the assets of the resource manager
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include <deque>
+#include "engine/resourceregistry.h"
+
+namespace Framework
+{
+    namespace
+    {
+        /* The interned paths live for the whole run, the ids are indices. A deque
+           keeps the returned references valid while paths are added */
+        std::mutex                                sPathMutex;
+        std::unordered_map<std::string, uint32_t> sPathIds;
+        std::deque<std::string>                   sPaths;
+
+        std::string NormalizePath(const std::string& aPath)
+        {
+            std::string lPath = aPath;
+            std::replace(lPath.begin(), lPath.end(), '\\', '/');
+            return lPath;
+        }
+    }
+
+    const uint32_t ResourceRegistryBase::sInvalidIndex;
+
+    uint32_t ResourceRegistryBase::InternPath(const std::string& aPath)
+    {
+        std::string lPath = NormalizePath(aPath);
+        std::lock_guard<std::mutex> lLock(sPathMutex);
+        auto lFound = sPathIds.find(lPath);
+        if ( lFound != sPathIds.end() )
+            return lFound->second;
+        const uint32_t lId = static_cast<uint32_t>(sPaths.size());
+        sPaths.push_back(lPath);
+        sPathIds.emplace(std::move(lPath), lId);
+        return lId;
+    }
+
+    const std::string& ResourceRegistryBase::GetPath(uint32_t aPathId)
+    {
+        std::lock_guard<std::mutex> lLock(sPathMutex);
+        ASSERT(aPathId < sPaths.size());
+        return sPaths[aPathId];
+    }
+
+    uint32_t ResourceRegistryBase::FindIndex(const std::string& aName) const
+    {
+        auto lFound = mNameIndex.find(aName);
+        return lFound != mNameIndex.end() ? lFound->second : sInvalidIndex;
+    }
+
+    uint32_t ResourceRegistryBase::FindIndexByPath(const std::string& aPath) const
+    {
+        auto lFound = mPathIndex.find(InternPath(aPath));
+        return lFound != mPathIndex.end() ? lFound->second : sInvalidIndex;
+    }
+
+    bool ResourceRegistryBase::AddEntry(const std::string& aName, const std::string& aPath, bool aUniquePath)
+    {
+        const uint32_t lPath = InternPath(aPath);
+        if ( mNameIndex.count(aName) > 0 || (aUniquePath && mPathIndex.count(lPath) > 0) )
+            return false;
+
+        const uint32_t lIndex = static_cast<uint32_t>(mEntries.size());
+        Entry lEntry;
+        lEntry.mName = aName;
+        lEntry.mPath = lPath;
+        mEntries.push_back(std::move(lEntry));
+        mNameIndex.emplace(aName, lIndex);
+        mPathIndex.emplace(lPath, lIndex); // the first entry of a shared path keeps it
+        ++mStats.mCount;
+        return true;
+    }
+
+    void ResourceRegistryBase::ClearEntries()
+    {
+        mEntries.clear();
+        mNameIndex.clear();
+        mPathIndex.clear();
+        mStats.mCount = mStats.mResident = 0;
+        mStats.mCpuBytes = mStats.mGpuBytes = 0;
+    }
+
+    void ResourceRegistryBase::MarkUsed(uint32_t aIndex, uint64_t aFrame)
+    {
+        Entry& lEntry = mEntries[aIndex];
+        lEntry.mLastUse = aFrame;
+        if ( lEntry.mResident )
+            ++mStats.mHits;
+        else
+            ++mStats.mMisses;
+    }
+
+    void ResourceRegistryBase::SetResident(uint32_t aIndex, bool aResident, uint64_t aCpuBytes, uint64_t aGpuBytes)
+    {
+        Entry& lEntry = mEntries[aIndex];
+        if ( lEntry.mResident )
+        {
+            --mStats.mResident;
+            mStats.mCpuBytes -= lEntry.mCpuBytes;
+            mStats.mGpuBytes -= lEntry.mGpuBytes;
+        }
+        lEntry.mResident = aResident;
+        lEntry.mCpuBytes = aResident ? aCpuBytes : 0;
+        lEntry.mGpuBytes = aResident ? aGpuBytes : 0;
+        if ( lEntry.mResident )
+        {
+            ++mStats.mResident;
+            mStats.mCpuBytes += lEntry.mCpuBytes;
+            mStats.mGpuBytes += lEntry.mGpuBytes;
+        }
+    }
+
+    uint32_t ResourceRegistryBase::Trim(const MemoryBudget& aBudget, uint64_t aFrame, std::initializer_list<ResourceRegistryBase*> aRegistries)
+    {
+        uint64_t lCpuBytes = 0, lGpuBytes = 0;
+        for ( auto lRegistry : aRegistries )
+        {
+            for ( uint32_t i = 0; i < lRegistry->GetCount(); ++i )
+                if ( lRegistry->mEntries[i].mResident && lRegistry->GetReferences(i) > 0 )
+                    lRegistry->mEntries[i].mLastUse = aFrame;
+            lCpuBytes += lRegistry->mStats.mCpuBytes;
+            lGpuBytes += lRegistry->mStats.mGpuBytes;
+        }
+        if ( aBudget.Fits(lCpuBytes, lGpuBytes) )
+            return 0;
+
+        struct Candidate
+        {
+            uint64_t              mLastUse;
+            ResourceRegistryBase* mRegistry;
+            uint32_t              mIndex;
+        };
+        std::vector<Candidate> lCandidates;
+        for ( auto lRegistry : aRegistries )
+            for ( uint32_t i = 0; i < lRegistry->GetCount(); ++i )
+                if ( lRegistry->mEntries[i].mResident && lRegistry->GetReferences(i) == 0 )
+                    lCandidates.push_back({ lRegistry->mEntries[i].mLastUse, lRegistry, i });
+        std::stable_sort(lCandidates.begin(), lCandidates.end(),
+                         [](const Candidate& aLeft, const Candidate& aRight) { return aLeft.mLastUse < aRight.mLastUse; });
+
+        uint32_t lEvicted = 0;
+        for ( const auto& lCandidate : lCandidates )
+        {
+            if ( aBudget.Fits(lCpuBytes, lGpuBytes) )
+                break;
+            ResourceRegistryBase& lRegistry = *lCandidate.mRegistry;
+            const Entry& lEntry = lRegistry.mEntries[lCandidate.mIndex];
+            lCpuBytes -= lEntry.mCpuBytes;
+            lGpuBytes -= lEntry.mGpuBytes;
+            ++lRegistry.mStats.mEvictions;
+            lRegistry.mStats.mEvictedBytes += lEntry.mCpuBytes + lEntry.mGpuBytes;
+            lRegistry.SetResident(lCandidate.mIndex, false, 0, 0);
+            lRegistry.Release(lCandidate.mIndex);
+            ++lEvicted;
+        }
+        // Still over the budget when the referenced resources alone do not fit
+        return lEvicted;
+    }
+
+    void ResourceRegistryBase::ResetCounters()
+    {
+        mStats.mHits = mStats.mMisses = 0;
+        mStats.mEvictions = mStats.mEvictedBytes = 0;
+    }
+}
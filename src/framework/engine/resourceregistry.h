@@ -0,0 +1,187 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Hashed registry of the assets of the resource manager. The entries
+ *                are found by name or by resource path; the paths are interned, so
+ *                the path index is keyed by a 32 bit id. The shared pointers handed
+ *                out are the handles: an entry is referenced while anything else than
+ *                the registry holds its resource.
+ *
+ *                A resident entry (loaded and uploaded) that is not referenced can be
+ *                evicted: its resource is replaced by an empty one with the same name
+ *                and path, which loads again on the next use. Trim evicts the least
+ *                recently used of them, over all the given registries, until the
+ *                resident bytes fit the memory budget.
+ *******************************************************************************/
+
+#pragma once
+
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+namespace Framework
+{
+    /**
+     * Bytes the resident resources may take, 0 is no limit
+     */
+    struct MemoryBudget
+    {
+        uint64_t mCpuBytes = 0;
+        uint64_t mGpuBytes = 0;
+
+        bool Fits(uint64_t aCpuBytes, uint64_t aGpuBytes) const
+        {
+            return (mCpuBytes == 0 || aCpuBytes <= mCpuBytes) && (mGpuBytes == 0 || aGpuBytes <= mGpuBytes);
+        }
+    };
+
+    class ResourceRegistryBase
+    {
+    public:
+        static const uint32_t sInvalidIndex = 0xFFFFFFFF;
+
+        struct Stats
+        {
+            uint32_t mCount = 0;        /**< Entries */
+            uint32_t mResident = 0;     /**< Entries loaded */
+            uint64_t mCpuBytes = 0;     /**< Resident bytes in system memory */
+            uint64_t mGpuBytes = 0;     /**< Resident bytes in video memory */
+            uint64_t mHits = 0;         /**< Uses of resident entries */
+            uint64_t mMisses = 0;       /**< Uses that had to load the entry */
+            uint64_t mEvictions = 0;    /**< Entries unloaded to fit the budget */
+            uint64_t mEvictedBytes = 0; /**< System and video memory released by the evictions */
+        };
+
+        virtual ~ResourceRegistryBase() = default;
+
+        /**
+         * Interns a resource path. The separators are unified, so both spellings of
+         * a path give the same id
+         *
+         * @return Id of the path, the same for the whole run
+         */
+        static uint32_t           InternPath(const std::string& aPath);
+        static const std::string& GetPath(uint32_t aPathId);
+
+        /**
+         * @return Index of the entry, or sInvalidIndex
+         */
+        uint32_t FindIndex(const std::string& aName) const;
+        uint32_t FindIndexByPath(const std::string& aPath) const;
+
+        uint32_t           GetCount() const { return static_cast<uint32_t>(mEntries.size()); }
+        const std::string& GetName(uint32_t aIndex) const { return mEntries[aIndex].mName; }
+        const std::string& GetResourcePath(uint32_t aIndex) const { return GetPath(mEntries[aIndex].mPath); }
+        bool               IsResident(uint32_t aIndex) const { return mEntries[aIndex].mResident; }
+
+        /**
+         * Records a use of the entry, a hit if it is resident and a miss otherwise
+         */
+        void MarkUsed(uint32_t aIndex, uint64_t aFrame);
+
+        /**
+         * Records the memory of a loaded entry, or releases it when aResident is false
+         */
+        void SetResident(uint32_t aIndex, bool aResident, uint64_t aCpuBytes, uint64_t aGpuBytes);
+
+        /**
+         * Stamps the referenced entries with the frame, then evicts the unreferenced
+         * resident entries of all the registries, least recently used first, until
+         * the totals fit the budget. Only the main thread may call it: the released
+         * resources free their GPU objects
+         *
+         * @return Number of evicted entries
+         */
+        static uint32_t Trim(const MemoryBudget& aBudget, uint64_t aFrame, std::initializer_list<ResourceRegistryBase*> aRegistries);
+
+        const Stats& GetStats() const { return mStats; }
+        void         ResetCounters();
+
+    protected:
+        struct Entry
+        {
+            std::string mName;
+            uint32_t    mPath = 0;
+            uint64_t    mCpuBytes = 0;
+            uint64_t    mGpuBytes = 0;
+            uint64_t    mLastUse = 0;   /**< Frame of the last use or reference */
+            bool        mResident = false;
+        };
+
+        /**
+         * @return false if the name or the path is already registered
+         */
+        bool AddEntry(const std::string& aName, const std::string& aPath, bool aUniquePath);
+        void ClearEntries();
+
+        /**
+         * @return Number of holders of the resource besides the registry
+         */
+        virtual long GetReferences(uint32_t aIndex) const = 0;
+
+        /**
+         * Replaces the resource by an empty one, the entry is not resident anymore
+         */
+        virtual void Release(uint32_t aIndex) = 0;
+
+        std::vector<Entry>                        mEntries;
+        std::unordered_map<std::string, uint32_t> mNameIndex;
+        std::unordered_map<uint32_t, uint32_t>    mPathIndex;   /**< Interned path to entry */
+        Stats                                     mStats;
+    };
+
+    /**
+     * Registry of a resource type constructed from its name and resource path,
+     * like Asset3D and Asset2D
+     */
+    template <class T>
+    class ResourceRegistry final : public ResourceRegistryBase
+    {
+    public:
+        /**
+         * Registers a resource, not loaded yet
+         *
+         * @param aUniquePath  Refuse another entry with the same resource path
+         *
+         * @return false if the name (or the path) is already registered
+         */
+        bool Add(const std::string& aName, const std::string& aPath, bool aUniquePath)
+        {
+            if ( !AddEntry(aName, aPath, aUniquePath) )
+                return false;
+            mResources.push_back(std::make_shared<T>(aName, aPath));
+            return true;
+        }
+
+        const std::shared_ptr<T>& Get(uint32_t aIndex) const { return mResources[aIndex]; }
+
+        std::shared_ptr<T> Find(const std::string& aName) const
+        {
+            const uint32_t lIndex = FindIndex(aName);
+            return lIndex != sInvalidIndex ? mResources[lIndex] : nullptr;
+        }
+
+        void Clear()
+        {
+            mResources.clear();
+            ClearEntries();
+        }
+
+    protected:
+        long GetReferences(uint32_t aIndex) const override { return mResources[aIndex].use_count() - 1; }
+
+        void Release(uint32_t aIndex) override
+        {
+            mResources[aIndex] = std::make_shared<T>(mEntries[aIndex].mName, GetResourcePath(aIndex));
+        }
+
+        std::vector<std::shared_ptr<T>> mResources;
+    };
+}
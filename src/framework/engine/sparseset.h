@@ -0,0 +1,142 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Sparse set keyed by entity id. The values are kept in a
+ *                contiguous dense array, the sparse side maps the key to the
+ *                dense index through fixed size pages, so the memory follows
+ *                the used id ranges and not the biggest id.
+ *******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <stdint.h>
+
+namespace Framework
+{
+    template< class ValueT >
+    class SparseSet
+    {
+    public:
+        typedef typename std::vector<ValueT>::iterator       iterator;
+        typedef typename std::vector<ValueT>::const_iterator const_iterator;
+
+        static const uint32_t sInvalidIndex = UINT32_MAX;
+
+        SparseSet() { }
+
+        // Return true if the key has a value in the set
+        bool Contains(size_t aKey) const
+        {
+            return DenseIndex(aKey) != sInvalidIndex;
+        }
+
+        // Insert or replace the value of the key
+        ValueT& Insert(size_t aKey, const ValueT& aValue)
+        {
+            uint32_t& lSlot = Slot(aKey);
+            if (lSlot != sInvalidIndex)
+            {
+                mDense[lSlot] = aValue;
+                return mDense[lSlot];
+            }
+
+            lSlot = static_cast<uint32_t>(mDense.size());
+            mDense.push_back(aValue);
+            mKeys.push_back(aKey);
+            return mDense.back();
+        }
+
+        // Remove the value of the key moving the last element to its place
+        bool Remove(size_t aKey)
+        {
+            uint32_t lIndex = DenseIndex(aKey);
+            if (lIndex == sInvalidIndex)
+                return false;
+
+            uint32_t lLast = static_cast<uint32_t>(mDense.size() - 1);
+            if (lIndex != lLast)
+            {
+                mDense[lIndex] = std::move(mDense[lLast]);
+                mKeys[lIndex] = mKeys[lLast];
+                Slot(mKeys[lIndex]) = lIndex;
+            }
+            mDense.pop_back();
+            mKeys.pop_back();
+            Slot(aKey) = sInvalidIndex;
+            return true;
+        }
+
+        // Return with the value of the key, or nullptr if it is not in the set
+        ValueT* Find(size_t aKey)
+        {
+            uint32_t lIndex = DenseIndex(aKey);
+            return lIndex == sInvalidIndex ? nullptr : &mDense[lIndex];
+        }
+
+        const ValueT* Find(size_t aKey) const
+        {
+            uint32_t lIndex = DenseIndex(aKey);
+            return lIndex == sInvalidIndex ? nullptr : &mDense[lIndex];
+        }
+
+        void Reserve(size_t aSize)
+        {
+            mDense.reserve(aSize);
+            mKeys.reserve(aSize);
+        }
+
+        void Clear()
+        {
+            mDense.clear();
+            mKeys.clear();
+            mPages.clear();
+        }
+
+        size_t         Size() const           { return mDense.size(); }
+        bool           Empty() const          { return mDense.empty(); }
+        size_t         KeyAt(size_t i) const  { return mKeys[i]; }
+        ValueT&        operator[](size_t i)   { return mDense[i]; }
+        const ValueT&  operator[](size_t i) const { return mDense[i]; }
+
+        iterator       begin()       { return mDense.begin(); }
+        iterator       end()         { return mDense.end(); }
+        const_iterator begin() const { return mDense.begin(); }
+        const_iterator end() const   { return mDense.end(); }
+
+    private:
+        static const size_t sPageBits = 10;
+        static const size_t sPageSize = size_t(1) << sPageBits;
+
+        uint32_t DenseIndex(size_t aKey) const
+        {
+            size_t lPage = aKey >> sPageBits;
+            if (lPage >= mPages.size() || !mPages[lPage])
+                return sInvalidIndex;
+            return mPages[lPage][aKey & (sPageSize - 1)];
+        }
+
+        // Return with the sparse slot of the key, allocating its page if it is needed
+        uint32_t& Slot(size_t aKey)
+        {
+            size_t lPage = aKey >> sPageBits;
+            if (lPage >= mPages.size())
+                mPages.resize(lPage + 1);
+            if (!mPages[lPage])
+            {
+                mPages[lPage].reset(new uint32_t[sPageSize]);
+                std::fill(mPages[lPage].get(), mPages[lPage].get() + sPageSize, uint32_t(sInvalidIndex));
+            }
+            return mPages[lPage][aKey & (sPageSize - 1)];
+        }
+
+        std::vector<ValueT>                      mDense;  // Contiguous values
+        std::vector<size_t>                      mKeys;   // Key of each dense value
+        std::vector<std::unique_ptr<uint32_t[]>> mPages;  // Key -> dense index
+    };
+}
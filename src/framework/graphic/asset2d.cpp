@@ -12,10 +12,21 @@
 namespace Framework
 {
 
+    uint64_t Asset2D::GetCpuSize() const
+    {
+        uint64_t lBytes = uint64_t(mVertexData.capacity()) * sizeof(VertexData);
+        for ( const auto& lTexture : mTextures )
+            lBytes += sizeof(Texture) + lTexture.mPixels.capacity();
+        return lBytes;
+    }
+
     void Asset2D::RenderReady()
     {
         if( mVertexData.empty() )
             return;
+        mGpuSize = uint64_t(mVertexData.size()) * sizeof(VertexData);
+        for ( const auto& lTexture : mTextures )
+            mGpuSize += lTexture.mPixels.size();
         //glm::vec2& lMin = const_cast<glm::vec2&>(mBoundingBox.GetMin());
         //glm::vec2& lMax = const_cast<glm::vec2&>(mBoundingBox.GetMax());
         mMaxLengthVertex = glm::vec2(0,0);
@@ -43,8 +54,8 @@ namespace Framework
             //    lMax.z = lElement.mVertex.z;
         }
         mResourceName.clear();
-        mVertexData.clear();
-        mTextures.clear();
+        std::vector<VertexData>().swap(mVertexData);
+        std::vector<Texture>().swap(mTextures);
     }
 
 }
@@ -104,6 +104,16 @@ namespace Framework
         inline const std::vector<Texture>&     GetTextures() const   { return mTextures; }
 
         inline const glm::vec2&                GetMaxLengthVertex() const { return mMaxLengthVertex; }
+
+        /**
+         * @return Bytes of video memory the asset took when it was made ready for rendering
+         */
+        inline uint64_t                        GetGpuSize() const { return mGpuSize; }
+
+        /**
+         * @return Bytes of system memory held by the data not released yet
+         */
+        uint64_t                               GetCpuSize() const;
                 
         std::unique_ptr<RendererResources> mRendererResources;
 
@@ -120,6 +130,7 @@ namespace Framework
         std::vector<Texture>     mTextures;      /*< List of textures used in the model. The first texture is a shape texture. */
 
         glm::vec2                mMaxLengthVertex;
+        uint64_t                 mGpuSize = 0;   /*< Upload size, recorded by RenderReady */
     };
 
 }
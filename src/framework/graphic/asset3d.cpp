@@ -8,6 +8,8 @@
 #include "precompiled.h"
 #include "graphic/asset3d.h"
 #include "core/graphic/zcompression.h"
+#include "core/graphic/modelfile.h"
+#include <glm/gtc/packing.hpp>
 
 namespace Framework
 {
@@ -78,88 +80,224 @@ namespace Framework
         return lStr;
     }
 
-    bool Asset3D::Save(const string &aName)
+    bool Asset3D::Save(const string &aName, ModelFile::Compression aGeometryCompression, ModelFile::Compression aTextureCompression)
     {
-        ofstream lFile(aName, ios::binary | ios::out | ios::trunc);
-        ZCompression lComp;
+        UpdateBounds();
+        ModelFile::Header lHeader;
+        memcpy(lHeader.mBoundsMin, &mBoundingBox.GetMin(), sizeof lHeader.mBoundsMin);
+        memcpy(lHeader.mBoundsMax, &mBoundingBox.GetMax(), sizeof lHeader.mBoundsMax);
+        memcpy(lHeader.mMaxLengthVertex, &mMaxLengthVertex, sizeof lHeader.mMaxLengthVertex);
+        lHeader.mVertexCount = (uint32_t)mVertexData.size();
+        lHeader.mIndexCount = (uint32_t)mVertexIndices.size();
+        lHeader.mRenderListCount = (uint32_t)mIndicesOffsets.size();
+        lHeader.mFlags = static_cast<uint16_t>(mVertexFormat) & ModelFile::eFLAG_VERTEX_FORMAT_MASK;
+
+        ModelFileWriter lWriter;
+        lWriter.AddChunk(ModelFile::eCHUNK_VERTICES, mVertexData.data(), mVertexData.size() * sizeof(VertexData),
+                         (uint32_t)mVertexData.size(), aGeometryCompression);
+        lWriter.AddChunk(ModelFile::eCHUNK_INDICES, mVertexIndices.data(), mVertexIndices.size() * sizeof(uint32_t),
+                         (uint32_t)mVertexIndices.size(), aGeometryCompression);
+        lWriter.AddChunk(ModelFile::eCHUNK_LIST_OFFSETS, mIndicesOffsets.data(), mIndicesOffsets.size() * sizeof(uint32_t),
+                         (uint32_t)mIndicesOffsets.size());
+        lWriter.AddChunk(ModelFile::eCHUNK_LIST_COUNTS, mIndicesCount.data(), mIndicesCount.size() * sizeof(uint32_t),
+                         (uint32_t)mIndicesCount.size());
+        lWriter.AddChunk(ModelFile::eCHUNK_MATERIALS, mMaterials.data(), mMaterials.size() * sizeof(Material),
+                         (uint32_t)mMaterials.size());
+        if ( !mLods.empty() )
+        {
+            std::vector<uint32_t> lLodData;
+            for ( const auto& lLod : mLods )
+            {
+                uint32_t lError;
+                memcpy(&lError, &lLod.mError, sizeof lError);
+                lLodData.push_back(lError);
+                lLodData.insert(lLodData.end(), lLod.mIndicesOffsets.begin(), lLod.mIndicesOffsets.end());
+                lLodData.insert(lLodData.end(), lLod.mIndicesCount.begin(), lLod.mIndicesCount.end());
+            }
+            lWriter.AddChunk(ModelFile::eCHUNK_LODS, lLodData.data(), lLodData.size() * sizeof(uint32_t), (uint32_t)mLods.size());
+        }
 
-        if (lFile.is_open() == false)
+        /* Every texture is its header followed by its pixels. The textures go to the
+           cooked chunk as soon as one of them is cooked, so older readers still find
+           the textures they can upload */
+        const bool lCooked = std::any_of(mTextures.begin(), mTextures.end(), [](const Texture& aTexture) { return aTexture.IsCooked(); });
+        std::vector<uint8_t> lTextureData;
+        for ( const auto& lTexture : mTextures )
         {
-            CRASH("ERROR opening file %s\n", aName.c_str());
-            return false;
+            const ModelFile::TextureHeader lTextureHeader = { lTexture.mWidth, lTexture.mHeight, lTexture.mBytesPerPixel,
+                                                              lTexture.mFormat, lTexture.mType };
+            const ModelFile::CookedTextureHeader lCookedHeader = { lTexture.mWidth, lTexture.mHeight, lTexture.mBytesPerPixel,
+                                                                   lTexture.mFormat, lTexture.mType,
+                                                                   static_cast<uint32_t>(lTexture.mCompression), lTexture.mMipLevels,
+                                                                   0, lTexture.mPixels.size() };
+            const uint8_t* lBytes = lCooked ? reinterpret_cast<const uint8_t*>(&lCookedHeader) : reinterpret_cast<const uint8_t*>(&lTextureHeader);
+            lTextureData.insert(lTextureData.end(), lBytes, lBytes + (lCooked ? sizeof lCookedHeader : sizeof lTextureHeader));
+            lTextureData.insert(lTextureData.end(), lTexture.mPixels.begin(), lTexture.mPixels.end());
         }
+        lWriter.AddChunk(lCooked ? ModelFile::eCHUNK_COOKED_TEXTURES : ModelFile::eCHUNK_TEXTURES, lTextureData.data(),
+                         lTextureData.size(), (uint32_t)mTextures.size(), aTextureCompression);
 
-        if (lComp.Init() == false)
+        if ( !lWriter.Write(aName, lHeader) )
         {
-            CRASH("ERROR initializing compression in Asset3DStorage::Save\n");
-            lFile.close();
+            CRASH("ERROR writing data to file %s\n", aName.c_str());
             return false;
         }
+        return true;
+    }
 
-        /* Write vertex data size */
-        uint32_t lDataSize = (uint32_t)mVertexData.size();
-        lComp.Write(lFile, (const char *)&lDataSize, sizeof lDataSize);
-
-        /* Write vertex data */
-        lComp.Write(lFile, (const char *)&mVertexData[0], lDataSize * sizeof mVertexData[0]);
-
-        /* Write material data size */
-        lDataSize = (uint32_t)mMaterials.size();
-        lComp.Write(lFile, (const char *)&lDataSize, sizeof lDataSize);
-       
-        /* Write materials */
-        lComp.Write(lFile, (const char *)&mMaterials[0], lDataSize * sizeof mMaterials[0]);
-
-        /* Write texture data size */
-        lDataSize = (uint32_t)mTextures.size();
-        lComp.Write(lFile, (const char *)&lDataSize, sizeof lDataSize);
+    bool Asset3D::Load(const string &aName)
+    {
+        if ( ModelFile::IsModelFile(aName) )
+            return LoadModelFile(aName);
+        return LoadZStream(aName);
+    }
 
-        /* Write texture data */
-        for (const auto& lTexture : mTextures)
+    bool Asset3D::LoadBounds(const string &aName, BoundingBox &aBox)
+    {
+        ModelFile::Header lHeader;
+        if ( ModelFile::ReadHeader(aName, lHeader) )
         {
-            lComp.Write(lFile, &lTexture.mWidth, sizeof lTexture.mWidth);
-            lComp.Write(lFile, &lTexture.mHeight, sizeof lTexture.mHeight);
-            lComp.Write(lFile, &lTexture.mBytesPerPixel, sizeof lTexture.mBytesPerPixel);
-            lComp.Write(lFile, lTexture.mPixels.data(), lTexture.mWidth * lTexture.mHeight * lTexture.mBytesPerPixel);
+            aBox = BoundingBox(glm::vec3(lHeader.mBoundsMin[0], lHeader.mBoundsMin[1], lHeader.mBoundsMin[2]),
+                               glm::vec3(lHeader.mBoundsMax[0], lHeader.mBoundsMax[1], lHeader.mBoundsMax[2]));
+            return true;
         }
 
-        /* Write indices data size */
-        lDataSize = (uint32_t)mVertexIndices.size();
-        lComp.Write(lFile, (const char *)&lDataSize, sizeof lDataSize);
-
-        /* Write indices data */
-        lComp.Write(lFile, (const char *)&mVertexIndices[0], lDataSize * sizeof mVertexIndices[0]);
-
-        /* Write indices offsets data size */
-        lDataSize = (uint32_t)mIndicesOffsets.size();
-        lComp.Write(lFile, (const char *)&lDataSize, sizeof lDataSize);
-
-        /* Write indices offsets data */
-        lComp.Write(lFile, (const char *)&mIndicesOffsets[0], lDataSize * sizeof mIndicesOffsets[0]);
-
-        /* Write indices count data size */
-        lDataSize = (uint32_t)mIndicesCount.size();
-        lComp.Write(lFile, (const char *)&lDataSize, sizeof lDataSize);
+        /* An older file, the bounds are not stored */
+        Asset3D lAsset("", aName);
+        if ( !lAsset.LoadZStream(aName) )
+            return false;
+        lAsset.UpdateBounds();
+        aBox = lAsset.mBoundingBox;
+        return true;
+    }
 
-        /* Write indices count data */
-        lComp.Write(lFile, (const char *)&mIndicesCount[0], lDataSize * sizeof mIndicesCount[0], true);
+    bool Asset3D::LoadModelFile(const string &aName)
+    {
+        ModelFile lFile;
+        if ( !lFile.Open(aName) )
+        {
+            CRASH("ERROR opening file %s\n", aName.c_str());
+            return false;
+        }
 
-        lComp.Finish();
+        const ModelFile::Header& lHeader = lFile.GetHeader();
+        mBoundingBox = BoundingBox(glm::vec3(lHeader.mBoundsMin[0], lHeader.mBoundsMin[1], lHeader.mBoundsMin[2]),
+                                   glm::vec3(lHeader.mBoundsMax[0], lHeader.mBoundsMax[1], lHeader.mBoundsMax[2]));
+        mMaxLengthVertex = glm::vec3(lHeader.mMaxLengthVertex[0], lHeader.mMaxLengthVertex[1], lHeader.mMaxLengthVertex[2]);
+        const uint16_t lVertexFormat = lHeader.mFlags & ModelFile::eFLAG_VERTEX_FORMAT_MASK;
+        mVertexFormat = lVertexFormat <= static_cast<uint16_t>(VertexFormat::eHALF) ? static_cast<VertexFormat>(lVertexFormat) : VertexFormat::eFLOAT;
 
-        if (lFile.bad() == true)
+        /* The uncompressed chunks are a single copy out of the mapped file */
+        auto lReadArray = [&lFile](uint32_t aType, auto& aArray) -> bool
         {
-            CRASH("ERROR writing data to lFile %s\n", aName.c_str());
-            lFile.close();
+            const ModelFile::Chunk* lChunk = lFile.FindChunk(aType);
+            if ( !lChunk )
+            {
+                aArray.clear();
+                return true;
+            }
+            if ( lChunk->mRawSize != uint64_t(lChunk->mCount) * sizeof(aArray[0]) )
+                return false;
+            aArray.resize(lChunk->mCount);
+            return lChunk->mCount == 0 || lFile.ReadChunk(*lChunk, aArray.data());
+        };
+        if ( !lReadArray(ModelFile::eCHUNK_VERTICES, mVertexData) ||
+             !lReadArray(ModelFile::eCHUNK_INDICES, mVertexIndices) ||
+             !lReadArray(ModelFile::eCHUNK_LIST_OFFSETS, mIndicesOffsets) ||
+             !lReadArray(ModelFile::eCHUNK_LIST_COUNTS, mIndicesCount) ||
+             !lReadArray(ModelFile::eCHUNK_MATERIALS, mMaterials) )
+        {
+            CRASH("ERROR reading data from file %s\n", aName.c_str());
             return false;
         }
 
-        /* Close the lFile */
-        lFile.close();
+        mLods.clear();
+        if ( const ModelFile::Chunk* lChunk = lFile.FindChunk(ModelFile::eCHUNK_LODS) )
+        {
+            const size_t lListCount = mIndicesOffsets.size();
+            std::vector<uint32_t> lLodData(lChunk->mRawSize / sizeof(uint32_t));
+            if ( lLodData.size() != lChunk->mCount * (1 + 2 * lListCount) || !lFile.ReadChunk(*lChunk, lLodData.data()) )
+            {
+                CRASH("ERROR reading the levels of detail from file %s\n", aName.c_str());
+                return false;
+            }
+            mLods.resize(lChunk->mCount);
+            const uint32_t* lData = lLodData.data();
+            for ( auto& lLod : mLods )
+            {
+                memcpy(&lLod.mError, lData++, sizeof lLod.mError);
+                lLod.mIndicesOffsets.assign(lData, lData + lListCount);
+                lData += lListCount;
+                lLod.mIndicesCount.assign(lData, lData + lListCount);
+                lData += lListCount;
+            }
+        }
+
+        mTextures.clear();
+        const ModelFile::Chunk* lChunk = lFile.FindChunk(ModelFile::eCHUNK_COOKED_TEXTURES);
+        const bool lCooked = lChunk != nullptr;
+        if ( !lCooked )
+            lChunk = lFile.FindChunk(ModelFile::eCHUNK_TEXTURES);
+        if ( lChunk )
+        {
+            std::vector<uint8_t> lInflated;
+            const uint8_t* lData = lFile.GetChunkData(*lChunk);
+            if ( lChunk->mCompression != static_cast<uint16_t>(ModelFile::Compression::eNONE) )
+            {
+                lInflated.resize(lChunk->mRawSize);
+                if ( !lFile.ReadChunk(*lChunk, lInflated.data()) )
+                {
+                    CRASH("ERROR reading textures from file %s\n", aName.c_str());
+                    return false;
+                }
+                lData = lInflated.data();
+            }
 
+            bool lPrintTexSizeWarn = false;
+            const uint8_t* lEnd = lData + lChunk->mRawSize;
+            mTextures.resize(lChunk->mCount);
+            for ( auto& lTexture : mTextures )
+            {
+                ModelFile::CookedTextureHeader lTextureHeader = {};
+                const size_t lHeaderSize = lCooked ? sizeof(ModelFile::CookedTextureHeader) : sizeof(ModelFile::TextureHeader);
+                if ( lData + lHeaderSize > lEnd )
+                {
+                    CRASH("ERROR reading textures from file %s\n", aName.c_str());
+                    return false;
+                }
+                memcpy(&lTextureHeader, lData, lHeaderSize);
+                lData += lHeaderSize;
+                lTexture.mWidth = lTextureHeader.mWidth;
+                lTexture.mHeight = lTextureHeader.mHeight;
+                lTexture.mBytesPerPixel = lTextureHeader.mBytesPerPixel;
+                lTexture.mFormat = lTextureHeader.mFormat;
+                lTexture.mType = lTextureHeader.mType;
+                size_t lSize = size_t(lTexture.mWidth) * lTexture.mHeight * lTexture.mBytesPerPixel;
+                if ( lCooked )
+                {
+                    lTexture.mCompression = static_cast<Texture::Compression>(lTextureHeader.mCompression);
+                    lTexture.mMipLevels = std::max(lTextureHeader.mMipLevels, 1u);
+                    if ( lTexture.IsCooked() )
+                        lSize = lTexture.GetLevelOffset(lTexture.mMipLevels);
+                }
+                if ( (lCooked && (lSize != lTextureHeader.mDataSize || lTexture.mCompression > Texture::Compression::eBC7)) ||
+                     lData + lSize > lEnd )
+                {
+                    CRASH("ERROR reading textures from file %s\n", aName.c_str());
+                    return false;
+                }
+                lTexture.mPixels.assign(lData, lData + lSize);
+                lData += lSize;
+                if ( lTexture.mWidth > 1024 || lTexture.mHeight > 1024 )
+                    lPrintTexSizeWarn = true;
+            }
+            if ( lPrintTexSizeWarn )
+                INFO(LogLevel::eLEVEL2, "Warning: A texture for model '%s' has size(s) > 1024", aName.c_str());
+        }
         return true;
     }
 
-    bool Asset3D::Load(const string &aName)
+    bool Asset3D::LoadZStream(const string &aName)
     {
         uint32_t lDataSize;
         ifstream lFile(aName, ios::binary | ios::in);
@@ -251,13 +389,10 @@ namespace Framework
     }
 
 
-    void Asset3D::RenderReady()
+    void Asset3D::UpdateBounds()
     {
-        if( mVertexData.empty() )
-            return;
-        glm::vec3& lMin = const_cast<glm::vec3&>(mBoundingBox.GetMin());
-        glm::vec3& lMax = const_cast<glm::vec3&>(mBoundingBox.GetMax());
-        lMin = lMax = mMaxLengthVertex = glm::vec3(0,0,0);
+        glm::vec3 lMin(0, 0, 0), lMax(0, 0, 0);
+        mMaxLengthVertex = glm::vec3(0, 0, 0);
         float maxLength = 0.0f;
         for ( const auto& lElement : mVertexData )
         {
@@ -281,10 +416,129 @@ namespace Framework
             else if ( lElement.mVertex.z > lMax.z )
                 lMax.z = lElement.mVertex.z;
         }
+        mBoundingBox = BoundingBox(lMin, lMax);
+    }
+
+
+    uint32_t Asset3D::GetVertexStride(VertexFormat aFormat)
+    {
+        switch ( aFormat )
+        {
+            case VertexFormat::eCOMPACT: return 20;
+            case VertexFormat::eHALF:    return 16;
+            default:                     return sizeof(VertexData);
+        }
+    }
+
+
+    const void* Asset3D::PackVertexData(std::vector<uint8_t>& aStorage) const
+    {
+        if ( mVertexFormat == VertexFormat::eFLOAT )
+            return mVertexData.data();
+
+        const uint32_t lStride = GetVertexStride(mVertexFormat);
+        aStorage.resize(mVertexData.size() * lStride);
+        uint8_t* lData = aStorage.data();
+        for ( const auto& lElement : mVertexData )
+        {
+            uint32_t lOffset = 0;
+            if ( mVertexFormat == VertexFormat::eHALF )
+            {
+                /* The fourth half pads the position to 8 bytes */
+                const glm::uint64 lPosition = glm::packHalf4x16(glm::vec4(lElement.mVertex, 1.0f));
+                memcpy(lData, &lPosition, sizeof lPosition);
+                lOffset = sizeof lPosition;
+            }
+            else
+            {
+                memcpy(lData, &lElement.mVertex, sizeof lElement.mVertex);
+                lOffset = sizeof lElement.mVertex;
+            }
+            const glm::uint32 lNormal = glm::packSnorm3x10_1x2(glm::vec4(lElement.mNormal, 0.0f));
+            memcpy(lData + lOffset, &lNormal, sizeof lNormal);
+            const glm::uint16 lUV[2] = { glm::packHalf1x16(lElement.mUVCoord.x), glm::packHalf1x16(lElement.mUVCoord.y) };
+            memcpy(lData + lOffset + sizeof lNormal, lUV, sizeof lUV);
+            lData += lStride;
+        }
+        return aStorage.data();
+    }
+
+
+    const void* Asset3D::PackIndexData(std::vector<uint16_t>& aStorage) const
+    {
+        if ( GetIndexSize() == sizeof(uint32_t) )
+            return mVertexIndices.data();
+
+        aStorage.assign(mVertexIndices.begin(), mVertexIndices.end());
+        return aStorage.data();
+    }
+
+
+    uint64_t Asset3D::GetUploadSize() const
+    {
+        uint64_t lBytes = uint64_t(mVertexData.size()) * GetVertexStride(mVertexFormat) +
+                          uint64_t(mVertexIndices.size()) * GetIndexSize();
+        for ( const auto& lTexture : mTextures )
+            lBytes += lTexture.mPixels.size();
+        return lBytes;
+    }
+
+
+    uint64_t Asset3D::GetCpuSize() const
+    {
+        uint64_t lBytes = uint64_t(mVertexData.capacity()) * sizeof(VertexData) +
+                          uint64_t(mVertexIndices.capacity() + mIndicesOffsets.capacity() + mIndicesCount.capacity()) * sizeof(uint32_t) +
+                          uint64_t(mMaterials.capacity()) * sizeof(Material) +
+                          mTriangleHierarchy.GetMemorySize();
+        for ( const auto& lTexture : mTextures )
+            lBytes += sizeof(Texture) + lTexture.mPixels.capacity();
+        for ( const auto& lLod : mLods )
+            lBytes += sizeof(LevelOfDetail) + uint64_t(lLod.mIndicesOffsets.capacity() + lLod.mIndicesCount.capacity()) * sizeof(uint32_t);
+        return lBytes;
+    }
+
+
+    void Asset3D::RenderReady()
+    {
+        if( mVertexData.empty() )
+            return;
+        mGpuSize = GetUploadSize();
+        UpdateBounds();
+        ++mRevision;
+
+        std::vector<glm::vec3> lPositions;
+        lPositions.reserve(mVertexData.size());
+        for ( const auto& lElement : mVertexData )
+            lPositions.push_back(lElement.mVertex);
+        if ( mLods.empty() )
+            mTriangleHierarchy.Build(std::move(lPositions), mVertexIndices);
+        else
+        {
+            /* Only the full resolution triangles are picked */
+            std::vector<uint32_t> lIndices;
+            for ( size_t i = 0; i < mIndicesOffsets.size(); ++i )
+                lIndices.insert(lIndices.end(), mVertexIndices.begin() + mIndicesOffsets[i],
+                                mVertexIndices.begin() + mIndicesOffsets[i] + mIndicesCount[i]);
+            mTriangleHierarchy.Build(std::move(lPositions), std::move(lIndices));
+        }
+
         mResourceName.clear();
-        mVertexData.clear();
-        mVertexIndices.clear();
-        mTextures.clear();
+        std::vector<VertexData>().swap(mVertexData);
+        std::vector<uint32_t>().swap(mVertexIndices);
+        std::vector<Texture>().swap(mTextures);
     }
 
+
+    void Asset3D::TakeData(Asset3D& aLoaded)
+    {
+        mVertexData = std::move(aLoaded.mVertexData);
+        mVertexIndices = std::move(aLoaded.mVertexIndices);
+        mIndicesOffsets = std::move(aLoaded.mIndicesOffsets);
+        mIndicesCount = std::move(aLoaded.mIndicesCount);
+        mTextures = std::move(aLoaded.mTextures);
+        mMaterials = std::move(aLoaded.mMaterials);
+        mVertexFormat = aLoaded.mVertexFormat;
+        mLods = std::move(aLoaded.mLods);
+        ++mRevision;
+    }
 }
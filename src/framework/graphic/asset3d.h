@@ -45,6 +45,8 @@
 #include "graphic/material.h"
 #include "graphic/texture.h"
 #include "boundingbox.h"
+#include "graphic/trianglehierarchy.h"
+#include "core/graphic/modelfile.h"
 
 
 namespace Framework
@@ -70,6 +72,11 @@ namespace Framework
         /* not good, maybe it worth just defining these as member funcs here? */
         friend class Asset3DLoaders;
         friend class AssetTransform;
+        friend class AssetStreamer;
+        friend class ObjImporter;
+        friend class MeshOptimizer;
+        friend class MeshSimplifier;
+        friend class TextureCooker;
         friend void Procedural::AppendBentPlane(Asset3D &aAsset, float aWidth, float aHeight, float aAngleWidth, float aAngleHeight, float aAngleRadius,
                                                 uint32_t aNumVertsWidth, uint32_t aNumVertsHeight);
 
@@ -87,6 +94,28 @@ namespace Framework
         };
 #pragma pack(pop)
 
+        /**
+         * Layout of the vertices in the GPU buffer. The CPU copy is always VertexData,
+         * the smaller layouts are packed when the asset is uploaded
+         */
+        enum class VertexFormat : uint8_t
+        {
+            eFLOAT   = 0,   /**< 32 bytes, the VertexData layout */
+            eCOMPACT = 1,   /**< 20 bytes, float position, snorm 10:10:10 normal and half UV */
+            eHALF    = 2    /**< 16 bytes, half position, snorm 10:10:10 normal and half UV */
+        };
+
+
+        /**
+         * Simplified version of the rendering lists. Its indices follow the ones of the
+         * full resolution lists in the index data, and use the same vertices
+         */
+        struct LevelOfDetail
+        {
+            float                 mError = 0.0f;     /**< Geometric error relative to the length of GetMaxLengthVertex() */
+            std::vector<uint32_t> mIndicesOffsets;   /**< One per rendering list, like GetIndicesOffsets() */
+            std::vector<uint32_t> mIndicesCount;     /**< One per rendering list, 0 when the list vanished */
+        };
 
         Asset3D(const std::string& aName,
                 const std::string& aResourceName)
@@ -132,41 +161,143 @@ namespace Framework
         inline const std::vector<Texture>&     GetTextures() const       { return mTextures; }
         inline const std::vector<Material>&    GetMaterials() const      { return mMaterials; }
 
+        /**
+         * Levels of detail, level 0 is the full resolution and every next level is
+         * coarser. The rendering lists of a level match the materials and textures
+         */
+        inline uint32_t                        GetLodCount() const { return static_cast<uint32_t>(mLods.size()) + 1; }
+        inline float                           GetLodError(uint32_t aLod) const { return aLod == 0 ? 0.0f : mLods[aLod - 1].mError; }
+        inline const std::vector<uint32_t>&    GetIndicesOffsets(uint32_t aLod) const { return aLod == 0 ? mIndicesOffsets : mLods[aLod - 1].mIndicesOffsets; }
+        inline const std::vector<uint32_t>&    GetIndicesCount(uint32_t aLod) const   { return aLod == 0 ? mIndicesCount : mLods[aLod - 1].mIndicesCount; }
+        inline uint32_t                        GetTriangleCount(uint32_t aLod) const
+        {
+            uint32_t lIndices = 0;
+            for ( uint32_t lCount : GetIndicesCount(aLod) )
+                lIndices += lCount;
+            return lIndices / 3;
+        }
+
         inline const BoundingBox&              GetBoundingBox() const { return mBoundingBox; }
         inline const glm::vec3&                GetMaxLengthVertex() const { return mMaxLengthVertex; }
+        inline const TriangleHierarchy&        GetTriangleHierarchy() const { return mTriangleHierarchy; }
+
+        /**
+         * Changes every time the bounds or the data of the asset change: placeholder
+         * bounds, upload and reload. The models compare it to recalculate their bounds
+         */
+        inline uint32_t                        GetRevision() const { return mRevision; }
+        inline VertexFormat                    GetVertexFormat() const { return mVertexFormat; }
+        inline void                            SetVertexFormat(VertexFormat aFormat) { mVertexFormat = aFormat; }
+
+        /**
+         * @return Bytes of a vertex in the GPU buffer for the given layout
+         */
+        static uint32_t GetVertexStride(VertexFormat aFormat);
+
+        /**
+         * @return Bytes of an index in the GPU buffer, 2 when all the vertices can be
+         *         addressed with 16 bits
+         */
+        inline uint32_t GetIndexSize() const { return mVertexData.size() <= 0x10000 ? 2 : 4; }
+
+        /**
+         * Vertices in the layout of the GPU buffer. The float layout is returned as is,
+         * the others are packed into the given storage
+         *
+         * @param aStorage  Buffer for the packed vertices
+         *
+         * @return GetVertexData().size() vertices of GetVertexStride() bytes
+         */
+        const void* PackVertexData(std::vector<uint8_t>& aStorage) const;
+
+        /**
+         * Indices in the size of the GPU buffer, see GetIndexSize()
+         *
+         * @param aStorage  Buffer for the 16 bit indices
+         *
+         * @return GetIndexData().size() indices of GetIndexSize() bytes
+         */
+        const void* PackIndexData(std::vector<uint16_t>& aStorage) const;
+
+        /**
+         * @return Bytes of the vertices, indices and textures sent to the GPU
+         */
+        uint64_t GetUploadSize() const;
+
+        /**
+         * @return Bytes of video memory the asset took when it was made ready for rendering
+         */
+        inline uint64_t GetGpuSize() const { return mGpuSize; }
+
+        /**
+         * @return Bytes of system memory held by the asset: the data not released yet,
+         *         the materials, the levels of detail and the triangle hierarchy
+         */
+        uint64_t GetCpuSize() const;
         
 
         /**
-        * Saves a Asset3D to disk with the given name
+        * Saves a Asset3D to disk with the given name in the chunked ModelFile format
         *
-        * @param name   Name of the model
-        * @param model  Asset3D to be saved to disk
+        * @param name                 Name of the model
+        * @param geometryCompression  Compression of the vertex and index chunks, uncompressed
+        *                             chunks can be used straight from the mapped file
+        * @param textureCompression   Compression of the texture chunk
         *
         * @return true if the model was saved correctly or false
         *         otherwise
         */
-        bool Save(const std::string &aName);
+        bool Save(const std::string &aName,
+                  ModelFile::Compression aGeometryCompression = ModelFile::Compression::eNONE,
+                  ModelFile::Compression aTextureCompression = ModelFile::Compression::eZLIB);
 
         /**
-        * Loads a Asset3D from disk with the given name
+        * Loads a Asset3D from disk with the given name. Both the chunked ModelFile
+        * format and the older zlib stream files are read
         *
         * @param name   Name of the model
-        * @param model  Asset3D to be loaded to disk
         *
         * @return true if the model was loaded correctly or false
         *         otherwise
         */
         bool Load(const std::string &aName);
 
+        /**
+        * Reads the bounding box of a model file. Only the header is read for the
+        * chunked format, the older files have to be loaded completely
+        *
+        * @param name   Name of the model
+        * @param box    Bounding box of the model
+        *
+        * @return true if the bounds were read correctly
+        */
+        static bool LoadBounds(const std::string &aName, BoundingBox &aBox);
+
         std::unique_ptr<RendererResources> mRendererResources;
         
         /**
-        * Calculate AABB, MaxLengthVertex
+        * Calculate AABB, MaxLengthVertex, build the triangle hierarchy for picking
         * Clean up mResourceName, mVertexData, mVertexIndices, mTextures
         */
         void RenderReady();
 
+        /**
+         * Moves the data loaded into another asset to this one, to replace the data
+         * of an asset in use. The asset has to be prepared for rendering again
+         *
+         * @param aLoaded  Asset with the same name, loaded but not render ready
+         */
+        void TakeData(Asset3D& aLoaded);
+
     protected:
+        bool LoadModelFile(const std::string &aName);
+        bool LoadZStream(const std::string &aName);
+
+        /**
+        * Calculates the AABB and the MaxLengthVertex from the vertex data
+        */
+        void UpdateBounds();
+
         std::string              mName;
         std::string              mResourceName;
         std::vector<VertexData>  mVertexData;     /**< Data containing the vertex position, normal and UV coordinates */
@@ -175,9 +306,14 @@ namespace Framework
         std::vector<uint32_t>    mIndicesCount;   /**< Number of indices belonging to the rendering list number 'n' */
         std::vector<Texture>     mTextures;       /**< List of textures used in the model */
         std::vector<Material>    mMaterials;      /**< List of materials used in the model */
+        VertexFormat             mVertexFormat = VertexFormat::eFLOAT;  /**< Layout of the GPU vertex buffer */
+        std::vector<LevelOfDetail> mLods;         /**< Levels of detail from 1 on, coarser every level */
 
         BoundingBox              mBoundingBox;
         glm::vec3                mMaxLengthVertex;
+        TriangleHierarchy        mTriangleHierarchy; /**< Triangles of the asset for ray casts, kept after the vertex data is released */
+        uint64_t                 mGpuSize = 0;       /**< Upload size, recorded by RenderReady */
+        uint32_t                 mRevision = 0;      /**< See GetRevision */
     };
 
 }
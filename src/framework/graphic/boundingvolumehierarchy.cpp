@@ -0,0 +1,479 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Dynamic bounding volume hierarchy over the AABB of the 3D objects.
+ *                Insertion and balancing follow the dynamic tree of Box2D, using the
+ *                surface area of the boxes as the cost.
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "graphic/boundingvolumehierarchy.h"
+
+namespace Framework
+{
+    namespace
+    {
+        const float sFatFactor = 0.1f;   // Leaf box enlargement relative to the object size
+        const float sFatMinimum = 1.0f;  // Minimum leaf box enlargement in world units
+
+        inline float SurfaceArea(const glm::vec3& aMin, const glm::vec3& aMax)
+        {
+            glm::vec3 d = aMax - aMin;
+            return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+
+        inline bool Overlaps(const glm::vec3& aMinA, const glm::vec3& aMaxA, const glm::vec3& aMinB, const glm::vec3& aMaxB)
+        {
+            return aMinA.x <= aMaxB.x && aMaxA.x >= aMinB.x &&
+                   aMinA.y <= aMaxB.y && aMaxA.y >= aMinB.y &&
+                   aMinA.z <= aMaxB.z && aMaxA.z >= aMinB.z;
+        }
+
+        inline bool Contains(const glm::vec3& aOuterMin, const glm::vec3& aOuterMax, const glm::vec3& aMin, const glm::vec3& aMax)
+        {
+            return aOuterMin.x <= aMin.x && aOuterMin.y <= aMin.y && aOuterMin.z <= aMin.z &&
+                   aMax.x <= aOuterMax.x && aMax.y <= aOuterMax.y && aMax.z <= aOuterMax.z;
+        }
+
+        inline bool OverlapsSphere(const glm::vec3& aMin, const glm::vec3& aMax, const glm::vec3& aCenter, float aRadius)
+        {
+            glm::vec3 d = aCenter - glm::clamp(aCenter, aMin, aMax);
+            return glm::dot(d, d) <= aRadius * aRadius;
+        }
+
+        // Slab test, aInvDirection components are +/-inf for axis parallel rays
+        inline bool OverlapsRay(const glm::vec3& aMin, const glm::vec3& aMax, const glm::vec3& aOrigin, const glm::vec3& aInvDirection, float aMaxDistance)
+        {
+            glm::vec3 t1 = (aMin - aOrigin) * aInvDirection;
+            glm::vec3 t2 = (aMax - aOrigin) * aInvDirection;
+            glm::vec3 lNear = glm::min(t1, t2);
+            glm::vec3 lFar = glm::max(t1, t2);
+            float lEnter = std::max(std::max(lNear.x, lNear.y), std::max(lNear.z, 0.0f));
+            float lExit = std::min(std::min(lFar.x, lFar.y), std::min(lFar.z, aMaxDistance));
+            return lEnter <= lExit;
+        }
+
+        enum class PlaneSide { Outside, Intersects, Inside };
+
+        inline PlaneSide ClassifyFrustum(const glm::vec3& aMin, const glm::vec3& aMax, const glm::vec4* aPlanes, size_t aPlaneCount)
+        {
+            PlaneSide lResult = PlaneSide::Inside;
+            for ( size_t i = 0; i < aPlaneCount; ++i )
+            {
+                const glm::vec4& p = aPlanes[i];
+                // Corner of the box farthest along the plane normal, and the nearest one
+                glm::vec3 lFar(p.x >= 0.0f ? aMax.x : aMin.x, p.y >= 0.0f ? aMax.y : aMin.y, p.z >= 0.0f ? aMax.z : aMin.z);
+                glm::vec3 lNear(p.x >= 0.0f ? aMin.x : aMax.x, p.y >= 0.0f ? aMin.y : aMax.y, p.z >= 0.0f ? aMin.z : aMax.z);
+                if ( glm::dot(glm::vec3(p), lFar) + p.w < 0.0f )
+                    return PlaneSide::Outside;
+                if ( glm::dot(glm::vec3(p), lNear) + p.w < 0.0f )
+                    lResult = PlaneSide::Intersects;
+            }
+            return lResult;
+        }
+    }
+
+    const int32_t BoundingVolumeHierarchy::sNullProxy;
+
+    BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+        : mRoot(sNullProxy)
+        , mFreeList(sNullProxy)
+        , mLeafCount(0)
+        , mStamp(0)
+    {
+    }
+
+    int32_t BoundingVolumeHierarchy::Insert(Object3D* aObject, const BoundingBox& aBox)
+    {
+        int32_t lLeaf = AllocateNode();
+        Node& lNode = mNodes[lLeaf];
+        glm::vec3 lMargin = glm::max((aBox.GetMax() - aBox.GetMin()) * sFatFactor, glm::vec3(sFatMinimum));
+        lNode.mMin = aBox.GetMin() - lMargin;
+        lNode.mMax = aBox.GetMax() + lMargin;
+        lNode.mTightMin = aBox.GetMin();
+        lNode.mTightMax = aBox.GetMax();
+        lNode.mHeight = 0;
+        lNode.mObject = aObject;
+        lNode.mStamp = ++mStamp;
+
+        InsertLeaf(lLeaf);
+        ++mLeafCount;
+        return lLeaf;
+    }
+
+    void BoundingVolumeHierarchy::Remove(int32_t aProxy)
+    {
+        ASSERT(0 <= aProxy && aProxy < static_cast<int32_t>(mNodes.size()) && mNodes[aProxy].IsLeaf());
+        RemoveLeaf(aProxy);
+        FreeNode(aProxy);
+        --mLeafCount;
+    }
+
+    bool BoundingVolumeHierarchy::Move(int32_t aProxy, const BoundingBox& aBox)
+    {
+        ASSERT(0 <= aProxy && aProxy < static_cast<int32_t>(mNodes.size()) && mNodes[aProxy].IsLeaf());
+        Node& lNode = mNodes[aProxy];
+        lNode.mTightMin = aBox.GetMin();
+        lNode.mTightMax = aBox.GetMax();
+        lNode.mStamp = ++mStamp;
+        if ( Contains(lNode.mMin, lNode.mMax, aBox.GetMin(), aBox.GetMax()) )
+            return false;
+
+        RemoveLeaf(aProxy);
+        glm::vec3 lMargin = glm::max((aBox.GetMax() - aBox.GetMin()) * sFatFactor, glm::vec3(sFatMinimum));
+        mNodes[aProxy].mMin = aBox.GetMin() - lMargin;
+        mNodes[aProxy].mMax = aBox.GetMax() + lMargin;
+        InsertLeaf(aProxy);
+        return true;
+    }
+
+    void BoundingVolumeHierarchy::Clear()
+    {
+        mNodes.clear();
+        mRoot = sNullProxy;
+        mFreeList = sNullProxy;
+        mLeafCount = 0;
+    }
+
+    bool BoundingVolumeHierarchy::GetBounds(BoundingBox& aBox) const
+    {
+        if ( mRoot == sNullProxy )
+            return false;
+        aBox.SetMin(mNodes[mRoot].mMin);
+        aBox.SetMax(mNodes[mRoot].mMax);
+        return true;
+    }
+
+    void BoundingVolumeHierarchy::QueryFrustum(const glm::vec4* aPlanes, size_t aPlaneCount, std::vector<Object3D*>& aResult) const
+    {
+        if ( mRoot == sNullProxy )
+            return;
+        mStack.clear();
+        mStack.push_back(mRoot);
+        while ( !mStack.empty() )
+        {
+            const int32_t lIndex = mStack.back();
+            mStack.pop_back();
+            const Node& lNode = mNodes[lIndex];
+            if ( lNode.IsLeaf() )
+            {
+                if ( ClassifyFrustum(lNode.mTightMin, lNode.mTightMax, aPlanes, aPlaneCount) != PlaneSide::Outside )
+                    aResult.push_back(lNode.mObject);
+                continue;
+            }
+
+            switch ( ClassifyFrustum(lNode.mMin, lNode.mMax, aPlanes, aPlaneCount) )
+            {
+                case PlaneSide::Outside:
+                    break;
+                case PlaneSide::Inside: // whole subtree is visible, no more plane tests
+                    CollectLeaves(lIndex, aResult);
+                    break;
+                case PlaneSide::Intersects:
+                    mStack.push_back(lNode.mChild1);
+                    mStack.push_back(lNode.mChild2);
+                    break;
+            }
+        }
+    }
+
+    void BoundingVolumeHierarchy::QueryBox(const BoundingBox& aBox, std::vector<Object3D*>& aResult) const
+    {
+        if ( mRoot == sNullProxy )
+            return;
+        mStack.clear();
+        mStack.push_back(mRoot);
+        while ( !mStack.empty() )
+        {
+            const Node& lNode = mNodes[mStack.back()];
+            mStack.pop_back();
+            if ( lNode.IsLeaf() )
+            {
+                if ( Overlaps(lNode.mTightMin, lNode.mTightMax, aBox.GetMin(), aBox.GetMax()) )
+                    aResult.push_back(lNode.mObject);
+            }
+            else if ( Overlaps(lNode.mMin, lNode.mMax, aBox.GetMin(), aBox.GetMax()) )
+            {
+                mStack.push_back(lNode.mChild1);
+                mStack.push_back(lNode.mChild2);
+            }
+        }
+    }
+
+    void BoundingVolumeHierarchy::QuerySphere(const glm::vec3& aCenter, float aRadius, std::vector<Object3D*>& aResult) const
+    {
+        if ( mRoot == sNullProxy )
+            return;
+        mStack.clear();
+        mStack.push_back(mRoot);
+        while ( !mStack.empty() )
+        {
+            const Node& lNode = mNodes[mStack.back()];
+            mStack.pop_back();
+            if ( lNode.IsLeaf() )
+            {
+                if ( OverlapsSphere(lNode.mTightMin, lNode.mTightMax, aCenter, aRadius) )
+                    aResult.push_back(lNode.mObject);
+            }
+            else if ( OverlapsSphere(lNode.mMin, lNode.mMax, aCenter, aRadius) )
+            {
+                mStack.push_back(lNode.mChild1);
+                mStack.push_back(lNode.mChild2);
+            }
+        }
+    }
+
+    void BoundingVolumeHierarchy::QueryRay(const glm::vec3& aOrigin, const glm::vec3& aDirection, float aMaxDistance, std::vector<Object3D*>& aResult) const
+    {
+        if ( mRoot == sNullProxy )
+            return;
+        const glm::vec3 lInvDirection = 1.0f / aDirection;
+        mStack.clear();
+        mStack.push_back(mRoot);
+        while ( !mStack.empty() )
+        {
+            const Node& lNode = mNodes[mStack.back()];
+            mStack.pop_back();
+            if ( lNode.IsLeaf() )
+            {
+                if ( OverlapsRay(lNode.mTightMin, lNode.mTightMax, aOrigin, lInvDirection, aMaxDistance) )
+                    aResult.push_back(lNode.mObject);
+            }
+            else if ( OverlapsRay(lNode.mMin, lNode.mMax, aOrigin, lInvDirection, aMaxDistance) )
+            {
+                mStack.push_back(lNode.mChild1);
+                mStack.push_back(lNode.mChild2);
+            }
+        }
+    }
+
+    int32_t BoundingVolumeHierarchy::AllocateNode()
+    {
+        int32_t lIndex;
+        if ( mFreeList != sNullProxy )
+        {
+            lIndex = mFreeList;
+            mFreeList = mNodes[lIndex].mParent;
+        }
+        else
+        {
+            lIndex = static_cast<int32_t>(mNodes.size());
+            mNodes.push_back(Node());
+        }
+        Node& lNode = mNodes[lIndex];
+        lNode.mParent = sNullProxy;
+        lNode.mChild1 = sNullProxy;
+        lNode.mChild2 = sNullProxy;
+        lNode.mHeight = 0;
+        lNode.mStamp = 0;
+        lNode.mObject = nullptr;
+        return lIndex;
+    }
+
+    void BoundingVolumeHierarchy::FreeNode(int32_t aNode)
+    {
+        mNodes[aNode].mParent = mFreeList;
+        mNodes[aNode].mHeight = -1;
+        mNodes[aNode].mObject = nullptr;
+        mFreeList = aNode;
+    }
+
+    void BoundingVolumeHierarchy::InsertLeaf(int32_t aLeaf)
+    {
+        if ( mRoot == sNullProxy )
+        {
+            mRoot = aLeaf;
+            mNodes[mRoot].mParent = sNullProxy;
+            return;
+        }
+
+        // Find the best sibling walking down the cheapest branch
+        const glm::vec3 lLeafMin = mNodes[aLeaf].mMin;
+        const glm::vec3 lLeafMax = mNodes[aLeaf].mMax;
+        int32_t lIndex = mRoot;
+        while ( !mNodes[lIndex].IsLeaf() )
+        {
+            const Node& lNode = mNodes[lIndex];
+            float lArea = SurfaceArea(lNode.mMin, lNode.mMax);
+            float lCombinedArea = SurfaceArea(glm::min(lNode.mMin, lLeafMin), glm::max(lNode.mMax, lLeafMax));
+
+            // Cost of creating a new parent for this node and the new leaf
+            float lCost = 2.0f * lCombinedArea;
+            // Minimum cost of pushing the leaf further down the tree
+            float lInheritanceCost = 2.0f * (lCombinedArea - lArea);
+
+            float lChildCost[2];
+            const int32_t lChildren[2] = { lNode.mChild1, lNode.mChild2 };
+            for ( int i = 0; i < 2; ++i )
+            {
+                const Node& lChild = mNodes[lChildren[i]];
+                float lNewArea = SurfaceArea(glm::min(lChild.mMin, lLeafMin), glm::max(lChild.mMax, lLeafMax));
+                if ( lChild.IsLeaf() )
+                    lChildCost[i] = lNewArea + lInheritanceCost;
+                else
+                    lChildCost[i] = (lNewArea - SurfaceArea(lChild.mMin, lChild.mMax)) + lInheritanceCost;
+            }
+
+            if ( lCost < lChildCost[0] && lCost < lChildCost[1] )
+                break;
+
+            lIndex = lChildCost[0] < lChildCost[1] ? lChildren[0] : lChildren[1];
+        }
+
+        // Create a new parent for the sibling and the leaf
+        const int32_t lSibling = lIndex;
+        const int32_t lOldParent = mNodes[lSibling].mParent;
+        const int32_t lNewParent = AllocateNode();
+        mNodes[lNewParent].mParent = lOldParent;
+        mNodes[lNewParent].mChild1 = lSibling;
+        mNodes[lNewParent].mChild2 = aLeaf;
+        mNodes[lSibling].mParent = lNewParent;
+        mNodes[aLeaf].mParent = lNewParent;
+
+        if ( lOldParent != sNullProxy )
+        {
+            if ( mNodes[lOldParent].mChild1 == lSibling )
+                mNodes[lOldParent].mChild1 = lNewParent;
+            else
+                mNodes[lOldParent].mChild2 = lNewParent;
+        }
+        else
+        {
+            mRoot = lNewParent;
+        }
+
+        // Walk back up fixing heights and boxes
+        for ( lIndex = lNewParent; lIndex != sNullProxy; lIndex = mNodes[lIndex].mParent )
+        {
+            lIndex = Balance(lIndex);
+            FitNode(lIndex);
+        }
+    }
+
+    void BoundingVolumeHierarchy::RemoveLeaf(int32_t aLeaf)
+    {
+        if ( aLeaf == mRoot )
+        {
+            mRoot = sNullProxy;
+            return;
+        }
+
+        const int32_t lParent = mNodes[aLeaf].mParent;
+        const int32_t lGrandParent = mNodes[lParent].mParent;
+        const int32_t lSibling = mNodes[lParent].mChild1 == aLeaf ? mNodes[lParent].mChild2 : mNodes[lParent].mChild1;
+
+        if ( lGrandParent == sNullProxy )
+        {
+            mRoot = lSibling;
+            mNodes[lSibling].mParent = sNullProxy;
+            FreeNode(lParent);
+            return;
+        }
+
+        // Replace the parent with the sibling
+        if ( mNodes[lGrandParent].mChild1 == lParent )
+            mNodes[lGrandParent].mChild1 = lSibling;
+        else
+            mNodes[lGrandParent].mChild2 = lSibling;
+        mNodes[lSibling].mParent = lGrandParent;
+        FreeNode(lParent);
+
+        for ( int32_t lIndex = lGrandParent; lIndex != sNullProxy; lIndex = mNodes[lIndex].mParent )
+        {
+            lIndex = Balance(lIndex);
+            FitNode(lIndex);
+        }
+    }
+
+    /**
+     * Rotates the node up if its children heights differ more than one.
+     * Returns the node that took the place of aNode
+     */
+    int32_t BoundingVolumeHierarchy::Balance(int32_t aNode)
+    {
+        const int32_t iA = aNode;
+        if ( mNodes[iA].IsLeaf() || mNodes[iA].mHeight < 2 )
+            return iA;
+
+        const int32_t iB = mNodes[iA].mChild1;
+        const int32_t iC = mNodes[iA].mChild2;
+        const int32_t lBalance = mNodes[iC].mHeight - mNodes[iB].mHeight;
+
+        if ( lBalance > 1 || lBalance < -1 )
+        {
+            // Rotate the taller child (iUp) up, A becomes its child
+            const int32_t iUp = lBalance > 1 ? iC : iB;
+            const int32_t iF = mNodes[iUp].mChild1;
+            const int32_t iG = mNodes[iUp].mChild2;
+
+            mNodes[iUp].mChild1 = iA;
+            mNodes[iUp].mParent = mNodes[iA].mParent;
+            mNodes[iA].mParent = iUp;
+
+            if ( mNodes[iUp].mParent != sNullProxy )
+            {
+                Node& lUpParent = mNodes[mNodes[iUp].mParent];
+                if ( lUpParent.mChild1 == iA )
+                    lUpParent.mChild1 = iUp;
+                else
+                    lUpParent.mChild2 = iUp;
+            }
+            else
+            {
+                mRoot = iUp;
+            }
+
+            // The taller grandchild stays under iUp, the other one goes under A
+            const bool lKeepF = mNodes[iF].mHeight > mNodes[iG].mHeight;
+            const int32_t iKeep = lKeepF ? iF : iG;
+            const int32_t iMove = lKeepF ? iG : iF;
+            mNodes[iUp].mChild2 = iKeep;
+            if ( lBalance > 1 )
+                mNodes[iA].mChild2 = iMove;
+            else
+                mNodes[iA].mChild1 = iMove;
+            mNodes[iMove].mParent = iA;
+
+            FitNode(iA);
+            FitNode(iUp);
+            return iUp;
+        }
+        return iA;
+    }
+
+    void BoundingVolumeHierarchy::FitNode(int32_t aNode)
+    {
+        Node& lNode = mNodes[aNode];
+        if ( lNode.IsLeaf() )
+            return;
+        const Node& lChild1 = mNodes[lNode.mChild1];
+        const Node& lChild2 = mNodes[lNode.mChild2];
+        lNode.mMin = glm::min(lChild1.mMin, lChild2.mMin);
+        lNode.mMax = glm::max(lChild1.mMax, lChild2.mMax);
+        lNode.mHeight = 1 + std::max(lChild1.mHeight, lChild2.mHeight);
+    }
+
+    void BoundingVolumeHierarchy::CollectLeaves(int32_t aNode, std::vector<Object3D*>& aResult) const
+    {
+        // Uses the tail of the shared stack, the caller's entries below it are kept
+        const size_t lBase = mStack.size();
+        mStack.push_back(aNode);
+        while ( mStack.size() > lBase )
+        {
+            const Node& lNode = mNodes[mStack.back()];
+            mStack.pop_back();
+            if ( lNode.IsLeaf() )
+            {
+                aResult.push_back(lNode.mObject);
+            }
+            else
+            {
+                mStack.push_back(lNode.mChild1);
+                mStack.push_back(lNode.mChild2);
+            }
+        }
+    }
+}
@@ -0,0 +1,122 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Dynamic bounding volume hierarchy over the AABB of the 3D objects.
+ *                Every object is a leaf (a proxy) of a binary tree of axis-aligned
+ *                boxes. The leaves keep a slightly enlarged box, so small movements
+ *                only update the leaf and don't touch the tree. The tree is kept
+ *                balanced with rotations on the way up after every insert and remove.
+ *******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+
+#include "glm/glm.hpp"
+#include "graphic/boundingbox.h"
+
+namespace Framework
+{
+    class Object3D;
+
+    class BoundingVolumeHierarchy
+    {
+    public:
+        static const int32_t sNullProxy = -1;
+
+        BoundingVolumeHierarchy();
+
+        /**
+         * Creates a new leaf for the object
+         *
+         * @param aObject  Object stored in the leaf
+         * @param aBox     World space AABB of the object
+         *
+         * @return The proxy id of the leaf
+         */
+        int32_t Insert(Object3D* aObject, const BoundingBox& aBox);
+
+        /**
+         * Removes the leaf of the proxy from the tree
+         */
+        void Remove(int32_t aProxy);
+
+        /**
+         * Refits the leaf of the proxy to the new AABB of its object. The leaf is
+         * only reinserted when the new box is not contained by its enlarged box
+         *
+         * @return true if the leaf was reinserted
+         */
+        bool Move(int32_t aProxy, const BoundingBox& aBox);
+
+        /**
+         * Removes all leaves from the tree
+         */
+        void Clear();
+
+        /**
+         * Spatial queries. The objects overlapping the volume are appended to aResult
+         *
+         * The frustum planes are in (normal, distance) form with the normal pointing
+         * inside, as calculated by Camera::RecalculateProjectionVolume
+         */
+        void QueryFrustum(const glm::vec4* aPlanes, size_t aPlaneCount, std::vector<Object3D*>& aResult) const;
+        void QueryBox(const BoundingBox& aBox, std::vector<Object3D*>& aResult) const;
+        void QuerySphere(const glm::vec3& aCenter, float aRadius, std::vector<Object3D*>& aResult) const;
+        void QueryRay(const glm::vec3& aOrigin, const glm::vec3& aDirection, float aMaxDistance, std::vector<Object3D*>& aResult) const;
+
+        /**
+         * Retrieves the box containing all the leaves
+         *
+         * @return false if the tree is empty
+         */
+        bool GetBounds(BoundingBox& aBox) const;
+
+        /**
+         * Every insert and move of a leaf takes a new stamp. A leaf stamp greater
+         * than a stamp taken earlier from GetStamp() means the leaf changed since then
+         */
+        uint32_t GetStamp() const                   { return mStamp; }
+        uint32_t GetStamp(int32_t aProxy) const     { return mNodes[aProxy].mStamp; }
+
+        Object3D* GetObject(int32_t aProxy) const { return mNodes[aProxy].mObject; }
+        size_t    Size() const                    { return mLeafCount; }
+        int32_t   GetHeight() const               { return mRoot == sNullProxy ? 0 : mNodes[mRoot].mHeight; }
+
+    private:
+        struct Node
+        {
+            glm::vec3 mMin;           /**< Enlarged box of the leaf, or union of the children */
+            glm::vec3 mMax;
+            glm::vec3 mTightMin;      /**< Leaf only: exact box of the object */
+            glm::vec3 mTightMax;
+            int32_t   mParent;        /**< Parent node, or next free node when the node is not used */
+            int32_t   mChild1;
+            int32_t   mChild2;
+            int32_t   mHeight;        /**< Leaf = 0, free node = -1 */
+            uint32_t  mStamp;         /**< Leaf only: stamp of the last insert or move */
+            Object3D* mObject;
+
+            bool IsLeaf() const { return mChild1 == sNullProxy; }
+        };
+
+        int32_t AllocateNode();
+        void    FreeNode(int32_t aNode);
+        void    InsertLeaf(int32_t aLeaf);
+        void    RemoveLeaf(int32_t aLeaf);
+        int32_t Balance(int32_t aNode);
+        void    FitNode(int32_t aNode);
+        void    CollectLeaves(int32_t aNode, std::vector<Object3D*>& aResult) const;
+
+        std::vector<Node>            mNodes;
+        int32_t                      mRoot;
+        int32_t                      mFreeList;
+        size_t                       mLeafCount;
+        uint32_t                     mStamp;
+        mutable std::vector<int32_t> mStack;      /**< Traversal stack reused by the queries */
+    };
+}
@@ -27,7 +27,7 @@ namespace Framework
         glm::mat4 lMVP = GetProjectionMatrix() * GetViewMatrix();
 
     #if 0 /* Left here to understand how the planes are calculated \
-             in the loop below */
+             in the loop of Projection::CalculateProjectionVolume */
         float planesTerms[MAX_PLANES][4] = {
             {lMVP[0][0] + lMVP[0][3], lMVP[1][0] + lMVP[1][3], lMVP[2][0] + lMVP[2][3], lMVP[3][0] + lMVP[3][3]},     /* Left plane */
             {-lMVP[0][0] + lMVP[0][3], -lMVP[1][0] + lMVP[1][3], -lMVP[2][0] + lMVP[2][3], -lMVP[3][0] + lMVP[3][3]}, /* Right plane */
@@ -38,13 +38,7 @@ namespace Framework
         };
     #endif
 
-        for (int i = 0; i < MAX_PLANES; ++i) {
-            float sign = (i % 2) ? -1.0f : 1.0f;
-
-            glm::vec3 normal = glm::vec3(sign * lMVP[0][i / 2] + lMVP[0][3], sign * lMVP[1][i / 2] + lMVP[1][3], sign * lMVP[2][i / 2] + lMVP[2][3]);
-
-            mProjectionVolumePlanes[i] = glm::vec4(normal, sign * lMVP[3][i / 2] + lMVP[3][3]) / glm::length(normal);
-        }
+        CalculateProjectionVolume(lMVP, mProjectionVolumePlanes);
     }
 
     bool Camera::IsObjectVisible(Object3D &aObject)
@@ -56,6 +56,13 @@ class Camera : public Projection, public Object3D
      */
     bool IsObjectVisible(Object2D &object);
 
+    /**
+     * Retrieves the projection volume planes calculated by RecalculateProjectionVolume,
+     * in (normal, distance) form with the normals pointing inside the volume
+     */
+    const glm::vec4* GetProjectionVolumePlanes() const { return mProjectionVolumePlanes; }
+    size_t GetProjectionVolumePlaneCount() const { return MAX_PLANES; }
+
 
   private:
     /**
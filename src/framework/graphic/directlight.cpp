@@ -6,13 +6,29 @@ namespace Framework
 {
     void DirectLight::UpdateViewProjectionMatrix() const
     {
-        glm::vec3 pos = normalize(GetPosition());
+        glm::vec3 lDirection = normalize(GetPosition());
         glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
-        if ( glm::length(glm::cross(pos, up)) < 1.0e-6f )
+        if ( glm::length(glm::cross(lDirection, up)) < 1.0e-6f )
             up = glm::vec3(1.0f/*or -1 ?*/, 0.0f, 0.0f);
-        pos *= (mProjectionVolume.z / 2.0f); // TODO: auto calculate it!
-        const auto lLightViewMatrix = glm::lookAt(pos, glm::vec3(0.0f, 0.0f, 0.0f), up);
-        const auto lLightProjMatrix = glm::ortho(-mProjectionVolume.x, mProjectionVolume.x, -mProjectionVolume.y, mProjectionVolume.y, 1.0f, mProjectionVolume.z);
+
+        // Look at the center of the shadow bounds from outside of them
+        const glm::vec3& lMin = mShadowBounds.GetMin();
+        const glm::vec3& lMax = mShadowBounds.GetMax();
+        const glm::vec3 lCenter = (lMin + lMax) / 2.0f;
+        const float lRadius = glm::length(lMax - lMin) / 2.0f;
+        const auto lLightViewMatrix = glm::lookAt(lCenter + lDirection * (lRadius + 1.0f), lCenter, up);
+
+        // Fit the orthographic volume to the corners of the bounds in light space
+        glm::vec3 lLightMin(FLT_MAX), lLightMax(-FLT_MAX);
+        for ( int i = 0; i < 8; ++i )
+        {
+            const glm::vec3 lCorner((i & 1) ? lMax.x : lMin.x, (i & 2) ? lMax.y : lMin.y, (i & 4) ? lMax.z : lMin.z);
+            const glm::vec3 lLightCorner = glm::vec3(lLightViewMatrix * glm::vec4(lCorner, 1.0f));
+            lLightMin = glm::min(lLightMin, lLightCorner);
+            lLightMax = glm::max(lLightMax, lLightCorner);
+        }
+        // the light looks down -z, so the near and far distances are the negated z range
+        const auto lLightProjMatrix = glm::ortho(lLightMin.x, lLightMax.x, lLightMin.y, lLightMax.y, -lLightMax.z, -lLightMin.z);
         mViewProjectionMatrix = lLightProjMatrix * lLightViewMatrix;
     }
 }
\ No newline at end of file
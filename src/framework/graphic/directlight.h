@@ -34,8 +34,23 @@ namespace Framework
             : Light(aAmbient, aDiffuse, aSpecular, aPosition, aEntityID)
         {}
 
-        mutable glm::vec3 mProjectionVolume{1000.0f, 1000.0f, 1000.0f}; // hint for ortho projection
+        /**
+         * Sets the box the orthographic shadow projection is fitted to. It shall contain
+         * all the shadow casters of the scene
+         */
+        void SetShadowBounds(const BoundingBox& aBounds) const
+        {
+            if ( aBounds.GetMin() != mShadowBounds.GetMin() || aBounds.GetMax() != mShadowBounds.GetMax() )
+            {
+                mShadowBounds = aBounds;
+                DoUpdateViewProjectionMatrix = true;
+            }
+        }
+        const BoundingBox& GetShadowBounds() const { return mShadowBounds; }
 
         void UpdateViewProjectionMatrix() const override;
+
+    private:
+        mutable BoundingBox mShadowBounds{glm::vec3(-1000.0f), glm::vec3(1000.0f)};
     };
 }
@@ -10,10 +10,64 @@
 
 #include "graphic/fontrender.h"
 #include "graphic/opengl/opengl_fontrenderer.h"
+#include "graphic/null/null_fontrenderer.h"
+#include "graphic/renderer.h"
 
 namespace Framework
 {
-    FontRenderer *FontRenderer::New(void) { return new OpenGLFontRenderer(); }
+    FontRenderer *FontRenderer::New(void)
+    {
+        if ( Renderer::GetBackend() == Renderer::Backend::eNULL )
+            return new NullFontRenderer();
+        return new OpenGLFontRenderer();
+    }
     void FontRenderer::Delete(FontRenderer *aFontRenderer) { delete aFontRenderer; }
-}
 
+    glm::uvec2 FontRenderer::EvaluateText(const char* aText, float aScale, uint32_t aVerticalSpacing) const
+    {
+        return mLayoutCache.Get(mAtlas, aText, aScale, aVerticalSpacing).mBox;
+    }
+
+    void FontRenderer::QueueText(const char* aText, float aScale, const glm::uvec3& aLayout, const glm::vec4& aColor, RenderTarget& aTarget) const
+    {
+        const TextLayout& lLayout = mLayoutCache.Get(mAtlas, aText, aScale, aLayout.z);
+        if ( mRuns.empty() || mRuns.back().mTarget != &aTarget )
+            mRuns.push_back(Run{ &aTarget, static_cast<uint32_t>(mBatch.size()) });
+        lLayout.Emit(glm::vec2(aLayout.x, aLayout.y), aColor, mBatch);
+        ++mQueuedTexts;
+    }
+
+    void FontRenderer::Flush() const
+    {
+        mStats = Stats();
+        mStats.mTexts = mQueuedTexts;
+        mStats.mGlyphs = static_cast<uint32_t>(mBatch.size() / 4);
+        for ( size_t i = 0; i < mRuns.size(); ++i )
+        {
+            const uint32_t lFirst = mRuns[i].mFirstVertex;
+            const uint32_t lEnd = (i + 1 < mRuns.size()) ? mRuns[i + 1].mFirstVertex : static_cast<uint32_t>(mBatch.size());
+            if ( lEnd > lFirst )
+            {
+                DrawBatch(mBatch.data() + lFirst, (lEnd - lFirst) / 4, *mRuns[i].mTarget);
+                ++mStats.mDrawCalls;
+            }
+        }
+        mBatch.clear();
+        mRuns.clear();
+        mQueuedTexts = 0;
+    }
+
+    void FontRenderer::RenderText(const char* aText, float aScale, const glm::uvec3& aLayout, const glm::vec4& aColor, RenderTarget& aTarget) const
+    {
+        QueueText(aText, aScale, aLayout, aColor, aTarget);
+        Flush();
+    }
+
+    void FontRenderer::BuildAtlas(std::shared_ptr<const TrueTypeFont> aFont)
+    {
+        mFont = std::move(aFont);
+        mAtlas.Build(*mFont);
+        // The quads of the cached layouts point into the previous atlas
+        mLayoutCache.Clear();
+    }
+}
@@ -11,17 +11,25 @@
  *                It allows to set a specific TrueType font for rendering and then
  *                render the desired text onto a render target with the given color
  *
+ *                The glyphs of the font are packed in a GlyphAtlas and the layout of
+ *                every text is kept in a TextLayoutCache. Queued texts are appended as
+ *                glyph quads to one vertex batch, and each flush draws the whole batch
+ *                of a render target at once, so hundreds of labels take one draw
+ *
  *                This class does NOT support formatting like printf. For that functionality
  *                instead use TextConsole class
  *******************************************************************************/
 #pragma once
 
 #include <string>
+#include <vector>
 #include <stdint.h>
 #include <glm/glm.hpp>
 
 #include "graphic/rendertarget.h"
 #include "graphic/truetypefont.h"
+#include "graphic/glyphatlas.h"
+#include "graphic/textlayout.h"
 
 namespace Framework
 {
@@ -66,11 +74,31 @@ namespace Framework
          *
          * @return       Bounding rectangle
          */
-        virtual glm::uvec2 EvaluateText(const char* text, float scale, uint32_t vertical_spacing) const = 0;
+        glm::uvec2 EvaluateText(const char* text, float scale, uint32_t vertical_spacing) const;
+
+        /**
+         * Adds the given text to the batch of the given render target. Nothing is
+         * drawn until the batch is flushed
+         *
+         * @param text   Text to be rendered
+         * @param scale  Applied font scale
+         * @param layout (x,y) = starting position for text rendering (in pixels), z = vertical spacing between lines (in pixels)
+         * @param color  Color to used for the rendering
+         * @param target Render target to render the text on
+         */
+        void QueueText(const char* text, float scale, const glm::uvec3& layout,
+                       const glm::vec4& color, RenderTarget& target) const;
+
+        /**
+         * Draws all the queued texts and empties the batch. The texts queued one after
+         * another for the same render target take a single draw
+         */
+        void Flush() const;
 
         /**
          * Renders the given text onto the given render target with the indicated color
-         * at the indicated (x, y) position on the render target
+         * at the indicated (x, y) position on the render target. Any queued text is
+         * drawn too
          *
          * @param text   Text to be rendered
          * @param scale  Applied font scale
@@ -78,10 +106,56 @@ namespace Framework
          * @param color  Color to used for the rendering
          * @param target Render target to render the text on
          */
-        virtual void RenderText(const char* text, float scale, const glm::uvec3& layout,
-                                const glm::vec4& color, RenderTarget& target) const = 0;
+        void RenderText(const char* text, float scale, const glm::uvec3& layout,
+                        const glm::vec4& color, RenderTarget& target) const;
+
+        /**
+         * Starts a new frame, the cached layouts not used during the last frame
+         * can be dropped
+         */
+        void BeginFrame() const { mLayoutCache.Tick(); }
+
+        /**
+         * Counters of the last flush
+         */
+        struct Stats
+        {
+            uint32_t mTexts = 0;
+            uint32_t mGlyphs = 0;
+            uint32_t mDrawCalls = 0;
+        };
+        const Stats&                  GetStats() const       { return mStats; }
+        const TextLayoutCache::Stats& GetLayoutStats() const { return mLayoutCache.GetStats(); }
 
     protected:
-       std::shared_ptr<const TrueTypeFont> mFont;
+        /**
+         * Sets the font and packs its glyphs, the backends upload the atlas afterwards
+         */
+        void BuildAtlas(std::shared_ptr<const TrueTypeFont> font);
+
+        /**
+         * Draws a batch of glyph quads, four vertices per quad
+         *
+         * @param vertices  Vertices of the quads
+         * @param quads     Number of quads
+         * @param target    Render target to render the quads on
+         */
+        virtual void DrawBatch(const GlyphVertex* vertices, uint32_t quads, RenderTarget& target) const = 0;
+
+        std::shared_ptr<const TrueTypeFont> mFont;
+        GlyphAtlas                          mAtlas;
+
+    private:
+        struct Run
+        {
+            RenderTarget* mTarget;
+            uint32_t      mFirstVertex;
+        };
+
+        mutable TextLayoutCache          mLayoutCache;
+        mutable std::vector<GlyphVertex> mBatch;
+        mutable std::vector<Run>         mRuns;     /**< Consecutive vertices of the same render target */
+        mutable Stats                    mStats;
+        mutable uint32_t                 mQueuedTexts = 0;
     };
 }
@@ -0,0 +1,90 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Packs the glyph bitmaps of a TrueType font into a single image
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include <algorithm>
+#include "graphic/glyphatlas.h"
+#include "graphic/truetypefont.h"
+
+namespace Framework
+{
+    namespace
+    {
+        const uint32_t sPadding = 1;    // Empty pixels around each glyph, so the linear filter does not bleed
+        const uint32_t sMinWidth = 256;
+
+        uint32_t NextPowerOfTwo(uint32_t aValue)
+        {
+            uint32_t lResult = 1;
+            while ( lResult < aValue )
+                lResult <<= 1;
+            return lResult;
+        }
+    }
+
+    void GlyphAtlas::Build(const TrueTypeFont& aFont)
+    {
+        const uint8_t* lBitmaps[sNumGlyphs];
+        uint32_t lOrder[sNumGlyphs];
+        uint32_t lArea = 0, lMaxWidth = 0;
+        for ( uint32_t i = 0; i < sNumGlyphs; ++i )
+        {
+            Glyph& lGlyph = mGlyphs[i];
+            lGlyph = Glyph();
+            lBitmaps[i] = aFont.GetBitmap(static_cast<char>(i), lGlyph.mWidth, lGlyph.mHeight,
+                                          lGlyph.mOffsetLeft, lGlyph.mOffsetTop, lGlyph.mAdvance);
+            if ( !lBitmaps[i] )
+                lGlyph.mWidth = lGlyph.mHeight = 0;
+            lArea += (lGlyph.mWidth + sPadding) * (lGlyph.mHeight + sPadding);
+            lMaxWidth = std::max(lMaxWidth, lGlyph.mWidth + 2 * sPadding);
+            lOrder[i] = i;
+        }
+
+        // Shelf packing, the tallest glyphs first so every shelf wastes little height
+        std::stable_sort(lOrder, lOrder + sNumGlyphs, [this](uint32_t a, uint32_t b)
+        {
+            return mGlyphs[a].mHeight > mGlyphs[b].mHeight;
+        });
+        mWidth = std::max(sMinWidth, NextPowerOfTwo(std::max(lMaxWidth, static_cast<uint32_t>(sqrtf(static_cast<float>(lArea))))));
+
+        uint32_t lX = sPadding, lY = sPadding, lShelfHeight = 0;
+        uint32_t lPositions[sNumGlyphs][2];
+        for ( uint32_t i : lOrder )
+        {
+            const Glyph& lGlyph = mGlyphs[i];
+            if ( !lGlyph.mWidth || !lGlyph.mHeight )
+                continue;
+            if ( lX + lGlyph.mWidth + sPadding > mWidth )
+            {
+                lX = sPadding;
+                lY += lShelfHeight + sPadding;
+                lShelfHeight = 0;
+            }
+            lPositions[i][0] = lX;
+            lPositions[i][1] = lY;
+            lX += lGlyph.mWidth + sPadding;
+            lShelfHeight = std::max(lShelfHeight, lGlyph.mHeight);
+        }
+        mHeight = NextPowerOfTwo(lY + lShelfHeight + sPadding);
+
+        mPixels.assign(mWidth * mHeight, 0);
+        const glm::vec2 lTexel(1.0f / mWidth, 1.0f / mHeight);
+        for ( uint32_t i = 0; i < sNumGlyphs; ++i )
+        {
+            Glyph& lGlyph = mGlyphs[i];
+            if ( !lGlyph.mWidth || !lGlyph.mHeight )
+                continue;
+            const uint32_t x = lPositions[i][0], y = lPositions[i][1];
+            for ( uint32_t lRow = 0; lRow < lGlyph.mHeight; ++lRow )
+                memcpy(&mPixels[(y + lRow) * mWidth + x], lBitmaps[i] + lRow * lGlyph.mWidth, lGlyph.mWidth);
+            lGlyph.mUVMin = glm::vec2(x, y) * lTexel;
+            lGlyph.mUVMax = glm::vec2(x + lGlyph.mWidth, y + lGlyph.mHeight) * lTexel;
+        }
+    }
+}
@@ -0,0 +1,63 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Packs the glyph bitmaps of a TrueType font into a single one channel
+ *                image. Every glyph keeps its rectangle in the image, its texture
+ *                coordinates and its metrics, so a text of any length can be drawn
+ *                with one texture bound. It does not know about the graphic API, the
+ *                font renderers upload the image.
+ *******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include <glm/glm.hpp>
+
+namespace Framework
+{
+    class TrueTypeFont;
+
+    class GlyphAtlas
+    {
+    public:
+        static const uint32_t sNumGlyphs = 128;   /**< ASCII only */
+
+        struct Glyph
+        {
+            uint32_t  mWidth = 0;       /**< Size of the bitmap in pixels, 0 for empty glyphs */
+            uint32_t  mHeight = 0;
+            int32_t   mOffsetLeft = 0;  /**< Bearings */
+            int32_t   mOffsetTop = 0;
+            uint32_t  mAdvance = 0;
+            glm::vec2 mUVMin;           /**< Texture coordinates of the bitmap in the atlas */
+            glm::vec2 mUVMax;
+        };
+
+        /**
+         * Rasterizes and packs all the glyphs of a font, the previous content is dropped
+         *
+         * @param aFont  Font to pack
+         */
+        void Build(const TrueTypeFont& aFont);
+
+        const Glyph& GetGlyph(char aLetter) const
+        {
+            return mGlyphs[static_cast<uint8_t>(aLetter) & (sNumGlyphs - 1)];
+        }
+
+        uint32_t       GetWidth() const  { return mWidth; }
+        uint32_t       GetHeight() const { return mHeight; }
+        const uint8_t* GetPixels() const { return mPixels.data(); }
+        bool           IsEmpty() const   { return mPixels.empty(); }
+
+    private:
+        Glyph                mGlyphs[sNumGlyphs];
+        std::vector<uint8_t> mPixels;   /**< One byte per pixel, rows from top to bottom */
+        uint32_t             mWidth = 0;
+        uint32_t             mHeight = 0;
+    };
+}
@@ -517,6 +517,7 @@ namespace Framework
                         { // we are in 2D view
                             Model2D* lModel2DTarget = static_cast<Model2D*>(mScene->mModelUnderTransform.mTarget);
                             lModel2DTarget->SetPosition(lModel2DTarget->GetPosition() + lDelta);
+                            Engine::Instance()->EntityManager().MarkDirty(lModel2DTarget->GetEntityID());
                             Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
                         }
                         else
@@ -524,6 +525,8 @@ namespace Framework
                             Model3D* lModel3DTarget = static_cast<Model3D*>(mScene->mModelUnderTransform.mTarget);
                             lModel3DTarget->SetPosition(lModel3DTarget->GetPosition() + lDelta * 1000.f);
                             lModel3DTarget->ConstrainPosition(mScene->mBoundingBox);
+                            lModel3DTarget->RefitSpatialProxy();
+                            Engine::Instance()->EntityManager().MarkDirty(lModel3DTarget->GetEntityID());
                             Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
                         }
                         break;
@@ -576,6 +579,7 @@ namespace Framework
                         { // we are in 2D view
                             Model2D* lModel2DTarget = static_cast<Model2D*>(mScene->mModelUnderTransform.mTarget);
                             lModel2DTarget->SetScaleFactor(lModel2DTarget->GetScaleFactor() + lDelta);
+                            Engine::Instance()->EntityManager().MarkDirty(lModel2DTarget->GetEntityID());
                             Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
                         }
                         else
@@ -583,6 +587,8 @@ namespace Framework
                             Model3D* lModel3DTarget = static_cast<Model3D*>(mScene->mModelUnderTransform.mTarget);
                             lModel3DTarget->SetScaleFactor(lModel3DTarget->GetScaleFactor() + lDelta * 1000.f);
                             lModel3DTarget->ConstrainPosition(mScene->mBoundingBox);
+                            lModel3DTarget->RefitSpatialProxy();
+                            Engine::Instance()->EntityManager().MarkDirty(lModel3DTarget->GetEntityID());
                             Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
                         }
                         break;
@@ -657,12 +663,15 @@ namespace Framework
                             if (lModel2DTarget)
                             {
                                 lModel2DTarget->Rotate(RotationMatrix);
+                                Engine::Instance()->EntityManager().MarkDirty(lModel2DTarget->GetEntityID());
                                 Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
                             }
                             else
                             {
                                 lModel3DTarget->Rotate(RotationMatrix);
                                 lModel3DTarget->ConstrainPosition(mScene->mBoundingBox);
+                                lModel3DTarget->RefitSpatialProxy();
+                                Engine::Instance()->EntityManager().MarkDirty(lModel3DTarget->GetEntityID());
                                 Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
                             }
                         }
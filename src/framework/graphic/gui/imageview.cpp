@@ -16,6 +16,7 @@
 #include <cmath>
 #include "engine.h"
 #include "graphic/gui/imageview.h"
+#include "core/graphic/texturecooker.h"
 #include "graphic/gui/window.h"
 #include "graphic/gui/screen.h"
 #include "graphic/gui/theme.h"
@@ -478,12 +479,15 @@ namespace Framework
 
             if (aSerializer.isMember("image"))
             {
+                /* The file name is kept apart, loading clears the texture */
+                const std::string lImageFile = aSerializer["image"].asString();
                 Texture lTexture;
-                lTexture.mName = aSerializer["image"].asString();
-
-                if (!lTexture.Load(lTexture.mName))
+                /* Never block compressed, the 4x4 blocks show on the sharp edges and the alpha of the UI */
+                TextureCooker::Options lOptions;
+                lOptions.mCompression = Texture::Compression::eNONE;
+                if (!TextureCooker::Load(lImageFile, lTexture, lOptions))
                 {
-                    CRASH("Error ocurred during loading a '%s' PNG image!", lTexture.mName.c_str())
+                    CRASH("Error ocurred during loading a '%s' PNG image!", lImageFile.c_str())
                 }
 
                 mImageSize = glm::ivec2(lTexture.mWidth, lTexture.mHeight);
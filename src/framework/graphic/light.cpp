@@ -7,6 +7,7 @@ namespace Framework
 {
     bool Light::SetShadowMap(uint32_t aSizeX, uint32_t aSizeY)
     {
+        InvalidateShadowMap();
         if ( mShadowMap )
             return mShadowMap->SetSize(aSizeX, aSizeY);
         mShadowMap.reset(ShadowMapRenderTarget::New());
@@ -17,6 +18,7 @@ namespace Framework
 
     void Light::ClearShadowMap()
     {
+        InvalidateShadowMap();
         mShadowMap.reset();
     }
 
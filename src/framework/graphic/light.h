@@ -58,6 +58,26 @@ namespace Framework
         bool SetShadowMap(uint32_t aSizeX, uint32_t aSizeY);
         void ClearShadowMap();
 
+        /**
+         * State of the shadow map content. The renderer keeps the shadow map of the
+         * previous frames while neither the light nor the casters in its volume changed
+         */
+        struct ShadowMapCache
+        {
+            bool      mValid = false;
+            glm::mat4 mLightMatrix = glm::mat4(0.0f);    /**< Model matrix of the light when the map was rendered */
+            glm::mat4 mViewProjection = glm::mat4(0.0f); /**< View-projection matrix the map was rendered with */
+            size_t    mCasterCount = 0;                  /**< Number of casters drawn */
+            size_t    mCasterHash = 0;                   /**< Order independent hash of the casters drawn */
+            uint32_t  mStamp = 0;                        /**< Scene hierarchy stamp when the map was rendered */
+        };
+        mutable ShadowMapCache mShadowMapCache;
+
+        /**
+         * Forces a refresh of the shadow map on the next frame
+         */
+        void InvalidateShadowMap() const { mShadowMapCache.mValid = false; }
+
         /**
          * Debug information
          */
@@ -56,6 +56,56 @@ namespace Framework
         return mMatrixState == MatrixState::NotUpdated;
     }
 
+    bool Model3D::Raycast(const glm::vec3& aOrigin, const glm::vec3& aDirection, float& aDistance, glm::vec3& aNormal) const
+    {
+        if ( !mAsset || mAsset->GetTriangleHierarchy().IsEmpty() )
+            return false;
+
+        /* The ray is moved to model space without normalizing its direction, so the
+           distance along it is still measured in world units */
+        const glm::mat4 lInvModel = glm::inverse(GetModelMatrix());
+        const glm::vec3 lOrigin = glm::vec3(lInvModel * glm::vec4(aOrigin, 1.0f));
+        const glm::vec3 lDirection = glm::vec3(lInvModel * glm::vec4(aDirection, 0.0f));
+
+        glm::vec3 lNormal;
+        if ( !mAsset->GetTriangleHierarchy().Raycast(lOrigin, lDirection, aDistance, lNormal) )
+            return false;
+
+        aNormal = glm::normalize(glm::transpose(glm::mat3(lInvModel)) * lNormal);
+        return true;
+    }
+
+
+    void Model3D::SyncAsset() const
+    {
+        if ( !mAsset || mAssetRevision == mAsset->GetRevision() )
+            return;
+        mAssetRevision = mAsset->GetRevision();
+        mOOBBValid = false;
+        mBoundingVolumesValid = false;
+        RefitSpatialProxy();
+    }
+
+    uint32_t Model3D::UpdateLod(float aScreenRadius, float aMaxPixelError) const
+    {
+        /* Fraction of the limit the error of a coarser level must stay under */
+        static const float sHysteresis = 0.75f;
+
+        if ( !mAsset || aMaxPixelError <= 0.0f )
+        {
+            mLod = 0;
+            return mLod;
+        }
+
+        const uint32_t lLodCount = mAsset->GetLodCount();
+        uint32_t lLod = std::min(mLod, lLodCount - 1);
+        while ( lLod > 0 && mAsset->GetLodError(lLod) * aScreenRadius > aMaxPixelError )
+            --lLod;
+        while ( lLod + 1 < lLodCount && mAsset->GetLodError(lLod + 1) * aScreenRadius <= aMaxPixelError * sHysteresis )
+            ++lLod;
+        mLod = lLod;
+        return mLod;
+    }
 
     void Model3D::CalculateBoundingVolumes() const
     {
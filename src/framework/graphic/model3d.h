@@ -90,6 +90,7 @@ namespace Framework
             , mIsShadowCaster(true)
             , mIsShadowReceiver(true)
         {
+            mAssetRevision = mAsset ? mAsset->GetRevision() : 0;
         }
 
         /**
@@ -105,6 +106,18 @@ namespace Framework
         /* Adjust model position so that model's AABB is inside parent AABB */
         bool ConstrainPosition(const BoundingBox& aParentAABB);
 
+        /**
+         * Casts a world space ray against the triangles of the model
+         *
+         * @param aOrigin     Origin of the ray
+         * @param aDirection  Normalized direction of the ray
+         * @param aDistance   In: maximum distance of the hit. Out: distance of the hit
+         * @param aNormal     Out: world space normal of the hit triangle, facing the ray origin
+         *
+         * @return true if the model was hit closer than the given distance
+         */
+        bool Raycast(const glm::vec3& aOrigin, const glm::vec3& aDirection, float& aDistance, glm::vec3& aNormal) const;
+
         /**
          * Retrieves the model asset 3D
          *
@@ -115,6 +128,39 @@ namespace Framework
         operator const Asset3D*() { return mAsset.get(); }
         operator const Asset3D&() { return *mAsset; }
 
+        /**
+         * Indicates if the asset is uploaded to the renderer. A streamed asset is
+         * drawn as a placeholder box until then
+         *
+         * @return true if the model can be rendered
+         */
+        bool IsReady() const { return mAsset && mAsset->mRendererResources != nullptr; }
+
+        /**
+         * Recalculates the bounding volumes when the asset changed since they were
+         * calculated: the placeholder bounds of a streamed asset are only an estimation
+         * of the final ones, and a reloaded asset has new ones
+         */
+        void SyncAsset() const;
+
+        /**
+         * Level of detail of the asset drawn for this model, see Asset3D::GetLodCount()
+         */
+        uint32_t GetLod() const { return mAsset ? std::min(mLod, mAsset->GetLodCount() - 1) : 0; }
+
+        /**
+         * Picks the coarsest level of detail whose error stays under the given number
+         * of pixels. A finer level is taken as soon as the error is too large, but a
+         * coarser one only when its error is clearly under the limit, so a model near
+         * a switching distance does not change its level every frame
+         *
+         * @param aScreenRadius    Projected radius of the bounding sphere in pixels
+         * @param aMaxPixelError   Largest error allowed in pixels, 0 selects the full resolution
+         *
+         * @return The selected level of detail
+         */
+        uint32_t UpdateLod(float aScreenRadius, float aMaxPixelError) const;
+
         /**
          * Enables/disables this model as a shadow caster
          *
@@ -166,6 +212,8 @@ namespace Framework
         bool                      mRenderNormals;    /**< Enables normal rendering for this model */
         bool                      mIsShadowCaster;   /**< Indicates if this model is a shadow caster */
         bool                      mIsShadowReceiver; /**< Indicates if this model is a shadow receiver */
+        mutable uint32_t          mAssetRevision = 0; /**< Revision of the asset when the bounding volumes were calculated */
+        mutable uint32_t          mLod = 0;          /**< Level of detail selected by the renderer */
     };
 
 }
@@ -14,6 +14,8 @@
 
 #include "precompiled.h"
 #include "graphic/opengl/opengl_noaarendertarget.h"
+#include "graphic/null/null_rendertarget.h"
+#include "graphic/renderer.h"
 
 namespace Framework
 {
@@ -28,6 +30,10 @@ namespace Framework
     }
 
     NoAARenderTarget *NoAARenderTarget::New()
-    { return new OpenGLNoAARenderTarget(); }
+    {
+        if ( Renderer::GetBackend() == Renderer::Backend::eNULL )
+            return new NullNoAARenderTarget();
+        return new OpenGLNoAARenderTarget();
+    }
 }
 
@@ -0,0 +1,102 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Command stream recorded by the null render backend
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "graphic/null/null_commandstream.h"
+
+namespace Framework
+{
+    CommandStream* CommandStream::sActive = nullptr;
+
+    void CommandStream::Record(Type aType, uint32_t aId, uint32_t aValue)
+    {
+        mCommands.push_back(Command{ aType, aId, aValue });
+        switch ( aType )
+        {
+            case Type::eDRAW:
+            case Type::eDRAW_TEXT:
+            case Type::eDRAW_INSTANCED:
+                ++mCounters.mDraws;
+                break;
+            case Type::eBIND_SHADER:
+            case Type::eBIND_TEXTURE:
+            case Type::eBIND_TARGET:
+            case Type::eBIND_UNIFORM_BLOCK:
+                ++mCounters.mBinds;
+                break;
+            case Type::eSET_UNIFORM:
+                ++mCounters.mUniformSets;
+                break;
+            case Type::eSET_STATE:
+                ++mCounters.mStateChanges;
+                break;
+            case Type::eUPLOAD:
+                mCounters.mBytesUploaded += aValue;
+                break;
+            default:
+                break;
+        }
+    }
+
+    void CommandStream::Clear()
+    {
+        mCommands.clear();
+        mCounters = Counters();
+    }
+
+    CommandStream::Difference CommandStream::Diff(const CommandStream& aBase, const CommandStream& aOther)
+    {
+        Difference lDiff;
+        const size_t n = std::min(aBase.mCommands.size(), aOther.mCommands.size());
+        lDiff.mFirstMismatch = n;
+        for ( size_t i = 0; i < n; ++i )
+        {
+            if ( aBase.mCommands[i] != aOther.mCommands[i] )
+            {
+                lDiff.mFirstMismatch = i;
+                break;
+            }
+        }
+        lDiff.mEqual = lDiff.mFirstMismatch == n && aBase.mCommands.size() == aOther.mCommands.size();
+
+        const Counters& a = aBase.mCounters;
+        const Counters& b = aOther.mCounters;
+        lDiff.mCommands = int64_t(aOther.mCommands.size()) - int64_t(aBase.mCommands.size());
+        lDiff.mDraws = int64_t(b.mDraws) - int64_t(a.mDraws);
+        lDiff.mBinds = int64_t(b.mBinds) - int64_t(a.mBinds);
+        lDiff.mUniformSets = int64_t(b.mUniformSets) - int64_t(a.mUniformSets);
+        lDiff.mStateChanges = int64_t(b.mStateChanges) - int64_t(a.mStateChanges);
+        lDiff.mBytesUploaded = int64_t(b.mBytesUploaded) - int64_t(a.mBytesUploaded);
+        return lDiff;
+    }
+
+    std::string CommandStream::Difference::ToString() const
+    {
+        if ( mEqual )
+            return "equal";
+        char lBuffer[256];
+        snprintf(lBuffer, sizeof(lBuffer),
+                 "first mismatch at command %zu, commands %+lld, draws %+lld, binds %+lld, uniform sets %+lld, state changes %+lld, bytes uploaded %+lld",
+                 mFirstMismatch, (long long)mCommands, (long long)mDraws, (long long)mBinds,
+                 (long long)mUniformSets, (long long)mStateChanges, (long long)mBytesUploaded);
+        return lBuffer;
+    }
+
+    uint32_t CommandStream::HashName(const std::string& aName)
+    {
+        // FNV-1a
+        uint32_t lHash = 2166136261u;
+        for ( char c : aName )
+        {
+            lHash ^= static_cast<uint8_t>(c);
+            lHash *= 16777619u;
+        }
+        return lHash;
+    }
+}
@@ -0,0 +1,113 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Command stream recorded by the null render backend. Every call the
+ *                null renderer, shaders, render targets, uniform blocks and font
+ *                renderer receive is stored as a compact fixed size command, and the
+ *                draws, binds, uniform sets and uploaded bytes are counted. Two
+ *                streams can be compared to find out where and how much a frame changed.
+ *******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+namespace Framework
+{
+    class CommandStream
+    {
+    public:
+        enum class Type : uint8_t
+        {
+            eDRAW,            /**< id: object drawn, value: elements */
+            eDRAW_TEXT,       /**< id: target, value: glyphs */
+            eBIND_SHADER,     /**< id: program, 0 when detached */
+            eBIND_TEXTURE,    /**< id: texture, value: unit */
+            eBIND_TARGET,     /**< id: render target, 0 when unbound */
+            eBIND_UNIFORM_BLOCK,
+            eSET_UNIFORM,     /**< id: hash of the uniform name, value: bytes */
+            eSET_STATE,       /**< id: state, value: new value */
+            eCLEAR,           /**< id: render target */
+            eBLIT,            /**< id: render target, value: pixels */
+            eUPLOAD,          /**< id: object, value: bytes */
+            eDRAW_INSTANCED   /**< id: first object drawn, value: instances */
+        };
+
+        struct Command
+        {
+            Type     mType;
+            uint32_t mId;
+            uint32_t mValue;
+
+            bool operator==(const Command& aOther) const
+            {
+                return mType == aOther.mType && mId == aOther.mId && mValue == aOther.mValue;
+            }
+            bool operator!=(const Command& aOther) const { return !(*this == aOther); }
+        };
+
+        struct Counters
+        {
+            uint32_t mDraws = 0;
+            uint32_t mBinds = 0;          /**< Shader, texture, render target and uniform block binds */
+            uint32_t mUniformSets = 0;
+            uint32_t mStateChanges = 0;
+            uint64_t mBytesUploaded = 0;  /**< Vertex, texture and uniform block data */
+        };
+
+        /**
+         * Result of the comparison of two streams. The counters are the
+         * difference of the second stream minus the first one
+         */
+        struct Difference
+        {
+            bool     mEqual = true;
+            size_t   mFirstMismatch = 0;  /**< Index of the first different command */
+            int64_t  mCommands = 0;
+            int64_t  mDraws = 0;
+            int64_t  mBinds = 0;
+            int64_t  mUniformSets = 0;
+            int64_t  mStateChanges = 0;
+            int64_t  mBytesUploaded = 0;
+
+            std::string ToString() const;
+        };
+
+        void Record(Type aType, uint32_t aId, uint32_t aValue = 0);
+        void Clear();
+
+        const std::vector<Command>& GetCommands() const { return mCommands; }
+        const Counters&             GetCounters() const { return mCounters; }
+
+        static Difference Diff(const CommandStream& aBase, const CommandStream& aOther);
+
+        /**
+         * Stream the null backend objects record into. Nothing is recorded
+         * while there is no active stream
+         */
+        static CommandStream* GetActive()                       { return sActive; }
+        static void           SetActive(CommandStream* aStream) { sActive = aStream; }
+
+        /**
+         * Records into the active stream, if any
+         */
+        static void RecordActive(Type aType, uint32_t aId, uint32_t aValue = 0)
+        {
+            if ( sActive )
+                sActive->Record(aType, aId, aValue);
+        }
+
+        static uint32_t HashName(const std::string& aName);
+
+    private:
+        std::vector<Command> mCommands;
+        Counters             mCounters;
+
+        static CommandStream* sActive;
+    };
+}
@@ -0,0 +1,30 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Font renderer of the null render backend
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "graphic/null/null_fontrenderer.h"
+#include "graphic/null/null_commandstream.h"
+
+namespace Framework
+{
+    bool NullFontRenderer::SetFont(std::shared_ptr<const TrueTypeFont> aFont)
+    {
+        BuildAtlas(std::move(aFont));
+        CommandStream::RecordActive(CommandStream::Type::eUPLOAD, CommandStream::HashName("Glyph atlas"),
+                                    mAtlas.GetWidth() * mAtlas.GetHeight());
+        return true;
+    }
+
+    void NullFontRenderer::DrawBatch(const GlyphVertex* aVertices, uint32_t aQuads, RenderTarget& aTarget) const
+    {
+        const uint32_t lTarget = CommandStream::HashName(aTarget.GetName());
+        CommandStream::RecordActive(CommandStream::Type::eUPLOAD, lTarget, aQuads * 4 * sizeof(GlyphVertex));
+        CommandStream::RecordActive(CommandStream::Type::eDRAW_TEXT, lTarget, aQuads);
+    }
+}
@@ -0,0 +1,26 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Font renderer of the null render backend. The text is measured with
+ *                the font like in the other backends, rendering it is recorded into
+ *                the active command stream
+ *******************************************************************************/
+
+#pragma once
+
+#include "graphic/fontrender.h"
+
+namespace Framework
+{
+    class NullFontRenderer : public FontRenderer
+    {
+      public:
+        bool SetFont(std::shared_ptr<const TrueTypeFont> aFont) override;
+
+      protected:
+        void DrawBatch(const GlyphVertex* aVertices, uint32_t aQuads, RenderTarget& aTarget) const override;
+    };
+}
@@ -0,0 +1,383 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Null renderer
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "graphic/null/null_renderer.h"
+#include "graphic/null/null_shader.h"
+
+namespace Framework
+{
+    namespace
+    {
+        /**
+         * Ids of the render states in the eSET_STATE commands
+         */
+        enum eState
+        {
+            eSTATE_RESET = 1,
+            eSTATE_DEPTH_TEST,
+            eSTATE_DEPTH_WRITE,
+            eSTATE_ADDITIVE_BLENDING,
+            eSTATE_CULL_FRONT_FACES,
+            eSTATE_POLYGON_FILL,
+            eSTATE_DRAW_BUFFERS,
+            eSTATE_WIREFRAME
+        };
+
+        /**
+         * Renderer resources of the null backend: fake ids of the textures of the rendering lists
+         */
+        class NullResources : public RendererResources
+        {
+        public:
+            std::vector<uint32_t> mTexturesIDs;
+        };
+
+        uint32_t NextTextureId()
+        {
+            static uint32_t sNextId = 1;
+            return sNextId++;
+        }
+
+        template <class AssetT>
+        uint32_t TexturesSize(const AssetT& aAsset)
+        {
+            size_t lBytes = 0;
+            for ( const auto& lTexture : aAsset.GetTextures() )
+                lBytes += lTexture.mPixels.size();
+            return static_cast<uint32_t>(lBytes);
+        }
+
+        inline uint32_t ModelId(const Object* aObject)
+        {
+            const Model* lModel = dynamic_cast<const Model*>(aObject);
+            return lModel ? lModel->GetId() : 0;
+        }
+
+        inline void Draw(uint32_t aId, uint32_t aElements)
+        {
+            CommandStream::RecordActive(CommandStream::Type::eDRAW, aId, aElements);
+        }
+
+        inline void SetState(uint32_t aState, uint32_t aValue)
+        {
+            CommandStream::RecordActive(CommandStream::Type::eSET_STATE, aState, aValue);
+        }
+
+        /**
+         * Geometry pass state of the render queue items, see OpenGLRenderer
+         */
+        class GPassQueueBackend : public RenderQueueBackend
+        {
+        public:
+            void BindShader(const Shader* aShader) override
+            {
+                if ( mShader )
+                    mShader->Detach();
+                mShader = aShader;
+                mShader->Attach();
+                mModelMatrix = mShader->GetUniformHandle("u_ModelMatrix");
+                mModelId = mShader->GetUniformHandle("u_modelId");
+                mLightingFlag = mShader->GetUniformHandle("u_lightingFlag");
+                mInstanced = mShader->GetUniformHandle("u_instanced");
+                mShader->SetUniformTexture2D(mShader->GetUniformHandle("u_diffuseMap"), 0);
+                mShader->SetUniformBool(mInstanced, false);
+            }
+
+            void BindMaterial(uint32_t aMaterial) override
+            {
+                mShader->SetUniformFloat(mLightingFlag, aMaterial ? 2.0f : 1.0f);
+            }
+
+            void BindTexture(uint32_t aTexture) override
+            {
+                if ( aTexture )
+                    CommandStream::RecordActive(CommandStream::Type::eBIND_TEXTURE, aTexture, 0);
+            }
+
+            void BindMesh(const Asset3D* aMesh) override
+            {
+                mMesh = aMesh;
+            }
+
+            void BindObject(const Model3D* aModel) override
+            {
+                mShader->SetUniformMat4(mModelMatrix, &aModel->GetModelMatrix());
+                mShader->SetUniformVec3(mModelId, glm::vec3(float(aModel->GetId())));
+            }
+
+            void Draw(const Model3D* aModel, uint32_t aSubmesh) override
+            {
+                Framework::Draw(aModel->GetId(), mMesh->GetIndicesCount(aModel->GetLod())[aSubmesh]);
+            }
+
+            void DrawInstanced(const Model3D* const* aModels, uint32_t aCount, uint32_t aSubmesh, uint32_t aLod) override
+            {
+                // A matrix and a model id per instance, as the OpenGL backend streams them
+                CommandStream::RecordActive(CommandStream::Type::eUPLOAD, 0, aCount * (sizeof(glm::mat4) + sizeof(glm::vec3)));
+                mShader->SetUniformBool(mInstanced, true);
+                CommandStream::RecordActive(CommandStream::Type::eDRAW_INSTANCED, aModels[0]->GetId(), aCount);
+                mShader->SetUniformBool(mInstanced, false);
+            }
+
+            void End()
+            {
+                if ( mShader )
+                    mShader->Detach();
+            }
+
+        private:
+            const Shader*         mShader = nullptr;
+            const Asset3D*        mMesh = nullptr;
+            Shader::UniformHandle mModelMatrix = Shader::sInvalidUniform;
+            Shader::UniformHandle mModelId = Shader::sInvalidUniform;
+            Shader::UniformHandle mLightingFlag = Shader::sInvalidUniform;
+            Shader::UniformHandle mInstanced = Shader::sInvalidUniform;
+        };
+    }
+
+    NullRenderer::NullRenderer()
+    {
+        CommandStream::SetActive(&mCommandStream);
+    }
+
+    NullRenderer::~NullRenderer()
+    {
+        if ( CommandStream::GetActive() == &mCommandStream )
+            CommandStream::SetActive(nullptr);
+    }
+
+    Shader* NullRenderer::NewShader(const std::string& aName) const
+    { return new NullShader(aName); }
+
+    bool NullRenderer::PrepareForRendering(Asset2D& aAsset) const
+    {
+        if ( aAsset.mRendererResources )
+            return true;
+        const uint32_t lBytes = static_cast<uint32_t>(aAsset.GetVertexData().size() * sizeof(Asset2D::VertexData)) + TexturesSize(aAsset);
+        CommandStream::RecordActive(CommandStream::Type::eUPLOAD, CommandStream::HashName(aAsset.GetName()), lBytes);
+        auto lResources = std::make_unique<NullResources>();
+        for ( size_t i = 0; i < aAsset.GetTextures().size(); ++i )
+            lResources->mTexturesIDs.push_back(NextTextureId());
+        aAsset.mRendererResources = std::move(lResources);
+        aAsset.RenderReady();
+        return true;
+    }
+
+    bool NullRenderer::PrepareForRendering(Asset3D& aAsset) const
+    {
+        if ( aAsset.mRendererResources )
+            return true;
+        const uint32_t lBytes = static_cast<uint32_t>(aAsset.GetUploadSize());
+        CommandStream::RecordActive(CommandStream::Type::eUPLOAD, CommandStream::HashName(aAsset.GetName()), lBytes);
+        auto lResources = std::make_unique<NullResources>();
+        for ( size_t i = 0; i < aAsset.GetTextures().size(); ++i )
+            lResources->mTexturesIDs.push_back(NextTextureId());
+        aAsset.mRendererResources = std::move(lResources);
+        aAsset.RenderReady();
+        return true;
+    }
+
+    void NullRenderer::RenderShadowMapQuad(const glm::vec2& aQuadOffset, const glm::vec2& aQuadScale, const Camera* aCamera, RenderTarget* aShadowMap, RenderTarget* aRenderTarget) const
+    {
+        BindTexture(0, aShadowMap->GetTextureId(GL_DEPTH_ATTACHMENT));
+        DrawScreenQuad();
+    }
+
+    void NullRenderer::RenderTexturedQuad(const Model2D &aModel, const glm::vec2& aImageOffset, const glm::vec2& aImageScale) const
+    {
+        Draw(aModel.GetId(), 4);
+    }
+
+    void NullRenderer::RenderModel2D(const Model2D &aModel, const glm::mat4& aViewProjectionMatrix, const Shader *aShader,
+        uint32_t aFlags) const
+    {
+        const NullResources* lRes = static_cast<const NullResources*>(aModel.GetAsset2D()->mRendererResources.get());
+        aShader->Attach();
+        const glm::mat4 lModelViewProjectionMatrix = aViewProjectionMatrix * aModel.GetModelMatrix();
+        aShader->SetUniformMat4("u_MVPMatrix", &lModelViewProjectionMatrix);
+        aShader->SetUniformTexture2D("u_shapeMap", 0);
+        aShader->SetUniformTexture2D("u_overlayMap", 1);
+        aShader->SetUniformBool("u_useOverlayMap", lRes->mTexturesIDs.size() > 1);
+        aShader->SetUniformVec3("u_modelId", glm::vec3(0.0f));
+        for ( size_t i = 0; i < lRes->mTexturesIDs.size(); ++i )
+            BindTexture(static_cast<uint32_t>(i), lRes->mTexturesIDs[i]);
+        Draw(aModel.GetId(), 4);
+        aShader->Detach();
+
+        if ( aFlags & (RENDER_MODEL__RENDER_FOCUSED_FLAG | RENDER_MODEL__RENDER_SELECTED_FLAG) )
+            RenderModelWireframe(&aModel, lModelViewProjectionMatrix, glm::vec4(1.0f));
+    }
+
+    void NullRenderer::RenderModelWireframe(const Object* aModel, const glm::mat4& aModelViewProjectionMatrix, const glm::vec4 &aColor) const
+    {
+        SetState(eSTATE_WIREFRAME, 1);
+        const Model3D* lModel3D = dynamic_cast<const Model3D*>(aModel);
+        if ( lModel3D )
+            RenderModel3D_core(*lModel3D, RENDER_MODEL__NO_MATERIAL_FLAG);
+        else
+            Draw(ModelId(aModel), 4);
+        SetState(eSTATE_WIREFRAME, 0);
+    }
+
+    void NullRenderer::RenderModel3D_core(const Model3D& aModel, uint32_t aFlags) const
+    {
+        const NullResources* lRes = static_cast<const NullResources*>(aModel.GetAsset3D()->mRendererResources.get());
+        auto& lCounts = aModel.GetAsset3D()->GetIndicesCount(aModel.GetLod());
+        for ( size_t i = 0; i < lCounts.size(); ++i )
+        {
+            if ( !(lRes->mTexturesIDs.empty() || (aFlags & RENDER_MODEL__NO_MATERIAL_FLAG)) )
+                CommandStream::RecordActive(CommandStream::Type::eBIND_TEXTURE, lRes->mTexturesIDs[i], 0);
+            Draw(aModel.GetId(), lCounts[i]);
+        }
+    }
+
+    void NullRenderer::RenderModel3D(const Model3D &aModel, const Camera &aCamera, const Shader *aShader,
+        uint32_t aFlags, const LightingInfo& aLightingInfo) const
+    {
+        aShader->Attach();
+        const glm::mat4 lModelViewProjectionMatrix = aCamera.GetProjectionMatrix() * aCamera.GetViewMatrix() * aModel.GetModelMatrix();
+        aShader->SetUniformMat4("u_MVPMatrix", &lModelViewProjectionMatrix);
+        aShader->SetUniformMat4("u_modelMatrix", &aModel.GetModelMatrix());
+        RenderModel3D_core(aModel, aFlags);
+        aShader->Detach();
+    }
+
+    void NullRenderer::RenderModel3D_GPass(const Model3D &aModel, const glm::mat4& aModelViewProjectionMatrix, const Shader *aShader,
+        uint32_t aFlags, const LightingInfo& aLightingInfo) const
+    {
+        aShader->Attach();
+        aShader->SetUniformMat4("u_ModelMatrix", &aModel.GetModelMatrix());
+        aShader->SetUniformTexture2D("u_diffuseMap", 0);
+        aShader->SetUniformVec3("u_modelId", glm::vec3(float(aModel.GetId())));
+        aShader->SetUniformFloat("u_lightingFlag", aModel.IsShadowReceiver() ? 2.0f : 1.0f);
+        RenderModel3D_core(aModel, 0);
+
+        if ( aFlags & (RENDER_MODEL__RENDER_FOCUSED_FLAG | RENDER_MODEL__RENDER_SELECTED_FLAG) )
+            RenderModel3DWireframe_GPass(aModel, aModelViewProjectionMatrix, glm::vec4(1.0f));
+
+        aShader->Detach();
+    }
+
+    void NullRenderer::RenderModel3DWireframe_GPass(const Model3D &aModel, const glm::mat4 &aModelViewProjectionMatrix, const glm::vec4 &aColor) const
+    {
+        RenderModelWireframe(&aModel, aModelViewProjectionMatrix, aColor);
+    }
+
+    void NullRenderer::QueueModel3D_GPass(RenderQueue& aQueue, const Model3D& aModel, const Shader* aShader, float aDepth) const
+    {
+        const Asset3D* lAsset = aModel.GetAsset3D();
+        const NullResources* lRes = static_cast<const NullResources*>(lAsset->mRendererResources.get());
+        const size_t n = lAsset->GetIndicesOffsets().size();
+        const uint32_t lMaterial = aModel.IsShadowReceiver() ? 1 : 0;
+        const uint32_t lLod = aModel.GetLod();
+        auto& lCounts = lAsset->GetIndicesCount(lLod);
+        for ( size_t i = 0; i < n; ++i )
+        {
+            if ( lCounts[i] == 0 )
+                continue;
+            aQueue.Add(RenderQueue::ePASS_OPAQUE, aShader, lMaterial, lRes->mTexturesIDs.empty() ? 0 : lRes->mTexturesIDs[i],
+                       lAsset, aDepth, &aModel, static_cast<uint32_t>(i), lLod);
+        }
+    }
+
+    void NullRenderer::SubmitQueue_GPass(RenderQueue& aQueue) const
+    {
+        GPassQueueBackend lBackend;
+        aQueue.Submit(lBackend);
+        lBackend.End();
+    }
+
+    void NullRenderer::UpdateFrameData(const Camera& aCamera, const glm::vec2& aScreenSize, const Shader* aShader) const
+    {
+        // std140 layout of the FrameData block, see OpenGLRenderer::UpdateFrameData
+        struct FrameData
+        {
+            glm::mat4 mViewMatrix;
+            glm::mat4 mProjectionMatrix;
+            glm::mat4 mViewProjectionMatrix;
+            glm::vec4 mCameraPosition;
+            glm::vec4 mScreenSize;
+        };
+        CommandStream::RecordActive(CommandStream::Type::eBIND_UNIFORM_BLOCK, CommandStream::HashName("FrameData"));
+        CommandStream::RecordActive(CommandStream::Type::eUPLOAD, CommandStream::HashName("FrameData"), sizeof(FrameData));
+    }
+
+    void NullRenderer::ResetRenderState() const                { SetState(eSTATE_RESET, 1); }
+    void NullRenderer::SetDepthTest(bool aEnable) const        { SetState(eSTATE_DEPTH_TEST, aEnable); }
+    void NullRenderer::SetDepthWrite(bool aEnable) const       { SetState(eSTATE_DEPTH_WRITE, aEnable); }
+    void NullRenderer::SetAdditiveBlending(bool aEnable) const { SetState(eSTATE_ADDITIVE_BLENDING, aEnable); }
+    void NullRenderer::SetCullFrontFaces(bool aFront) const    { SetState(eSTATE_CULL_FRONT_FACES, aFront); }
+    void NullRenderer::SetPolygonFill() const                  { SetState(eSTATE_POLYGON_FILL, 1); }
+    void NullRenderer::SetDrawBuffers(uint32_t aCount) const   { SetState(eSTATE_DRAW_BUFFERS, aCount); }
+
+    void NullRenderer::BindTexture(uint32_t aUnit, uint32_t aTexture, bool aNearest) const
+    {
+        CommandStream::RecordActive(CommandStream::Type::eBIND_TEXTURE, aTexture, aUnit);
+    }
+
+    void NullRenderer::DrawScreenQuad() const
+    {
+        Draw(0, 4);
+    }
+
+    void NullRenderer::RenderTransformGizmo(uint32_t aGizmoType, const Object *aModel, const Camera &aCamera) const
+    {
+        Draw(ModelId(aModel), 1);
+    }
+
+    void NullRenderer::RenderGrid2D(float aStep, const glm::vec4 &aColor, float aLineWidth, const Camera &aCamera) const
+    {
+        Draw(0, 1);
+    }
+
+    void NullRenderer::RenderGrid3D(float aStep, float aSize, const glm::vec4& aColor, float aLineWidth, const Camera& aCamera) const
+    {
+        Draw(0, 1);
+    }
+
+    void NullRenderer::RenderLight(const Light &aLight, const Camera &aCamera, uint32_t aLightNumber) const
+    {
+        CommandStream::RecordActive(CommandStream::Type::eUPLOAD, aLightNumber, sizeof(glm::vec3));
+        Draw(aLightNumber, 1);
+    }
+
+    void NullRenderer::RenderLights(std::vector<const Light*> &aLights, const Camera &aCamera) const
+    {
+        uint32_t i = 0;
+        for ( const auto lLight : aLights )
+            RenderLight(*lLight, aCamera, i++);
+    }
+
+    void NullRenderer::RenderBoundingBox(const BoundingBox &aBox, const glm::mat4 &aModelViewProjectionMatrix, const glm::vec4 &aColor) const
+    {
+        Draw(0, 1);
+    }
+
+    void NullRenderer::RenderBoundingSphere(const BoundingSphere &aSphere, const glm::vec3 &aCenter, const glm::vec4 &aColor, const Camera &aCamera) const
+    {
+        Draw(0, 1);
+    }
+
+    void NullRenderer::RenderBoundingVolumes(const Object3D &aObject, const Camera &aCamera, bool aShowSphere, bool aShowAABB,
+        bool aShowOOBB) const
+    {
+        if ( aShowSphere )
+            RenderBoundingSphere(aObject.GetBoundingSphere(), aObject.GetPosition(), glm::vec4(1.0f), aCamera);
+        if ( aShowAABB )
+            RenderBoundingBox(aObject.GetAABB(), glm::mat4(1.0f), glm::vec4(1.0f));
+        if ( aShowOOBB )
+            RenderBoundingBox(aObject.GetOOBB(), glm::mat4(1.0f), glm::vec4(1.0f));
+    }
+
+    void NullRenderer::RenderModelNormals(const Model3D &aModel, const glm::mat4 &aModelViewProjectionMatrix, float aNormalSize) const
+    {
+        RenderModel3D_core(aModel, RENDER_MODEL__NO_MATERIAL_FLAG);
+    }
+}
@@ -0,0 +1,88 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Null renderer. It runs the scene rendering routines of the Renderer
+ *                without a graphic API: every draw, bind, uniform set, state change
+ *                and upload is recorded into its command stream. It is used to measure
+ *                the CPU cost and the draw count of a frame on machines without a GPU
+ *******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "graphic/renderer.h"
+#include "graphic/null/null_commandstream.h"
+
+namespace Framework
+{
+    class NullRenderer : public Renderer
+    {
+      public:
+        NullRenderer();
+        ~NullRenderer() override;
+
+        /**
+         * Stream of the commands recorded since the last Clear()
+         */
+        CommandStream&       GetCommandStream()       { return mCommandStream; }
+        const CommandStream& GetCommandStream() const { return mCommandStream; }
+
+        /**
+         * Renderer methods
+         */
+        bool        Init(void) override { return true; }
+        const char* GetName() const override          { return "Null renderer"; }
+        const char* GetVersion() const override       { return "1.0"; }
+        const char* GetVendor() const override        { return "none"; }
+        const char* GetShaderVersion() const override { return "none"; }
+
+        Shader*     NewShader(const std::string& aName) const override;
+        bool        PrepareForRendering(Asset2D& aAsset) const override;
+        bool        PrepareForRendering(Asset3D& aAsset) const override;
+
+        void        RenderShadowMapQuad(const glm::vec2& aQuadOffset, const glm::vec2& aQuadScale, const Camera* aCamera, RenderTarget* aShadowMap, RenderTarget* aRenderTarget) const override;
+        void        RenderTexturedQuad(const Model2D &aModel, const glm::vec2& aImageOffset, const glm::vec2& aImageScale) const override;
+        void        RenderModel2D(const Model2D &aModel, const glm::mat4& aViewProjectionMatrix, const Shader *aShader,
+                                  uint32_t aFlags) const override;
+        void        RenderModelWireframe(const Object* aModel, const glm::mat4& aViewProjectionMatrix, const glm::vec4 &aColor) const override;
+        void        RenderModel3D_core(const Model3D& aModel, uint32_t aFlags) const override;
+        void        RenderModel3D(const Model3D &aModel, const Camera &aCamera, const Shader *aShader,
+                                  uint32_t aFlags, const LightingInfo& aLightingInfo) const override;
+        void        RenderModel3D_GPass(const Model3D &aModel, const glm::mat4& aModelViewProjectionMatrix, const Shader *aShader,
+                                        uint32_t aFlags, const LightingInfo& aLightingInfo) const override;
+
+    protected:
+        void RenderModel3DWireframe_GPass(const Model3D &aModel, const glm::mat4& aModelViewProjectionMatrix, const glm::vec4 &aColor) const override;
+        void QueueModel3D_GPass(RenderQueue& aQueue, const Model3D& aModel, const Shader* aShader, float aDepth) const override;
+        void SubmitQueue_GPass(RenderQueue& aQueue) const override;
+        void UpdateFrameData(const Camera& aCamera, const glm::vec2& aScreenSize, const Shader* aShader) const override;
+
+        void ResetRenderState() const override;
+        void SetDepthTest(bool aEnable) const override;
+        void SetDepthWrite(bool aEnable) const override;
+        void SetAdditiveBlending(bool aEnable) const override;
+        void SetCullFrontFaces(bool aFront) const override;
+        void SetPolygonFill() const override;
+        void SetDrawBuffers(uint32_t aCount) const override;
+        void BindTexture(uint32_t aUnit, uint32_t aTexture, bool aNearest = false) const override;
+        void DrawScreenQuad() const override;
+    public:
+
+        void        RenderTransformGizmo(uint32_t aGizmoType, const Object *aModel, const Camera &aCamera) const override;
+        void        RenderGrid2D(float aStep, const glm::vec4 &aColor, float aLineWidth, const Camera &aCamera) const override;
+        void        RenderGrid3D(float aStep, float aSize, const glm::vec4& aColor, float aLineWidth, const Camera& aCamera) const override;
+        void        RenderLight(const Light &aLight, const Camera &aCamera, uint32_t aLightNumber) const override;
+        void        RenderLights(std::vector<const Light*> &aLights, const Camera &aCamera) const override;
+        void        RenderBoundingBox(const BoundingBox &aBox, const glm::mat4 &aModelViewProjectionMatrix, const glm::vec4 &aColor) const override;
+        void        RenderBoundingSphere(const BoundingSphere &aSphere, const glm::vec3 &aCenter, const glm::vec4 &aColor, const Camera &aCamera) const override;
+        void        RenderBoundingVolumes(const Object3D &aObject, const Camera &aCamera, bool aShowSphere = true, bool aShowAABB = true, bool aShowOOBB = true) const override;
+        void        RenderModelNormals(const Model3D &aModel, const glm::mat4 &aModelViewProjectionMatrix, float aNormalSize) const override;
+        void        Flush() override {}
+
+      private:
+        CommandStream mCommandStream;
+    };
+}
@@ -0,0 +1,101 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Render targets of the null render backend
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "graphic/null/null_rendertarget.h"
+#include "graphic/null/null_commandstream.h"
+
+namespace Framework
+{
+    namespace
+    {
+        // Ids of the render targets and of their attachments, never 0
+        uint32_t NextId()
+        {
+            static uint32_t sNextId = 1;
+            return sNextId++;
+        }
+    }
+
+    NullRenderTarget::NullRenderTarget()
+        : mTargetId(NextId())
+    {
+    }
+
+    bool NullRenderTarget::Init(uint32_t aWidth, uint32_t aHeight, const void* aParams)
+    {
+        if ( !aParams )
+            return false; // Invalid parameter
+        if ( mSize.x )
+            return false; // Already initialized
+
+        mAttachments = *reinterpret_cast<const RenderTarget::Attachments*>(aParams);
+        mNumColorBuffers = mNumDepthBuffers = mNumStencilBuffers = 0;
+        for ( auto& lAttachment : mAttachments )
+        {
+            if ( lAttachment.first == GL_DEPTH_ATTACHMENT )
+                ++mNumDepthBuffers;
+            else if ( lAttachment.first == GL_STENCIL_ATTACHMENT )
+                ++mNumStencilBuffers;
+            else if ( lAttachment.first == GL_DEPTH_STENCIL_ATTACHMENT )
+            {
+                ++mNumDepthBuffers;
+                ++mNumStencilBuffers;
+            }
+            else
+                ++mNumColorBuffers;
+            lAttachment.second.Id = NextId();
+        }
+        return SetSize(aWidth, aHeight);
+    }
+
+    bool NullRenderTarget::SetSize(uint32_t aWidth, uint32_t aHeight)
+    {
+        mSize = glm::uvec2(aWidth, aHeight);
+        return true;
+    }
+
+    void NullRenderTarget::BindForDrawning() const
+    {
+        CommandStream::RecordActive(CommandStream::Type::eBIND_TARGET, mTargetId);
+    }
+
+    void NullRenderTarget::BindForReading() const
+    {
+        CommandStream::RecordActive(CommandStream::Type::eBIND_TARGET, mTargetId);
+    }
+
+    void NullRenderTarget::Unbind() const
+    {
+        CommandStream::RecordActive(CommandStream::Type::eBIND_TARGET, 0);
+    }
+
+    void NullRenderTarget::Blit(uint32_t aDstX, uint32_t aDstY, uint32_t aWidth, uint32_t aHeight, uint32_t srcColorBufferIndex, bool dstIsMainFB) const
+    {
+        CommandStream::RecordActive(CommandStream::Type::eBLIT, mTargetId, aWidth * aHeight);
+    }
+
+    void NullRenderTarget::Clear(uint32_t aMask) const
+    {
+        CommandStream::RecordActive(CommandStream::Type::eCLEAR, mTargetId, aMask);
+    }
+
+    uint32_t NullRenderTarget::GetTextureId(uint32_t aAttachment) const
+    {
+        if ( !aAttachment )
+        { // default
+            if ( mNumColorBuffers )
+                aAttachment = GL_COLOR_ATTACHMENT0;
+            else if ( mNumDepthBuffers )
+                aAttachment = mNumStencilBuffers ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+        }
+        const auto lAttachment = mAttachments.find(aAttachment);
+        return lAttachment != mAttachments.end() ? lAttachment->second.Id : 0;
+    }
+}
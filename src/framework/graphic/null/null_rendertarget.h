@@ -0,0 +1,50 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Render targets of the null render backend. They own no buffers,
+ *                the attachments only get a fake id so the callers can tell them
+ *                apart. Binding, clearing and blitting is recorded into the active
+ *                command stream
+ *******************************************************************************/
+
+#pragma once
+
+#include "graphic/rendertarget.h"
+#include "graphic/noaarendertarget.h"
+#include "graphic/shadowmaprendertarget.h"
+
+#pragma warning(disable : 4250)
+
+namespace Framework
+{
+    class NullRenderTarget : public virtual RenderTarget
+    {
+      public:
+        NullRenderTarget();
+
+        bool Init(uint32_t aWidth, uint32_t aHeight, const void* aParams = nullptr) override;
+        bool SetSize(uint32_t aWidth, uint32_t aHeight) override;
+        void BindForDrawning() const override;
+        void BindForReading() const override;
+        void Unbind() const override;
+        void Blit(uint32_t aDstX, uint32_t aDstY, uint32_t aWidth, uint32_t aHeight, uint32_t srcColorBufferIndex = 0, bool dstIsMainFB = true) const override;
+        void Clear(uint32_t aMask = 0/*all available*/) const override;
+
+        uint32_t GetTextureId(uint32_t aAttachment = 0/*default: color0 or depth buffer*/) const override;
+        uint32_t GetColor(uint32_t x, uint32_t y, uint32_t colorBufferIndex) const override { return 0; }
+
+      protected:
+        uint32_t mTargetId;
+    };
+
+    class NullNoAARenderTarget : public NoAARenderTarget, public NullRenderTarget
+    {
+    };
+
+    class NullShadowMapRenderTarget : public ShadowMapRenderTarget, public NullRenderTarget
+    {
+    };
+}
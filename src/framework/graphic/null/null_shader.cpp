@@ -0,0 +1,131 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Shader of the null render backend
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "graphic/null/null_shader.h"
+#include "graphic/null/null_commandstream.h"
+
+namespace Framework
+{
+    NullShader::NullShader(const std::string& aName)
+        : Shader(aName)
+    {
+        static uint32_t sNextProgramID = 1;
+        mProgramID = sNextProgramID++;
+    }
+
+    bool NullShader::Load(const std::string &aPath, std::string &aError)
+    {
+        return true;
+    }
+
+    bool NullShader::Attach(void) const
+    {
+        CommandStream::RecordActive(CommandStream::Type::eBIND_SHADER, mProgramID);
+        return true;
+    }
+
+    bool NullShader::Detach(void) const
+    {
+        CommandStream::RecordActive(CommandStream::Type::eBIND_SHADER, 0);
+        return true;
+    }
+
+    const bool NullShader::GetUniformID(const std::string &aName, uint32_t *id) const
+    {
+        *id = CommandStream::HashName(aName);
+        return true;
+    }
+
+    const bool NullShader::GetAttributeID(const std::string &aName, uint32_t *id) const
+    {
+        *id = CommandStream::HashName(aName);
+        return true;
+    }
+
+    Shader::UniformHandle NullShader::GetUniformHandle(const std::string &aName) const
+    {
+        auto lResult = mUniformHandles.emplace(aName, static_cast<UniformHandle>(mUniformHashes.size()));
+        if ( lResult.second )
+        {
+            mUniformCache.Add();
+            mUniformHashes.push_back(CommandStream::HashName(aName));
+        }
+        return lResult.first->second;
+    }
+
+    bool NullShader::RecordUniform(UniformHandle aHandle, const void *aValue, size_t aBytes) const
+    {
+        if ( aHandle == sInvalidUniform )
+            return false;
+        if ( mUniformCache.Update(aHandle, aValue, static_cast<uint32_t>(aBytes)) )
+            CommandStream::RecordActive(CommandStream::Type::eSET_UNIFORM, mUniformHashes[aHandle], static_cast<uint32_t>(aBytes));
+        return true;
+    }
+
+    bool NullShader::SetUniformMat4(const std::string &aName, const glm::mat4 aValue[], uint32_t aNumItems) const
+    { return SetUniformMat4(GetUniformHandle(aName), aValue, aNumItems); }
+
+    bool NullShader::SetUniformMat3(const std::string &aName, const glm::mat3 aValue[], uint32_t aNumItems) const
+    { return SetUniformMat3(GetUniformHandle(aName), aValue, aNumItems); }
+
+    bool NullShader::SetUniformTexture2D(const std::string &aName, uint32_t aUnitID) const
+    { return SetUniformTexture2D(GetUniformHandle(aName), aUnitID); }
+
+    bool NullShader::SetUniformTexture2DArray(const std::string &aName, uint32_t aUnitID[], uint32_t aNumItems) const
+    { return SetUniformTexture2DArray(GetUniformHandle(aName), aUnitID, aNumItems); }
+
+    bool NullShader::SetUniformFloat(const std::string &aName, float aValue) const
+    { return SetUniformFloat(GetUniformHandle(aName), aValue); }
+
+    bool NullShader::SetUniformInt(const std::string &aName, int32_t aValue) const
+    { return SetUniformInt(GetUniformHandle(aName), aValue); }
+
+    bool NullShader::SetUniformBool(const std::string &aName, bool aValue) const
+    { return SetUniformBool(GetUniformHandle(aName), aValue); }
+
+    bool NullShader::SetUniformVec4(const std::string &aName, const glm::vec4 &aValue) const
+    { return SetUniformVec4(GetUniformHandle(aName), aValue); }
+
+    bool NullShader::SetUniformVec3(const std::string &aName, const glm::vec3 &aValue) const
+    { return SetUniformVec3(GetUniformHandle(aName), aValue); }
+
+    bool NullShader::SetUniformVec2(const std::string &aName, const glm::vec2 &aValue) const
+    { return SetUniformVec2(GetUniformHandle(aName), aValue); }
+
+    bool NullShader::SetUniformMat4(UniformHandle aHandle, const glm::mat4 aValue[], uint32_t aNumItems) const
+    { return RecordUniform(aHandle, aValue, sizeof(glm::mat4) * aNumItems); }
+
+    bool NullShader::SetUniformMat3(UniformHandle aHandle, const glm::mat3 aValue[], uint32_t aNumItems) const
+    { return RecordUniform(aHandle, aValue, sizeof(glm::mat3) * aNumItems); }
+
+    bool NullShader::SetUniformTexture2D(UniformHandle aHandle, uint32_t aUnitID) const
+    { return RecordUniform(aHandle, &aUnitID, sizeof aUnitID); }
+
+    bool NullShader::SetUniformTexture2DArray(UniformHandle aHandle, uint32_t aUnitID[], uint32_t aNumItems) const
+    { return RecordUniform(aHandle, aUnitID, sizeof(uint32_t) * aNumItems); }
+
+    bool NullShader::SetUniformFloat(UniformHandle aHandle, float aValue) const
+    { return RecordUniform(aHandle, &aValue, sizeof aValue); }
+
+    bool NullShader::SetUniformInt(UniformHandle aHandle, int32_t aValue) const
+    { return RecordUniform(aHandle, &aValue, sizeof aValue); }
+
+    bool NullShader::SetUniformBool(UniformHandle aHandle, bool aValue) const
+    { return SetUniformInt(aHandle, aValue ? 1 : 0); }
+
+    bool NullShader::SetUniformVec4(UniformHandle aHandle, const glm::vec4 &aValue) const
+    { return RecordUniform(aHandle, &aValue[0], sizeof aValue); }
+
+    bool NullShader::SetUniformVec3(UniformHandle aHandle, const glm::vec3 &aValue) const
+    { return RecordUniform(aHandle, &aValue[0], sizeof aValue); }
+
+    bool NullShader::SetUniformVec2(UniformHandle aHandle, const glm::vec2 &aValue) const
+    { return RecordUniform(aHandle, &aValue[0], sizeof aValue); }
+}
@@ -0,0 +1,79 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Shader of the null render backend. It compiles nothing, attaching
+ *                it and setting its uniforms is recorded into the active command stream.
+ *                Every name gets a handle, and the value shadow drops the redundant
+ *                sets like the OpenGL shader does
+ *******************************************************************************/
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "graphic/shader.h"
+
+namespace Framework
+{
+    class NullShader : public Shader
+    {
+    public:
+                     NullShader(const std::string& aName);
+
+        bool         Init() override { return true; }
+        uint32_t     GetProgramID() const override { return mProgramID; }
+        bool         Load(const std::string &aPath, std::string &aError) override;
+        bool         Reload(std::string &aError) override { return true; }
+
+    protected:
+        bool         LoadVertexShader(const std::string &aFileName, std::string &aError) override   { return true; }
+        bool         LoadGeometryShader(const std::string &aFileName, std::string &aError) override { return true; }
+        bool         LoadFragmentShader(const std::string &aFileName, std::string &aError) override { return true; }
+        bool         LinkProgram(std::string &aError) override                                      { return true; }
+
+    public:
+        bool         Attach(void) const override;
+        bool         Detach(void) const override;
+
+        const std::map<std::string, uint32_t> &GetUniforms(void) const override { return mUniformNames; }
+        const bool   GetUniformID(const std::string &aName, uint32_t *id) const override;
+        const bool   GetAttributeID(const std::string &aName, uint32_t *id) const override;
+        UniformHandle GetUniformHandle(const std::string &aName) const override;
+
+        bool         SetUniformMat4(const std::string &aName, const glm::mat4 aValue[], uint32_t aNumItems = 1) const override;
+        bool         SetUniformMat3(const std::string &aName, const glm::mat3 aValue[], uint32_t aNumItems = 1) const override;
+        bool         SetUniformTexture2D(const std::string &aName, uint32_t aUnitID) const override;
+        bool         SetUniformTexture2DArray(const std::string &aName, uint32_t aUnitID[], uint32_t aNumItems) const override;
+        bool         SetUniformFloat(const std::string &aName, float aValue) const override;
+        bool         SetUniformInt(const std::string &aName, int32_t aValue) const override;
+        bool         SetUniformBool(const std::string &aName, bool aValue) const override;
+        bool         SetUniformVec4(const std::string &aName, const glm::vec4 &aValue) const override;
+        bool         SetUniformVec3(const std::string &aName, const glm::vec3 &aValue) const override;
+        bool         SetUniformVec2(const std::string &aName, const glm::vec2 &aValue) const override;
+
+        bool         SetUniformMat4(UniformHandle aHandle, const glm::mat4 aValue[], uint32_t aNumItems = 1) const override;
+        bool         SetUniformMat3(UniformHandle aHandle, const glm::mat3 aValue[], uint32_t aNumItems = 1) const override;
+        bool         SetUniformTexture2D(UniformHandle aHandle, uint32_t aUnitID) const override;
+        bool         SetUniformTexture2DArray(UniformHandle aHandle, uint32_t aUnitID[], uint32_t aNumItems) const override;
+        bool         SetUniformFloat(UniformHandle aHandle, float aValue) const override;
+        bool         SetUniformInt(UniformHandle aHandle, int32_t aValue) const override;
+        bool         SetUniformBool(UniformHandle aHandle, bool aValue) const override;
+        bool         SetUniformVec4(UniformHandle aHandle, const glm::vec4 &aValue) const override;
+        bool         SetUniformVec3(UniformHandle aHandle, const glm::vec3 &aValue) const override;
+        bool         SetUniformVec2(UniformHandle aHandle, const glm::vec2 &aValue) const override;
+        void         SetCustomParams(void) const override {}
+
+    private:
+        bool         RecordUniform(UniformHandle aHandle, const void *aValue, size_t aBytes) const;
+
+        std::map<std::string, uint32_t> mUniformNames;   /**< Always empty, there is no program to query */
+        mutable std::unordered_map<std::string, UniformHandle> mUniformHandles;
+        mutable std::vector<uint32_t>   mUniformHashes;  /**< Hash of the name of every handle */
+        uint32_t                        mProgramID;
+    };
+}
@@ -0,0 +1,40 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Uniform block of the null render backend
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "graphic/null/null_uniformblock.h"
+#include "graphic/null/null_commandstream.h"
+
+namespace Framework
+{
+    NullUniformBlock::NullUniformBlock()
+        : mBlockArrayIndex(-1)
+        , mBindingPoint(0)
+        , mProgramID(0)
+    {
+    }
+
+    void NullUniformBlock::AddParamName(const std::string &aName)
+    {
+        if ( mParamsOffsets.emplace(aName, mParamsOffsets.size() * sSlotSize).second )
+            mParamsBuffer.resize(mParamsOffsets.size() * sSlotSize, 0);
+    }
+
+    bool NullUniformBlock::PrepareForShader(uint32_t aProgramID)
+    {
+        mProgramID = aProgramID;
+        return true;
+    }
+
+    void NullUniformBlock::Bind()
+    {
+        CommandStream::RecordActive(CommandStream::Type::eBIND_UNIFORM_BLOCK, mBindingPoint);
+        CommandStream::RecordActive(CommandStream::Type::eUPLOAD, mBindingPoint, static_cast<uint32_t>(mParamsBuffer.size()));
+    }
+}
@@ -0,0 +1,58 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Uniform block of the null render backend, with the interface of
+ *                OpenGLUniformBlock. There is no program to query the layout from,
+ *                so every parameter takes a 16 bytes slot in declaration order, like
+ *                the scalars and vectors of a std140 block. Binding the block records
+ *                the upload of the whole buffer
+ *******************************************************************************/
+
+#pragma once
+
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace Framework
+{
+    class NullUniformBlock
+    {
+      public:
+        NullUniformBlock();
+
+        void SetBlockName(const std::string &aBlockName) { mBlockName = aBlockName; }
+        void SetBlockArrayIndex(uint32_t aBlockArrayIndex) { mBlockArrayIndex = aBlockArrayIndex; }
+        void SetBindingPoint(uint32_t aBindingPoint) { mBindingPoint = aBindingPoint; }
+        void AddParamName(const std::string &aName);
+
+        bool PrepareForShader(uint32_t aProgramID);
+
+        template <typename T>
+        bool SetParamValue(const std::string &aName, const T &aValue)
+        {
+            auto lOffset = mParamsOffsets.find(aName);
+            if ( lOffset == mParamsOffsets.end() || lOffset->second + sizeof(aValue) > mParamsBuffer.size() )
+                return false;
+            memcpy(mParamsBuffer.data() + lOffset->second, &aValue, sizeof aValue);
+            return true;
+        }
+
+        void Bind();
+
+      private:
+        static const uint32_t sSlotSize = 16;
+
+        std::string                    mBlockName;
+        int32_t                        mBlockArrayIndex;
+        uint32_t                       mBindingPoint;
+        std::map<std::string, size_t>  mParamsOffsets;
+        std::vector<uint8_t>           mParamsBuffer;
+        uint32_t                       mProgramID;
+    };
+}
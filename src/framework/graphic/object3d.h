@@ -9,6 +9,7 @@
 #include "graphic/object.h"
 #include "graphic/boundingbox.h"
 #include "graphic/boundingsphere.h"
+#include "graphic/boundingvolumehierarchy.h"
 
 
 namespace Framework
@@ -31,6 +32,8 @@ namespace Framework
             , mRenderBoundingSphere(false)
             , mRenderAABB(false)
             , mRenderOOBB(false)
+            , mSpatialIndex(nullptr)
+            , mSpatialProxy(BoundingVolumeHierarchy::sNullProxy)
         {}
 
         const BoundingSphere &GetBoundingSphere() const
@@ -89,6 +92,27 @@ namespace Framework
         bool GetRenderAABB() const { return mRenderAABB; }
         bool GetRenderOOBB() const { return mRenderOOBB; }
 
+        /**
+         * Links the object to its leaf in the spatial index of the scene
+         */
+        void SetSpatialProxy(BoundingVolumeHierarchy* aIndex, int32_t aProxy)
+        {
+            mSpatialIndex = aIndex;
+            mSpatialProxy = aProxy;
+        }
+        BoundingVolumeHierarchy* GetSpatialIndex() const { return mSpatialIndex; }
+        int32_t GetSpatialProxy() const { return mSpatialProxy; }
+
+        /**
+         * Refits the leaf of the object in the spatial index of the scene.
+         * It must be called after the transformation of the object changed
+         */
+        void RefitSpatialProxy() const
+        {
+            if (mSpatialIndex)
+                mSpatialIndex->Move(mSpatialProxy, GetAABB());
+        }
+
 
       protected:
         /**
@@ -144,6 +168,9 @@ namespace Framework
         bool           mRenderBoundingSphere;/**< Flag to enable model bounding sphere rendering */
         bool           mRenderAABB;          /**< Flag to enable model AABB rendering */
         bool           mRenderOOBB;          /**< Flag to enable model OOBB rendering */
+
+        BoundingVolumeHierarchy* mSpatialIndex; /**< Spatial index of the scene containing the object, if any */
+        int32_t                  mSpatialProxy; /**< Leaf of the object in mSpatialIndex */
     };
 }
 
@@ -19,19 +19,23 @@ namespace Framework
 {
     class OpenGLFontRenderer : public FontRenderer
     {
-    #define GL_FONT_RENDERER_NUM_GLYPHS 128
       public:
-        OpenGLFontRenderer();
+        OpenGLFontRenderer() = default;
         ~OpenGLFontRenderer() override;
 
         bool SetFont(std::shared_ptr<const TrueTypeFont> aFont) override;
-        glm::uvec2 EvaluateText(const char* aText, float aScale, uint32_t aVerticalSpacing) const override;
-        void RenderText(const char* aText, float aScale, const glm::uvec3& aPosition, const glm::vec4& aColor, RenderTarget& aTarget) const override;
+
+      protected:
+        void DrawBatch(const GlyphVertex* aVertices, uint32_t aQuads, RenderTarget& aTarget) const override;
 
       private:
-        GLuint        mGlyphTextures[GL_FONT_RENDERER_NUM_GLYPHS];
-        GLuint        mGlyphVAOs[GL_FONT_RENDERER_NUM_GLYPHS];
-        GLuint        mGlyphBuffers[GL_FONT_RENDERER_NUM_GLYPHS];
-        Shader*       mShader = nullptr;
+        GLuint           mAtlasTexture = 0;
+        GLuint           mVAO = 0;
+        GLuint           mVertexBuffer = 0;     /**< Quads of the batch, filled again on every draw */
+        GLuint           mIndexBuffer = 0;      /**< Two triangles per quad */
+        mutable uint32_t mIndexedQuads = 0;     /**< Quads the index buffer can draw */
+        Shader*          mShader = nullptr;
+        Shader::UniformHandle mTransformHandle = Shader::sInvalidUniform;
+        Shader::UniformHandle mGlyphHandle = Shader::sInvalidUniform;
     };
 }
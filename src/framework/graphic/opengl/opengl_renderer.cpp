@@ -110,6 +110,8 @@ namespace Framework
             __(glDeleteBuffers(1, &mTempVBO));
         if ( mTempVAO != GL_NONE )
             __(glDeleteVertexArrays(1, &mTempVAO));
+        if ( mInstanceBO != GL_NONE )
+            __(glDeleteBuffers(1, &mInstanceBO));
     }
 
     const char* OpenGLRenderer::GetName() const { return (const char *)glGetString(GL_RENDERER); }
@@ -312,8 +314,8 @@ namespace Framework
     {
         const OpenGLResources* lGLRes = static_cast<const OpenGLResources*>(aModel.GetAsset3D()->mRendererResources.get());
         __(glBindVertexArray(lGLRes->GetVertexArrayID()));
-        auto& lOffsets = aModel.GetAsset3D()->GetIndicesOffsets();
-        auto& lCounts = aModel.GetAsset3D()->GetIndicesCount();
+        auto& lOffsets = aModel.GetAsset3D()->GetIndicesOffsets(aModel.GetLod());
+        auto& lCounts = aModel.GetAsset3D()->GetIndicesCount(aModel.GetLod());
         auto& lTexturesIDs = lGLRes->GetTexturesIDs();
         size_t n = lOffsets.size();
         ASSERT( lCounts.size() == n &&
@@ -325,7 +327,7 @@ namespace Framework
                 __(glBindTexture(GL_TEXTURE_2D, lTexturesIDs[i]));
                 ASSERT(glIsTexture(lTexturesIDs[i]));
             }
-            __(glDrawElements(GL_TRIANGLES, lCounts[i], GL_UNSIGNED_INT, (void*)(lOffsets[i] * sizeof(GLuint))));
+            __(glDrawElements(GL_TRIANGLES, lCounts[i], lGLRes->GetIndexType(), lGLRes->GetIndexOffset(lOffsets[i])));
         }
         __(glBindVertexArray(GL_NONE));
     }
@@ -490,8 +492,8 @@ namespace Framework
         {
             __(glActiveTexture(GL_TEXTURE0));
 
-            auto& lOffsets = aModel.GetAsset3D()->GetIndicesOffsets();
-            auto& lCounts = aModel.GetAsset3D()->GetIndicesCount();
+            auto& lOffsets = aModel.GetAsset3D()->GetIndicesOffsets(aModel.GetLod());
+            auto& lCounts = aModel.GetAsset3D()->GetIndicesCount(aModel.GetLod());
             auto& lTexturesIDs = lGLRes->GetTexturesIDs();
             auto& lMaterials = aModel.GetAsset3D()->GetMaterials();
 
@@ -500,7 +502,7 @@ namespace Framework
                 __(glBindTexture(GL_TEXTURE_2D, lTexturesIDs[i]));
                 ASSERT(glIsTexture(lTexturesIDs[i]));
                 lLightingShader->SetMaterial(lMaterials[i]);
-                __(glDrawElements(GL_TRIANGLES, lCounts[i], GL_UNSIGNED_INT, (void *)(lOffsets[i] * sizeof(GLuint))));
+                __(glDrawElements(GL_TRIANGLES, lCounts[i], lGLRes->GetIndexType(), lGLRes->GetIndexOffset(lOffsets[i])));
             }
         }
         __(glBindVertexArray(GL_NONE));
@@ -553,7 +555,6 @@ namespace Framework
         }
 
         aShader->Attach();
-        aShader->SetUniformMat4("u_MVPMatrix", &aModelViewProjectionMatrix);
         aShader->SetUniformMat4("u_ModelMatrix", &aModel.GetModelMatrix());
         
         aShader->SetUniformTexture2D("u_diffuseMap", 0);
@@ -615,6 +616,289 @@ namespace Framework
     }
 
 
+    namespace
+    {
+        /* Model id written to the model id buffer, the three low bytes of the id */
+        glm::vec3 GetModelIdColor(const Model3D& aModel)
+        {
+            uint32_t lColor = aModel.GetId();
+            uint8_t* lColorBytes = (uint8_t*)&lColor;
+            ASSERT(lColorBytes[3] == 0xFF);
+            return glm::vec3(lColorBytes[0] / 255.0f, lColorBytes[1] / 255.0f, lColorBytes[2] / 255.0f);
+        }
+
+        /**
+         * Geometry pass state of the render queue items. The material of an item is
+         * its lighting flag, the texture the diffuse map (GL_NONE keeps the bound one)
+         *
+         * The instanced draws read the model matrix and the model id from the vertex
+         * attributes 3 to 7 instead of the uniforms, see geometry_pass.vert. They are
+         * streamed into the instance buffer and only enabled for the draw, the vertex
+         * array of the mesh is left as it was
+         */
+        class GPassQueueBackend : public RenderQueueBackend
+        {
+        public:
+            explicit GPassQueueBackend(GLuint aInstanceBuffer)
+                : mInstanceBuffer(aInstanceBuffer)
+            {}
+
+            void BindShader(const Shader* aShader) override
+            {
+                if ( mShader )
+                    mShader->Detach();
+                mShader = aShader;
+                mShader->Attach();
+                // The handles are resolved once per shader, the objects only use them
+                mModelMatrix = mShader->GetUniformHandle("u_ModelMatrix");
+                mModelId = mShader->GetUniformHandle("u_modelId");
+                mLightingFlag = mShader->GetUniformHandle("u_lightingFlag");
+                mInstanced = mShader->GetUniformHandle("u_instanced");
+                mShader->SetUniformTexture2D(mShader->GetUniformHandle("u_diffuseMap"), 0);
+                mShader->SetUniformBool(mInstanced, false);
+                __(glActiveTexture(GL_TEXTURE0));
+            }
+
+            void BindMaterial(uint32_t aMaterial) override
+            {
+                mShader->SetUniformFloat(mLightingFlag, aMaterial ? 2.0f : 1.0f);
+            }
+
+            void BindTexture(uint32_t aTexture) override
+            {
+                if ( aTexture != GL_NONE )
+                {
+                    __(glBindTexture(GL_TEXTURE_2D, aTexture));
+                    ASSERT(glIsTexture(aTexture));
+                }
+            }
+
+            void BindMesh(const Asset3D* aMesh) override
+            {
+                const OpenGLResources* lGLRes = static_cast<const OpenGLResources*>(aMesh->mRendererResources.get());
+                mMesh = aMesh;
+                mMeshResources = lGLRes;
+                __(glBindVertexArray(lGLRes->GetVertexArrayID()));
+            }
+
+            void BindObject(const Model3D* aModel) override
+            {
+                // The view projection matrix comes from the FrameData block
+                mShader->SetUniformMat4(mModelMatrix, &aModel->GetModelMatrix());
+                mShader->SetUniformVec3(mModelId, GetModelIdColor(*aModel));
+            }
+
+            void Draw(const Model3D* aModel, uint32_t aSubmesh) override
+            {
+                const uint32_t lCount = mMesh->GetIndicesCount(aModel->GetLod())[aSubmesh];
+                const uint32_t lOffset = mMesh->GetIndicesOffsets(aModel->GetLod())[aSubmesh];
+                __(glDrawElements(GL_TRIANGLES, lCount, mMeshResources->GetIndexType(), mMeshResources->GetIndexOffset(lOffset)));
+            }
+
+            void DrawInstanced(const Model3D* const* aModels, uint32_t aCount, uint32_t aSubmesh, uint32_t aLod) override
+            {
+                mInstances.resize(aCount);
+                for ( uint32_t i = 0; i < aCount; ++i )
+                {
+                    mInstances[i].mModelMatrix = aModels[i]->GetModelMatrix();
+                    mInstances[i].mModelId = GetModelIdColor(*aModels[i]);
+                }
+                // Orphans the storage of the previous draw instead of waiting for it
+                __(glBindBuffer(GL_ARRAY_BUFFER, mInstanceBuffer));
+                __(glBufferData(GL_ARRAY_BUFFER, aCount * sizeof(Instance), nullptr, GL_STREAM_DRAW));
+                __(glBufferSubData(GL_ARRAY_BUFFER, 0, aCount * sizeof(Instance), mInstances.data()));
+                for ( GLuint c = 0; c < 5; ++c )
+                {
+                    __(glEnableVertexAttribArray(sInstanceAttribute + c));
+                    __(glVertexAttribPointer(sInstanceAttribute + c, c < 4 ? 4 : 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                                             reinterpret_cast<void*>(static_cast<uintptr_t>(c * sizeof(glm::vec4)))));
+                    __(glVertexAttribDivisor(sInstanceAttribute + c, 1));
+                }
+                __(glBindBuffer(GL_ARRAY_BUFFER, GL_NONE));
+
+                mShader->SetUniformBool(mInstanced, true);
+                const uint32_t lCount = mMesh->GetIndicesCount(aLod)[aSubmesh];
+                const uint32_t lOffset = mMesh->GetIndicesOffsets(aLod)[aSubmesh];
+                __(glDrawElementsInstanced(GL_TRIANGLES, lCount, mMeshResources->GetIndexType(), mMeshResources->GetIndexOffset(lOffset), aCount));
+                mShader->SetUniformBool(mInstanced, false);
+
+                for ( GLuint c = 0; c < 5; ++c )
+                {
+                    __(glVertexAttribDivisor(sInstanceAttribute + c, 0));
+                    __(glDisableVertexAttribArray(sInstanceAttribute + c));
+                }
+            }
+
+            void End()
+            {
+                __(glBindVertexArray(GL_NONE));
+                if ( mShader )
+                    mShader->Detach();
+            }
+
+        private:
+            const Shader*          mShader = nullptr;
+            const Asset3D*         mMesh = nullptr;
+            const OpenGLResources* mMeshResources = nullptr;
+            Shader::UniformHandle  mModelMatrix = Shader::sInvalidUniform;
+            Shader::UniformHandle  mModelId = Shader::sInvalidUniform;
+            Shader::UniformHandle  mLightingFlag = Shader::sInvalidUniform;
+            Shader::UniformHandle  mInstanced = Shader::sInvalidUniform;
+
+            /* Layout of the instance buffer, the matrix takes the attributes 3 to 6 */
+            struct Instance
+            {
+                glm::mat4 mModelMatrix;
+                glm::vec3 mModelId;
+            };
+            static const GLuint    sInstanceAttribute = 3;
+            GLuint                 mInstanceBuffer;
+            std::vector<Instance>  mInstances;
+        };
+    }
+
+
+    void OpenGLRenderer::QueueModel3D_GPass(RenderQueue& aQueue, const Model3D& aModel, const Shader* aShader, float aDepth) const
+    {
+        const Asset3D* lAsset = aModel.GetAsset3D();
+        const OpenGLResources* lGLRes = static_cast<const OpenGLResources*>(lAsset->mRendererResources.get());
+        auto& lTexturesIDs = lGLRes->GetTexturesIDs();
+        const size_t n = lAsset->GetIndicesOffsets().size();
+        ASSERT( lAsset->GetIndicesCount().size() == n &&
+                (lTexturesIDs.empty() || lTexturesIDs.size() == n) );
+        const uint32_t lMaterial = aModel.IsShadowReceiver() ? 1 : 0;
+        const uint32_t lLod = aModel.GetLod();
+        auto& lCounts = lAsset->GetIndicesCount(lLod);
+        for ( size_t i = 0; i < n; ++i )
+        {
+            if ( lCounts[i] == 0 ) /* the list was simplified away at this level of detail */
+                continue;
+            aQueue.Add(RenderQueue::ePASS_OPAQUE, aShader, lMaterial, lTexturesIDs.empty() ? GL_NONE : lTexturesIDs[i],
+                       lAsset, aDepth, &aModel, static_cast<uint32_t>(i), lLod);
+        }
+    }
+
+
+    void OpenGLRenderer::SubmitQueue_GPass(RenderQueue& aQueue) const
+    {
+        if ( mInstanceBO == GL_NONE )
+            __(glGenBuffers(1, &mInstanceBO));
+        GPassQueueBackend lBackend(mInstanceBO);
+        aQueue.Submit(lBackend);
+        lBackend.End();
+    }
+
+
+    void OpenGLRenderer::UpdateFrameData(const Camera& aCamera, const glm::vec2& aScreenSize, const Shader* aShader) const
+    {
+        if ( mFrameData.GetBlockSize() == 0 )
+        {
+            mFrameData.SetBlockName("FrameData");
+            mFrameData.SetBindingPoint(OpenGLShader::eFRAME_DATA_BINDING);
+            mFrameData.AddParamName("viewMatrix");
+            mFrameData.AddParamName("projectionMatrix");
+            mFrameData.AddParamName("viewProjectionMatrix");
+            mFrameData.AddParamName("cameraPosition");
+            mFrameData.AddParamName("screenSize");
+            if ( !mFrameData.PrepareForShader(aShader->GetProgramID()) )
+                CRASH("Shader %s does not declare the FrameData block", aShader->GetName().c_str());
+        }
+        const glm::mat4 lViewProjectionMatrix = aCamera.GetProjectionMatrix() * aCamera.GetViewMatrix();
+        mFrameData.SetParamValue("viewMatrix", aCamera.GetViewMatrix());
+        mFrameData.SetParamValue("projectionMatrix", aCamera.GetProjectionMatrix());
+        mFrameData.SetParamValue("viewProjectionMatrix", lViewProjectionMatrix);
+        mFrameData.SetParamValue("cameraPosition", glm::vec4(aCamera.GetPosition(), 1.0f));
+        mFrameData.SetParamValue("screenSize", aScreenSize);
+        mFrameData.Bind();
+    }
+
+
+    void OpenGLRenderer::ResetRenderState() const
+    {
+        __(glDisable(GL_BLEND));
+        __(glDisable(GL_STENCIL_TEST));
+        __(glDepthMask(GL_TRUE));
+        __(glEnable(GL_DEPTH_TEST));
+        __(glPolygonMode(GL_FRONT_AND_BACK, GL_FILL));
+        __(glFrontFace(GL_CCW));
+        __(glEnable(GL_CULL_FACE));
+    }
+
+
+    void OpenGLRenderer::SetDepthTest(bool aEnable) const
+    {
+        if ( aEnable )
+        {
+            __(glEnable(GL_DEPTH_TEST));
+        }
+        else
+        {
+            __(glDisable(GL_DEPTH_TEST));
+        }
+    }
+
+
+    void OpenGLRenderer::SetDepthWrite(bool aEnable) const
+    {
+        __(glDepthMask(aEnable ? GL_TRUE : GL_FALSE));
+    }
+
+
+    void OpenGLRenderer::SetAdditiveBlending(bool aEnable) const
+    {
+        if ( aEnable )
+        {
+            __(glEnable(GL_BLEND));
+            __(glBlendEquation(GL_FUNC_ADD));
+            __(glBlendFunc(GL_ONE, GL_ONE));
+        }
+        else
+        {
+            __(glDisable(GL_BLEND));
+        }
+    }
+
+
+    void OpenGLRenderer::SetCullFrontFaces(bool aFront) const
+    {
+        __(glCullFace(aFront ? GL_FRONT : GL_BACK));
+    }
+
+
+    void OpenGLRenderer::SetPolygonFill() const
+    {
+        __(glPolygonMode(GL_FRONT_AND_BACK, GL_FILL));
+    }
+
+
+    void OpenGLRenderer::SetDrawBuffers(uint32_t aCount) const
+    {
+        static const GLenum sColorBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3 };
+        ASSERT(aCount <= sizeof(sColorBuffers) / sizeof(sColorBuffers[0]));
+        __(glDrawBuffers(aCount, sColorBuffers));
+    }
+
+
+    void OpenGLRenderer::BindTexture(uint32_t aUnit, uint32_t aTexture, bool aNearest) const
+    {
+        __(glActiveTexture(GL_TEXTURE0 + aUnit));
+        __(glBindTexture(GL_TEXTURE_2D, aTexture));
+        ASSERT(aTexture == GL_NONE || glIsTexture(aTexture));
+        if ( aNearest )
+        {
+            __(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+            __(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+        }
+    }
+
+
+    void OpenGLRenderer::DrawScreenQuad() const
+    {
+        __(glBindVertexArray(mTempVAO));
+        __(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
+    }
+
+
     void OpenGLRenderer::RenderTransformGizmo(uint32_t aGizmoType, const Object *aModel, const Camera &aCamera) const
     {
         const Shader* lGizmoDrawingShader = Engine::Instance()->ResourceManager().FindShader("Gizmo drawing");
@@ -12,6 +12,7 @@
 #include <vector>
 #include "graphic/renderer.h"
 #include "graphic/opengl/opengl_shader.h"
+#include "graphic/opengl/opengl_uniformblock.h"
 #include "graphic/procedural/texturedquad.h"
 
 namespace Framework
@@ -56,6 +57,19 @@ namespace Framework
 
     protected:
         void RenderModel3DWireframe_GPass(const Model3D &aModel, const glm::mat4& aModelViewProjectionMatrix, const glm::vec4 &aColor) const override;
+        void QueueModel3D_GPass(RenderQueue& aQueue, const Model3D& aModel, const Shader* aShader, float aDepth) const override;
+        void SubmitQueue_GPass(RenderQueue& aQueue) const override;
+        void UpdateFrameData(const Camera& aCamera, const glm::vec2& aScreenSize, const Shader* aShader) const override;
+
+        void ResetRenderState() const override;
+        void SetDepthTest(bool aEnable) const override;
+        void SetDepthWrite(bool aEnable) const override;
+        void SetAdditiveBlending(bool aEnable) const override;
+        void SetCullFrontFaces(bool aFront) const override;
+        void SetPolygonFill() const override;
+        void SetDrawBuffers(uint32_t aCount) const override;
+        void BindTexture(uint32_t aUnit, uint32_t aTexture, bool aNearest = false) const override;
+        void DrawScreenQuad() const override;
     public:
 
         void        RenderTransformGizmo(uint32_t aGizmoType, const Object *aModel, const Camera &aCamera) const override;
@@ -117,5 +131,15 @@ namespace Framework
         OpenGLShader mRenderShadowMapQuad = OpenGLShader("render shadowmap quad");
 
         GLuint mTempVAO = GL_NONE, mTempVBO = GL_NONE;
+
+        /**
+         * Model matrices and ids of the instanced draws of the geometry pass
+         */
+        mutable GLuint mInstanceBO = GL_NONE;
+
+        /**
+         * Camera and screen data shared by the scene passes, see OpenGLShader::eFRAME_DATA_BINDING
+         */
+        mutable OpenGLUniformBlock mFrameData;
     };
 }
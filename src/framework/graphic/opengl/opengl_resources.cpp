@@ -15,6 +15,48 @@
 
 namespace Framework
 {
+    namespace
+    {
+        /* Fills the texture bound to GL_TEXTURE_2D. A cooked texture brings its mip
+           chain, the levels of a raw one are generated from its pixels in the given
+           format and type */
+        void UploadTexture(const Texture& aTexture, GLenum aRawFormat, GLenum aRawType)
+        {
+            if ( !aTexture.IsCooked() )
+            {
+                // the number of mipmap levels = log2( max(width, height) ) + 1
+                uint32_t mipMapLevels = log2(max(aTexture.mWidth, aTexture.mHeight)) + 1;
+                __(glTexStorage2D(GL_TEXTURE_2D, mipMapLevels, GL_RGBA8, aTexture.mWidth, aTexture.mHeight));
+                __(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, aTexture.mWidth, aTexture.mHeight, aRawFormat, aRawType, aTexture.mPixels.data()));
+                __(glGenerateMipmap(GL_TEXTURE_2D));
+                return;
+            }
+
+            GLenum lInternalFormat = GL_RGBA8;
+            switch ( aTexture.mCompression )
+            {
+                case Texture::Compression::eBC1: lInternalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+                case Texture::Compression::eBC3: lInternalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+                case Texture::Compression::eBC7: lInternalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+                default: break;
+            }
+            __(glTexStorage2D(GL_TEXTURE_2D, aTexture.mMipLevels, lInternalFormat, aTexture.mWidth, aTexture.mHeight));
+            for ( uint32_t lLevel = 0; lLevel < aTexture.mMipLevels; ++lLevel )
+            {
+                const uint8_t* lPixels = aTexture.mPixels.data() + aTexture.GetLevelOffset(lLevel);
+                const GLsizei lWidth = aTexture.GetLevelWidth(lLevel), lHeight = aTexture.GetLevelHeight(lLevel);
+                if ( aTexture.mCompression == Texture::Compression::eNONE )
+                {
+                    __(glTexSubImage2D(GL_TEXTURE_2D, lLevel, 0, 0, lWidth, lHeight, GL_RGBA, GL_UNSIGNED_BYTE, lPixels));
+                }
+                else
+                {
+                    __(glCompressedTexSubImage2D(GL_TEXTURE_2D, lLevel, 0, 0, lWidth, lHeight, lInternalFormat,
+                                                 (GLsizei)aTexture.GetLevelSize(lLevel), lPixels));
+                }
+            }
+        }
+    }
 
     OpenGLResources::OpenGLResources(const Asset2D& aAsset)
     {
@@ -68,11 +110,7 @@ namespace Framework
             ASSERT(lTexture.mWidth && lTexture.mHeight && lTexture.mBytesPerPixel);
             __(glBindTexture(GL_TEXTURE_2D, mTexturesIDs[i]));
             {
-                // the number of mipmap levels = log2( max(width, height) ) + 1
-                uint32_t mipMapLevels = log2(max(lTexture.mWidth, lTexture.mHeight)) + 1;
-                __(glTexStorage2D(GL_TEXTURE_2D, mipMapLevels, GL_RGBA8, lTexture.mWidth, lTexture.mHeight));
-                __(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, lTexture.mWidth, lTexture.mHeight, lTexture.mFormat, lTexture.mType, lTexture.mPixels.data()));
-                __(glGenerateMipmap(GL_TEXTURE_2D));
+                UploadTexture(lTexture, lTexture.mFormat, lTexture.mType);
                 __(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
                 __(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
                 __(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
@@ -96,48 +134,52 @@ namespace Framework
             __(glGenBuffers(1, &mVertexDataBO));
             __(glBindBuffer(GL_ARRAY_BUFFER, mVertexDataBO));
             {
-                /* Upload the data for this buffer */
-                __(glBufferData(GL_ARRAY_BUFFER, aAsset.GetVertexData().size() * sizeof aAsset.GetVertexData()[0], &(aAsset.GetVertexData()[0]), GL_STATIC_DRAW));
-
-                /* First attribute contains the vertex coordinates */
-                __(glEnableVertexAttribArray(0));
-                __(glVertexAttribPointer(0, // attribute index. No particular reason for 0, but must match the layout in the shader.
-                    3,         // size
-                    GL_FLOAT,  // type
-                    GL_FALSE,  // normalized?
-                    sizeof(Asset3D::VertexData),  // stride
-                    (void *)0                     // array buffer lOffset
-                    ));
-
-                /* Second attibute contains the normals */
-                uint32_t lOffset = 12;
-                __(glEnableVertexAttribArray(1));
-                __(glVertexAttribPointer(1,           // attribute
-                    3,                                // size
-                    GL_FLOAT,                         // type
-                    GL_FALSE,                         // normalized?
-                    sizeof(Asset3D::VertexData),      // stride
-                    reinterpret_cast<void *>(lOffset) // array buffer lOffset
-                    ));
-
-                /* Third attribute contains the UV coordinates */
-                lOffset = 24;
-                __(glEnableVertexAttribArray(2));
-                __(glVertexAttribPointer(2,           // attribute
-                    2,                                // size
-                    GL_FLOAT,                         // type
-                    GL_FALSE,                         // normalized?
-                    sizeof(Asset3D::VertexData),      // stride
-                    reinterpret_cast<void *>(lOffset) // array buffer lOffset
-                    ));
+                /* Upload the data for this buffer, packed in the layout chosen when the asset was cooked */
+                std::vector<uint8_t> lPackedVertices;
+                const GLsizei lStride = Asset3D::GetVertexStride(aAsset.GetVertexFormat());
+                __(glBufferData(GL_ARRAY_BUFFER, aAsset.GetVertexData().size() * lStride, aAsset.PackVertexData(lPackedVertices), GL_STATIC_DRAW));
+
+                /* Position, normal and UV coordinates of every layout, the normals are
+                   snorm 10:10:10 in the compact ones, which needs 4 components */
+                struct Attribute
+                {
+                    GLint     mSize;
+                    GLenum    mType;
+                    GLboolean mNormalized;
+                    uint32_t  mOffset;
+                };
+                static const Attribute sFloatLayout[3]   = { { 3, GL_FLOAT,      GL_FALSE, 0 },
+                                                             { 3, GL_FLOAT,      GL_FALSE, 12 },
+                                                             { 2, GL_FLOAT,      GL_FALSE, 24 } };
+                static const Attribute sCompactLayout[3] = { { 3, GL_FLOAT,      GL_FALSE, 0 },
+                                                             { 4, GL_INT_2_10_10_10_REV, GL_TRUE, 12 },
+                                                             { 2, GL_HALF_FLOAT, GL_FALSE, 16 } };
+                static const Attribute sHalfLayout[3]    = { { 3, GL_HALF_FLOAT, GL_FALSE, 0 },
+                                                             { 4, GL_INT_2_10_10_10_REV, GL_TRUE, 8 },
+                                                             { 2, GL_HALF_FLOAT, GL_FALSE, 12 } };
+                const Attribute* lLayout = sFloatLayout;
+                if ( aAsset.GetVertexFormat() == Asset3D::VertexFormat::eCOMPACT )
+                    lLayout = sCompactLayout;
+                else if ( aAsset.GetVertexFormat() == Asset3D::VertexFormat::eHALF )
+                    lLayout = sHalfLayout;
+
+                for ( GLuint i = 0; i < 3; ++i )
+                {
+                    __(glEnableVertexAttribArray(i));
+                    __(glVertexAttribPointer(i, lLayout[i].mSize, lLayout[i].mType, lLayout[i].mNormalized, lStride,
+                                             reinterpret_cast<void *>(static_cast<uintptr_t>(lLayout[i].mOffset))));
+                }
             }
 
-            /* Generate the buffer models for the indices */
+            /* Generate the buffer models for the indices, 16 bits when the vertices allow it */
             __(glGenBuffers(1, &mIndicesBO));
             __(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndicesBO));
             {
                 /* Upload the data */
-                __(glBufferData(GL_ELEMENT_ARRAY_BUFFER, aAsset.GetIndexData().size() * sizeof(aAsset.GetIndexData()[0]), &(aAsset.GetIndexData()[0]), GL_STATIC_DRAW));
+                std::vector<uint16_t> lShortIndices;
+                mIndexSize = aAsset.GetIndexSize();
+                mIndexType = mIndexSize == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+                __(glBufferData(GL_ELEMENT_ARRAY_BUFFER, aAsset.GetIndexData().size() * mIndexSize, aAsset.PackIndexData(lShortIndices), GL_STATIC_DRAW));
             }
         }
         __(glBindVertexArray(GL_NONE));
@@ -154,14 +196,9 @@ namespace Framework
             { // what kind of case it that?
                 continue;
             }
-            /* TODO: Once we use our own format, this should not be needed */
             __(glBindTexture(GL_TEXTURE_2D, mTexturesIDs[i]));
             {
-                // the number of mipmap levels = log2( max(width, height) ) + 1
-                uint32_t mipMapLevels = log2(max(lTexture.mWidth, lTexture.mHeight)) + 1;
-                __(glTexStorage2D(GL_TEXTURE_2D, mipMapLevels, GL_RGBA8, lTexture.mWidth, lTexture.mHeight));
-                __(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, lTexture.mWidth, lTexture.mHeight, GL_RGB, GL_UNSIGNED_BYTE, lTexture.mPixels.data()));
-                __(glGenerateMipmap(GL_TEXTURE_2D));
+                UploadTexture(lTexture, GL_RGB, GL_UNSIGNED_BYTE);
                 __(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
                 __(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
                 __(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
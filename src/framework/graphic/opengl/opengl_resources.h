@@ -37,11 +37,19 @@ namespace Framework
         inline uint32_t                      GetVertexArrayID() const { return mVAO; }
         inline uint32_t                      GetIndicesArrayID() const { return mIndicesBO; }
         inline const std::vector<uint32_t>&  GetTexturesIDs() const { return mTexturesIDs; }
+        inline GLenum                        GetIndexType() const { return mIndexType; }
+
+        /**
+         * @return Byte offset in the index buffer of the given index
+         */
+        inline void*                         GetIndexOffset(uint32_t aIndex) const { return reinterpret_cast<void*>(static_cast<uintptr_t>(aIndex) * mIndexSize); }
 
       private:
         GLuint                mVAO = GL_NONE;           /**< Vertex array object ID */
         GLuint                mVertexDataBO = GL_NONE;  /**< Vertex buffer object ID */
         GLuint                mIndicesBO = GL_NONE;     /**< Indices buffer object ID */
+        GLenum                mIndexType = GL_UNSIGNED_INT;  /**< GL_UNSIGNED_SHORT for the meshes of up to 65536 vertices */
+        uint32_t              mIndexSize = sizeof(GLuint);
         std::vector<uint32_t> mTexturesIDs;             /**< Textures ID vector */
     };
 }
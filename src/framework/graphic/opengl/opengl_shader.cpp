@@ -36,6 +36,8 @@ namespace Framework
     bool OpenGLShader::Load(const string& aPath, string& aError)
     {
         const string lShaderPath = Engine::Instance()->Config().GetDataDirectory() + string("/resources/shaders/") + aPath;
+        mPath = aPath;
+        mSourceFiles.clear();
 
         string vertex = lShaderPath + string(".vert");
         string geometry = lShaderPath + string(".geo");
@@ -54,6 +56,34 @@ namespace Framework
         return LinkProgram(aError);
     }
 
+    bool OpenGLShader::Reload(string& aError)
+    {
+        if ( mPath.empty() )
+        {
+            aError = string("Shader ") + mName + string(" was not loaded from files");
+            return false;
+        }
+
+        /* The program in use is kept until the new one is linked */
+        const uint32_t lProgramID = mProgramID;
+        std::vector<string> lSourceFiles = mSourceFiles;
+        mProgramID = GL_NONE;
+        if ( !Load(string(mPath), aError) )
+        {
+            for ( auto lShaderID : mShadersIDs )
+                __(glDeleteShader(lShaderID));
+            mShadersIDs.clear();
+            if ( mProgramID )
+                __(glDeleteProgram(mProgramID));
+            mProgramID = lProgramID;
+            mSourceFiles = std::move(lSourceFiles); // the failed stage stays watched
+            return false;
+        }
+        if ( lProgramID )
+            __(glDeleteProgram(lProgramID));
+        return true;
+    }
+
     bool OpenGLShader::LoadVertexShader(const string& aFilename, string& aError)
     {
         GLuint shaderObjectID;
@@ -96,6 +126,7 @@ namespace Framework
             return false;
         }
 
+        mSourceFiles.push_back(aFilename);
         fseek(shader, 0, SEEK_END);
         long size = ftell(shader);
         fseek(shader, 0, SEEK_SET);
@@ -197,6 +228,7 @@ namespace Framework
         INFO(LogLevel::eLEVEL3,"linked program [%s]", mName.c_str());
 
         BuildUniformsMap();
+        BindSharedBlocks();
 
         return true;
     }
@@ -238,143 +270,149 @@ namespace Framework
         return *aId != -1 ? true : false;
     }
 
-    bool OpenGLShader::SetUniformMat4(const string& aName, const glm::mat4 aValue[], uint32_t aNumItems) const
+    Shader::UniformHandle OpenGLShader::GetUniformHandle(const string& aName) const
     {
-        auto lIter = mUniformNames.find(aName);
+        auto lIter = mUniformHandles.find(aName);
 
-        if ( lIter == mUniformNames.end() )
+        if ( lIter == mUniformHandles.end() )
         {
             WARNING("Not found '%s' in the uniform name list", aName.c_str());
-            return false;
+            return sInvalidUniform;
         }
 
-        __(glUniformMatrix4fv(lIter->second, aNumItems, GL_FALSE, (GLfloat*)aValue));
-        return true;
+        return lIter->second;
     }
 
-    bool OpenGLShader::SetUniformMat3(const string& aName, const glm::mat3 aValue[], uint32_t aNumItems) const
+    GLint OpenGLShader::UpdateUniform(UniformHandle aHandle, const void* aValue, uint32_t aBytes) const
     {
-        auto lIter = mUniformNames.find(aName);
+        ASSERT(aHandle < mUniformLocations.size());
+        if ( !mUniformCache.Update(aHandle, aValue, aBytes) )
+            return -1;
+        return mUniformLocations[aHandle];
+    }
 
-        if ( lIter == mUniformNames.end() )
-        {
-            WARNING("Not found '%s' in the uniform name list", aName.c_str());
-            return false;
-        }
+    bool OpenGLShader::SetUniformMat4(const string& aName, const glm::mat4 aValue[], uint32_t aNumItems) const
+    { return SetUniformMat4(GetUniformHandle(aName), aValue, aNumItems); }
 
-        __(glUniformMatrix3fv(lIter->second, aNumItems, GL_FALSE, (GLfloat*)aValue));
-        return true;
-    }
+    bool OpenGLShader::SetUniformMat3(const string& aName, const glm::mat3 aValue[], uint32_t aNumItems) const
+    { return SetUniformMat3(GetUniformHandle(aName), aValue, aNumItems); }
 
     bool OpenGLShader::SetUniformTexture2D(const string& aName, uint32_t aUnitID) const
-    {
-        auto lIter = mUniformNames.find(aName);
+    { return SetUniformTexture2D(GetUniformHandle(aName), aUnitID); }
 
-        if ( lIter == mUniformNames.end() )
-        {
-            WARNING("Not found '%s' in the uniform name list", aName.c_str());
-            return false;
-        }
+    bool OpenGLShader::SetUniformTexture2DArray(const string& aName, uint32_t aUnitIDs[], uint32_t aNumItems) const
+    { return SetUniformTexture2DArray(GetUniformHandle(aName), aUnitIDs, aNumItems); }
+
+    bool OpenGLShader::SetUniformFloat(const string& aName, float aValue) const
+    { return SetUniformFloat(GetUniformHandle(aName), aValue); }
+
+    bool OpenGLShader::SetUniformInt(const string& aName, int32_t aValue) const
+    { return SetUniformInt(GetUniformHandle(aName), aValue); }
+
+    bool OpenGLShader::SetUniformBool(const string& aName, bool aValue) const
+    { return SetUniformBool(GetUniformHandle(aName), aValue); }
+
+    bool OpenGLShader::SetUniformVec4(const string& aName, const glm::vec4& aValue) const
+    { return SetUniformVec4(GetUniformHandle(aName), aValue); }
+
+    bool OpenGLShader::SetUniformVec3(const string& aName, const glm::vec3& aValue) const
+    { return SetUniformVec3(GetUniformHandle(aName), aValue); }
+
+    bool OpenGLShader::SetUniformVec2(const string& aName, const glm::vec2& aValue) const
+    { return SetUniformVec2(GetUniformHandle(aName), aValue); }
 
-        __(glUniform1i(lIter->second, aUnitID));
+    bool OpenGLShader::SetUniformMat4(UniformHandle aHandle, const glm::mat4 aValue[], uint32_t aNumItems) const
+    {
+        if ( aHandle == sInvalidUniform )
+            return false;
+        const GLint lLocation = UpdateUniform(aHandle, aValue, sizeof(glm::mat4) * aNumItems);
+        if ( lLocation != -1 )
+            __(glUniformMatrix4fv(lLocation, aNumItems, GL_FALSE, (GLfloat*)aValue));
         return true;
     }
 
-    bool OpenGLShader::SetUniformTexture2DArray(const string& aName, uint32_t aUnitIDs[], uint32_t aNumItems) const
+    bool OpenGLShader::SetUniformMat3(UniformHandle aHandle, const glm::mat3 aValue[], uint32_t aNumItems) const
     {
-        auto lIter = mUniformNames.find(aName);
-
-        if ( lIter == mUniformNames.end() )
-        {
-            WARNING("Not found '%s' in the uniform name list", aName.c_str());
+        if ( aHandle == sInvalidUniform )
             return false;
-        }
-
-        __(glUniform1iv(lIter->second, aNumItems, (GLint*)aUnitIDs));
+        const GLint lLocation = UpdateUniform(aHandle, aValue, sizeof(glm::mat3) * aNumItems);
+        if ( lLocation != -1 )
+            __(glUniformMatrix3fv(lLocation, aNumItems, GL_FALSE, (GLfloat*)aValue));
         return true;
     }
 
-    bool OpenGLShader::SetUniformFloat(const string& aName, float aValue) const
+    bool OpenGLShader::SetUniformTexture2D(UniformHandle aHandle, uint32_t aUnitID) const
     {
-        auto lIter = mUniformNames.find(aName);
-
-        if ( lIter == mUniformNames.end() )
-        {
-            WARNING("Not found '%s' in the uniform name list", aName.c_str());
+        if ( aHandle == sInvalidUniform )
             return false;
-        }
-
-        __(glUniform1f(lIter->second, aValue));
+        const GLint lLocation = UpdateUniform(aHandle, &aUnitID, sizeof aUnitID);
+        if ( lLocation != -1 )
+            __(glUniform1i(lLocation, aUnitID));
         return true;
     }
 
-    bool OpenGLShader::SetUniformInt(const string& aName, int32_t aValue) const
+    bool OpenGLShader::SetUniformTexture2DArray(UniformHandle aHandle, uint32_t aUnitIDs[], uint32_t aNumItems) const
     {
-        auto lIter = mUniformNames.find(aName);
-
-        if ( lIter == mUniformNames.end() )
-        {
-            WARNING("Not found '%s' in the uniform name list", aName.c_str());
+        if ( aHandle == sInvalidUniform )
             return false;
-        }
-
-        __(glUniform1i(lIter->second, aValue));
+        const GLint lLocation = UpdateUniform(aHandle, aUnitIDs, sizeof(uint32_t) * aNumItems);
+        if ( lLocation != -1 )
+            __(glUniform1iv(lLocation, aNumItems, (GLint*)aUnitIDs));
         return true;
     }
 
-    bool OpenGLShader::SetUniformBool(const string& aName, bool aValue) const
+    bool OpenGLShader::SetUniformFloat(UniformHandle aHandle, float aValue) const
     {
-        auto lIter = mUniformNames.find(aName);
-
-        if ( lIter == mUniformNames.end() )
-        {
-            WARNING("Not found '%s' in the uniform name list", aName.c_str());
+        if ( aHandle == sInvalidUniform )
             return false;
-        }
-
-        __(glUniform1i(lIter->second, aValue));
+        const GLint lLocation = UpdateUniform(aHandle, &aValue, sizeof aValue);
+        if ( lLocation != -1 )
+            __(glUniform1f(lLocation, aValue));
         return true;
     }
 
-    bool OpenGLShader::SetUniformVec4(const string& aName, const glm::vec4& aValue) const
+    bool OpenGLShader::SetUniformInt(UniformHandle aHandle, int32_t aValue) const
     {
-        auto lIter = mUniformNames.find(aName);
-
-        if ( lIter == mUniformNames.end() )
-        {
-            WARNING("Not found '%s' in the uniform name list", aName.c_str());
+        if ( aHandle == sInvalidUniform )
             return false;
-        }
-
-        __(glUniform4fv(lIter->second, 1, &aValue[0]));
+        const GLint lLocation = UpdateUniform(aHandle, &aValue, sizeof aValue);
+        if ( lLocation != -1 )
+            __(glUniform1i(lLocation, aValue));
         return true;
     }
 
-    bool OpenGLShader::SetUniformVec3(const string& aName, const glm::vec3& aValue) const
+    bool OpenGLShader::SetUniformBool(UniformHandle aHandle, bool aValue) const
     {
-        auto lIter = mUniformNames.find(aName);
+        return SetUniformInt(aHandle, aValue ? 1 : 0);
+    }
 
-        if ( lIter == mUniformNames.end() )
-        {
-            WARNING("Not found '%s' in the uniform name list", aName.c_str());
+    bool OpenGLShader::SetUniformVec4(UniformHandle aHandle, const glm::vec4& aValue) const
+    {
+        if ( aHandle == sInvalidUniform )
             return false;
-        }
-
-        __(glUniform3fv(lIter->second, 1, &aValue[0]));
+        const GLint lLocation = UpdateUniform(aHandle, &aValue[0], sizeof aValue);
+        if ( lLocation != -1 )
+            __(glUniform4fv(lLocation, 1, &aValue[0]));
         return true;
     }
 
-    bool OpenGLShader::SetUniformVec2(const string& aName, const glm::vec2& aValue) const
+    bool OpenGLShader::SetUniformVec3(UniformHandle aHandle, const glm::vec3& aValue) const
     {
-        auto lIter = mUniformNames.find(aName);
-
-        if ( lIter == mUniformNames.end() )
-        {
-            WARNING("Not found '%s' in the uniform name list", aName.c_str());
+        if ( aHandle == sInvalidUniform )
             return false;
-        }
+        const GLint lLocation = UpdateUniform(aHandle, &aValue[0], sizeof aValue);
+        if ( lLocation != -1 )
+            __(glUniform3fv(lLocation, 1, &aValue[0]));
+        return true;
+    }
 
-        __(glUniform2fv(lIter->second, 1, &aValue[0]));
+    bool OpenGLShader::SetUniformVec2(UniformHandle aHandle, const glm::vec2& aValue) const
+    {
+        if ( aHandle == sInvalidUniform )
+            return false;
+        const GLint lLocation = UpdateUniform(aHandle, &aValue[0], sizeof aValue);
+        if ( lLocation != -1 )
+            __(glUniform2fv(lLocation, 1, &aValue[0]));
         return true;
     }
 
@@ -382,7 +420,12 @@ namespace Framework
 
     void OpenGLShader::BuildUniformsMap(void)
     {
+        /* A program linked again by Reload keeps the handles of the uniforms it
+           already had, the callers resolved them once. The uniforms it lost have
+           no location anymore and their updates are dropped */
         mUniformNames.clear();
+        std::fill(mUniformLocations.begin(), mUniformLocations.end(), -1);
+        mUniformCache.Invalidate();
 
         int32_t lCount, i;
         __(glGetProgramiv(mProgramID, GL_ACTIVE_UNIFORMS, &lCount));
@@ -409,6 +452,31 @@ namespace Framework
 
             /* Save in map */
             mUniformNames[lUniformName] = uniformID;
+
+            /* The handle indexes the locations and the value shadow */
+            auto lHandle = mUniformHandles.find(lUniformName);
+            if ( lHandle != mUniformHandles.end() )
+                mUniformLocations[lHandle->second] = uniformID;
+            else
+            {
+                mUniformHandles[lUniformName] = mUniformCache.Add();
+                mUniformLocations.push_back(uniformID);
+            }
+        }
+    }
+
+    void OpenGLShader::BindSharedBlocks(void)
+    {
+        static const struct { const char* mName; GLuint mBindingPoint; } sSharedBlocks[] = {
+            { "FrameData", eFRAME_DATA_BINDING },
+        };
+
+        for ( const auto& lBlock : sSharedBlocks )
+        {
+            GLuint lBlockIndex;
+            __(lBlockIndex = glGetUniformBlockIndex(mProgramID, lBlock.mName));
+            if ( lBlockIndex != GL_INVALID_INDEX )
+                __(glUniformBlockBinding(mProgramID, lBlockIndex, lBlock.mBindingPoint));
         }
     }
 
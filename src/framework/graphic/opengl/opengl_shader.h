@@ -11,6 +11,7 @@
 
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "graphic/shader.h"
 #include "graphic/opengl/opengl_shadermaterial.h"
@@ -26,6 +27,7 @@ namespace Framework
         bool         Init() override { return true; }
         uint32_t     GetProgramID() const override;
         bool         Load(const std::string &aPath, std::string &aError) override;
+        bool         Reload(std::string &aError) override;
 
     protected:
         bool         LoadVertexShader(const std::string &aFileName, std::string &aError) override;
@@ -41,6 +43,7 @@ namespace Framework
         const std::map<std::string, uint32_t> &GetUniforms(void) const override;
         const bool   GetUniformID(const std::string &aName, uint32_t *id) const override;
         const bool   GetAttributeID(const std::string &aName, uint32_t *id) const override;
+        UniformHandle GetUniformHandle(const std::string &aName) const override;
 
         bool         SetUniformMat4(const std::string &aName, const glm::mat4 aValue[], uint32_t aNumItems = 1) const override;
         bool         SetUniformMat3(const std::string &aName, const glm::mat3 aValue[], uint32_t aNumItems = 1) const override;
@@ -52,16 +55,41 @@ namespace Framework
         bool         SetUniformVec4(const std::string &aName, const glm::vec4 &aValue) const override;
         bool         SetUniformVec3(const std::string &aName, const glm::vec3 &aValue) const override;
         bool         SetUniformVec2(const std::string &aName, const glm::vec2 &aValue) const override;
+
+        bool         SetUniformMat4(UniformHandle aHandle, const glm::mat4 aValue[], uint32_t aNumItems = 1) const override;
+        bool         SetUniformMat3(UniformHandle aHandle, const glm::mat3 aValue[], uint32_t aNumItems = 1) const override;
+        bool         SetUniformTexture2D(UniformHandle aHandle, uint32_t aUnitID) const override;
+        bool         SetUniformTexture2DArray(UniformHandle aHandle, uint32_t aUnitID[], uint32_t aNumItems) const override;
+        bool         SetUniformFloat(UniformHandle aHandle, float aValue) const override;
+        bool         SetUniformInt(UniformHandle aHandle, int32_t aValue) const override;
+        bool         SetUniformBool(UniformHandle aHandle, bool aValue) const override;
+        bool         SetUniformVec4(UniformHandle aHandle, const glm::vec4 &aValue) const override;
+        bool         SetUniformVec3(UniformHandle aHandle, const glm::vec3 &aValue) const override;
+        bool         SetUniformVec2(UniformHandle aHandle, const glm::vec2 &aValue) const override;
         void         SetCustomParams(void) const override;
+
+        /**
+         * Binding points of the uniform blocks shared by all the programs. A program
+         * declaring one of these blocks is bound to it when it is linked
+         */
+        enum eSharedBlock
+        {
+            eFRAME_DATA_BINDING = 0,    /**< FrameData: camera and screen, updated once per frame */
+        };
         //std::string  GetShaderFilename() const override;
 
     private:
         bool         LoadShader(uint32_t shaderObjectID, const std::string &aFileName, std::string &aError, bool optional = false);
         void         BuildUniformsMap(void);
+        void         BindSharedBlocks(void);
+        // Returns the location of the uniform if its value differs from the shadowed one, -1 otherwise
+        GLint        UpdateUniform(UniformHandle aHandle, const void *aValue, uint32_t aBytes) const;
 
     protected:
         std::vector<uint32_t>           mShadersIDs; // temp
         std::map<std::string, uint32_t> mUniformNames;
+        std::unordered_map<std::string, UniformHandle> mUniformHandles;
+        std::vector<GLint>              mUniformLocations;   /**< Indexed by handle */
         uint32_t                        mProgramID;
         //std::string                     mFilename;
     };
@@ -41,6 +41,9 @@ namespace Framework
 
         void Bind();
 
+        // Zero until the block is prepared for a shader
+        GLint GetBlockSize() const { return mBlockSize; }
+
       private:
         bool                         mLinkedToShader;
 
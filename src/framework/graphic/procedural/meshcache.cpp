@@ -0,0 +1,55 @@
+/*******************************************************************************
+*  Author      : giron3s
+*  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+*                Unauthorized copying of this file, via any medium is strictly prohibited
+*                Proprietary and confidential
+*
+*   Brief      : Cache of the procedural meshes
+*******************************************************************************/
+
+#include "precompiled.h"
+#include "graphic/procedural/meshcache.h"
+#include "graphic/renderer.h"
+
+namespace Framework
+{
+    namespace Procedural
+    {
+        uint32_t MeshCache::Trim()
+        {
+            uint32_t lDropped = 0;
+            for ( auto lIter = mMeshes.begin(); lIter != mMeshes.end(); )
+            {
+                if ( lIter->second.use_count() == 1 )
+                {
+                    lIter = mMeshes.erase(lIter);
+                    ++lDropped;
+                }
+                else
+                    ++lIter;
+            }
+            return lDropped;
+        }
+
+        void MeshCache::Clear()
+        {
+            mMeshes.clear();
+            mStats = Stats();
+        }
+
+        MeshCache::Stats MeshCache::GetStats() const
+        {
+            Stats lStats = mStats;
+            lStats.mMeshes = static_cast<uint32_t>(mMeshes.size());
+            return lStats;
+        }
+
+        bool MeshCache::Upload(const Renderer& aRenderer, Asset3D& aMesh)
+        {
+            if ( aRenderer.PrepareForRendering(aMesh) )
+                return true;
+            WARNING("Failed to prepare the procedural mesh %s", aMesh.GetName().c_str());
+            return false;
+        }
+    }
+}
@@ -0,0 +1,99 @@
+/*******************************************************************************
+*  Author      : giron3s
+*  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+*                Unauthorized copying of this file, via any medium is strictly prohibited
+*                Proprietary and confidential
+*
+*   Brief      : Cache of the procedural meshes. A generator run with the same
+*                parameters gives the same geometry, so the models that ask for it
+*                share one asset and one upload instead of generating their own,
+*                and the render queue can draw them as instances of a single mesh.
+*******************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <type_traits>
+#include <unordered_map>
+#include <stdint.h>
+#include "graphic/asset3d.h"
+
+namespace Framework
+{
+    class Renderer;
+
+    namespace Procedural
+    {
+        class MeshCache
+        {
+        public:
+            struct Stats
+            {
+                uint32_t mMeshes = 0;   /**< Meshes in the cache */
+                uint32_t mHits = 0;     /**< Requests served from the cache */
+                uint32_t mMisses = 0;   /**< Requests that generated a mesh */
+            };
+
+            /**
+             * Finds the mesh of a generator, or generates and uploads it. The key is
+             * the generator type and the bytes of the parameters as they are passed,
+             * so 1 and 1.0f are different keys, and so are the explicit default
+             * parameters and the omitted ones
+             *
+             * @param aRenderer  Renderer that uploads a new mesh
+             * @param aArgs      Constructor parameters of the generator
+             *
+             * @return The shared mesh, nullptr if it could not be uploaded
+             */
+            template <typename TGenerator, typename... TArgs>
+            std::shared_ptr<const Asset3D> Get(const Renderer& aRenderer, const TArgs&... aArgs)
+            {
+                static_assert(std::is_base_of<Asset3D, TGenerator>::value, "The generator must build an Asset3D");
+                std::string lKey = typeid(TGenerator).name();
+                AppendKey(lKey, aArgs...);
+
+                auto lFound = mMeshes.find(lKey);
+                if ( lFound != mMeshes.end() )
+                {
+                    ++mStats.mHits;
+                    return lFound->second;
+                }
+                ++mStats.mMisses;
+                std::shared_ptr<Asset3D> lMesh = std::make_shared<TGenerator>(aArgs...);
+                if ( !Upload(aRenderer, *lMesh) )
+                    return nullptr;
+                mMeshes.emplace(std::move(lKey), lMesh);
+                return lMesh;
+            }
+
+            /**
+             * Drops the meshes no model holds anymore
+             *
+             * @return Number of dropped meshes
+             */
+            uint32_t Trim();
+            void     Clear();
+
+            Stats    GetStats() const;
+
+        private:
+            static void AppendKey(std::string&) {}
+
+            template <typename T, typename... TRest>
+            static void AppendKey(std::string& aKey, const T& aValue, const TRest&... aRest)
+            {
+                // Numbers and glm vectors, whose bytes are their value
+                static_assert(std::is_standard_layout<T>::value && !std::is_pointer<T>::value, "The generator parameters must be plain values");
+                aKey.append(reinterpret_cast<const char*>(&aValue), sizeof aValue);
+                AppendKey(aKey, aRest...);
+            }
+
+            static bool Upload(const Renderer& aRenderer, Asset3D& aMesh);
+
+            std::unordered_map<std::string, std::shared_ptr<const Asset3D>> mMeshes;
+            Stats                                                           mStats;
+        };
+    }
+}
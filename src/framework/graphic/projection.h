@@ -121,6 +121,27 @@ namespace Framework
             return mProjectionMatrix;
         }
 
+        /**
+         * Calculates the planes of the volume projected by a view-projection matrix
+         *
+         * The planes are in (normal, distance) form with the normals pointing inside
+         * the volume, ordered as left, right, bottom, top, near and far
+         *
+         * @param aViewProjection  View-projection matrix of the volume
+         * @param aPlanes          Out: the six planes of the volume
+         */
+        static void CalculateProjectionVolume(const glm::mat4& aViewProjection, glm::vec4 aPlanes[6])
+        {
+            for ( int i = 0; i < 6; ++i )
+            {
+                float sign = (i % 2) ? -1.0f : 1.0f;
+                glm::vec3 normal = glm::vec3(sign * aViewProjection[0][i / 2] + aViewProjection[0][3],
+                                             sign * aViewProjection[1][i / 2] + aViewProjection[1][3],
+                                             sign * aViewProjection[2][i / 2] + aViewProjection[2][3]);
+                aPlanes[i] = glm::vec4(normal, sign * aViewProjection[3][i / 2] + aViewProjection[3][3]) / glm::length(normal);
+            }
+        }
+
     protected:
         uint32_t  mProjectionType = PERSPECTIVE;
         float mAspect = 1.0f, // width/height
@@ -14,6 +14,8 @@
 #include "graphic/renderer.h"
 #include "graphic/opengl/opengl_renderer.h"
 #include "graphic/opengl/opengl_fontrenderer.h"
+#include "graphic/null/null_renderer.h"
+#include "graphic/null/null_fontrenderer.h"
 #include "graphic/procedural/texturedquad.h"
 #include "graphic/procedural/plane.h"
 #include "graphic/procedural/sphere.h"
@@ -28,12 +30,27 @@ namespace Framework
 {
     Renderer *Renderer::sRenderer = nullptr;
     FontRenderer *Renderer::sFontRenderer = nullptr;
+    Renderer::Backend Renderer::sBackend = Renderer::Backend::eOPENGL;
+
+    void Renderer::SetBackend(Backend aBackend)
+    {
+        ASSERT(sRenderer == nullptr && "The backend must be selected before the renderer is created");
+        sBackend = aBackend;
+    }
 
     Renderer *Renderer::GetInstance(void)
     {
         if ( sRenderer == NULL ) {
-            sRenderer = new OpenGLRenderer();
-            sFontRenderer = new OpenGLFontRenderer();
+            if ( sBackend == Backend::eNULL )
+            {
+                sRenderer = new NullRenderer();
+                sFontRenderer = new NullFontRenderer();
+            }
+            else
+            {
+                sRenderer = new OpenGLRenderer();
+                sFontRenderer = new OpenGLFontRenderer();
+            }
             auto lFont = std::shared_ptr<TrueTypeFont>(TrueTypeFont::New());
             const auto& lFontInfo = Engine::Instance()->Config().GetFontInfo();
             if ( !lFont->Init(lFontInfo.path, lFontInfo.size) )
@@ -58,14 +75,14 @@ namespace Framework
 
         // Force recalculation of projection volume planes
         aScene.GetActiveCamera()->RecalculateProjectionVolume();
+        // Upload the streamed and the reloaded assets, their models get the new bounds
+        if ( Engine::Instance()->ResourceManager().UpdateStreaming(*this) )
+            for ( auto lModel : aScene.GetModels3D() )
+                lModel->SyncAsset();
+
         // Set default render state
-        glDisable(GL_BLEND);
-        glDisable(GL_STENCIL_TEST);
-        glDepthMask(GL_TRUE);
-        glEnable(GL_DEPTH_TEST);
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        glFrontFace(GL_CCW);
-        glEnable(GL_CULL_FACE);
+        ResetRenderState();
+        sFontRenderer->BeginFrame();
         // Invoke 2D or 3D scene rendring routine
         if ( aScene.GetActiveCamera()->GetProjectionType() == Projection::ORTHOGRAPHIC )
             RenderScene2D(aScene);
@@ -82,15 +99,14 @@ namespace Framework
         lRT->BindForDrawning();
         lRT->Clear();
 
-        const GLenum lColorBuffers[2] = { GL_COLOR_ATTACHMENT0/*main*/, GL_COLOR_ATTACHMENT1/*modelId*/ };
         // Render Grid if presents
         if ( aScene.GetGrid() )
         {
             int lDistMult = (int)(aScene.GetActiveCamera()->GetPosition().z / aScene.GetGrid()->GetRescaleDistance());
             if ( lDistMult < 1 )
                 lDistMult = 1;
-            glDrawBuffers(1, lColorBuffers); // don't draw to modelId buffer
-            glDisable(GL_DEPTH_TEST);
+            SetDrawBuffers(1); // don't draw to modelId buffer
+            SetDepthTest(false);
             RenderGrid2D( // major
                 aScene.GetGrid()->GetMajorStep2D() * lDistMult,
                 glm::vec4(aScene.GetGrid()->GetColor(), 1.0f),
@@ -101,8 +117,8 @@ namespace Framework
                 glm::vec4(aScene.GetGrid()->GetColor(), 1.0f),
                 aScene.GetGrid()->GetMinorLineWidth(),
                 *aScene.GetActiveCamera());
-           glDrawBuffers(2, lColorBuffers); // draw to all buffers
-           glEnable(GL_DEPTH_TEST);
+           SetDrawBuffers(2); // draw to all buffers
+           SetDepthTest(true);
         }
 
         // Collect visible models
@@ -135,8 +151,8 @@ namespace Framework
         }
 
         // Render texts
-        glDisable(GL_DEPTH_TEST);
-        glDrawBuffers(1, lColorBuffers); // don't draw to modelId buffer
+        SetDepthTest(false);
+        SetDrawBuffers(1); // don't draw to modelId buffer
         const float lTextScale = 100.0 / aScene.GetActiveCamera()->GetPosition().z;
         constexpr uint32_t VERTICAL_SPACING = 20;
         for (auto lModel : lVisible2DModels)
@@ -154,11 +170,12 @@ namespace Framework
                 const glm::uvec2 lTextBox = Renderer::sFontRenderer->EvaluateText(lModel->mText.c_str(), lTextScale, VERTICAL_SPACING);
                 const glm::uvec3 lTextLayout(lPos.x - lTextBox.x / 2, lPos.y - lTextBox.y / 2, VERTICAL_SPACING);
                 const glm::vec4& lTextColor = Engine::Instance()->Config().GetFontInfo().color;
-                Renderer::sFontRenderer->RenderText(lModel->mText.c_str(), lTextScale, lTextLayout,
+                Renderer::sFontRenderer->QueueText(lModel->mText.c_str(), lTextScale, lTextLayout,
                     lTextColor, *lRT);
             }
-        glDrawBuffers(2, lColorBuffers); // draw to all buffers
-        glEnable(GL_DEPTH_TEST);
+        Renderer::sFontRenderer->Flush(); // all the labels in one draw
+        SetDrawBuffers(2); // draw to all buffers
+        SetDepthTest(true);
 
         // Render a transform gizmo if any
         if (aScene.mModelUnderTransform.mTarget &&
@@ -167,9 +184,9 @@ namespace Framework
             uint32_t lGizmoType = static_cast<uint32_t>(aScene.mModelUnderTransform.mTransformType);
             lGizmoType |= _2D_FLAG;
             Model2D* lModel2D = dynamic_cast<Model2D*>(aScene.mModelUnderTransform.mTarget);
-            glDisable(GL_DEPTH_TEST);
+            SetDepthTest(false);
             RenderTransformGizmo(lGizmoType, lModel2D, *aScene.GetActiveCamera());
-            glEnable(GL_DEPTH_TEST);
+            SetDepthTest(true);
         }
 
         lRT->Unbind();
@@ -182,7 +199,87 @@ namespace Framework
     }
 
 
-    void Renderer::RenderToShadowMap(const Light* aLight, const std::list<Model3D*>& aModels3D, const Shader* aShader) const
+    void Renderer::UpdateShadowMap(const Scene& aScene, const Light* aLight, const Shader* aShader) const
+    {
+        Light::ShadowMapCache& lCache = aLight->mShadowMapCache;
+
+        // A moved light needs a new view-projection matrix
+        if ( aLight->GetModelMatrix() != lCache.mLightMatrix )
+            aLight->DoUpdateViewProjectionMatrix = true;
+        const glm::mat4& lViewProjection = aLight->GetViewProjectionMatrix();
+
+        /* Only the casters inside the light volume can throw a shadow into it,
+           even if they are not visible from the camera */
+        glm::vec4 lPlanes[6];
+        Projection::CalculateProjectionVolume(lViewProjection, lPlanes);
+        mShadowCasters.clear();
+        aScene.QueryFrustum(lPlanes, 6, mShadowCasters);
+        mShadowCasters.erase(std::remove_if(mShadowCasters.begin(), mShadowCasters.end(),
+                                            [](const Model3D* aModel) { return !aModel->IsEnabled() || !aModel->IsShadowCaster() || !aModel->IsReady(); }),
+                             mShadowCasters.end());
+        SelectLods(*aScene.GetActiveCamera(), mLodScreenHeight, mShadowCasters);
+
+        // Compare the casters with the ones of the cached map, a caster that changed its level of detail changes the hash
+        const BoundingVolumeHierarchy& lHierarchy = aScene.GetModels3DHierarchy();
+        size_t lCasterHash = 0;
+        bool lCasterMoved = false;
+        for ( auto lModel : mShadowCasters )
+        {
+            lCasterHash += (std::hash<const Model3D*>()(lModel) + lModel->GetLod()) * 0x9E3779B1u;
+            lCasterMoved |= lHierarchy.GetStamp(lModel->GetSpatialProxy()) > lCache.mStamp;
+        }
+
+        if ( lCache.mValid && !lCasterMoved &&
+             lCache.mViewProjection == lViewProjection &&
+             lCache.mCasterCount == mShadowCasters.size() &&
+             lCache.mCasterHash == lCasterHash )
+        {
+            ++mShadowStats.mMapsCached;
+            return;
+        }
+
+        RenderToShadowMap(aLight, mShadowCasters, aShader);
+        CountLodTriangles(mShadowCasters);
+        ++mShadowStats.mMapsRefreshed;
+        mShadowStats.mCastersDrawn += static_cast<uint32_t>(mShadowCasters.size());
+
+        lCache.mValid = true;
+        lCache.mLightMatrix = aLight->GetModelMatrix();
+        lCache.mViewProjection = lViewProjection;
+        lCache.mCasterCount = mShadowCasters.size();
+        lCache.mCasterHash = lCasterHash;
+        lCache.mStamp = lHierarchy.GetStamp();
+    }
+
+    void Renderer::SelectLods(const Camera& aCamera, float aScreenHeight, const std::vector<Model3D*>& aModels) const
+    {
+        /* Pixels covered by one world unit, at unit distance for a perspective camera */
+        const float lFocal = 0.5f * aScreenHeight * aCamera.GetProjectionMatrix()[1][1];
+        const bool lPerspective = aCamera.GetProjectionType() == Projection::PERSPECTIVE;
+        for ( auto lModel : aModels )
+        {
+            const float lRadius = lModel->GetBoundingSphere().GetRadius();
+            float lPixelsPerUnit = lFocal;
+            if ( lPerspective ) /* at the closest point of the bounding sphere */
+                lPixelsPerUnit /= std::max(glm::length(lModel->GetPosition() - aCamera.GetPosition()) - lRadius, aCamera.GetZNear());
+            lModel->UpdateLod(lRadius * lPixelsPerUnit, mLodPixelError);
+        }
+    }
+
+    void Renderer::CountLodTriangles(const std::vector<Model3D*>& aModels) const
+    {
+        for ( auto lModel : aModels )
+        {
+            const Asset3D* lAsset = lModel->GetAsset3D();
+            const uint32_t lLod = lModel->GetLod();
+            mLodStats.mTriangles += lAsset->GetTriangleCount(lLod);
+            mLodStats.mFullTriangles += lAsset->GetTriangleCount(0);
+            if ( lLod > 0 )
+                ++mLodStats.mReducedModels;
+        }
+    }
+
+    void Renderer::RenderToShadowMap(const Light* aLight, const std::vector<Model3D*>& aModels3D, const Shader* aShader) const
     {
         //aShader->Attach();
         auto lRT_DepthMap = aLight->GetShadowMap();
@@ -191,16 +288,16 @@ namespace Framework
         lRT_DepthMap->BindForDrawning();
         lRT_DepthMap->Clear();
 
-        glCullFace(GL_FRONT);
-        for ( auto lModel : aModels3D ) /* go through ALL models because even
-            if a model is not visible, its shadow may still be visible. */
-            if ( lModel->IsEnabled() && lModel->IsShadowCaster() )
-            {
-                const auto lMVP = aLight->GetViewProjectionMatrix() * lModel->GetModelMatrix();
-                aShader->SetUniformMat4("u_MVPMatrix", &lMVP);
-                RenderModel3D_core(*lModel, RENDER_MODEL__NO_MATERIAL_FLAG); // to depth map of directional light
-            }
-        glCullFace(GL_BACK);
+        SetCullFrontFaces(true);
+        const Shader::UniformHandle lMVPHandle = aShader->GetUniformHandle("u_MVPMatrix");
+        for ( auto lModel : aModels3D ) /* the casters culled against the light volume,
+            even if a model is not visible, its shadow may still be visible. */
+        {
+            const auto lMVP = aLight->GetViewProjectionMatrix() * lModel->GetModelMatrix();
+            aShader->SetUniformMat4(lMVPHandle, &lMVP);
+            RenderModel3D_core(*lModel, RENDER_MODEL__NO_MATERIAL_FLAG); // to depth map of the light
+        }
+        SetCullFrontFaces(false);
 
         lRT_DepthMap->Unbind();
         //aShader->Detach();
@@ -221,9 +318,7 @@ namespace Framework
             lLightViewProjMatrix_scaled_biased = sScaleBiasMatrix * aLight->GetViewProjectionMatrix();
             aShader->SetUniformTexture2D("u_shadowMap", 3);
             auto lTexId = aLight->GetShadowMap()->GetTextureId(GL_DEPTH_ATTACHMENT);
-            glActiveTexture(GL_TEXTURE3);
-            glBindTexture(GL_TEXTURE_2D, lTexId);
-            ASSERT(glIsTexture(lTexId));
+            BindTexture(3, lTexId);
             //__(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
             //__(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
             //__(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL));
@@ -237,20 +332,29 @@ namespace Framework
 
     void Renderer::RenderScene3D(const Scene &aScene) const
     {
-        // Collect visible models
+        // Collect visible models from the bounding volume hierarchy of the scene
         float lAvgRadius = 0.0f;
         vector<Model3D*> lVisible3DModels;
-        lVisible3DModels.reserve(aScene.GetModels3D().size());
-        for (auto lModel : aScene.GetModels3D())
-        {
-            if ( lModel->IsEnabled() && aScene.GetActiveCamera()->IsObjectVisible(*lModel) )
-            {
-                lVisible3DModels.push_back(lModel);
-                lAvgRadius += lModel->GetBoundingSphere().GetRadius() / glm::length(lModel->GetScaleFactor());
-            }
-        }
+        vector<Model3D*> lPlaceholderModels; /* still streaming, only their bounds are drawn */
+        aScene.QueryFrustum(*aScene.GetActiveCamera(), lVisible3DModels);
+        lVisible3DModels.erase(std::remove_if(lVisible3DModels.begin(), lVisible3DModels.end(),
+                                              [&lPlaceholderModels](Model3D* aModel)
+                                              {
+                                                  if ( aModel->IsEnabled() && !aModel->IsReady() )
+                                                      lPlaceholderModels.push_back(aModel);
+                                                  return !aModel->IsEnabled() || !aModel->IsReady();
+                                              }),
+                               lVisible3DModels.end());
+        for (auto lModel : lVisible3DModels)
+            lAvgRadius += lModel->GetBoundingSphere().GetRadius() / glm::length(lModel->GetScaleFactor());
         lAvgRadius /= aScene.GetModels3D().size();
 
+        auto lRT_GBuffer = aScene.GetRenderTarget("GBuffer");
+        if ( !lRT_GBuffer )
+            CRASH("Scene '%s' does not have a GBuffer render target", aScene.GetName().c_str());
+        mLodScreenHeight = static_cast<float>(lRT_GBuffer->GetSize().y);
+        SelectLods(*aScene.GetActiveCamera(), mLodScreenHeight, lVisible3DModels);
+
         const DirectLight* lDirectLight = aScene.GetDirectLight();
         if ( lDirectLight && !lDirectLight->IsEnabled() )
             lDirectLight = nullptr;
@@ -273,38 +377,36 @@ namespace Framework
         const Shader* lDepthShader = Engine::Instance()->ResourceManager().FindShader("Depth");
         ASSERT(lDepthShader);
         lDepthShader->Attach();
+        mShadowStats = ShadowStats();
+        mLodStats = LodStats();
 
         if ( lDirectLight &&
              lDirectLight->GetShadowMap() ) // if there are shadows from this light source
-        { /* z position in light volume must be chosen so that all
-             shadow caster objects are entirely 'visible' from that point */
-            constexpr float AREA_SIDE_X = 500.0f + 200.0f;
-            constexpr float AREA_SIDE_Y = 500.0f + 50.0f;
-            constexpr float MAX_ELEVATION = 1500.0f;
-            lDirectLight->mProjectionVolume = glm::vec3(AREA_SIDE_X, AREA_SIDE_Y, MAX_ELEVATION);
-            RenderToShadowMap(lDirectLight, aScene.GetModels3D(), lDepthShader);
+        { /* the light volume must contain all shadow caster objects,
+             so it is fitted to the bounds of the scene models */
+            BoundingBox lSceneBounds;
+            if ( aScene.GetModels3DHierarchy().GetBounds(lSceneBounds) )
+                lDirectLight->SetShadowBounds(lSceneBounds);
+            UpdateShadowMap(aScene, lDirectLight, lDepthShader);
         }
 
         // Render spot light shadows
         for ( auto lLight : lVisibleSpotLights )
         {
             if( lLight->GetShadowMap() ) // if there are shadows from this light source
-                RenderToShadowMap(lLight, aScene.GetModels3D(), lDepthShader);            
+                UpdateShadowMap(aScene, lLight, lDepthShader);
         }
 
         // Render point light shadows
         for ( auto lLight : lVisiblePointLights )
         { 
             if ( lLight->GetShadowMap() ) // if there are shadows from this light source
-                RenderToShadowMap(lLight, aScene.GetModels3D(), lDepthShader);
+                UpdateShadowMap(aScene, lLight, lDepthShader);
         }
 
         lDepthShader->Detach();
 
         // Done rendering shadow maps
-        auto lRT_GBuffer = aScene.GetRenderTarget("GBuffer");
-        if ( !lRT_GBuffer )
-            CRASH("Scene '%s' does not have a GBuffer render target", aScene.GetName().c_str());
         // Geometry Pass - Render visible models
         // Note: Geometry pass is the only pass that updates depth buffer
         lRT_GBuffer->BindForDrawning();
@@ -314,6 +416,8 @@ namespace Framework
         if ( !lShader )
             CRASH("Deferred lighting shader/Geomerty pass was not found in Resource Manager");
         const glm::mat4 lViewProjectionMatrix = aScene.GetActiveCamera()->GetProjectionMatrix() * aScene.GetActiveCamera()->GetViewMatrix();
+        const glm::vec2 lScreenSize(lRT_GBuffer->GetSize().x, lRT_GBuffer->GetSize().y);
+        UpdateFrameData(*aScene.GetActiveCamera(), lScreenSize, lShader);
 
         const LightingInfo lLightingInfo{
             aScene.GetDirectLight(),
@@ -321,17 +425,33 @@ namespace Framework
             lVisibleSpotLights,
             0.05f };
 
+        /* The models are drawn through the render queue sorted by state. The selected
+           and focused models need their own stencil pass for the contour, so they
+           are still drawn one by one */
+        const Camera* lCamera = aScene.GetActiveCamera();
+        mRenderQueue.Clear();
         for ( auto lModel : lVisible3DModels )
         {
-            const glm::mat4 lModelViewProjectionMatrix = lViewProjectionMatrix * lModel->GetModelMatrix();
-
             uint32_t lFlags = 0;
             if ( std::find(aScene.mSelectedModels.begin(), aScene.mSelectedModels.end(), lModel) != aScene.mSelectedModels.end() )
                 lFlags = RENDER_MODEL__RENDER_SELECTED_FLAG;
             else if ( aScene.mFocusedModel == lModel )
                 lFlags = RENDER_MODEL__RENDER_FOCUSED_FLAG;
-            RenderModel3D_GPass(*lModel, lModelViewProjectionMatrix, lShader,
-                lFlags, lLightingInfo);
+
+            if ( lFlags )
+                RenderModel3D_GPass(*lModel, lViewProjectionMatrix * lModel->GetModelMatrix(), lShader,
+                    lFlags, lLightingInfo);
+            else
+                QueueModel3D_GPass(mRenderQueue, *lModel, lShader,
+                    glm::length(lModel->GetPosition() - lCamera->GetPosition()) / lCamera->GetZFar());
+        }
+        mRenderQueue.Sort();
+        SubmitQueue_GPass(mRenderQueue);
+        CountLodTriangles(lVisible3DModels);
+
+        for ( auto lModel : lVisible3DModels )
+        {
+            const glm::mat4 lModelViewProjectionMatrix = lViewProjectionMatrix * lModel->GetModelMatrix();
 
             // Render overlay wireframe if requested
             if ( GetWireframeMode() == Renderer::RENDER_WIREFRAME_OVERLAY )
@@ -347,10 +467,13 @@ namespace Framework
                 lModel->GetRenderAABB() || this->GetRenderAABB(), lModel->GetRenderOOBB() || this->GetRenderOOBB());
         }
 
+        for ( auto lModel : lPlaceholderModels )
+            RenderBoundingBox(lModel->GetOOBB(), lViewProjectionMatrix * lModel->GetModelMatrix(), glm::vec4(0.6f, 0.6f, 0.6f, 1.0f));
+
         // Render Grid if presents
         if (aScene.GetGrid())
         {
-            glEnable(GL_DEPTH_TEST);
+            SetDepthTest(true);
             RenderGrid3D(// Major
                 aScene.GetGrid()->GetMajorStep3D(),
                 aScene.GetGrid()->GetSize3D(),
@@ -364,7 +487,7 @@ namespace Framework
                 aScene.GetGrid()->GetMinorLineWidth()+1,
                 *aScene.GetActiveCamera());
 
-            glEnable(GL_DEPTH_TEST);
+            SetDepthTest(true);
         }
 
         // Render a transform gizmo if necessary
@@ -375,9 +498,9 @@ namespace Framework
             Model3D* lModel3D = dynamic_cast<Model3D*>(aScene.mModelUnderTransform.mTarget);
             GLenum lColorBuffers[4] = { GL_COLOR_ATTACHMENT0/*diffuse*/, GL_COLOR_ATTACHMENT1/*modelId*/, GL_NONE/*position*/, GL_COLOR_ATTACHMENT3/*normal*/ };
             //glDrawBuffers(4, lColorBuffers); // don't draw to position buffer
-            glDisable(GL_DEPTH_TEST);
+            SetDepthTest(false);
             RenderTransformGizmo(lGizmoType, lModel3D, *aScene.GetActiveCamera());
-            glEnable(GL_DEPTH_TEST);
+            SetDepthTest(true);
             lColorBuffers[2] = GL_COLOR_ATTACHMENT2;
             //glDrawBuffers(4, lColorBuffers); // draw to all buffers
         }
@@ -435,18 +558,14 @@ namespace Framework
 
         // When we get here the depth buffer is already populated and the stencil pass
         // depends on it, but it does not write to it.
-        glDepthMask(GL_FALSE);
-        glDisable(GL_DEPTH_TEST);
-        glEnable(GL_BLEND);
-        glBlendEquation(GL_FUNC_ADD);
-        glBlendFunc(GL_ONE, GL_ONE);
+        SetDepthWrite(false);
+        SetDepthTest(false);
+        SetAdditiveBlending(true);
 
-        GLenum lColorBuffers[2] = { GL_COLOR_ATTACHMENT0/*main*/, GL_COLOR_ATTACHMENT1/*modelId*/ };
-        glDrawBuffers(1, lColorBuffers); // don't draw to modelId buffer
+        SetDrawBuffers(1); // don't draw to modelId buffer
 
         const glm::mat4 ViewProjectionMatrix = aScene.GetActiveCamera()->GetProjectionMatrix() * aScene.GetActiveCamera()->GetViewMatrix();
         glm::mat4 MVP(1.0f); // identity
-        glm::vec2 lScreenSize(lRT_GBuffer->GetSize().x, lRT_GBuffer->GetSize().y); // TODO...
 
         // Ambient - always
         lShader = Engine::Instance()->ResourceManager().FindShader("DeferredShading_AmbientPass");
@@ -454,24 +573,12 @@ namespace Framework
             CRASH("Deferred lighting shader/Ambient pass was not found in Resource Manager");
         lShader->Attach();
         lShader->SetUniformTexture2D("u_diffuseMap", 0);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT0));
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        BindTexture(0, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT0), true);
         lShader->SetUniformTexture2D("u_normalMap", 1);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT3));
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        lShader->SetUniformVec2("u_screenSize", lScreenSize);
-        glBindVertexArray(((OpenGLRenderer*)this)->GetTempVAO());
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-        //glBindVertexArray(GL_NONE);
-        ASSERT(glGetError() == GL_NO_ERROR);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, GL_NONE);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, GL_NONE);
+        BindTexture(1, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT3), true);
+        DrawScreenQuad();
+        BindTexture(0, GL_NONE);
+        BindTexture(1, GL_NONE);
         lShader->Detach();
 
         // Directional light - if needed
@@ -483,36 +590,20 @@ namespace Framework
                 CRASH("Deferred lighting shader/Directional light pass was not found in Resource Manager");
             lShader->Attach();
             lShader->SetUniformTexture2D("u_diffuseMap", 0);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT0));
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            BindTexture(0, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT0), true);
             lShader->SetUniformTexture2D("u_positionMap", 1);
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT2));
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            BindTexture(1, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT2), true);
             lShader->SetUniformTexture2D("u_normalMap", 2);
-            glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT3));
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-            lShader->SetUniformVec2("u_screenSize", lScreenSize);
-            glBindVertexArray(((OpenGLRenderer*)this)->GetTempVAO());
+            BindTexture(2, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT3), true);
             glm::vec3 pos = glm::normalize(lLight->GetPosition());
             ASSERT_vec3_is_normalized(pos);
             lShader->SetUniformVec3("u_LightPosition", pos); // = any_vertex-to-light vector
             lShader->SetUniformVec4("u_LightColor", glm::vec4(lLight->GetDiffuse(), 1.0f));
             SetupShaderShadowParams(lLight, lShader);
-            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-            //glBindVertexArray(GL_NONE);
-            ASSERT(glGetError() == GL_NO_ERROR);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, GL_NONE);
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, GL_NONE);
-            glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, GL_NONE);
+            DrawScreenQuad();
+            BindTexture(0, GL_NONE);
+            BindTexture(1, GL_NONE);
+            BindTexture(2, GL_NONE);
             lShader->Detach();
         }
 
@@ -524,28 +615,29 @@ namespace Framework
                 CRASH("Deferred lighting shader/Spot light pass was not found in Resource Manager");
             lShader->Attach();
             lShader->SetUniformTexture2D("u_diffuseMap", 0);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT0));
+            BindTexture(0, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT0));
             lShader->SetUniformTexture2D("u_positionMap", 1);
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT2));
+            BindTexture(1, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT2));
             lShader->SetUniformTexture2D("u_normalMap", 2);
-            glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT3));
-            lShader->SetUniformVec2("u_screenSize", lScreenSize);
+            BindTexture(2, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT3));
+            const Shader::UniformHandle lLightPosition = lShader->GetUniformHandle("u_LightPosition");
+            const Shader::UniformHandle lLightColor = lShader->GetUniformHandle("u_LightColor");
+            const Shader::UniformHandle lLightRadius = lShader->GetUniformHandle("u_LightRadius");
+            const Shader::UniformHandle lLightDirection = lShader->GetUniformHandle("u_LightDirection");
+            const Shader::UniformHandle lLightConeAngle = lShader->GetUniformHandle("u_LightConeAngle");
             for ( auto lLight : lVisibleSpotLights )
             {
                 MVP = ViewProjectionMatrix * lLight->GetModelMatrix();
                 //lShader->SetUniformMat4("u_MVPMatrix", &MVP); // position and radius for sphere defining a spot light
-                lShader->SetUniformVec3("u_LightPosition", lLight->GetPosition());
-                lShader->SetUniformVec4("u_LightColor", glm::vec4(lLight->GetDiffuse(), 1.0f));
-                lShader->SetUniformFloat("u_LightRadius", lLight->GetCutoff());
+                lShader->SetUniformVec3(lLightPosition, lLight->GetPosition());
+                lShader->SetUniformVec4(lLightColor, glm::vec4(lLight->GetDiffuse(), 1.0f));
+                lShader->SetUniformFloat(lLightRadius, lLight->GetCutoff());
                 ASSERT_vec3_is_normalized(lLight->GetDirection());
-                lShader->SetUniformVec3("u_LightDirection", lLight->GetDirection());
-                lShader->SetUniformFloat("u_LightConeAngle", lLight->GetConeAngle());
+                lShader->SetUniformVec3(lLightDirection, lLight->GetDirection());
+                lShader->SetUniformFloat(lLightConeAngle, lLight->GetConeAngle());
                 //glDrawElements(GL_TRIANGLES, sUnitSphereIndexCount, GL_UNSIGNED_INT, 0); 
                 SetupShaderShadowParams(lLight, lShader);
-                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+                DrawScreenQuad();
             }
         }
 
@@ -589,29 +681,26 @@ namespace Framework
                 CRASH("Deferred lighting shader/Point light pass was not found in Resource Manager");
             lShader->Attach();
             lShader->SetUniformTexture2D("u_diffuseMap", 0);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT0));
+            BindTexture(0, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT0));
             lShader->SetUniformTexture2D("u_positionMap", 1);
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT2));
+            BindTexture(1, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT2));
             lShader->SetUniformTexture2D("u_normalMap", 2);
-            glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT3));
-            lShader->SetUniformVec2("u_screenSize", lScreenSize);
+            BindTexture(2, lRT_GBuffer->GetTextureId(GL_COLOR_ATTACHMENT3));
             //glBindVertexArray(sUnitSphereVA);
+            const Shader::UniformHandle lLightPosition = lShader->GetUniformHandle("u_LightPosition");
+            const Shader::UniformHandle lLightColor = lShader->GetUniformHandle("u_LightColor");
+            const Shader::UniformHandle lLightRadius = lShader->GetUniformHandle("u_LightRadius");
             for ( auto lLight : lVisiblePointLights )
             {
                 MVP = ViewProjectionMatrix * lLight->GetModelMatrix();
                 //lShader->SetUniformMat4("u_MVPMatrix", &MVP); // position and radius for sphere defining a point light
-                lShader->SetUniformVec3("u_LightPosition", lLight->GetPosition());
-                lShader->SetUniformVec4("u_LightColor", glm::vec4(lLight->GetDiffuse(), 1.0f));
-                lShader->SetUniformFloat("u_LightRadius", lLight->GetCutoff());
+                lShader->SetUniformVec3(lLightPosition, lLight->GetPosition());
+                lShader->SetUniformVec4(lLightColor, glm::vec4(lLight->GetDiffuse(), 1.0f));
+                lShader->SetUniformFloat(lLightRadius, lLight->GetCutoff());
                 //glDrawElements(GL_TRIANGLES, sUnitSphereIndexCount, GL_UNSIGNED_INT, 0); 
                 SetupShaderShadowParams(lLight, lShader);
-                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+                DrawScreenQuad();
             }
-            //glBindVertexArray(GL_NONE);
-            ASSERT(glGetError() == GL_NO_ERROR);
             lShader->Detach();
         }
     }
@@ -621,9 +710,12 @@ namespace Framework
         if (!mRenderDebugInfo)
             return;
 
-        __(glPolygonMode(GL_FRONT_AND_BACK, GL_FILL));
+        SetPolygonFill();
         const glm::uvec3 lFPSLayout(900, 15, 0);
         const glm::uvec3 lRTLayout(700, 15, 0);
+        const glm::uvec3 lTextStatsLayout(700, 35, 0);
+        const glm::uvec3 lStreamingStatsLayout(700, 55, 0);
+        const glm::uvec3 lLodStatsLayout(700, 75, 0);
         const glm::vec4& lTextColor = Engine::Instance()->Config().GetFontInfo().color;
         
         string lAttachmentName = "";
@@ -650,5 +742,21 @@ namespace Framework
             Renderer::sFontRenderer->RenderText(FPS::GetInstance()->GetFPSInfo().c_str(), 0.3f, lFPSLayout, lTextColor, *lRenderTargets.at(mRenderTargetIdx));
             Renderer::sFontRenderer->RenderText((lRenderTargets.at(mRenderTargetIdx)->GetName() + lAttachmentName).c_str(), 0.3f, lRTLayout, lTextColor, *lRenderTargets.at(mRenderTargetIdx));
         }
+
+        char lTextStats[64];
+        snprintf(lTextStats, sizeof(lTextStats), "Text layout cache hits: %.1f%%",
+                 Renderer::sFontRenderer->GetLayoutStats().GetHitRate() * 100.0f);
+        Renderer::sFontRenderer->RenderText(lTextStats, 0.3f, lTextStatsLayout, lTextColor, *lRenderTargets.at(0));
+
+        const AssetStreamer::Stats lStreaming = Engine::Instance()->ResourceManager().GetStreamingStats();
+        char lStreamingStats[96];
+        snprintf(lStreamingStats, sizeof(lStreamingStats), "Streaming queue: %u, latency avg %.1f ms, max %.1f ms",
+                 lStreaming.GetQueueDepth(), lStreaming.mAverageLatency, lStreaming.mMaxLatency);
+        Renderer::sFontRenderer->RenderText(lStreamingStats, 0.3f, lStreamingStatsLayout, lTextColor, *lRenderTargets.at(0));
+
+        char lLodStats[96];
+        snprintf(lLodStats, sizeof(lLodStats), "LOD triangles: %llu of %llu, %u models reduced",
+                 (unsigned long long)mLodStats.mTriangles, (unsigned long long)mLodStats.mFullTriangles, mLodStats.mReducedModels);
+        Renderer::sFontRenderer->RenderText(lLodStats, 0.3f, lLodStatsLayout, lTextColor, *lRenderTargets.at(0));
     }
 }
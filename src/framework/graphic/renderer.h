@@ -16,6 +16,7 @@
 #include "graphic/camera.h"
 #include "graphic/viewport.h"
 #include "graphic/fontrender.h"
+#include "graphic/renderqueue.h"
 
 
 #define RENDER_MODEL__RENDER_FOCUSED_FLAG  1
@@ -35,6 +36,16 @@ namespace Framework
         static Renderer* GetInstance(void);
         static void DisposeInstance(void);
 
+        /**
+         * Graphic API of the renderer and of the shaders, render targets and font
+         * renderer created by the factories. It must be set before the first call
+         * to GetInstance(). The null backend records the rendering commands instead
+         * of executing them, so the frames can be rendered without a GPU
+         */
+        enum class Backend { eOPENGL, eNULL };
+        static void    SetBackend(Backend aBackend);
+        static Backend GetBackend() { return sBackend; }
+
         /**
          * Destructor
          */
@@ -74,6 +85,54 @@ namespace Framework
          */
         void RenderScene(const Scene& aScene) const;
 
+        /**
+         * Shadow map counters of the last rendered frame
+         */
+        struct ShadowStats
+        {
+            uint32_t mCastersDrawn = 0;   /**< Shadow casters drawn into the refreshed maps */
+            uint32_t mMapsRefreshed = 0;  /**< Shadow maps rendered again */
+            uint32_t mMapsCached = 0;     /**< Shadow maps kept from a previous frame */
+        };
+        const ShadowStats& GetShadowStats() const { return mShadowStats; }
+
+        /**
+         * Triangles of the last rendered frame, in the geometry pass and in the
+         * refreshed shadow maps, with the selected levels of detail and at full resolution
+         */
+        struct LodStats
+        {
+            uint64_t mTriangles = 0;      /**< Triangles drawn */
+            uint64_t mFullTriangles = 0;  /**< Triangles the same draws have at full resolution */
+            uint32_t mReducedModels = 0;  /**< Models drawn with a coarser level than the full resolution */
+        };
+        const LodStats& GetLodStats() const { return mLodStats; }
+
+        /**
+         * Largest error of the levels of detail in pixels, a value of 0 or less
+         * always draws the models at full resolution
+         */
+        void  SetLodPixelError(float aPixels) { mLodPixelError = aPixels; }
+        float GetLodPixelError() const { return mLodPixelError; }
+
+        /**
+         * Counters of the geometry pass queue of the last rendered frame
+         */
+        const RenderQueue::Stats& GetRenderQueueStats() const { return mRenderQueue.GetStats(); }
+
+        /**
+         * Draws the models that share a mesh with one instanced draw per rendering
+         * list, see RenderQueue::SetInstancing. Enabled by default
+         */
+        void SetInstancing(bool aEnable) { mRenderQueue.SetInstancing(aEnable); }
+        bool IsInstancing() const        { return mRenderQueue.IsInstancing(); }
+
+        /**
+         * Counters of the last text flush and of the text layout cache
+         */
+        const FontRenderer::Stats&    GetTextStats() const       { return sFontRenderer->GetStats(); }
+        const TextLayoutCache::Stats& GetTextLayoutStats() const { return sFontRenderer->GetLayoutStats(); }
+
     private:
         void RenderScene2D(const Scene& aScene) const;
         void RenderScene3D(const Scene& aScene) const;
@@ -85,6 +144,30 @@ namespace Framework
          
         std::function<bool(Model2D*, Model2D*)> mRenderSort2D = std::bind(&Renderer::RenderSort2D, this, _1, _2);
 
+        /**
+         * Culls the shadow casters against the volume of the light and renders its
+         * shadow map, unless the map of the previous frame is still valid
+         */
+        void UpdateShadowMap(const Scene& aScene, const Light* aLight, const Shader* aShader) const;
+
+        /**
+         * Selects the level of detail of the models from their projected size on the
+         * active camera, shadow casters included so their shadow matches the model
+         */
+        void SelectLods(const Camera& aCamera, float aScreenHeight, const std::vector<Model3D*>& aModels) const;
+
+        /**
+         * Adds the triangles drawn for the models to the level of detail counters
+         */
+        void CountLodTriangles(const std::vector<Model3D*>& aModels) const;
+
+        mutable ShadowStats           mShadowStats;
+        mutable LodStats              mLodStats;
+        float                         mLodPixelError = 1.0f;
+        mutable float                 mLodScreenHeight = 0.0f; /**< Height of the frame the levels of detail are selected for */
+        mutable std::vector<Model3D*> mShadowCasters; /**< Scratch buffer of the casters of a light */
+        mutable RenderQueue           mRenderQueue;   /**< Draw items of the geometry pass */
+
     public:
         void SetRenderSort2D(const std::function<bool(Model2D*, Model2D*)> &aRenderSort) { mRenderSort2D = aRenderSort; }
 
@@ -117,7 +200,7 @@ namespace Framework
         // This functions simply passes Model's geometry to rendering pipeline
         virtual void RenderModel3D_core(const Model3D& aModel, uint32_t aFlags) const = 0;
         // Render depthmaps of shadow casters to corresponding texture
-        virtual void RenderToShadowMap(const Light* aLight, const std::list<Model3D*>& aModels3D, const Shader* aShader) const;
+        virtual void RenderToShadowMap(const Light* aLight, const std::vector<Model3D*>& aModels3D, const Shader* aShader) const;
 
     public:
 
@@ -154,7 +237,30 @@ namespace Framework
 
     protected:
         virtual void RenderModel3DWireframe_GPass(const Model3D& aModel, const glm::mat4& aModelViewProjectionMatrix, const glm::vec4& aColor) const = 0;
+        // Adds the rendering lists of the model to the geometry pass queue
+        virtual void QueueModel3D_GPass(RenderQueue& aQueue, const Model3D& aModel, const Shader* aShader, float aDepth) const = 0;
+        // Draws a sorted geometry pass queue
+        virtual void SubmitQueue_GPass(RenderQueue& aQueue) const = 0;
+        // Uploads the camera and screen data of the FrameData uniform block shared by the
+        // passes, once per frame. The program of aShader gives the layout of the block
+        virtual void UpdateFrameData(const Camera& aCamera, const glm::vec2& aScreenSize, const Shader* aShader) const = 0;
         virtual void SetupShaderShadowParams(const Light* aLight, const Shader* aShader) const;
+
+        /**
+         * Render state used by the scene passes, so they don't call the graphic API
+         */
+        virtual void ResetRenderState() const = 0;
+        virtual void SetDepthTest(bool aEnable) const = 0;
+        virtual void SetDepthWrite(bool aEnable) const = 0;
+        virtual void SetAdditiveBlending(bool aEnable) const = 0;
+        virtual void SetCullFrontFaces(bool aFront) const = 0;
+        virtual void SetPolygonFill() const = 0;
+        // Draws to the first aCount color attachments of the bound render target
+        virtual void SetDrawBuffers(uint32_t aCount) const = 0;
+        // Binds a 2D texture to a texture unit, optionally switching it to nearest filtering
+        virtual void BindTexture(uint32_t aUnit, uint32_t aTexture, bool aNearest = false) const = 0;
+        // Draws a quad covering the whole render target
+        virtual void DrawScreenQuad() const = 0;
     public:
 
         /**
@@ -370,6 +476,7 @@ namespace Framework
     protected:
         static Renderer* sRenderer;             /**< Singleton instance */
         static FontRenderer* sFontRenderer;         /**< Singleton instance */
+        static Backend sBackend;                    /**< Graphic API of the singleton and the factories */
         WireframeMode          mWireframeMode;        /**< Sets the wireframe mode rendering. @see WireframeMode */
         bool                   mRenderNormals;        /**< Global aFlag to enable model normals rendering */
         bool                   mRenderBoundingSphere; /**< Global aFlag to enable model bounding sphere rendering */
@@ -0,0 +1,206 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Sort key render queue
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include <chrono>
+#include "graphic/renderqueue.h"
+
+namespace Framework
+{
+    namespace
+    {
+        const uint32_t sPassBits = 4;
+        const uint32_t sShaderBits = 8;
+        const uint32_t sMaterialBits = 8;
+        const uint32_t sTextureBits = 16;
+        const uint32_t sMeshBits = 16;
+        const uint32_t sDepthBits = 12;
+
+        /* Fewest items with the same geometry that are drawn instanced */
+        const uint32_t sMinInstances = 2;
+
+        const uint32_t sDepthShift = 0;
+        const uint32_t sMeshShift = sDepthShift + sDepthBits;
+        const uint32_t sTextureShift = sMeshShift + sMeshBits;
+        const uint32_t sMaterialShift = sTextureShift + sTextureBits;
+        const uint32_t sShaderShift = sMaterialShift + sMaterialBits;
+        const uint32_t sPassShift = sShaderShift + sShaderBits;
+        static_assert(sPassShift + sPassBits == 64, "The sort key fields must fill 64 bits");
+
+        inline uint64_t Field(uint32_t aValue, uint32_t aBits, uint32_t aShift)
+        {
+            return (uint64_t(aValue) & ((uint64_t(1) << aBits) - 1)) << aShift;
+        }
+    }
+
+    uint64_t RenderQueue::MakeKey(uint32_t aPass, uint32_t aShader, uint32_t aMaterial, uint32_t aTexture,
+                                  uint32_t aMesh, float aDepth)
+    {
+        ASSERT(aPass < ePASS_COUNT);
+        const float lDepth = std::min(std::max(aDepth, 0.0f), 1.0f);
+        const uint32_t lDepthBits = static_cast<uint32_t>(lDepth * ((1 << sDepthBits) - 1));
+        return Field(aPass, sPassBits, sPassShift) |
+               Field(aShader, sShaderBits, sShaderShift) |
+               Field(aMaterial, sMaterialBits, sMaterialShift) |
+               Field(aTexture, sTextureBits, sTextureShift) |
+               Field(aMesh, sMeshBits, sMeshShift) |
+               Field(lDepthBits, sDepthBits, sDepthShift);
+    }
+
+    uint32_t RenderQueue::Intern(std::unordered_map<const void*, uint32_t>& aIds, const void* aPointer)
+    {
+        auto lResult = aIds.emplace(aPointer, static_cast<uint32_t>(aIds.size()));
+        return lResult.first->second;
+    }
+
+    void RenderQueue::Clear()
+    {
+        mItems.clear();
+        mOrder.clear();
+        mShaderIds.clear();
+        mMeshIds.clear();
+    }
+
+    void RenderQueue::Add(uint32_t aPass, const Shader* aShader, uint32_t aMaterial, uint32_t aTexture,
+                          const Asset3D* aMesh, float aDepth, const Model3D* aModel, uint32_t aSubmesh, uint32_t aLod)
+    {
+        Item lItem;
+        if ( mInstancing )
+            lItem.mKey = MakeKey(aPass, Intern(mShaderIds, aShader), aMaterial, aTexture, Intern(mMeshIds, aMesh), 0.0f) |
+                         Field((aLod << 8) | (aSubmesh & 0xFF), sDepthBits, sDepthShift);
+        else
+            lItem.mKey = MakeKey(aPass, Intern(mShaderIds, aShader), aMaterial, aTexture, Intern(mMeshIds, aMesh), aDepth);
+        lItem.mShader = aShader;
+        lItem.mMaterial = aMaterial;
+        lItem.mTexture = aTexture;
+        lItem.mMesh = aMesh;
+        lItem.mModel = aModel;
+        lItem.mSubmesh = aSubmesh;
+        lItem.mLod = aLod;
+        mItems.push_back(lItem);
+    }
+
+    void RenderQueue::Sort()
+    {
+        const auto lStart = std::chrono::high_resolution_clock::now();
+
+        const size_t n = mItems.size();
+        mKeys.resize(n);
+        mKeysTemp.resize(n);
+        mOrder.resize(n);
+        mOrderTemp.resize(n);
+        for ( size_t i = 0; i < n; ++i )
+        {
+            mKeys[i] = mItems[i].mKey;
+            mOrder[i] = static_cast<uint32_t>(i);
+        }
+
+        // LSD radix sort, one byte per pass. A pass where all the keys have the
+        // same byte would not move anything, so it is skipped
+        for ( uint32_t lShift = 0; lShift < 64; lShift += 8 )
+        {
+            size_t lCount[256] = {};
+            for ( size_t i = 0; i < n; ++i )
+                ++lCount[(mKeys[i] >> lShift) & 0xFF];
+            if ( n == 0 || lCount[(mKeys[0] >> lShift) & 0xFF] == n )
+                continue;
+
+            size_t lOffset = 0;
+            for ( size_t b = 0; b < 256; ++b )
+            {
+                const size_t c = lCount[b];
+                lCount[b] = lOffset;
+                lOffset += c;
+            }
+            for ( size_t i = 0; i < n; ++i )
+            {
+                const size_t lDest = lCount[(mKeys[i] >> lShift) & 0xFF]++;
+                mKeysTemp[lDest] = mKeys[i];
+                mOrderTemp[lDest] = mOrder[i];
+            }
+            mKeys.swap(mKeysTemp);
+            mOrder.swap(mOrderTemp);
+        }
+
+        mStats.mSortTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - lStart).count();
+    }
+
+    void RenderQueue::Submit(RenderQueueBackend& aBackend)
+    {
+        ASSERT(mOrder.size() == mItems.size());
+        const double lSortTime = mStats.mSortTime;
+        mStats = Stats();
+        mStats.mSortTime = lSortTime;
+        mStats.mItems = static_cast<uint32_t>(mItems.size());
+        mStats.mMeshes = static_cast<uint32_t>(mMeshIds.size());
+
+        auto lSameGeometry = [](const Item& a, const Item& b)
+        {
+            return a.mShader == b.mShader && a.mMaterial == b.mMaterial && a.mTexture == b.mTexture &&
+                   a.mMesh == b.mMesh && a.mSubmesh == b.mSubmesh && a.mLod == b.mLod;
+        };
+
+        const Item* lLast = nullptr;
+        const Model3D* lObject = nullptr;   // model of the bound per object state
+        for ( size_t i = 0; i < mOrder.size(); )
+        {
+            const Item& lItem = mItems[mOrder[i]];
+            size_t lEnd = i + 1;
+            if ( mInstancing )
+                while ( lEnd < mOrder.size() && lSameGeometry(lItem, mItems[mOrder[lEnd]]) )
+                    ++lEnd;
+
+            // Uniforms belong to the shader program, so a new shader needs them again
+            const bool lNewShader = !lLast || lItem.mShader != lLast->mShader;
+            if ( lNewShader )
+            {
+                aBackend.BindShader(lItem.mShader);
+                ++mStats.mStateChanges;
+            }
+            if ( lNewShader || lItem.mMaterial != lLast->mMaterial )
+            {
+                aBackend.BindMaterial(lItem.mMaterial);
+                ++mStats.mStateChanges;
+            }
+            if ( !lLast || lItem.mTexture != lLast->mTexture )
+            {
+                aBackend.BindTexture(lItem.mTexture);
+                ++mStats.mStateChanges;
+            }
+            if ( !lLast || lItem.mMesh != lLast->mMesh )
+            {
+                aBackend.BindMesh(lItem.mMesh);
+                ++mStats.mStateChanges;
+            }
+            if ( lEnd - i >= sMinInstances )
+            {
+                mInstances.clear();
+                for ( size_t j = i; j < lEnd; ++j )
+                    mInstances.push_back(mItems[mOrder[j]].mModel);
+                aBackend.DrawInstanced(mInstances.data(), static_cast<uint32_t>(mInstances.size()), lItem.mSubmesh, lItem.mLod);
+                ++mStats.mInstancedDraws;
+                mStats.mInstances += static_cast<uint32_t>(mInstances.size());
+                // The instances do not use the per object state, it is unchanged
+            }
+            else
+            {
+                if ( lNewShader || lItem.mModel != lObject )
+                {
+                    aBackend.BindObject(lItem.mModel);
+                    ++mStats.mObjectChanges;
+                    lObject = lItem.mModel;
+                }
+                aBackend.Draw(lItem.mModel, lItem.mSubmesh);
+            }
+            ++mStats.mDrawCalls;
+            lLast = &lItem;
+            i = lEnd;
+        }
+    }
+}
@@ -0,0 +1,157 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Queue of the draw items of a frame. Every item (one rendering list
+ *                of a model) takes a 64 bit sort key built from its render state, the
+ *                queue is radix sorted once per frame, and on submit only the state
+ *                that differs from the previous item is sent to the backend. The queue
+ *                does not know about the graphic API, all the work is done through
+ *                the RenderQueueBackend interface.
+ *
+ *                Sort key layout, from the most to the least significant bits:
+ *
+ *                    | pass 4 | shader 8 | material 8 | texture 16 | mesh 16 | depth 12 |
+ *
+ *                With instancing the depth field holds the level of detail and the
+ *                rendering list instead, so the items that draw the same geometry
+ *                end up next to each other and go out as a single instanced draw.
+ *                Inside such a run the items keep the order they were added in.
+ *******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+
+namespace Framework
+{
+    class Shader;
+    class Asset3D;
+    class Model3D;
+
+    /**
+     * Receives the state changes and the draws of a submitted queue. Every Bind
+     * call is only made when the state differs from the one of the previous item
+     */
+    class RenderQueueBackend
+    {
+    public:
+        virtual ~RenderQueueBackend() = default;
+
+        virtual void BindShader(const Shader* aShader) = 0;
+        virtual void BindMaterial(uint32_t aMaterial) = 0;
+        virtual void BindTexture(uint32_t aTexture) = 0;
+        virtual void BindMesh(const Asset3D* aMesh) = 0;
+        // Per object state (matrices, model id), bound when the model of the item changes
+        virtual void BindObject(const Model3D* aModel) = 0;
+        virtual void Draw(const Model3D* aModel, uint32_t aSubmesh) = 0;
+        // One draw of the rendering list for every model, the per object state goes
+        // with the instances and BindObject is not called for them
+        virtual void DrawInstanced(const Model3D* const* aModels, uint32_t aCount, uint32_t aSubmesh, uint32_t aLod) = 0;
+    };
+
+    class RenderQueue
+    {
+    public:
+        enum ePass
+        {
+            ePASS_OPAQUE = 0,
+            ePASS_COUNT = 16
+        };
+
+        struct Item
+        {
+            uint64_t       mKey;
+            const Shader*  mShader;
+            uint32_t       mMaterial;
+            uint32_t       mTexture;
+            const Asset3D* mMesh;
+            const Model3D* mModel;
+            uint32_t       mSubmesh;    /**< Rendering list of the mesh */
+            uint32_t       mLod;        /**< Level of detail of the mesh */
+        };
+
+        /**
+         * Counters of the last submitted queue
+         */
+        struct Stats
+        {
+            uint32_t mItems = 0;
+            uint32_t mDrawCalls = 0;
+            uint32_t mStateChanges = 0; /**< Shader, material, texture and mesh binds */
+            uint32_t mObjectChanges = 0;
+            uint32_t mMeshes = 0;         /**< Different meshes of the items */
+            uint32_t mInstancedDraws = 0; /**< Draw calls that drew several items */
+            uint32_t mInstances = 0;      /**< Items drawn by the instanced draws */
+            double   mSortTime = 0.0;   /**< In milliseconds */
+        };
+
+        RenderQueue() = default;
+
+        /**
+         * Empties the queue for a new frame
+         */
+        void Clear();
+
+        /**
+         * Adds a draw item to the queue
+         *
+         * @param aPass      Pass of the item, the passes are submitted in ascending order
+         * @param aShader    Shader of the item
+         * @param aMaterial  Material state, only the 8 low bits take part in the sort
+         * @param aTexture   Texture handle, only the 16 low bits take part in the sort
+         * @param aMesh      Mesh of the item
+         * @param aDepth     Normalized view depth [0, 1], the items are drawn front to back
+         * @param aModel     Model the item belongs to
+         * @param aSubmesh   Rendering list of the mesh
+         * @param aLod       Level of detail of the mesh
+         */
+        void Add(uint32_t aPass, const Shader* aShader, uint32_t aMaterial, uint32_t aTexture,
+                 const Asset3D* aMesh, float aDepth, const Model3D* aModel, uint32_t aSubmesh, uint32_t aLod = 0);
+
+        /**
+         * Sorts the items by their key. The sort is stable, items with the same key
+         * keep the order they were added in
+         */
+        void Sort();
+
+        /**
+         * Sends the sorted items to the backend, skipping redundant state changes
+         */
+        void Submit(RenderQueueBackend& aBackend);
+
+        /**
+         * Groups the items with the same state, mesh, rendering list and level of
+         * detail into instanced draws, at the cost of the front to back order among
+         * them. Applies to the items added after the call
+         */
+        void SetInstancing(bool aEnable) { mInstancing = aEnable; }
+        bool IsInstancing() const        { return mInstancing; }
+
+        static uint64_t MakeKey(uint32_t aPass, uint32_t aShader, uint32_t aMaterial, uint32_t aTexture,
+                                uint32_t aMesh, float aDepth);
+
+        size_t             Size() const                  { return mItems.size(); }
+        const Item&        GetItem(size_t aIndex) const  { return mItems[mOrder[aIndex]]; }
+        const Stats&       GetStats() const              { return mStats; }
+
+    private:
+        // Compacts a pointer into a small id, so it fits in its bit field of the key
+        static uint32_t Intern(std::unordered_map<const void*, uint32_t>& aIds, const void* aPointer);
+
+        std::vector<Item>     mItems;
+        std::vector<uint32_t> mOrder;        /**< Sorted indices into mItems */
+        std::vector<uint64_t> mKeys;         /**< Radix sort buffers */
+        std::vector<uint64_t> mKeysTemp;
+        std::vector<uint32_t> mOrderTemp;
+        std::unordered_map<const void*, uint32_t> mShaderIds;
+        std::unordered_map<const void*, uint32_t> mMeshIds;
+        std::vector<const Model3D*> mInstances;   /**< Models of the instanced draw being submitted */
+        Stats                 mStats;
+        bool                  mInstancing = true;
+    };
+}
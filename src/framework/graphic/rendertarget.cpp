@@ -14,12 +14,16 @@
 
 #include "precompiled.h"
 #include "graphic/opengl/opengl_rendertarget.h"
+#include "graphic/null/null_rendertarget.h"
+#include "graphic/renderer.h"
 
 namespace Framework
 {
 
     RenderTarget* RenderTarget::New()
     {
+        if ( Renderer::GetBackend() == Renderer::Backend::eNULL )
+            return new NullRenderTarget();
         return new OpenGLRenderTarget();
     }
 
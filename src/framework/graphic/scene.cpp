@@ -8,6 +8,7 @@
 #include "precompiled.h"
 #include "engine.h"
 #include "engine/components/entity.h"
+#include "engine/CmpManager.h"
 #include "engine/components/cameracmp.h"
 #include "engine/components/motioncmp.h"
 #include "engine/components/directlightcmp.h"
@@ -16,6 +17,7 @@
 #include "engine/components/renderablecmp.h"
 #include "engine/components/transformcmp.h"
 
+#include "engine/projectfile.h"
 #include "graphic/scene.h"
 #include "graphic/rendertarget.h"
 #include "graphic/noaarendertarget.h"
@@ -27,6 +29,9 @@
 
 #include "glm/gtx/rotate_vector.hpp"
 
+#include <algorithm>
+#include <sstream>
+
 namespace Framework
 {
     
@@ -40,7 +45,7 @@ namespace Framework
 
         mGrid = aGrid;
 
-        Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
+        SetProjectUnsaved();
         return true;
     }
 
@@ -60,7 +65,7 @@ namespace Framework
 
         mModels2D.push_back(aElem);
 
-        Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
+        SetProjectUnsaved();
         return true;
     }
 
@@ -73,7 +78,11 @@ namespace Framework
         }
         mModels3D.push_back(aElem);
 
-        Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
+        ASSERT(aElem->GetSpatialIndex() == nullptr);
+        aElem->SyncAsset(); // the asset may have been streamed since the bounds were cached
+        aElem->SetSpatialProxy(&mModels3DHierarchy, mModels3DHierarchy.Insert(aElem, aElem->GetAABB()));
+
+        SetProjectUnsaved();
         return true;
     }
 
@@ -86,7 +95,7 @@ namespace Framework
         }
         mPointLights.push_back(aElem);
 
-        Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
+        SetProjectUnsaved();
         return true;
     }
 
@@ -99,7 +108,7 @@ namespace Framework
         }
         mSpotLights.push_back(aElem);
 
-        Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
+        SetProjectUnsaved();
         return true;
     }
 
@@ -112,7 +121,7 @@ namespace Framework
         //}
         mDirectLight = aElem;
 
-        Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
+        SetProjectUnsaved();
         return true;
     }
 
@@ -138,7 +147,7 @@ namespace Framework
             lCameraMotion.lock()->SetUpdatable(false);
         }
 
-        Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
+        SetProjectUnsaved();
         return true;
     }
 
@@ -153,11 +162,18 @@ namespace Framework
         mRenderTargets.push_back(aRenderTarget);
 
 
-        Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
+        SetProjectUnsaved();
         return true;
     }
 
 
+    void Scene::SetProjectUnsaved()
+    {
+        // A scene being loaded is as it was saved
+        if ( !mIsDeserializing )
+            Engine::Instance()->StateMachine().ExecuteAction("SetProjectUnsaved");
+    }
+
     Model3D* Scene::GetModel3D(const string &aName) const
     {
         for ( auto lModel : mModels3D )
@@ -242,54 +258,82 @@ namespace Framework
 
     void Scene::Serialize(Json::Value& aSerializer) const
     {
-        aSerializer["sceneName"] = mName;
-        aSerializer["rendertarget"] = "NoAA"; // ?
+        SerializeHeader(aSerializer);
 
         Json::Value& v = aSerializer["entities"];
         v = Json::Value(Json::ValueType::arrayValue);
-        const EntityManager& lEntityManager = Engine::Instance()->EntityManager();
-        unsigned int i = 0;
-        for ( const auto lCamera : mCameras )
+        SerializeEntities([&v](size_t, Json::Value& aEntity) { v.append(Json::Value()).swap(aEntity); });
+    }
+
+    void Scene::SerializeHeader(Json::Value& aSerializer) const
+    {
+        aSerializer["sceneName"] = mName;
+        aSerializer["rendertarget"] = "NoAA"; // ?
+        SerializeVec<glm::vec4>(aSerializer["rendertarget_clearcolor"], mClearColor);
+        if ( mRenderTargetSize != glm::uvec2(256, 256) )
+            SerializeVec<glm::uvec2>(aSerializer["rendertarget_size"], mRenderTargetSize);
+
+        // Only the constrained axes, the others are unbounded
+        static const char* const sMinNames[] = { "min_x", "min_y", "min_z" };
+        static const char* const sMaxNames[] = { "max_x", "max_y", "max_z" };
+        for ( int i = 0; i < 3; ++i )
         {
-            auto lEntity = lEntityManager.GetEntityByID(lCamera->GetEntityID());
-            lEntity->Serialize(v[i++]);
+            if ( mBoundingBox.GetMin()[i] != -FLT_MAX )
+                aSerializer["constraints3d"][sMinNames[i]] = mBoundingBox.GetMin()[i];
+            if ( mBoundingBox.GetMax()[i] != FLT_MAX )
+                aSerializer["constraints3d"][sMaxNames[i]] = mBoundingBox.GetMax()[i];
         }
-        if ( mGrid )
+    }
+
+    void Scene::SerializeEntities(const std::function<void(size_t, Json::Value&)>& aWrite) const
+    {
+        const EntityManager& lEntityManager = Engine::Instance()->EntityManager();
+        std::vector<size_t> lEntityIDs;
+        GetSavedEntities(lEntityIDs);
+        for ( size_t lEntityID : lEntityIDs )
         {
-            auto lEntity = lEntityManager.GetEntityByID(mGrid->GetEntityID());
-            lEntity->Serialize(v[i++]);
+            Json::Value lSerializer;
+            lEntityManager.GetEntityByID(lEntityID)->Serialize(lSerializer);
+            aWrite(lEntityID, lSerializer);
         }
+    }
+
+    void Scene::GetSavedEntities(std::vector<size_t>& aEntityIDs) const
+    {
+        for ( const auto lCamera : mCameras )
+            aEntityIDs.push_back(lCamera->GetEntityID());
+        if ( mGrid )
+            aEntityIDs.push_back(mGrid->GetEntityID());
         for ( const auto lModel : mModels3D )
-        {
-            auto lEntity = lEntityManager.GetEntityByID(lModel->GetEntityID());
-            lEntity->Serialize(v[i++]);
-        }
+            aEntityIDs.push_back(lModel->GetEntityID());
         for ( const auto lModel : mModels2D )
         {
             if ( !lModel->mBuddy )
-            {
-                auto lEntity = lEntityManager.GetEntityByID(lModel->GetEntityID());
-                lEntity->Serialize(v[i++]);
-            }
+                aEntityIDs.push_back(lModel->GetEntityID());
         }
         for ( const auto lLight : mPointLights )
-        {
-            auto lEntity = lEntityManager.GetEntityByID(lLight->GetEntityID());
-            lEntity->Serialize(v[i++]);
-        }
+            aEntityIDs.push_back(lLight->GetEntityID());
         for ( const auto lLight : mSpotLights )
-        {
-            auto lEntity = lEntityManager.GetEntityByID(lLight->GetEntityID());
-            lEntity->Serialize(v[i++]);
-        }
+            aEntityIDs.push_back(lLight->GetEntityID());
         if ( mDirectLight )
-        {
-            auto lEntity = lEntityManager.GetEntityByID(mDirectLight->GetEntityID());
-            lEntity->Serialize(v[i++]);
-        }
+            aEntityIDs.push_back(mDirectLight->GetEntityID());
     }
 
     void Scene::Deserialize(const Json::Value& aSerializer)
+    {
+        DeserializeHeader(aSerializer);
+        CreateRenderTargets();
+
+        // Deserialize entities
+        const Json::Value& lEntitiesRes = aSerializer["entities"];
+        ASSERT(lEntitiesRes.isArray());
+        for ( const Json::Value& lEntityRes : lEntitiesRes )
+            DeserializeEntity(lEntityRes);
+
+        EndDeserialize();
+    }
+
+    void Scene::DeserializeHeader(const Json::Value& aSerializer)
     {
         if(aSerializer.isMember("sceneName"))
             mName = aSerializer["sceneName"].asString();
@@ -302,19 +346,46 @@ namespace Framework
 
         //Deserialize Render Target
         const string   lRTType   = aSerializer["rendertarget"].asString();
+        if ( lRTType.compare("NoAA") != 0 )
+            CRASH("Unknown Render Target Type(%s)", lRTType.c_str());
         glm::u32vec2 lRTSize(256,256);
         if(aSerializer.isMember("rendertarget_size") )
             DeserializeVec<glm::u32vec2>(aSerializer["rendertarget_size"], lRTSize);
         glm::vec4 lRTClearColor;
         DeserializeVec<glm::vec4>(aSerializer["rendertarget_clearcolor"], lRTClearColor);
+        mRenderTargetSize = lRTSize;
+        mClearColor = lRTClearColor;
         
         // reset scene bounding box
         mBoundingBox.SetMin(glm::vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX));
         mBoundingBox.SetMax(glm::vec3(FLT_MAX, FLT_MAX, FLT_MAX));
 
-#define COLOR_CLEAR_VALUE {lRTClearColor.r, lRTClearColor.g, lRTClearColor.b, lRTClearColor.a}
+        if (aSerializer.isMember("constraints3d") )
+        {
+            const auto& lConstraints3d = aSerializer["constraints3d"];
+            glm::vec3& lBB_min = const_cast<glm::vec3&>(mBoundingBox.GetMin());
+            if ( lConstraints3d.isMember("min_x") )
+                lBB_min.x = lConstraints3d["min_x"].asFloat();
+            if ( lConstraints3d.isMember("min_y") )
+                lBB_min.y = lConstraints3d["min_y"].asFloat();
+            if ( lConstraints3d.isMember("min_z") )
+                lBB_min.z = lConstraints3d["min_z"].asFloat();
+            glm::vec3& lBB_max = const_cast<glm::vec3&>(mBoundingBox.GetMax());
+            if ( lConstraints3d.isMember("max_x") )
+                lBB_max.x = lConstraints3d["max_x"].asFloat();
+            if ( lConstraints3d.isMember("max_y") )
+                lBB_max.y = lConstraints3d["max_y"].asFloat();
+            if ( lConstraints3d.isMember("max_z") )
+                lBB_max.z = lConstraints3d["max_z"].asFloat();
+            if ( lBB_min.x > lBB_max.x || lBB_min.y > lBB_max.y || lBB_min.z > lBB_max.z )
+                CRASH("constraints3d member is invalid");
+        }
+    }
+
+    void Scene::CreateRenderTargets()
+    {
+#define COLOR_CLEAR_VALUE {mClearColor.r, mClearColor.g, mClearColor.b, mClearColor.a}
 #define COLOR_PICKING_ATTACHMENT GL_COLOR_ATTACHMENT1
-        if ( lRTType.compare("NoAA") == 0 )
         {
             /* Add NoAA RT for forward shading in 2D view.
                This RT requires a depth-stencil buffer and an additional
@@ -327,14 +398,10 @@ namespace Framework
             lAttachments[GL_COLOR_ATTACHMENT0] = {GL_TEXTURE_2D, GL_RGBA8, COLOR_CLEAR_VALUE}; // primary color buffer
             lAttachments[COLOR_PICKING_ATTACHMENT] = {GL_TEXTURE_2D, GL_RGB8, DEFAULT_COLOR_CLEAR_VALUE}; // color picking buffer for on-screen model selection
             lAttachments[GL_DEPTH_STENCIL_ATTACHMENT] = {GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, DEFAULT_DEPTH_STENCIL_CLEAR_VALUE};
-            bool res = lRT_NoAA->Init(lRTSize.x, lRTSize.y, &lAttachments);
+            bool res = lRT_NoAA->Init(mRenderTargetSize.x, mRenderTargetSize.y, &lAttachments);
             ASSERT(res);
             Add(lRT_NoAA);
         }
-        else
-        {
-            CRASH("Unknown Render Target Type(%s)", lRTType.c_str());
-        }
 
         // Add Deferred Shading Render Target
         {
@@ -349,92 +416,65 @@ namespace Framework
                 1 = fragment is subject to lighting but not a shadow receiver,
                 2 = fragment is subject to lighting and a shadow receiver */
             lAttachemnts[GL_DEPTH_STENCIL_ATTACHMENT] = {GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, DEFAULT_DEPTH_STENCIL_CLEAR_VALUE};
-            bool res = lRT_GBuffer->Init(lRTSize.x, lRTSize.y, &lAttachemnts);
+            bool res = lRT_GBuffer->Init(mRenderTargetSize.x, mRenderTargetSize.y, &lAttachemnts);
             ASSERT(res);
             ASSERT((uint32_t)Model::ReservedId::ClearColor == 0xFF000000ui32); // === DEFAULT_CLEAR_COLOR_VALUE
             Add(lRT_GBuffer);
         }
+    }
 
-        if (aSerializer.isMember("constraints3d") )
+    void Scene::DeserializeEntity(const Json::Value& aSerializer)
+    {
+        auto lEntity = Engine::Instance()->EntityManager().CreateEntityFromData(aSerializer).lock();
+
+        if ( lEntity->HasComponent<CameraCmp>() )
         {
-            const auto& lConstraints3d = aSerializer["constraints3d"];
-            glm::vec3& lBB_min = const_cast<glm::vec3&>(mBoundingBox.GetMin());
-            if ( lConstraints3d.isMember("min_x") )
-                lBB_min.x = lConstraints3d["min_x"].asFloat();
-            if ( lConstraints3d.isMember("min_y") )
-                lBB_min.y = lConstraints3d["min_y"].asFloat();
-            if ( lConstraints3d.isMember("min_z") )
-                lBB_min.z = lConstraints3d["min_z"].asFloat();
-            glm::vec3& lBB_max = const_cast<glm::vec3&>(mBoundingBox.GetMax());
-            if ( lConstraints3d.isMember("max_x") )
-                lBB_max.x = lConstraints3d["max_x"].asFloat();
-            if ( lConstraints3d.isMember("max_y") )
-                lBB_max.y = lConstraints3d["max_y"].asFloat();
-            if ( lConstraints3d.isMember("max_z") )
-                lBB_max.z = lConstraints3d["max_z"].asFloat();
-            if ( lBB_min.x > lBB_max.x || lBB_min.y > lBB_max.y || lBB_min.z > lBB_max.z )
-                CRASH("constraints3d member is invalid");
+            auto lCamera = lEntity->GetComponent<CameraCmp>().lock();
+            Add(lCamera->GetCamera());
         }
-
-        // Deserialize entities
-        const Json::Value& lEntitiesRes = aSerializer["entities"];
-        ASSERT(lEntitiesRes.isArray());
-        for ( size_t i = 0, lSize = lEntitiesRes.size(); i < lSize; ++i )
+        else if ( lEntity->HasComponent<RenderableCmp>() )
         {
-            const Json::Value lEntityRes = lEntitiesRes[static_cast<int>(i)];
-            auto lEntity = Engine::Instance()->EntityManager().CreateEntityFromData(lEntityRes).lock();
+            auto lRenderable = lEntity->GetComponent<RenderableCmp>().lock();
+            auto lModel2D = lRenderable->GetModel2D();
+            auto lModel3D = lRenderable->GetModel3D();
 
-            if ( lEntity->HasComponent<CameraCmp>() )
+            if (lModel2D)
             {
-                auto lCamera = lEntity->GetComponent<CameraCmp>().lock();
-                Add(lCamera->GetCamera());
+                Procedural::Grid* lGrid = dynamic_cast<Procedural::Grid*>(lModel2D);
+                if(lGrid)
+                    Add(lGrid); // Add 2D grid
+                else 
+                    Add(lModel2D); // Add any 2D model
             }
-            else if ( lEntity->HasComponent<RenderableCmp>() )
-            {
-                auto lRenderable = lEntity->GetComponent<RenderableCmp>().lock();
-                auto lModel2D = lRenderable->GetModel2D();
-                auto lModel3D = lRenderable->GetModel3D();
-
-                if (lModel2D)
-                {
-                    Procedural::Grid* lGrid = dynamic_cast<Procedural::Grid*>(lModel2D);
-                    if(lGrid)
-                        Add(lGrid); // Add 2D grid
-                    else 
-                        Add(lModel2D); // Add any 2D model
-                }
 
-                if ( lModel3D )
-                {
-                    bool constrained = lModel3D->ConstrainPosition(mBoundingBox);
-                    if ( constrained && lEntity->HasComponent<TransformCmp>() )
-                    { // Read back the constrained transform values
-                        auto lTransformCmp = lEntity->GetComponent<TransformCmp>().lock();
-                        lTransformCmp->SetPosition(lModel3D->GetPosition());
-                        //lTransformCmp->SetOrientation(glm::quat_cast(lModel3D->GetOrientation()));
-                        //lTransformCmp->SetScale(lModel3D->GetScaleFactor());
-                    }
-                    Add(lModel3D);
-                }
-            }
-            else if ( lEntity->HasComponent<DirectLightCmp>() )
-            {
-                auto lDirectLight = lEntity->GetComponent<DirectLightCmp>().lock();
-                Add(lDirectLight->GetDirectLight());
-            }
-            else if ( lEntity->HasComponent<SpotLightCmp>() )
-            {
-                auto lSpotLight = lEntity->GetComponent<SpotLightCmp>().lock();
-                Add(lSpotLight->GetSpotLight());
-            }
-            else if ( lEntity->HasComponent<PointLightCmp>() )
+            if ( lModel3D )
             {
-                auto lPointLight = lEntity->GetComponent<PointLightCmp>().lock();
-                Add(lPointLight->GetPointLight());
+                bool constrained = lModel3D->ConstrainPosition(mBoundingBox);
+                if ( constrained && lEntity->HasComponent<TransformCmp>() )
+                { // Read back the constrained transform values
+                    auto lTransformCmp = lEntity->GetComponent<TransformCmp>().lock();
+                    lTransformCmp->SetPosition(lModel3D->GetPosition());
+                    //lTransformCmp->SetOrientation(glm::quat_cast(lModel3D->GetOrientation()));
+                    //lTransformCmp->SetScale(lModel3D->GetScaleFactor());
+                }
+                Add(lModel3D);
             }
         }
-
-        mIsLoaded = true;
+        else if ( lEntity->HasComponent<DirectLightCmp>() )
+        {
+            auto lDirectLight = lEntity->GetComponent<DirectLightCmp>().lock();
+            Add(lDirectLight->GetDirectLight());
+        }
+        else if ( lEntity->HasComponent<SpotLightCmp>() )
+        {
+            auto lSpotLight = lEntity->GetComponent<SpotLightCmp>().lock();
+            Add(lSpotLight->GetSpotLight());
+        }
+        else if ( lEntity->HasComponent<PointLightCmp>() )
+        {
+            auto lPointLight = lEntity->GetComponent<PointLightCmp>().lock();
+            Add(lPointLight->GetPointLight());
+        }
     }
 
     void Scene::Unload()
@@ -443,6 +483,9 @@ namespace Framework
             delete lRT;
         mRenderTargets.clear();
 
+        for (auto lModel : mModels3D)
+            lModel->SetSpatialProxy(nullptr, BoundingVolumeHierarchy::sNullProxy);
+        mModels3DHierarchy.Clear();
         mModels3D.clear();
         mModels2D.clear();
         mFocusedModel = nullptr;
@@ -452,22 +495,226 @@ namespace Framework
         mPointLights.clear();
         mSpotLights.clear();
         mCameras.clear();
+        mActiveCamera = nullptr;
+        mGrid = nullptr;
 
         mIsLoaded = false;
     }
 
+    void Scene::SetStoredEntities(const std::string& aFileName, std::streampos aPosition)
+    {
+        ASSERT(!mIsLoaded);
+        mStoredFile = aFileName;
+        mStoredRecords.clear();
+        mStoredPosition = aPosition;
+    }
 
-    Model::ReservedId Scene::GetModelAtPoint(int aX, int aY, __out Model*& aModel) const
+    void Scene::SetStoredEntities(std::string&& aRecords, std::streampos aPosition)
     {
-        const char* lRTName = mActiveCamera->GetProjectionType() == Projection::PERSPECTIVE ? "GBuffer" : "NoAA";
-        RenderTarget* lRT = GetRenderTarget(lRTName);
-        if (!lRT)
-            CRASH("Scene '%s' does not have a %s render target", GetName().c_str(), lRTName);
+        ASSERT(!mIsLoaded);
+        mStoredFile.clear();
+        mStoredRecords = std::move(aRecords);
+        mStoredPosition = aPosition;
+    }
+
+    bool Scene::OpenStoredEntities(ProjectFile::Reader& aReader, std::istringstream& aRecords) const
+    {
+        bool lIsOpen;
+        if ( mStoredFile.empty() )
+        {
+            aRecords.str(mStoredRecords);
+            lIsOpen = aReader.Open(aRecords);
+        }
+        else
+            lIsOpen = aReader.Open(mStoredFile);
+
+        Json::Value lHeader;
+        if ( !lIsOpen || !aReader.Seek(mStoredPosition) || aReader.Next(lHeader) != ProjectFile::Record::eSCENE
+             || lHeader["sceneName"].asString() != mName )
+        {
+            WARNING("The stored entities of the scene '%s' cannot be read", mName.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool Scene::Load()
+    {
+        if ( mIsLoaded )
+            return true;
+
+        ProjectFile::Reader lReader;
+        std::istringstream lRecords;
+        if ( !OpenStoredEntities(lReader, lRecords) )
+            return false;
+
+        mIsDeserializing = true;
+        CreateRenderTargets();
+        Json::Value lRecord;
+        ProjectFile::Record lType;
+        while ( (lType = lReader.Next(lRecord)) == ProjectFile::Record::eENTITY )
+            DeserializeEntity(lRecord);
+        mIsDeserializing = false;
+        EndDeserialize();
+
+        if ( lType != ProjectFile::Record::eSCENE_END )
+            WARNING("The stored scene '%s' is truncated, its last entities are missing", mName.c_str());
+
+        // The entities are the loaded ones from now on
+        mStoredFile.clear();
+        std::string().swap(mStoredRecords);
+        mStoredPosition = -1;
+        return true;
+    }
+
+    void Scene::Evict()
+    {
+        if ( !mIsLoaded )
+            return;
+
+        std::stringstream lRecords(std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+        ProjectFile::Writer lWriter;
+        lWriter.Open(lRecords);
+        Json::Value lHeader;
+        SerializeHeader(lHeader);
+        lWriter.BeginScene(lHeader);
+        const std::streampos lPosition = lWriter.GetScenePosition();
+        SerializeEntities([&lWriter](size_t aEntityID, Json::Value& aEntity) { lWriter.WriteEntity(aEntity, aEntityID); });
+        lWriter.EndScene();
+        lWriter.Close();
+
+        // The buddies of the 3D models are 2D models of the same entities
+        std::vector<size_t> lEntityIDs;
+        GetSavedEntities(lEntityIDs);
+        for ( const auto lModel : mModels2D )
+        {
+            if ( lModel->mBuddy )
+                lEntityIDs.push_back(lModel->GetEntityID());
+        }
+        std::sort(lEntityIDs.begin(), lEntityIDs.end());
+        lEntityIDs.erase(std::unique(lEntityIDs.begin(), lEntityIDs.end()), lEntityIDs.end());
+
+        Unload();
+        EntityManager& lEntityManager = Engine::Instance()->EntityManager();
+        // Removed at once, so the models release their assets before the memory is trimmed
+        for ( size_t lEntityID : lEntityIDs )
+            lEntityManager.DestroyEntityNow(lEntityID);
+
+        SetStoredEntities(lRecords.str(), lPosition);
+    }
+
+    bool Scene::ReadStoredEntities(const std::function<void(uint64_t, Json::Value&)>& aRead) const
+    {
+        ASSERT(!mIsLoaded);
+        ProjectFile::Reader lReader;
+        std::istringstream lRecords;
+        if ( !OpenStoredEntities(lReader, lRecords) )
+            return false;
+
+        Json::Value lRecord;
+        ProjectFile::Record lType;
+        while ( (lType = lReader.Next(lRecord)) == ProjectFile::Record::eENTITY )
+            aRead(lReader.GetEntityKey(), lRecord);
+        return lType == ProjectFile::Record::eSCENE_END;
+    }
+
+    uint64_t Scene::GetRenderTargetBytes() const
+    {
+        if ( !mIsLoaded )
+            return 0;
+        // NoAA: RGBA8, RGB8 and depth stencil. GBuffer: RGBA8, RGB8, RGB32F, RGBA32F and depth stencil
+        const uint64_t lNoAABytes = 4 + 3 + 4;
+        const uint64_t lGBufferBytes = 4 + 3 + 12 + 16 + 4;
+        return uint64_t(mRenderTargetSize.x) * mRenderTargetSize.y * (lNoAABytes + lGBufferBytes);
+    }
+
+
+    void Scene::QueryFrustum(const Camera& aCamera, std::vector<Model3D*>& aResult) const
+    {
+        QueryFrustum(aCamera.GetProjectionVolumePlanes(), aCamera.GetProjectionVolumePlaneCount(), aResult);
+    }
+
+    void Scene::QueryFrustum(const glm::vec4* aPlanes, size_t aPlaneCount, std::vector<Model3D*>& aResult) const
+    {
+        mModels3DHierarchy.QueryFrustum(aPlanes, aPlaneCount, mQueryResult);
+        AppendQueryResult(aResult);
+    }
 
+    void Scene::QueryBox(const BoundingBox& aBox, std::vector<Model3D*>& aResult) const
+    {
+        mModels3DHierarchy.QueryBox(aBox, mQueryResult);
+        AppendQueryResult(aResult);
+    }
 
+    void Scene::QuerySphere(const glm::vec3& aCenter, float aRadius, std::vector<Model3D*>& aResult) const
+    {
+        mModels3DHierarchy.QuerySphere(aCenter, aRadius, mQueryResult);
+        AppendQueryResult(aResult);
+    }
+
+    void Scene::QueryRay(const glm::vec3& aOrigin, const glm::vec3& aDirection, float aMaxDistance, std::vector<Model3D*>& aResult) const
+    {
+        mModels3DHierarchy.QueryRay(aOrigin, aDirection, aMaxDistance, mQueryResult);
+        AppendQueryResult(aResult);
+    }
+
+    void Scene::AppendQueryResult(std::vector<Model3D*>& aResult) const
+    {
+        // Only Model3D objects are inserted into the hierarchy
+        aResult.reserve(aResult.size() + mQueryResult.size());
+        for ( auto lObject : mQueryResult )
+            aResult.push_back(static_cast<Model3D*>(lObject));
+        mQueryResult.clear();
+    }
+
+    void Scene::RemoveFromHierarchy(Model3D* aModel)
+    {
+        if ( aModel->GetSpatialIndex() != &mModels3DHierarchy )
+            return;
+        mModels3DHierarchy.Remove(aModel->GetSpatialProxy());
+        aModel->SetSpatialProxy(nullptr, BoundingVolumeHierarchy::sNullProxy);
+    }
+
+    Model::ReservedId Scene::GetModelAtPoint(int aX, int aY, __out Model*& aModel) const
+    {
         INFO(LogLevel::eLEVEL1, "GetModel at [%d , %d]", aX, aY);
         aModel = nullptr;
         constexpr uint32_t COLOR_PICKING_BUFFER_INDEX = (COLOR_PICKING_ATTACHMENT - GL_COLOR_ATTACHMENT0);
+
+        // Projection is PERSPECTIVE - cast a ray against the 3D models
+        if ( mActiveCamera->GetProjectionType() == Camera::Projection::PERSPECTIVE )
+        {
+            /* The transform gizmo is generated on the GPU, so its axes can only be picked
+               from the color picking buffer. Read it back only while the gizmo is shown */
+            if ( mModelUnderTransform.mTarget &&
+                 !(mModelUnderTransform.mTarget->mFlags & Model::ModelFlags::eDISABLE_TRASFORM_3D) )
+            {
+                RenderTarget* lRT = GetRenderTarget("GBuffer");
+                if ( !lRT )
+                    CRASH("Scene '%s' does not have a GBuffer render target", GetName().c_str());
+                uint32_t lPixel = lRT->GetColor(aX, aY, COLOR_PICKING_BUFFER_INDEX);
+                switch ( static_cast<Model::ReservedId>(lPixel) )
+                {
+                    case Model::ReservedId::GizmoAxisX:
+                    case Model::ReservedId::GizmoAxisY:
+                    case Model::ReservedId::GizmoAxisZ:
+                    case Model::ReservedId::GizmoAxisAll:
+                    return static_cast<Model::ReservedId>(lPixel);
+                }
+            }
+
+            PickInfo lPick;
+            if ( !PickModel3D(aX, aY, lPick) )
+                return Model::ReservedId::ClearColor;
+            aModel = lPick.mModel;
+            return Model::ReservedId::ModelMask;
+        }
+
+        // Projection is ORTHOGRAPHIC - check against 2D model ids
+        RenderTarget* lRT = GetRenderTarget("NoAA");
+        if (!lRT)
+            CRASH("Scene '%s' does not have a NoAA render target", GetName().c_str());
+
         uint32_t lPixel = lRT->GetColor(aX, aY, COLOR_PICKING_BUFFER_INDEX);
 
         // first check against reserved ids:
@@ -481,45 +728,20 @@ namespace Framework
             return static_cast<Model3D::ReservedId>(lPixel);
         }
 
-        // Projection is ORTHOGRAPHIC - check against 2D model ids
-        if ( mActiveCamera->GetProjectionType() == Camera::Projection::ORTHOGRAPHIC )
+        for (list<Model2D*>::const_iterator lModelIter = mModels2D.begin(); lModelIter != mModels2D.end(); ++lModelIter )
         {
-            for (list<Model2D*>::const_iterator lModelIter = mModels2D.begin(); lModelIter != mModels2D.end(); ++lModelIter )
+            Model2D* lModel2D = *lModelIter;
+            uint32_t lModelId = lModel2D->GetId();
+            const uint8_t* lModelColor = (uint8_t*)&lModelId;
+            const uint8_t* lPickedColor = (uint8_t*)&lPixel;
+            uint8_t d = (lModelColor[0] - lPickedColor[0]) +
+                (lModelColor[1] - lPickedColor[1]) +
+                (lModelColor[2] - lPickedColor[2]) +
+                (lModelColor[3] - lPickedColor[3]);
+            if ( d < 4 ) // TODO: try if lModelId == lPixel
             {
-                Model2D* lModel2D = *lModelIter;
-                uint32_t lModelId = lModel2D->GetId();
-                const uint8_t* lModelColor = (uint8_t*)&lModelId;
-                const uint8_t* lPickedColor = (uint8_t*)&lPixel;
-                uint8_t d = (lModelColor[0] - lPickedColor[0]) +
-                    (lModelColor[1] - lPickedColor[1]) +
-                    (lModelColor[2] - lPickedColor[2]) +
-                    (lModelColor[3] - lPickedColor[3]);
-                if ( d < 4 ) // TODO: try if lModelId == lPixel
-                {
-                    aModel = lModel2D;
-                    return Model::ReservedId::ModelMask;
-                }
-            }
-        }
-        // Projection is PERSPECTIVE - check against 3D model ids
-        else
-        {
-            for (list<Model3D*>::const_iterator lModelIter = mModels3D.begin(); lModelIter != mModels3D.end(); ++lModelIter )
-            {
-                Model3D* lModel3D = *lModelIter;
-                uint32_t lModelId = lModel3D->GetId();
-                const uint8_t* lModelColor = (uint8_t*)&lModelId;
-                const uint8_t* lPickedColor = (uint8_t*)&lPixel;
-                uint8_t d = (lModelColor[0] - lPickedColor[0]) +
-                    (lModelColor[1] - lPickedColor[1]) +
-                    (lModelColor[2] - lPickedColor[2]) +
-                    (lModelColor[3] - lPickedColor[3]);
-
-                if ( d < 4 ) // TODO: try if lModelId == lPixel
-                {
-                    aModel = lModel3D;
-                    return Model::ReservedId::ModelMask;
-                }
+                aModel = lModel2D;
+                return Model::ReservedId::ModelMask;
             }
         }
 
@@ -527,6 +749,43 @@ namespace Framework
         return Model::ReservedId::ClearColor;
     }
 
+    bool Scene::PickModel3D(const glm::vec3& aOrigin, const glm::vec3& aDirection, __out PickInfo& aPick) const
+    {
+        aPick = PickInfo();
+        mModels3DHierarchy.QueryRay(aOrigin, aDirection, FLT_MAX, mQueryResult);
+        for ( auto lObject : mQueryResult )
+        {
+            // Only Model3D objects are inserted into the hierarchy
+            const Model3D* lModel3D = static_cast<const Model3D*>(lObject);
+            if ( !lModel3D->IsEnabled() )
+                continue;
+            // aPick.mDistance is the nearest hit so far, farther triangles are skipped
+            if ( lModel3D->Raycast(aOrigin, aDirection, aPick.mDistance, aPick.mNormal) )
+                aPick.mModel = const_cast<Model3D*>(lModel3D);
+        }
+        mQueryResult.clear();
+        return aPick.mModel != nullptr;
+    }
+
+    bool Scene::PickModel3D(int aX, int aY, __out PickInfo& aPick) const
+    {
+        RenderTarget* lRT = GetRenderTarget("GBuffer");
+        if ( !lRT )
+            CRASH("Scene '%s' does not have a GBuffer render target", GetName().c_str());
+
+        // Unproject the pixel center on the near and far planes
+        const glm::uvec2 lSize = lRT->GetSize();
+        const glm::vec2 lNDC(((aX + 0.5f) / lSize.x) * 2.0f - 1.0f,
+                             ((aY + 0.5f) / lSize.y) * 2.0f - 1.0f);
+        const glm::mat4 lInvViewProj = glm::inverse(mActiveCamera->GetProjectionMatrix() * mActiveCamera->GetViewMatrix());
+        glm::vec4 lNear = lInvViewProj * glm::vec4(lNDC, -1.0f, 1.0f);
+        glm::vec4 lFar = lInvViewProj * glm::vec4(lNDC, 1.0f, 1.0f);
+        lNear /= lNear.w;
+        lFar /= lFar.w;
+
+        return PickModel3D(glm::vec3(lNear), glm::normalize(glm::vec3(lFar - lNear)), aPick);
+    }
+
     void Scene::DeleteSelectedModels()
     {
         // Projection is PERSPECTIVE - remove selected 3d models and their 2d buddies from the scene
@@ -540,6 +799,7 @@ namespace Framework
                     {
                         mModels3D.erase(i);
                         Model3D* lModel3D = dynamic_cast<Model3D*>(lSelectedModel3D);
+                        RemoveFromHierarchy(lModel3D);
 
                         // 3d model has a 2d buddy -> Remove it
                         if ( lModel3D->mBuddy )
@@ -577,6 +837,7 @@ namespace Framework
                             {
                                 if ( *j == lModel2D->mBuddy )
                                 {
+                                    RemoveFromHierarchy(*j);
                                     mModels3D.erase(j);
                                     break;
                                 }
@@ -662,6 +923,7 @@ namespace Framework
                     lModel->mBuddy->SetOrientation(lOrientation);
                     // scale in 2D view = scale in 3D view
                     lModel->mBuddy->SetScaleFactor(lModel->GetScaleFactor());
+                    lModel->mBuddy->RefitSpatialProxy();
                 }
             }
             SetActiveCamera("camera_perspective");
@@ -12,12 +12,15 @@
 *******************************************************************************/
 
 #pragma once
+#include <functional>
+#include <ios>
 #include <vector>
 #include <map>
 #include <list>
 #include <string>
 
 #include "glm/glm.hpp"
+#include "graphic/boundingvolumehierarchy.h"
 #include "graphic/camera.h"
 #include "graphic/directlight.h"
 #include "graphic/model.h"
@@ -31,6 +34,10 @@
 
 namespace Framework
 {
+    namespace ProjectFile
+    {
+        class Reader;
+    }
 
     class Scene : public SerializableObject
     {
@@ -104,6 +111,22 @@ namespace Framework
         const std::vector<RenderTarget*>& GetRenderTargets() const { return mRenderTargets; }
 
 
+        /**
+         * Spatial queries over the 3D models, answered by the bounding volume
+         * hierarchy built over the AABB of the models
+         *
+         * The models found are appended to aResult. QueryFrustum expects the projection
+         * volume of the camera to be already recalculated
+         */
+        void QueryFrustum(const Camera& aCamera, std::vector<Model3D*>& aResult) const;
+        void QueryFrustum(const glm::vec4* aPlanes, size_t aPlaneCount, std::vector<Model3D*>& aResult) const;
+        void QueryBox(const BoundingBox& aBox, std::vector<Model3D*>& aResult) const;
+        void QuerySphere(const glm::vec3& aCenter, float aRadius, std::vector<Model3D*>& aResult) const;
+        void QueryRay(const glm::vec3& aOrigin, const glm::vec3& aDirection, float aMaxDistance, std::vector<Model3D*>& aResult) const;
+
+        const BoundingVolumeHierarchy& GetModels3DHierarchy() const { return mModels3DHierarchy; }
+
+
         /**
          * Sets the active camera to be used for rendering
          *
@@ -164,6 +187,45 @@ namespace Framework
          **/
         bool IsLoaded() { return mIsLoaded; }
 
+        /**
+         * Lazy loading. A scene indexed when the project is opened only has its
+         * attributes: its entities stay stored, in the binary project file or in
+         * memory, until Load instantiates them and creates the render targets
+         *
+         * @param aFileName  Binary project file holding the scene
+         * @param aRecords   The scene written as a binary project of its own
+         * @param aPosition  Position of the record of the scene
+         */
+        void SetStoredEntities(const std::string& aFileName, std::streampos aPosition);
+        void SetStoredEntities(std::string&& aRecords, std::streampos aPosition);
+        bool IsStoredIn(const std::string& aFileName) const { return !mStoredFile.empty() && mStoredFile == aFileName; }
+
+        /**
+         * Instantiates the stored entities. Nothing is done if the scene is loaded
+         *
+         * @return false if the stored scene could not be read
+         */
+        bool Load();
+
+        /**
+         * Stores the entities in memory and unloads the scene. Its entities are removed
+         * at once, not at the next update of the entities, so their models release their
+         * assets before it returns, and so are its render targets. Load brings it back
+         */
+        void Evict();
+
+        /**
+         * Reads the stored entities of a scene that is not loaded, with the key they
+         * were stored with
+         */
+        bool ReadStoredEntities(const std::function<void(uint64_t, Json::Value&)>& aRead) const;
+
+        /**
+         * @return Video memory of the render targets of the loaded scene, from the
+         *         formats of their attachments
+         */
+        uint64_t GetRenderTargetBytes() const;
+
         /**
          * Delete the selected models from the scene
          */
@@ -171,8 +233,40 @@ namespace Framework
         
         /**
          * Get the model from the (X,Y) screen coordinates
+         *
+         * In 3D view the models are picked on the CPU by PickModel3D, only the transform
+         * gizmo axes are read back from the color picking buffer while the gizmo is shown
          */
         Model::ReservedId GetModelAtPoint(int aX, int aY, __out Model*& aModel) const;
+
+        /**
+         * Result of a ray cast against the 3D models
+         */
+        struct PickInfo
+        {
+            Model3D*  mModel = nullptr;          /**< Nearest model hit by the ray */
+            float     mDistance = FLT_MAX;       /**< Distance from the ray origin to the hit */
+            glm::vec3 mNormal = glm::vec3(0.0f); /**< World space normal of the hit triangle */
+        };
+
+        /**
+         * Casts a ray against the enabled 3D models on the CPU. The candidates are taken
+         * from the bounding volume hierarchy of the scene, then the ray is tested against
+         * the triangle hierarchy of their assets
+         *
+         * @param aOrigin     Origin of the ray in world space
+         * @param aDirection  Normalized direction of the ray in world space
+         * @param aPick       Out: nearest model hit, distance and normal
+         *
+         * @return true if any model was hit
+         */
+        bool PickModel3D(const glm::vec3& aOrigin, const glm::vec3& aDirection, __out PickInfo& aPick) const;
+
+        /**
+         * Casts the ray of the active camera through the (X,Y) pixel of the GBuffer
+         * render target (origin at the bottom left corner)
+         */
+        bool PickModel3D(int aX, int aY, __out PickInfo& aPick) const;
         
         /**
          * Toogle the camera between OTRHOGRAPHICS <-> PERSPECTIVE view
@@ -182,6 +276,32 @@ namespace Framework
         virtual void Serialize(Json::Value& aSerializer) const override;
         virtual void Deserialize(const Json::Value& aSerializer) override;
 
+        /**
+         * Serializes the attributes of the scene, all but the entities
+         */
+        void SerializeHeader(Json::Value& aSerializer) const;
+
+        /**
+         * Serializes the entities one at a time, in the order they are saved
+         *
+         * @param aWrite  Receives the id of every entity and its value, which can be taken
+         */
+        void SerializeEntities(const std::function<void(size_t, Json::Value&)>& aWrite) const;
+
+        /**
+         * @return The ids of the entities saved with the scene, in the order they are saved
+         */
+        void GetSavedEntities(std::vector<size_t>& aEntityIDs) const;
+
+        /**
+         * Deserialization of a scene whose entities come one at a time: the header
+         * reads the attributes and the constraints, then every entity is created and
+         * added as it comes, and the end marks the scene as loaded
+         */
+        void DeserializeHeader(const Json::Value& aSerializer);
+        void DeserializeEntity(const Json::Value& aSerializer);
+        void EndDeserialize() { mIsLoaded = true; }
+
         mutable Model*            mFocusedModel = nullptr;
         mutable std::list<Model*> mSelectedModels;
 
@@ -204,12 +324,45 @@ namespace Framework
         BoundingBox mBoundingBox = BoundingBox(glm::vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX), glm::vec3(FLT_MAX, FLT_MAX, FLT_MAX));
 
       private:
+        /**
+         * Creates the NoAA and GBuffer render targets from the attributes of the scene
+         */
+        void CreateRenderTargets();
+
+        /**
+         * Marks the project unsaved, unless the scene is being deserialized
+         */
+        void SetProjectUnsaved();
+
+        /**
+         * Opens the stored scene and reads its header
+         */
+        bool OpenStoredEntities(ProjectFile::Reader& aReader, std::istringstream& aRecords) const;
+
+        /**
+         * Removes the model from the bounding volume hierarchy
+         */
+        void RemoveFromHierarchy(Model3D* aModel);
+
+        /**
+         * Moves the objects found by the hierarchy to the models list of a query
+         */
+        void AppendQueryResult(std::vector<Model3D*>& aResult) const;
+
         std::string                          mName;
 
         bool                                 mIsLoaded;
+        bool                                 mIsDeserializing = false;
+        std::string                          mStoredFile;           /**< Binary project holding the entities of the scene while it is not loaded */
+        std::string                          mStoredRecords;        /**< Or the scene written in memory, when evicted */
+        std::streampos                       mStoredPosition = -1;  /**< Position of the scene record in either of them */
+        glm::uvec2                           mRenderTargetSize = glm::uvec2(256, 256);
+        glm::vec4                            mClearColor;           /**< Clear color of the render targets, as it was loaded */
 
         std::list<Model2D*>                  mModels2D;             /**< Contains all models in the scene 2D view*/
         std::list<Model3D*>                  mModels3D;             /**< Contains all models in the scene 3D view*/
+        BoundingVolumeHierarchy              mModels3DHierarchy;    /**< Spatial index over the AABB of mModels3D */
+        mutable std::vector<Object3D*>       mQueryResult;          /**< Scratch buffer of the spatial queries */
         DirectLight*                         mDirectLight;          /**< Directional light in the scene */
         std::vector<PointLight*>             mPointLights;          /**< Contains all point lights in the scene */
         std::vector<SpotLight*>              mSpotLights;           /**< Contains all spot lights in the scene */
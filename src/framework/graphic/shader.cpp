@@ -10,9 +10,15 @@
 #include "precompiled.h"
 #include "graphic/shader.h"
 #include "graphic/opengl/opengl_shader.h"
+#include "graphic/null/null_shader.h"
+#include "graphic/renderer.h"
 
 namespace Framework
 {
     Shader *Shader::New(const std::string& aName) 
-    { return new OpenGLShader(aName); }
+    {
+        if ( Renderer::GetBackend() == Renderer::Backend::eNULL )
+            return new NullShader(aName);
+        return new OpenGLShader(aName);
+    }
 }
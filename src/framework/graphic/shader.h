@@ -13,13 +13,26 @@
 #include "glm/glm.hpp"
 #include <map>
 #include <string>
+#include <vector>
+#include "graphic/uniformcache.h"
 
 namespace Framework
 {
     class Shader
     {
+    public:
+        /**
+         * Handle of a uniform. It is resolved once after the program is linked
+         * and it is only valid for the shader that returned it
+         */
+        typedef uint32_t UniformHandle;
+        static const UniformHandle sInvalidUniform = 0xFFFFFFFF;
+
     protected:
-        const std::string mName;
+        const std::string        mName;
+        std::string              mPath;          /**< Path given to Load */
+        std::vector<std::string> mSourceFiles;   /**< Stage files read by Load */
+        mutable UniformCache     mUniformCache;  /**< Values last sent for every uniform handle */
 
     public:
 
@@ -54,6 +67,23 @@ namespace Framework
          */
         virtual bool Load(const std::string& path, std::string& error) = 0;
 
+        /**
+         * Compiles and links the files of the last Load again, after one of them
+         * changed. The program in use is kept when the new one fails to build, and
+         * the uniform handles already resolved stay valid
+         *
+         * @param[out]	error If compilation fails error will contain
+         *					  a description of the error
+         *
+         * @return true or false
+         */
+        virtual bool Reload(std::string& error) = 0;
+
+        /**
+         * @return Stage files the program was built from by the last Load
+         */
+        const std::vector<std::string>& GetSourceFiles() const { return mSourceFiles; }
+
     protected:
         /**
          * Loads a new vertex shader code and compiles it
@@ -126,6 +156,22 @@ namespace Framework
         virtual const bool GetUniformID(const std::string& aName, uint32_t* id) const = 0;
         virtual const bool GetAttributeID(const std::string& aName, uint32_t* id) const = 0;
 
+        /**
+         * Resolves the handle of a uniform. The handle setters skip the name lookup,
+         * so the handles of the uniforms set per draw are resolved once and kept
+         *
+         * @param aName  Name of the uniform
+         *
+         * @return The handle or sInvalidUniform if the uniform cannot be found
+         */
+        virtual UniformHandle GetUniformHandle(const std::string& aName) const = 0;
+
+        /**
+         * Redundant uniform updates dropped by the value shadow of the shader
+         */
+        const UniformCache::Stats& GetUniformStats() const { return mUniformCache.GetStats(); }
+        void                       ResetUniformStats() const { mUniformCache.ResetStats(); }
+
         /**
          * Sets the aValue of a shader uniform as a mat4x4
          *
@@ -147,6 +193,26 @@ namespace Framework
         virtual bool SetUniformVec3(const std::string& aName, const glm::vec3& aValue) const = 0;
         virtual bool SetUniformVec2(const std::string& aName, const glm::vec2& aValue) const = 0;
 
+        /**
+         * Handle setters. A value equal to the last one set through the same handle
+         * is not sent again
+         *
+         * @param aHandle Handle returned by GetUniformHandle
+         * @param aValue  Value of the uniform to be set
+         *
+         * @return true if the aValue was set or is already set, false if the handle is invalid
+         */
+        virtual bool SetUniformMat4(UniformHandle aHandle, const glm::mat4 aValue[], uint32_t aNumItems = 1) const = 0;
+        virtual bool SetUniformMat3(UniformHandle aHandle, const glm::mat3 aValue[], uint32_t aNumItems = 1) const = 0;
+        virtual bool SetUniformTexture2D(UniformHandle aHandle, uint32_t aUnitID) const = 0;
+        virtual bool SetUniformTexture2DArray(UniformHandle aHandle, uint32_t aUnitIDs[], uint32_t aNumItems) const = 0;
+        virtual bool SetUniformFloat(UniformHandle aHandle, float aValue) const = 0;
+        virtual bool SetUniformInt(UniformHandle aHandle, int32_t aValue) const = 0;
+        virtual bool SetUniformBool(UniformHandle aHandle, bool aValue) const = 0;
+        virtual bool SetUniformVec4(UniformHandle aHandle, const glm::vec4& aValue) const = 0;
+        virtual bool SetUniformVec3(UniformHandle aHandle, const glm::vec3& aValue) const = 0;
+        virtual bool SetUniformVec2(UniformHandle aHandle, const glm::vec2& aValue) const = 0;
+
         /**
          * Sets custom parameters only known by the implementer class
          */
@@ -14,6 +14,8 @@
 
 #include "precompiled.h"
 #include "graphic/opengl/opengl_shadowmaprendertarget.h"
+#include "graphic/null/null_rendertarget.h"
+#include "graphic/renderer.h"
 
 namespace Framework
 {
@@ -32,5 +34,9 @@ namespace Framework
     }
 
     ShadowMapRenderTarget *ShadowMapRenderTarget::New(void)
-    { return new OpenGLShadowMapRenderTarget(); }
+    {
+        if ( Renderer::GetBackend() == Renderer::Backend::eNULL )
+            return new NullShadowMapRenderTarget();
+        return new OpenGLShadowMapRenderTarget();
+    }
 }
@@ -0,0 +1,149 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Layout of a text as glyph quads, and the cache of the layouts
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "graphic/textlayout.h"
+#include "graphic/glyphatlas.h"
+
+namespace Framework
+{
+    void TextLayout::Build(const GlyphAtlas& aAtlas, const char* aText, float aScale, uint32_t aVerticalSpacing,
+                           TextLayout& aLayout)
+    {
+        aLayout.mQuads.clear();
+
+        glm::vec2 lPos(0.0f, 0.0f);
+        glm::uvec2 lBox(0, 0), lLineSpan(0, 0);
+        for ( char c = *aText; c; c = *++aText )
+        {
+            if ( c == '\n' )
+            { // a newline character
+                lBox.x = std::max(lBox.x, lLineSpan.x);
+                lBox.y += lLineSpan.y + aVerticalSpacing;
+                lPos.x = 0.0f;
+                lPos.y += (lLineSpan.y + aVerticalSpacing) * aScale; // shift by the tallest glyph of the line plus the spacing
+                lLineSpan = glm::uvec2(0, 0);
+                continue;
+            }
+            ASSERT(c >= ' ' && c <= '~');
+
+            const GlyphAtlas::Glyph& lGlyph = aAtlas.GetGlyph(c);
+            lLineSpan.x += lGlyph.mAdvance;
+            lLineSpan.y = std::max(lLineSpan.y, lGlyph.mHeight);
+
+            if ( lGlyph.mWidth && lGlyph.mHeight )
+            {
+                /* Adjust the coordinates to take into account the bearings */
+                Quad lQuad;
+                lQuad.mMin = glm::vec2(lPos.x + lGlyph.mOffsetLeft * aScale, lPos.y + lGlyph.mOffsetTop * aScale);
+                lQuad.mMax = lQuad.mMin + glm::vec2(lGlyph.mWidth, lGlyph.mHeight) * aScale;
+                lQuad.mUVMin = lGlyph.mUVMin;
+                lQuad.mUVMax = lGlyph.mUVMax;
+                aLayout.mQuads.push_back(lQuad);
+            }
+            lPos.x += lGlyph.mAdvance * aScale;
+        }
+        lBox.x = std::max(lBox.x, lLineSpan.x);
+        lBox.y += lLineSpan.y;
+        aLayout.mBox = glm::uvec2(glm::vec2(lBox) * aScale);
+    }
+
+    void TextLayout::Emit(const glm::vec2& aOrigin, const glm::vec4& aColor, std::vector<GlyphVertex>& aVertices) const
+    {
+        GlyphVertex lVertex;
+        const glm::vec4 lColor = glm::clamp(aColor, 0.0f, 1.0f) * 255.0f + 0.5f;
+        for ( int i = 0; i < 4; ++i )
+            lVertex.mColor[i] = static_cast<uint8_t>(lColor[i]);
+
+        aVertices.reserve(aVertices.size() + mQuads.size() * 4);
+        for ( const Quad& lQuad : mQuads )
+        {
+            const glm::vec2 lMin = aOrigin + lQuad.mMin;
+            const glm::vec2 lMax = aOrigin + lQuad.mMax;
+            lVertex.mPosition = lMin;
+            lVertex.mUV = lQuad.mUVMin;
+            aVertices.push_back(lVertex);
+            lVertex.mPosition = glm::vec2(lMin.x, lMax.y);
+            lVertex.mUV = glm::vec2(lQuad.mUVMin.x, lQuad.mUVMax.y);
+            aVertices.push_back(lVertex);
+            lVertex.mPosition = glm::vec2(lMax.x, lMin.y);
+            lVertex.mUV = glm::vec2(lQuad.mUVMax.x, lQuad.mUVMin.y);
+            aVertices.push_back(lVertex);
+            lVertex.mPosition = lMax;
+            lVertex.mUV = lQuad.mUVMax;
+            aVertices.push_back(lVertex);
+        }
+    }
+
+    uint64_t TextLayoutCache::Hash(const char* aText, float aScale, uint32_t aVerticalSpacing)
+    {
+        // FNV-1a over the text, the scale bits and the spacing
+        uint64_t lHash = 14695981039346656037ull;
+        auto lMix = [&lHash](const uint8_t* aBytes, size_t aSize)
+        {
+            for ( size_t i = 0; i < aSize; ++i )
+            {
+                lHash ^= aBytes[i];
+                lHash *= 1099511628211ull;
+            }
+        };
+        lMix(reinterpret_cast<const uint8_t*>(aText), strlen(aText));
+        lMix(reinterpret_cast<const uint8_t*>(&aScale), sizeof(aScale));
+        lMix(reinterpret_cast<const uint8_t*>(&aVerticalSpacing), sizeof(aVerticalSpacing));
+        return lHash;
+    }
+
+    const TextLayout& TextLayoutCache::Get(const GlyphAtlas& aAtlas, const char* aText, float aScale, uint32_t aVerticalSpacing)
+    {
+        const uint64_t lHash = Hash(aText, aScale, aVerticalSpacing);
+        auto it = mEntries.find(lHash);
+        if ( it != mEntries.end() && it->second.mText == aText &&
+             it->second.mScale == aScale && it->second.mVerticalSpacing == aVerticalSpacing )
+        {
+            ++mStats.mHits;
+            it->second.mLastUse = mClock;
+            return it->second.mLayout;
+        }
+
+        // Not cached yet, or a hash collision that replaces the previous text
+        ++mStats.mMisses;
+        Entry& lEntry = mEntries[lHash];
+        lEntry.mText = aText;
+        lEntry.mScale = aScale;
+        lEntry.mVerticalSpacing = aVerticalSpacing;
+        lEntry.mLastUse = mClock;
+        TextLayout::Build(aAtlas, aText, aScale, aVerticalSpacing, lEntry.mLayout);
+        return lEntry.mLayout;
+    }
+
+    void TextLayoutCache::Tick()
+    {
+        if ( mEntries.size() > mCapacity )
+        {
+            for ( auto it = mEntries.begin(); it != mEntries.end(); )
+            {
+                if ( it->second.mLastUse < mClock )
+                {
+                    it = mEntries.erase(it);
+                    ++mStats.mEvictions;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+        ++mClock;
+    }
+
+    void TextLayoutCache::Clear()
+    {
+        mEntries.clear();
+    }
+}
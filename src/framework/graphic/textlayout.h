@@ -0,0 +1,130 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Layout of a text as a list of glyph quads of a GlyphAtlas, and the
+ *                cache of the layouts. A layout only depends on the text, the scale
+ *                and the vertical spacing, the quads are relative to the top left
+ *                corner of the text so the same layout is drawn at any position.
+ *                The cache keeps the layouts of the texts drawn every frame (labels
+ *                of the floor plan, debug info), only new or changed texts are built.
+ *******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <stdint.h>
+#include <glm/glm.hpp>
+
+namespace Framework
+{
+    class GlyphAtlas;
+
+    /**
+     * Vertex of the glyph quads sent to the graphic API
+     */
+    struct GlyphVertex
+    {
+        glm::vec2 mPosition;    /**< In screen space (in pixels) */
+        glm::vec2 mUV;          /**< Texture coordinates in the atlas */
+        uint8_t   mColor[4];    /**< RGBA, normalized by the graphic API */
+    };
+
+    struct TextLayout
+    {
+        struct Quad
+        {
+            glm::vec2 mMin;     /**< Corners relative to the top left corner of the text */
+            glm::vec2 mMax;
+            glm::vec2 mUVMin;
+            glm::vec2 mUVMax;
+        };
+
+        std::vector<Quad> mQuads;
+        glm::uvec2        mBox;     /**< Bounding rectangle of the text */
+
+        /**
+         * Builds the layout of a text. The glyphs are placed on their bearings and
+         * advanced from left to right, a newline starts a new line below the tallest
+         * glyph of the current one. Empty glyphs take no quad.
+         *
+         * @param aAtlas    Atlas of the font
+         * @param aText     Text to lay out
+         * @param aScale    Applied font scale
+         * @param aVerticalSpacing  Vertical spacing between text lines (unscaled)
+         * @param aLayout   Result
+         */
+        static void Build(const GlyphAtlas& aAtlas, const char* aText, float aScale, uint32_t aVerticalSpacing,
+                          TextLayout& aLayout);
+
+        /**
+         * Appends the quads of the layout as vertices, four per quad in the order
+         * left-top, left-bottom, right-top, right-bottom
+         *
+         * @param aOrigin    Screen position of the top left corner of the text
+         * @param aColor     Color of the text
+         * @param aVertices  Vertices to append to
+         */
+        void Emit(const glm::vec2& aOrigin, const glm::vec4& aColor, std::vector<GlyphVertex>& aVertices) const;
+    };
+
+    class TextLayoutCache
+    {
+    public:
+        struct Stats
+        {
+            uint32_t mHits = 0;
+            uint32_t mMisses = 0;
+            uint32_t mEvictions = 0;
+
+            float GetHitRate() const
+            {
+                const uint32_t lLookups = mHits + mMisses;
+                return lLookups ? static_cast<float>(mHits) / lLookups : 0.0f;
+            }
+        };
+
+        explicit TextLayoutCache(size_t aCapacity = 1024) : mCapacity(aCapacity) {}
+
+        /**
+         * Returns the layout of a text, building it if it is not in the cache
+         */
+        const TextLayout& Get(const GlyphAtlas& aAtlas, const char* aText, float aScale, uint32_t aVerticalSpacing);
+
+        /**
+         * Marks the end of a batch of lookups. When the cache is over its capacity
+         * the layouts not used since the previous call are dropped
+         */
+        void Tick();
+
+        /**
+         * Drops all the layouts, they are not valid any more when the atlas changes
+         */
+        void Clear();
+
+        size_t       Size() const       { return mEntries.size(); }
+        const Stats& GetStats() const   { return mStats; }
+        void         ResetStats()       { mStats = Stats(); }
+
+    private:
+        struct Entry
+        {
+            std::string mText;
+            float       mScale;
+            uint32_t    mVerticalSpacing;
+            uint32_t    mLastUse;
+            TextLayout  mLayout;
+        };
+
+        static uint64_t Hash(const char* aText, float aScale, uint32_t aVerticalSpacing);
+
+        std::unordered_map<uint64_t, Entry> mEntries;
+        size_t   mCapacity;
+        uint32_t mClock = 0;
+        Stats    mStats;
+    };
+}
@@ -12,7 +12,10 @@
 #include "precompiled.h"
 #include "texture.h"
 #include "core/logger.h"
-#include <IL/il.h>
+#include "core/graphic/imagedecoder.h"
+#ifndef NO_DEVIL
+    #include <IL/il.h>
+#endif
 
 namespace Framework
 {
@@ -21,6 +24,18 @@ namespace Framework
         Clear();
         if ( aFilename.empty() )
             return false;
+
+        /* The common formats are decoded without DevIL, so the loads can run on any thread */
+        if ( ImageDecoder::Decode(aFilename, *this) )
+            return true;
+
+#ifdef NO_DEVIL
+        WARNING("Failed to load image \"%s\". The other formats need DevIL", aFilename.c_str());
+        return false;
+#else
+        /* DevIL keeps its state in globals, one image is decoded at a time */
+        static std::mutex sDevILMutex;
+        std::lock_guard<std::mutex> lLock(sDevILMutex);
         static bool sCallILInit = true;
         if ( sCallILInit ) {
             ilInit();
@@ -55,5 +70,42 @@ end_label:;
         if ( lError != IL_NO_ERROR )
             WARNING("Failed to load image \"%s\". IL error code 0x%X", aFilename.c_str(), lError);
         return lError == IL_NO_ERROR;
+#endif
+    }
+
+    uint64_t Texture::GetLevelSize(Compression aCompression, uint32_t aWidth, uint32_t aHeight)
+    {
+        const uint64_t lBlocks = uint64_t((aWidth + 3) / 4) * ((aHeight + 3) / 4);
+        switch ( aCompression )
+        {
+            case Compression::eBC1: return lBlocks * 8;
+            case Compression::eBC3:
+            case Compression::eBC7: return lBlocks * 16;
+            default:                return uint64_t(aWidth) * aHeight * 4;
+        }
+    }
+
+    uint64_t Texture::GetLevelSize(uint32_t aLevel) const
+    {
+        return GetLevelSize(mCompression, GetLevelWidth(aLevel), GetLevelHeight(aLevel));
+    }
+
+    uint64_t Texture::GetLevelOffset(uint32_t aLevel) const
+    {
+        uint64_t lOffset = 0;
+        for ( uint32_t i = 0; i < aLevel; ++i )
+            lOffset += GetLevelSize(i);
+        return lOffset;
+    }
+
+    uint64_t Texture::GetResidentSize() const
+    {
+        if ( IsCooked() )
+            return mPixels.size();
+
+        uint64_t lBytes = 0;
+        for ( uint32_t lLevel = 0; (std::max(mWidth, mHeight) >> lLevel) > 0; ++lLevel )
+            lBytes += uint64_t(GetLevelWidth(lLevel)) * GetLevelHeight(lLevel) * 4;
+        return lBytes;
     }
 }
@@ -4,12 +4,15 @@
  *                Unauthorized copying of this file, via any medium is strictly prohibited
  *                Proprietary and confidential
  *
- *  Brief       : Holds the texture data
+ *  Brief       : Holds the texture data. A decoded image holds one level of pixels
+ *                in mFormat/mType, a cooked one (see TextureCooker) holds its whole
+ *                mip chain as RGBA8 pixels or as compressed blocks, ready for the GPU
  *******************************************************************************/
 
 #pragma once
 
 #include <stdint.h>
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -17,12 +20,22 @@ namespace Framework
 {
     struct Texture
     {
+        enum class Compression : uint32_t
+        {
+            eNONE = 0,
+            eBC1  = 1,      /**< 8 bytes per 4x4 block, RGB and 1 bit alpha */
+            eBC3  = 2,      /**< 16 bytes per 4x4 block, RGB and interpolated alpha */
+            eBC7  = 3       /**< 16 bytes per 4x4 block, RGBA in higher quality */
+        };
+
         std::string mName;
         uint32_t    mWidth = 0;
         uint32_t    mHeight = 0;
         uint32_t    mBytesPerPixel = 0;
         uint32_t    mType = 0;
         uint32_t    mFormat = 0;
+        Compression mCompression = Compression::eNONE;
+        uint32_t    mMipLevels = 1;     /**< Levels in mPixels, the largest first. More than 1 only when cooked */
         std::vector<uint8_t> mPixels;
 
         Texture() = default;
@@ -36,6 +49,8 @@ namespace Framework
             , mBytesPerPixel(aTempTexture.mBytesPerPixel)
             , mType(aTempTexture.mType)
             , mFormat(aTempTexture.mFormat)
+            , mCompression(aTempTexture.mCompression)
+            , mMipLevels(aTempTexture.mMipLevels)
             , mPixels(std::move(aTempTexture.mPixels))
 
         {
@@ -52,6 +67,8 @@ namespace Framework
             mBytesPerPixel = aTempTexture.mBytesPerPixel;
             mType = aTempTexture.mType;
             mFormat = aTempTexture.mFormat;
+            mCompression = aTempTexture.mCompression;
+            mMipLevels = aTempTexture.mMipLevels;
             mPixels = std::move(aTempTexture.mPixels);
             aTempTexture.Clear();
             return *this;
@@ -65,9 +82,36 @@ namespace Framework
             mBytesPerPixel = 0;
             mType = 0;
             mFormat = 0;
+            mCompression = Compression::eNONE;
+            mMipLevels = 1;
             mPixels.clear();
         }
 
+        /**
+         * Decodes an image file. It can be called from any thread, the formats the
+         * ImageDecoder does not support go through DevIL one image at a time
+         */
         bool Load(const std::string& aFilename);
+
+        /**
+         * Indicates if the texture went through the TextureCooker, its pixels are
+         * then RGBA8 or compressed blocks and its mip chain is already built
+         */
+        bool IsCooked() const { return mMipLevels > 1 || mCompression != Compression::eNONE; }
+
+        /**
+         * Bytes of a mip level of a cooked texture
+         */
+        static uint64_t GetLevelSize(Compression aCompression, uint32_t aWidth, uint32_t aHeight);
+        uint64_t        GetLevelSize(uint32_t aLevel) const;
+        uint64_t        GetLevelOffset(uint32_t aLevel) const;
+        uint32_t        GetLevelWidth(uint32_t aLevel) const  { return std::max(mWidth >> aLevel, 1u); }
+        uint32_t        GetLevelHeight(uint32_t aLevel) const { return std::max(mHeight >> aLevel, 1u); }
+
+        /**
+         * Bytes of video memory of the uploaded texture. A texture that is not cooked
+         * is stored as RGBA8 with a generated mip chain
+         */
+        uint64_t GetResidentSize() const;
     };
 }
@@ -0,0 +1,277 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Static bounding volume hierarchy over the triangles of a mesh. The
+ *                nodes are split with a binned surface area heuristic over the
+ *                triangle centroids.
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "graphic/trianglehierarchy.h"
+
+namespace Framework
+{
+    namespace
+    {
+        const uint32_t sMaxLeafTriangles = 4;
+        const uint32_t sBinCount = 12;
+
+        inline float SurfaceArea(const glm::vec3& aMin, const glm::vec3& aMax)
+        {
+            glm::vec3 d = aMax - aMin;
+            return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+
+        // Returns the distance to the box along the ray, or a negative value if it is missed
+        inline float IntersectBox(const glm::vec3& aMin, const glm::vec3& aMax, const glm::vec3& aOrigin, const glm::vec3& aInvDirection, float aMaxDistance)
+        {
+            glm::vec3 t1 = (aMin - aOrigin) * aInvDirection;
+            glm::vec3 t2 = (aMax - aOrigin) * aInvDirection;
+            glm::vec3 lNear = glm::min(t1, t2);
+            glm::vec3 lFar = glm::max(t1, t2);
+            float lEnter = std::max(std::max(lNear.x, lNear.y), std::max(lNear.z, 0.0f));
+            float lExit = std::min(std::min(lFar.x, lFar.y), std::min(lFar.z, aMaxDistance));
+            return lEnter <= lExit ? lEnter : -1.0f;
+        }
+
+        // Moller-Trumbore, both faces
+        inline bool IntersectTriangle(const glm::vec3& aOrigin, const glm::vec3& aDirection,
+                                      const glm::vec3& aV0, const glm::vec3& aV1, const glm::vec3& aV2, float& aDistance)
+        {
+            const glm::vec3 lEdge1 = aV1 - aV0;
+            const glm::vec3 lEdge2 = aV2 - aV0;
+            const glm::vec3 p = glm::cross(aDirection, lEdge2);
+            const float lDet = glm::dot(lEdge1, p);
+            if ( std::abs(lDet) < 1.0e-12f )
+                return false;
+            const float lInvDet = 1.0f / lDet;
+            const glm::vec3 s = aOrigin - aV0;
+            const float u = glm::dot(s, p) * lInvDet;
+            if ( u < 0.0f || u > 1.0f )
+                return false;
+            const glm::vec3 q = glm::cross(s, lEdge1);
+            const float v = glm::dot(aDirection, q) * lInvDet;
+            if ( v < 0.0f || u + v > 1.0f )
+                return false;
+            const float t = glm::dot(lEdge2, q) * lInvDet;
+            if ( t < 0.0f || t >= aDistance )
+                return false;
+            aDistance = t;
+            return true;
+        }
+    }
+
+    void TriangleHierarchy::Build(std::vector<glm::vec3> aPositions, std::vector<uint32_t> aIndices)
+    {
+        ASSERT(aIndices.size() % 3 == 0);
+        Clear();
+        mPositions = std::move(aPositions);
+        mIndices = std::move(aIndices);
+
+        const uint32_t lTriangleCount = static_cast<uint32_t>(mIndices.size() / 3);
+        if ( lTriangleCount == 0 )
+            return;
+
+        std::vector<glm::vec3> lCentroids(lTriangleCount);
+        for ( uint32_t i = 0; i < lTriangleCount; ++i )
+            lCentroids[i] = (mPositions[mIndices[3 * i]] + mPositions[mIndices[3 * i + 1]] + mPositions[mIndices[3 * i + 2]]) / 3.0f;
+
+        mNodes.reserve(2 * lTriangleCount / sMaxLeafTriangles + 1);
+        BuildNode(lCentroids, 0, lTriangleCount);
+        mNodes.shrink_to_fit();
+    }
+
+    void TriangleHierarchy::Clear()
+    {
+        mNodes.clear();
+        mPositions.clear();
+        mIndices.clear();
+    }
+
+    uint32_t TriangleHierarchy::BuildNode(std::vector<glm::vec3>& aCentroids, uint32_t aFirst, uint32_t aCount)
+    {
+        const uint32_t lNodeIndex = static_cast<uint32_t>(mNodes.size());
+        mNodes.push_back(Node());
+
+        glm::vec3 lMin(FLT_MAX), lMax(-FLT_MAX);
+        glm::vec3 lCentroidMin(FLT_MAX), lCentroidMax(-FLT_MAX);
+        for ( uint32_t i = aFirst; i < aFirst + aCount; ++i )
+        {
+            for ( int k = 0; k < 3; ++k )
+            {
+                lMin = glm::min(lMin, mPositions[mIndices[3 * i + k]]);
+                lMax = glm::max(lMax, mPositions[mIndices[3 * i + k]]);
+            }
+            lCentroidMin = glm::min(lCentroidMin, aCentroids[i]);
+            lCentroidMax = glm::max(lCentroidMax, aCentroids[i]);
+        }
+        mNodes[lNodeIndex].mMin = lMin;
+        mNodes[lNodeIndex].mMax = lMax;
+        mNodes[lNodeIndex].mFirst = aFirst;
+        mNodes[lNodeIndex].mCount = aCount;
+
+        if ( aCount <= sMaxLeafTriangles )
+            return lNodeIndex;
+
+        // Split along the axis with the biggest centroid extent
+        const glm::vec3 lExtent = lCentroidMax - lCentroidMin;
+        const int lAxis = (lExtent.x > lExtent.y && lExtent.x > lExtent.z) ? 0 : (lExtent.y > lExtent.z ? 1 : 2);
+        if ( lExtent[lAxis] <= 0.0f )
+            return lNodeIndex; // all the centroids are in the same place, keep it as a leaf
+
+        struct Bin
+        {
+            glm::vec3 mMin = glm::vec3(FLT_MAX);
+            glm::vec3 mMax = glm::vec3(-FLT_MAX);
+            uint32_t  mCount = 0;
+        } lBins[sBinCount];
+
+        const float lBinScale = sBinCount / lExtent[lAxis];
+        auto BinOf = [&](uint32_t aTriangle)
+        {
+            uint32_t b = static_cast<uint32_t>((aCentroids[aTriangle][lAxis] - lCentroidMin[lAxis]) * lBinScale);
+            return std::min(b, sBinCount - 1);
+        };
+
+        for ( uint32_t i = aFirst; i < aFirst + aCount; ++i )
+        {
+            Bin& lBin = lBins[BinOf(i)];
+            ++lBin.mCount;
+            for ( int k = 0; k < 3; ++k )
+            {
+                lBin.mMin = glm::min(lBin.mMin, mPositions[mIndices[3 * i + k]]);
+                lBin.mMax = glm::max(lBin.mMax, mPositions[mIndices[3 * i + k]]);
+            }
+        }
+
+        // Sweep from the right to get the cost of the right side of every split plane
+        float lRightCost[sBinCount];
+        {
+            glm::vec3 lRightMin(FLT_MAX), lRightMax(-FLT_MAX);
+            uint32_t lRightCount = 0;
+            for ( uint32_t b = sBinCount - 1; b > 0; --b )
+            {
+                lRightMin = glm::min(lRightMin, lBins[b].mMin);
+                lRightMax = glm::max(lRightMax, lBins[b].mMax);
+                lRightCount += lBins[b].mCount;
+                lRightCost[b] = lRightCount ? lRightCount * SurfaceArea(lRightMin, lRightMax) : 0.0f;
+            }
+        }
+
+        float lBestCost = FLT_MAX;
+        uint32_t lBestSplit = 0;
+        {
+            glm::vec3 lLeftMin(FLT_MAX), lLeftMax(-FLT_MAX);
+            uint32_t lLeftCount = 0;
+            for ( uint32_t b = 1; b < sBinCount; ++b )
+            {
+                lLeftMin = glm::min(lLeftMin, lBins[b - 1].mMin);
+                lLeftMax = glm::max(lLeftMax, lBins[b - 1].mMax);
+                lLeftCount += lBins[b - 1].mCount;
+                if ( lLeftCount == 0 || lLeftCount == aCount )
+                    continue;
+                float lCost = lLeftCount * SurfaceArea(lLeftMin, lLeftMax) + lRightCost[b];
+                if ( lCost < lBestCost )
+                {
+                    lBestCost = lCost;
+                    lBestSplit = b;
+                }
+            }
+        }
+
+        // Not splitting is cheaper, keep it as a leaf
+        if ( lBestSplit == 0 || lBestCost >= aCount * SurfaceArea(lMin, lMax) )
+            return lNodeIndex;
+
+        // Partition the triangles of the range by the split bin
+        uint32_t i = aFirst, j = aFirst + aCount;
+        while ( i < j )
+        {
+            if ( BinOf(i) < lBestSplit )
+            {
+                ++i;
+            }
+            else
+            {
+                --j;
+                std::swap(aCentroids[i], aCentroids[j]);
+                std::swap(mIndices[3 * i], mIndices[3 * j]);
+                std::swap(mIndices[3 * i + 1], mIndices[3 * j + 1]);
+                std::swap(mIndices[3 * i + 2], mIndices[3 * j + 2]);
+            }
+        }
+        const uint32_t lLeftCount = i - aFirst;
+        ASSERT(0 < lLeftCount && lLeftCount < aCount);
+
+        BuildNode(aCentroids, aFirst, lLeftCount);
+        const uint32_t lRight = BuildNode(aCentroids, i, aCount - lLeftCount);
+        mNodes[lNodeIndex].mFirst = lRight;
+        mNodes[lNodeIndex].mCount = 0;
+        return lNodeIndex;
+    }
+
+    bool TriangleHierarchy::Raycast(const glm::vec3& aOrigin, const glm::vec3& aDirection, float& aDistance, glm::vec3& aNormal) const
+    {
+        if ( mNodes.empty() )
+            return false;
+
+        const glm::vec3 lInvDirection = 1.0f / aDirection;
+        int32_t lHitTriangle = -1;
+
+        if ( IntersectBox(mNodes[0].mMin, mNodes[0].mMax, aOrigin, lInvDirection, aDistance) < 0.0f )
+            return false;
+        std::vector<uint32_t> lStack;
+        lStack.reserve(64);
+        lStack.push_back(0);
+
+        while ( !lStack.empty() )
+        {
+            const Node& lNode = mNodes[lStack.back()];
+            lStack.pop_back();
+            if ( lNode.mCount )
+            {
+                for ( uint32_t t = lNode.mFirst; t < lNode.mFirst + lNode.mCount; ++t )
+                {
+                    if ( IntersectTriangle(aOrigin, aDirection,
+                                           mPositions[mIndices[3 * t]], mPositions[mIndices[3 * t + 1]], mPositions[mIndices[3 * t + 2]],
+                                           aDistance) )
+                        lHitTriangle = static_cast<int32_t>(t);
+                }
+                continue;
+            }
+
+            // Visit the nearest child first, so the far one is likely culled by the hit distance
+            const uint32_t lChild1 = static_cast<uint32_t>(&lNode - &mNodes[0]) + 1;
+            const uint32_t lChild2 = lNode.mFirst;
+            float d1 = IntersectBox(mNodes[lChild1].mMin, mNodes[lChild1].mMax, aOrigin, lInvDirection, aDistance);
+            float d2 = IntersectBox(mNodes[lChild2].mMin, mNodes[lChild2].mMax, aOrigin, lInvDirection, aDistance);
+            if ( d1 >= 0.0f && d2 >= 0.0f )
+            {
+                lStack.push_back(d1 <= d2 ? lChild2 : lChild1);
+                lStack.push_back(d1 <= d2 ? lChild1 : lChild2);
+            }
+            else if ( d1 >= 0.0f )
+            {
+                lStack.push_back(lChild1);
+            }
+            else if ( d2 >= 0.0f )
+            {
+                lStack.push_back(lChild2);
+            }
+        }
+
+        if ( lHitTriangle < 0 )
+            return false;
+
+        const glm::vec3& v0 = mPositions[mIndices[3 * lHitTriangle]];
+        const glm::vec3& v1 = mPositions[mIndices[3 * lHitTriangle + 1]];
+        const glm::vec3& v2 = mPositions[mIndices[3 * lHitTriangle + 2]];
+        aNormal = glm::normalize(glm::cross(v1 - v0, v2 - v0));
+        if ( glm::dot(aNormal, aDirection) > 0.0f )
+            aNormal = -aNormal;
+        return true;
+    }
+}
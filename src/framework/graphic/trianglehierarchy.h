@@ -0,0 +1,76 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Static bounding volume hierarchy over the triangles of a mesh, used
+ *                to cast rays against the geometry on the CPU (picking). It keeps its
+ *                own copy of the vertex positions, so it stays valid after the vertex
+ *                data of the asset has been uploaded to the GPU and released.
+ *******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+
+#include "glm/glm.hpp"
+
+namespace Framework
+{
+    class TriangleHierarchy
+    {
+    public:
+        TriangleHierarchy() = default;
+
+        /**
+         * Builds the hierarchy. The triangles are given by triplets of indices
+         * into aPositions, like the index data of Asset3D
+         */
+        void Build(std::vector<glm::vec3> aPositions, std::vector<uint32_t> aIndices);
+
+        /**
+         * Releases the hierarchy
+         */
+        void Clear();
+
+        /**
+         * Casts a ray against the triangles. Both faces of the triangles are hit
+         *
+         * @param aOrigin     Origin of the ray
+         * @param aDirection  Direction of the ray, the distances are measured in units of its length
+         * @param aDistance   In: maximum distance of the hit. Out: distance of the nearest hit
+         * @param aNormal     Out: geometric normal of the hit triangle, facing the ray origin
+         *
+         * @return true if a triangle was hit closer than the given distance
+         */
+        bool Raycast(const glm::vec3& aOrigin, const glm::vec3& aDirection, float& aDistance, glm::vec3& aNormal) const;
+
+        bool   IsEmpty() const          { return mNodes.empty(); }
+        size_t GetTriangleCount() const { return mIndices.size() / 3; }
+
+        /**
+         * @return Bytes of system memory taken by the hierarchy
+         */
+        size_t GetMemorySize() const
+        {
+            return mNodes.capacity() * sizeof(Node) + mPositions.capacity() * sizeof(glm::vec3) + mIndices.capacity() * sizeof(uint32_t);
+        }
+
+    private:
+        struct Node
+        {
+            glm::vec3 mMin;
+            glm::vec3 mMax;
+            uint32_t  mFirst;   /**< Leaf: first triangle. Inner node: index of the second child, the first one follows the node */
+            uint32_t  mCount;   /**< Number of triangles of a leaf, 0 for inner nodes */
+        };
+
+        uint32_t BuildNode(std::vector<glm::vec3>& aCentroids, uint32_t aFirst, uint32_t aCount);
+
+        std::vector<Node>      mNodes;
+        std::vector<glm::vec3> mPositions;
+        std::vector<uint32_t>  mIndices;   /**< Triangle indices, reordered so every leaf owns a contiguous range */
+    };
+}
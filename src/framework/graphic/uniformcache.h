@@ -0,0 +1,111 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Shadow copy of the uniform values of a shader program. The uniforms
+ *                are program state, so a value that did not change since the last set
+ *                does not need to be sent to the graphic API again. Every uniform handle
+ *                owns a slot, the slot storage is allocated the first time it is updated.
+ *******************************************************************************/
+
+#pragma once
+
+#include <string.h>
+#include <vector>
+#include <stdint.h>
+
+namespace Framework
+{
+    class UniformCache
+    {
+    public:
+        /**
+         * Counters of the updates since the last reset
+         */
+        struct Stats
+        {
+            uint32_t mUpdates = 0;   /**< Values sent to the graphic API */
+            uint32_t mSkipped = 0;   /**< Redundant values dropped */
+        };
+
+        /**
+         * Adds a slot for a new uniform
+         *
+         * @return The slot index, the handles of the shaders use it directly
+         */
+        uint32_t Add()
+        {
+            mSlots.push_back(Slot());
+            return static_cast<uint32_t>(mSlots.size() - 1);
+        }
+
+        /**
+         * Removes all the slots, the handles given so far are not valid anymore
+         */
+        void Clear()
+        {
+            mSlots.clear();
+            mData.clear();
+        }
+
+        /**
+         * Forgets the stored values, the next update of every slot is sent
+         */
+        void Invalidate()
+        {
+            for ( auto& lSlot : mSlots )
+                lSlot.mValid = false;
+        }
+
+        /**
+         * Stores the value of a slot
+         *
+         * @param aSlot   Slot of the uniform
+         * @param aValue  New value
+         * @param aBytes  Size of the value
+         *
+         * @return true if the value differs from the stored one and has to be sent
+         */
+        bool Update(uint32_t aSlot, const void* aValue, uint32_t aBytes)
+        {
+            Slot& lSlot = mSlots[aSlot];
+            if ( lSlot.mBytes < aBytes )
+            {
+                // First update, or a bigger array than before: give the slot new storage
+                lSlot.mOffset = static_cast<uint32_t>(mData.size());
+                lSlot.mBytes = aBytes;
+                lSlot.mValid = false;
+                mData.resize(mData.size() + aBytes);
+            }
+            uint8_t* lStored = mData.data() + lSlot.mOffset;
+            if ( lSlot.mValid && lSlot.mSize == aBytes && memcmp(lStored, aValue, aBytes) == 0 )
+            {
+                ++mStats.mSkipped;
+                return false;
+            }
+            memcpy(lStored, aValue, aBytes);
+            lSlot.mSize = aBytes;
+            lSlot.mValid = true;
+            ++mStats.mUpdates;
+            return true;
+        }
+
+        const Stats& GetStats() const { return mStats; }
+        void         ResetStats()     { mStats = Stats(); }
+
+    private:
+        struct Slot
+        {
+            uint32_t mOffset = 0;
+            uint32_t mBytes = 0;    /**< Allocated storage */
+            uint32_t mSize = 0;     /**< Size of the stored value */
+            bool     mValid = false;
+        };
+
+        std::vector<Slot>    mSlots;
+        std::vector<uint8_t> mData;
+        Stats                mStats;
+    };
+}
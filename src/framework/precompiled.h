@@ -41,6 +41,10 @@
 #include <algorithm>
 #include <exception> // For handling the exceptions
 #include <memory>    // For smart pointers
+#include <thread>    // Worker threads, before core/macros.h redefines __out
+#include <mutex>
+#include <condition_variable>
+#include <future>
 
 #ifdef  _WIN32
     #include <tchar.h>
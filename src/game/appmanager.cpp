@@ -9,6 +9,7 @@
 #include "engine.h"
 #include "engine/script.h"
 #include "engine/project.h"
+#include "engine/projectfile.h"
 
 #include "appmanager.h"
 #include "engine/components/motioncmp.h"
@@ -208,13 +209,13 @@ namespace Game
         {
             char buf[1024];
             GetCurrentDirectoryA(256, buf);
-            std::string lFileName = file_dialog({ {"sh3d", "Sweet Home Project files"}, {"*", "All files"} }, true);
+            std::string lFileName = file_dialog({ {"sh3d", "Sweet Home Project files"}, {"sh3b", "Sweet Home binary Project files"}, {"*", "All files"} }, true);
             SetCurrentDirectoryA(buf);
 
             if (!lFileName.empty())
             {
-                //  The file name does not include file extension. So add it here.
-                if (lFileName.find(".sh3d") == std::string::npos)
+                //  The file name does not include file extension. So add it here. The binary one saves in the binary format
+                if (lFileName.find(".sh3d") == std::string::npos && !Framework::ProjectFile::HasBinaryExtension(lFileName))
                     lCurrentProject->SetFileName(lFileName + ".sh3d");
                 else
                     lCurrentProject->SetFileName(lFileName);
@@ -252,9 +253,20 @@ namespace Game
         if (lCurrentProject == nullptr)
             return;
 
-       
+        // Another project starts a new session, which writes the whole project first
+        if (mAutosaveProject.lock() != lCurrentProject)
+        {
+            mAutosave.SetFileName("./data/resources/projects/autosave.project");
+            mAutosaveProject = lCurrentProject;
+        }
+
         lCurrentProject->SetSample(false);
-        lCurrentProject->Save("./data/resources/projects/autosave.project");
+        if (!lCurrentProject->Autosave(mAutosave))
+            return;
+
+        const Framework::AutosaveJournal::Stats lStats = mAutosave.GetStats();
+        INFO(LogLevel::eLEVEL2, "Autosave: %u entities, %.2f ms on the main thread, %llu bytes written by the previous autosave",
+             lStats.mLastEntities, lStats.mLastStall, static_cast<unsigned long long>(lStats.mLastBytes));
     }
 
     std::string AppManager::AddScene(const std::string aSceneName)
@@ -11,6 +11,7 @@
 #include "core/utils.h"
 #include "core/serialization/jsoncpputils.h"
 #include "engine/basemanager.h"
+#include "engine/autosave.h"
 #include "graphic/scene.h"
 #include "floorplanner3d.h"
 #include "catalogview.h"
@@ -60,6 +61,8 @@ namespace Game
         Game::UIFloorPlanner3D*             mFloorPlanner;
         std::string                         mSceneToRemove;
         Framework::Timer*                   mAutosaveTimer;
+        Framework::AutosaveJournal          mAutosave;
+        std::weak_ptr<Framework::Project>   mAutosaveProject;   /**< Project of the autosave session */
         UICatalogView*                      mCatalogView;
         UIButton*                           mBtnToggleCatalogView;
     };
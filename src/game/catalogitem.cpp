@@ -45,11 +45,24 @@ namespace Game
 
     void CatalogItem::Deserialize(const Json::Value& aSerializer)
     {
-        mId = aSerializer.get("id", mId).asString();
-        mName = aSerializer.get("name", mName).asString();
+        Read(aSerializer);
+    }
+
+    void CatalogItem::DeserializeView(const JsonView& aSerializer)
+    {
+        Read(aSerializer);
+    }
+
+    template<class Serializer>
+    void CatalogItem::Read(const Serializer& aSerializer)
+    {
+        if (aSerializer.isMember("id"))
+            mId = aSerializer["id"].asString();
+        if (aSerializer.isMember("name"))
+            mName = aSerializer["name"].asString();
         mPrefabFile = aSerializer["prefabfile"].asString();
-        string lGroupStr = aSerializer.get("group", CatalogGroupToString(mGroup)).asString();
-        mGroup = StringToCatalogGroup(lGroupStr.c_str());
+        if (aSerializer.isMember("group"))
+            mGroup = StringToCatalogGroup(aSerializer["group"].asString().c_str());
 
         const string lImageName = aSerializer["icon"].asString();
         mIcon = Engine::Instance()->ResourceManager().FindImage(lImageName);
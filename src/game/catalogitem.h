@@ -7,6 +7,7 @@
 
 #include "precompiled.h"
 #include "core/serialization/serializableobject.h"
+#include "core/serialization/jsondocument.h"
 #include "graphic/texture.h"
 
 #include "cataloggroup.h"
@@ -27,8 +28,14 @@ namespace Game
 
         void                                Serialize(Json::Value& aSerialize) const override;
         void                                Deserialize(const Json::Value& aSerialize) override;
+        /** From the catalog file read in place, see CatalogManager::LoadCatalog */
+        void                                DeserializeView(const Framework::JsonView& aSerialize);
 
     protected:
+        /** Shared by both serializers, read with the same Json::Value names */
+        template<class Serializer>
+        void                                Read(const Serializer& aSerializer);
+
         std::string                         mId;
         std::string                         mName;
         CatalogGroup                        mGroup;
@@ -41,12 +41,12 @@ namespace Game
 
     void CatalogManager::LoadCatalog(const string& aResourceFile)
     {
-        Json::Value lRes;
+        JsonDocument lRes;
         Json::JsonUtils::OpenAndParseJsonFromFile(lRes, aResourceFile);
 
-        for (size_t i = 0, lSize = lRes.size(); i < lSize; ++i)
+        for (const JsonView lItem : lRes.GetRoot())
         {
-            AddCatalogItem(lRes[static_cast<int>(i)]);
+            AddCatalogItem(lItem);
         }
     }
 
@@ -68,10 +68,10 @@ namespace Game
         return lResult;
     }
 
-    CatalogItem* CatalogManager::AddCatalogItem(const Json::Value& aSerializer)
+    CatalogItem* CatalogManager::AddCatalogItem(const JsonView& aSerializer)
     {
         mCatalogItems.push_back(new CatalogItem());
-        mCatalogItems.back()->Deserialize(aSerializer);
+        mCatalogItems.back()->DeserializeView(aSerializer);
         return mCatalogItems.back();
     }
 
@@ -10,6 +10,7 @@
 
 #include "core/utils.h"
 #include "core/serialization/jsoncpputils.h"
+#include "core/serialization/jsondocument.h"
 
 #include "engine/basemanager.h"
 #include "cataloggroup.h"
@@ -35,7 +36,7 @@ namespace Game
         std::vector<CatalogItem*> GetCatalogItems(CatalogGroup aGroup);
 
     private:
-        CatalogItem*              AddCatalogItem(const Json::Value& aSerializer);
+        CatalogItem*              AddCatalogItem(const Framework::JsonView& aSerializer);
         void                      ClearCatalog();
 
     protected:
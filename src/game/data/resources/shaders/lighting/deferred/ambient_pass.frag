@@ -5,12 +5,20 @@ layout(location = 0) out vec4 o_color;
 uniform sampler2D u_diffuseMap;
 uniform sampler2D u_normalMap;
 
-uniform vec2      u_screenSize;
+layout(std140) uniform FrameData // shared by all the passes, updated once per frame
+{
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 viewProjectionMatrix;
+	vec4 cameraPosition;
+	vec2 screenSize;
+}
+u_Frame;
 
 
 void main() 
 { 
-	vec2 texCoord = gl_FragCoord.xy/u_screenSize;
+	vec2 texCoord = gl_FragCoord.xy/u_Frame.screenSize;
 	vec4 materialDiffuseColor = texture(u_diffuseMap, texCoord);
 	o_color = materialDiffuseColor; // color for fragment that is not subject to lighting
 	
@@ -3,20 +3,37 @@
 layout(location = 0) in vec3 in_vertex;
 layout(location = 1) in vec3 in_normal;
 layout(location = 2) in vec2 in_uvcoord;
+layout(location = 3) in mat4 in_instanceMatrix; // locations 3 to 6, one per instance
+layout(location = 7) in vec3 in_instanceId;
+
+layout(std140) uniform FrameData // shared by all the passes, updated once per frame
+{
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 viewProjectionMatrix;
+	vec4 cameraPosition;
+	vec2 screenSize;
+}
+u_Frame;
 
-uniform mat4 u_MVPMatrix;
 uniform mat4 u_ModelMatrix;
+uniform vec3 u_modelId;
+uniform bool u_instanced; /* the model matrix and the model id come from the instance attributes */
 
 out vec3 io_fragVertex;
 out vec3 io_fragNormal;
 out vec2 io_fragUVCoord;
+flat out vec3 io_modelId;
 
 
 void main()
 { 
+	mat4 modelMatrix = u_instanced ? in_instanceMatrix : u_ModelMatrix;
 	vec4 v = vec4(in_vertex, 1.0);
-	gl_Position = u_MVPMatrix * v;
-    io_fragVertex = (u_ModelMatrix * v).xyz; // vertex position in world space
-    io_fragNormal = (u_ModelMatrix * vec4(in_normal, 0.0)).xyz; // normal in world space
+	vec4 worldVertex = modelMatrix * v;
+	gl_Position = u_Frame.viewProjectionMatrix * worldVertex;
+    io_fragVertex = worldVertex.xyz; // vertex position in world space
+    io_fragNormal = (modelMatrix * vec4(in_normal, 0.0)).xyz; // normal in world space
     io_fragUVCoord = in_uvcoord;
+    io_modelId = u_instanced ? in_instanceId : u_modelId;
 }
@@ -9,7 +9,15 @@ uniform sampler2D u_normalMap; /* xyz = normal in world space, w = lighting flag
                                   1 = fragment is subject to lighting but not a shadow receiver,
                                   2 = fragment is subject to lighting and a shadow receiver */
 
-uniform vec2      u_screenSize;
+layout(std140) uniform FrameData // shared by all the passes, updated once per frame
+{
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 viewProjectionMatrix;
+	vec4 cameraPosition;
+	vec2 screenSize;
+}
+u_Frame;
 
 uniform vec3      u_LightPosition; // in world space
 uniform vec4      u_LightColor;
@@ -24,7 +32,7 @@ uniform mat4            u_LVPMatrix_sb; // light view-projection matrix, scaled
 void main() 
 { 
 	o_color = vec4(0.0, 0.0, 0.0, 0.0); // output color assiming it is applied via additive blending
-	vec2 texCoord = gl_FragCoord.xy/u_screenSize;
+	vec2 texCoord = gl_FragCoord.xy/u_Frame.screenSize;
 	vec4 normal_ = texture(u_normalMap, texCoord);
 	if ( normal_.w == 0.0 )
 		return; // fragment Not subject to lighting
@@ -4,13 +4,13 @@
 #version 330 core
 
 in vec2 f_texcoord;
+in vec4 f_color;
 
 uniform sampler2D glyph;
-uniform vec4 color;
 
 out vec4 fragColor;
 
 void main(void) {
     float intensity = texture(glyph, f_texcoord).r;
-    fragColor = color * intensity;
+    fragColor = f_color * intensity;
 }
@@ -5,16 +5,17 @@
 
 // Input parameters
 layout(location = 0) in vec2 vertex; // in screen space (in pixels)
-layout(location = 1) in vec2 texcoord;
+layout(location = 1) in vec2 texcoord; // in the glyph atlas
+layout(location = 2) in vec4 color;
 
 // Output parameters for the fragment shader
 out vec2 f_texcoord;
+out vec4 f_color;
 
 uniform mat4 glyphTransform; // to NDC
-uniform vec2 glyphPos; // in screen space (in pixels)
-uniform float scale;
 
 void main(void) {
-    gl_Position = glyphTransform * vec4(glyphPos + vertex * scale, 0.0, 1.0);
+    gl_Position = glyphTransform * vec4(vertex, 0.0, 1.0);
     f_texcoord = texcoord;
+    f_color = color;
 }
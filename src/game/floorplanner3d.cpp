@@ -10,6 +10,7 @@
 #include "floorplanner3d.h"
 
 #include "engine/project.h"
+#include "engine/CmpManager.h"
 #include "engine/components/cameracmp.h"
 #include "engine/components/renderablecmp.h"
 #include "engine/components/directlightcmp.h"
@@ -303,7 +304,10 @@ namespace Game
         if ( mScene->GetActiveCamera()->GetProjectionType() == Projection::PERSPECTIVE )
         {
             if ( lModel3D ) // set position of Model3D if there is Model3D
+            {
                 lModel3D->SetPosition(lPosition);
+                lModel3D->RefitSpatialProxy();
+            }
         }
         else // ORTHOGRAPHIC
         {
@@ -365,8 +369,9 @@ namespace Game
             return false;
         }
 
+        if (!GetCurrentProject()->SetActiveScene(lNewScene))
+            return false;
         mScene = lNewScene;
-        GetCurrentProject()->SetActiveScene(mScene);
         Engine::Instance()->Display().performLayout();
         Engine::Instance()->StateMachine().ExecuteAction("OnChangedSceneSelection");
         return true;
@@ -380,9 +385,12 @@ namespace Game
         //Add the new floor
         if (lSelectedSceneName.compare("Add Floor") == 0)
             Engine::Instance()->StateMachine().ExecuteAction("GotoAddScene");
-        //Load the scene
-        else 
-            LoadScene(lSelectedSceneName);
+        //Load the scene, the combo shows the active one again if it fails
+        else if (!LoadScene(lSelectedSceneName))
+        {
+            mSceneSelectCombo->setSelectedIndex(mSceneSelectComboIndex);
+            return;
+        }
 
         mSceneSelectComboIndex = aSelectedSceneIndex;
         mSceneSelectCombo->setSelectedIndex(mSceneSelectComboIndex);
@@ -0,0 +1,434 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Cooks a tree of assets into engine model files on a pool of threads.
+ *                The OBJ files are imported with their materials and textures, the
+ *                model files are cooked again; both get the mesh optimization, the
+ *                levels of detail and the texture cook of the other tools.
+ *
+ *                A manifest in the output directory keeps a content hash of the
+ *                inputs of every asset (the source file, and the material libraries
+ *                and textures of an OBJ) and of the cook options. The assets whose
+ *                hash did not change and whose output is still there are skipped.
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <unordered_map>
+#include "core/mappedfile.h"
+#include "core/serialization/jsoncpputils.h"
+#include "core/graphic/meshoptimizer.h"
+#include "core/graphic/meshsimplifier.h"
+#include "core/graphic/objimporter.h"
+#include "core/graphic/texturecooker.h"
+#include "graphic/asset3d.h"
+#include "texture-cooker.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined(_WIN32)
+    #include <direct.h>
+#else
+    #include <dirent.h>
+#endif
+
+using namespace Framework;
+
+namespace Tool
+{
+    namespace AssetCook
+    {
+        /* Changes of the cook that make the previous outputs stale */
+        static const uint32_t sVersion = 1;
+        static const char*    sManifestName = "cook.manifest";
+
+        enum class Status
+        {
+            eCOOKED,
+            eUNCHANGED,
+            eFAILED,
+        };
+
+        struct Job
+        {
+            std::string mInput;             /**< Path relative to the source directory */
+            uint64_t    mInputBytes = 0;    /**< Source file and dependencies */
+            uint64_t    mHash = 0;
+            uint64_t    mOutputBytes = 0;
+            double      mTime = 0.0;        /**< Milliseconds, the hash included */
+            Status      mStatus = Status::eFAILED;
+            std::string mError;
+        };
+
+        struct ManifestEntry
+        {
+            uint64_t mHash = 0;
+            uint64_t mOutputBytes = 0;
+        };
+
+        inline uint64_t Fnv1a(const void* aData, size_t aSize, uint64_t aHash = 14695981039346656037ull)
+        {
+            const uint8_t* lBytes = static_cast<const uint8_t*>(aData);
+            for ( size_t i = 0; i < aSize; ++i )
+            {
+                aHash ^= lBytes[i];
+                aHash *= 1099511628211ull;
+            }
+            return aHash;
+        }
+
+        inline int64_t GetFileSize(const std::string& aFileName)
+        {
+            struct stat lStat;
+            return stat(aFileName.c_str(), &lStat) == 0 ? static_cast<int64_t>(lStat.st_size) : -1;
+        }
+
+        /* Joined with the separator of the platform, the loaders split the paths with it */
+        inline std::string Join(const std::string& aDirectory, const std::string& aName)
+        {
+            return aDirectory + Utils::GetPathSeparator() + aName;
+        }
+
+        inline void MakeDirectories(const std::string& aPath)
+        {
+            for ( size_t lSlash = aPath.find_first_of("/\\", 1); ; lSlash = aPath.find_first_of("/\\", lSlash + 1) )
+            {
+                const std::string lDirectory = aPath.substr(0, lSlash);
+#if defined(_WIN32)
+                _mkdir(lDirectory.c_str());
+#else
+                mkdir(lDirectory.c_str(), 0755);
+#endif
+                if ( lSlash == std::string::npos )
+                    break;
+            }
+        }
+
+        /* The OBJ and model files of a directory tree, relative to aDirectory */
+        inline void ListInputs(const std::string& aDirectory, const std::string& aRelative, std::vector<std::string>& aInputs)
+        {
+            const std::string lPath = Join(aDirectory, aRelative);
+#if defined(_WIN32)
+            WIN32_FIND_DATAA lData;
+            HANDLE lFind = FindFirstFileA((lPath + "*").c_str(), &lData);
+            if ( lFind == INVALID_HANDLE_VALUE )
+                return;
+            do
+            {
+                const std::string lName = lData.cFileName;
+                const bool lIsDirectory = (lData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+            DIR* lDirectory = opendir(lPath.c_str());
+            if ( !lDirectory )
+                return;
+            while ( struct dirent* lEntry = readdir(lDirectory) )
+            {
+                const std::string lName = lEntry->d_name;
+                struct stat lStat;
+                const bool lIsDirectory = stat((lPath + lName).c_str(), &lStat) == 0 && S_ISDIR(lStat.st_mode);
+#endif
+                if ( lName.empty() || lName[0] == '.' )
+                    continue;
+                if ( lIsDirectory )
+                    ListInputs(aDirectory, aRelative + lName + Utils::GetPathSeparator(), aInputs);
+                else
+                {
+                    const std::string lExtension = Utils::GetFileExtension(lName);
+                    if ( lExtension == "obj" || lExtension == "model" )
+                        aInputs.push_back(aRelative + lName);
+                }
+#if defined(_WIN32)
+            } while ( FindNextFileA(lFind, &lData) != 0 );
+            FindClose(lFind);
+#else
+            }
+            closedir(lDirectory);
+#endif
+        }
+
+        /* Lines of a text file that start with the keyword, with the rest trimmed */
+        inline std::vector<std::string> FindLines(const uint8_t* aData, size_t aSize, const char* aKeyword)
+        {
+            std::vector<std::string> lValues;
+            const size_t lLength = strlen(aKeyword);
+            const char* p = reinterpret_cast<const char*>(aData);
+            const char* lEnd = p + aSize;
+            while ( p < lEnd )
+            {
+                const char* lLineEnd = static_cast<const char*>(memchr(p, '\n', lEnd - p));
+                if ( !lLineEnd )
+                    lLineEnd = lEnd;
+                if ( size_t(lLineEnd - p) > lLength && strncmp(p, aKeyword, lLength) == 0 && (p[lLength] == ' ' || p[lLength] == '\t') )
+                {
+                    const char* lBegin = p + lLength;
+                    const char* lValueEnd = lLineEnd;
+                    while ( lBegin < lValueEnd && isspace(static_cast<unsigned char>(*lBegin)) )
+                        ++lBegin;
+                    while ( lValueEnd > lBegin && isspace(static_cast<unsigned char>(lValueEnd[-1])) )
+                        --lValueEnd;
+                    if ( lValueEnd > lBegin )
+                        lValues.emplace_back(lBegin, lValueEnd);
+                }
+                p = lLineEnd + 1;
+            }
+            return lValues;
+        }
+
+        /**
+         * Hashes the source file and the files it pulls in: the material libraries
+         * of an OBJ and their diffuse textures, found as the importer finds them
+         *
+         * @return false if one of the files is missing, the importer would fail
+         */
+        inline bool HashInputs(const std::string& aFileName, uint64_t aSeed, Job& aJob)
+        {
+            MappedFile lFile;
+            if ( !lFile.Open(aFileName) )
+            {
+                aJob.mError = "cannot read " + aFileName;
+                return false;
+            }
+            aJob.mHash = Fnv1a(lFile.GetData(), lFile.GetSize(), aSeed);
+            aJob.mInputBytes = lFile.GetSize();
+            if ( Utils::GetFileExtension(aFileName) != "obj" )
+                return true;
+
+            const std::string lBasePath = Utils::GetFilePath(aFileName);
+            for ( const auto& lLibrary : FindLines(lFile.GetData(), lFile.GetSize(), "mtllib") )
+            {
+                const std::string lLibraryFile = lBasePath + Utils::GetPathSeparator() + lLibrary;
+                MappedFile lMaterials;
+                if ( !lMaterials.Open(lLibraryFile) )
+                {
+                    aJob.mError = "cannot read " + lLibraryFile;
+                    return false;
+                }
+                aJob.mHash = Fnv1a(lLibrary.data(), lLibrary.size(), aJob.mHash);
+                aJob.mHash = Fnv1a(lMaterials.GetData(), lMaterials.GetSize(), aJob.mHash);
+                aJob.mInputBytes += lMaterials.GetSize();
+
+                for ( const auto& lTexture : FindLines(lMaterials.GetData(), lMaterials.GetSize(), "map_Kd") )
+                {
+                    if ( lTexture == "null" )
+                        continue;
+                    const std::string lTextureFile = Utils::GetFilePath(lTexture).empty() ? lBasePath + Utils::GetPathSeparator() + lTexture : lTexture;
+                    MappedFile lImage;
+                    if ( !lImage.Open(lTextureFile) )
+                    {
+                        aJob.mError = "cannot read " + lTextureFile;
+                        return false;
+                    }
+                    aJob.mHash = Fnv1a(lTexture.data(), lTexture.size(), aJob.mHash);
+                    aJob.mHash = Fnv1a(lImage.GetData(), lImage.GetSize(), aJob.mHash);
+                    aJob.mInputBytes += lImage.GetSize();
+                }
+            }
+            return true;
+        }
+
+        inline std::string GetOutput(const std::string& aInput)
+        {
+            return aInput.substr(0, aInput.find_last_of('.')) + ".model";
+        }
+
+        /* Import or load, optimize, simplify, cook the textures and save */
+        inline bool Cook(const std::string& aInput, const std::string& aOutput, const TextureCooker::Options& aOptions, std::string& aError)
+        {
+            Asset3D lAsset(aInput, "");
+            const bool lLoaded = Utils::GetFileExtension(aInput) == "obj" ? ObjImporter::Load(lAsset, aInput, 1) : lAsset.Load(aInput);
+            if ( !lLoaded )
+            {
+                aError = "cannot load the asset";
+                return false;
+            }
+            MeshOptimizer::Optimize(lAsset);
+            MeshSimplifier::GenerateLods(lAsset);
+            TextureCooker::CookTextures(lAsset, aOptions);
+
+            MakeDirectories(Utils::GetFilePath(aOutput));
+            if ( !lAsset.Save(aOutput) )
+            {
+                aError = "cannot write " + aOutput;
+                return false;
+            }
+            return true;
+        }
+
+        inline std::unordered_map<std::string, ManifestEntry> ReadManifest(const std::string& aFileName)
+        {
+            std::unordered_map<std::string, ManifestEntry> lEntries;
+            Json::Value lManifest;
+            if ( GetFileSize(aFileName) < 0 || !Json::JsonUtils::OpenAndParseJsonFromFile(lManifest, aFileName) )
+                return lEntries;
+            if ( lManifest.get("version", 0).asUInt() != sVersion )
+                return lEntries;
+            const Json::Value& lAssets = lManifest["assets"];
+            for ( const auto& lName : lAssets.getMemberNames() )
+            {
+                ManifestEntry lEntry;
+                lEntry.mHash = strtoull(lAssets[lName]["hash"].asCString(), nullptr, 16);
+                lEntry.mOutputBytes = lAssets[lName]["bytes"].asUInt64();
+                lEntries.emplace(lName, lEntry);
+            }
+            return lEntries;
+        }
+
+        inline bool WriteManifest(const std::string& aFileName, const std::vector<Job>& aJobs)
+        {
+            Json::Value lManifest;
+            lManifest["version"] = sVersion;
+            Json::Value& lAssets = lManifest["assets"];
+            lAssets = Json::Value(Json::ValueType::objectValue);
+            for ( const auto& lJob : aJobs )
+            {
+                // The failed assets are left out, so they are cooked again
+                if ( lJob.mStatus == Status::eFAILED )
+                    continue;
+                char lHash[32];
+                snprintf(lHash, sizeof lHash, "%016llx", (unsigned long long)lJob.mHash);
+                lAssets[lJob.mInput]["hash"] = lHash;
+                lAssets[lJob.mInput]["bytes"] = Json::UInt64(lJob.mOutputBytes);
+            }
+            Json::StyledWriter lWriter;
+            std::ofstream lFile(aFileName, std::ios_base::out | std::ios_base::trunc);
+            lFile << lWriter.write(lManifest);
+            return lFile.good();
+        }
+
+        inline double Milliseconds(const std::chrono::high_resolution_clock::time_point& aStart)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - aStart).count();
+        }
+    }
+
+    int CookAssets(int argc, char **argv)
+    {
+        if (argc < 4)
+        {
+            INFO(LogLevel::eLEVEL2, "Insomnium Engine Tools\n\n");
+            INFO(LogLevel::eLEVEL2, "Usage: [OPTION] ... PARAMERTERS\n");
+            INFO(LogLevel::eLEVEL2, "\n");
+
+            INFO(LogLevel::eLEVEL2, "Options:\n");
+            INFO(LogLevel::eLEVEL2, "  -c, --cook <source_dir> <target_dir> [<workers>] [<compression>] Cooks the changed assets of a directory tree\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <source_dir>: directory with the .obj (and their .mtl and textures) and .model files\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <target_dir>: directory of the cooked .model files and of the cook manifest\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <workers>: cooking threads, 0 uses one per core (default)\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <compression>: 'none' (default), 'bc1', 'bc3' or 'bc7'\n\n");
+            exit(1);
+        }
+
+        const std::string lSourceDir = argv[2];
+        const std::string lTargetDir = argv[3];
+        const uint32_t lCores = std::max(1u, std::thread::hardware_concurrency());
+        const uint32_t lWorkers = argc > 4 && atoi(argv[4]) > 0 ? static_cast<uint32_t>(atoi(argv[4])) : lCores;
+        TextureCooker::Options lOptions;
+        if (argc > 5 && !TextureCook::ParseCompression(argv[5], lOptions.mCompression))
+        {
+            CRASH("ERROR unknown texture compression %s\n", argv[5]);
+            exit(2);
+        }
+
+        std::vector<std::string> lInputs;
+        AssetCook::ListInputs(lSourceDir, "", lInputs);
+        if (lInputs.empty())
+        {
+            CRASH("ERROR no .obj or .model files found in %s\n", lSourceDir.c_str());
+            exit(3);
+        }
+        std::sort(lInputs.begin(), lInputs.end());
+
+        const std::string lManifestFile = AssetCook::Join(lTargetDir, AssetCook::sManifestName);
+        const auto lManifest = AssetCook::ReadManifest(lManifestFile);
+        const uint32_t lKey[] = { AssetCook::sVersion, static_cast<uint32_t>(lOptions.mCompression), lOptions.mMipmaps ? 1u : 0u };
+        const uint64_t lSeed = AssetCook::Fnv1a(lKey, sizeof lKey);
+
+        /* The biggest files first, so a large asset does not start last and keep a
+           single worker busy at the end */
+        std::vector<AssetCook::Job> lJobs(lInputs.size());
+        std::vector<std::pair<int64_t, size_t>> lOrder;
+        for (size_t i = 0; i < lInputs.size(); ++i)
+        {
+            lJobs[i].mInput = lInputs[i];
+            lOrder.emplace_back(AssetCook::GetFileSize(AssetCook::Join(lSourceDir, lInputs[i])), i);
+        }
+        std::sort(lOrder.begin(), lOrder.end(), [](const std::pair<int64_t, size_t>& aLeft, const std::pair<int64_t, size_t>& aRight) { return aLeft.first > aRight.first; });
+
+        std::atomic<size_t> lNext(0);
+        auto lWorker = [&]()
+        {
+            for (size_t lSlot = lNext++; lSlot < lOrder.size(); lSlot = lNext++)
+            {
+                AssetCook::Job& lJob = lJobs[lOrder[lSlot].second];
+                const auto lStart = std::chrono::high_resolution_clock::now();
+                const std::string lInput = AssetCook::Join(lSourceDir, lJob.mInput);
+                const std::string lOutput = AssetCook::Join(lTargetDir, AssetCook::GetOutput(lJob.mInput));
+                if (AssetCook::HashInputs(lInput, lSeed, lJob))
+                {
+                    auto lEntry = lManifest.find(lJob.mInput);
+                    const int64_t lOutputBytes = AssetCook::GetFileSize(lOutput);
+                    if (lEntry != lManifest.end() && lEntry->second.mHash == lJob.mHash && lOutputBytes >= 0 &&
+                        uint64_t(lOutputBytes) == lEntry->second.mOutputBytes)
+                    {
+                        lJob.mStatus = AssetCook::Status::eUNCHANGED;
+                        lJob.mOutputBytes = lOutputBytes;
+                    }
+                    else if (AssetCook::Cook(lInput, lOutput, lOptions, lJob.mError))
+                    {
+                        lJob.mStatus = AssetCook::Status::eCOOKED;
+                        lJob.mOutputBytes = std::max<int64_t>(AssetCook::GetFileSize(lOutput), 0);
+                    }
+                }
+                lJob.mTime = AssetCook::Milliseconds(lStart);
+            }
+        };
+
+        const auto lStart = std::chrono::high_resolution_clock::now();
+        std::vector<std::thread> lThreads;
+        for (uint32_t i = 1; i < std::min<size_t>(lWorkers, lJobs.size()); ++i)
+            lThreads.emplace_back(lWorker);
+        lWorker(); // the main thread is one of the workers
+        for (auto& lThread : lThreads)
+            lThread.join();
+        const double lWallTime = AssetCook::Milliseconds(lStart);
+
+        uint32_t lCounts[3] = { 0, 0, 0 };
+        uint64_t lInputBytes = 0, lOutputBytes = 0, lCookedInput = 0, lCookedOutput = 0;
+        double lCookTime = 0.0;
+        static const char* sStatus[] = { "cooked", "same", "FAILED" };
+        printf("%-48s %-8s %10s %14s %14s\n", "asset", "status", "ms", "input bytes", "output bytes");
+        for (const auto& lJob : lJobs)
+        {
+            printf("%-48s %-8s %10.1f %14llu %14llu", lJob.mInput.c_str(), sStatus[static_cast<int>(lJob.mStatus)], lJob.mTime,
+                   (unsigned long long)lJob.mInputBytes, (unsigned long long)lJob.mOutputBytes);
+            printf(lJob.mStatus == AssetCook::Status::eFAILED ? "  %s\n" : "\n", lJob.mError.c_str());
+            ++lCounts[static_cast<int>(lJob.mStatus)];
+            lInputBytes += lJob.mInputBytes;
+            lOutputBytes += lJob.mOutputBytes;
+            lCookTime += lJob.mTime;
+            if (lJob.mStatus == AssetCook::Status::eCOOKED)
+            {
+                lCookedInput += lJob.mInputBytes;
+                lCookedOutput += lJob.mOutputBytes;
+            }
+        }
+        printf("%u assets: %u cooked, %u unchanged, %u failed, %u workers on %u hardware threads\n", static_cast<uint32_t>(lJobs.size()),
+               lCounts[0], lCounts[1], lCounts[2], static_cast<uint32_t>(std::min<size_t>(lWorkers, lJobs.size())), lCores);
+        printf("%.1f ms, %.1f ms summed over the workers, %llu bytes read, %llu bytes of the cooked assets written (%llu bytes of output in all)\n",
+               lWallTime, lCookTime, (unsigned long long)lInputBytes, (unsigned long long)lCookedOutput, (unsigned long long)lOutputBytes);
+
+        AssetCook::MakeDirectories(lTargetDir);
+        if (!AssetCook::WriteManifest(lManifestFile, lJobs))
+        {
+            CRASH("ERROR storing the cook manifest %s\n", lManifestFile.c_str());
+            exit(4);
+        }
+        return lCounts[2] > 0 ? 5 : 0;
+    }
+}
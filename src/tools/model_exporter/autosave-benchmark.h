@@ -0,0 +1,325 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Main thread stall of the autosave. A generated project is saved
+ *                whole, as the autosave did, then autosaved through the journal
+ *                while a few entities are moved, removed and added between two
+ *                autosaves. The entities are serialized by the generator of the
+ *                project benchmark, which builds the values Entity::Serialize does.
+ *
+ *                The compacted autosave file must hold the last state of the
+ *                project, and a journal cut in its last autosave the state before it.
+ *******************************************************************************/
+
+#pragma once
+
+#include "precompiled.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
+#include "engine/autosave.h"
+#include "engine/projectfile.h"
+#include "project-benchmark.h"
+
+using namespace Framework;
+
+namespace Tool
+{
+    namespace AutosaveModel
+    {
+        /* An entity of the generated project and the times it was moved */
+        struct Item
+        {
+            uint32_t mIndex = 0;
+            uint32_t mMoves = 0;
+        };
+
+        /* Entities of every scene by key */
+        typedef std::vector<std::map<uint64_t, Item>> State;
+
+        void Serialize(Json::Value& aEntity, const Item& aItem)
+        {
+            ProjectGenerator::Entity(aEntity, aItem.mIndex);
+            if (aItem.mMoves)
+            {
+                Json::Value& lPosition = aEntity["components"][1]["position"];
+                lPosition[0] = lPosition[0].asFloat() + 10.0f * aItem.mMoves;
+            }
+        }
+
+        /**
+         * @return true if the binary project holds the entities of the state, in any order
+         */
+        bool Matches(const std::string& aFileName, const State& aState)
+        {
+            ProjectFile::Reader lReader;
+            if (!lReader.Open(aFileName))
+                return false;
+
+            std::vector<std::map<uint64_t, Json::Value>> lScenes;
+            Json::Value lRecord;
+            ProjectFile::Record lType;
+            while ((lType = lReader.Next(lRecord)) != ProjectFile::Record::eEND)
+            {
+                if (lType == ProjectFile::Record::eERROR)
+                    return false;
+                if (lType == ProjectFile::Record::eSCENE)
+                    lScenes.emplace_back();
+                else if (lType == ProjectFile::Record::eENTITY && !lScenes.back().emplace(lReader.GetEntityKey(), lRecord).second)
+                    return false;
+            }
+            if (lScenes.size() != aState.size())
+                return false;
+
+            for (size_t s = 0; s < aState.size(); ++s)
+            {
+                if (lScenes[s].size() != aState[s].size())
+                    return false;
+                for (const auto& lItem : aState[s])
+                {
+                    Json::Value lExpected;
+                    Serialize(lExpected, lItem.second);
+                    auto lFound = lScenes[s].find(lItem.first);
+                    if (lFound == lScenes[s].end() || !(lFound->second == lExpected))
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        bool CopyFile(const std::string& aFrom, const std::string& aTo, std::streamoff aDropBytes = 0)
+        {
+            std::ifstream lIn(aFrom, std::ios_base::in | std::ios_base::binary);
+            if (!lIn)
+                return false;
+            std::string lData((std::istreambuf_iterator<char>(lIn)), std::istreambuf_iterator<char>());
+            lData.resize(lData.size() - std::min<size_t>(lData.size(), static_cast<size_t>(aDropBytes)));
+            std::ofstream lOut(aTo, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+            lOut.write(lData.data(), lData.size());
+            return !!lOut;
+        }
+    }
+
+    int AutosaveBenchmark(int argc, char **argv)
+    {
+        if (argc < 3)
+        {
+            INFO(LogLevel::eLEVEL2, "Insomnium Engine Tools\n\n");
+            INFO(LogLevel::eLEVEL2, "Usage: [OPTION] ... PARAMERTERS\n");
+            INFO(LogLevel::eLEVEL2, "\n");
+
+            INFO(LogLevel::eLEVEL2, "Options:\n");
+            INFO(LogLevel::eLEVEL2, "  -as, --autosave-benchmark <work_dir> [<entities>] [<changes>] [<autosaves>] Main thread stall of the full and the incremental autosave\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <work_dir>: directory for the autosave files\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <entities>: entities of the project, 10000 by default\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <changes>: entities moved between two autosaves, 50 by default\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <autosaves>: incremental autosaves, 20 by default\n\n");
+            exit(1);
+        }
+
+        const std::string lWorkDir = argv[2];
+        const uint32_t lEntities = argc > 3 ? std::max(1, atoi(argv[3])) : 10000;
+        const uint32_t lChanges = argc > 4 ? std::max(1, atoi(argv[4])) : 50;
+        const uint32_t lAutosaves = argc > 5 ? std::max(1, atoi(argv[5])) : 20;
+        const uint32_t lScenes = 4;
+        const std::string lJsonFile = lWorkDir + Utils::GetPathSeparator() + "autosave.sh3d";
+        const std::string lBinaryFile = lWorkDir + Utils::GetPathSeparator() + "autosave.sh3b";
+        const std::string lAutosaveFile = lWorkDir + Utils::GetPathSeparator() + "autosave.project";
+        const std::string lRecoveryFile = lWorkDir + Utils::GetPathSeparator() + "recovery.project";
+
+        auto lNow = []() { return std::chrono::high_resolution_clock::now(); };
+        auto lMs = [](std::chrono::high_resolution_clock::time_point aStart)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - aStart).count();
+        };
+
+        std::vector<Json::Value> lHeaders(lScenes);
+        std::vector<std::string> lSceneNames;
+        AutosaveModel::State lState(lScenes);
+        std::vector<std::pair<uint32_t, uint64_t>> lKeys;   // scene and key of the entities
+        for (uint32_t s = 0; s < lScenes; ++s)
+        {
+            ProjectGenerator::Scene(lHeaders[s], s);
+            lSceneNames.push_back(lHeaders[s]["sceneName"].asString());
+        }
+        for (uint32_t i = 0; i < lEntities; ++i)
+        {
+            lState[i % lScenes][i].mIndex = i;
+            lKeys.emplace_back(i % lScenes, i);
+        }
+        Json::Value lProject;
+        lProject["projectName"] = "benchmark";
+        lProject["sample"] = false;
+
+        /* The whole project on the main thread, as Project::Save writes it */
+        auto lStart = lNow();
+        uint64_t lJsonBytes = 0;
+        {
+            Json::Value lSerializer(lProject);
+            Json::Value& lScenesValue = lSerializer["scenes"];
+            for (uint32_t s = 0; s < lScenes; ++s)
+            {
+                Json::Value& lScene = lScenesValue.append(lHeaders[s]);
+                Json::Value& lSceneEntities = lScene["entities"];
+                lSceneEntities = Json::Value(Json::arrayValue);
+                for (const auto& lItem : lState[s])
+                    AutosaveModel::Serialize(lSceneEntities.append(Json::Value()), lItem.second);
+            }
+            Json::StyledWriter lWriter;
+            const std::string lOutput = lWriter.write(lSerializer);
+            std::fstream lFileOut(lJsonFile, std::ios_base::out);
+            lFileOut << lOutput;
+            lJsonBytes = lOutput.size();
+        }
+        const double lJsonTime = lMs(lStart);
+
+        lStart = lNow();
+        uint64_t lBinaryBytes = 0;
+        {
+            ProjectFile::Writer lWriter;
+            if (!lWriter.Open(lBinaryFile))
+                exit(2);
+            lWriter.WriteProject(lProject);
+            for (uint32_t s = 0; s < lScenes; ++s)
+            {
+                lWriter.BeginScene(lHeaders[s]);
+                for (const auto& lItem : lState[s])
+                {
+                    Json::Value lEntity;
+                    AutosaveModel::Serialize(lEntity, lItem.second);
+                    lWriter.WriteEntity(lEntity, lItem.first);
+                }
+                lWriter.EndScene();
+            }
+            if (!lWriter.Close())
+                exit(2);
+            lBinaryBytes = lWriter.GetWrittenBytes();
+        }
+        const double lBinaryTime = lMs(lStart);
+
+        /* The autosaves: the first one writes the base, the next ones the changes */
+        std::remove(lAutosaveFile.c_str());
+        std::remove(AutosaveJournal::GetJournalName(lAutosaveFile).c_str());
+        std::mt19937 lRandom(1234);
+        uint64_t lNextKey = lEntities;
+        uint32_t lNextIndex = lEntities;
+        double lBaseStall = 0.0, lStallSum = 0.0, lStallMax = 0.0;
+        AutosaveModel::State lPrevious;
+        AutosaveJournal::Stats lStats;
+        double lDrainTime = 0.0;
+        uint64_t lBaseBytes = 0;
+        {
+            AutosaveJournal lJournal;
+            lJournal.SetFileName(lAutosaveFile);
+            for (uint32_t a = 0; a <= lAutosaves; ++a)
+            {
+                std::set<uint64_t> lDirty;
+                std::vector<uint64_t> lRemoved;
+                if (a > 0)
+                {
+                    lPrevious = lState;
+                    for (uint32_t c = 0; c < lChanges; ++c)
+                    {
+                        const auto& lKey = lKeys[lRandom() % lKeys.size()];
+                        ++lState[lKey.first][lKey.second].mMoves;
+                        lDirty.insert(lKey.second);
+                    }
+
+                    // One entity deleted and one added per autosave
+                    const size_t lVictim = lRandom() % lKeys.size();
+                    lState[lKeys[lVictim].first].erase(lKeys[lVictim].second);
+                    lDirty.erase(lKeys[lVictim].second);
+                    lRemoved.push_back(lKeys[lVictim].second);
+                    lKeys[lVictim] = lKeys.back();
+                    lKeys.pop_back();
+
+                    const uint32_t lScene = lRandom() % lScenes;
+                    lState[lScene][lNextKey].mIndex = lNextIndex++;
+                    lKeys.emplace_back(lScene, lNextKey);
+                    lDirty.insert(lNextKey++);
+                }
+
+                // What Project::Autosave does on the main thread
+                lStart = lNow();
+                AutosaveJournal::Snapshot lSnapshot;
+                lSnapshot.mFull = lJournal.NeedsBase(lSceneNames);
+                lSnapshot.mProject = lProject;
+                lSnapshot.mRemoved = lRemoved;
+                for (uint32_t s = 0; s < lScenes; ++s)
+                {
+                    AutosaveJournal::Snapshot::SceneChanges lSceneChanges;
+                    for (const auto& lItem : lState[s])
+                    {
+                        if (!lSnapshot.mFull && !lDirty.count(lItem.first))
+                            continue;
+                        lSceneChanges.mEntities.emplace_back(lItem.first, Json::Value());
+                        AutosaveModel::Serialize(lSceneChanges.mEntities.back().second, lItem.second);
+                    }
+                    if (lSnapshot.mFull || !lSceneChanges.mEntities.empty())
+                    {
+                        lSceneChanges.mHeader = lHeaders[s];
+                        lSnapshot.mScenes.push_back(std::move(lSceneChanges));
+                    }
+                }
+                lSnapshot.mTime = lMs(lStart);
+                lJournal.Write(std::move(lSnapshot), lSceneNames);
+
+                const double lStall = lJournal.GetStats().mLastStall;
+                if (a == 0)
+                {
+                    // The base is written before the incremental autosaves are measured
+                    lBaseStall = lStall;
+                    lJournal.Flush();
+                    lBaseBytes = lJournal.GetStats().mBaseBytes;
+                }
+                else
+                {
+                    lStallSum += lStall;
+                    lStallMax = std::max(lStallMax, lStall);
+                }
+            }
+
+            lStart = lNow();
+            lJournal.Flush();
+            lDrainTime = lMs(lStart);
+            lStats = lJournal.GetStats();
+
+            // A crash while the last autosave was written: its end record is missing
+            const std::string lJournalFile = AutosaveJournal::GetJournalName(lAutosaveFile);
+            std::remove(AutosaveJournal::GetJournalName(lRecoveryFile).c_str());
+            if (lStats.mJournalBytes > 0)
+            {
+                AutosaveModel::CopyFile(lAutosaveFile, lRecoveryFile);
+                AutosaveModel::CopyFile(lJournalFile, AutosaveJournal::GetJournalName(lRecoveryFile), 3);
+            }
+        }
+        // The journal compacts the autosave file when it is destroyed
+
+        const double lIncrementalBytes = double(lStats.mTotalBytes - lBaseBytes) / lAutosaves;
+        printf("%u entities in %u scenes, %u moved, 1 removed and 1 added between two autosaves, %u autosaves\n\n",
+               lEntities, lScenes, lChanges, lAutosaves);
+        printf("%-30s %12s %12s %12s\n", "", "stall ms", "max ms", "written KB");
+        printf("%-30s %12.2f %12s %12.1f\n", "full save, json", lJsonTime, "", lJsonBytes / 1024.0);
+        printf("%-30s %12.2f %12s %12.1f\n", "full save, binary", lBinaryTime, "", lBinaryBytes / 1024.0);
+        printf("%-30s %12.2f %12s %12.1f\n", "autosave, base", lBaseStall, "", lBaseBytes / 1024.0);
+        printf("%-30s %12.3f %12.3f %12.2f\n", "autosave, incremental", lStallSum / lAutosaves, lStallMax, lIncrementalBytes / 1024.0);
+        printf("\nworker: %.2f ms left to write after the last autosave, %u compactions, journal %.1f KB\n",
+               lDrainTime, lStats.mCompactions, lStats.mJournalBytes / 1024.0);
+
+        const bool lIsOk = AutosaveModel::Matches(lAutosaveFile, lState);
+        printf("compacted autosave file: %s\n", lIsOk ? "identical" : "DIFFERENT");
+        bool lIsRecovered = true;
+        if (lStats.mJournalBytes > 0)
+        {
+            lIsRecovered = AutosaveJournal::Compact(lRecoveryFile) && AutosaveModel::Matches(lRecoveryFile, lPrevious);
+            printf("cut journal, recovered to the previous autosave: %s\n", lIsRecovered ? "identical" : "DIFFERENT");
+        }
+        return lIsOk && lIsRecovered ? 0 : 3;
+    }
+}
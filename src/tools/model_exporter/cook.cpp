@@ -0,0 +1,23 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : The asset cook alone, without the engine the other tools link.
+ *                Takes the arguments of the -c option of the tools.
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "asset-cook.h"
+
+using namespace Framework;
+using namespace Tool;
+
+int main(int argc, char **argv)
+{
+    // The option the tools dispatch on, before the cook arguments
+    std::vector<char*> lArguments(argv, argv + argc);
+    lArguments.insert(lArguments.begin() + 1, const_cast<char*>("--cook"));
+    return CookAssets(static_cast<int>(lArguments.size()), lArguments.data());
+}
@@ -0,0 +1,346 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Create, lookup and destroy costs of the entity containers, the
+ *                list EntityManager had with its linear scans against the sparse
+ *                set, the name index and the free id list it has now. An entity
+ *                destructor needs the engine, so the entities are records of an
+ *                id and a name, kept by the containers as EntityManager keeps
+ *                them. The list is only run up to a size, it is quadratic.
+ *
+ *                The index must behave as the list: a lookup by name finds the
+ *                first entity added with the name, after destroys and renames, and
+ *                the id of a destroyed entity is not given to the next one.
+ *******************************************************************************/
+
+#pragma once
+
+#include "precompiled.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <list>
+#include <random>
+#include "engine/sparseset.h"
+#include "engine/entitynameindex.h"
+
+using namespace Framework;
+
+namespace Tool
+{
+    namespace Entities
+    {
+        const char* const sModels[] = { "bed1", "chair3", "rack2", "sofa1", "table4", "lamp2", "shelf1", "desk3" };
+
+        struct Record
+        {
+            size_t      mEntityID;
+            std::string mName;
+        };
+
+        /* The containers of EntityManager before the index: a list searched from its front */
+        class ListEntities
+        {
+        public:
+            void Add(const std::shared_ptr<Record>& aEntity)
+            {
+                for (const auto& lEntity : mEntities)
+                    if (lEntity == aEntity)
+                        return;
+                mEntities.push_back(aEntity);
+            }
+
+            void Destroy(size_t aEntityID)
+            {
+                for (const auto& lEntity : mEntities)
+                    if (lEntity->mEntityID == aEntityID)
+                        mDestroyed.push_back(lEntity);
+            }
+
+            void Update()
+            {
+                for (const auto& lDestroyed : mDestroyed)
+                {
+                    for (auto i = mEntities.begin(); i != mEntities.end(); ++i)
+                    {
+                        if (*i == lDestroyed)
+                        {
+                            mEntities.erase(i);
+                            break;
+                        }
+                    }
+                }
+                mDestroyed.clear();
+            }
+
+            std::shared_ptr<Record> GetByID(size_t aEntityID) const
+            {
+                for (const auto& lEntity : mEntities)
+                    if (lEntity->mEntityID == aEntityID)
+                        return lEntity;
+                return std::shared_ptr<Record>();
+            }
+
+            std::shared_ptr<Record> GetByName(const std::string& aName) const
+            {
+                for (const auto& lEntity : mEntities)
+                    if (lEntity->mName == aName)
+                        return lEntity;
+                return std::shared_ptr<Record>();
+            }
+
+            size_t CountBySubString(const std::string& aName) const
+            {
+                size_t lCount = 0;
+                for (const auto& lEntity : mEntities)
+                    lCount += lEntity->mName.find(aName) != std::string::npos ? 1 : 0;
+                return lCount;
+            }
+
+            size_t Size() const { return mEntities.size(); }
+
+        private:
+            std::list<std::shared_ptr<Record>>      mEntities;
+            std::vector<std::shared_ptr<Record>>    mDestroyed;
+        };
+
+        /* The containers of EntityManager now, the ids from a free list as Entity takes them */
+        class IndexedEntities
+        {
+        public:
+            static const size_t sMinFreeIDs = 1024;
+
+            size_t AcquireID()
+            {
+                if (mFreeIDs.size() < sMinFreeIDs)
+                    return ++mLastID;
+                const size_t lEntityID = mFreeIDs.front();
+                mFreeIDs.pop_front();
+                return lEntityID;
+            }
+
+            void Add(const std::shared_ptr<Record>& aEntity)
+            {
+                if (mEntities.Contains(aEntity->mEntityID))
+                    return;
+                mEntities.Insert(aEntity->mEntityID, aEntity);
+                mNames.Add(aEntity->mEntityID, aEntity->mName);
+            }
+
+            void Destroy(size_t aEntityID)
+            {
+                if (mEntities.Contains(aEntityID))
+                    mDestroyed.push_back(aEntityID);
+            }
+
+            void Update()
+            {
+                for (size_t lEntityID : mDestroyed)
+                {
+                    if (!mEntities.Contains(lEntityID))
+                        continue;
+                    mNames.Remove(lEntityID);
+                    mEntities.Remove(lEntityID);
+                    mFreeIDs.push_back(lEntityID);
+                }
+                mDestroyed.clear();
+            }
+
+            std::shared_ptr<Record> GetByID(size_t aEntityID) const
+            {
+                const std::shared_ptr<Record>* lEntity = mEntities.Find(aEntityID);
+                return lEntity ? *lEntity : std::shared_ptr<Record>();
+            }
+
+            std::shared_ptr<Record> GetByName(const std::string& aName) const
+            {
+                size_t lEntityID = 0;
+                return mNames.Find(aName, lEntityID) ? GetByID(lEntityID) : std::shared_ptr<Record>();
+            }
+
+            void Rename(const std::shared_ptr<Record>& aEntity, const std::string& aName)
+            {
+                aEntity->mName = aName;
+                mNames.Rename(aEntity->mEntityID, aName);
+            }
+
+            size_t CountBySubString(const std::string& aName) const
+            {
+                size_t lCount = 0;
+                mNames.VisitSubString(aName, [&lCount](size_t) { ++lCount; });
+                return lCount;
+            }
+
+            size_t Size() const { return mEntities.Size(); }
+
+        private:
+            SparseSet<std::shared_ptr<Record>>  mEntities;
+            EntityNameIndex                     mNames;
+            std::vector<size_t>                 mDestroyed;
+            std::deque<size_t>                  mFreeIDs;
+            size_t                              mLastID = 0;
+        };
+
+        struct Times
+        {
+            double  mCreate = 0.0;      // ms for all the entities
+            double  mById = 0.0;        // ns per lookup
+            double  mByName = 0.0;      // ns per lookup
+            double  mBySubString = 0.0; // us per lookup
+            double  mDestroy = 0.0;     // ms for all the entities
+            size_t  mFound = 0;         // entities the lookups found, the same for both containers
+        };
+    }
+
+    int EntityBenchmark(int argc, char **argv)
+    {
+        const size_t lListMax = argc > 2 ? static_cast<size_t>(std::max(0, atoi(argv[2]))) : 10000;
+        const size_t lLookups = 2000;
+        const size_t lSubStringLookups = 50;
+
+        auto lNow = []() { return std::chrono::high_resolution_clock::now(); };
+        auto lMs = [](std::chrono::high_resolution_clock::time_point aStart)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - aStart).count();
+        };
+
+        /* Names as a project gives them, the prefab name and a counter, a tenth of them unnamed */
+        auto lName = [](size_t i)
+        {
+            return i % 10 == 9 ? std::string() : std::string(Entities::sModels[i % 8]) + "_" + std::to_string(i);
+        };
+
+        auto lRun = [&](auto& aEntities, size_t aCount)
+        {
+            Entities::Times lTimes;
+            std::mt19937 lRandom(static_cast<uint32_t>(aCount));
+            std::vector<size_t> lEntityIDs;
+            lEntityIDs.reserve(aCount);
+
+            auto lStart = lNow();
+            for (size_t i = 0; i < aCount; ++i)
+            {
+                std::shared_ptr<Entities::Record> lEntity(new Entities::Record{ aEntities.AcquireID(), lName(i) });
+                lEntityIDs.push_back(lEntity->mEntityID);
+                aEntities.Add(lEntity);
+            }
+            lTimes.mCreate = lMs(lStart);
+
+            lStart = lNow();
+            for (size_t i = 0; i < lLookups; ++i)
+                lTimes.mFound += aEntities.GetByID(lEntityIDs[lRandom() % aCount]) ? 1 : 0;
+            lTimes.mById = lMs(lStart) * 1e6 / lLookups;
+
+            lStart = lNow();
+            for (size_t i = 0; i < lLookups; ++i)
+                lTimes.mFound += aEntities.GetByName(lName(lRandom() % aCount)) ? 1 : 0;
+            lTimes.mByName = lMs(lStart) * 1e6 / lLookups;
+
+            /* A counter suffix matches a few entities, a prefab name a part of them */
+            lStart = lNow();
+            for (size_t i = 0; i < lSubStringLookups; ++i)
+            {
+                const std::string lSubString = i % 2 ? "_" + std::to_string(lRandom() % aCount) : Entities::sModels[lRandom() % 8];
+                lTimes.mFound += aEntities.CountBySubString(lSubString);
+            }
+            lTimes.mBySubString = lMs(lStart) * 1e3 / lSubStringLookups;
+
+            /* A bulk delete: every entity destroyed in a random order, removed at the next update */
+            std::shuffle(lEntityIDs.begin(), lEntityIDs.end(), lRandom);
+            lStart = lNow();
+            for (size_t lEntityID : lEntityIDs)
+                aEntities.Destroy(lEntityID);
+            aEntities.Update();
+            lTimes.mDestroy = lMs(lStart);
+            lTimes.mFound += aEntities.Size();
+            return lTimes;
+        };
+
+        /* The list takes its ids the same way, so both see the same entities */
+        struct ListRun : Entities::ListEntities
+        {
+            size_t AcquireID() { return ++mLastID; }
+            size_t mLastID = 0;
+        };
+
+        printf("%-8s %-6s %12s %12s %14s %14s %12s\n", "entities", "", "create ms", "by id ns", "by name ns", "substring us", "destroy ms");
+        bool lIsSame = true;
+        const size_t lCounts[] = { 1000, 10000, 100000 };
+        for (size_t lCount : lCounts)
+        {
+            Entities::IndexedEntities lIndexed;
+            const Entities::Times lIndex = lRun(lIndexed, lCount);
+            auto lRow = [lCount](const char* aName, const Entities::Times& aTimes)
+            {
+                printf("%-8zu %-6s %12.2f %12.1f %14.1f %14.1f %12.2f\n", lCount, aName, aTimes.mCreate, aTimes.mById, aTimes.mByName, aTimes.mBySubString, aTimes.mDestroy);
+            };
+            if (lCount <= lListMax)
+            {
+                ListRun lList;
+                const Entities::Times lLinear = lRun(lList, lCount);
+                lRow("list", lLinear);
+                lIsSame &= lLinear.mFound == lIndex.mFound;
+            }
+            lRow("index", lIndex);
+        }
+        printf("\nlookups: %s\n", lIsSame ? "same entities found by the list and the index" : "DIFFERENT");
+
+        /* Both containers hold the same records, a few names shared by many entities: after
+           destroys in a random order and renames, a name finds the same record in both */
+        bool lIsOrdered = true;
+        bool lIsIdReused = false;
+        {
+            Entities::IndexedEntities lIndexed;
+            Entities::ListEntities lList;
+            std::mt19937 lRandom(7);
+            std::vector<std::shared_ptr<Entities::Record>> lAlive;
+            for (size_t lRound = 0; lRound < 8; ++lRound)
+            {
+                for (size_t i = 0; i < 500; ++i)
+                {
+                    std::shared_ptr<Entities::Record> lEntity(new Entities::Record{ lIndexed.AcquireID(), Entities::sModels[lRandom() % 8] });
+                    lIndexed.Add(lEntity);
+                    lList.Add(lEntity);
+                    lAlive.push_back(lEntity);
+                }
+                std::shuffle(lAlive.begin(), lAlive.end(), lRandom);
+                for (size_t i = 0; i < lAlive.size() / 3; ++i)
+                {
+                    lIndexed.Destroy(lAlive.back()->mEntityID);
+                    lList.Destroy(lAlive.back()->mEntityID);
+                    lAlive.pop_back();
+                }
+                lIndexed.Update();
+                lList.Update();
+                for (size_t i = 0; i < 20; ++i)
+                    lIndexed.Rename(lAlive[lRandom() % lAlive.size()], Entities::sModels[lRandom() % 8]);
+
+                for (const char* lModel : Entities::sModels)
+                    lIsOrdered &= lIndexed.GetByName(lModel) == lList.GetByName(lModel);
+
+                /* The first id given after a destroy */
+                const size_t lDestroyedID = lAlive.back()->mEntityID;
+                lIndexed.Destroy(lDestroyedID);
+                lList.Destroy(lDestroyedID);
+                lAlive.pop_back();
+                lIndexed.Update();
+                lList.Update();
+                const size_t lNextID = lIndexed.AcquireID();
+                lIsIdReused |= lNextID == lDestroyedID;
+                std::shared_ptr<Entities::Record> lEntity(new Entities::Record{ lNextID, "" });
+                lIndexed.Add(lEntity);
+                lList.Add(lEntity);
+                lAlive.push_back(lEntity);
+            }
+        }
+        printf("name order: %s\n", lIsOrdered ? "the first entity added with a name is found, as by the list" : "DIFFERENT");
+        if (lIsIdReused)
+            printf("id reuse: a destroyed id is given to the next entity\n");
+        else
+            printf("id reuse: oldest first, once %zu ids are free\n", Entities::IndexedEntities::sMinFreeIDs);
+        return lIsSame && lIsOrdered && !lIsIdReused ? 0 : 3;
+    }
+}
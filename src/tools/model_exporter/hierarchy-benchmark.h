@@ -0,0 +1,218 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Frustum, box and ray queries of the bounding volume hierarchy of
+ *                the scene against the scan of every model the renderer did before
+ *                it. The models are generated boxes of furniture size spread on a
+ *                floor, the more models the larger the floor. The camera, the boxes
+ *                and the rays are the ones of a view, a selection and a pick. Both
+ *                answer with the same models, which is checked on every query.
+ *******************************************************************************/
+
+#pragma once
+
+#include "precompiled.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include "graphic/boundingvolumehierarchy.h"
+#include "graphic/projection.h"
+
+using namespace Framework;
+
+namespace Tool
+{
+    namespace Hierarchy
+    {
+        /* The tests of the hierarchy on the exact box of a model */
+        bool OverlapsFrustum(const BoundingBox& aBox, const glm::vec4* aPlanes, size_t aPlaneCount)
+        {
+            for (size_t i = 0; i < aPlaneCount; ++i)
+            {
+                const glm::vec4& p = aPlanes[i];
+                const glm::vec3 lFar(p.x >= 0.0f ? aBox.GetMax().x : aBox.GetMin().x,
+                                     p.y >= 0.0f ? aBox.GetMax().y : aBox.GetMin().y,
+                                     p.z >= 0.0f ? aBox.GetMax().z : aBox.GetMin().z);
+                if (glm::dot(glm::vec3(p), lFar) + p.w < 0.0f)
+                    return false;
+            }
+            return true;
+        }
+
+        bool OverlapsBox(const BoundingBox& aBox, const BoundingBox& aOther)
+        {
+            return aBox.GetMin().x <= aOther.GetMax().x && aBox.GetMax().x >= aOther.GetMin().x &&
+                   aBox.GetMin().y <= aOther.GetMax().y && aBox.GetMax().y >= aOther.GetMin().y &&
+                   aBox.GetMin().z <= aOther.GetMax().z && aBox.GetMax().z >= aOther.GetMin().z;
+        }
+
+        bool OverlapsRay(const BoundingBox& aBox, const glm::vec3& aOrigin, const glm::vec3& aInvDirection, float aMaxDistance)
+        {
+            const glm::vec3 t1 = (aBox.GetMin() - aOrigin) * aInvDirection;
+            const glm::vec3 t2 = (aBox.GetMax() - aOrigin) * aInvDirection;
+            const glm::vec3 lNear = glm::min(t1, t2);
+            const glm::vec3 lFar = glm::max(t1, t2);
+            const float lEnter = std::max(std::max(lNear.x, lNear.y), std::max(lNear.z, 0.0f));
+            const float lExit = std::min(std::min(lFar.x, lFar.y), std::min(lFar.z, aMaxDistance));
+            return lEnter <= lExit;
+        }
+
+        struct Times
+        {
+            double  mBuild = 0.0;       // ms to insert all the models
+            double  mFrustum = 0.0;     // us per query
+            double  mBox = 0.0;
+            double  mRay = 0.0;
+            size_t  mFrustumFound = 0;  // models found by all the queries of a kind
+            size_t  mBoxFound = 0;
+            size_t  mRayFound = 0;
+        };
+    }
+
+    int HierarchyBenchmark(int argc, char **argv)
+    {
+        const size_t lMaxCount = argc > 2 ? static_cast<size_t>(std::max(1000, atoi(argv[2]))) : 100000;
+        const int lFrustums = 200;
+        const int lBoxes = 1000;
+        const int lRays = 1000;
+        const float lRayLength = 50.0f;
+
+        auto lNow = []() { return std::chrono::high_resolution_clock::now(); };
+        auto lMs = [](std::chrono::high_resolution_clock::time_point aStart)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - aStart).count();
+        };
+
+        printf("%-8s %-10s %10s %12s %12s %12s %10s %10s %10s\n", "models", "", "build ms", "frustum us", "box us", "ray us",
+               "in view", "in box", "on ray");
+        bool lIsSame = true;
+        for (size_t lCount = 1000; lCount <= lMaxCount; lCount *= 10)
+        {
+            /* A model every 4 square metres, of 0.3 to 2 metres a side */
+            std::mt19937 lRandom(static_cast<uint32_t>(lCount));
+            const float lSide = 2.0f * std::sqrt(float(lCount));
+            std::uniform_real_distribution<float> lOnFloor(0.0f, lSide);
+            std::uniform_real_distribution<float> lSize(0.3f, 2.0f);
+            std::uniform_real_distribution<float> lUnit(-1.0f, 1.0f);
+            std::vector<BoundingBox> lModels;
+            lModels.reserve(lCount);
+            for (size_t i = 0; i < lCount; ++i)
+            {
+                const glm::vec3 lMin(lOnFloor(lRandom), 0.0f, lOnFloor(lRandom));
+                lModels.emplace_back(lMin, lMin + glm::vec3(lSize(lRandom), lSize(lRandom), lSize(lRandom)));
+            }
+
+            /* The hierarchy never reads its objects: they are the addresses of a byte per model */
+            std::vector<uint8_t> lKeys(lCount);
+            auto lObject = [&lKeys](size_t i) { return reinterpret_cast<Object3D*>(&lKeys[i]); };
+            auto lModel = [&lKeys](const Object3D* aObject) { return static_cast<size_t>(reinterpret_cast<const uint8_t*>(aObject) - lKeys.data()); };
+
+            Hierarchy::Times lLinear;
+            Hierarchy::Times lTree;
+            BoundingVolumeHierarchy lHierarchy;
+            auto lStart = lNow();
+            for (size_t i = 0; i < lCount; ++i)
+                lHierarchy.Insert(lObject(i), lModels[i]);
+            lTree.mBuild = lMs(lStart);
+
+            /* Both results as sorted model indices */
+            std::vector<Object3D*> lResult;
+            std::vector<size_t> lFound;
+            std::vector<size_t> lExpected;
+            auto lCompare = [&]()
+            {
+                lFound.clear();
+                for (const Object3D* lHit : lResult)
+                    lFound.push_back(lModel(lHit));
+                std::sort(lFound.begin(), lFound.end());
+                lIsSame &= lFound == lExpected;
+            };
+
+            /* A camera at eye height looking along the floor, 60 degrees and 30 metres deep */
+            const glm::mat4 lProjection = glm::perspective(60.0f * DEG_TO_RADf, 16.0f / 9.0f, 0.1f, 30.0f);
+            for (int q = 0; q < lFrustums; ++q)
+            {
+                const glm::vec3 lEye(lOnFloor(lRandom), 1.7f, lOnFloor(lRandom));
+                const glm::vec3 lForward(lUnit(lRandom), -0.2f, lUnit(lRandom));
+                glm::vec4 lPlanes[6];
+                Projection::CalculateProjectionVolume(lProjection * glm::lookAt(lEye, lEye + lForward, glm::vec3(0.0f, 1.0f, 0.0f)), lPlanes);
+
+                lExpected.clear();
+                lStart = lNow();
+                for (size_t i = 0; i < lCount; ++i)
+                    if (Hierarchy::OverlapsFrustum(lModels[i], lPlanes, 6))
+                        lExpected.push_back(i);
+                lLinear.mFrustum += lMs(lStart);
+
+                lResult.clear();
+                lStart = lNow();
+                lHierarchy.QueryFrustum(lPlanes, 6, lResult);
+                lTree.mFrustum += lMs(lStart);
+                lTree.mFrustumFound += lResult.size();
+                lCompare();
+            }
+
+            /* A selection rectangle of 2 to 8 metres, the height of the floor */
+            std::uniform_real_distribution<float> lSelection(2.0f, 8.0f);
+            for (int q = 0; q < lBoxes; ++q)
+            {
+                const glm::vec3 lMin(lOnFloor(lRandom), 0.0f, lOnFloor(lRandom));
+                const BoundingBox lBox(lMin, lMin + glm::vec3(lSelection(lRandom), 3.0f, lSelection(lRandom)));
+
+                lExpected.clear();
+                lStart = lNow();
+                for (size_t i = 0; i < lCount; ++i)
+                    if (Hierarchy::OverlapsBox(lModels[i], lBox))
+                        lExpected.push_back(i);
+                lLinear.mBox += lMs(lStart);
+
+                lResult.clear();
+                lStart = lNow();
+                lHierarchy.QueryBox(lBox, lResult);
+                lTree.mBox += lMs(lStart);
+                lTree.mBoxFound += lResult.size();
+                lCompare();
+            }
+
+            /* A pick from the eye, slightly down to the floor */
+            for (int q = 0; q < lRays; ++q)
+            {
+                const glm::vec3 lOrigin(lOnFloor(lRandom), 1.7f, lOnFloor(lRandom));
+                const glm::vec3 lDirection = glm::normalize(glm::vec3(lUnit(lRandom), -0.1f, lUnit(lRandom)));
+                const glm::vec3 lInvDirection = 1.0f / lDirection;
+
+                lExpected.clear();
+                lStart = lNow();
+                for (size_t i = 0; i < lCount; ++i)
+                    if (Hierarchy::OverlapsRay(lModels[i], lOrigin, lInvDirection, lRayLength))
+                        lExpected.push_back(i);
+                lLinear.mRay += lMs(lStart);
+
+                lResult.clear();
+                lStart = lNow();
+                lHierarchy.QueryRay(lOrigin, lDirection, lRayLength, lResult);
+                lTree.mRay += lMs(lStart);
+                lTree.mRayFound += lResult.size();
+                lCompare();
+            }
+
+            auto lRow = [&](const char* aName, const Hierarchy::Times& aTimes)
+            {
+                char lBuild[16] = "-";
+                if (&aTimes == &lTree)
+                    snprintf(lBuild, sizeof(lBuild), "%.2f", aTimes.mBuild);
+                printf("%-8zu %-10s %10s %12.2f %12.2f %12.2f %10.1f %10.1f %10.1f\n", lCount, aName, lBuild,
+                       aTimes.mFrustum * 1e3 / lFrustums, aTimes.mBox * 1e3 / lBoxes, aTimes.mRay * 1e3 / lRays,
+                       double(lTree.mFrustumFound) / lFrustums, double(lTree.mBoxFound) / lBoxes, double(lTree.mRayFound) / lRays);
+            };
+            lRow("linear", lLinear);
+            lRow("hierarchy", lTree);
+        }
+        printf("\nin view, in box, on ray: models found per query\n");
+        printf("queries: %s\n", lIsSame ? "same models found by the scan and the hierarchy" : "DIFFERENT");
+        return lIsSame ? 0 : 3;
+    }
+}
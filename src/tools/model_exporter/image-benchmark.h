@@ -0,0 +1,92 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Benchmarks the time until all the thumbnails of the catalogs are
+ *                loaded: the decode one image after the other on the main thread, as
+ *                NanoVG did, against the image loader pool of the resource manager
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include <chrono>
+#include "engine/imageloader.h"
+
+using namespace Framework;
+
+namespace Tool
+{
+    int ImageBenchmark(int argc, char **argv)
+    {
+        if (argc < 3)
+        {
+            INFO(LogLevel::eLEVEL2, "Insomnium Engine Tools\n\n");
+            INFO(LogLevel::eLEVEL2, "Usage: [OPTION] ... PARAMERTERS\n");
+            INFO(LogLevel::eLEVEL2, "\n");
+
+            INFO(LogLevel::eLEVEL2, "Options:\n");
+            INFO(LogLevel::eLEVEL2, "  -ib, --image-benchmark <images_dir> [<workers>]  Time until all the thumbnails of a directory are loaded\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <images_dir>: directory with the .png and .jpg files, e.g. data/resources/textures/furnitures/icons\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <workers>: decoding threads, 0 uses one per core (default)\n\n");
+            exit(1);
+        }
+
+        std::vector<std::string> lFiles = Utils::ListFiles(argv[2], "png");
+        const std::vector<std::string> lJpegFiles = Utils::ListFiles(argv[2], "jpg");
+        lFiles.insert(lFiles.end(), lJpegFiles.begin(), lJpegFiles.end());
+        if (lFiles.empty())
+        {
+            CRASH("ERROR no .png or .jpg files found in %s\n", argv[2]);
+            exit(2);
+        }
+        const uint32_t lWorkers = argc > 3 ? static_cast<uint32_t>(atoi(argv[3])) : 0;
+
+        /* The layout the resource manager gives to NanoVG */
+        ImageDecoder::Options lOptions;
+        lOptions.mChannels = 4;
+        lOptions.mFlipVertically = false;
+
+        /* One image after the other on the main thread */
+        uint64_t lSerialBytes = 0;
+        uint32_t lSerialImages = 0;
+        auto lStart = std::chrono::high_resolution_clock::now();
+        for (const auto& lFile : lFiles)
+        {
+            Texture lImage;
+            if (ImageDecoder::Decode(lFile, lImage, lOptions))
+            {
+                lSerialBytes += lImage.mPixels.size();
+                ++lSerialImages;
+            }
+        }
+        const double lSerialTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - lStart).count();
+
+        /* The pool: requests for every image, then the main thread waits for them */
+        ImageLoader lLoader(lWorkers);
+        uint64_t lPoolBytes = 0;
+        uint32_t lPoolImages = 0;
+        lStart = std::chrono::high_resolution_clock::now();
+        for (const auto& lFile : lFiles)
+        {
+            lLoader.Request(lFile, lOptions, [&lPoolBytes, &lPoolImages](const std::string&, Texture& aImage, bool aLoaded)
+            {
+                if (!aLoaded)
+                    return;
+                lPoolBytes += aImage.mPixels.size();
+                ++lPoolImages;
+            });
+        }
+        lLoader.Flush();
+        const double lPoolTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - lStart).count();
+        const ImageLoader::Stats lStats = lLoader.GetStats();
+
+        printf("%u images, %u decoding threads, %u hardware threads\n", static_cast<uint32_t>(lFiles.size()), lLoader.GetWorkerCount(),
+               std::thread::hardware_concurrency());
+        printf("%-10s %8s %14s %14s %16s\n", "", "images", "bytes", "all loaded ms", "max latency ms");
+        printf("%-10s %8u %14llu %14.1f %16s\n", "serial", lSerialImages, (unsigned long long)lSerialBytes, lSerialTime, "");
+        printf("%-10s %8u %14llu %14.1f %16.1f\n", "pool", lPoolImages, (unsigned long long)lPoolBytes, lPoolTime, lStats.mMaxLatency);
+        printf("speedup %.2fx, decode time summed over the workers %.1f ms\n", lPoolTime > 0.0 ? lSerialTime / lPoolTime : 0.0, lStats.mDecodeTime);
+        return 0;
+    }
+}
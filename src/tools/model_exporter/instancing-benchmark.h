@@ -0,0 +1,128 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Geometry pass of a scene of identical models, with and without
+ *                instancing. The models share one asset, as the ones created by
+ *                the resource manager do, and are queued like the renderer queues
+ *                them: an item per rendering list, the texture of the list and the
+ *                view depth. The counters are the ones of the render queue.
+ *
+ *                There is no GPU here: the backend only counts, so the times are
+ *                the cost of the queue, not of the draws.
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include <chrono>
+#include "graphic/asset3d.h"
+#include "graphic/model3d.h"
+#include "graphic/renderqueue.h"
+
+using namespace Framework;
+
+namespace Tool
+{
+    namespace Instancing
+    {
+        class CountingBackend : public RenderQueueBackend
+        {
+        public:
+            void BindShader(const Shader*) override {}
+            void BindMaterial(uint32_t) override {}
+            void BindTexture(uint32_t) override {}
+            void BindMesh(const Asset3D*) override {}
+            void BindObject(const Model3D*) override {}
+            void Draw(const Model3D*, uint32_t) override { ++mDrawnModels; }
+            void DrawInstanced(const Model3D* const*, uint32_t aCount, uint32_t, uint32_t) override { mDrawnModels += aCount; }
+
+            uint64_t mDrawnModels = 0;  /**< Rendering lists of the models drawn, instanced or not */
+        };
+    }
+
+    int InstancingBenchmark(int argc, char **argv)
+    {
+        if (argc < 3)
+        {
+            INFO(LogLevel::eLEVEL2, "Insomnium Engine Tools\n\n");
+            INFO(LogLevel::eLEVEL2, "Usage: [OPTION] ... PARAMERTERS\n");
+            INFO(LogLevel::eLEVEL2, "\n");
+
+            INFO(LogLevel::eLEVEL2, "Options:\n");
+            INFO(LogLevel::eLEVEL2, "  -ir, --instancing <model> [<count>] [<frames>]   Draws of a scene of identical models with and without instancing\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <model>: internal asset path and name, e.g. data/resources/models/chair3.model\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <count>: models in the scene, 500 by default\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <frames>: frames queued for the timing, 100 by default\n\n");
+            exit(1);
+        }
+
+        const std::string lFile = argv[2];
+        const uint32_t lCount = argc > 3 ? std::max(1, atoi(argv[3])) : 500;
+        const uint32_t lFrames = argc > 4 ? std::max(1, atoi(argv[4])) : 100;
+
+        auto lAsset = std::make_shared<Asset3D>(lFile, lFile);
+        if (!lAsset->Load(lFile))
+        {
+            CRASH("ERROR loading %s\n", lFile.c_str());
+            exit(2);
+        }
+        const size_t lLists = lAsset->GetIndicesCount().size();
+
+        /* The models stand on a square grid, the camera looks at it from a corner */
+        const glm::vec3 lSize = lAsset->GetBoundingBox().GetMax() - lAsset->GetBoundingBox().GetMin();
+        const float lSpacing = 1.5f * std::max(lSize.x, lSize.z);
+        const uint32_t lSide = static_cast<uint32_t>(std::ceil(std::sqrt(float(lCount))));
+        const glm::vec3 lCamera(-lSpacing, 2.0f * lSize.y, -lSpacing);
+        const float lFar = 2.0f * lSpacing * lSide;
+        std::vector<std::unique_ptr<Model3D>> lModels;
+        for (uint32_t i = 0; i < lCount; ++i)
+        {
+            lModels.emplace_back(new Model3D(lAsset));
+            lModels.back()->SetPosition(glm::vec3((i % lSide) * lSpacing, 0.0f, (i / lSide) * lSpacing));
+        }
+
+        printf("%u models sharing the asset %s of %u rendering lists, %u frames\n\n", lCount, lFile.c_str(),
+               static_cast<uint32_t>(lLists), lFrames);
+        printf("%-12s %8s %8s %8s %10s %10s %8s %8s %10s\n", "instancing", "meshes", "items", "draws", "instanced", "instances",
+               "states", "objects", "ms/frame");
+
+        for (int lInstancing = 0; lInstancing < 2; ++lInstancing)
+        {
+            RenderQueue lQueue;
+            lQueue.SetInstancing(lInstancing != 0);
+            Instancing::CountingBackend lBackend;
+
+            const auto lStart = std::chrono::high_resolution_clock::now();
+            for (uint32_t f = 0; f < lFrames; ++f)
+            {
+                lQueue.Clear();
+                for (const auto& lModel : lModels)
+                {
+                    const float lDepth = glm::length(lModel->GetPosition() - lCamera) / lFar;
+                    const uint32_t lLod = lModel->GetLod();
+                    const auto& lCounts = lAsset->GetIndicesCount(lLod);
+                    for (size_t i = 0; i < lLists; ++i)
+                    {
+                        if (lCounts[i] == 0)
+                            continue;
+                        // A texture handle per list, as the uploaded asset has
+                        const uint32_t lTexture = lAsset->GetTextures().empty() ? 0 : static_cast<uint32_t>(i + 1);
+                        lQueue.Add(RenderQueue::ePASS_OPAQUE, nullptr, 1, lTexture, lAsset.get(), lDepth, lModel.get(),
+                                   static_cast<uint32_t>(i), lLod);
+                    }
+                }
+                lQueue.Sort();
+                lQueue.Submit(lBackend);
+            }
+            const double lTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - lStart).count() / lFrames;
+
+            const RenderQueue::Stats& lFrame = lQueue.GetStats();
+            if (lBackend.mDrawnModels != uint64_t(lFrame.mItems) * lFrames)
+                WARNING("%llu rendering lists drawn instead of %u per frame", (unsigned long long)lBackend.mDrawnModels, lFrame.mItems);
+            printf("%-12s %8u %8u %8u %10u %10u %8u %8u %10.3f\n", lInstancing ? "on" : "off", lFrame.mMeshes, lFrame.mItems,
+                   lFrame.mDrawCalls, lFrame.mInstancedDraws, lFrame.mInstances, lFrame.mStateChanges, lFrame.mObjectChanges, lTime);
+        }
+        return 0;
+    }
+}
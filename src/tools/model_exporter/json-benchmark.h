@@ -0,0 +1,154 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Parse of the largest project, UI, catalog and resource files of the
+ *                resources, into a jsoncpp tree and into a JsonDocument. Both parse
+ *                the text already in memory, the jsoncpp reader is built once. The
+ *                heap is counted by the operator new of the project benchmark: the
+ *                allocations of a parse and the bytes the parsed value holds.
+ *******************************************************************************/
+
+#pragma once
+
+#include "precompiled.h"
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include "core/serialization/jsondocument.h"
+#include "project-benchmark.h"
+
+using namespace Framework;
+
+namespace Tool
+{
+    int JsonBenchmark(int argc, char **argv)
+    {
+        if (argc < 3)
+        {
+            INFO(LogLevel::eLEVEL2, "Insomnium Engine Tools\n\n");
+            INFO(LogLevel::eLEVEL2, "Usage: [OPTION] ... PARAMERTERS\n");
+            INFO(LogLevel::eLEVEL2, "\n");
+
+            INFO(LogLevel::eLEVEL2, "Options:\n");
+            INFO(LogLevel::eLEVEL2, "  -jd, --json-benchmark <resources_dir> [<runs>] Parse of the largest JSON files, jsoncpp and JsonDocument\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <resources_dir>: directory of the resources, e.g. game/data/resources\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <runs>: parses per file, the best one is kept, 200 by default\n\n");
+            exit(1);
+        }
+
+        const std::string lResourcesDir = argv[2];
+        const int lRuns = argc > 3 ? std::max(1, atoi(argv[3])) : 200;
+
+        /* The largest file of each kind */
+        struct Kind { const char* mName; std::string mDirectory; const char* mExtension; };
+        const Kind lKinds[] = {
+            { "project", lResourcesDir + "/projects", "project" },
+            { "ui", lResourcesDir + "/ui", "ui" },
+            { "catalog", lResourcesDir + "/catalogs", "catalog" },
+            { "resources", lResourcesDir, "json" },
+        };
+
+        auto lNow = []() { return std::chrono::high_resolution_clock::now(); };
+        auto lMs = [](std::chrono::high_resolution_clock::time_point aStart)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - aStart).count();
+        };
+
+        Json::CharReaderBuilder lBuilder;
+        std::unique_ptr<Json::CharReader> lReader(lBuilder.newCharReader());
+
+        printf("%-10s %-24s %8s | %10s %8s %10s | %10s %8s %10s %8s | %8s %s\n",
+               "kind", "file", "bytes", "time ms", "allocs", "held", "time ms", "allocs", "held", "blocks", "speedup", "same");
+        bool lIsSame = true;
+        for (const Kind& lKind : lKinds)
+        {
+            std::string lFile;
+            size_t lSize = 0;
+            for (const auto& lCandidate : Utils::ListFiles(lKind.mDirectory, lKind.mExtension))
+            {
+                std::ifstream lStream(lCandidate, std::ios::binary | std::ios::ate);
+                const size_t lCandidateSize = static_cast<size_t>(lStream.tellg());
+                if (lCandidateSize > lSize)
+                {
+                    lFile = lCandidate;
+                    lSize = lCandidateSize;
+                }
+            }
+            if (lFile.empty())
+            {
+                WARNING("No .%s file in %s\n", lKind.mExtension, lKind.mDirectory.c_str());
+                continue;
+            }
+
+            std::string lText(lSize, '\0');
+            std::ifstream(lFile, std::ios::binary).read(&lText[0], lSize);
+            const char* lBegin = lText.data();
+            const char* lEnd = lBegin + lText.size();
+
+            /* The allocations of a parse and the bytes the value holds once parsed */
+            Json::Value lValue;
+            std::string lErrors;
+            size_t lBase = ProjectMemory::Begin();
+            size_t lAllocations = ProjectMemory::sAllocations;
+            if (!lReader->parse(lBegin, lEnd, &lValue, &lErrors))
+            {
+                WARNING("Error parsing %s\n %s\n", lFile.c_str(), lErrors.c_str());
+                lIsSame = false;
+                continue;
+            }
+            const size_t lJsonAllocations = ProjectMemory::sAllocations - lAllocations;
+            const size_t lJsonBytes = ProjectMemory::sCurrent - lBase;
+
+            JsonDocument lDocument;
+            lBase = ProjectMemory::Begin();
+            lAllocations = ProjectMemory::sAllocations;
+            if (!lDocument.Parse(lBegin, lText.size()))
+            {
+                WARNING("Error parsing %s\n %s\n", lFile.c_str(), lDocument.GetError().c_str());
+                lIsSame = false;
+                continue;
+            }
+            const size_t lDocumentAllocations = ProjectMemory::sAllocations - lAllocations;
+            const size_t lDocumentBytes = ProjectMemory::sCurrent - lBase;
+
+            /* The document reads the same values jsoncpp does */
+            Json::Value lConverted;
+            lDocument.GetRoot().ToValue(lConverted);
+            const bool lIsFileSame = lConverted == lValue;
+            lIsSame &= lIsFileSame;
+
+            /* Best of the runs, the parsed value released in each one as a loader does */
+            double lJsonTime = 0.0;
+            double lDocumentTime = 0.0;
+            for (int r = 0; r < lRuns; ++r)
+            {
+                auto lStart = lNow();
+                {
+                    Json::Value lRun;
+                    lReader->parse(lBegin, lEnd, &lRun, &lErrors);
+                }
+                const double lJson = lMs(lStart);
+                lStart = lNow();
+                {
+                    JsonDocument lRun;
+                    lRun.Parse(lBegin, lText.size());
+                }
+                const double lDocumentRun = lMs(lStart);
+                lJsonTime = r == 0 ? lJson : std::min(lJsonTime, lJson);
+                lDocumentTime = r == 0 ? lDocumentRun : std::min(lDocumentTime, lDocumentRun);
+            }
+
+            const std::string lName = lFile.substr(lFile.find_last_of('/') + 1);
+            printf("%-10s %-24s %8zu | %10.3f %8zu %10zu | %10.3f %8zu %10zu %8u | %7.2fx %s\n",
+                   lKind.mName, lName.c_str(), lSize, lJsonTime, lJsonAllocations, lJsonBytes,
+                   lDocumentTime, lDocumentAllocations, lDocumentBytes, lDocument.GetArena().GetBlocks(),
+                   lJsonTime / lDocumentTime, lIsFileSame ? "yes" : "NO");
+        }
+        printf("\nleft: jsoncpp tree, right: JsonDocument, held: bytes of the parsed value, text included for the document\n");
+        printf("documents: %s\n", lIsSame ? "same values as jsoncpp" : "DIFFERENT");
+        return lIsSame ? 0 : 3;
+    }
+}
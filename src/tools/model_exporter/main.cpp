@@ -9,6 +9,22 @@
 #include "obj2engine.h"
 #include "model-inspector.h"
 #include "zcompress.h"
+#include "model-benchmark.h"
+#include "obj-benchmark.h"
+#include "mesh-optimizer.h"
+#include "texture-cooker.h"
+#include "image-benchmark.h"
+#include "resource-stress.h"
+#include "asset-cook.h"
+#include "instancing-benchmark.h"
+#include "project-benchmark.h"
+#include "autosave-benchmark.h"
+#include "scene-benchmark.h"
+#include "prefab-benchmark.h"
+#include "json-benchmark.h"
+#include "entity-benchmark.h"
+#include "hierarchy-benchmark.h"
+#include "picking-benchmark.h"
 
 using namespace Framework;
 using namespace Tool;
@@ -32,6 +48,88 @@ void info( )
     INFO(LogLevel::eLEVEL2, "                                                   <input>     - Input file\n");
     INFO(LogLevel::eLEVEL2, "                                                   <output>    - Output file\n\n");
 
+    INFO(LogLevel::eLEVEL2, "  -b, --benchmark <models_dir> <work_dir> [<runs>] Load time benchmark of the model formats\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <models_dir>: directory with the .model files, e.g. data/resources/models\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <work_dir>: directory for the converted files\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <runs>: loads of every file, 10 by default\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -ob, --obj-benchmark <models_dir> <work_dir> [<copies>] [<runs>] Import throughput benchmark of the OBJ loaders\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <models_dir>: directory with the .model files, e.g. data/resources/models\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <work_dir>: directory for the exported OBJ files\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <copies>: copies of every mesh in its OBJ file, 16 by default\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <runs>: imports of every file, the fastest is kept, 3 by default\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -m, --optimize-mesh <input> <output> [<format>]  Optimizes the geometry of an internal asset file\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <input>: internal asset path and name\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <output>: filename of the optimized asset\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <format>: GPU vertex layout, 'float' (32 bytes, default), 'compact' (20 bytes) or 'half' (16 bytes)\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -t, --cook-textures <input> <output> [<compression>] Builds the mip chain of the textures of an internal asset file\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <input>: internal asset path and name\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <output>: filename of the cooked asset\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <compression>: 'none' (default), 'bc1', 'bc3' or 'bc7'\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -tb, --texture-benchmark <textures_dir> <work_dir> [<compression>] Startup cost of the images with and without the texture cache\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <textures_dir>: directory with the .png and .jpg files, e.g. data/resources/textures\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <work_dir>: directory of the texture cache\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <compression>: 'none' (default), 'bc1', 'bc3' or 'bc7'\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -ib, --image-benchmark <images_dir> [<workers>]  Time until all the thumbnails of a directory are loaded\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <images_dir>: directory with the .png and .jpg files, e.g. data/resources/textures/furnitures/icons\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <workers>: decoding threads, 0 uses one per core (default)\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -rs, --resource-stress <game_dir> <cpu_mb> <gpu_mb> [<passes>] [<page>] Cycles through the catalog under a memory budget\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <game_dir>: directory with data/resources/resources*.json\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <cpu_mb>, <gpu_mb>: budget of the loaded assets, 0 is no limit\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <passes>: times the catalog is browsed, 3 by default\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <page>: models in use at a time, 4 by default\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -c, --cook <source_dir> <target_dir> [<workers>] [<compression>] Cooks the changed assets of a directory tree\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <source_dir>: directory with the .obj (and their .mtl and textures) and .model files\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <target_dir>: directory of the cooked .model files and of the cook manifest\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <workers>: cooking threads, 0 uses one per core (default)\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <compression>: 'none' (default), 'bc1', 'bc3' or 'bc7'\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -ir, --instancing <model> [<count>] [<frames>]   Draws of a scene of identical models with and without instancing\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <model>: internal asset path and name, e.g. data/resources/models/chair3.model\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <count>: models in the scene, 500 by default\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <frames>: frames queued for the timing, 100 by default\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -pb, --project-benchmark <work_dir> [<entities>] [<scenes>] Save and load of a generated project, JSON and binary\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <work_dir>: directory for the project files\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <entities>: entities of the project, 10000 by default\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <scenes>: floors they are spread over, 4 by default\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -as, --autosave-benchmark <work_dir> [<entities>] [<changes>] [<autosaves>] Main thread stall of the full and the incremental autosave\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <work_dir>: directory for the autosave files\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <entities>: entities of the project, 10000 by default\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <changes>: entities moved between two autosaves, 50 by default\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <autosaves>: incremental autosaves, 20 by default\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -sl, --scene-loading <work_dir> [<floors>] [<entities>] [<budget>] Open time and resident memory, floors loaded at the open and when shown\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <work_dir>: directory for the project file\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <floors>: floors of the project, 10 by default\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <entities>: entities per floor, 1000 by default\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <budget>: MB the loaded floors may take, 16 by default\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -pf, --prefab-benchmark <entities_dir> [<instances>] Instantiation rate of the prefabs, from the JSON and from the templates\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <entities_dir>: directory of the .entity prefabs, e.g. game/data/entities\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <instances>: instances created per run, 20000 by default\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -jd, --json-benchmark <resources_dir> [<runs>] Parse of the largest JSON files, jsoncpp and JsonDocument\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <resources_dir>: directory of the resources, e.g. game/data/resources\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <runs>: parses per file, the best one is kept, 200 by default\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -eb, --entity-benchmark [<list_max>]             Create, lookup and destroy of 1k, 10k and 100k entities, list and index\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <list_max>: largest count the list is run with, 10000 by default\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -hb, --hierarchy-benchmark [<max_models>]        Frustum, box and ray queries of the hierarchy and of a scan of the models\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <max_models>: largest scene, from 1000 by tenfold steps, 100000 by default\n\n");
+
+    INFO(LogLevel::eLEVEL2, "  -pk, --picking-benchmark <models_dir> [<rays>]   Ray casts of the models, triangle hierarchy and every triangle\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <models_dir>: directory with the .model files, e.g. data/resources/models\n");
+    INFO(LogLevel::eLEVEL2, "                                                   <rays>: rays cast at every model, 1000 by default\n\n");
+
     INFO(LogLevel::eLEVEL2, "  -h, --help                                       Display this help and exit");
     exit(1);
 }
@@ -56,6 +154,74 @@ int main(int argc, char **argv)
     {
         Tool::ZCompress(argc, argv);
     }
+    else if(strcmp(argv[1], "-b") == 0 || strcmp(argv[1], "--benchmark") == 0)
+    {
+        Tool::ModelBenchmark(argc, argv);
+    }
+    else if(strcmp(argv[1], "-ob") == 0 || strcmp(argv[1], "--obj-benchmark") == 0)
+    {
+        Tool::ObjBenchmark(argc, argv);
+    }
+    else if(strcmp(argv[1], "-m") == 0 || strcmp(argv[1], "--optimize-mesh") == 0)
+    {
+        Tool::MeshOptimize(argc, argv);
+    }
+    else if(strcmp(argv[1], "-t") == 0 || strcmp(argv[1], "--cook-textures") == 0)
+    {
+        Tool::CookTextures(argc, argv);
+    }
+    else if(strcmp(argv[1], "-tb") == 0 || strcmp(argv[1], "--texture-benchmark") == 0)
+    {
+        Tool::TextureBenchmark(argc, argv);
+    }
+    else if(strcmp(argv[1], "-ib") == 0 || strcmp(argv[1], "--image-benchmark") == 0)
+    {
+        Tool::ImageBenchmark(argc, argv);
+    }
+    else if(strcmp(argv[1], "-rs") == 0 || strcmp(argv[1], "--resource-stress") == 0)
+    {
+        return Tool::ResourceStress(argc, argv);
+    }
+    else if(strcmp(argv[1], "-c") == 0 || strcmp(argv[1], "--cook") == 0)
+    {
+        return Tool::CookAssets(argc, argv);
+    }
+    else if(strcmp(argv[1], "-ir") == 0 || strcmp(argv[1], "--instancing") == 0)
+    {
+        return Tool::InstancingBenchmark(argc, argv);
+    }
+    else if(strcmp(argv[1], "-pb") == 0 || strcmp(argv[1], "--project-benchmark") == 0)
+    {
+        return Tool::ProjectBenchmark(argc, argv);
+    }
+    else if(strcmp(argv[1], "-as") == 0 || strcmp(argv[1], "--autosave-benchmark") == 0)
+    {
+        return Tool::AutosaveBenchmark(argc, argv);
+    }
+    else if(strcmp(argv[1], "-sl") == 0 || strcmp(argv[1], "--scene-loading") == 0)
+    {
+        return Tool::SceneLoadingBenchmark(argc, argv);
+    }
+    else if(strcmp(argv[1], "-pf") == 0 || strcmp(argv[1], "--prefab-benchmark") == 0)
+    {
+        return Tool::PrefabBenchmark(argc, argv);
+    }
+    else if(strcmp(argv[1], "-jd") == 0 || strcmp(argv[1], "--json-benchmark") == 0)
+    {
+        return Tool::JsonBenchmark(argc, argv);
+    }
+    else if(strcmp(argv[1], "-eb") == 0 || strcmp(argv[1], "--entity-benchmark") == 0)
+    {
+        return Tool::EntityBenchmark(argc, argv);
+    }
+    else if(strcmp(argv[1], "-hb") == 0 || strcmp(argv[1], "--hierarchy-benchmark") == 0)
+    {
+        return Tool::HierarchyBenchmark(argc, argv);
+    }
+    else if(strcmp(argv[1], "-pk") == 0 || strcmp(argv[1], "--picking-benchmark") == 0)
+    {
+        return Tool::PickingBenchmark(argc, argv);
+    }
     else if(strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)
     {
         INFO(LogLevel::eLEVEL2, );
@@ -0,0 +1,79 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Optimizes the geometry of engine model files and reports the
+ *                vertex cache efficiency and the GPU buffer sizes before and after.
+ *                The levels of detail are generated again from the optimized geometry
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include "graphic/asset3d.h"
+#include "core/graphic/meshoptimizer.h"
+#include "core/graphic/meshsimplifier.h"
+
+using namespace Framework;
+
+namespace Tool
+{
+    int MeshOptimize(int argc, char **argv)
+    {
+        if (argc < 4)
+        {
+            INFO(LogLevel::eLEVEL2, "Insomnium Engine Tools\n\n");
+            INFO(LogLevel::eLEVEL2, "Usage: [OPTION] ... PARAMERTERS\n");
+            INFO(LogLevel::eLEVEL2, "\n");
+
+            INFO(LogLevel::eLEVEL2, "Options:\n");
+            INFO(LogLevel::eLEVEL2, "  -m, --optimize-mesh <input> <output> [<format>]  Optimizes the geometry of an internal asset file\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <input>: internal asset path and name\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <output>: filename of the optimized asset\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <format>: GPU vertex layout, 'float' (32 bytes, default), 'compact' (20 bytes) or 'half' (16 bytes)\n\n");
+            exit(1);
+        }
+
+        MeshOptimizer::Options lOptions;
+        if (argc > 4)
+        {
+            if (strcmp(argv[4], "compact") == 0)
+                lOptions.mVertexFormat = Asset3D::VertexFormat::eCOMPACT;
+            else if (strcmp(argv[4], "half") == 0)
+                lOptions.mVertexFormat = Asset3D::VertexFormat::eHALF;
+            else if (strcmp(argv[4], "float") != 0)
+            {
+                CRASH("ERROR unknown vertex format %s\n", argv[4]);
+                exit(2);
+            }
+        }
+
+        Asset3D lAsset(argv[2], "");
+        if (lAsset.Load(argv[2]) == false)
+        {
+            CRASH("ERROR loading asset from file %s\n", argv[2]);
+            exit(3);
+        }
+
+        const MeshOptimizer::Stats lStats = MeshOptimizer::Optimize(lAsset, lOptions);
+        printf("%-10s %10s %10s %10s %10s %10s %12s\n", "", "vertices", "triangles", "ACMR", "ATVR", "bytes/vtx", "GPU bytes");
+        printf("%-10s %10u %10u %10.3f %10.3f %10u %12llu\n", "before", lStats.mBefore.mVertices, lStats.mBefore.mTriangles,
+               lStats.mBefore.mACMR, lStats.mBefore.mATVR, lStats.mBefore.mVertexBytes, (unsigned long long)lStats.mBefore.mGeometryBytes);
+        printf("%-10s %10u %10u %10.3f %10.3f %10u %12llu\n", "after", lStats.mAfter.mVertices, lStats.mAfter.mTriangles,
+               lStats.mAfter.mACMR, lStats.mAfter.mATVR, lStats.mAfter.mVertexBytes, (unsigned long long)lStats.mAfter.mGeometryBytes);
+        printf("%u overdraw clusters, %u bytes per index, %.1f ms\n", lStats.mClusters, lStats.mAfter.mIndexBytes, lStats.mTime);
+
+        MeshSimplifier::GenerateLods(lAsset);
+        for (uint32_t lLod = 0; lLod < lAsset.GetLodCount(); ++lLod)
+            printf("LOD %u: %10u triangles, error %.4f\n", lLod, lAsset.GetTriangleCount(lLod), lAsset.GetLodError(lLod));
+
+        if (lAsset.Save(argv[3]) == false)
+        {
+            CRASH("ERROR storing asset to output file %s\n", argv[3]);
+            exit(4);
+        }
+
+        INFO(LogLevel::eLEVEL2, "Created %s succesfully\n\n", argv[3]);
+        return 0;
+    }
+}
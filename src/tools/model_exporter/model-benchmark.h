@@ -0,0 +1,124 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Load time benchmark of the model files of a directory. Every model
+ *                is loaded as it is, then written in the chunked format with
+ *                uncompressed and with zlib geometry, and the load and bounds query
+ *                times of the three files are compared.
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include <chrono>
+#include <fstream>
+#include "graphic/asset3d.h"
+
+using namespace Framework;
+
+namespace Tool
+{
+    namespace Benchmark
+    {
+        inline uint64_t FileSize(const std::string& aFileName)
+        {
+            std::ifstream lFile(aFileName, std::ios::binary | std::ios::ate);
+            return lFile.is_open() ? static_cast<uint64_t>(lFile.tellg()) : 0;
+        }
+
+        // Average milliseconds of a number of runs
+        template<typename F>
+        double Time(uint32_t aIterations, F aFunction)
+        {
+            const auto lStart = std::chrono::high_resolution_clock::now();
+            for ( uint32_t i = 0; i < aIterations; ++i )
+                aFunction();
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - lStart).count() / aIterations;
+        }
+
+        struct Result
+        {
+            uint64_t mSize = 0;
+            double   mLoad = 0.0;
+            double   mBounds = 0.0;
+        };
+    }
+
+    int ModelBenchmark(int argc, char **argv)
+    {
+        if (argc < 4)
+        {
+            INFO(LogLevel::eLEVEL2, "Insomnium Engine Tools\n\n");
+            INFO(LogLevel::eLEVEL2, "Usage: [OPTION] ... PARAMERTERS\n");
+            INFO(LogLevel::eLEVEL2, "\n");
+
+            INFO(LogLevel::eLEVEL2, "Options:\n");
+            INFO(LogLevel::eLEVEL2, "  -b, --benchmark <models_dir> <work_dir> [<runs>] Load time benchmark of the model formats\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <models_dir>: directory with the .model files, e.g. data/resources/models\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <work_dir>: directory for the converted files\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <runs>: loads of every file, 10 by default\n\n");
+            exit(1);
+        }
+
+        const std::string lModelsDir = argv[2];
+        const std::string lWorkDir = argv[3];
+        const uint32_t lRuns = argc > 4 ? std::max(1, atoi(argv[4])) : 10;
+
+        const std::vector<std::string> lFiles = Utils::ListFiles(lModelsDir, "model");
+        if (lFiles.empty())
+        {
+            CRASH("ERROR no .model files found in %s\n", lModelsDir.c_str());
+            exit(3);
+        }
+
+        enum { eSOURCE, eCHUNKED, eCHUNKED_ZLIB, eCOUNT };
+        const char* lNames[eCOUNT] = { "source", "chunked", "chunked+zlib" };
+        Benchmark::Result lTotals[eCOUNT];
+
+        printf("%-24s %-14s %12s %12s %12s\n", "model", "format", "bytes", "load ms", "bounds ms");
+        for (const auto& lSource : lFiles)
+        {
+            const std::string lFileName = lSource.substr(lSource.find_last_of('/') + 1);
+            std::string lPaths[eCOUNT] = { lSource, lWorkDir + "/" + lFileName, lWorkDir + "/zlib_" + lFileName };
+
+            {
+                Asset3D lAsset("", lSource);
+                if (!lAsset.Load(lSource) ||
+                    !lAsset.Save(lPaths[eCHUNKED]) ||
+                    !lAsset.Save(lPaths[eCHUNKED_ZLIB], ModelFile::Compression::eZLIB, ModelFile::Compression::eZLIB))
+                {
+                    WARNING("Skipping %s, it cannot be converted", lSource.c_str());
+                    continue;
+                }
+            }
+
+            for (int f = 0; f < eCOUNT; ++f)
+            {
+                Benchmark::Result lResult;
+                lResult.mSize = Benchmark::FileSize(lPaths[f]);
+                lResult.mLoad = Benchmark::Time(lRuns, [&]()
+                {
+                    Asset3D lAsset("", lPaths[f]);
+                    lAsset.Load(lPaths[f]);
+                });
+                lResult.mBounds = Benchmark::Time(lRuns, [&]()
+                {
+                    BoundingBox lBox;
+                    Asset3D::LoadBounds(lPaths[f], lBox);
+                });
+                printf("%-24s %-14s %12llu %12.3f %12.3f\n", lFileName.c_str(), lNames[f],
+                       (unsigned long long)lResult.mSize, lResult.mLoad, lResult.mBounds);
+                lTotals[f].mSize += lResult.mSize;
+                lTotals[f].mLoad += lResult.mLoad;
+                lTotals[f].mBounds += lResult.mBounds;
+            }
+        }
+
+        printf("\n");
+        for (int f = 0; f < eCOUNT; ++f)
+            printf("%-24s %-14s %12llu %12.3f %12.3f\n", "total", lNames[f],
+                   (unsigned long long)lTotals[f].mSize, lTotals[f].mLoad, lTotals[f].mBounds);
+        return 0;
+    }
+}
@@ -0,0 +1,183 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Import throughput benchmark of the OBJ loaders. Every model of a
+ *                directory is exported as an OBJ file with a grid of copies of the
+ *                mesh, to get files of the size of detailed furniture, then imported
+ *                with Asset3DLoaders::LoadOBJ and with ObjImporter on one and on all
+ *                the cores.
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include <chrono>
+#include <fstream>
+#include "graphic/asset3d.h"
+#include "core/graphic/asset3dloaders.h"
+#include "core/graphic/objimporter.h"
+
+using namespace Framework;
+
+namespace Tool
+{
+    namespace ObjBenchmarkUtils
+    {
+        // Writes the OBJ subset read by Asset3DLoaders::LoadOBJ, so both loaders can be compared
+        inline bool WriteOBJ(const Asset3D& aAsset, const std::string& aDirectory, const std::string& aName, uint32_t aCopies)
+        {
+            std::ofstream lMaterials(aDirectory + "/" + aName + ".mtl");
+            for ( size_t m = 0; m < aAsset.GetMaterials().size(); ++m )
+            {
+                const Material& lMaterial = aAsset.GetMaterials()[m];
+                lMaterials << "newmtl material_" << m << "\n"
+                           << "Ka " << lMaterial.GetAmbient().r << " " << lMaterial.GetAmbient().g << " " << lMaterial.GetAmbient().b << "\n"
+                           << "Kd " << lMaterial.GetDiffuse().r << " " << lMaterial.GetDiffuse().g << " " << lMaterial.GetDiffuse().b << "\n"
+                           << "Ks " << lMaterial.GetSpecular().r << " " << lMaterial.GetSpecular().g << " " << lMaterial.GetSpecular().b << "\n"
+                           << "Ns " << lMaterial.GetShininess() << "\n"
+                           << "d " << lMaterial.GetAlpha() << "\n"
+                           << "map_Kd null\n";
+            }
+
+            FILE* lFile = fopen((aDirectory + "/" + aName + ".obj").c_str(), "w");
+            if ( !lFile || !lMaterials.good() )
+            {
+                if ( lFile )
+                    fclose(lFile);
+                return false;
+            }
+
+            const auto& lVertices = aAsset.GetVertexData();
+            const uint32_t lSide = static_cast<uint32_t>(std::ceil(std::sqrt(float(aCopies))));
+            fprintf(lFile, "mtllib %s.mtl\n", aName.c_str());
+            for ( uint32_t c = 0; c < aCopies; ++c )
+            {
+                const glm::vec3 lOffset(2.5f * (c % lSide), 0.0f, 2.5f * (c / lSide));
+                for ( const auto& lVertex : lVertices )
+                    fprintf(lFile, "v %f %f %f\n", lVertex.mVertex.x + lOffset.x, lVertex.mVertex.y + lOffset.y, lVertex.mVertex.z + lOffset.z);
+            }
+            for ( const auto& lVertex : lVertices )
+                fprintf(lFile, "vt %f %f\n", lVertex.mUVCoord.x, 1.0f - lVertex.mUVCoord.y);
+            for ( const auto& lVertex : lVertices )
+                fprintf(lFile, "vn %f %f %f\n", lVertex.mNormal.x, lVertex.mNormal.y, lVertex.mNormal.z);
+
+            const auto& lIndices = aAsset.GetIndexData();
+            for ( size_t m = 0; m < aAsset.GetIndicesOffsets().size(); ++m )
+            {
+                fprintf(lFile, "usemtl material_%zu\n", m);
+                const uint32_t lBegin = aAsset.GetIndicesOffsets()[m];
+                const uint32_t lEnd = lBegin + aAsset.GetIndicesCount()[m];
+                for ( uint32_t c = 0; c < aCopies; ++c )
+                {
+                    const size_t lBase = size_t(c) * lVertices.size();
+                    for ( uint32_t i = lBegin; i + 2 < lEnd; i += 3 )
+                    {
+                        const uint32_t a = lIndices[i] + 1, b = lIndices[i + 1] + 1, d = lIndices[i + 2] + 1;
+                        fprintf(lFile, "f %zu/%u/%u %zu/%u/%u %zu/%u/%u\n", lBase + a, a, a, lBase + b, b, b, lBase + d, d, d);
+                    }
+                }
+            }
+            const bool lResult = ferror(lFile) == 0;
+            fclose(lFile);
+            return lResult;
+        }
+
+        // Milliseconds of the fastest of a number of runs
+        template<typename F>
+        double Time(uint32_t aRuns, F aFunction)
+        {
+            double lBest = 0.0;
+            for ( uint32_t i = 0; i < aRuns; ++i )
+            {
+                const auto lStart = std::chrono::high_resolution_clock::now();
+                aFunction();
+                const double lTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - lStart).count();
+                lBest = i == 0 ? lTime : std::min(lBest, lTime);
+            }
+            return lBest;
+        }
+    }
+
+    int ObjBenchmark(int argc, char **argv)
+    {
+        if (argc < 4)
+        {
+            INFO(LogLevel::eLEVEL2, "Insomnium Engine Tools\n\n");
+            INFO(LogLevel::eLEVEL2, "Usage: [OPTION] ... PARAMERTERS\n");
+            INFO(LogLevel::eLEVEL2, "\n");
+
+            INFO(LogLevel::eLEVEL2, "Options:\n");
+            INFO(LogLevel::eLEVEL2, "  -ob, --obj-benchmark <models_dir> <work_dir> [<copies>] [<runs>] Import throughput benchmark of the OBJ loaders\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <models_dir>: directory with the .model files, e.g. data/resources/models\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <work_dir>: directory for the exported OBJ files\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <copies>: copies of every mesh in its OBJ file, 16 by default\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <runs>: imports of every file, the fastest is kept, 3 by default\n\n");
+            exit(1);
+        }
+
+        const std::string lModelsDir = argv[2];
+        const std::string lWorkDir = argv[3];
+        const uint32_t lCopies = argc > 4 ? std::max(1, atoi(argv[4])) : 16;
+        const uint32_t lRuns = argc > 5 ? std::max(1, atoi(argv[5])) : 3;
+
+        const std::vector<std::string> lFiles = Utils::ListFiles(lModelsDir, "model");
+        if (lFiles.empty())
+        {
+            CRASH("ERROR no .model files found in %s\n", lModelsDir.c_str());
+            exit(3);
+        }
+
+        enum { eLOADOBJ, eIMPORTER_1, eIMPORTER_N, eCOUNT };
+        const char* lNames[eCOUNT] = { "LoadOBJ", "ObjImporter/1", "ObjImporter/all" };
+        double lTotalTime[eCOUNT] = {};
+        double lTotalBytes = 0.0;
+        double lTotalTriangles = 0.0;
+
+        printf("%-24s %-16s %10s %10s %10s %10s %10s\n", "model", "loader", "MB", "tris", "ms", "MB/s", "Mtris/s");
+        for (const auto& lSource : lFiles)
+        {
+            std::string lName = lSource.substr(lSource.find_last_of('/') + 1);
+            lName = lName.substr(0, lName.find_last_of('.'));
+            {
+                Asset3D lAsset("", lSource);
+                if (!lAsset.Load(lSource) || !ObjBenchmarkUtils::WriteOBJ(lAsset, lWorkDir, lName, lCopies))
+                {
+                    WARNING("Skipping %s, it cannot be exported", lSource.c_str());
+                    continue;
+                }
+            }
+
+            const std::string lOBJ = lWorkDir + "/" + lName + ".obj";
+            ObjImporter::Stats lStats;
+            {
+                Asset3D lAsset("", "");
+                if (!ObjImporter::Load(lAsset, lOBJ, 0, &lStats))
+                {
+                    WARNING("Skipping %s, it cannot be imported", lOBJ.c_str());
+                    continue;
+                }
+            }
+            const double lMB = lStats.mBytes / (1024.0 * 1024.0);
+            lTotalBytes += lMB;
+            lTotalTriangles += lStats.mTriangles;
+
+            double lTimes[eCOUNT];
+            lTimes[eLOADOBJ] = ObjBenchmarkUtils::Time(lRuns, [&]() { Asset3D lAsset("", ""); Asset3DLoaders::LoadOBJ(lAsset, lOBJ); });
+            lTimes[eIMPORTER_1] = ObjBenchmarkUtils::Time(lRuns, [&]() { Asset3D lAsset("", ""); ObjImporter::Load(lAsset, lOBJ, 1); });
+            lTimes[eIMPORTER_N] = ObjBenchmarkUtils::Time(lRuns, [&]() { Asset3D lAsset("", ""); ObjImporter::Load(lAsset, lOBJ); });
+            for (int l = 0; l < eCOUNT; ++l)
+            {
+                lTotalTime[l] += lTimes[l];
+                printf("%-24s %-16s %10.2f %10u %10.2f %10.1f %10.2f\n", lName.c_str(), lNames[l], lMB, lStats.mTriangles,
+                       lTimes[l], lMB * 1000.0 / lTimes[l], lStats.mTriangles / (lTimes[l] * 1000.0));
+            }
+        }
+
+        printf("\n");
+        for (int l = 0; l < eCOUNT; ++l)
+            printf("%-24s %-16s %10.2f %10.0f %10.2f %10.1f %10.2f\n", "total", lNames[l], lTotalBytes, lTotalTriangles,
+                   lTotalTime[l], lTotalBytes * 1000.0 / lTotalTime[l], lTotalTriangles / (lTotalTime[l] * 1000.0));
+        return 0;
+    }
+}
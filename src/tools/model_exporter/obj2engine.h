@@ -7,7 +7,10 @@
 
 
 #include "precompiled.h"
-#include "core/graphic/asset3dloaders.h"
+#include "graphic/asset3d.h"
+#include "core/graphic/objimporter.h"
+#include "core/graphic/meshoptimizer.h"
+#include "core/graphic/meshsimplifier.h"
 
 using namespace Framework;
 
@@ -30,12 +33,18 @@ namespace Tool
 
         Asset3D lAsset("","");
 
-        if (Asset3DLoaders::LoadOBJ(lAsset, argv[2]) == false)
+        ObjImporter::Stats lStats;
+        if (ObjImporter::Load(lAsset, argv[2], 0, &lStats) == false)
         {
             CRASH("ERROR opening input OBJ asset %s\n", argv[2]);
             exit(2);
         }
 
+        INFO(LogLevel::eLEVEL2, "Imported %u triangles from %u polygons in %.1f ms using %u threads",
+             lStats.mTriangles, lStats.mPolygons, lStats.mTotalTime, lStats.mThreads);
+        MeshOptimizer::Optimize(lAsset);
+        MeshSimplifier::GenerateLods(lAsset);
+
         INFO(LogLevel::eLEVEL2, "Asset info:");
         printf("%s", lAsset.ToString().c_str());
 
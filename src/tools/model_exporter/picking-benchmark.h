@@ -0,0 +1,178 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Ray casts against the model files of a directory, through the
+ *                triangle hierarchy RenderReady builds for the picking and against
+ *                every triangle of the model. The rays come from around the model
+ *                and aim inside its box, so most of them hit it. Both must agree on
+ *                the hit and on its distance.
+ *******************************************************************************/
+
+#pragma once
+
+#include "precompiled.h"
+#include <chrono>
+#include <cfloat>
+#include <random>
+#include "graphic/asset3d.h"
+
+using namespace Framework;
+
+namespace Tool
+{
+    namespace Picking
+    {
+        /* The triangle test of the hierarchy, on every triangle */
+        bool Raycast(const std::vector<glm::vec3>& aPositions, const std::vector<uint32_t>& aIndices,
+                     const glm::vec3& aOrigin, const glm::vec3& aDirection, float& aDistance)
+        {
+            bool lIsHit = false;
+            for (size_t i = 0; i + 2 < aIndices.size(); i += 3)
+            {
+                const glm::vec3& v0 = aPositions[aIndices[i]];
+                const glm::vec3 lEdge1 = aPositions[aIndices[i + 1]] - v0;
+                const glm::vec3 lEdge2 = aPositions[aIndices[i + 2]] - v0;
+                const glm::vec3 p = glm::cross(aDirection, lEdge2);
+                const float lDet = glm::dot(lEdge1, p);
+                if (std::abs(lDet) < 1.0e-12f)
+                    continue;
+                const float lInvDet = 1.0f / lDet;
+                const glm::vec3 s = aOrigin - v0;
+                const float u = glm::dot(s, p) * lInvDet;
+                if (u < 0.0f || u > 1.0f)
+                    continue;
+                const glm::vec3 q = glm::cross(s, lEdge1);
+                const float v = glm::dot(aDirection, q) * lInvDet;
+                if (v < 0.0f || u + v > 1.0f)
+                    continue;
+                const float t = glm::dot(lEdge2, q) * lInvDet;
+                if (t < 0.0f || t >= aDistance)
+                    continue;
+                aDistance = t;
+                lIsHit = true;
+            }
+            return lIsHit;
+        }
+    }
+
+    int PickingBenchmark(int argc, char **argv)
+    {
+        if (argc < 3)
+        {
+            INFO(LogLevel::eLEVEL2, "Insomnium Engine Tools\n\n");
+            INFO(LogLevel::eLEVEL2, "Usage: [OPTION] ... PARAMERTERS\n");
+            INFO(LogLevel::eLEVEL2, "\n");
+
+            INFO(LogLevel::eLEVEL2, "Options:\n");
+            INFO(LogLevel::eLEVEL2, "  -pk, --picking-benchmark <models_dir> [<rays>]   Ray casts of the models, triangle hierarchy and every triangle\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <models_dir>: directory with the .model files, e.g. data/resources/models\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <rays>: rays cast at every model, 1000 by default\n\n");
+            exit(1);
+        }
+
+        const std::string lDirectory = argv[2];
+        const int lRays = argc > 3 ? std::max(1, atoi(argv[3])) : 1000;
+
+        auto lNow = []() { return std::chrono::high_resolution_clock::now(); };
+        auto lMs = [](std::chrono::high_resolution_clock::time_point aStart)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - aStart).count();
+        };
+
+        printf("%-24s %10s %10s %8s | %12s %12s %8s | %6s %s\n", "model", "triangles", "build ms", "hits", "brute us", "hierarchy us",
+               "speedup", "diff", "same");
+        bool lIsSame = true;
+        double lBruteTotal = 0.0;
+        double lHierarchyTotal = 0.0;
+        for (const auto& lFile : Utils::ListFiles(lDirectory, "model"))
+        {
+            Asset3D lAsset(lFile, lFile);
+            if (!lAsset.Load(lFile))
+            {
+                WARNING("ERROR loading %s\n", lFile.c_str());
+                lIsSame = false;
+                continue;
+            }
+
+            /* The triangles RenderReady gives the hierarchy, the full resolution ones */
+            std::vector<glm::vec3> lPositions;
+            lPositions.reserve(lAsset.GetVertexData().size());
+            for (const auto& lElement : lAsset.GetVertexData())
+                lPositions.push_back(lElement.mVertex);
+            std::vector<uint32_t> lIndices;
+            if (lAsset.GetLodCount() == 1)
+                lIndices = lAsset.GetIndexData();
+            else
+            {
+                for (size_t i = 0; i < lAsset.GetIndicesOffsets(0).size(); ++i)
+                    lIndices.insert(lIndices.end(), lAsset.GetIndexData().begin() + lAsset.GetIndicesOffsets(0)[i],
+                                    lAsset.GetIndexData().begin() + lAsset.GetIndicesOffsets(0)[i] + lAsset.GetIndicesCount(0)[i]);
+            }
+
+            auto lStart = lNow();
+            lAsset.RenderReady();
+            const double lBuild = lMs(lStart);
+            const TriangleHierarchy& lHierarchy = lAsset.GetTriangleHierarchy();
+
+            /* From a sphere around the box to a point inside it */
+            const BoundingBox& lBox = lAsset.GetBoundingBox();
+            const glm::vec3 lCenter = 0.5f * (lBox.GetMin() + lBox.GetMax());
+            const float lRadius = std::max(glm::length(lBox.GetMax() - lBox.GetMin()), 1.0e-3f);
+            std::mt19937 lRandom(static_cast<uint32_t>(lIndices.size()));
+            std::uniform_real_distribution<float> lUnit(0.0f, 1.0f);
+            std::normal_distribution<float> lNormal;
+            std::vector<glm::vec3> lOrigins(lRays);
+            std::vector<glm::vec3> lDirections(lRays);
+            for (int r = 0; r < lRays; ++r)
+            {
+                lOrigins[r] = lCenter + lRadius * glm::normalize(glm::vec3(lNormal(lRandom), lNormal(lRandom), lNormal(lRandom)) + glm::vec3(1.0e-6f));
+                const glm::vec3 lTarget = glm::mix(lBox.GetMin(), lBox.GetMax(), glm::vec3(lUnit(lRandom), lUnit(lRandom), lUnit(lRandom)));
+                lDirections[r] = glm::normalize(lTarget - lOrigins[r]);
+            }
+
+            std::vector<float> lBruteDistances(lRays, FLT_MAX);
+            lStart = lNow();
+            for (int r = 0; r < lRays; ++r)
+                Picking::Raycast(lPositions, lIndices, lOrigins[r], lDirections[r], lBruteDistances[r]);
+            const double lBrute = lMs(lStart) * 1e3 / lRays;
+
+            std::vector<float> lDistances(lRays, FLT_MAX);
+            std::vector<char> lHits(lRays, 0);
+            lStart = lNow();
+            for (int r = 0; r < lRays; ++r)
+            {
+                glm::vec3 lHitNormal;
+                lHits[r] = lHierarchy.Raycast(lOrigins[r], lDirections[r], lDistances[r], lHitNormal) ? 1 : 0;
+            }
+            const double lTime = lMs(lStart) * 1e3 / lRays;
+
+            /* The same hits at the same distances, the largest difference relative to the model size */
+            int lHitCount = 0;
+            bool lIsFileSame = true;
+            float lDifference = 0.0f;
+            for (int r = 0; r < lRays; ++r)
+            {
+                const bool lIsBruteHit = lBruteDistances[r] < FLT_MAX;
+                lIsFileSame &= lIsBruteHit == (lHits[r] != 0);
+                if (lIsBruteHit && lHits[r])
+                    lDifference = std::max(lDifference, std::abs(lBruteDistances[r] - lDistances[r]) / lRadius);
+                lHitCount += lHits[r];
+            }
+            lIsFileSame &= lDifference <= 1.0e-5f;
+            lIsSame &= lIsFileSame;
+            lBruteTotal += lBrute;
+            lHierarchyTotal += lTime;
+
+            const std::string lName = lFile.substr(lFile.find_last_of("/\\") + 1);
+            printf("%-24s %10zu %10.2f %7.1f%% | %12.2f %12.2f %7.1fx | %6.0e %s\n", lName.c_str(), lHierarchy.GetTriangleCount(), lBuild,
+                   100.0 * lHitCount / lRays, lBrute, lTime, lBrute / lTime, lDifference, lIsFileSame ? "yes" : "NO");
+        }
+        printf("\nbrute: every triangle tested, diff: largest distance difference over the model diagonal\n");
+        printf("a ray at every model: %.2f us brute, %.2f us hierarchy\n", lBruteTotal, lHierarchyTotal);
+        printf("casts: %s\n", lIsSame ? "same hits and distances with the hierarchy" : "DIFFERENT");
+        return lIsSame ? 0 : 3;
+    }
+}
@@ -0,0 +1,272 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Instantiation rate of the prefabs of a directory, from the merged
+ *                JSON of the prefab as EntityManager did, and from the compiled
+ *                prefab template. The instances are created as a furniture drop
+ *                does, without an override, and as a project load does, with the
+ *                name and the position overridden.
+ *
+ *                There is no engine here: the components are counted by stub
+ *                managers registered in a CmpManagerRegistry, and their Deserialize
+ *                only reads the values, the same for both paths. So the times are
+ *                the cost of the instantiation, not of the component setup.
+ *******************************************************************************/
+
+#pragma once
+
+#include "precompiled.h"
+#include <chrono>
+#include <map>
+#include "core/serialization/jsoncpputils.h"
+#include "engine/components/basecmp.h"
+#include "engine/ICmpManager.h"
+#include "engine/CmpManagerRegistry.h"
+#include "engine/prefabtemplate.h"
+
+using namespace Framework;
+
+namespace Tool
+{
+    namespace Prefabs
+    {
+        class Component : public BaseCmp
+        {
+        public:
+            void Deserialize(const Json::Value& aSerializer) override
+            {
+                for (auto lValue = aSerializer.begin(); lValue != aSerializer.end(); ++lValue)
+                    mValues += lValue->isArray() ? lValue->size() : 1;
+            }
+
+            uint32_t mValues = 0;
+        };
+
+        class CountingCmpManager : public ICmpManager
+        {
+        public:
+            CountingCmpManager(const std::string& aName) : mName(aName) {}
+
+            const char* GetName() const override { return mName.c_str(); }
+            int GetCmpID() override { return mCmpId; }
+            size_t Size() const override { return mCreated; }
+            shared_ptr<BaseCmp> AddCmp(size_t) override
+            {
+                ++mCreated;
+                shared_ptr<BaseCmp> lComponent(new Component);
+                lComponent->SetCmpId(mCmpId);
+                return lComponent;
+            }
+            void RemoveCmp(size_t) override {}
+            shared_ptr<BaseCmp> GetCmp(size_t) const override { return shared_ptr<BaseCmp>(); }
+            void LinkCmp(size_t, const shared_ptr<BaseCmp>&) override {}
+            void UnlinkCmp(size_t) override {}
+
+            int         mCmpId = 0;
+            size_t      mCreated = 0;
+
+        private:
+            std::string mName;
+        };
+
+        /* An entity of the benchmark: its name and its components, in creation order */
+        struct Instance
+        {
+            std::string                         mName;
+            std::vector<shared_ptr<BaseCmp>>    mComponents;
+        };
+    }
+
+    int PrefabBenchmark(int argc, char **argv)
+    {
+        if (argc < 3)
+        {
+            INFO(LogLevel::eLEVEL2, "Insomnium Engine Tools\n\n");
+            INFO(LogLevel::eLEVEL2, "Usage: [OPTION] ... PARAMERTERS\n");
+            INFO(LogLevel::eLEVEL2, "\n");
+
+            INFO(LogLevel::eLEVEL2, "Options:\n");
+            INFO(LogLevel::eLEVEL2, "  -pf, --prefab-benchmark <entities_dir> [<instances>] Instantiation rate of the prefabs, from the JSON and from the templates\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <entities_dir>: directory of the .entity prefabs, e.g. game/data/entities\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <instances>: instances created per run, 20000 by default\n\n");
+            exit(1);
+        }
+
+        const std::string lEntitiesDir = argv[2];
+        const uint32_t lInstances = argc > 3 ? std::max(1, atoi(argv[3])) : 20000;
+        const std::string lTransformType = "class Framework::TransformCmp";
+        const std::string lMotionType = "class Framework::MotionCmp";
+
+        /* The prefabs, stored as PrefabManager::AddPrefab stores them */
+        std::map<const std::string, Json::Value> lDatabase;
+        for (const auto& lFile : Utils::ListFiles(lEntitiesDir, "entity"))
+        {
+            Json::Value lPrefab;
+            if (!Json::JsonUtils::OpenAndParseJsonFromFile(lPrefab, lFile) || !lPrefab.isMember("prefabdefinition"))
+                continue;
+            const Json::Value& lDefinition = lPrefab["prefabdefinition"];
+            lDatabase[lDefinition["name"].asString()] = lDefinition;
+        }
+        if (lDatabase.empty())
+        {
+            WARNING("No prefab in %s\n", lEntitiesDir.c_str());
+            exit(2);
+        }
+
+        /* A manager per component type, the motion one for the components an override adds */
+        CmpManagerRegistry lRegistry;
+        std::vector<std::unique_ptr<Prefabs::CountingCmpManager>> lManagers;
+        auto lRegister = [&](const std::string& aType)
+        {
+            if (lRegistry.GetByCompName(aType))
+                return;
+            lManagers.emplace_back(new Prefabs::CountingCmpManager(aType));
+            lManagers.back()->mCmpId = lRegistry.RegisterCmpManager(lManagers.back().get());
+        };
+        lRegister(lMotionType);
+        for (const auto& lPrefab : lDatabase)
+            for (const auto& lComponent : lPrefab.second["components"])
+                lRegister(lComponent["type"].asString());
+        const PrefabTemplate::Resolver lResolver = [&lRegistry](const std::string& aType) { return lRegistry.GetByCompName(aType); };
+
+        /* The entity types by name, as the ObjectFactory finds them */
+        std::map<std::string, std::function<Prefabs::Instance*()>> lEntityTypes;
+        lEntityTypes["class Framework::Entity"] = []() { return new Prefabs::Instance; };
+
+        auto lNow = []() { return std::chrono::high_resolution_clock::now(); };
+        auto lMs = [](std::chrono::high_resolution_clock::time_point aStart)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - aStart).count();
+        };
+
+        const auto lCompileStart = lNow();
+        std::map<const std::string, PrefabTemplate> lTemplates;
+        for (const auto& lPrefab : lDatabase)
+        {
+            PrefabTemplate lTemplate;
+            if (lTemplate.Compile(lPrefab.second, lResolver))
+                lTemplates.emplace(lPrefab.first, std::move(lTemplate));
+        }
+        const double lCompileTime = lMs(lCompileStart);
+
+        /* The instances round robin over the prefabs. A load overrides the name and the position */
+        std::vector<std::string> lNames;
+        for (const auto& lPrefab : lDatabase)
+            lNames.push_back(lPrefab.first);
+        std::vector<Json::Value> lOverrides(lInstances);
+        for (uint32_t i = 0; i < lInstances; ++i)
+        {
+            Json::Value& lOverride = lOverrides[i];
+            lOverride["name"] = lNames[i % lNames.size()] + "_" + std::to_string(i);
+            Json::Value& lTransform = lOverride["components"][0];
+            lTransform["type"] = lTransformType;
+            lTransform["position"][0] = static_cast<double>(i % 100);
+            lTransform["position"][1] = 0.0;
+            lTransform["position"][2] = static_cast<double>(i / 100);
+        }
+        const Json::Value lNoOverride;
+
+        std::vector<std::unique_ptr<Prefabs::Instance>> lEntities;
+        lEntities.reserve(lInstances);
+        auto lAddComponent = [](Prefabs::Instance& aInstance, ICmpManager* aCmpManager, const Json::Value& aValues)
+        {
+            shared_ptr<BaseCmp> lComponent = aCmpManager->AddCmp(0);
+            aInstance.mComponents.push_back(lComponent);
+            lComponent->Deserialize(aValues);
+        };
+
+        /* EntityManager::Deserialize and CreateEntityFromData before the templates */
+        auto lFromJson = [&](const std::string& aPrefabName, const Json::Value& aOverride)
+        {
+            Json::Value lPrefab = lDatabase.find(aPrefabName)->second;
+            if (!aOverride.isNull())
+                Json::JsonUtils::OverrideEntity(lPrefab, aOverride);
+            Prefabs::Instance* lInstance = lEntityTypes.find(lPrefab["type"].asString())->second();
+            lInstance->mName = lPrefab["name"].asString();
+            for (const auto& lComponent : lPrefab["components"])
+                lAddComponent(*lInstance, lRegistry.GetByCompName(lComponent["type"].asString()), lComponent);
+            return lInstance;
+        };
+
+        /* EntityManager::CreateEntityFromPrefab and Entity::Instantiate */
+        auto lFromTemplate = [&](const std::string& aPrefabName, const Json::Value& aOverride)
+        {
+            const PrefabTemplate& lTemplate = lTemplates.find(aPrefabName)->second;
+            Prefabs::Instance* lInstance = new Prefabs::Instance;
+            lInstance->mName = lTemplate.GetName(aOverride);
+            lTemplate.VisitComponents(aOverride, lResolver, [&](ICmpManager* aCmpManager, const Json::Value& aValues)
+            {
+                lAddComponent(*lInstance, aCmpManager, aValues);
+            });
+            return lInstance;
+        };
+
+        /* Best of three runs, the instances destroyed between them */
+        auto lRun = [&](bool aTemplate, bool aOverride)
+        {
+            double lBest = 0.0;
+            for (int r = 0; r < 3; ++r)
+            {
+                lEntities.clear();
+                const auto lStart = lNow();
+                for (uint32_t i = 0; i < lInstances; ++i)
+                {
+                    const std::string& lName = lNames[i % lNames.size()];
+                    const Json::Value& lOverride = aOverride ? lOverrides[i] : lNoOverride;
+                    lEntities.emplace_back(aTemplate ? lFromTemplate(lName, lOverride) : lFromJson(lName, lOverride));
+                }
+                const double lTime = lMs(lStart);
+                lBest = r == 0 ? lTime : std::min(lBest, lTime);
+            }
+            lEntities.clear();
+            return lBest;
+        };
+
+        const double lDropJson = lRun(false, false);
+        const double lDropTemplate = lRun(true, false);
+        const double lLoadJson = lRun(false, true);
+        const double lLoadTemplate = lRun(true, true);
+
+        /* Both paths give the same names and component values, an added component included */
+        bool lIsSame = lTemplates.size() == lDatabase.size();
+        Json::Value lAdding = lOverrides[0];
+        lAdding["components"][1]["type"] = lMotionType;
+        lAdding["components"][1]["speed"] = 2.0;
+        for (const auto& lName : lNames)
+        {
+            const Json::Value* lChecked[] = { &lNoOverride, &lOverrides[0], &lAdding };
+            for (const Json::Value* lOverride : lChecked)
+            {
+                Json::Value lMerged = lDatabase.find(lName)->second;
+                if (!lOverride->isNull())
+                    Json::JsonUtils::OverrideEntity(lMerged, *lOverride);
+                const PrefabTemplate& lTemplate = lTemplates.find(lName)->second;
+                lIsSame &= lTemplate.GetName(*lOverride) == lMerged["name"].asString();
+
+                Json::ArrayIndex c = 0;
+                lTemplate.VisitComponents(*lOverride, lResolver, [&](ICmpManager* aCmpManager, const Json::Value& aValues)
+                {
+                    const Json::Value& lExpected = lMerged["components"][c++];
+                    lIsSame &= aCmpManager == lRegistry.GetByCompName(lExpected["type"].asString()) && aValues == lExpected;
+                });
+                lIsSame &= c == lMerged["components"].size();
+            }
+        }
+
+        printf("%zu prefabs compiled in %.3f ms, %u instances per run\n\n", lTemplates.size(), lCompileTime, lInstances);
+        printf("%-24s %10s %16s %10s\n", "instantiation", "time ms", "instances / s", "speedup");
+        auto lRow = [&](const char* aName, double aTime, double aBaseTime)
+        {
+            printf("%-24s %10.2f %16.0f %9.2fx\n", aName, aTime, lInstances / (aTime / 1000.0), aBaseTime / aTime);
+        };
+        lRow("drop, json", lDropJson, lDropJson);
+        lRow("drop, template", lDropTemplate, lDropJson);
+        lRow("load, json", lLoadJson, lLoadJson);
+        lRow("load, template", lLoadTemplate, lLoadJson);
+        printf("\ntemplate instances: %s\n", lIsSame ? "same as the json ones" : "DIFFERENT");
+        return lIsSame ? 0 : 3;
+    }
+}
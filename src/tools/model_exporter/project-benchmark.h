@@ -0,0 +1,323 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Save and load cost of a large project in the JSON format, written
+ *                with StyledWriter as Project::Save does by default, and in the
+ *                binary format it writes for a .sh3b file.
+ *                The project is generated: furniture entities spread over the
+ *                floors, serialized as Entity::Serialize writes them.
+ *
+ *                The peak memory is the one of the allocations made during the save
+ *                or the load above the ones alive before it. This tool replaces the
+ *                global operator new to count them.
+ *******************************************************************************/
+
+#pragma once
+
+#include "precompiled.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <new>
+#include "core/serialization/jsoncpputils.h"
+#include "engine/projectfile.h"
+
+using namespace Framework;
+
+namespace Tool
+{
+    namespace ProjectMemory
+    {
+        std::atomic<size_t> sCurrent(0);
+        std::atomic<size_t> sPeak(0);
+        std::atomic<size_t> sAllocations(0);
+
+        /* Keeps the size of the block before it, with the alignment of malloc */
+        const size_t sHeader = 16;
+
+        void* Allocate(size_t aSize)
+        {
+            char* lBlock = static_cast<char*>(malloc(aSize + sHeader));
+            if (!lBlock)
+                return nullptr;
+            *reinterpret_cast<size_t*>(lBlock) = aSize;
+            sAllocations.fetch_add(1);
+            const size_t lCurrent = sCurrent.fetch_add(aSize) + aSize;
+            size_t lPeak = sPeak.load();
+            while (lCurrent > lPeak && !sPeak.compare_exchange_weak(lPeak, lCurrent))
+            {
+            }
+            return lBlock + sHeader;
+        }
+
+        void Free(void* aPointer)
+        {
+            if (!aPointer)
+                return;
+            char* lBlock = static_cast<char*>(aPointer) - sHeader;
+            sCurrent.fetch_sub(*reinterpret_cast<size_t*>(lBlock));
+            free(lBlock);
+        }
+
+        /**
+         * Starts a measure
+         *
+         * @return The bytes alive, which the peak of the measure does not count
+         */
+        size_t Begin()
+        {
+            sPeak = sCurrent.load();
+            return sCurrent.load();
+        }
+    }
+}
+
+void* operator new(size_t aSize)
+{
+    void* lPointer = Tool::ProjectMemory::Allocate(aSize);
+    if (!lPointer)
+        throw std::bad_alloc();
+    return lPointer;
+}
+void* operator new[](size_t aSize) { return operator new(aSize); }
+void* operator new(size_t aSize, const std::nothrow_t&) noexcept { return Tool::ProjectMemory::Allocate(aSize); }
+void* operator new[](size_t aSize, const std::nothrow_t&) noexcept { return Tool::ProjectMemory::Allocate(aSize); }
+void operator delete(void* aPointer) noexcept { Tool::ProjectMemory::Free(aPointer); }
+void operator delete[](void* aPointer) noexcept { Tool::ProjectMemory::Free(aPointer); }
+void operator delete(void* aPointer, size_t) noexcept { Tool::ProjectMemory::Free(aPointer); }
+void operator delete[](void* aPointer, size_t) noexcept { Tool::ProjectMemory::Free(aPointer); }
+void operator delete(void* aPointer, const std::nothrow_t&) noexcept { Tool::ProjectMemory::Free(aPointer); }
+void operator delete[](void* aPointer, const std::nothrow_t&) noexcept { Tool::ProjectMemory::Free(aPointer); }
+
+namespace Tool
+{
+    namespace ProjectGenerator
+    {
+        const char* const sModels[] = { "bed1", "chair3", "rack2", "sofa1", "table4", "lamp2", "shelf1", "desk3" };
+        const char* const sGroups[] = { "Bedroom", "TablesAndChairs", "Storage", "LivingRoom" };
+
+        void SerializeVec(Json::Value& aSerializer, std::initializer_list<float> aValues)
+        {
+            aSerializer = Json::Value(Json::arrayValue);
+            for (float lValue : aValues)
+                aSerializer.append(lValue);
+        }
+
+        void Scene(Json::Value& aScene, uint32_t aFloor)
+        {
+            aScene["sceneName"] = "Floor " + std::to_string(aFloor);
+            aScene["rendertarget"] = "NoAA";
+            SerializeVec(aScene["rendertarget_clearcolor"], { 0.2f, 0.2f, 0.2f, 1.0f });
+            aScene["constraints3d"]["min_x"] = -500.0f;
+            aScene["constraints3d"]["max_x"] = 500.0f;
+            aScene["constraints3d"]["min_y"] = 0.0f;
+            aScene["constraints3d"]["max_y"] = 500.0f;
+        }
+
+        /* A catalog model standing on the floor, as RenderableCmp, TransformCmp and
+           CatalogCmp serialize it */
+        void Entity(Json::Value& aEntity, uint32_t aIndex)
+        {
+            const char* lModel = sModels[aIndex % (sizeof sModels / sizeof *sModels)];
+            aEntity["type"] = "Framework::Entity";
+            aEntity["name"] = std::string(lModel) + "_" + std::to_string(aIndex);
+
+            Json::Value& lComponents = aEntity["components"];
+            lComponents = Json::Value(Json::arrayValue);
+
+            Json::Value& lRenderable = lComponents.append(Json::Value());
+            lRenderable["type"] = "Framework::RenderableCmp";
+            lRenderable["model3d"] = lModel;
+            lRenderable["shadowcaster"] = true;
+
+            Json::Value& lTransform = lComponents.append(Json::Value());
+            lTransform["type"] = "Framework::TransformCmp";
+            const float lX = float(int(aIndex * 37 % 1000) - 500) + 0.25f * (aIndex % 4);
+            const float lZ = float(int(aIndex * 91 % 1000) - 500) + 0.5f * (aIndex % 2);
+            SerializeVec(lTransform["position"], { lX, 0.0f, lZ });
+            SerializeVec(lTransform["scale"], { 100.0f, 100.0f, 100.0f });
+            if (aIndex % 3)
+                SerializeVec(lTransform["rotation"], { 0.0f, 1.0f, 0.0f, float(aIndex % 360) });
+
+            Json::Value& lCatalog = lComponents.append(Json::Value());
+            lCatalog["type"] = "Framework::CatalogCmp";
+            lCatalog["id"] = lModel;
+            lCatalog["name"] = lModel;
+            lCatalog["group"] = sGroups[aIndex % (sizeof sGroups / sizeof *sGroups)];
+            lCatalog["icon"] = lModel;
+        }
+    }
+
+    int ProjectBenchmark(int argc, char **argv)
+    {
+        if (argc < 3)
+        {
+            INFO(LogLevel::eLEVEL2, "Insomnium Engine Tools\n\n");
+            INFO(LogLevel::eLEVEL2, "Usage: [OPTION] ... PARAMERTERS\n");
+            INFO(LogLevel::eLEVEL2, "\n");
+
+            INFO(LogLevel::eLEVEL2, "Options:\n");
+            INFO(LogLevel::eLEVEL2, "  -pb, --project-benchmark <work_dir> [<entities>] [<scenes>] Save and load of a generated project, JSON and binary\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <work_dir>: directory for the project files\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <entities>: entities of the project, 10000 by default\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <scenes>: floors they are spread over, 4 by default\n\n");
+            exit(1);
+        }
+
+        const std::string lWorkDir = argv[2];
+        const uint32_t lEntities = argc > 3 ? std::max(1, atoi(argv[3])) : 10000;
+        const uint32_t lScenes = argc > 4 ? std::max(1, atoi(argv[4])) : 4;
+        const std::string lJsonFile = lWorkDir + Utils::GetPathSeparator() + "benchmark.sh3d";
+        const std::string lBinaryFile = lWorkDir + Utils::GetPathSeparator() + "benchmark.sh3b";
+        const std::string lExportFile = lWorkDir + Utils::GetPathSeparator() + "benchmark.export.sh3d";
+        const std::string lImportFile = lWorkDir + Utils::GetPathSeparator() + "benchmark.import.sh3b";
+
+        struct Result
+        {
+            double mSaveTime = 0.0;
+            double mLoadTime = 0.0;
+            size_t mSavePeak = 0;
+            size_t mLoadPeak = 0;
+            uint64_t mBytes = 0;
+            uint32_t mLoaded = 0;   /**< Entities found by the load */
+        };
+        auto lEntitiesOf = [&](uint32_t aScene)
+        {
+            return lEntities / lScenes + (aScene < lEntities % lScenes ? 1 : 0);
+        };
+        auto lNow = []() { return std::chrono::high_resolution_clock::now(); };
+        auto lMs = [](std::chrono::high_resolution_clock::time_point aStart)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - aStart).count();
+        };
+
+        /* JSON: the project as one DOM, written with StyledWriter and parsed whole */
+        Result lJson;
+        {
+            size_t lBase = ProjectMemory::Begin();
+            auto lStart = lNow();
+            {
+                Json::Value lSerializer;
+                lSerializer["projectName"] = "benchmark";
+                lSerializer["sample"] = false;
+                Json::Value& lScenesValue = lSerializer["scenes"];
+                lScenesValue = Json::Value(Json::arrayValue);
+                for (uint32_t s = 0, lIndex = 0; s < lScenes; ++s)
+                {
+                    Json::Value& lScene = lScenesValue.append(Json::Value());
+                    ProjectGenerator::Scene(lScene, s);
+                    Json::Value& lSceneEntities = lScene["entities"];
+                    lSceneEntities = Json::Value(Json::arrayValue);
+                    for (uint32_t e = 0; e < lEntitiesOf(s); ++e)
+                        ProjectGenerator::Entity(lSceneEntities.append(Json::Value()), lIndex++);
+                }
+                Json::StyledWriter lWriter;
+                const std::string lOutput = lWriter.write(lSerializer);
+                std::fstream lFileOut(lJsonFile, std::ios_base::out);
+                lFileOut << lOutput;
+                lJson.mBytes = lOutput.size();
+            }
+            lJson.mSaveTime = lMs(lStart);
+            lJson.mSavePeak = ProjectMemory::sPeak - lBase;
+
+            lBase = ProjectMemory::Begin();
+            lStart = lNow();
+            {
+                Json::Value lSerializer;
+                if (!Json::JsonUtils::OpenAndParseJsonFromFile(lSerializer, lJsonFile))
+                {
+                    CRASH("ERROR parsing %s\n", lJsonFile.c_str());
+                    exit(2);
+                }
+                for (const Json::Value& lScene : lSerializer["scenes"])
+                    for (const Json::Value& lEntity : lScene["entities"])
+                        lJson.mLoaded += lEntity.isMember("components") ? 1 : 0;
+            }
+            lJson.mLoadTime = lMs(lStart);
+            lJson.mLoadPeak = ProjectMemory::sPeak - lBase;
+        }
+
+        /* Binary: an entity at a time */
+        Result lBinary;
+        {
+            size_t lBase = ProjectMemory::Begin();
+            auto lStart = lNow();
+            {
+                ProjectFile::Writer lWriter;
+                if (!lWriter.Open(lBinaryFile))
+                    exit(2);
+                Json::Value lProject;
+                lProject["projectName"] = "benchmark";
+                lProject["sample"] = false;
+                lWriter.WriteProject(lProject);
+                for (uint32_t s = 0, lIndex = 0; s < lScenes; ++s)
+                {
+                    Json::Value lScene;
+                    ProjectGenerator::Scene(lScene, s);
+                    lWriter.BeginScene(lScene);
+                    for (uint32_t e = 0; e < lEntitiesOf(s); ++e)
+                    {
+                        Json::Value lEntity;
+                        ProjectGenerator::Entity(lEntity, lIndex++);
+                        lWriter.WriteEntity(lEntity);
+                    }
+                    lWriter.EndScene();
+                }
+                if (!lWriter.Close())
+                    exit(2);
+                lBinary.mBytes = lWriter.GetWrittenBytes();
+            }
+            lBinary.mSaveTime = lMs(lStart);
+            lBinary.mSavePeak = ProjectMemory::sPeak - lBase;
+
+            lBase = ProjectMemory::Begin();
+            lStart = lNow();
+            {
+                ProjectFile::Reader lReader;
+                if (!lReader.Open(lBinaryFile))
+                    exit(2);
+                Json::Value lRecord;
+                ProjectFile::Record lType;
+                while ((lType = lReader.Next(lRecord)) != ProjectFile::Record::eEND)
+                {
+                    if (lType == ProjectFile::Record::eERROR)
+                    {
+                        CRASH("ERROR reading %s\n", lBinaryFile.c_str());
+                        exit(2);
+                    }
+                    if (lType == ProjectFile::Record::eENTITY)
+                        lBinary.mLoaded += lRecord.isMember("components") ? 1 : 0;
+                }
+            }
+            lBinary.mLoadTime = lMs(lStart);
+            lBinary.mLoadPeak = ProjectMemory::sPeak - lBase;
+        }
+
+        printf("%u entities in %u scenes\n\n", lEntities, lScenes);
+        printf("%-8s %10s %10s %12s %14s %14s %10s\n", "format", "save ms", "load ms", "file KB", "save peak KB", "load peak KB", "loaded");
+        for (const auto& lRow : { std::make_pair("json", &lJson), std::make_pair("binary", &lBinary) })
+        {
+            const Result& lResult = *lRow.second;
+            printf("%-8s %10.1f %10.1f %12.1f %14.1f %14.1f %10u\n", lRow.first, lResult.mSaveTime, lResult.mLoadTime,
+                   lResult.mBytes / 1024.0, lResult.mSavePeak / 1024.0, lResult.mLoadPeak / 1024.0, lResult.mLoaded);
+        }
+
+        /* The conversions keep the project: the export of the binary file parses to
+           the saved JSON project, and so does the export of the import of it */
+        auto lExportsAsSaved = [&](const std::string& aBinaryFile)
+        {
+            Json::Value lSaved, lExported;
+            return ProjectFile::ExportJson(aBinaryFile, lExportFile)
+                && Json::JsonUtils::OpenAndParseJsonFromFile(lSaved, lJsonFile)
+                && Json::JsonUtils::OpenAndParseJsonFromFile(lExported, lExportFile)
+                && lSaved == lExported;
+        };
+        const bool lIsOk = lJson.mLoaded == lEntities && lBinary.mLoaded == lEntities && lExportsAsSaved(lBinaryFile)
+            && ProjectFile::ImportJson(lJsonFile, lImportFile) && lExportsAsSaved(lImportFile);
+        printf("\nJSON export and import: %s\n", lIsOk ? "identical" : "DIFFERENT");
+        return lIsOk ? 0 : 3;
+    }
+}
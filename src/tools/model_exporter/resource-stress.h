@@ -0,0 +1,145 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Stress test of the memory budget of the resource manager. The 3D
+ *                assets of all the resource files are browsed in catalog order, a
+ *                page of models at a time, like a user scrolling the catalog. After
+ *                every step the registry is trimmed as the engine does once per frame,
+ *                and the resident memory must stay under the budget.
+ *
+ *                There is no GPU here: an asset counts as uploaded once it is made
+ *                render ready, with the video memory it would have taken.
+ *******************************************************************************/
+
+#include "precompiled.h"
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include "core/serialization/jsoncpputils.h"
+#include "engine/resourceregistry.h"
+#include "graphic/asset3d.h"
+
+using namespace Framework;
+
+namespace Tool
+{
+    int ResourceStress(int argc, char **argv)
+    {
+        if (argc < 5)
+        {
+            INFO(LogLevel::eLEVEL2, "Insomnium Engine Tools\n\n");
+            INFO(LogLevel::eLEVEL2, "Usage: [OPTION] ... PARAMERTERS\n");
+            INFO(LogLevel::eLEVEL2, "\n");
+
+            INFO(LogLevel::eLEVEL2, "Options:\n");
+            INFO(LogLevel::eLEVEL2, "  -rs, --resource-stress <game_dir> <cpu_mb> <gpu_mb> [<passes>] [<page>] Cycles through the catalog under a memory budget\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <game_dir>: directory with data/resources/resources*.json\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <cpu_mb>, <gpu_mb>: budget of the loaded assets, 0 is no limit\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <passes>: times the catalog is browsed, 3 by default\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <page>: models in use at a time, 4 by default\n\n");
+            exit(1);
+        }
+
+        const std::string lGameDir = argv[2];
+        MemoryBudget lBudget;
+        lBudget.mCpuBytes = uint64_t(atoi(argv[3])) << 20;
+        lBudget.mGpuBytes = uint64_t(atoi(argv[4])) << 20;
+        const uint32_t lPasses = argc > 5 ? std::max(1, atoi(argv[5])) : 3;
+        const uint32_t lPage = argc > 6 ? std::max(1, atoi(argv[6])) : 4;
+
+        /* The catalog entries whose model is not in the data directory are skipped,
+           the engine would not load them either */
+        ResourceRegistry<Asset3D> lRegistry;
+        uint32_t lMissing = 0;
+        for (const auto& lResourceFile : Utils::ListFiles(lGameDir + "/data/resources", "json"))
+        {
+            Json::Value lResources;
+            Json::JsonUtils::OpenAndParseJsonFromFile(lResources, lResourceFile);
+            for (const auto& lModel : lResources["models"])
+            {
+                if (!lModel.isMember("asset3d"))
+                    continue;
+                const std::string lFile = lGameDir + "/" + lModel["asset3d"].asString();
+                if (std::ifstream(lFile).good())
+                    lRegistry.Add(lModel["name"].asString(), lFile, true);
+                else
+                    ++lMissing;
+            }
+        }
+        if (lRegistry.GetCount() == 0)
+        {
+            CRASH("ERROR no 3D assets found in %s/data/resources\n", lGameDir.c_str());
+            exit(2);
+        }
+
+        /* Every step uses the next asset of the catalog and releases the one that
+           scrolls out of the page */
+        std::deque<std::shared_ptr<const Asset3D>> lInUse;
+        uint64_t lFrame = 0, lPeakCpu = 0, lPeakGpu = 0, lPeakReferencedCpu = 0, lPeakReferencedGpu = 0;
+        uint32_t lOverBudget = 0, lFailed = 0;
+        const auto lStart = std::chrono::high_resolution_clock::now();
+        for (uint32_t lPass = 0; lPass < lPasses; ++lPass)
+        {
+            for (uint32_t i = 0; i < lRegistry.GetCount(); ++i, ++lFrame)
+            {
+                lRegistry.MarkUsed(i, lFrame);
+                std::shared_ptr<Asset3D> lAsset = lRegistry.Get(i);
+                if (!lAsset->mRendererResources)
+                {
+                    if (!lAsset->Load(lAsset->GetResourceName()))
+                    {
+                        ++lFailed;
+                        continue;
+                    }
+                    lAsset->mRendererResources.reset(new RendererResources());
+                    lAsset->RenderReady();
+                    lRegistry.SetResident(i, true, lAsset->GetCpuSize(), lAsset->GetGpuSize());
+                }
+                lInUse.push_back(std::move(lAsset));
+                if (lInUse.size() > lPage)
+                    lInUse.pop_front();
+
+                ResourceRegistryBase::Trim(lBudget, lFrame, { &lRegistry });
+
+                const ResourceRegistryBase::Stats& lStats = lRegistry.GetStats();
+                uint64_t lReferencedCpu = 0, lReferencedGpu = 0;
+                for (const auto& lUsed : lInUse)
+                {
+                    lReferencedCpu += lUsed->GetCpuSize();
+                    lReferencedGpu += lUsed->GetGpuSize();
+                }
+                lPeakCpu = std::max(lPeakCpu, lStats.mCpuBytes);
+                lPeakGpu = std::max(lPeakGpu, lStats.mGpuBytes);
+                lPeakReferencedCpu = std::max(lPeakReferencedCpu, lReferencedCpu);
+                lPeakReferencedGpu = std::max(lPeakReferencedGpu, lReferencedGpu);
+                // Over the budget is only allowed while the page alone does not fit
+                if (!lBudget.Fits(lStats.mCpuBytes, lStats.mGpuBytes) && lBudget.Fits(lReferencedCpu, lReferencedGpu))
+                    ++lOverBudget;
+            }
+        }
+        const double lTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - lStart).count();
+
+        const ResourceRegistryBase::Stats& lStats = lRegistry.GetStats();
+        const double lMB = 1.0 / (1 << 20);
+        printf("%u assets (%u missing files skipped), %u passes, %u models in use, budget %.1f MiB system / %.1f MiB video\n", lRegistry.GetCount(), lMissing, lPasses, lPage,
+               lBudget.mCpuBytes * lMB, lBudget.mGpuBytes * lMB);
+        printf("peak resident      %10.2f MiB system %10.2f MiB video\n", lPeakCpu * lMB, lPeakGpu * lMB);
+        printf("peak of the page   %10.2f MiB system %10.2f MiB video\n", lPeakReferencedCpu * lMB, lPeakReferencedGpu * lMB);
+        printf("resident at end    %10.2f MiB system %10.2f MiB video, %u assets\n", lStats.mCpuBytes * lMB, lStats.mGpuBytes * lMB, lStats.mResident);
+        printf("hits %llu, misses %llu, evictions %llu (%.2f MiB), load failures %u, %.1f ms\n",
+               (unsigned long long)lStats.mHits, (unsigned long long)lStats.mMisses, (unsigned long long)lStats.mEvictions,
+               lStats.mEvictedBytes * lMB, lFailed, lTime);
+
+        lInUse.clear();
+        if (lOverBudget > 0)
+        {
+            printf("FAILED: %u steps over the budget with evictable assets\n", lOverBudget);
+            return 4;
+        }
+        printf("PASSED: the resident memory stayed under the budget\n");
+        return 0;
+    }
+}
@@ -0,0 +1,272 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Open time and resident memory of a project of many floors, with
+ *                every floor loaded at the open and with the floors loaded when
+ *                shown, as Project and Scene do. Then the floors are shown one after
+ *                the other under a memory budget, the least recently shown ones
+ *                evicted to memory. An eviction must release its memory at once,
+ *                as Project::EvictScenes checks the budget again right after it:
+ *                only the floors needed to fit the budget are evicted.
+ *
+ *                There is no engine here: a loaded floor is its decoded entities,
+ *                which stand for the instantiated ones, and its render targets,
+ *                counted with the size Scene::GetRenderTargetBytes gives them. The
+ *                memory is counted by the operator new of the project benchmark.
+ *******************************************************************************/
+
+#pragma once
+
+#include "precompiled.h"
+#include <chrono>
+#include <sstream>
+#include "engine/projectfile.h"
+#include "project-benchmark.h"
+
+using namespace Framework;
+
+namespace Tool
+{
+    namespace SceneLoading
+    {
+        /* NoAA and GBuffer of 256x256, see Scene::GetRenderTargetBytes */
+        const uint64_t sRenderTargetBytes = 256 * 256 * ((4 + 3 + 4) + (4 + 3 + 12 + 16 + 4));
+
+        struct Floor
+        {
+            std::string              mFileName;                 /**< Binary project holding the floor */
+            std::string              mRecords;                  /**< Or the floor in memory, once evicted */
+            std::streampos           mPosition = -1;
+            std::vector<Json::Value> mEntities;                 /**< The loaded entities */
+            bool                     mIsLoaded = false;
+        };
+
+        bool Load(Floor& aFloor)
+        {
+            ProjectFile::Reader lReader;
+            std::istringstream lRecords;
+            bool lIsOpen;
+            if (aFloor.mFileName.empty())
+            {
+                lRecords.str(aFloor.mRecords);
+                lIsOpen = lReader.Open(lRecords);
+            }
+            else
+                lIsOpen = lReader.Open(aFloor.mFileName);
+
+            Json::Value lRecord;
+            if (!lIsOpen || !lReader.Seek(aFloor.mPosition) || lReader.Next(lRecord) != ProjectFile::Record::eSCENE)
+                return false;
+            ProjectFile::Record lType;
+            while ((lType = lReader.Next(lRecord)) == ProjectFile::Record::eENTITY)
+            {
+                aFloor.mEntities.emplace_back();
+                aFloor.mEntities.back().swap(lRecord);
+            }
+            aFloor.mIsLoaded = true;
+            std::string().swap(aFloor.mRecords);
+            aFloor.mFileName.clear();
+            return lType == ProjectFile::Record::eSCENE_END;
+        }
+
+        void Evict(Floor& aFloor, uint32_t aFloorIndex)
+        {
+            std::stringstream lRecords(std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+            ProjectFile::Writer lWriter;
+            lWriter.Open(lRecords);
+            Json::Value lHeader;
+            ProjectGenerator::Scene(lHeader, aFloorIndex);
+            lWriter.BeginScene(lHeader);
+            aFloor.mPosition = lWriter.GetScenePosition();
+            for (const Json::Value& lEntity : aFloor.mEntities)
+                lWriter.WriteEntity(lEntity);
+            lWriter.EndScene();
+            lWriter.Close();
+
+            aFloor.mRecords = lRecords.str();
+            std::vector<Json::Value>().swap(aFloor.mEntities);
+            aFloor.mIsLoaded = false;
+        }
+    }
+
+    int SceneLoadingBenchmark(int argc, char **argv)
+    {
+        if (argc < 3)
+        {
+            INFO(LogLevel::eLEVEL2, "Insomnium Engine Tools\n\n");
+            INFO(LogLevel::eLEVEL2, "Usage: [OPTION] ... PARAMERTERS\n");
+            INFO(LogLevel::eLEVEL2, "\n");
+
+            INFO(LogLevel::eLEVEL2, "Options:\n");
+            INFO(LogLevel::eLEVEL2, "  -sl, --scene-loading <work_dir> [<floors>] [<entities>] [<budget>] Open time and resident memory, floors loaded at the open and when shown\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <work_dir>: directory for the project file\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <floors>: floors of the project, 10 by default\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <entities>: entities per floor, 1000 by default\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <budget>: MB the loaded floors may take, 16 by default\n\n");
+            exit(1);
+        }
+
+        const std::string lWorkDir = argv[2];
+        const uint32_t lFloors = argc > 3 ? std::max(1, atoi(argv[3])) : 10;
+        const uint32_t lEntities = argc > 4 ? std::max(1, atoi(argv[4])) : 1000;
+        const uint64_t lBudget = uint64_t(argc > 5 ? std::max(1, atoi(argv[5])) : 16) << 20;
+        const std::string lFileName = lWorkDir + Utils::GetPathSeparator() + "floors.sh3b";
+
+        auto lNow = []() { return std::chrono::high_resolution_clock::now(); };
+        auto lMs = [](std::chrono::high_resolution_clock::time_point aStart)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - aStart).count();
+        };
+
+        {
+            ProjectFile::Writer lWriter;
+            if (!lWriter.Open(lFileName))
+                exit(2);
+            Json::Value lProject;
+            lProject["projectName"] = "floors";
+            lProject["sample"] = false;
+            lWriter.WriteProject(lProject);
+            for (uint32_t f = 0, lIndex = 0; f < lFloors; ++f)
+            {
+                Json::Value lScene;
+                ProjectGenerator::Scene(lScene, f);
+                lWriter.BeginScene(lScene);
+                for (uint32_t e = 0; e < lEntities; ++e, ++lIndex)
+                {
+                    Json::Value lEntity;
+                    ProjectGenerator::Entity(lEntity, lIndex);
+                    lWriter.WriteEntity(lEntity, lIndex);
+                }
+                lWriter.EndScene();
+            }
+            if (!lWriter.Close())
+                exit(2);
+        }
+
+        /* Opens the project: every floor loaded, or indexed only */
+        struct Open
+        {
+            double  mTime = 0.0;
+            size_t  mBytes = 0;             /**< Resident after the open, render targets excluded */
+            uint32_t mLoaded = 0;
+        };
+        auto lOpen = [&](std::vector<SceneLoading::Floor>& aFloors, bool aLazy, Open& aResult)
+        {
+            const size_t lBase = ProjectMemory::Begin();
+            const auto lStart = lNow();
+            ProjectFile::Reader lReader;
+            if (!lReader.Open(lFileName))
+                return false;
+            Json::Value lRecord;
+            for (;;)
+            {
+                const ProjectFile::Record lType = lReader.Next(lRecord);
+                if (lType == ProjectFile::Record::eEND)
+                    break;
+                if (lType == ProjectFile::Record::eERROR)
+                    return false;
+                if (lType == ProjectFile::Record::eSCENE)
+                {
+                    aFloors.emplace_back();
+                    aFloors.back().mFileName = lFileName;
+                    aFloors.back().mPosition = lReader.GetRecordPosition();
+                    if (aLazy && !lReader.SkipScene())
+                        return false;
+                    aFloors.back().mIsLoaded = !aLazy;
+                }
+                else if (lType == ProjectFile::Record::eENTITY)
+                {
+                    aFloors.back().mEntities.emplace_back();
+                    aFloors.back().mEntities.back().swap(lRecord);
+                }
+            }
+            aResult.mTime = lMs(lStart);
+            aResult.mBytes = ProjectMemory::sCurrent - lBase;
+            for (const auto& lFloor : aFloors)
+                aResult.mLoaded += lFloor.mIsLoaded ? 1 : 0;
+            return true;
+        };
+
+        Open lEager, lLazy, lFirstFloor;
+        bool lIsOk = true;
+        std::vector<SceneLoading::Floor> lLazyFloors;
+        const size_t lLazyBase = ProjectMemory::sCurrent;
+        lIsOk &= lOpen(lLazyFloors, true, lLazy);
+        {
+            const auto lStart = lNow();
+            lIsOk &= SceneLoading::Load(lLazyFloors[0]);
+            lFirstFloor.mTime = lLazy.mTime + lMs(lStart);
+            lFirstFloor.mBytes = ProjectMemory::sCurrent - lLazyBase;
+            lFirstFloor.mLoaded = 1;
+        }
+
+        /* The floors shown in order twice, the least recently shown evicted while the
+           loaded floors do not fit the budget */
+        std::vector<uint32_t> lLoaded(1, 0);   // the least recently shown first
+        double lFileLoadTime = 0.0, lMemoryLoadTime = 0.0, lEvictTime = 0.0;
+        uint32_t lFileLoads = 0, lMemoryLoads = 0, lEvictions = 0;
+        bool lIsEvictionOk = true;
+        size_t lPeakBytes = 0;
+        for (uint32_t s = 1; s < 2 * lFloors; ++s)
+        {
+            const uint32_t lShown = s % lFloors;
+            SceneLoading::Floor& lFloor = lLazyFloors[lShown];
+            if (!lFloor.mIsLoaded)
+            {
+                const bool lFromFile = !lFloor.mFileName.empty();
+                const auto lStart = lNow();
+                lIsOk &= SceneLoading::Load(lFloor);
+                (lFromFile ? lFileLoadTime : lMemoryLoadTime) += lMs(lStart);
+                ++(lFromFile ? lFileLoads : lMemoryLoads);
+            }
+            lLoaded.erase(std::remove(lLoaded.begin(), lLoaded.end(), lShown), lLoaded.end());
+            lLoaded.push_back(lShown);
+
+            auto lResident = [&]() { return ProjectMemory::sCurrent - lLazyBase + lLoaded.size() * SceneLoading::sRenderTargetBytes; };
+            lPeakBytes = std::max(lPeakBytes, lResident());
+            while (lLoaded.size() > 1 && lResident() > lBudget)
+            {
+                const size_t lBefore = lResident();
+                const auto lStart = lNow();
+                SceneLoading::Evict(lLazyFloors[lLoaded.front()], lLoaded.front());
+                lEvictTime += lMs(lStart);
+                ++lEvictions;
+                lLoaded.erase(lLoaded.begin());
+
+                // Nothing released would evict every other floor before the budget is met
+                lIsEvictionOk &= lResident() < lBefore;
+            }
+            lIsEvictionOk &= lLoaded.size() == 1 || lResident() <= lBudget;
+        }
+
+        // Last: freeing every floor leaves the allocator consolidating in the next open
+        {
+            std::vector<SceneLoading::Floor> lEagerFloors;
+            lIsOk &= lOpen(lEagerFloors, false, lEager);
+        }
+
+        printf("%u floors of %u entities, render targets of %.0f KB per floor\n\n", lFloors, lEntities, SceneLoading::sRenderTargetBytes / 1024.0);
+        printf("%-24s %10s %14s %14s %8s\n", "open", "time ms", "entities KB", "resident KB", "loaded");
+        const std::pair<const char*, const Open*> lRows[] = { { "every floor", &lEager }, { "indexed", &lLazy }, { "indexed + first floor", &lFirstFloor } };
+        for (const auto& lRow : lRows)
+        {
+            const Open& lResult = *lRow.second;
+            printf("%-24s %10.2f %14.1f %14.1f %8u\n", lRow.first, lResult.mTime, lResult.mBytes / 1024.0,
+                   (lResult.mBytes + lResult.mLoaded * SceneLoading::sRenderTargetBytes) / 1024.0, lResult.mLoaded);
+        }
+
+        printf("\nshowing the floors twice with a budget of %.1f MB: %u loaded from the file in %.2f ms each, %u from memory in %.2f ms each\n",
+               lBudget / 1048576.0, lFileLoads, lFileLoads ? lFileLoadTime / lFileLoads : 0.0, lMemoryLoads, lMemoryLoads ? lMemoryLoadTime / lMemoryLoads : 0.0);
+        printf("%u evictions in %.2f ms each, peak resident %.1f KB, %zu floors loaded at the end\n",
+               lEvictions, lEvictions ? lEvictTime / lEvictions : 0.0, lPeakBytes / 1024.0, lLoaded.size());
+
+        for (const auto& lFloor : lLazyFloors)
+            lIsOk &= !lFloor.mIsLoaded || lFloor.mEntities.size() == lEntities;
+        printf("\nfloors read back: %s\n", lIsOk ? "complete" : "INCOMPLETE");
+        printf("evictions: %s\n", lIsEvictionOk ? "memory released at once, only the floors needed to fit the budget" : "TOO MANY");
+        return lIsOk && lIsEvictionOk ? 0 : 3;
+    }
+}
@@ -0,0 +1,180 @@
+/*******************************************************************************
+ *  Author      : giron3s
+ *  Copyright   : Copyright (C) 2019 Marc Girones Dezsenyi - All Rights Reserved
+ *                Unauthorized copying of this file, via any medium is strictly prohibited
+ *                Proprietary and confidential
+ *
+ *  Brief       : Cooks the textures of engine model files, and benchmarks the
+ *                startup cost of the images of a directory: decode time against
+ *                the load from the texture cache, and the video memory of the
+ *                uploaded textures before and after the cook
+ *******************************************************************************/
+
+#pragma once
+
+#include "precompiled.h"
+#include <chrono>
+#include "graphic/asset3d.h"
+#include "core/graphic/texturecooker.h"
+
+using namespace Framework;
+
+namespace Tool
+{
+    namespace TextureCook
+    {
+        inline bool ParseCompression(const char* aName, Texture::Compression& aCompression)
+        {
+            static const char* sNames[] = { "none", "bc1", "bc3", "bc7" };
+            for ( uint32_t i = 0; i < 4; ++i )
+            {
+                if ( strcmp(aName, sNames[i]) == 0 )
+                {
+                    aCompression = static_cast<Texture::Compression>(i);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        inline double Milliseconds(const std::chrono::high_resolution_clock::time_point& aStart)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - aStart).count();
+        }
+    }
+
+    int CookTextures(int argc, char **argv)
+    {
+        if (argc < 4)
+        {
+            INFO(LogLevel::eLEVEL2, "Insomnium Engine Tools\n\n");
+            INFO(LogLevel::eLEVEL2, "Usage: [OPTION] ... PARAMERTERS\n");
+            INFO(LogLevel::eLEVEL2, "\n");
+
+            INFO(LogLevel::eLEVEL2, "Options:\n");
+            INFO(LogLevel::eLEVEL2, "  -t, --cook-textures <input> <output> [<compression>] Builds the mip chain of the textures of an internal asset file\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <input>: internal asset path and name\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <output>: filename of the cooked asset\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <compression>: 'none' (default), 'bc1', 'bc3' or 'bc7'\n\n");
+            exit(1);
+        }
+
+        TextureCooker::Options lOptions;
+        if (argc > 4 && !TextureCook::ParseCompression(argv[4], lOptions.mCompression))
+        {
+            CRASH("ERROR unknown texture compression %s\n", argv[4]);
+            exit(2);
+        }
+
+        Asset3D lAsset(argv[2], "");
+        if (lAsset.Load(argv[2]) == false)
+        {
+            CRASH("ERROR loading asset from file %s\n", argv[2]);
+            exit(3);
+        }
+
+        uint64_t lRawSize = 0;
+        for (const auto& lTexture : lAsset.GetTextures())
+            lRawSize += lTexture.GetResidentSize();
+
+        const auto lStart = std::chrono::high_resolution_clock::now();
+        const uint32_t lCooked = TextureCooker::CookTextures(lAsset, lOptions);
+        const double lTime = TextureCook::Milliseconds(lStart);
+
+        uint64_t lCookedSize = 0;
+        printf("%-24s %12s %6s %14s\n", "texture", "size", "levels", "bytes");
+        for (const auto& lTexture : lAsset.GetTextures())
+        {
+            printf("%-24s %5ux%-6u %6u %14llu\n", lTexture.mName.c_str(), lTexture.mWidth, lTexture.mHeight, lTexture.mMipLevels,
+                   (unsigned long long)lTexture.GetResidentSize());
+            lCookedSize += lTexture.GetResidentSize();
+        }
+        printf("%u textures cooked in %.1f ms, video memory %llu bytes before and %llu after\n", lCooked, lTime,
+               (unsigned long long)lRawSize, (unsigned long long)lCookedSize);
+
+        if (lAsset.Save(argv[3]) == false)
+        {
+            CRASH("ERROR storing asset to output file %s\n", argv[3]);
+            exit(4);
+        }
+
+        INFO(LogLevel::eLEVEL2, "Created %s succesfully\n\n", argv[3]);
+        return 0;
+    }
+
+    int TextureBenchmark(int argc, char **argv)
+    {
+        if (argc < 4)
+        {
+            INFO(LogLevel::eLEVEL2, "Insomnium Engine Tools\n\n");
+            INFO(LogLevel::eLEVEL2, "Usage: [OPTION] ... PARAMERTERS\n");
+            INFO(LogLevel::eLEVEL2, "\n");
+
+            INFO(LogLevel::eLEVEL2, "Options:\n");
+            INFO(LogLevel::eLEVEL2, "  -tb, --texture-benchmark <textures_dir> <work_dir> [<compression>] Startup cost of the images with and without the texture cache\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <textures_dir>: directory with the .png and .jpg files, e.g. data/resources/textures\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <work_dir>: directory of the texture cache\n");
+            INFO(LogLevel::eLEVEL2, "                                                   <compression>: 'none' (default), 'bc1', 'bc3' or 'bc7'\n\n");
+            exit(1);
+        }
+
+        TextureCooker::Options lOptions;
+        if (argc > 4 && !TextureCook::ParseCompression(argv[4], lOptions.mCompression))
+        {
+            CRASH("ERROR unknown texture compression %s\n", argv[4]);
+            exit(2);
+        }
+
+        std::vector<std::string> lFiles = Utils::ListFiles(argv[2], "png");
+        const std::vector<std::string> lJpegFiles = Utils::ListFiles(argv[2], "jpg");
+        lFiles.insert(lFiles.end(), lJpegFiles.begin(), lJpegFiles.end());
+        if (lFiles.empty())
+        {
+            CRASH("ERROR no .png or .jpg files found in %s\n", argv[2]);
+            exit(3);
+        }
+        TextureCooker::SetCacheDirectory(argv[3]);
+
+        double lDecodeTime = 0.0, lCookTime = 0.0, lCachedTime = 0.0;
+        uint64_t lRawSize = 0, lCookedSize = 0;
+        printf("%-32s %12s %10s %10s %10s %14s %14s\n", "texture", "size", "decode ms", "cook ms", "cached ms", "raw bytes", "cooked bytes");
+        for (const auto& lFile : lFiles)
+        {
+            /* The decode as the engine did before, then the cook that fills the cache */
+            Texture lTexture;
+            auto lStart = std::chrono::high_resolution_clock::now();
+            if (!lTexture.Load(lFile))
+                continue;
+            const double lDecode = TextureCook::Milliseconds(lStart);
+            const uint64_t lRaw = lTexture.GetResidentSize();
+
+            uint64_t lSourceHash = 0;
+            const std::string lCacheFile = TextureCooker::GetCacheFile(lFile, lOptions, lSourceHash);
+            lStart = std::chrono::high_resolution_clock::now();
+            const bool lCooked = TextureCooker::Cook(lTexture, lOptions);
+            const double lCook = TextureCook::Milliseconds(lStart);
+            if (!lCooked || !TextureCooker::WriteCacheFile(lCacheFile, lSourceHash, lTexture))
+            {
+                WARNING("Texture %s cannot be cooked", lFile.c_str());
+                continue;
+            }
+
+            /* The load of the next startups */
+            Texture lCachedTexture;
+            lStart = std::chrono::high_resolution_clock::now();
+            TextureCooker::Load(lFile, lCachedTexture, lOptions);
+            const double lCached = TextureCook::Milliseconds(lStart);
+
+            printf("%-32s %5ux%-6u %10.2f %10.2f %10.2f %14llu %14llu\n", Utils::GetFileName(lFile).c_str(), lTexture.mWidth, lTexture.mHeight,
+                   lDecode, lCook, lCached, (unsigned long long)lRaw, (unsigned long long)lCachedTexture.GetResidentSize());
+            lDecodeTime += lDecode;
+            lCookTime += lCook;
+            lCachedTime += lCached;
+            lRawSize += lRaw;
+            lCookedSize += lCachedTexture.GetResidentSize();
+        }
+        printf("%-32s %12s %10.2f %10.2f %10.2f %14llu %14llu\n", "total", "", lDecodeTime, lCookTime, lCachedTime,
+               (unsigned long long)lRawSize, (unsigned long long)lCookedSize);
+        return 0;
+    }
+}